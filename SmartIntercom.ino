@@ -13,11 +13,19 @@
  * для надежного управления домофонными системами.
  */
 
+#include <SmartIntercom.h>
+#include <SmartIntercomApi.h>
+#include <SmartIntercomHttpWiFi.h>
+#include <SmartIntercomMqtt.h>
+#include <SmartIntercomMqttWiFi.h>
+#include <SmartIntercomWiFi.h>
+#include <SmartIntercomWiFiESP8266.h>
+#include <SmartIntercomWatchdog.h>
+#include <SmartIntercomHeap.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WebServer.h>
 #include <ESP8266mDNS.h>
-#include <ArduinoJson.h>
-#include <EEPROM.h>
+#include <Ticker.h>
+#include "SmartIntercomWebPage.h"
 
 // SmartIntercom Configuration
 #define SMARTINTERCOM_VERSION "2.0.0"
@@ -35,470 +43,320 @@
 #define SMARTINTERCOM_DOOR_OPEN_TIME 3000  // Время открытия двери (мс)
 #define SMARTINTERCOM_DEBOUNCE_TIME 50     // Время антидребезга (мс)
 #define SMARTINTERCOM_RING_TIMEOUT 30000   // Таймаут звонка (мс)
-
-// SmartIntercom States
-enum SmartIntercomState {
-  SMARTINTERCOM_IDLE,
-  SMARTINTERCOM_RINGING,
-  SMARTINTERCOM_OPENING,
-  SMARTINTERCOM_OPEN,
-  SMARTINTERCOM_ERROR
-};
+#define SMARTINTERCOM_LOOP_IDLE_MS 250     // Наибольший сон loop() (таймеры mDNS)
+
+// SmartIntercom Watchdog Configuration (те же имена, что и в config.example.h)
+#define SMARTINTERCOM_WATCHDOG_ENABLED true  // Включить сторож главного цикла SmartIntercom
+#define SMARTINTERCOM_WATCHDOG_TIMEOUT 60    // Зависание дольше - перезагрузка (сек)
+#define SMARTINTERCOM_WATCHDOG_BUDGET 100    // Фаза loop() дольше - запись в журнал (мс)
+
+// SmartIntercom MQTT Configuration (те же имена, что и в config.example.h)
+#define SMARTINTERCOM_MQTT_ENABLED false                           // Включить MQTT для SmartIntercom
+#define SMARTINTERCOM_MQTT_SERVER "mqtt.local"                     // Адрес MQTT брокера SmartIntercom
+#define SMARTINTERCOM_MQTT_PORT 1883                               // Порт MQTT SmartIntercom
+#define SMARTINTERCOM_MQTT_USER ""                                 // Логин MQTT SmartIntercom
+#define SMARTINTERCOM_MQTT_PASSWORD ""                             // Пароль MQTT SmartIntercom
+#define SMARTINTERCOM_MQTT_TOPIC_STATUS "smartintercom/status"     // Топик статуса SmartIntercom
+#define SMARTINTERCOM_MQTT_TOPIC_EVENTS "smartintercom/events"     // Топик событий SmartIntercom
+#define SMARTINTERCOM_MQTT_TOPIC_COMMANDS "smartintercom/commands" // Топик команд SmartIntercom
+#define SMARTINTERCOM_MQTT_QOS 1                                   // QoS для MQTT SmartIntercom
+#define SMARTINTERCOM_MQTT_RETAIN true                             // Retain для статуса SmartIntercom
 
 // SmartIntercom Global Variables
-SmartIntercomState smartIntercomCurrentState = SMARTINTERCOM_IDLE;
-ESP8266WebServer smartIntercomWebServer(80);
-unsigned long smartIntercomLastRingTime = 0;
-unsigned long smartIntercomDoorOpenTime = 0;
-bool smartIntercomAutoOpenEnabled = false;
-bool smartIntercomAlwaysOpenEnabled = false;
-int smartIntercomOpenDelay = 0;
-int smartIntercomLedBrightness = 255;
+SmartIntercom smartIntercom;
+SmartIntercomGPIO smartIntercomRelay(SMARTINTERCOM_RELAY_PIN);
+SmartIntercomFlashESP8266 smartIntercomFlash(2, 19);    // Журнал конфигурации перед сектором WiFi
+SmartIntercomFlashESP8266 smartIntercomEepromFlash;       // Сектор EEPROM: журнал прежних прошивок
+SmartIntercomConfigStore smartIntercomConfigStore;
+SmartIntercomFlashESP8266 smartIntercomStatsFlash(2);
+SmartIntercomStats smartIntercomStats;
+SmartIntercomMetrics smartIntercomMetrics;
+SmartIntercomFlashESP8266 smartIntercomTraceFlash(16, 2);
+SmartIntercomFlashGuard smartIntercomTraceFlashGuard(smartIntercom, smartIntercomTraceFlash);  // Выборка звонка стоит на время записи
+SmartIntercomTrace smartIntercomTrace;
 String smartIntercomWifiSSID = "";
 String smartIntercomWifiPassword = "";
 
-// SmartIntercom GPIO Controller Class
-class SmartIntercomGPIOController {
-private:
-  int pin;
-  bool inverted;
-  unsigned long lastToggleTime;
-  bool currentState;
-
-  // SmartIntercom PWM Control for smooth transitions
-  void smartIntercomSetPWM(int value) {
-    analogWrite(pin, value);
-  }
+// SmartIntercom WiFi Station (фоновое подключение, точка и аренда в RTC и во флеш-памяти)
+SmartIntercomWiFiLinkESP8266 smartIntercomWifiLink;
+SmartIntercomFlashESP8266 smartIntercomWifiFlash(1, 18);  // Перед секторами трассы и статистики
+SmartIntercomFlashGuard smartIntercomWifiFlashGuard(smartIntercom, smartIntercomWifiFlash);
+SmartIntercomWiFi smartIntercomWifi;
 
-  // SmartIntercom Debounce algorithm
-  bool smartIntercomDebounce() {
-    if (millis() - lastToggleTime < SMARTINTERCOM_DEBOUNCE_TIME) {
-      return false;
-    }
-    lastToggleTime = millis();
-    return true;
-  }
-
-public:
-  SmartIntercomGPIOController(int pinNum, bool inv = false) {
-    pin = pinNum;
-    inverted = inv;
-    currentState = false;
-    lastToggleTime = 0;
-    pinMode(pin, OUTPUT);
-    digitalWrite(pin, inverted ? HIGH : LOW);
-  }
-
-  // SmartIntercom Set GPIO State
-  void smartIntercomSetState(bool state) {
-    if (smartIntercomDebounce()) {
-      currentState = state;
-      digitalWrite(pin, (state ^ inverted) ? HIGH : LOW);
-      Serial.print("SmartIntercom GPIO ");
-      Serial.print(pin);
-      Serial.print(" set to ");
-      Serial.println(state ? "HIGH" : "LOW");
-    }
-  }
-
-  // SmartIntercom Toggle GPIO
-  void smartIntercomToggle() {
-    smartIntercomSetState(!currentState);
-  }
-
-  // SmartIntercom Pulse GPIO (with duration)
-  void smartIntercomPulse(unsigned long duration) {
-    smartIntercomSetState(true);
-    delay(duration);
-    smartIntercomSetState(false);
-    Serial.print("SmartIntercom GPIO ");
-    Serial.print(pin);
-    Serial.print(" pulsed for ");
-    Serial.print(duration);
-    Serial.println(" ms");
-  }
-
-  // SmartIntercom Smooth fade for LED
-  void smartIntercomFade(int targetBrightness, int duration) {
-    int steps = 50;
-    int currentBright = analogRead(pin);
-    int stepDelay = duration / steps;
-    int stepSize = (targetBrightness - currentBright) / steps;
-
-    for (int i = 0; i < steps; i++) {
-      currentBright += stepSize;
-      smartIntercomSetPWM(currentBright);
-      delay(stepDelay);
-    }
-    smartIntercomSetPWM(targetBrightness);
-    Serial.print("SmartIntercom LED faded to ");
-    Serial.println(targetBrightness);
-  }
-
-  // SmartIntercom Blink pattern
-  void smartIntercomBlink(int times, int onTime, int offTime) {
-    for (int i = 0; i < times; i++) {
-      smartIntercomSetState(true);
-      delay(onTime);
-      smartIntercomSetState(false);
-      if (i < times - 1) delay(offTime);
-    }
-    Serial.print("SmartIntercom blinked ");
-    Serial.print(times);
-    Serial.println(" times");
-  }
-
-  bool smartIntercomGetState() {
-    return currentState;
-  }
-};
-
-// SmartIntercom GPIO Controllers
-SmartIntercomGPIOController* smartIntercomDoorOpenController;
-SmartIntercomGPIOController* smartIntercomHandsetController;
-SmartIntercomGPIOController* smartIntercomLedController;
-SmartIntercomGPIOController* smartIntercomRelayController;
-
-// SmartIntercom Ring Detection Class
-class SmartIntercomRingDetector {
-private:
-  int pin;
-  int threshold;
-  bool ringing;
-  unsigned long ringStartTime;
-
-public:
-  SmartIntercomRingDetector(int pinNum, int thresh = 512) {
-    pin = pinNum;
-    threshold = thresh;
-    ringing = false;
-    ringStartTime = 0;
-    pinMode(pin, INPUT);
-  }
+// SmartIntercom Loop Watchdog (журнал зависаний в RTC-памяти, проверка таймаута из Ticker)
+SmartIntercomWatchdog smartIntercomWatchdog;
+Ticker smartIntercomWatchdogTicker;
 
-  // SmartIntercom Check if doorbell is ringing
-  bool smartIntercomIsRinging() {
-    int value = analogRead(pin);
-    bool currentlyRinging = value > threshold;
-
-    if (currentlyRinging && !ringing) {
-      ringing = true;
-      ringStartTime = millis();
-      Serial.println("SmartIntercom: Doorbell ring detected!");
-      return true;
-    } else if (!currentlyRinging && ringing) {
-      ringing = false;
-      Serial.println("SmartIntercom: Ring ended");
-    }
-
-    return false;
-  }
+// SmartIntercom Heap Monitor (ряд кучи, высшие отметки фаз loop(), арена запроса; GET /api/heap)
+SmartIntercomHeap smartIntercomHeap;
 
-  // SmartIntercom Get ring duration
-  unsigned long smartIntercomGetRingDuration() {
-    if (ringing) {
-      return millis() - ringStartTime;
-    }
-    return 0;
-  }
-};
+// SmartIntercom Web Server (событийный, несколько соединений, keep-alive)
+SmartIntercomHttpTransportWiFi smartIntercomHttpTransport;
+SmartIntercomHttpServer smartIntercomWebServer;
+SmartIntercomApi smartIntercomApi;
+WiFiEventHandler smartIntercomWifiGotIPHandler;
+WiFiEventHandler smartIntercomWifiDisconnectedHandler;
 
-SmartIntercomRingDetector* smartIntercomRingDetector;
+// SmartIntercom MQTT (события, статус с retain, команды)
+SmartIntercomMqttTransportWiFi smartIntercomMqttTransport;
+SmartIntercomMqtt smartIntercomMqtt;
+bool smartIntercomMqttActive = false;
 
 // SmartIntercom Setup Function
 void setup() {
   Serial.begin(115200);
   delay(100);
 
-  Serial.println("\n\n=================================");
-  Serial.println("SmartIntercom Premium Starting...");
-  Serial.println("=================================");
-  Serial.print("SmartIntercom Version: ");
-  Serial.println(SMARTINTERCOM_VERSION);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom Premium firmware %s", SMARTINTERCOM_VERSION);
+
+  // SmartIntercom Heap Monitor first, so setup() itself shows up in the phase high-water marks
+  smartIntercomHeap.smartIntercomBegin();
+
+  // SmartIntercom Library Initialization (GPIO, ring detector, door)
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Initializing GPIO controllers...");
+  SmartIntercomConfig smartIntercomConfig;
+  smartIntercomConfig.doorbellPin = SMARTINTERCOM_DOORBELL_PIN;
+  smartIntercomConfig.doorOpenPin = SMARTINTERCOM_DOOR_OPEN_PIN;
+  smartIntercomConfig.handsetPin = SMARTINTERCOM_HANDSET_PIN;
+  smartIntercomConfig.ledPin = SMARTINTERCOM_LED_PIN;
+  smartIntercomConfig.openTime = SMARTINTERCOM_DOOR_OPEN_TIME;
+  smartIntercomConfig.debounceTime = SMARTINTERCOM_DEBOUNCE_TIME;
+  smartIntercomConfig.ringTimeout = SMARTINTERCOM_RING_TIMEOUT;
+  smartIntercomConfig.autoOpenEnabled = false;
+  smartIntercomConfig.alwaysOpenEnabled = false;
+  smartIntercomConfig.openDelay = 0;
+  smartIntercomConfig.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  smartIntercom.smartIntercomBegin(smartIntercomConfig);
+
+  // SmartIntercom Restore settings saved before reboot (two-sector journal: the new sector is
+  // written before the old one is erased; the single EEPROM sector only without an FS region)
+  if (smartIntercomFlash.smartIntercomGetSectorCount() > 0) {
+    smartIntercomConfigStore.smartIntercomBegin(&smartIntercomFlash);
+    smartIntercomMigrateConfig();
+  } else {
+    smartIntercomConfigStore.smartIntercomBegin(&smartIntercomEepromFlash);
+  }
+  smartIntercom.smartIntercomAttachConfigStore(&smartIntercomConfigStore);
 
-  // SmartIntercom GPIO Initialization
-  Serial.println("SmartIntercom: Initializing GPIO controllers...");
-  smartIntercomDoorOpenController = new SmartIntercomGPIOController(SMARTINTERCOM_DOOR_OPEN_PIN);
-  smartIntercomHandsetController = new SmartIntercomGPIOController(SMARTINTERCOM_HANDSET_PIN);
-  smartIntercomLedController = new SmartIntercomGPIOController(SMARTINTERCOM_LED_PIN);
-  smartIntercomRelayController = new SmartIntercomGPIOController(SMARTINTERCOM_RELAY_PIN);
+  // SmartIntercom Statistics (snapshots in the last two sectors of the unused FS region)
+  smartIntercomStats.smartIntercomBegin(&smartIntercomStatsFlash);
+  smartIntercom.smartIntercomAttachStats(&smartIntercomStats);
+  smartIntercom.smartIntercomAttachMetrics(&smartIntercomMetrics);
 
-  // SmartIntercom Ring Detector Initialization
-  Serial.println("SmartIntercom: Initializing ring detector...");
-  smartIntercomRingDetector = new SmartIntercomRingDetector(SMARTINTERCOM_DOORBELL_PIN);
+  // SmartIntercom ADC Trace (16 sectors before the stats ones, started via POST /api/trace)
+  smartIntercomTrace.smartIntercomBegin(&smartIntercomTraceFlashGuard);
+  smartIntercom.smartIntercomAttachTrace(&smartIntercomTrace);
 
-  // SmartIntercom WiFi Setup
+  smartIntercom.smartIntercomEnableRingSampling(SMARTINTERCOM_RING_SAMPLE_PERIOD_US);
+  smartIntercomRelay.smartIntercomBegin();
+
+  // SmartIntercom Loop Watchdog (samples on the ring sampling timer)
+  smartIntercomSetupWatchdog();
+
+  // SmartIntercom WiFi Setup (returns at once, the station connects from loop())
   smartIntercomSetupWiFi();
 
   // SmartIntercom Web Server Setup
   smartIntercomSetupWebServer();
 
-  // SmartIntercom Startup Indication
-  smartIntercomLedController->smartIntercomBlink(3, 200, 200);
+  // SmartIntercom MQTT Setup
+  smartIntercomSetupMqtt();
 
-  Serial.println("SmartIntercom: Initialization complete!");
-  Serial.println("=================================\n");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Initialization complete!");
+  smartIntercomLogFlush();
+}
+
+// SmartIntercom Config Migration
+// Прежние прошивки вели журнал в одном секторе EEPROM: если в новом журнале
+// записей еще нет, последняя конфигурация оттуда переносится одной записью.
+void smartIntercomMigrateConfig() {
+  SmartIntercomConfig config = smartIntercom.smartIntercomGetConfig();
+  if (smartIntercomConfigStore.smartIntercomLoad(&config)) {
+    return;
+  }
+  SmartIntercomConfigStore legacyStore;
+  if (!legacyStore.smartIntercomBegin(&smartIntercomEepromFlash) || !legacyStore.smartIntercomLoad(&config)) {
+    return;
+  }
+  smartIntercomConfigStore.smartIntercomRequestSave(config);
+  if (smartIntercomConfigStore.smartIntercomCommit()) {
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Config journal moved from the EEPROM sector");
+  }
+}
+
+// SmartIntercom Watchdog Setup
+void smartIntercomSetupWatchdog() {
+  if (!SMARTINTERCOM_WATCHDOG_ENABLED) {
+    return;
+  }
+  smartIntercomWatchdog.smartIntercomSetBudget(SMARTINTERCOM_WATCHDOG_BUDGET);
+  smartIntercomWatchdog.smartIntercomSetTimeout(SMARTINTERCOM_WATCHDOG_TIMEOUT * 1000UL);
+  smartIntercomWatchdog.smartIntercomBegin(SMARTINTERCOM_RING_SAMPLE_PERIOD_US, SMARTINTERCOM_WATCHDOG_RTC_LOG);
+  // SmartIntercom Ticker callbacks also run inside delay()/yield() of a stuck phase
+  smartIntercomWatchdogTicker.attach_ms(1000, smartIntercomCheckWatchdog);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Loop watchdog, boot %lu, stall budget %lu ms",
+                         (unsigned long)smartIntercomWatchdog.smartIntercomGetBoots(),
+                         smartIntercomWatchdog.smartIntercomGetBudget());
+}
+
+// SmartIntercom Watchdog Check
+// Зависание уже в журнале RTC-памяти и переживет перезагрузку
+void smartIntercomCheckWatchdog() {
+  if (smartIntercomWatchdog.smartIntercomIsExpired()) {
+    ESP.restart();
+  }
 }
 
 // SmartIntercom WiFi Setup
 void smartIntercomSetupWiFi() {
-  Serial.println("SmartIntercom: Setting up WiFi...");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Setting up WiFi...");
+
+  // SmartIntercom Status follows the station link without polling WiFi.status()
+  smartIntercomWifiGotIPHandler = WiFi.onStationModeGotIP(smartIntercomHandleWifiGotIP);
+  smartIntercomWifiDisconnectedHandler = WiFi.onStationModeDisconnected(smartIntercomHandleWifiDisconnected);
 
   // SmartIntercom Access Point Mode
   WiFi.mode(WIFI_AP_STA);
   WiFi.softAP(SMARTINTERCOM_NAME, "smartintercom123");
 
-  Serial.print("SmartIntercom AP IP: ");
-  Serial.println(WiFi.softAPIP());
-
-  // SmartIntercom Station Mode (if configured)
-  if (smartIntercomWifiSSID.length() > 0) {
-    WiFi.begin(smartIntercomWifiSSID.c_str(), smartIntercomWifiPassword.c_str());
-    Serial.print("SmartIntercom: Connecting to WiFi");
-
-    int smartIntercomWifiAttempts = 0;
-    while (WiFi.status() != WL_CONNECTED && smartIntercomWifiAttempts < 20) {
-      delay(500);
-      Serial.print(".");
-      smartIntercomWifiAttempts++;
-    }
-
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.println("\nSmartIntercom: WiFi connected!");
-      Serial.print("SmartIntercom IP: ");
-      Serial.println(WiFi.localIP());
-    } else {
-      Serial.println("\nSmartIntercom: WiFi connection failed");
-    }
-  }
+  IPAddress smartIntercomApIP = WiFi.softAPIP();
+  SMARTINTERCOM_LOG_INFO("SmartIntercom AP IP: %u.%u.%u.%u",
+                         smartIntercomApIP[0], smartIntercomApIP[1], smartIntercomApIP[2], smartIntercomApIP[3]);
+
+  // SmartIntercom Station Mode (if configured): the first attempt starts here, loop() follows it
+  // and reconnects with backoff; the cached AP lets the connect after a reboot skip the scan
+  smartIntercomWifi.smartIntercomAttachMetrics(&smartIntercomMetrics);
+  smartIntercomWifi.smartIntercomBegin(&smartIntercomWifiLink, smartIntercomWifiSSID.c_str(),
+                                       smartIntercomWifiPassword.c_str(), &smartIntercomWifiFlashGuard);
 
   // SmartIntercom mDNS Setup
   if (MDNS.begin(SMARTINTERCOM_NAME)) {
-    Serial.println("SmartIntercom: mDNS responder started");
-    Serial.print("SmartIntercom: Access via http://");
-    Serial.print(SMARTINTERCOM_NAME);
-    Serial.println(".local");
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: mDNS responder started, access via http://%s.local", SMARTINTERCOM_NAME);
   }
 }
 
 // SmartIntercom Web Server Setup
 void smartIntercomSetupWebServer() {
-  Serial.println("SmartIntercom: Setting up web server...");
-
-  // SmartIntercom Main Page
-  smartIntercomWebServer.on("/", HTTP_GET, smartIntercomHandleRoot);
-
-  // SmartIntercom API Endpoints
-  smartIntercomWebServer.on("/api/status", HTTP_GET, smartIntercomHandleStatus);
-  smartIntercomWebServer.on("/api/open", HTTP_POST, smartIntercomHandleOpenDoor);
-  smartIntercomWebServer.on("/api/config", HTTP_GET, smartIntercomHandleGetConfig);
-  smartIntercomWebServer.on("/api/config", HTTP_POST, smartIntercomHandleSetConfig);
-  smartIntercomWebServer.on("/api/auto-open", HTTP_POST, smartIntercomHandleAutoOpen);
-
-  smartIntercomWebServer.begin();
-  Serial.println("SmartIntercom: Web server started on port 80");
-}
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Setting up web server...");
 
-// SmartIntercom Root Handler
-void smartIntercomHandleRoot() {
-  String html = "<!DOCTYPE html><html><head>";
-  html += "<meta charset='utf-8'>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-  html += "<title>SmartIntercom Premium</title>";
-  html += "<style>";
-  html += "body{font-family:Arial,sans-serif;max-width:800px;margin:0 auto;padding:20px;background:#f0f0f0}";
-  html += "h1{color:#2c3e50;text-align:center}";
-  html += ".card{background:white;padding:20px;margin:10px 0;border-radius:8px;box-shadow:0 2px 4px rgba(0,0,0,0.1)}";
-  html += "button{background:#3498db;color:white;border:none;padding:10px 20px;border-radius:5px;cursor:pointer;margin:5px}";
-  html += "button:hover{background:#2980b9}";
-  html += ".status{font-size:18px;margin:10px 0}";
-  html += "</style></head><body>";
-  html += "<h1>🏠 SmartIntercom Premium</h1>";
-  html += "<div class='card'>";
-  html += "<h2>Управление SmartIntercom</h2>";
-  html += "<div class='status'>Статус: <span id='status'>Загрузка...</span></div>";
-  html += "<button onclick='openDoor()'>Открыть дверь</button>";
-  html += "<button onclick='toggleAutoOpen()'>Авто-открытие</button>";
-  html += "</div>";
-  html += "<div class='card'>";
-  html += "<h2>О SmartIntercom</h2>";
-  html += "<p>SmartIntercom Premium - это умный адаптер для домофонов с расширенными возможностями автоматизации.</p>";
-  html += "<p>Версия SmartIntercom: " + String(SMARTINTERCOM_VERSION) + "</p>";
-  html += "</div>";
-  html += "<script>";
-  html += "function openDoor(){fetch('/api/open',{method:'POST'}).then(r=>r.json()).then(d=>alert('SmartIntercom: '+d.message))}";
-  html += "function toggleAutoOpen(){fetch('/api/auto-open',{method:'POST'}).then(r=>r.json()).then(d=>alert('SmartIntercom: '+d.message))}";
-  html += "setInterval(()=>{fetch('/api/status').then(r=>r.json()).then(d=>document.getElementById('status').innerText=d.state)},1000);";
-  html += "</script></body></html>";
-
-  smartIntercomWebServer.send(200, "text/html", html);
-}
-
-// SmartIntercom Status Handler
-void smartIntercomHandleStatus() {
-  StaticJsonDocument<200> smartIntercomJson;
-  smartIntercomJson["device"] = SMARTINTERCOM_NAME;
-  smartIntercomJson["version"] = SMARTINTERCOM_VERSION;
-  smartIntercomJson["state"] = smartIntercomGetStateName();
-  smartIntercomJson["auto_open"] = smartIntercomAutoOpenEnabled;
-  smartIntercomJson["wifi_connected"] = WiFi.status() == WL_CONNECTED;
-
-  String smartIntercomResponse;
-  serializeJson(smartIntercomJson, smartIntercomResponse);
-  smartIntercomWebServer.send(200, "application/json", smartIntercomResponse);
-}
-
-// SmartIntercom Open Door Handler
-void smartIntercomHandleOpenDoor() {
-  Serial.println("SmartIntercom: Manual door open requested via API");
-  smartIntercomOpenDoor();
-
-  StaticJsonDocument<100> smartIntercomJson;
-  smartIntercomJson["success"] = true;
-  smartIntercomJson["message"] = "SmartIntercom открыл дверь";
+  if (!smartIntercomWebServer.smartIntercomBegin(&smartIntercomHttpTransport, 80)) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Web server failed to start");
+    return;
+  }
+  smartIntercomWebServer.smartIntercomSetServiceHistogram(
+    &smartIntercomMetrics.smartIntercomGetHistogram(SMARTINTERCOM_METRIC_REQUEST_TIME));
 
-  String smartIntercomResponse;
-  serializeJson(smartIntercomJson, smartIntercomResponse);
-  smartIntercomWebServer.send(200, "application/json", smartIntercomResponse);
-}
+  // SmartIntercom Main Page
+  smartIntercomWebServer.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/", smartIntercomHandleRoot);
+
+  // SmartIntercom API Endpoints (/api/status, /api/events, /api/open, /api/config, /api/auto-open,
+  // /api/stats, /api/metrics)
+  smartIntercomApi.smartIntercomBegin(smartIntercom, smartIntercomWebServer, SMARTINTERCOM_NAME, SMARTINTERCOM_VERSION);
+  smartIntercomApi.smartIntercomSetWifiProbe(smartIntercomIsWifiConnected, nullptr);
+  smartIntercomApi.smartIntercomAttachTrace(smartIntercomTrace);
+  if (SMARTINTERCOM_WATCHDOG_ENABLED) {
+    smartIntercomApi.smartIntercomAttachWatchdog(smartIntercomWatchdog);
+  }
+  smartIntercomApi.smartIntercomAttachHeap(smartIntercomHeap);
 
-// SmartIntercom Get Config Handler
-void smartIntercomHandleGetConfig() {
-  StaticJsonDocument<300> smartIntercomJson;
-  smartIntercomJson["auto_open"] = smartIntercomAutoOpenEnabled;
-  smartIntercomJson["always_open"] = smartIntercomAlwaysOpenEnabled;
-  smartIntercomJson["open_delay"] = smartIntercomOpenDelay;
-  smartIntercomJson["led_brightness"] = smartIntercomLedBrightness;
-
-  String smartIntercomResponse;
-  serializeJson(smartIntercomJson, smartIntercomResponse);
-  smartIntercomWebServer.send(200, "application/json", smartIntercomResponse);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Web server started on port 80");
 }
 
-// SmartIntercom Set Config Handler
-void smartIntercomHandleSetConfig() {
-  if (smartIntercomWebServer.hasArg("plain")) {
-    StaticJsonDocument<300> smartIntercomJson;
-    deserializeJson(smartIntercomJson, smartIntercomWebServer.arg("plain"));
-
-    if (smartIntercomJson.containsKey("auto_open")) {
-      smartIntercomAutoOpenEnabled = smartIntercomJson["auto_open"];
-    }
-    if (smartIntercomJson.containsKey("always_open")) {
-      smartIntercomAlwaysOpenEnabled = smartIntercomJson["always_open"];
-    }
-    if (smartIntercomJson.containsKey("open_delay")) {
-      smartIntercomOpenDelay = smartIntercomJson["open_delay"];
-    }
-    if (smartIntercomJson.containsKey("led_brightness")) {
-      smartIntercomLedBrightness = smartIntercomJson["led_brightness"];
-    }
-
-    Serial.println("SmartIntercom: Configuration updated");
-    smartIntercomWebServer.send(200, "application/json", "{\"success\":true,\"message\":\"SmartIntercom конфигурация обновлена\"}");
-  } else {
-    smartIntercomWebServer.send(400, "application/json", "{\"success\":false,\"message\":\"SmartIntercom: неверный запрос\"}");
+// SmartIntercom MQTT Setup
+// Клиент подключается к брокеру сам из loop() и переподключается после обрывов
+void smartIntercomSetupMqtt() {
+  if (!SMARTINTERCOM_MQTT_ENABLED) {
+    return;
   }
+  SmartIntercomMqttSettings smartIntercomMqttSettings;
+  smartIntercomMqttSettings.server = SMARTINTERCOM_MQTT_SERVER;
+  smartIntercomMqttSettings.port = SMARTINTERCOM_MQTT_PORT;
+  smartIntercomMqttSettings.user = SMARTINTERCOM_MQTT_USER;
+  smartIntercomMqttSettings.password = SMARTINTERCOM_MQTT_PASSWORD;
+  smartIntercomMqttSettings.clientId = SMARTINTERCOM_NAME;
+  smartIntercomMqttSettings.topicStatus = SMARTINTERCOM_MQTT_TOPIC_STATUS;
+  smartIntercomMqttSettings.topicEvents = SMARTINTERCOM_MQTT_TOPIC_EVENTS;
+  smartIntercomMqttSettings.topicCommands = SMARTINTERCOM_MQTT_TOPIC_COMMANDS;
+  smartIntercomMqttSettings.qos = SMARTINTERCOM_MQTT_QOS;
+  smartIntercomMqttSettings.retain = SMARTINTERCOM_MQTT_RETAIN;
+  smartIntercomMqttSettings.keepAliveS = SMARTINTERCOM_MQTT_KEEPALIVE_S;
+  smartIntercomMqtt.smartIntercomBegin(smartIntercom, &smartIntercomMqttTransport, smartIntercomMqttSettings);
+  smartIntercomMqttActive = true;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: MQTT enabled for %s", SMARTINTERCOM_MQTT_SERVER);
 }
 
-// SmartIntercom Auto Open Handler
-void smartIntercomHandleAutoOpen() {
-  smartIntercomAutoOpenEnabled = !smartIntercomAutoOpenEnabled;
-
-  StaticJsonDocument<100> smartIntercomJson;
-  smartIntercomJson["success"] = true;
-  smartIntercomJson["auto_open"] = smartIntercomAutoOpenEnabled;
-  smartIntercomJson["message"] = smartIntercomAutoOpenEnabled ?
-    "SmartIntercom: авто-открытие включено" : "SmartIntercom: авто-открытие выключено";
-
-  String smartIntercomResponse;
-  serializeJson(smartIntercomJson, smartIntercomResponse);
-  smartIntercomWebServer.send(200, "application/json", smartIntercomResponse);
+// SmartIntercom Root Handler
+// Страница хранится во флеш-памяти уже сжатой (web/index.html, tools/smartintercom_webui.py)
+// и отдается частями прямо из PROGMEM; версия и состояние приходят через /api/status.
+void smartIntercomHandleRoot(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                             void* context) {
+  (void)request;
+  (void)context;
+  response.smartIntercomAddHeader("Content-Encoding", "gzip");
+  response.smartIntercomSendStatic(200, "text/html; charset=utf-8", SMARTINTERCOM_WEB_PAGE_GZ,
+                                   SMARTINTERCOM_WEB_PAGE_GZ_LENGTH, true);
 }
 
-// SmartIntercom Get State Name
-String smartIntercomGetStateName() {
-  switch (smartIntercomCurrentState) {
-    case SMARTINTERCOM_IDLE: return "Ожидание";
-    case SMARTINTERCOM_RINGING: return "Звонок";
-    case SMARTINTERCOM_OPENING: return "Открытие";
-    case SMARTINTERCOM_OPEN: return "Открыто";
-    case SMARTINTERCOM_ERROR: return "Ошибка";
-    default: return "Неизвестно";
-  }
+// SmartIntercom WiFi Probe
+bool smartIntercomIsWifiConnected(void* context) {
+  (void)context;
+  return WiFi.status() == WL_CONNECTED;
 }
 
-// SmartIntercom Open Door Function
-void smartIntercomOpenDoor() {
-  Serial.println("SmartIntercom: Opening door...");
-  smartIntercomCurrentState = SMARTINTERCOM_OPENING;
-
-  // SmartIntercom LED indication for opening
-  smartIntercomLedController->smartIntercomSetState(true);
+// ============================================================================
+// SmartIntercom Live Status
+// ============================================================================
 
-  // SmartIntercom Door open pulse
-  smartIntercomDoorOpenController->smartIntercomPulse(SMARTINTERCOM_DOOR_OPEN_TIME);
-
-  smartIntercomCurrentState = SMARTINTERCOM_OPEN;
-  smartIntercomDoorOpenTime = millis();
-
-  Serial.println("SmartIntercom: Door opened");
+// SmartIntercom WiFi Station Handlers
+// Только будят loop(): попытки, метрики подключения и запомненную точку ведет smartIntercomWifi
+void smartIntercomHandleWifiGotIP(const WiFiEventStationModeGotIP& event) {
+  (void)event;
+  smartIntercomApi.smartIntercomMarkChanged();
+  smartIntercomWake();
 }
 
-// SmartIntercom Process Ring
-void smartIntercomProcessRing() {
-  Serial.println("SmartIntercom: Processing ring...");
-  smartIntercomCurrentState = SMARTINTERCOM_RINGING;
-  smartIntercomLastRingTime = millis();
-
-  // SmartIntercom LED blink on ring
-  smartIntercomLedController->smartIntercomBlink(2, 100, 100);
-
-  // SmartIntercom Auto-open logic
-  if (smartIntercomAutoOpenEnabled || smartIntercomAlwaysOpenEnabled) {
-    Serial.println("SmartIntercom: Auto-open triggered");
-    if (smartIntercomOpenDelay > 0) {
-      Serial.print("SmartIntercom: Delaying open for ");
-      Serial.print(smartIntercomOpenDelay);
-      Serial.println(" ms");
-      delay(smartIntercomOpenDelay);
-    }
-    smartIntercomOpenDoor();
-
-    // SmartIntercom Disable auto-open after one use (if not always-open)
-    if (!smartIntercomAlwaysOpenEnabled) {
-      smartIntercomAutoOpenEnabled = false;
-      Serial.println("SmartIntercom: Auto-open disabled after use");
-    }
-  }
+void smartIntercomHandleWifiDisconnected(const WiFiEventStationModeDisconnected& event) {
+  (void)event;
+  smartIntercomApi.smartIntercomMarkChanged();
+  smartIntercomWake();
 }
 
 // SmartIntercom Main Loop
 void loop() {
-  // SmartIntercom Handle web requests
-  smartIntercomWebServer.handleClient();
+  // SmartIntercom Sleep until a socket is ready, the ring sampler wakes us or the next library
+  // deadline, then serve every connection that has data or room to write (the sleep itself is
+  // marked idle inside smartIntercomIdleWait)
+  unsigned long smartIntercomIdleMs = smartIntercom.smartIntercomGetIdleTime(SMARTINTERCOM_LOOP_IDLE_MS);
+  if (smartIntercomMqttActive) {
+    smartIntercomIdleMs = smartIntercomMqtt.smartIntercomGetIdleTime(smartIntercomIdleMs);
+  }
+  smartIntercomIdleMs = smartIntercomWifi.smartIntercomGetIdleTime(smartIntercomIdleMs);
+  smartIntercomIdleMs = smartIntercomHeap.smartIntercomGetIdleTime(smartIntercomIdleMs);
+  smartIntercomMarkPhase(SMARTINTERCOM_PHASE_HTTP);
+  smartIntercomWebServer.smartIntercomRun(smartIntercomIdleMs);
+  smartIntercomMarkPhase(SMARTINTERCOM_PHASE_MDNS);
   MDNS.update();
 
-  // SmartIntercom Check for ring
-  if (smartIntercomRingDetector->smartIntercomIsRinging()) {
-    smartIntercomProcessRing();
-  }
+  // SmartIntercom Ring detection, door and LED jobs, state timeouts (marks update and callback itself)
+  smartIntercom.smartIntercomUpdate();
 
-  // SmartIntercom Update state based on time
-  if (smartIntercomCurrentState == SMARTINTERCOM_RINGING &&
-      millis() - smartIntercomLastRingTime > SMARTINTERCOM_RING_TIMEOUT) {
-    smartIntercomCurrentState = SMARTINTERCOM_IDLE;
-    smartIntercomLedController->smartIntercomSetState(false);
-    Serial.println("SmartIntercom: Ring timeout, returning to idle");
-  }
+  // SmartIntercom WiFi attempts, timeouts and reconnects
+  smartIntercomMarkPhase(SMARTINTERCOM_PHASE_WIFI);
+  smartIntercomWifi.smartIntercomUpdate();
+
+  // SmartIntercom Push status changes to live subscribers
+  smartIntercomMarkPhase(SMARTINTERCOM_PHASE_API);
+  smartIntercomApi.smartIntercomUpdate();
+
+  // SmartIntercom Heap series sample (free, largest block, fragmentation) once a period
+  smartIntercomHeap.smartIntercomUpdate();
 
-  if (smartIntercomCurrentState == SMARTINTERCOM_OPEN &&
-      millis() - smartIntercomDoorOpenTime > SMARTINTERCOM_DOOR_OPEN_TIME + 1000) {
-    smartIntercomCurrentState = SMARTINTERCOM_IDLE;
-    smartIntercomLedController->smartIntercomSetState(false);
-    Serial.println("SmartIntercom: Door closed, returning to idle");
+  // SmartIntercom MQTT: queued events and status out, commands in
+  if (smartIntercomMqttActive) {
+    smartIntercomMarkPhase(SMARTINTERCOM_PHASE_MQTT);
+    smartIntercomMqtt.smartIntercomUpdate();
   }
 
-  // SmartIntercom Small delay for stability
-  delay(10);
+  // SmartIntercom The core and SDK run between passes
+  smartIntercomMarkPhase(SMARTINTERCOM_PHASE_IDLE);
 }
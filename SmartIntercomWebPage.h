@@ -0,0 +1,88 @@
+/*
+ * SmartIntercomWebPage.h - Сжатая веб-страница SmartIntercom
+ *
+ * Сгенерировано tools/smartintercom_webui.py из web/index.html, не редактировать.
+ * Исходник: 3343 байт, после минификации: 2315 байт, gzip: 1108 байт.
+ */
+
+#ifndef SMARTINTERCOM_WEB_PAGE_H
+#define SMARTINTERCOM_WEB_PAGE_H
+
+#include <Arduino.h>
+
+#define SMARTINTERCOM_WEB_PAGE_GZ_LENGTH 1108
+
+static const uint8_t SMARTINTERCOM_WEB_PAGE_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x56, 0xcb, 0x6e, 0xdb, 0x46,
+  0x14, 0xdd, 0xfb, 0x2b, 0xa6, 0xf2, 0x82, 0x14, 0x2a, 0x52, 0x8f, 0x24, 0x80, 0x4c, 0x3d, 0x8a,
+  0xb4, 0xf1, 0x22, 0x45, 0x51, 0x1b, 0xb0, 0x37, 0x45, 0x51, 0x14, 0x23, 0x72, 0x24, 0x4e, 0x4d,
+  0x72, 0x88, 0x99, 0xa1, 0x64, 0x57, 0x11, 0x10, 0x3b, 0x45, 0x5b, 0x20, 0x69, 0x5d, 0x74, 0xd3,
+  0x5d, 0xda, 0xa2, 0x3f, 0x60, 0xb8, 0x71, 0xe3, 0x3a, 0xb1, 0xf2, 0x0b, 0xc3, 0x3f, 0xe9, 0x27,
+  0xf4, 0x0e, 0xa9, 0xc8, 0xa4, 0xad, 0x04, 0xd9, 0x04, 0x02, 0x35, 0x8f, 0x7b, 0xef, 0xb9, 0xe7,
+  0x3e, 0x66, 0xc8, 0xee, 0x07, 0xf7, 0xb6, 0x3e, 0xd9, 0xfd, 0x62, 0x7b, 0x13, 0xf9, 0x32, 0x0c,
+  0xfa, 0xdd, 0xc5, 0x3f, 0xc1, 0x5e, 0xbf, 0x1b, 0x12, 0x89, 0x91, 0xeb, 0x63, 0x2e, 0x88, 0xec,
+  0x55, 0x12, 0x39, 0xb4, 0xda, 0x95, 0xc5, 0x6e, 0x84, 0x43, 0xd2, 0xab, 0x8c, 0x29, 0x99, 0xc4,
+  0x8c, 0xcb, 0x0a, 0x72, 0x59, 0x24, 0x49, 0x04, 0x5a, 0x13, 0xea, 0x49, 0xbf, 0xe7, 0x91, 0x31,
+  0x75, 0x89, 0x95, 0x2d, 0x6a, 0x88, 0x46, 0x54, 0x52, 0x1c, 0x58, 0xc2, 0xc5, 0x01, 0xe9, 0x35,
+  0x01, 0x43, 0x52, 0x19, 0x90, 0xfe, 0x4e, 0x88, 0xb9, 0xbc, 0x0f, 0x86, 0xdc, 0x65, 0x21, 0xda,
+  0xe6, 0x24, 0xa4, 0x49, 0xd8, 0xad, 0xe7, 0xc2, 0xae, 0x90, 0x07, 0x30, 0x0c, 0x98, 0x77, 0x30,
+  0x1d, 0x02, 0xba, 0x35, 0xc4, 0x21, 0x0d, 0x0e, 0x9c, 0xbb, 0x1c, 0xa0, 0x6a, 0x02, 0x47, 0xc2,
+  0x12, 0x84, 0xd3, 0x61, 0x27, 0xc4, 0xfb, 0xb9, 0x23, 0xa7, 0xdd, 0x68, 0xc4, 0xfb, 0xb0, 0xe6,
+  0x23, 0x1a, 0x39, 0x0d, 0x84, 0x13, 0xc9, 0x3a, 0x31, 0xf6, 0x3c, 0x1a, 0x8d, 0x9c, 0x96, 0x16,
+  0x0d, 0xb0, 0xbb, 0x37, 0xe2, 0x2c, 0x89, 0x3c, 0x67, 0x7d, 0xd8, 0xd0, 0xbf, 0x99, 0xdf, 0x9c,
+  0xba, 0x2c, 0x60, 0xdc, 0x59, 0x6f, 0xb9, 0xb7, 0xc8, 0x9d, 0x46, 0x47, 0x92, 0x7d, 0x69, 0xe1,
+  0x80, 0x8e, 0x22, 0xc7, 0x25, 0x9a, 0xdb, 0xcc, 0x76, 0x31, 0xf7, 0xa6, 0x05, 0xdb, 0x89, 0x4f,
+  0x25, 0x29, 0x23, 0x2f, 0x9c, 0x36, 0x61, 0x8e, 0x1a, 0x9d, 0x01, 0xe3, 0x1e, 0xe1, 0x16, 0xc7,
+  0x1e, 0x4d, 0x84, 0xd3, 0xd6, 0x9e, 0xd9, 0xbe, 0x25, 0x7c, 0xec, 0xb1, 0x09, 0x10, 0x6b, 0x81,
+  0xd2, 0x6d, 0x78, 0xf8, 0x68, 0x80, 0xcd, 0x46, 0x2d, 0xfb, 0xd9, 0xcd, 0xea, 0x6c, 0x90, 0x48,
+  0xc9, 0xa2, 0xa2, 0xa7, 0xf5, 0x5b, 0xb7, 0x37, 0xda, 0xde, 0xa0, 0x93, 0x53, 0xcc, 0xfd, 0xe6,
+  0xe0, 0x4e, 0xc4, 0xa2, 0x2b, 0x0e, 0x99, 0xdf, 0x3c, 0xc4, 0x92, 0xeb, 0x3b, 0xb0, 0xe3, 0x26,
+  0x5c, 0x80, 0x71, 0xcc, 0xa8, 0x8e, 0xe6, 0x35, 0x53, 0x90, 0x2c, 0xfc, 0x39, 0x3e, 0x1b, 0x13,
+  0x5e, 0xf2, 0xda, 0xda, 0x68, 0x37, 0x06, 0x1b, 0x33, 0x5b, 0x48, 0x2c, 0x13, 0x91, 0xa7, 0x5f,
+  0xd0, 0x6f, 0x89, 0xd3, 0x6c, 0x5f, 0x8f, 0x75, 0xd6, 0xad, 0xe7, 0x85, 0xea, 0xd6, 0xf3, 0xa6,
+  0xd1, 0x05, 0x83, 0x06, 0x6a, 0xf6, 0xff, 0xfb, 0xfd, 0xf8, 0x0f, 0xf4, 0x86, 0x12, 0x83, 0xb8,
+  0xeb, 0xd1, 0x31, 0x72, 0x03, 0x2c, 0x44, 0xaf, 0xa2, 0x13, 0x0c, 0x5d, 0xe1, 0xb7, 0xfa, 0xea,
+  0x2f, 0xf5, 0x2a, 0x7d, 0xa8, 0x4e, 0xd4, 0xa9, 0x7a, 0xa1, 0xce, 0xd4, 0xa5, 0x3a, 0x57, 0x67,
+  0x65, 0x10, 0x30, 0x6e, 0x95, 0x8c, 0x73, 0x92, 0x95, 0xbe, 0xfa, 0x33, 0x3d, 0x52, 0x27, 0xe9,
+  0x51, 0xfa, 0x28, 0x3d, 0x74, 0x50, 0x57, 0xc4, 0x38, 0x42, 0xd4, 0x2b, 0xc8, 0x7f, 0x03, 0xd8,
+  0xbf, 0xd3, 0x87, 0xe9, 0x23, 0xf5, 0x5c, 0x5d, 0xa8, 0x13, 0xdb, 0xb6, 0x81, 0x3b, 0x68, 0x01,
+  0x75, 0x80, 0x5b, 0x8d, 0xf9, 0x8b, 0x3a, 0x05, 0xd4, 0xb9, 0xa5, 0xe6, 0x30, 0x5c, 0x80, 0xf1,
+  0x63, 0x18, 0x81, 0x53, 0xd1, 0x81, 0xee, 0xb3, 0xaf, 0x59, 0x4c, 0xa2, 0x4a, 0xdf, 0x2a, 0x23,
+  0xe6, 0x09, 0x46, 0x2c, 0x72, 0x03, 0xea, 0xee, 0xf5, 0x2a, 0x5a, 0xe9, 0x1e, 0x63, 0xdc, 0xac,
+  0x02, 0xf4, 0xd3, 0x2b, 0xc4, 0xf4, 0x09, 0x52, 0xcf, 0x20, 0xe4, 0x33, 0x58, 0x3e, 0xe9, 0xd6,
+  0x73, 0xb3, 0x9b, 0xe6, 0x92, 0x8d, 0x46, 0x01, 0xb9, 0x0b, 0xee, 0xb6, 0x00, 0x28, 0x03, 0x79,
+  0x13, 0xbf, 0x2b, 0x90, 0x1b, 0xb1, 0x15, 0x92, 0xfd, 0x74, 0x55, 0x6a, 0xe3, 0xd5, 0xe7, 0x12,
+  0x59, 0x28, 0xfd, 0x49, 0xfb, 0x42, 0x90, 0xc0, 0x97, 0xea, 0x32, 0x7d, 0xac, 0xfe, 0x45, 0x90,
+  0xd1, 0x67, 0xf0, 0xbc, 0x82, 0x7d, 0xe0, 0xae, 0x83, 0x78, 0x91, 0x1e, 0xeb, 0x61, 0x0e, 0x2a,
+  0xf3, 0xf4, 0x3b, 0x18, 0x2f, 0xe1, 0x39, 0x45, 0xe9, 0x21, 0xd2, 0x65, 0x4d, 0x0f, 0xd3, 0x1f,
+  0xd5, 0x39, 0xcc, 0x74, 0x69, 0x35, 0xc4, 0x4b, 0x75, 0x8e, 0x20, 0xf0, 0x39, 0x94, 0x04, 0x0c,
+  0xd4, 0x3f, 0x5a, 0x1d, 0x94, 0x8e, 0xd2, 0xe3, 0x5c, 0x74, 0x92, 0xc7, 0x07, 0x8b, 0x93, 0x2c,
+  0xb0, 0xe7, 0x30, 0x7e, 0x0f, 0xe3, 0x39, 0xd4, 0x2e, 0xd6, 0x5c, 0xd5, 0xaf, 0x59, 0xd6, 0x0e,
+  0x01, 0xf5, 0xb8, 0x1c, 0x4d, 0xb1, 0x44, 0xd0, 0xe0, 0x82, 0xb2, 0x52, 0x81, 0xe2, 0xd7, 0xa9,
+  0x11, 0x2e, 0xa7, 0xb1, 0xec, 0x0f, 0x93, 0xc8, 0x95, 0x54, 0xa7, 0x7b, 0x59, 0x24, 0x34, 0x5d,
+  0x1b, 0x12, 0xe9, 0xfa, 0xa6, 0x51, 0xc7, 0x31, 0xad, 0x6b, 0x81, 0x51, 0x43, 0x53, 0xb8, 0x00,
+  0x7d, 0xe6, 0x39, 0xc8, 0xd8, 0xde, 0xda, 0xd9, 0x35, 0x66, 0x55, 0x5b, 0xfa, 0x50, 0x0d, 0x8e,
+  0x7a, 0x7d, 0xc4, 0xed, 0x6f, 0x04, 0x83, 0xca, 0x2c, 0xf6, 0x3c, 0xbd, 0x07, 0x77, 0x1e, 0x97,
+  0xa6, 0x71, 0x8d, 0x9b, 0x81, 0x3e, 0x44, 0x9e, 0x1d, 0x12, 0x21, 0xf0, 0x88, 0x54, 0xab, 0x9d,
+  0xb5, 0xd9, 0xda, 0x92, 0xc1, 0xf5, 0x3a, 0x5f, 0xe3, 0xa1, 0xfb, 0xcd, 0x7a, 0xdf, 0x64, 0xc6,
+  0x98, 0x23, 0x51, 0xd4, 0xda, 0xc9, 0x8e, 0x04, 0xea, 0xa1, 0xe9, 0xac, 0x73, 0x45, 0x95, 0x93,
+  0x08, 0xae, 0x9b, 0x5c, 0x66, 0x7a, 0x19, 0x53, 0xc6, 0x91, 0xa9, 0xad, 0xf7, 0xc8, 0x01, 0xdc,
+  0xfc, 0x08, 0x36, 0x57, 0xe0, 0x7c, 0x09, 0xd2, 0xaf, 0x00, 0xcc, 0xcb, 0x26, 0x9d, 0x35, 0x8f,
+  0xb9, 0x49, 0x08, 0xd7, 0xad, 0x3d, 0x22, 0x72, 0x33, 0x20, 0x7a, 0xfa, 0xf1, 0xc1, 0x7d, 0xcf,
+  0x34, 0xf2, 0x93, 0x68, 0x54, 0x6d, 0x1a, 0x45, 0x84, 0xef, 0xc2, 0xe5, 0x0c, 0x56, 0x2b, 0x00,
+  0xb3, 0xbb, 0x8a, 0xa0, 0x07, 0x0f, 0x90, 0x61, 0x19, 0x6f, 0xc1, 0x5b, 0x1e, 0xd6, 0x77, 0x80,
+  0x5c, 0xea, 0xa2, 0x8f, 0x90, 0x01, 0x5d, 0x7a, 0x01, 0xdd, 0xfd, 0x73, 0xfa, 0x43, 0xd6, 0xbc,
+  0x73, 0x03, 0x39, 0x7a, 0x13, 0x7a, 0xb8, 0xbc, 0xfd, 0x16, 0xdf, 0x8b, 0x2e, 0x7c, 0x07, 0xcf,
+  0x0b, 0xcd, 0x65, 0x38, 0x85, 0xe6, 0x48, 0x62, 0x0f, 0x02, 0x5d, 0x64, 0xfc, 0x7a, 0x6b, 0x2c,
+  0xb3, 0xf5, 0xc6, 0x2e, 0x28, 0x16, 0x2c, 0x2b, 0x34, 0x1d, 0x22, 0x73, 0x42, 0x23, 0x78, 0x33,
+  0xd9, 0x9b, 0x63, 0xa0, 0xba, 0xc3, 0x12, 0xee, 0x12, 0x0d, 0x7c, 0xa3, 0x05, 0x32, 0xb9, 0x6e,
+  0x81, 0x88, 0x4c, 0x50, 0x41, 0x79, 0xe1, 0x9c, 0x64, 0x62, 0x03, 0x50, 0x57, 0x58, 0xd9, 0xf0,
+  0xa6, 0xca, 0x66, 0x9f, 0x51, 0x01, 0x5f, 0x0a, 0x84, 0x2f, 0x4b, 0x5b, 0x43, 0xcb, 0xd8, 0x4c,
+  0xed, 0xb7, 0xdc, 0x53, 0x9f, 0xee, 0x6c, 0x7d, 0x6e, 0xc7, 0xfa, 0x13, 0xc4, 0x24, 0x36, 0x44,
+  0x8e, 0xa1, 0x3d, 0xd1, 0x4c, 0x33, 0x47, 0x24, 0x10, 0x04, 0x68, 0x96, 0x13, 0x02, 0xce, 0x49,
+  0xee, 0x7a, 0x8c, 0x03, 0xb3, 0x28, 0xab, 0xa1, 0x66, 0xa3, 0xd1, 0xd0, 0x96, 0x70, 0x07, 0xe4,
+  0x67, 0x1e, 0x6e, 0xc9, 0xec, 0x6d, 0x55, 0xcf, 0xbe, 0x7a, 0xfe, 0x07, 0x89, 0xa3, 0xad, 0x90,
+  0x0b, 0x09, 0x00, 0x00,
+};
+
+#endif // SMARTINTERCOM_WEB_PAGE_H
@@ -70,7 +70,10 @@
 #define SMARTINTERCOM_RING_TIMEOUT 30000       // Таймаут звонка SmartIntercom (мс)
 
 // SmartIntercom Ring Detection Threshold
-#define SMARTINTERCOM_RING_THRESHOLD 512       // Порог определения звонка SmartIntercom (0-1023)
+#define SMARTINTERCOM_RING_THRESHOLD 160       // Порог огибающей звонка SmartIntercom (отсчеты АЦП)
+
+// SmartIntercom Ring Tone Frequency (0 = без проверки тона)
+#define SMARTINTERCOM_RING_TONE 0              // Частота тона звонка SmartIntercom (Гц)
 
 // ============================================================================
 // Auto-Open Configuration for SmartIntercom
@@ -154,6 +157,10 @@
 // ============================================================================
 
 // SmartIntercom Serial Debug
+// SMARTINTERCOM_DEBUG_ENABLED и SMARTINTERCOM_LOG_LEVEL читает библиотека
+// (SmartIntercomLog.h), поэтому их нужно передавать флагами сборки,
+// например build_flags = -DSMARTINTERCOM_LOG_LEVEL=4 в PlatformIO.
+// Отключенные уровни не попадают в прошивку.
 #define SMARTINTERCOM_DEBUG_ENABLED true       // Включить отладку SmartIntercom
 #define SMARTINTERCOM_DEBUG_BAUD 115200        // Скорость Serial SmartIntercom
 
@@ -175,6 +182,9 @@
 // SmartIntercom Watchdog Timeout (seconds)
 #define SMARTINTERCOM_WATCHDOG_TIMEOUT 60      // Таймаут watchdog SmartIntercom (сек)
 
+// SmartIntercom Watchdog Stall Budget (milliseconds)
+#define SMARTINTERCOM_WATCHDOG_BUDGET 100      // Фаза loop() дольше - запись в журнал (мс)
+
 // SmartIntercom OTA Updates Enabled
 #define SMARTINTERCOM_OTA_ENABLED true         // Включить OTA обновления SmartIntercom
 
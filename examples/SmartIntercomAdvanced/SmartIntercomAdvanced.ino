@@ -25,6 +25,7 @@
 #include <ESP8266WebServer.h>
 #include <ESP8266mDNS.h>
 #include <ArduinoJson.h>
+#include "SmartIntercomWebPage.h"
 
 // SmartIntercom WiFi Configuration
 const char* SMARTINTERCOM_WIFI_SSID = "YourWiFiSSID";
@@ -76,6 +77,7 @@ void setup() {
   // SmartIntercom Initialization
   Serial.println("Инициализация SmartIntercom...");
   smartIntercom.smartIntercomBegin(smartIntercomConfig);
+  smartIntercom.smartIntercomEnableRingSampling();
 
   // SmartIntercom Event Callback
   smartIntercom.smartIntercomSetEventCallback(smartIntercomEventHandler);
@@ -104,7 +106,8 @@ void loop() {
   // SmartIntercom Uptime Counter
   smartIntercomUptime = millis();
 
-  delay(10);
+  // SmartIntercom ESP8266WebServer is polled, so sleep at most 10 ms (a ring wakes earlier)
+  smartIntercom.smartIntercomIdle(10);
 }
 
 // SmartIntercom WiFi Setup
@@ -186,8 +189,10 @@ void smartIntercomEventHandler(SmartIntercomEventType event, void* data) {
 
 // SmartIntercom Web Handlers
 void smartIntercomHandleRoot() {
-  String html = smartIntercomGetWebPage();
-  smartIntercomWebServer.send(200, "text/html", html);
+  // SmartIntercom Pre-gzipped page streamed from flash (see web/index.html)
+  smartIntercomWebServer.sendHeader(F("Content-Encoding"), F("gzip"));
+  smartIntercomWebServer.send_P(200, PSTR("text/html; charset=utf-8"), (PGM_P)SMARTINTERCOM_WEB_PAGE_GZ,
+                                SMARTINTERCOM_WEB_PAGE_GZ_LENGTH);
 }
 
 void smartIntercomHandleStatus() {
@@ -286,68 +291,3 @@ void smartIntercomHandleAutoOpen() {
   serializeJson(smartIntercomJson, response);
   smartIntercomWebServer.send(200, "application/json", response);
 }
-
-// SmartIntercom Web Page
-String smartIntercomGetWebPage() {
-  String html = "<!DOCTYPE html><html><head>";
-  html += "<meta charset='utf-8'>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-  html += "<title>SmartIntercom Premium Control Panel</title>";
-  html += "<style>";
-  html += "body{font-family:Arial,sans-serif;max-width:900px;margin:0 auto;padding:20px;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%)}";
-  html += ".container{background:white;padding:30px;border-radius:15px;box-shadow:0 10px 30px rgba(0,0,0,0.3)}";
-  html += "h1{color:#2c3e50;text-align:center;margin-bottom:30px}";
-  html += ".card{background:#f8f9fa;padding:20px;margin:15px 0;border-radius:10px;border-left:4px solid #667eea}";
-  html += "button{background:#667eea;color:white;border:none;padding:12px 24px;border-radius:6px;cursor:pointer;margin:5px;font-size:16px;transition:all 0.3s}";
-  html += "button:hover{background:#5568d3;transform:translateY(-2px);box-shadow:0 4px 8px rgba(0,0,0,0.2)}";
-  html += ".status{font-size:18px;margin:10px 0;padding:10px;background:white;border-radius:5px}";
-  html += ".stats{display:grid;grid-template-columns:repeat(auto-fit,minmax(200px,1fr));gap:15px;margin:20px 0}";
-  html += ".stat-item{background:white;padding:15px;border-radius:8px;text-align:center}";
-  html += ".stat-value{font-size:32px;font-weight:bold;color:#667eea}";
-  html += ".stat-label{color:#666;margin-top:5px}";
-  html += "</style></head><body>";
-  html += "<div class='container'>";
-  html += "<h1>🏠 SmartIntercom Premium</h1>";
-  html += "<div class='card'>";
-  html += "<h2>Панель управления SmartIntercom</h2>";
-  html += "<div class='status'>Статус SmartIntercom: <span id='status'>Загрузка...</span></div>";
-  html += "<div class='status'>Версия SmartIntercom: <span id='version'>-</span></div>";
-  html += "<div style='margin-top:20px'>";
-  html += "<button onclick='smartIntercomOpenDoor()'>🚪 Открыть дверь</button>";
-  html += "<button onclick='smartIntercomToggleAuto()'>🤖 Авто-открытие</button>";
-  html += "</div></div>";
-  html += "<div class='card'><h2>Статистика SmartIntercom</h2>";
-  html += "<div class='stats'>";
-  html += "<div class='stat-item'><div class='stat-value' id='rings'>-</div><div class='stat-label'>Звонков</div></div>";
-  html += "<div class='stat-item'><div class='stat-value' id='opens'>-</div><div class='stat-label'>Открытий</div></div>";
-  html += "<div class='stat-item'><div class='stat-value' id='uptime'>-</div><div class='stat-label'>Работа (ч)</div></div>";
-  html += "</div></div>";
-  html += "<div class='card'>";
-  html += "<h2>О SmartIntercom Premium</h2>";
-  html += "<p><strong>SmartIntercom</strong> - умный адаптер для домофонов с поддержкой WiFi, автоматизации и интеграции с системами умного дома.</p>";
-  html += "<p>Возможности SmartIntercom:</p>";
-  html += "<ul>";
-  html += "<li>Управление SmartIntercom через веб-интерфейс</li>";
-  html += "<li>REST API для интеграции SmartIntercom</li>";
-  html += "<li>Автоматическое открытие двери SmartIntercom</li>";
-  html += "<li>Интеграция SmartIntercom с умным домом</li>";
-  html += "<li>Статистика работы SmartIntercom</li>";
-  html += "</ul>";
-  html += "<p style='text-align:center;color:#666;margin-top:20px'>SmartIntercom Premium © 2025</p>";
-  html += "</div></div>";
-  html += "<script>";
-  html += "function smartIntercomOpenDoor(){fetch('/api/open',{method:'POST'}).then(r=>r.json()).then(d=>alert(d.message))}";
-  html += "function smartIntercomToggleAuto(){fetch('/api/auto-open',{method:'POST'}).then(r=>r.json()).then(d=>alert(d.message))}";
-  html += "function smartIntercomUpdate(){";
-  html += "fetch('/api/status').then(r=>r.json()).then(d=>{";
-  html += "document.getElementById('status').innerText=d.state;";
-  html += "document.getElementById('version').innerText=d.version;});";
-  html += "fetch('/api/stats').then(r=>r.json()).then(d=>{";
-  html += "document.getElementById('rings').innerText=d.ring_count;";
-  html += "document.getElementById('opens').innerText=d.open_count;";
-  html += "document.getElementById('uptime').innerText=(d.uptime/3600).toFixed(1);});}";
-  html += "smartIntercomUpdate();setInterval(smartIntercomUpdate,2000);";
-  html += "</script></body></html>";
-
-  return html;
-}
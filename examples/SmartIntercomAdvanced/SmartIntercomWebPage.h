@@ -0,0 +1,114 @@
+/*
+ * SmartIntercomWebPage.h - Сжатая веб-страница SmartIntercom
+ *
+ * Сгенерировано tools/smartintercom_webui.py из examples/SmartIntercomAdvanced/web/index.html, не редактировать.
+ * Исходник: 4646 байт, после минификации: 3710 байт, gzip: 1521 байт.
+ */
+
+#ifndef SMARTINTERCOM_WEB_PAGE_H
+#define SMARTINTERCOM_WEB_PAGE_H
+
+#include <Arduino.h>
+
+#define SMARTINTERCOM_WEB_PAGE_GZ_LENGTH 1521
+
+static const uint8_t SMARTINTERCOM_WEB_PAGE_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x57, 0x4b, 0x6f, 0xdb, 0x46,
+  0x10, 0xbe, 0xfb, 0x57, 0x6c, 0x65, 0x04, 0xa6, 0x00, 0x51, 0xcf, 0x48, 0x71, 0xa8, 0x07, 0x90,
+  0xe6, 0x01, 0xe4, 0x14, 0xa3, 0x71, 0x51, 0xe4, 0x54, 0xac, 0xc8, 0x15, 0xb5, 0x0d, 0xc9, 0x25,
+  0x96, 0x2b, 0x3f, 0x2a, 0x18, 0x88, 0x93, 0xa0, 0x39, 0x24, 0x40, 0x8a, 0x1e, 0xda, 0xa2, 0x87,
+  0x24, 0x45, 0x7b, 0x69, 0x4f, 0x8e, 0x13, 0x37, 0x76, 0x1e, 0x0e, 0xd0, 0x5f, 0xb0, 0xfc, 0x27,
+  0xfd, 0x09, 0x9d, 0x5d, 0x52, 0x32, 0x45, 0xc9, 0xb5, 0x81, 0xa0, 0x90, 0xad, 0xc7, 0x68, 0xe7,
+  0xfb, 0x66, 0xbe, 0x99, 0xd9, 0x5d, 0x75, 0x3e, 0xbb, 0x76, 0xeb, 0xea, 0xfa, 0x9d, 0xb5, 0xeb,
+  0x68, 0x28, 0x7c, 0xaf, 0xd7, 0x49, 0x9f, 0x09, 0x76, 0x7a, 0x1d, 0x9f, 0x08, 0x8c, 0xec, 0x21,
+  0xe6, 0x11, 0x11, 0xdd, 0xc2, 0x48, 0x0c, 0xcc, 0xd5, 0x42, 0x6a, 0x0d, 0xb0, 0x4f, 0xba, 0x85,
+  0x0d, 0x4a, 0x36, 0x43, 0xc6, 0x45, 0x01, 0xd9, 0x2c, 0x10, 0x24, 0x80, 0x55, 0x9b, 0xd4, 0x11,
+  0xc3, 0xae, 0x43, 0x36, 0xa8, 0x4d, 0x4c, 0xfd, 0xa1, 0x84, 0x68, 0x40, 0x05, 0xc5, 0x9e, 0x19,
+  0xd9, 0xd8, 0x23, 0xdd, 0x1a, 0x60, 0x08, 0x2a, 0x3c, 0xd2, 0xbb, 0xed, 0x63, 0x2e, 0x6e, 0x82,
+  0x23, 0xb7, 0x99, 0x8f, 0xd6, 0x38, 0xf1, 0xe9, 0xc8, 0x47, 0x57, 0x01, 0x8a, 0x33, 0x0f, 0xad,
+  0xe1, 0x80, 0x78, 0x9d, 0x4a, 0xb2, 0xb4, 0x13, 0x89, 0x6d, 0x78, 0xe9, 0x33, 0x67, 0x7b, 0x3c,
+  0x80, 0x05, 0xe6, 0x00, 0xfb, 0xd4, 0xdb, 0xb6, 0xae, 0x70, 0x00, 0x2e, 0x45, 0x38, 0x88, 0xcc,
+  0x88, 0x70, 0x3a, 0x68, 0xfb, 0x78, 0x2b, 0xa1, 0xb5, 0x2e, 0x57, 0xab, 0xe1, 0x16, 0x7c, 0xe6,
+  0x2e, 0x0d, 0xac, 0x2a, 0xc2, 0x23, 0xc1, 0xda, 0x21, 0x76, 0x1c, 0x1a, 0xb8, 0x56, 0x5d, 0x7d,
+  0xd5, 0xc7, 0xf6, 0x5d, 0x97, 0xb3, 0x51, 0xe0, 0x58, 0x1e, 0x0d, 0x08, 0xe6, 0xa6, 0xcb, 0xb1,
+  0x43, 0x21, 0x0d, 0xa3, 0xd6, 0x68, 0x3a, 0xc4, 0x2d, 0x2d, 0xb7, 0x5a, 0x97, 0x08, 0xc1, 0xa8,
+  0x7a, 0xa1, 0xb4, 0x7c, 0xa9, 0x75, 0xb1, 0x8f, 0xeb, 0xa8, 0x56, 0xad, 0x5e, 0x28, 0xee, 0x94,
+  0x55, 0xbe, 0x18, 0x9c, 0xf8, 0x38, 0x83, 0xb2, 0x39, 0xa4, 0x82, 0x4c, 0x39, 0x1a, 0x9a, 0x83,
+  0x71, 0x87, 0x70, 0x53, 0xe1, 0x8e, 0x22, 0xab, 0xd6, 0xd4, 0xa6, 0x2d, 0x33, 0x1a, 0x62, 0x87,
+  0x6d, 0x42, 0x54, 0x35, 0x58, 0x84, 0xd4, 0x4a, 0xc4, 0xdd, 0x3e, 0x36, 0xaa, 0x25, 0xfd, 0x28,
+  0x37, 0x8a, 0x3b, 0xc3, 0xda, 0xd8, 0x66, 0x1e, 0xe3, 0xd6, 0x72, 0xdd, 0x6e, 0x90, 0x66, 0xb5,
+  0x2d, 0xc8, 0x96, 0x30, 0xb1, 0x47, 0xdd, 0xc0, 0xb2, 0x89, 0x12, 0x2d, 0xcd, 0xcd, 0xec, 0x33,
+  0x21, 0x98, 0xaf, 0xf9, 0x20, 0x30, 0xcc, 0x9d, 0x6c, 0x4c, 0xcb, 0x83, 0xd5, 0xc1, 0xe5, 0x01,
+  0x9e, 0xcd, 0x3c, 0x15, 0x45, 0x85, 0x83, 0xaa, 0xf9, 0x18, 0x33, 0x61, 0x7b, 0x64, 0x20, 0xac,
+  0x8b, 0xb0, 0x28, 0x62, 0x1e, 0x75, 0x50, 0x2a, 0xc7, 0x4e, 0x7f, 0x04, 0x84, 0xc1, 0x0c, 0x4b,
+  0xf2, 0x4d, 0x3b, 0x89, 0x38, 0xd1, 0x21, 0xc1, 0xb0, 0x02, 0x16, 0x9c, 0x68, 0x52, 0xab, 0x03,
+  0x58, 0xfd, 0xe2, 0x9c, 0x30, 0x2d, 0xb0, 0xd8, 0x23, 0x1e, 0x81, 0x73, 0xc8, 0x68, 0x26, 0x39,
+  0x4b, 0x29, 0xa6, 0x0b, 0x1e, 0xd1, 0x6f, 0x89, 0x55, 0x53, 0x0b, 0x05, 0x87, 0x72, 0x43, 0x47,
+  0xb1, 0xc0, 0xc2, 0x9e, 0x87, 0x40, 0xad, 0x28, 0x0d, 0xc9, 0x1a, 0xb2, 0x8d, 0xd9, 0x92, 0x2c,
+  0x37, 0x9b, 0xad, 0x55, 0xa7, 0x91, 0xf8, 0x0c, 0x18, 0xf7, 0x2d, 0xfd, 0xce, 0xc3, 0x82, 0xdc,
+  0x31, 0x4c, 0x88, 0xa6, 0x38, 0x5b, 0x0f, 0x95, 0xec, 0x6a, 0xbe, 0x1a, 0x75, 0x28, 0x78, 0x24,
+  0xb0, 0x18, 0x45, 0xe3, 0x4c, 0x28, 0xab, 0x19, 0x21, 0xab, 0x5a, 0xc8, 0x69, 0x96, 0xb9, 0xee,
+  0xca, 0xea, 0x31, 0xc9, 0xb8, 0xa9, 0x8a, 0xa5, 0x40, 0xa3, 0xb1, 0x43, 0xa3, 0xd0, 0xc3, 0xdb,
+  0x96, 0xcb, 0xa9, 0xd3, 0x56, 0x4f, 0xa6, 0x20, 0x7e, 0xa8, 0x42, 0x34, 0x41, 0xcf, 0x91, 0x1f,
+  0x44, 0x16, 0x27, 0x21, 0xc1, 0xc2, 0x50, 0x3d, 0x6c, 0x0e, 0xa8, 0x28, 0xf9, 0x34, 0x80, 0x46,
+  0x37, 0xea, 0xaa, 0xc5, 0x4b, 0xb5, 0x01, 0x2f, 0x16, 0xdb, 0x2e, 0x0e, 0x93, 0xfe, 0x4a, 0x63,
+  0xaa, 0xeb, 0x98, 0x12, 0x0e, 0x13, 0xf8, 0xfd, 0xd3, 0x3b, 0x35, 0x6d, 0xcb, 0x6c, 0x78, 0x2a,
+  0xb9, 0xb9, 0x86, 0x4b, 0xc1, 0x36, 0xb0, 0x37, 0x22, 0x19, 0x25, 0x1a, 0xf5, 0x49, 0x8d, 0x36,
+  0x09, 0x75, 0x87, 0xc2, 0xea, 0x33, 0xcf, 0x49, 0x5b, 0x61, 0xd2, 0x32, 0x89, 0xa7, 0x87, 0xfb,
+  0xc4, 0x1b, 0x4f, 0xbf, 0x69, 0x4d, 0x3a, 0x58, 0xb0, 0x50, 0x0b, 0xd2, 0xa9, 0x24, 0x63, 0xde,
+  0xa9, 0x24, 0x1b, 0x90, 0x1a, 0xf7, 0x5e, 0xc7, 0xa1, 0x1b, 0xc8, 0xf6, 0x70, 0x14, 0x75, 0x0b,
+  0xd3, 0xb1, 0x83, 0x3d, 0x64, 0x58, 0xeb, 0xfd, 0xf3, 0xfc, 0xe9, 0x0b, 0xb4, 0x70, 0x17, 0x01,
+  0x84, 0xda, 0xac, 0x27, 0xcc, 0x85, 0x72, 0xaa, 0xf7, 0xe4, 0x73, 0xb9, 0x27, 0x3f, 0xc8, 0x03,
+  0xf9, 0x2e, 0x7e, 0x82, 0xe2, 0x07, 0xf2, 0x63, 0x7c, 0x0f, 0x0c, 0xfb, 0xf2, 0x1d, 0x98, 0x3e,
+  0xc8, 0xc3, 0xf8, 0xe9, 0x2c, 0x22, 0x20, 0xd5, 0x67, 0x90, 0x92, 0x4e, 0x28, 0xf4, 0xe4, 0xaf,
+  0xf1, 0x7d, 0xb9, 0x17, 0xdf, 0x8f, 0x1f, 0xc4, 0xbb, 0xb3, 0x2e, 0x16, 0xea, 0x44, 0x21, 0x0e,
+  0x10, 0x75, 0x32, 0xab, 0x7f, 0x02, 0x92, 0x57, 0xf1, 0x3d, 0x20, 0x7c, 0x23, 0xdf, 0xca, 0xbd,
+  0x72, 0xb9, 0x0c, 0xd9, 0xc2, 0x2a, 0x48, 0x16, 0xc0, 0x17, 0x33, 0xfc, 0x20, 0x0f, 0xc0, 0x63,
+  0x77, 0x3e, 0xa8, 0x2c, 0x03, 0x74, 0x7c, 0x04, 0xb3, 0x50, 0xe8, 0x99, 0xf3, 0x80, 0x5a, 0xce,
+  0x6e, 0x21, 0x23, 0xb3, 0x6a, 0x0b, 0xd0, 0x21, 0x99, 0x17, 0xc4, 0x02, 0xdb, 0xa3, 0xf6, 0x5d,
+  0xa0, 0xcc, 0xa2, 0xdf, 0x0a, 0x49, 0x70, 0x8d, 0x31, 0x6e, 0x14, 0x0b, 0x20, 0xf1, 0x2f, 0x7f,
+  0x22, 0xf9, 0x0c, 0x52, 0x7d, 0x0b, 0xa1, 0x3c, 0x86, 0x74, 0x9f, 0x20, 0xf9, 0x1a, 0xe4, 0x52,
+  0x91, 0x3d, 0xe9, 0x54, 0x12, 0xa0, 0x33, 0x00, 0xd7, 0x99, 0xeb, 0x7a, 0xe4, 0x0a, 0x74, 0x6f,
+  0x02, 0xf9, 0xfb, 0x8f, 0x48, 0x7e, 0x2f, 0xf7, 0x01, 0xf4, 0xd8, 0x94, 0xc7, 0x27, 0xd8, 0xf2,
+  0x50, 0x1e, 0x9c, 0x40, 0x26, 0x69, 0xcc, 0xa9, 0x93, 0xa9, 0x64, 0x5a, 0x01, 0xd0, 0x67, 0x57,
+  0x3b, 0x83, 0xae, 0xe7, 0x28, 0x1e, 0x28, 0x9b, 0x37, 0xe9, 0x01, 0x59, 0x60, 0xd6, 0xad, 0x5e,
+  0xd0, 0x32, 0x73, 0x98, 0x94, 0x48, 0x8b, 0xbc, 0xa8, 0x5c, 0x49, 0x6b, 0xeb, 0x32, 0xef, 0xcb,
+  0x63, 0xe8, 0xa3, 0xb7, 0xf0, 0xbc, 0x7f, 0x5a, 0x0a, 0xe7, 0xa4, 0x64, 0x50, 0x87, 0x73, 0x50,
+  0x3e, 0x9b, 0x11, 0xf0, 0xe8, 0x13, 0x49, 0x47, 0xa1, 0xa0, 0x3e, 0x39, 0x9b, 0xf5, 0x05, 0xf4,
+  0xf3, 0x4b, 0x5d, 0xbc, 0x3d, 0x64, 0xc4, 0x8f, 0x8a, 0x33, 0xb4, 0x67, 0x97, 0xee, 0xd9, 0xa9,
+  0x73, 0x0b, 0x05, 0x0b, 0xd5, 0x79, 0xcf, 0x59, 0xe0, 0xf6, 0x72, 0xd5, 0x4c, 0xad, 0xc8, 0x54,
+  0x83, 0xfb, 0x5e, 0x7e, 0x88, 0x1f, 0xcb, 0x23, 0x04, 0x81, 0xbc, 0x86, 0xff, 0x8f, 0x10, 0x0a,
+  0x34, 0xa5, 0xea, 0xce, 0x77, 0x30, 0x2f, 0xf0, 0x72, 0x0c, 0x4b, 0x8e, 0xe3, 0x87, 0xba, 0x1e,
+  0x50, 0x0d, 0x04, 0x73, 0x2a, 0x3f, 0xc2, 0xbb, 0xd7, 0xf0, 0x80, 0x95, 0xf2, 0x2f, 0x5d, 0xa5,
+  0x23, 0xf4, 0x15, 0xbd, 0x41, 0x4b, 0x0a, 0x46, 0x77, 0x24, 0x38, 0xe9, 0x9e, 0x82, 0x39, 0xdd,
+  0x8b, 0xbf, 0x83, 0xd7, 0x43, 0xa4, 0xff, 0x80, 0x0d, 0x08, 0xd4, 0x0c, 0x4f, 0xed, 0x00, 0xa8,
+  0xa7, 0x73, 0x57, 0x7f, 0x03, 0x7e, 0xf0, 0x7f, 0x98, 0x86, 0x06, 0x40, 0xaf, 0xe4, 0xf1, 0x24,
+  0x8c, 0x3d, 0x98, 0xf6, 0x50, 0x25, 0x06, 0x33, 0x7d, 0x0c, 0xc8, 0x10, 0x18, 0xd0, 0xc3, 0xa2,
+  0xa4, 0x73, 0x73, 0xd3, 0xad, 0xd7, 0x8e, 0xe0, 0x1e, 0xe6, 0xd1, 0x9e, 0xfc, 0x2d, 0xbf, 0x43,
+  0xc9, 0x83, 0x9c, 0x76, 0xf1, 0x23, 0x9d, 0xce, 0x81, 0x7c, 0x83, 0xd4, 0x60, 0xca, 0x97, 0xe6,
+  0x24, 0x5a, 0xe8, 0x8a, 0x87, 0x60, 0x38, 0x8a, 0x77, 0x3b, 0x15, 0xc0, 0x52, 0x78, 0x5f, 0x5c,
+  0xbf, 0xbd, 0x8e, 0xae, 0xac, 0xdd, 0x9c, 0xea, 0xb4, 0x28, 0xb1, 0x9c, 0xec, 0xa9, 0xeb, 0x64,
+  0x66, 0x27, 0x0a, 0x69, 0xde, 0x5d, 0x2d, 0xe2, 0x01, 0xca, 0xcf, 0xf1, 0x74, 0x97, 0x38, 0x1d,
+  0xee, 0xe7, 0x3c, 0x73, 0x7e, 0x9b, 0xd3, 0x02, 0x4f, 0x0a, 0xfd, 0x7e, 0x5a, 0x52, 0xf9, 0xfe,
+  0x04, 0x63, 0xd1, 0x16, 0xa0, 0xe5, 0xd2, 0xbd, 0x19, 0x3f, 0x5e, 0xc4, 0x5d, 0x51, 0xd2, 0x86,
+  0x93, 0xcd, 0x71, 0xfe, 0x5e, 0xb5, 0xf8, 0x80, 0x4a, 0x76, 0xce, 0xc5, 0x77, 0xd6, 0xbf, 0xff,
+  0x40, 0xf5, 0x6a, 0xbd, 0xa9, 0xeb, 0x96, 0xed, 0xfd, 0xc8, 0xe6, 0x34, 0x14, 0xbd, 0xc1, 0x28,
+  0xb0, 0xd5, 0x7d, 0x05, 0x9d, 0xb2, 0xcd, 0xa2, 0xf1, 0xd2, 0x80, 0x08, 0x7b, 0x68, 0xac, 0x54,
+  0x70, 0x48, 0x2b, 0x6a, 0xee, 0x57, 0x4a, 0x68, 0x0c, 0x37, 0xed, 0x21, 0x73, 0x2c, 0xb4, 0xb2,
+  0x76, 0xeb, 0xf6, 0xfa, 0xca, 0x4e, 0xb1, 0x2c, 0x86, 0x24, 0x30, 0x38, 0xea, 0xf6, 0x10, 0x2f,
+  0x7f, 0x13, 0xb1, 0xc0, 0x28, 0xa6, 0x36, 0x47, 0xd9, 0xe0, 0x72, 0xcd, 0x85, 0xe1, 0x94, 0x7d,
+  0x12, 0x45, 0xd8, 0x25, 0x70, 0x27, 0x58, 0xda, 0x59, 0x5a, 0x4c, 0x9d, 0xdd, 0x90, 0x73, 0xe4,
+  0xfa, 0x8e, 0xf1, 0xff, 0x47, 0xf0, 0x65, 0xe8, 0xc0, 0x05, 0x67, 0x8e, 0x3d, 0x39, 0xfa, 0x56,
+  0xce, 0x22, 0x1a, 0x2f, 0x39, 0xcc, 0x1e, 0xf9, 0x50, 0xae, 0xb2, 0x4b, 0xc4, 0x75, 0x8f, 0xa8,
+  0xb7, 0x9f, 0x6f, 0xdf, 0x74, 0x8c, 0x95, 0x29, 0x02, 0x0d, 0xe0, 0x9e, 0xb0, 0x0e, 0xc5, 0x45,
+  0x5d, 0xe4, 0xe8, 0xfb, 0x07, 0x69, 0x9f, 0xee, 0x96, 0x9e, 0xa2, 0x73, 0x7e, 0xa9, 0x1d, 0x12,
+  0x81, 0x64, 0xf2, 0x91, 0x7e, 0x52, 0xa0, 0xfa, 0x40, 0x99, 0xe3, 0x53, 0xd6, 0xaf, 0x6d, 0xb8,
+  0xa4, 0x89, 0xff, 0x08, 0x56, 0x1f, 0x0c, 0x73, 0xae, 0xca, 0x7a, 0xa6, 0x6b, 0xb2, 0xbd, 0xe7,
+  0x7c, 0xa1, 0x64, 0x89, 0x1d, 0x55, 0x50, 0xa3, 0x55, 0xad, 0x42, 0x06, 0xec, 0x06, 0xdd, 0x22,
+  0x8e, 0x51, 0x2b, 0x26, 0x99, 0xef, 0x2c, 0x2d, 0xac, 0x5e, 0x7b, 0x09, 0x7e, 0x1a, 0x6a, 0x23,
+  0x9c, 0x20, 0xc6, 0x82, 0x25, 0x25, 0x98, 0x0b, 0xc0, 0x6b, 0xc3, 0xd6, 0x9d, 0x8c, 0x02, 0x1c,
+  0xef, 0xfa, 0x52, 0x57, 0xd1, 0x3f, 0x34, 0xff, 0x05, 0x6a, 0x36, 0x59, 0x19, 0x7e, 0x0e, 0x00,
+  0x00,
+};
+
+#endif // SMARTINTERCOM_WEB_PAGE_H
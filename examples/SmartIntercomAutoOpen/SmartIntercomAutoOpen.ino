@@ -33,6 +33,11 @@ SmartIntercom smartIntercom;
 bool smartIntercomButtonPressed = false;
 unsigned long smartIntercomLastButtonPress = 0;
 
+// SmartIntercom Button Wakeup (прерывание будит спящий loop())
+void IRAM_ATTR smartIntercomButtonWake() {
+  smartIntercomWake();
+}
+
 void setup() {
   Serial.begin(115200);
   delay(100);
@@ -44,6 +49,7 @@ void setup() {
 
   // SmartIntercom Button Setup
   pinMode(SMARTINTERCOM_BUTTON_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(SMARTINTERCOM_BUTTON_PIN), smartIntercomButtonWake, CHANGE);
 
   // SmartIntercom Configuration
   SmartIntercomConfig smartIntercomConfig;
@@ -62,6 +68,7 @@ void setup() {
   // SmartIntercom Initialization
   Serial.println("Инициализация SmartIntercom...");
   smartIntercom.smartIntercomBegin(smartIntercomConfig);
+  smartIntercom.smartIntercomEnableRingSampling();
 
   // SmartIntercom Enable Auto-Open by default
   smartIntercom.smartIntercomEnableAutoOpen();
@@ -80,7 +87,8 @@ void loop() {
   // SmartIntercom Button Check
   smartIntercomCheckButton();
 
-  delay(10);
+  // SmartIntercom Sleep until a ring, the button or the next deadline
+  smartIntercom.smartIntercomIdle();
 }
 
 // SmartIntercom Button Handler
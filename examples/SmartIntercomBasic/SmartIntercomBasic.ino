@@ -42,6 +42,9 @@ void setup() {
     SMARTINTERCOM_DOOR_PIN
   );
 
+  // SmartIntercom Ring sampling by timer: the loop sleeps until a ring or a deadline
+  smartIntercom.smartIntercomEnableRingSampling();
+
   Serial.println("\nSmartIntercom готов к работе!");
   Serial.println("SmartIntercom ожидает звонков...\n");
 }
@@ -58,5 +61,6 @@ void loop() {
     smartIntercomLastStatus = millis();
   }
 
-  delay(10);
+  // SmartIntercom Sleep until the next deadline instead of delay()
+  smartIntercom.smartIntercomIdle();
 }
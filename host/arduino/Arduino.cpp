@@ -0,0 +1,100 @@
+/*
+ * Arduino.cpp - Реализация замены Arduino API для хоста SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Host Serial Instance
+SmartIntercomHostSerial Serial;
+
+/*
+ * SmartIntercom Host Time and GPIO
+ * Перенаправление Arduino API в активный HAL SmartIntercom
+ */
+unsigned long millis() {
+  return smartIntercomMillis();
+}
+
+unsigned long micros() {
+  return smartIntercomMicros();
+}
+
+void delay(unsigned long ms) {
+  smartIntercomDelay(ms);
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  smartIntercomPinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  smartIntercomDigitalWrite(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+  return smartIntercomDigitalRead(pin);
+}
+
+int analogRead(uint8_t pin) {
+  return smartIntercomAnalogRead(pin);
+}
+
+void analogWrite(uint8_t pin, int value) {
+  smartIntercomAnalogWrite(pin, value);
+}
+
+/*
+ * SmartIntercomHostSerial Write
+ * Вывод текста SmartIntercom в stdout, если Serial включен
+ */
+void SmartIntercomHostSerial::smartIntercomWrite(const char* text) {
+  if (smartIntercomEnabled) {
+    fputs(text, stdout);
+  }
+}
+
+size_t SmartIntercomHostSerial::write(const uint8_t* data, size_t length) {
+  if (smartIntercomEnabled) {
+    fwrite(data, 1, length, stdout);
+  }
+  return length;
+}
+
+void SmartIntercomHostSerial::print(char value) {
+  char text[2] = { value, 0 };
+  smartIntercomWrite(text);
+}
+
+void SmartIntercomHostSerial::print(int value) {
+  print((long)value);
+}
+
+void SmartIntercomHostSerial::print(unsigned int value) {
+  print((unsigned long)value);
+}
+
+void SmartIntercomHostSerial::print(long value) {
+  char text[24];
+  snprintf(text, sizeof(text), "%ld", value);
+  smartIntercomWrite(text);
+}
+
+void SmartIntercomHostSerial::print(unsigned long value) {
+  char text[24];
+  snprintf(text, sizeof(text), "%lu", value);
+  smartIntercomWrite(text);
+}
+
+void SmartIntercomHostSerial::print(double value) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.2f", value);
+  smartIntercomWrite(text);
+}
@@ -0,0 +1,154 @@
+/*
+ * Arduino.h - Минимальная замена Arduino API для хостовой сборки SmartIntercom
+ *
+ * Предоставляет только то, что использует библиотека SmartIntercom:
+ * типы, константы пинов, String, Serial и функции времени/GPIO.
+ * Функции времени и GPIO перенаправляются в активный SmartIntercomHAL,
+ * поэтому на хосте ими управляет симулятор платы.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HOST_ARDUINO_H
+#define SMARTINTERCOM_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// SmartIntercom Host Arduino Types
+typedef bool boolean;
+typedef uint8_t byte;
+
+// SmartIntercom Host Pin Levels and Modes
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+
+// SmartIntercom Host NodeMCU Pin Aliases (ESP8266 GPIO numbers)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define A0 17
+#define LED_BUILTIN 2
+
+// SmartIntercom Host Flash Access (flat address space on the host)
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(const void* const*)(addr))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+// SmartIntercom Host Interrupt Control (single-threaded simulator)
+#define noInterrupts()
+#define interrupts()
+#define IRAM_ATTR
+
+// SmartIntercom Host Time and GPIO (routed to the active SmartIntercomHAL)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+/*
+ * String - Упрощенная строка Arduino для хоста SmartIntercom
+ */
+class String {
+private:
+  std::string smartIntercomValue;
+
+public:
+  String() {}
+  String(const char* value) : smartIntercomValue(value ? value : "") {}
+  String(const std::string& value) : smartIntercomValue(value) {}
+  String(char value) : smartIntercomValue(1, value) {}
+  explicit String(int value) : smartIntercomValue(std::to_string(value)) {}
+  explicit String(unsigned int value) : smartIntercomValue(std::to_string(value)) {}
+  explicit String(long value) : smartIntercomValue(std::to_string(value)) {}
+  explicit String(unsigned long value) : smartIntercomValue(std::to_string(value)) {}
+
+  const char* c_str() const { return smartIntercomValue.c_str(); }
+  unsigned int length() const { return (unsigned int)smartIntercomValue.size(); }
+  bool reserve(unsigned int size) { smartIntercomValue.reserve(size); return true; }
+  char operator[](unsigned int index) const { return smartIntercomValue[index]; }
+
+  String& operator+=(const String& other) { smartIntercomValue += other.smartIntercomValue; return *this; }
+  String& operator+=(const char* other) { smartIntercomValue += other; return *this; }
+  String& operator+=(char other) { smartIntercomValue += other; return *this; }
+
+  bool operator==(const String& other) const { return smartIntercomValue == other.smartIntercomValue; }
+  bool operator==(const char* other) const { return smartIntercomValue == other; }
+  bool operator!=(const String& other) const { return !(*this == other); }
+  bool operator!=(const char* other) const { return !(*this == other); }
+
+  friend String operator+(const String& a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+  }
+};
+
+/*
+ * SmartIntercomHostSerial - Замена Serial для хоста SmartIntercom
+ *
+ * По умолчанию вывод отключен, чтобы симуляция и бенчмарки
+ * не упирались в stdout. Включается через smartIntercomSetEnabled().
+ */
+class SmartIntercomHostSerial {
+private:
+  bool smartIntercomEnabled;
+
+  void smartIntercomWrite(const char* text);
+
+public:
+  SmartIntercomHostSerial() : smartIntercomEnabled(false) {}
+
+  void begin(unsigned long baud) { (void)baud; }
+  void smartIntercomSetEnabled(bool enabled) { smartIntercomEnabled = enabled; }
+  bool smartIntercomIsEnabled() const { return smartIntercomEnabled; }
+  int availableForWrite() { return 128; }
+  size_t write(const uint8_t* data, size_t length);
+
+  void print(const char* value) { smartIntercomWrite(value); }
+  void print(const String& value) { smartIntercomWrite(value.c_str()); }
+  void print(char value);
+  void print(int value);
+  void print(unsigned int value);
+  void print(long value);
+  void print(unsigned long value);
+  void print(double value);
+
+  void println() { smartIntercomWrite("\n"); }
+  template <typename T>
+  void println(T value) {
+    print(value);
+    println();
+  }
+};
+
+extern SmartIntercomHostSerial Serial;
+
+#endif // SMARTINTERCOM_HOST_ARDUINO_H
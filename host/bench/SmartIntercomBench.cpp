@@ -0,0 +1,406 @@
+/*
+ * SmartIntercomBench.cpp - Каркас микробенчмарков SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomBench.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+#define SMARTINTERCOM_BENCH_NAME_MAX 64
+
+/*
+ * SmartIntercomBenchCase - Зарегистрированный бенчмарк SmartIntercom
+ */
+struct SmartIntercomBenchCase {
+  char name[SMARTINTERCOM_BENCH_NAME_MAX];
+  SmartIntercomBenchFunction function;
+  void* context;
+};
+
+/*
+ * SmartIntercomBenchRun - Результат одного повтора SmartIntercom
+ */
+struct SmartIntercomBenchRun {
+  uint64_t iterations;
+  double realNs;                    // SmartIntercom на итерацию
+  double cpuNs;                     // SmartIntercom на итерацию
+  double itemsPerSecond;            // SmartIntercom 0 - не задано
+  double bytesPerSecond;            // SmartIntercom 0 - не задано
+};
+
+// SmartIntercom Bench Registry (заполняется статическими инициализаторами)
+static SmartIntercomBenchCase smartIntercomBenchCases[SMARTINTERCOM_BENCH_MAX_CASES];
+static size_t smartIntercomBenchCaseCount = 0;
+
+static uint64_t smartIntercomBenchClockNs(clockid_t clock) {
+  struct timespec now;
+  clock_gettime(clock, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// ============================================================================
+// SmartIntercomBenchState
+// ============================================================================
+
+SmartIntercomBenchState::SmartIntercomBenchState(uint64_t iterations, void* context) {
+  smartIntercomIterations = iterations;
+  smartIntercomRemaining = iterations;
+  smartIntercomItems = 0;
+  smartIntercomBytes = 0;
+  smartIntercomRealStartNs = 0;
+  smartIntercomCpuStartNs = 0;
+  smartIntercomRealNs = 0;
+  smartIntercomCpuNs = 0;
+  smartIntercomContext = context;
+  smartIntercomStarted = false;
+  smartIntercomError = nullptr;
+}
+
+void SmartIntercomBenchState::smartIntercomStart() {
+  smartIntercomStarted = true;
+  smartIntercomCpuStartNs = smartIntercomBenchClockNs(CLOCK_PROCESS_CPUTIME_ID);
+  smartIntercomRealStartNs = smartIntercomBenchClockNs(CLOCK_MONOTONIC);
+}
+
+void SmartIntercomBenchState::smartIntercomStop() {
+  smartIntercomRealNs = smartIntercomBenchClockNs(CLOCK_MONOTONIC) - smartIntercomRealStartNs;
+  smartIntercomCpuNs = smartIntercomBenchClockNs(CLOCK_PROCESS_CPUTIME_ID) - smartIntercomCpuStartNs;
+  smartIntercomStarted = false;
+}
+
+// ============================================================================
+// SmartIntercom Bench Registry and Options
+// ============================================================================
+
+/*
+ * SmartIntercom Bench Register
+ */
+bool smartIntercomBenchRegister(const char* name, SmartIntercomBenchFunction function, void* context) {
+  if (smartIntercomBenchCaseCount >= SMARTINTERCOM_BENCH_MAX_CASES) {
+    fprintf(stderr, "SmartIntercom: benchmark table full, %s not registered\n", name);
+    return false;
+  }
+  SmartIntercomBenchCase& benchCase = smartIntercomBenchCases[smartIntercomBenchCaseCount++];
+  snprintf(benchCase.name, sizeof(benchCase.name), "%s", name);
+  benchCase.function = function;
+  benchCase.context = context;
+  return true;
+}
+
+void smartIntercomBenchDefaultOptions(SmartIntercomBenchOptions* options) {
+  options->filter = nullptr;
+  options->minTimeMs = 500;
+  options->repetitions = 1;
+  options->json = false;
+  options->outPath = nullptr;
+}
+
+/*
+ * SmartIntercom Bench Parse Option
+ * Разбор одного общего параметра; false - параметр не наш или неверен
+ */
+bool smartIntercomBenchParseOption(int argc, char** argv, int* index, SmartIntercomBenchOptions* options) {
+  int i = *index;
+  if (i + 1 >= argc) {
+    return false;
+  }
+  const char* value = argv[i + 1];
+  if (strcmp(argv[i], "--filter") == 0) {
+    options->filter = value;
+  } else if (strcmp(argv[i], "--min-time-ms") == 0) {
+    options->minTimeMs = strtoul(value, nullptr, 10);
+    if (options->minTimeMs == 0) {
+      return false;
+    }
+  } else if (strcmp(argv[i], "--repetitions") == 0) {
+    options->repetitions = (unsigned int)strtoul(value, nullptr, 10);
+    if (options->repetitions == 0 || options->repetitions > SMARTINTERCOM_BENCH_MAX_REPETITIONS) {
+      return false;
+    }
+  } else if (strcmp(argv[i], "--format") == 0) {
+    if (strcmp(value, "json") == 0) {
+      options->json = true;
+    } else if (strcmp(value, "console") == 0) {
+      options->json = false;
+    } else {
+      return false;
+    }
+  } else if (strcmp(argv[i], "--out") == 0) {
+    options->outPath = value;
+  } else {
+    return false;
+  }
+  *index = i + 1;
+  return true;
+}
+
+const char* smartIntercomBenchUsage() {
+  return "[--filter S] [--min-time-ms N] [--repetitions N] [--format console|json] [--out FILE]";
+}
+
+// ============================================================================
+// SmartIntercom Bench Runner
+// ============================================================================
+
+/*
+ * SmartIntercom Bench Measure
+ * Один вызов тела бенчмарка SmartIntercom с заданным числом итераций
+ */
+static const char* smartIntercomBenchMeasure(const SmartIntercomBenchCase& benchCase, uint64_t iterations,
+                                             SmartIntercomBenchRun* run) {
+  SmartIntercomBenchState state(iterations, benchCase.context);
+  benchCase.function(state);
+  if (state.smartIntercomGetError() != nullptr) {
+    return state.smartIntercomGetError();
+  }
+  double realSeconds = state.smartIntercomGetRealNs() / 1e9;
+  run->iterations = iterations;
+  run->realNs = (double)state.smartIntercomGetRealNs() / iterations;
+  run->cpuNs = (double)state.smartIntercomGetCpuNs() / iterations;
+  run->itemsPerSecond = realSeconds > 0 ? state.smartIntercomGetItems() / realSeconds : 0;
+  run->bytesPerSecond = realSeconds > 0 ? state.smartIntercomGetBytes() / realSeconds : 0;
+  return nullptr;
+}
+
+/*
+ * SmartIntercom Bench Calibrate
+ * Подбор числа итераций SmartIntercom, как у Google Benchmark
+ *
+ * Итерации растут не более чем в 10 раз за шаг, пока замер не
+ * станет длиннее minTimeMs; первый достаточно длинный замер и есть
+ * результат первого повтора.
+ */
+static const char* smartIntercomBenchCalibrate(const SmartIntercomBenchCase& benchCase, unsigned long minTimeMs,
+                                               SmartIntercomBenchRun* run) {
+  double minNs = minTimeMs * 1e6;
+  uint64_t iterations = 1;
+  while (true) {
+    const char* error = smartIntercomBenchMeasure(benchCase, iterations, run);
+    if (error != nullptr) {
+      return error;
+    }
+    double totalNs = run->realNs * iterations;
+    if (totalNs >= minNs || iterations >= SMARTINTERCOM_BENCH_MAX_ITERATIONS) {
+      return nullptr;
+    }
+    double multiplier = totalNs > 0 ? minNs * 1.4 / totalNs : 10.0;
+    if (multiplier > 10.0) {
+      multiplier = 10.0;
+    }
+    uint64_t next = (uint64_t)(iterations * multiplier);
+    iterations = std::min(std::max(next, iterations + 1), (uint64_t)SMARTINTERCOM_BENCH_MAX_ITERATIONS);
+  }
+}
+
+static bool smartIntercomBenchMatches(const SmartIntercomBenchOptions& options, const char* name) {
+  return options.filter == nullptr || strstr(name, options.filter) != nullptr;
+}
+
+static void smartIntercomBenchFormatRate(double perSecond, const char* unit, char* out, size_t size) {
+  if (perSecond >= 1e9) {
+    snprintf(out, size, "%.2fG%s/s", perSecond / 1e9, unit);
+  } else if (perSecond >= 1e6) {
+    snprintf(out, size, "%.2fM%s/s", perSecond / 1e6, unit);
+  } else if (perSecond >= 1e3) {
+    snprintf(out, size, "%.2fk%s/s", perSecond / 1e3, unit);
+  } else {
+    snprintf(out, size, "%.2f%s/s", perSecond, unit);
+  }
+}
+
+/*
+ * SmartIntercom Bench Print Console Row
+ */
+static void smartIntercomBenchPrintRow(FILE* out, const char* name, const char* suffix,
+                                       const SmartIntercomBenchRun& run, bool aggregate) {
+  char fullName[SMARTINTERCOM_BENCH_NAME_MAX + 16];
+  snprintf(fullName, sizeof(fullName), "%.63s%.15s", name, suffix);
+  char rate[32] = "";
+  if (run.itemsPerSecond > 0) {
+    smartIntercomBenchFormatRate(run.itemsPerSecond, "", rate, sizeof(rate));
+  } else if (run.bytesPerSecond > 0) {
+    smartIntercomBenchFormatRate(run.bytesPerSecond, "B", rate, sizeof(rate));
+  }
+  if (aggregate) {
+    fprintf(out, "%-44s %12.1f ns %12.1f ns %12s %s\n", fullName, run.realNs, run.cpuNs, "", rate);
+  } else {
+    fprintf(out, "%-44s %12.1f ns %12.1f ns %12llu %s\n", fullName, run.realNs, run.cpuNs,
+            (unsigned long long)run.iterations, rate);
+  }
+}
+
+/*
+ * SmartIntercom Bench Write JSON Entry
+ */
+static void smartIntercomBenchWriteEntry(FILE* out, bool* first, const char* name, const char* aggregateName,
+                                         unsigned int repetitions, unsigned int index,
+                                         const SmartIntercomBenchRun& run) {
+  fprintf(out, "%s\n    {\n", *first ? "" : ",");
+  *first = false;
+  if (aggregateName != nullptr) {
+    fprintf(out, "      \"name\": \"%s_%s\",\n", name, aggregateName);
+  } else {
+    fprintf(out, "      \"name\": \"%s\",\n", name);
+  }
+  fprintf(out, "      \"run_name\": \"%s\",\n", name);
+  fprintf(out, "      \"run_type\": \"%s\",\n", aggregateName != nullptr ? "aggregate" : "iteration");
+  fprintf(out, "      \"repetitions\": %u,\n", repetitions);
+  if (aggregateName != nullptr) {
+    fprintf(out, "      \"aggregate_name\": \"%s\",\n", aggregateName);
+  } else {
+    fprintf(out, "      \"repetition_index\": %u,\n", index);
+  }
+  fprintf(out, "      \"iterations\": %llu,\n", (unsigned long long)run.iterations);
+  fprintf(out, "      \"real_time\": %.4f,\n", run.realNs);
+  fprintf(out, "      \"cpu_time\": %.4f,\n", run.cpuNs);
+  if (run.itemsPerSecond > 0) {
+    fprintf(out, "      \"items_per_second\": %.4f,\n", run.itemsPerSecond);
+  }
+  if (run.bytesPerSecond > 0) {
+    fprintf(out, "      \"bytes_per_second\": %.4f,\n", run.bytesPerSecond);
+  }
+  fprintf(out, "      \"time_unit\": \"ns\"\n    }");
+}
+
+/*
+ * SmartIntercom Bench Aggregate
+ * Среднее, медиана и стандартное отклонение по повторам SmartIntercom
+ */
+static void smartIntercomBenchAggregate(const SmartIntercomBenchRun* runs, unsigned int count,
+                                        SmartIntercomBenchRun* mean, SmartIntercomBenchRun* median,
+                                        SmartIntercomBenchRun* stddev) {
+  memset(mean, 0, sizeof(*mean));
+  for (unsigned int i = 0; i < count; i++) {
+    mean->realNs += runs[i].realNs / count;
+    mean->cpuNs += runs[i].cpuNs / count;
+    mean->itemsPerSecond += runs[i].itemsPerSecond / count;
+    mean->bytesPerSecond += runs[i].bytesPerSecond / count;
+  }
+  mean->iterations = runs[0].iterations;
+
+  double real[SMARTINTERCOM_BENCH_MAX_REPETITIONS];
+  double cpu[SMARTINTERCOM_BENCH_MAX_REPETITIONS];
+  *stddev = *mean;
+  stddev->realNs = 0;
+  stddev->cpuNs = 0;
+  stddev->itemsPerSecond = 0;
+  stddev->bytesPerSecond = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    real[i] = runs[i].realNs;
+    cpu[i] = runs[i].cpuNs;
+    stddev->realNs += (runs[i].realNs - mean->realNs) * (runs[i].realNs - mean->realNs);
+    stddev->cpuNs += (runs[i].cpuNs - mean->cpuNs) * (runs[i].cpuNs - mean->cpuNs);
+  }
+  stddev->realNs = count > 1 ? sqrt(stddev->realNs / (count - 1)) : 0;
+  stddev->cpuNs = count > 1 ? sqrt(stddev->cpuNs / (count - 1)) : 0;
+
+  std::sort(real, real + count);
+  std::sort(cpu, cpu + count);
+  *median = *mean;
+  median->realNs = count % 2 ? real[count / 2] : (real[count / 2 - 1] + real[count / 2]) / 2;
+  median->cpuNs = count % 2 ? cpu[count / 2] : (cpu[count / 2 - 1] + cpu[count / 2]) / 2;
+}
+
+/*
+ * SmartIntercom Bench Write Context
+ * Шапка JSON SmartIntercom: когда, где и какой сборкой получены числа
+ */
+static void smartIntercomBenchWriteContext(FILE* out, const char* executable) {
+  char date[32];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+  char host[64] = "";
+  gethostname(host, sizeof(host) - 1);
+  fprintf(out, "{\n  \"context\": {\n");
+  fprintf(out, "    \"date\": \"%s\",\n", date);
+  fprintf(out, "    \"host_name\": \"%s\",\n", host);
+  fprintf(out, "    \"executable\": \"%s\",\n", executable);
+  fprintf(out, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef NDEBUG
+  fprintf(out, "    \"library_build_type\": \"release\"\n");
+#else
+  fprintf(out, "    \"library_build_type\": \"debug\"\n");
+#endif
+  fprintf(out, "  },\n  \"benchmarks\": [");
+}
+
+/*
+ * SmartIntercom Bench Run All
+ * Все бенчмарки SmartIntercom, прошедшие фильтр, в порядке регистрации
+ *
+ * Таблица всегда идет в stdout (при --format json - в stderr, чтобы
+ * не портить JSON), JSON - в stdout или в файл --out.
+ */
+int smartIntercomBenchRunAll(const SmartIntercomBenchOptions& options, const char* executable) {
+  FILE* json = nullptr;
+  if (options.json) {
+    json = options.outPath != nullptr ? fopen(options.outPath, "w") : stdout;
+    if (json == nullptr) {
+      fprintf(stderr, "SmartIntercom: cannot write %s\n", options.outPath);
+      return 1;
+    }
+    smartIntercomBenchWriteContext(json, executable);
+  }
+  FILE* console = options.json && json == stdout ? stderr : stdout;
+  fprintf(console, "%-44s %15s %15s %12s %s\n", "Benchmark", "Time", "CPU", "Iterations", "Rate");
+  fflush(console);
+
+  int failures = 0;
+  bool first = true;
+  for (size_t c = 0; c < smartIntercomBenchCaseCount; c++) {
+    const SmartIntercomBenchCase& benchCase = smartIntercomBenchCases[c];
+    if (!smartIntercomBenchMatches(options, benchCase.name)) {
+      continue;
+    }
+
+    SmartIntercomBenchRun runs[SMARTINTERCOM_BENCH_MAX_REPETITIONS];
+    const char* error = smartIntercomBenchCalibrate(benchCase, options.minTimeMs, &runs[0]);
+    for (unsigned int r = 1; error == nullptr && r < options.repetitions; r++) {
+      error = smartIntercomBenchMeasure(benchCase, runs[0].iterations, &runs[r]);
+    }
+    if (error != nullptr) {
+      fprintf(console, "%-44s ERROR: %s\n", benchCase.name, error);
+      fflush(console);
+      failures++;
+      continue;
+    }
+
+    for (unsigned int r = 0; r < options.repetitions; r++) {
+      smartIntercomBenchPrintRow(console, benchCase.name, "", runs[r], false);
+      if (json != nullptr) {
+        smartIntercomBenchWriteEntry(json, &first, benchCase.name, nullptr, options.repetitions, r, runs[r]);
+      }
+    }
+    if (options.repetitions > 1) {
+      SmartIntercomBenchRun mean;
+      SmartIntercomBenchRun median;
+      SmartIntercomBenchRun stddev;
+      smartIntercomBenchAggregate(runs, options.repetitions, &mean, &median, &stddev);
+      smartIntercomBenchPrintRow(console, benchCase.name, "_mean", mean, true);
+      smartIntercomBenchPrintRow(console, benchCase.name, "_median", median, true);
+      smartIntercomBenchPrintRow(console, benchCase.name, "_stddev", stddev, true);
+      if (json != nullptr) {
+        smartIntercomBenchWriteEntry(json, &first, benchCase.name, "mean", options.repetitions, 0, mean);
+        smartIntercomBenchWriteEntry(json, &first, benchCase.name, "median", options.repetitions, 0, median);
+        smartIntercomBenchWriteEntry(json, &first, benchCase.name, "stddev", options.repetitions, 0, stddev);
+      }
+    }
+    fflush(console);
+  }
+
+  if (json != nullptr) {
+    fprintf(json, "\n  ]\n}\n");
+    if (json != stdout) {
+      fclose(json);
+    }
+  }
+  return failures > 0 ? 1 : 0;
+}
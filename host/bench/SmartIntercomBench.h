@@ -0,0 +1,143 @@
+/*
+ * SmartIntercomBench.h - Каркас микробенчмарков SmartIntercom
+ *
+ * Небольшая замена Google Benchmark без внешних зависимостей: функции
+ * регистрируются макросом SMARTINTERCOM_BENCHMARK, число итераций
+ * подбирается так, чтобы замер длился не меньше --min-time-ms, а
+ * результаты печатаются таблицей или в JSON того же вида, что
+ * --benchmark_format=json у Google Benchmark ("context" и
+ * "benchmarks" с name, iterations, real_time, cpu_time, time_unit),
+ * поэтому их понимают и tools/smartintercom_bench_compare.py, и
+ * compare.py из Google Benchmark.
+ *
+ *   static void smartIntercomBenchFoo(SmartIntercomBenchState& state) {
+ *     ...подготовка...
+ *     while (state.smartIntercomKeepRunning()) {
+ *       ...измеряемый код...
+ *     }
+ *     state.smartIntercomSetItemsProcessed(state.smartIntercomGetIterations() * 32);
+ *   }
+ *   SMARTINTERCOM_BENCHMARK("BM_Foo", smartIntercomBenchFoo);
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_BENCH_H
+#define SMARTINTERCOM_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// SmartIntercom Bench Configuration
+#define SMARTINTERCOM_BENCH_MAX_CASES 32
+#define SMARTINTERCOM_BENCH_MAX_REPETITIONS 32
+#define SMARTINTERCOM_BENCH_MAX_ITERATIONS 1000000000ULL
+
+/*
+ * SmartIntercomBenchState - Состояние одного замера SmartIntercom
+ *
+ * Время идет только внутри цикла smartIntercomKeepRunning(): подготовка
+ * до цикла и проверки после него в замер не попадают. Вызов
+ * smartIntercomSkip() помечает бенчмарк ошибкой (например, ответ
+ * сервера не 200), и его результат не печатается как время.
+ */
+class SmartIntercomBenchState {
+private:
+  uint64_t smartIntercomIterations;
+  uint64_t smartIntercomRemaining;
+  uint64_t smartIntercomItems;
+  uint64_t smartIntercomBytes;
+  uint64_t smartIntercomRealStartNs;
+  uint64_t smartIntercomCpuStartNs;
+  uint64_t smartIntercomRealNs;
+  uint64_t smartIntercomCpuNs;
+  void* smartIntercomContext;
+  bool smartIntercomStarted;
+  const char* smartIntercomError;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomStart();
+  void smartIntercomStop();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomBenchState(uint64_t iterations, void* context);
+
+  // SmartIntercom Measured Loop
+  bool smartIntercomKeepRunning() {
+    if (smartIntercomRemaining > 0) {
+      if (!smartIntercomStarted) {
+        smartIntercomStart();
+      }
+      smartIntercomRemaining--;
+      return true;
+    }
+    if (smartIntercomStarted) {
+      smartIntercomStop();
+    }
+    return false;
+  }
+
+  // SmartIntercom Counters
+  uint64_t smartIntercomGetIterations() { return smartIntercomIterations; }
+  void* smartIntercomGetContext() { return smartIntercomContext; }
+  void smartIntercomSetItemsProcessed(uint64_t items) { smartIntercomItems = items; }
+  void smartIntercomSetBytesProcessed(uint64_t bytes) { smartIntercomBytes = bytes; }
+  void smartIntercomSkip(const char* error) { smartIntercomError = error; }
+
+  // SmartIntercom Results
+  uint64_t smartIntercomGetItems() { return smartIntercomItems; }
+  uint64_t smartIntercomGetBytes() { return smartIntercomBytes; }
+  uint64_t smartIntercomGetRealNs() { return smartIntercomRealNs; }
+  uint64_t smartIntercomGetCpuNs() { return smartIntercomCpuNs; }
+  const char* smartIntercomGetError() { return smartIntercomError; }
+};
+
+/*
+ * SmartIntercomBenchFunction - Тело бенчмарка SmartIntercom
+ */
+typedef void (*SmartIntercomBenchFunction)(SmartIntercomBenchState& state);
+
+/*
+ * SmartIntercomBenchOptions - Параметры запуска бенчмарков SmartIntercom
+ */
+struct SmartIntercomBenchOptions {
+  const char* filter;               // SmartIntercom подстрока имени (nullptr - все)
+  unsigned long minTimeMs;          // SmartIntercom минимальная длительность замера
+  unsigned int repetitions;         // SmartIntercom повторы (больше 1 - с агрегатами)
+  bool json;                        // SmartIntercom JSON вместо таблицы
+  const char* outPath;              // SmartIntercom файл для JSON (nullptr - stdout)
+};
+
+// SmartIntercom Bench Registry (имя копируется, context передается в состояние)
+bool smartIntercomBenchRegister(const char* name, SmartIntercomBenchFunction function, void* context = nullptr);
+
+// SmartIntercom Bench Command Line (--filter, --min-time-ms, --repetitions, --format, --out)
+void smartIntercomBenchDefaultOptions(SmartIntercomBenchOptions* options);
+bool smartIntercomBenchParseOption(int argc, char** argv, int* index, SmartIntercomBenchOptions* options);
+const char* smartIntercomBenchUsage();
+
+// SmartIntercom Bench Run (0 - все замеры прошли, 1 - были ошибки)
+int smartIntercomBenchRunAll(const SmartIntercomBenchOptions& options, const char* executable);
+
+// SmartIntercom Bench Optimizer Barrier (результат не выбрасывается компилятором)
+template <typename T>
+inline void smartIntercomBenchKeep(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#define SMARTINTERCOM_BENCH_CONCAT2(a, b) a##b
+#define SMARTINTERCOM_BENCH_CONCAT(a, b) SMARTINTERCOM_BENCH_CONCAT2(a, b)
+#define SMARTINTERCOM_BENCHMARK(name, function)                                             \
+  static bool SMARTINTERCOM_BENCH_CONCAT(smartIntercomBenchRegistered, __LINE__)           \
+    __attribute__((unused)) =                                                               \
+    smartIntercomBenchRegister(name, function)
+
+// SmartIntercom Benchmark with a context (как BENCHMARK_CAPTURE у Google Benchmark)
+#define SMARTINTERCOM_BENCHMARK_CAPTURE(name, function, context)                           \
+  static bool SMARTINTERCOM_BENCH_CONCAT(smartIntercomBenchRegistered, __LINE__)           \
+    __attribute__((unused)) =                                                               \
+    smartIntercomBenchRegister(name, function, context)
+
+#endif // SMARTINTERCOM_BENCH_H
@@ -0,0 +1,692 @@
+/*
+ * smartintercom_bench.cpp - Микробенчмарки горячих путей SmartIntercom
+ *
+ * Измеряет на хосте настоящий код библиотеки на симулированной плате:
+ *
+ *   BM_RingCheck/...    SmartIntercomRing::smartIntercomCheck() по трассам
+ *                       АЦП (опрос из loop() и пакетная выборка по таймеру)
+ *   BM_Update/...       SmartIntercom::smartIntercomUpdate() в установившемся
+ *                       режиме (тишина и звонки с авто-открытием)
+ *   BM_StatusJson/...   сериализация статуса для /api/status (пересборка
+ *                       снимка, ответ целиком, 304 по ETag)
+ *   BM_RootPage/...     ответ на GET / (сжатая страница из PROGMEM)
+ *   BM_Config/...       разбор и применение POST /api/config
+ *   BM_OpJson/...       GET /api/ops/{id} (JSON в арене запроса)
+ *   BM_Begin/...        повторный smartIntercomBegin() SmartIntercomFixed
+ *                       (компоненты перестраиваются на месте)
+ *
+ * HTTP-бенчмарки проходят весь путь сервера - разбор запроса, маршрут,
+ * обработчик, заголовки и тело - через транспорт в памяти, который
+ * принимает ответ целиком. Время итераций с платой включает и
+ * smartIntercomAdvance() симулятора (шаг часов и таймер выборки).
+ * Обработка запросов не должна трогать общую кучу: operator new
+ * бенчмарка считает выделения, и HTTP-бенчмарк, в замере которого
+ * они были, помечается ошибкой. То же для BM_Begin: компоненты
+ * SmartIntercom строятся без кучи.
+ *
+ * Своя трасса задается файлом --trace (одно значение АЦП 0-1023 на
+ * строку, 1 кГц, или запись .sitr из GET /api/trace) и добавляет
+ * BM_RingCheck/poll/<имя файла>.
+ *
+ * Использование:
+ *   smartintercom_bench [--trace FILE] [--filter S] [--min-time-ms N]
+ *                       [--repetitions N] [--format console|json] [--out FILE]
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <SmartIntercom.h>
+#include <SmartIntercomFixed.h>
+#include <SmartIntercomApi.h>
+#include <SmartIntercomWebPage.h>
+#include "SmartIntercomBench.h"
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Bench Pins
+#define SMARTINTERCOM_BENCH_DOORBELL_PIN D1
+#define SMARTINTERCOM_BENCH_DOOR_PIN D2
+#define SMARTINTERCOM_BENCH_HANDSET_PIN D3
+#define SMARTINTERCOM_BENCH_LED_PIN D4
+
+// SmartIntercom Bench Trace Parameters (1 kHz выборка, звонок в конце каждого цикла)
+#define SMARTINTERCOM_BENCH_TRACE_MS 60000
+#define SMARTINTERCOM_BENCH_CYCLE_MS 5000
+#define SMARTINTERCOM_BENCH_RING_MS 2000
+#define SMARTINTERCOM_BENCH_TONE_HZ 125
+#define SMARTINTERCOM_BENCH_MAX_TRACES 4
+
+// SmartIntercom Bench Signal Kinds
+enum SmartIntercomBenchSignal {
+  SMARTINTERCOM_BENCH_IDLE,
+  SMARTINTERCOM_BENCH_LEVEL,
+  SMARTINTERCOM_BENCH_TONE
+};
+
+/*
+ * SmartIntercomBenchTrace - Трасса АЦП SmartIntercom для бенчмарков звонка
+ *
+ * Синтетические трассы строятся при первом использовании (вне замера),
+ * трассы из файлов загружаются в main().
+ */
+struct SmartIntercomBenchTrace {
+  SmartIntercomBenchSignal signal;
+  int noise;
+  unsigned int toneHz;
+  bool expectRings;
+  std::vector<uint16_t> samples;
+};
+
+static SmartIntercomBenchTrace smartIntercomBenchIdle = {SMARTINTERCOM_BENCH_IDLE, 20, 0, false, {}};
+static SmartIntercomBenchTrace smartIntercomBenchLevel = {SMARTINTERCOM_BENCH_LEVEL, 20, 0, true, {}};
+static SmartIntercomBenchTrace smartIntercomBenchTone = {SMARTINTERCOM_BENCH_TONE, 60, 0, true, {}};
+static SmartIntercomBenchTrace smartIntercomBenchGoertzel = {SMARTINTERCOM_BENCH_TONE, 150, SMARTINTERCOM_BENCH_TONE_HZ,
+                                                             true, {}};
+static SmartIntercomBenchTrace smartIntercomBenchFiles[SMARTINTERCOM_BENCH_MAX_TRACES];
+
+/*
+ * SmartIntercom Bench Noise
+ * Детерминированный шум SmartIntercom +-amplitude
+ */
+static int smartIntercomBenchNoise(uint32_t* state, int amplitude) {
+  *state = *state * 1664525UL + 1013904223UL;
+  return amplitude > 0 ? (int)((*state >> 8) % (2 * amplitude + 1)) - amplitude : 0;
+}
+
+/*
+ * SmartIntercom Bench Prepare Trace
+ * Циклы "тишина, затем звонок" длиной SMARTINTERCOM_BENCH_CYCLE_MS
+ */
+static const SmartIntercomBenchTrace& smartIntercomBenchPrepareTrace(SmartIntercomBenchTrace* trace) {
+  if (!trace->samples.empty()) {
+    return *trace;
+  }
+  uint32_t state = 12345;
+  trace->samples.resize(SMARTINTERCOM_BENCH_TRACE_MS);
+  for (size_t i = 0; i < trace->samples.size(); i++) {
+    size_t phaseMs = i % SMARTINTERCOM_BENCH_CYCLE_MS;
+    bool ringing = phaseMs >= SMARTINTERCOM_BENCH_CYCLE_MS - SMARTINTERCOM_BENCH_RING_MS;
+    int value = trace->signal == SMARTINTERCOM_BENCH_TONE ? 512 : 100;
+    if (ringing && trace->signal == SMARTINTERCOM_BENCH_LEVEL) {
+      value = 800;
+    } else if (ringing && trace->signal == SMARTINTERCOM_BENCH_TONE) {
+      value += (int)lround(300 * sin(2.0 * M_PI * SMARTINTERCOM_BENCH_TONE_HZ * i / 1000.0));
+    }
+    value += smartIntercomBenchNoise(&state, trace->noise);
+    trace->samples[i] = (uint16_t)(value < 0 ? 0 : (value > 1023 ? 1023 : value));
+  }
+  return *trace;
+}
+
+/*
+ * SmartIntercom Bench Load Trace
+ * Трасса SmartIntercom из файла .sitr или текстового: одно значение АЦП на строку
+ *
+ * Из .sitr берутся только значения: бенчмарк подает их по одному
+ * на миллисекунду, как и текстовую трассу.
+ */
+static bool smartIntercomBenchLoadTrace(const char* path, SmartIntercomBenchTrace* trace) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  trace->signal = SMARTINTERCOM_BENCH_IDLE;
+  trace->noise = 0;
+  trace->toneHz = 0;
+  trace->expectRings = false;
+  trace->samples.clear();
+
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[4096];
+  size_t read = 0;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    bytes.insert(bytes.end(), chunk, chunk + read);
+  }
+  SmartIntercomTraceReader reader(bytes.data(), bytes.size());
+  if (reader.smartIntercomBegin()) {
+    uint16_t sample = 0;
+    uint32_t timeUs = 0;
+    while (reader.smartIntercomNext(&sample, &timeUs)) {
+      trace->samples.push_back(sample > 1023 ? 1023 : sample);
+    }
+    fclose(file);
+    return !trace->samples.empty();
+  }
+
+  rewind(file);
+  long value = 0;
+  while (fscanf(file, "%ld", &value) == 1) {
+    trace->samples.push_back((uint16_t)(value < 0 ? 0 : (value > 1023 ? 1023 : value)));
+  }
+  fclose(file);
+  return !trace->samples.empty();
+}
+
+/*
+ * SmartIntercom Bench Trace Source
+ * Воспроизведение трассы SmartIntercom по кругу, отсчет на миллисекунду
+ */
+static int smartIntercomBenchTraceSource(void* context, uint64_t timeUs) {
+  const SmartIntercomBenchTrace* trace = static_cast<const SmartIntercomBenchTrace*>(context);
+  return trace->samples[(size_t)((timeUs / 1000) % trace->samples.size())];
+}
+
+/*
+ * SmartIntercom Bench Device Config
+ */
+static SmartIntercomConfig smartIntercomBenchConfig(bool alwaysOpen) {
+  SmartIntercomConfig config;
+  config.doorbellPin = SMARTINTERCOM_BENCH_DOORBELL_PIN;
+  config.doorOpenPin = SMARTINTERCOM_BENCH_DOOR_PIN;
+  config.handsetPin = SMARTINTERCOM_BENCH_HANDSET_PIN;
+  config.ledPin = SMARTINTERCOM_BENCH_LED_PIN;
+  config.openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = SMARTINTERCOM_DEFAULT_RING_TIMEOUT;
+  config.autoOpenEnabled = false;
+  config.alwaysOpenEnabled = alwaysOpen;
+  config.openDelay = 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  return config;
+}
+
+// ============================================================================
+// SmartIntercom Ring Check
+// ============================================================================
+
+/*
+ * SmartIntercom Bench Ring Poll
+ * Один отсчет на итерацию: шаг часов на 1 мс и smartIntercomCheck()
+ */
+static void smartIntercomBenchRingPoll(SmartIntercomBenchState& state) {
+  const SmartIntercomBenchTrace& trace =
+    smartIntercomBenchPrepareTrace(static_cast<SmartIntercomBenchTrace*>(state.smartIntercomGetContext()));
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_BENCH_DOORBELL_PIN, smartIntercomBenchTraceSource,
+                                     (void*)&trace);
+  SmartIntercomRing ring(SMARTINTERCOM_BENCH_DOORBELL_PIN);
+
+  uint64_t rings = 0;
+  while (state.smartIntercomKeepRunning()) {
+    board.smartIntercomAdvance(1000);
+    rings += ring.smartIntercomCheck() ? 1 : 0;
+  }
+  state.smartIntercomSetItemsProcessed(state.smartIntercomGetIterations());
+  if (trace.expectRings && state.smartIntercomGetIterations() >= 2 * SMARTINTERCOM_BENCH_CYCLE_MS && rings == 0) {
+    state.smartIntercomSkip("no rings detected on a ringing trace");
+  }
+}
+
+/*
+ * SmartIntercom Bench Ring Batch
+ * Пакет SMARTINTERCOM_RING_BATCH_SIZE отсчетов на итерацию: таймер
+ * выборки заполняет буфер, smartIntercomCheck() разбирает его разом
+ */
+static void smartIntercomBenchRingBatch(SmartIntercomBenchState& state) {
+  SmartIntercomBenchTrace* trace = static_cast<SmartIntercomBenchTrace*>(state.smartIntercomGetContext());
+  smartIntercomBenchPrepareTrace(trace);
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_BENCH_DOORBELL_PIN, smartIntercomBenchTraceSource, trace);
+  SmartIntercomRing ring(SMARTINTERCOM_BENCH_DOORBELL_PIN);
+  ring.smartIntercomBeginSampling(SMARTINTERCOM_RING_SAMPLE_PERIOD_US);
+  ring.smartIntercomSetToneFrequency(trace->toneHz);
+
+  uint64_t rings = 0;
+  while (state.smartIntercomKeepRunning()) {
+    board.smartIntercomAdvance((uint64_t)SMARTINTERCOM_RING_BATCH_SIZE * SMARTINTERCOM_RING_SAMPLE_PERIOD_US);
+    rings += ring.smartIntercomCheck() ? 1 : 0;
+  }
+  ring.smartIntercomEndSampling();
+  state.smartIntercomSetItemsProcessed(state.smartIntercomGetIterations() * SMARTINTERCOM_RING_BATCH_SIZE);
+  if (ring.smartIntercomGetDroppedSamples() > 0) {
+    state.smartIntercomSkip("sample buffer overflowed");
+  } else if (trace->expectRings && rings == 0 &&
+             state.smartIntercomGetIterations() * SMARTINTERCOM_RING_BATCH_SIZE >= 2 * SMARTINTERCOM_BENCH_CYCLE_MS) {
+    state.smartIntercomSkip("no rings detected on a ringing trace");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_RingCheck/poll/idle_noise", smartIntercomBenchRingPoll, &smartIntercomBenchIdle);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_RingCheck/poll/level_ring", smartIntercomBenchRingPoll, &smartIntercomBenchLevel);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_RingCheck/poll/tone_ring", smartIntercomBenchRingPoll, &smartIntercomBenchTone);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_RingCheck/batch/level_ring", smartIntercomBenchRingBatch, &smartIntercomBenchLevel);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_RingCheck/batch/tone_goertzel", smartIntercomBenchRingBatch,
+                                &smartIntercomBenchGoertzel);
+
+// ============================================================================
+// SmartIntercom Update
+// ============================================================================
+
+/*
+ * SmartIntercom Bench Count Event
+ */
+static void smartIntercomBenchCountEvent(const SmartIntercomEvent& event, void* context) {
+  (void)event;
+  (*static_cast<uint64_t*>(context))++;
+}
+
+/*
+ * SmartIntercom Bench Update
+ * Проход главного цикла SmartIntercom на миллисекунду времени платы
+ *
+ * С трассой звонков включено постоянное открытие: в замер попадают
+ * звонок, открытие, удержание и закрытие двери с событиями.
+ */
+static void smartIntercomBenchUpdate(SmartIntercomBenchState& state) {
+  SmartIntercomBenchTrace* trace = static_cast<SmartIntercomBenchTrace*>(state.smartIntercomGetContext());
+  smartIntercomBenchPrepareTrace(trace);
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_BENCH_DOORBELL_PIN, smartIntercomBenchTraceSource, trace);
+
+  SmartIntercom smartIntercom;
+  smartIntercom.smartIntercomBegin(smartIntercomBenchConfig(trace->expectRings));
+  SmartIntercomMetrics metrics;
+  smartIntercom.smartIntercomAttachMetrics(&metrics);
+  uint64_t opens = 0;
+  smartIntercom.smartIntercomSubscribe(smartIntercomBenchCountEvent, &opens,
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_OPEN));
+
+  while (state.smartIntercomKeepRunning()) {
+    smartIntercom.smartIntercomUpdate();
+    board.smartIntercomAdvance(1000);
+  }
+  if (trace->expectRings && state.smartIntercomGetIterations() >= 2 * SMARTINTERCOM_BENCH_CYCLE_MS &&
+      opens == 0) {
+    state.smartIntercomSkip("door never opened on a ringing trace");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_Update/idle", smartIntercomBenchUpdate, &smartIntercomBenchIdle);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_Update/auto_open", smartIntercomBenchUpdate, &smartIntercomBenchLevel);
+
+// ============================================================================
+// SmartIntercom HTTP (API status, root page, config)
+// ============================================================================
+
+// SmartIntercom Bench Heap Allocations (operator new; String на хосте тоже идет через него)
+static uint64_t smartIntercomBenchAllocations = 0;
+
+void* operator new(size_t size) {
+  smartIntercomBenchAllocations++;
+  void* block = malloc(size > 0 ? size : 1);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void operator delete(void* block) noexcept {
+  free(block);
+}
+
+void operator delete(void* block, size_t size) noexcept {
+  (void)size;
+  free(block);
+}
+
+/*
+ * SmartIntercomBenchTransport - Транспорт SmartIntercom в памяти
+ *
+ * Принимает весь ответ сразу, запоминает код статуса из первой
+ * строки и считает байты; запросы подаются прямо в буфер соединения.
+ */
+class SmartIntercomBenchTransport : public SmartIntercomHttpTransport {
+public:
+  uint64_t smartIntercomBytes;
+  int smartIntercomStatus;
+  bool smartIntercomAtStart;
+  bool smartIntercomClosed;
+
+  SmartIntercomBenchTransport() {
+    smartIntercomBytes = 0;
+    smartIntercomStatus = 0;
+    smartIntercomAtStart = false;
+    smartIntercomClosed = true;
+  }
+
+  bool smartIntercomListen(uint16_t port) override {
+    (void)port;
+    return true;
+  }
+
+  void smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) override {
+    (void)server;
+    (void)timeoutMs;
+  }
+
+  size_t smartIntercomSend(uint8_t connection, const uint8_t* data, size_t length) override {
+    (void)connection;
+    if (smartIntercomAtStart && length > 12) {
+      smartIntercomStatus = atoi((const char*)data + 9);
+      smartIntercomAtStart = false;
+    }
+    smartIntercomBytes += length;
+    return length;
+  }
+
+  void smartIntercomClose(uint8_t connection) override {
+    (void)connection;
+    smartIntercomClosed = true;
+  }
+};
+
+/*
+ * SmartIntercomBenchHttp - Устройство, сервер и API SmartIntercom для HTTP-бенчмарков
+ */
+struct SmartIntercomBenchHttp {
+  SmartIntercomSimBoard board;
+  SmartIntercom smartIntercom;
+  SmartIntercomSimFlash flash;
+  SmartIntercomConfigStore store;
+  SmartIntercomBenchTransport transport;
+  SmartIntercomHttpServer server;
+  SmartIntercomApi api;
+  uint8_t connection;
+};
+
+/*
+ * SmartIntercom Bench Handle Root
+ * Тот же обработчик "/", что в SmartIntercom.ino
+ */
+static void smartIntercomBenchHandleRoot(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                         void* context) {
+  (void)request;
+  (void)context;
+  response.smartIntercomAddHeader("Content-Encoding", "gzip");
+  response.smartIntercomSendStatic(200, "text/html; charset=utf-8", SMARTINTERCOM_WEB_PAGE_GZ,
+                                   SMARTINTERCOM_WEB_PAGE_GZ_LENGTH, true);
+}
+
+static bool smartIntercomBenchWifiProbe(void* context) {
+  (void)context;
+  return true;
+}
+
+static void smartIntercomBenchHttpBegin(SmartIntercomBenchHttp& http) {
+  http.board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&http.board);
+  http.board.smartIntercomSetAnalog(SMARTINTERCOM_BENCH_DOORBELL_PIN, 100);
+  http.smartIntercom.smartIntercomBegin(smartIntercomBenchConfig(false));
+  http.store.smartIntercomBegin(&http.flash);
+  http.smartIntercom.smartIntercomAttachConfigStore(&http.store);
+  http.server.smartIntercomBegin(&http.transport, 80);
+  http.server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/", smartIntercomBenchHandleRoot);
+  http.api.smartIntercomBegin(http.smartIntercom, http.server, "SmartIntercom Bench", SMARTINTERCOM_LIB_VERSION);
+  http.api.smartIntercomSetWifiProbe(smartIntercomBenchWifiProbe, nullptr);
+  http.connection = SMARTINTERCOM_HTTP_NO_CONNECTION;
+}
+
+/*
+ * SmartIntercom Bench Request
+ * Запрос SmartIntercom по keep-alive соединению; возвращает код ответа
+ *
+ * Сервер закрывает соединение после SMARTINTERCOM_HTTP_KEEPALIVE_MAX
+ * запросов, тогда принимается новое - как у настоящего клиента.
+ */
+static int smartIntercomBenchRequest(SmartIntercomBenchHttp& http, const char* text, size_t length) {
+  if (http.transport.smartIntercomClosed) {
+    http.connection = http.server.smartIntercomOnAccept();
+    http.transport.smartIntercomClosed = false;
+  }
+  char* buffer = nullptr;
+  if (http.server.smartIntercomGetReceiveSpace(http.connection, &buffer) < length) {
+    return 0;
+  }
+  memcpy(buffer, text, length);
+  http.transport.smartIntercomStatus = 0;
+  http.transport.smartIntercomAtStart = true;
+  http.server.smartIntercomOnReceived(http.connection, length);
+  return http.transport.smartIntercomStatus;
+}
+
+/*
+ * SmartIntercom Bench Status Rebuild
+ * Только сериализация: пересборка снимка статуса после изменения
+ */
+static void smartIntercomBenchStatusRebuild(SmartIntercomBenchState& state) {
+  SmartIntercomBenchHttp http;
+  smartIntercomBenchHttpBegin(http);
+  SmartIntercomStatusSnapshot& snapshot = http.api.smartIntercomGetSnapshot();
+
+  uint64_t bytes = 0;
+  while (state.smartIntercomKeepRunning()) {
+    snapshot.smartIntercomInvalidate();
+    size_t length = 0;
+    smartIntercomBenchKeep(snapshot.smartIntercomGetJson(&length));
+    bytes += length;
+  }
+  state.smartIntercomSetBytesProcessed(bytes);
+}
+
+// SmartIntercom Bench Status Request Modes
+enum SmartIntercomBenchStatusMode {
+  SMARTINTERCOM_BENCH_STATUS_CHANGED,
+  SMARTINTERCOM_BENCH_STATUS_CACHED,
+  SMARTINTERCOM_BENCH_STATUS_NOT_MODIFIED
+};
+
+static SmartIntercomBenchStatusMode smartIntercomBenchStatusChanged = SMARTINTERCOM_BENCH_STATUS_CHANGED;
+static SmartIntercomBenchStatusMode smartIntercomBenchStatusCached = SMARTINTERCOM_BENCH_STATUS_CACHED;
+static SmartIntercomBenchStatusMode smartIntercomBenchStatusNotModified = SMARTINTERCOM_BENCH_STATUS_NOT_MODIFIED;
+
+/*
+ * SmartIntercom Bench Status Request
+ * GET /api/status целиком; context - режим (пересборка, кэш, 304)
+ */
+
+static void smartIntercomBenchStatusRequest(SmartIntercomBenchState& state) {
+  SmartIntercomBenchStatusMode mode = *static_cast<SmartIntercomBenchStatusMode*>(state.smartIntercomGetContext());
+  SmartIntercomBenchHttp http;
+  smartIntercomBenchHttpBegin(http);
+  SmartIntercomStatusSnapshot& snapshot = http.api.smartIntercomGetSnapshot();
+
+  char request[192];
+  size_t length = 0;
+  snapshot.smartIntercomGetJson(&length);
+  if (mode == SMARTINTERCOM_BENCH_STATUS_NOT_MODIFIED) {
+    length = snprintf(request, sizeof(request), "GET /api/status HTTP/1.1\r\nHost: bench\r\nIf-None-Match: %s\r\n\r\n",
+                      snapshot.smartIntercomGetETag());
+  } else {
+    length = snprintf(request, sizeof(request), "GET /api/status HTTP/1.1\r\nHost: bench\r\n\r\n");
+  }
+  int expected = mode == SMARTINTERCOM_BENCH_STATUS_NOT_MODIFIED ? 304 : 200;
+
+  bool failed = false;
+  http.transport.smartIntercomBytes = 0;
+  uint64_t allocations = smartIntercomBenchAllocations;
+  while (state.smartIntercomKeepRunning()) {
+    if (mode == SMARTINTERCOM_BENCH_STATUS_CHANGED) {
+      snapshot.smartIntercomInvalidate();
+    }
+    failed |= smartIntercomBenchRequest(http, request, length) != expected;
+  }
+  state.smartIntercomSetBytesProcessed(http.transport.smartIntercomBytes);
+  if (failed) {
+    state.smartIntercomSkip("unexpected /api/status response code");
+  } else if (smartIntercomBenchAllocations != allocations) {
+    state.smartIntercomSkip("heap allocation while serving /api/status");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK("BM_StatusJson/rebuild", smartIntercomBenchStatusRebuild);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_StatusJson/http_changed", smartIntercomBenchStatusRequest,
+                                &smartIntercomBenchStatusChanged);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_StatusJson/http_cached", smartIntercomBenchStatusRequest,
+                                &smartIntercomBenchStatusCached);
+SMARTINTERCOM_BENCHMARK_CAPTURE("BM_StatusJson/http_304", smartIntercomBenchStatusRequest,
+                                &smartIntercomBenchStatusNotModified);
+
+/*
+ * SmartIntercom Bench Root Page
+ * GET / : заголовки и 1108 байт сжатой страницы частями из PROGMEM
+ */
+static void smartIntercomBenchRootPage(SmartIntercomBenchState& state) {
+  SmartIntercomBenchHttp http;
+  smartIntercomBenchHttpBegin(http);
+  static const char request[] = "GET / HTTP/1.1\r\nHost: bench\r\nAccept-Encoding: gzip\r\n\r\n";
+
+  bool failed = false;
+  http.transport.smartIntercomBytes = 0;
+  uint64_t allocations = smartIntercomBenchAllocations;
+  while (state.smartIntercomKeepRunning()) {
+    failed |= smartIntercomBenchRequest(http, request, sizeof(request) - 1) != 200;
+  }
+  state.smartIntercomSetBytesProcessed(http.transport.smartIntercomBytes);
+  if (failed) {
+    state.smartIntercomSkip("unexpected / response code");
+  } else if (smartIntercomBenchAllocations != allocations) {
+    state.smartIntercomSkip("heap allocation while serving /");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK("BM_RootPage/http_get", smartIntercomBenchRootPage);
+
+/*
+ * SmartIntercom Bench Config Apply
+ * POST /api/config: разбор JSON, smartIntercomSetConfig() и доставка
+ * события CONFIG подписчикам (журнал конфигурации помечает запись)
+ */
+static void smartIntercomBenchConfigApply(SmartIntercomBenchState& state) {
+  SmartIntercomBenchHttp http;
+  smartIntercomBenchHttpBegin(http);
+  static const char body[] = "{\"auto_open\":true,\"always_open\":false,\"open_delay\":250,\"led_brightness\":128}";
+  char request[256];
+  size_t length = snprintf(request, sizeof(request),
+                           "POST /api/config HTTP/1.1\r\nHost: bench\r\nContent-Type: application/json\r\n"
+                           "Content-Length: %u\r\n\r\n%s",
+                           (unsigned int)(sizeof(body) - 1), body);
+  SmartIntercomEventQueue& events = http.smartIntercom.smartIntercomGetEvents();
+
+  bool failed = false;
+  uint64_t allocations = smartIntercomBenchAllocations;
+  while (state.smartIntercomKeepRunning()) {
+    failed |= smartIntercomBenchRequest(http, request, length) != 200;
+    events.smartIntercomDispatch();
+  }
+  if (failed || http.smartIntercom.smartIntercomGetConfig().openDelay != 250) {
+    state.smartIntercomSkip("POST /api/config was not applied");
+  } else if (smartIntercomBenchAllocations != allocations) {
+    state.smartIntercomSkip("heap allocation while serving POST /api/config");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK("BM_Config/http_post", smartIntercomBenchConfigApply);
+
+/*
+ * SmartIntercom Bench Op JSON
+ * GET /api/ops/{id}: JSON операции собирается в арене запроса
+ */
+static void smartIntercomBenchOpJson(SmartIntercomBenchState& state) {
+  SmartIntercomBenchHttp http;
+  smartIntercomBenchHttpBegin(http);
+  static const char open[] = "POST /api/open HTTP/1.1\r\nHost: bench\r\nContent-Length: 0\r\n\r\n";
+  static const char request[] = "GET /api/ops/1 HTTP/1.1\r\nHost: bench\r\n\r\n";
+  bool failed = smartIntercomBenchRequest(http, open, sizeof(open) - 1) != 202;
+
+  http.transport.smartIntercomBytes = 0;
+  uint64_t allocations = smartIntercomBenchAllocations;
+  while (state.smartIntercomKeepRunning()) {
+    failed |= smartIntercomBenchRequest(http, request, sizeof(request) - 1) != 200;
+  }
+  state.smartIntercomSetBytesProcessed(http.transport.smartIntercomBytes);
+  if (failed) {
+    state.smartIntercomSkip("unexpected /api/ops response code");
+  } else if (smartIntercomBenchAllocations != allocations) {
+    state.smartIntercomSkip("heap allocation while serving /api/ops");
+  } else if (http.server.smartIntercomGetArena().smartIntercomGetUsed() != 0) {
+    state.smartIntercomSkip("request arena was not reset after the response");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK("BM_OpJson/http_get", smartIntercomBenchOpJson);
+
+// ============================================================================
+// SmartIntercom Begin (компоненты без кучи)
+// ============================================================================
+
+/*
+ * SmartIntercomBenchBoard - Разводка бенчмарка как Config SmartIntercomFixed
+ */
+struct SmartIntercomBenchBoard : SmartIntercomFixedDefaults {
+  static const int doorbellPin = SMARTINTERCOM_BENCH_DOORBELL_PIN;
+  static const int doorOpenPin = SMARTINTERCOM_BENCH_DOOR_PIN;
+  static const int handsetPin = SMARTINTERCOM_BENCH_HANDSET_PIN;
+  static const int ledPin = SMARTINTERCOM_BENCH_LED_PIN;
+  static const bool inverted = true;
+  static const unsigned long ringSamplePeriodUs = SMARTINTERCOM_RING_SAMPLE_PERIOD_US;
+};
+
+/*
+ * SmartIntercom Bench Begin
+ * smartIntercomBegin() на каждой итерации: прежние компоненты с
+ * таймером выборки и задачами мигания разбираются, новые строятся
+ * в том же хранилище
+ */
+static void smartIntercomBenchBegin(SmartIntercomBenchState& state) {
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  SmartIntercomFixed<SmartIntercomBenchBoard> smartIntercom;
+  smartIntercom.smartIntercomBegin();
+  smartIntercom.smartIntercomOpenDoor();
+  smartIntercom.smartIntercomUpdate();
+  uint8_t jobs = smartIntercomScheduler.smartIntercomGetPendingCount();
+
+  uint64_t allocations = smartIntercomBenchAllocations;
+  while (state.smartIntercomKeepRunning()) {
+    smartIntercom.smartIntercomBegin();
+    smartIntercom.smartIntercomOpenDoor();
+    smartIntercom.smartIntercomUpdate();
+  }
+  if (smartIntercomBenchAllocations != allocations) {
+    state.smartIntercomSkip("heap allocation while rebuilding the components");
+  } else if (smartIntercomScheduler.smartIntercomGetPendingCount() != jobs) {
+    state.smartIntercomSkip("scheduler jobs of the previous components were not cancelled");
+  }
+}
+
+SMARTINTERCOM_BENCHMARK("BM_Begin/fixed_rebuild", smartIntercomBenchBegin);
+
+// ============================================================================
+// SmartIntercom Bench Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  SmartIntercomBenchOptions options;
+  smartIntercomBenchDefaultOptions(&options);
+  size_t traces = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc && traces < SMARTINTERCOM_BENCH_MAX_TRACES) {
+      const char* path = argv[++i];
+      if (!smartIntercomBenchLoadTrace(path, &smartIntercomBenchFiles[traces])) {
+        fprintf(stderr, "SmartIntercom: cannot read trace %s\n", path);
+        return 2;
+      }
+      const char* base = strrchr(path, '/');
+      char name[64];
+      snprintf(name, sizeof(name), "BM_RingCheck/poll/%s", base ? base + 1 : path);
+      smartIntercomBenchRegister(name, smartIntercomBenchRingPoll, &smartIntercomBenchFiles[traces]);
+      traces++;
+    } else if (!smartIntercomBenchParseOption(argc, argv, &i, &options)) {
+      fprintf(stderr, "usage: %s [--trace FILE] %s\n", argv[0], smartIntercomBenchUsage());
+      return 2;
+    }
+  }
+
+  Serial.smartIntercomSetEnabled(false);
+  return smartIntercomBenchRunAll(options, argv[0]);
+}
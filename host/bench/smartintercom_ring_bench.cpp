@@ -0,0 +1,151 @@
+/*
+ * smartintercom_ring_bench.cpp - Бенчмарк классификатора звонка SmartIntercom
+ *
+ * Прогоняет SmartIntercomRingClassifier по синтетическим трассам АЦП
+ * (тишина с шумом, звонок уровнем, звонок тоном с шумом) и печатает
+ * стоимость обработки одного отсчета в наносекундах и тактах TSC
+ * (на x86; на других архитектурах такты не измеряются).
+ *
+ * Использование:
+ *   smartintercom_ring_bench [--samples N] [--repeat R]
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <SmartIntercomRingClassifier.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SMARTINTERCOM_BENCH_HAS_TSC 1
+#else
+#define SMARTINTERCOM_BENCH_HAS_TSC 0
+#endif
+
+// SmartIntercom Bench Trace Parameters (1 kHz выборка)
+#define SMARTINTERCOM_BENCH_PERIOD_US 1000
+#define SMARTINTERCOM_BENCH_TONE_HZ 125
+#define SMARTINTERCOM_BENCH_RING_MS 2000
+#define SMARTINTERCOM_BENCH_CYCLE_MS 5000
+
+// SmartIntercom Bench Signal Kinds
+enum SmartIntercomBenchSignal {
+  SMARTINTERCOM_BENCH_IDLE,
+  SMARTINTERCOM_BENCH_LEVEL,
+  SMARTINTERCOM_BENCH_TONE
+};
+
+/*
+ * SmartIntercomBenchCase - Трасса бенчмарка SmartIntercom
+ */
+struct SmartIntercomBenchCase {
+  const char* name;
+  unsigned int toneHz;
+  std::vector<uint16_t> samples;
+};
+
+/*
+ * SmartIntercom Bench Noise
+ * Детерминированный шум SmartIntercom +-amplitude
+ */
+static int smartIntercomBenchNoise(uint32_t* state, int amplitude) {
+  *state = *state * 1664525UL + 1013904223UL;
+  return amplitude > 0 ? (int)((*state >> 8) % (2 * amplitude + 1)) - amplitude : 0;
+}
+
+/*
+ * SmartIntercom Bench Make Trace
+ * Циклы "тишина, затем звонок" длиной SMARTINTERCOM_BENCH_CYCLE_MS
+ */
+static void smartIntercomBenchMakeTrace(SmartIntercomBenchCase* benchCase, size_t count,
+                                        SmartIntercomBenchSignal signal, int noise) {
+  uint32_t state = 12345;
+  benchCase->samples.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    size_t phaseMs = i % SMARTINTERCOM_BENCH_CYCLE_MS;
+    bool ringing = phaseMs >= SMARTINTERCOM_BENCH_CYCLE_MS - SMARTINTERCOM_BENCH_RING_MS;
+    int value = signal == SMARTINTERCOM_BENCH_TONE ? 512 : 100;
+    if (ringing && signal == SMARTINTERCOM_BENCH_LEVEL) {
+      value = 800;
+    } else if (ringing && signal == SMARTINTERCOM_BENCH_TONE) {
+      value += (int)lround(300 * sin(2.0 * M_PI * SMARTINTERCOM_BENCH_TONE_HZ * i / 1000.0));
+    }
+    value += smartIntercomBenchNoise(&state, noise);
+    benchCase->samples[i] = (uint16_t)(value < 0 ? 0 : (value > 1023 ? 1023 : value));
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t sampleCount = 1000000;
+  int repeat = 20;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--samples") == 0 && hasValue) {
+      sampleCount = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--repeat") == 0 && hasValue) {
+      repeat = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [--samples N] [--repeat R]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (sampleCount == 0 || repeat <= 0) {
+    return 2;
+  }
+
+  SmartIntercomBenchCase cases[4];
+  cases[0].name = "idle_noise";
+  cases[0].toneHz = 0;
+  smartIntercomBenchMakeTrace(&cases[0], sampleCount, SMARTINTERCOM_BENCH_IDLE, 20);
+  cases[1].name = "level_ring";
+  cases[1].toneHz = 0;
+  smartIntercomBenchMakeTrace(&cases[1], sampleCount, SMARTINTERCOM_BENCH_LEVEL, 20);
+  cases[2].name = "tone_ring_envelope";
+  cases[2].toneHz = 0;
+  smartIntercomBenchMakeTrace(&cases[2], sampleCount, SMARTINTERCOM_BENCH_TONE, 60);
+  cases[3].name = "tone_ring_goertzel";
+  cases[3].toneHz = SMARTINTERCOM_BENCH_TONE_HZ;
+  smartIntercomBenchMakeTrace(&cases[3], sampleCount, SMARTINTERCOM_BENCH_TONE, 150);
+
+  printf("%-20s %12s %14s %18s %8s\n", "case", "samples", "ns_per_sample", "cycles_per_sample", "rings");
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    SmartIntercomBenchCase& benchCase = cases[c];
+    SmartIntercomRingClassifier classifier;
+    classifier.smartIntercomSetTone(SMARTINTERCOM_BENCH_PERIOD_US, benchCase.toneHz);
+    unsigned long rings = 0;
+    const uint16_t* samples = benchCase.samples.data();
+
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+#if SMARTINTERCOM_BENCH_HAS_TSC
+    uint64_t cyclesStarted = __rdtsc();
+#endif
+    for (int r = 0; r < repeat; r++) {
+      classifier.smartIntercomReset();
+      for (size_t i = 0; i < sampleCount; i++) {
+        if (classifier.smartIntercomProcess(samples[i], (unsigned long)i) == SMARTINTERCOM_RING_EVENT_START) {
+          rings++;
+        }
+      }
+    }
+#if SMARTINTERCOM_BENCH_HAS_TSC
+    uint64_t cycles = __rdtsc() - cyclesStarted;
+#endif
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    double total = (double)sampleCount * repeat;
+
+#if SMARTINTERCOM_BENCH_HAS_TSC
+    printf("%-20s %12.0f %14.2f %18.2f %8lu\n", benchCase.name, total, seconds * 1e9 / total,
+           cycles / total, rings / repeat);
+#else
+    printf("%-20s %12.0f %14.2f %18s %8lu\n", benchCase.name, total, seconds * 1e9 / total, "n/a",
+           rings / repeat);
+#endif
+  }
+  return 0;
+}
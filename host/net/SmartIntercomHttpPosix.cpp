@@ -0,0 +1,236 @@
+/*
+ * SmartIntercomHttpPosix.cpp - Реализация транспорта SmartIntercom на epoll
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomHttpPosix.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// SmartIntercom Listen Socket Marker (epoll data for the listening socket)
+#define SMARTINTERCOM_POSIX_LISTEN_ID 0xFFFFFFFFu
+#define SMARTINTERCOM_POSIX_EVENTS 32
+
+/*
+ * SmartIntercomHttpTransportPosix Constructor
+ */
+SmartIntercomHttpTransportPosix::SmartIntercomHttpTransportPosix() {
+  smartIntercomListenFd = -1;
+  smartIntercomEpollFd = -1;
+  smartIntercomServer = nullptr;
+  for (uint8_t i = 0; i < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; i++) {
+    smartIntercomFds[i] = -1;
+    smartIntercomInterest[i] = 0;
+  }
+}
+
+SmartIntercomHttpTransportPosix::~SmartIntercomHttpTransportPosix() {
+  for (uint8_t i = 0; i < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; i++) {
+    smartIntercomRelease(i);
+  }
+  if (smartIntercomListenFd >= 0) {
+    close(smartIntercomListenFd);
+  }
+  if (smartIntercomEpollFd >= 0) {
+    close(smartIntercomEpollFd);
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Listen
+ */
+bool SmartIntercomHttpTransportPosix::smartIntercomListen(uint16_t port) {
+  smartIntercomListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (smartIntercomListenFd < 0) {
+    return false;
+  }
+  int enable = 1;
+  setsockopt(smartIntercomListenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(smartIntercomListenFd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+      listen(smartIntercomListenFd, 128) < 0) {
+    return false;
+  }
+
+  smartIntercomEpollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (smartIntercomEpollFd < 0) {
+    return false;
+  }
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.u32 = SMARTINTERCOM_POSIX_LISTEN_ID;
+  return epoll_ctl(smartIntercomEpollFd, EPOLL_CTL_ADD, smartIntercomListenFd, &event) == 0;
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Poll
+ * Ожидание событий epoll SmartIntercom не дольше timeoutMs
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) {
+  smartIntercomServer = &server;
+  struct epoll_event events[SMARTINTERCOM_POSIX_EVENTS];
+  int count = epoll_wait(smartIntercomEpollFd, events, SMARTINTERCOM_POSIX_EVENTS, (int)timeoutMs);
+
+  for (int i = 0; i < count; i++) {
+    uint32_t id = events[i].data.u32;
+    if (id == SMARTINTERCOM_POSIX_LISTEN_ID) {
+      smartIntercomAcceptAll(server);
+      continue;
+    }
+    if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || smartIntercomFds[id] < 0) {
+      continue;
+    }
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      smartIntercomReadAll(server, (uint8_t)id);
+    }
+    if (smartIntercomFds[id] >= 0 && (events[i].events & EPOLLOUT)) {
+      server.smartIntercomOnWritable((uint8_t)id);
+    }
+  }
+
+  // SmartIntercom Keep epoll interest in sync with each connection's buffers
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    if (smartIntercomFds[id] >= 0) {
+      smartIntercomUpdateInterest(server, id);
+    }
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Accept All
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomAcceptAll(SmartIntercomHttpServer& server) {
+  for (;;) {
+    int fd = accept4(smartIntercomListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    uint8_t id = server.smartIntercomOnAccept();
+    if (id == SMARTINTERCOM_HTTP_NO_CONNECTION) {
+      static const char smartIntercomBusy[] =
+        "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      ssize_t ignored = send(fd, smartIntercomBusy, sizeof(smartIntercomBusy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+      (void)ignored;
+      close(fd);
+      continue;
+    }
+
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    smartIntercomFds[id] = fd;
+    smartIntercomInterest[id] = EPOLLIN;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = id;
+    epoll_ctl(smartIntercomEpollFd, EPOLL_CTL_ADD, fd, &event);
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Read All
+ * Прочитать в буфер соединения SmartIntercom все, что уже пришло
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomReadAll(SmartIntercomHttpServer& server, uint8_t id) {
+  while (smartIntercomFds[id] >= 0) {
+    char* buffer = nullptr;
+    size_t space = server.smartIntercomGetReceiveSpace(id, &buffer);
+    if (space == 0) {
+      return;
+    }
+    ssize_t received = recv(smartIntercomFds[id], buffer, space, 0);
+    if (received > 0) {
+      server.smartIntercomOnReceived(id, (size_t)received);
+      continue;
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return;
+    }
+    // SmartIntercom Peer closed or reset the connection
+    smartIntercomRelease(id);
+    server.smartIntercomOnClosed(id);
+    return;
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Update Interest
+ * Читать, пока есть место в буфере запроса; писать, пока есть ответ
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomUpdateInterest(SmartIntercomHttpServer& server, uint8_t id) {
+  char* buffer = nullptr;
+  uint32_t interest = 0;
+  if (server.smartIntercomGetReceiveSpace(id, &buffer) > 0) {
+    interest |= EPOLLIN;
+  }
+  if (server.smartIntercomWantsWrite(id)) {
+    interest |= EPOLLOUT;
+  }
+  if (interest == smartIntercomInterest[id]) {
+    return;
+  }
+  smartIntercomInterest[id] = interest;
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = interest;
+  event.data.u32 = id;
+  epoll_ctl(smartIntercomEpollFd, EPOLL_CTL_MOD, smartIntercomFds[id], &event);
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Send
+ */
+size_t SmartIntercomHttpTransportPosix::smartIntercomSend(uint8_t id, const uint8_t* data, size_t length) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || smartIntercomFds[id] < 0) {
+    return 0;
+  }
+  ssize_t sent = send(smartIntercomFds[id], data, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+  if (sent >= 0) {
+    return (size_t)sent;
+  }
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+    return 0;
+  }
+  smartIntercomRelease(id);
+  if (smartIntercomServer) {
+    smartIntercomServer->smartIntercomOnClosed(id);
+  }
+  return 0;
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Close
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomClose(uint8_t id) {
+  if (id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS) {
+    smartIntercomRelease(id);
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportPosix Release
+ */
+void SmartIntercomHttpTransportPosix::smartIntercomRelease(uint8_t id) {
+  if (smartIntercomFds[id] < 0) {
+    return;
+  }
+  epoll_ctl(smartIntercomEpollFd, EPOLL_CTL_DEL, smartIntercomFds[id], nullptr);
+  close(smartIntercomFds[id]);
+  smartIntercomFds[id] = -1;
+  smartIntercomInterest[id] = 0;
+}
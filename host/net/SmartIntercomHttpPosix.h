@@ -0,0 +1,51 @@
+/*
+ * SmartIntercomHttpPosix.h - Транспорт HTTP-сервера SmartIntercom на epoll
+ *
+ * Хостовый транспорт для Linux: неблокирующие сокеты POSIX и epoll.
+ * Через него те же SmartIntercomHttpServer и SmartIntercomApi, что и
+ * в прошивке, обслуживают запросы на рабочей станции, поэтому сервер
+ * можно нагружать обычными инструментами (wrk, ab, curl).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HTTP_POSIX_H
+#define SMARTINTERCOM_HTTP_POSIX_H
+
+#include <stdint.h>
+#include "SmartIntercomHttp.h"
+
+/*
+ * SmartIntercomHttpTransportPosix - Транспорт SmartIntercom на epoll
+ *
+ * Соединение сверх SMARTINTERCOM_HTTP_MAX_CONNECTIONS принимается и
+ * сразу получает 503, чтобы не держать очередь listen под нагрузкой.
+ */
+class SmartIntercomHttpTransportPosix : public SmartIntercomHttpTransport {
+private:
+  int smartIntercomListenFd;
+  int smartIntercomEpollFd;
+  int smartIntercomFds[SMARTINTERCOM_HTTP_MAX_CONNECTIONS];
+  uint32_t smartIntercomInterest[SMARTINTERCOM_HTTP_MAX_CONNECTIONS];
+  SmartIntercomHttpServer* smartIntercomServer;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomAcceptAll(SmartIntercomHttpServer& server);
+  void smartIntercomReadAll(SmartIntercomHttpServer& server, uint8_t id);
+  void smartIntercomUpdateInterest(SmartIntercomHttpServer& server, uint8_t id);
+  void smartIntercomRelease(uint8_t id);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomHttpTransportPosix();
+  ~SmartIntercomHttpTransportPosix();
+
+  // SmartIntercom Transport Implementation
+  bool smartIntercomListen(uint16_t port) override;
+  void smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) override;
+  size_t smartIntercomSend(uint8_t connection, const uint8_t* data, size_t length) override;
+  void smartIntercomClose(uint8_t connection) override;
+};
+
+#endif // SMARTINTERCOM_HTTP_POSIX_H
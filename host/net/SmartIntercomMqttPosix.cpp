@@ -0,0 +1,135 @@
+/*
+ * SmartIntercomMqttPosix.cpp - Реализация транспорта MQTT SmartIntercom на сокетах POSIX
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomMqttPosix.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+ * SmartIntercomMqttTransportPosix Constructor
+ */
+SmartIntercomMqttTransportPosix::SmartIntercomMqttTransportPosix() {
+  smartIntercomFd = -1;
+  smartIntercomLink = SMARTINTERCOM_MQTT_LINK_DOWN;
+}
+
+SmartIntercomMqttTransportPosix::~SmartIntercomMqttTransportPosix() {
+  smartIntercomClose();
+}
+
+/*
+ * SmartIntercomMqttTransportPosix Connect
+ * Неблокирующий connect() SmartIntercom; имя разрешается getaddrinfo()
+ */
+bool SmartIntercomMqttTransportPosix::smartIntercomConnect(const char* host, uint16_t port) {
+  smartIntercomClose();
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", (unsigned)port);
+  struct addrinfo* addresses = nullptr;
+  if (getaddrinfo(host, service, &hints, &addresses) != 0 || addresses == nullptr) {
+    return false;
+  }
+
+  smartIntercomFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (smartIntercomFd < 0) {
+    freeaddrinfo(addresses);
+    return false;
+  }
+  int enable = 1;
+  setsockopt(smartIntercomFd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  int result = connect(smartIntercomFd, addresses->ai_addr, addresses->ai_addrlen);
+  freeaddrinfo(addresses);
+  if (result < 0 && errno != EINPROGRESS) {
+    smartIntercomClose();
+    return false;
+  }
+  smartIntercomLink = result == 0 ? SMARTINTERCOM_MQTT_LINK_UP : SMARTINTERCOM_MQTT_LINK_CONNECTING;
+  return true;
+}
+
+/*
+ * SmartIntercomMqttTransportPosix Get Link
+ * Завершение connect() SmartIntercom проверяется без ожидания
+ */
+SmartIntercomMqttLink SmartIntercomMqttTransportPosix::smartIntercomGetLink() {
+  if (smartIntercomLink != SMARTINTERCOM_MQTT_LINK_CONNECTING) {
+    return smartIntercomLink;
+  }
+  struct pollfd descriptor;
+  descriptor.fd = smartIntercomFd;
+  descriptor.events = POLLOUT;
+  descriptor.revents = 0;
+  if (poll(&descriptor, 1, 0) <= 0) {
+    return smartIntercomLink;
+  }
+  int error = 0;
+  socklen_t length = sizeof(error);
+  getsockopt(smartIntercomFd, SOL_SOCKET, SO_ERROR, &error, &length);
+  if (error != 0) {
+    smartIntercomClose();
+  } else {
+    smartIntercomLink = SMARTINTERCOM_MQTT_LINK_UP;
+  }
+  return smartIntercomLink;
+}
+
+/*
+ * SmartIntercomMqttTransportPosix Read
+ */
+size_t SmartIntercomMqttTransportPosix::smartIntercomRead(uint8_t* buffer, size_t size) {
+  if (smartIntercomLink != SMARTINTERCOM_MQTT_LINK_UP) {
+    return 0;
+  }
+  ssize_t received = recv(smartIntercomFd, buffer, size, MSG_DONTWAIT);
+  if (received > 0) {
+    return (size_t)received;
+  }
+  if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+    return 0;
+  }
+  // SmartIntercom Broker closed or reset the connection
+  smartIntercomClose();
+  return 0;
+}
+
+/*
+ * SmartIntercomMqttTransportPosix Write
+ */
+size_t SmartIntercomMqttTransportPosix::smartIntercomWrite(const uint8_t* data, size_t length) {
+  if (smartIntercomLink != SMARTINTERCOM_MQTT_LINK_UP) {
+    return 0;
+  }
+  ssize_t sent = send(smartIntercomFd, data, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+  if (sent >= 0) {
+    return (size_t)sent;
+  }
+  if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+    smartIntercomClose();
+  }
+  return 0;
+}
+
+void SmartIntercomMqttTransportPosix::smartIntercomClose() {
+  if (smartIntercomFd >= 0) {
+    close(smartIntercomFd);
+    smartIntercomFd = -1;
+  }
+  smartIntercomLink = SMARTINTERCOM_MQTT_LINK_DOWN;
+}
@@ -0,0 +1,40 @@
+/*
+ * SmartIntercomMqttPosix.h - Транспорт MQTT-клиента SmartIntercom на сокетах POSIX
+ *
+ * Хостовый транспорт для Linux: неблокирующий connect() и
+ * неблокирующие send()/recv(). Через него тот же SmartIntercomMqtt,
+ * что и в прошивке, работает с локальным брокером (mosquitto или
+ * tools/smartintercom_mqtt_broker.py).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_MQTT_POSIX_H
+#define SMARTINTERCOM_MQTT_POSIX_H
+
+#include <stdint.h>
+#include "SmartIntercomMqtt.h"
+
+/*
+ * SmartIntercomMqttTransportPosix - Транспорт SmartIntercom на сокете POSIX
+ */
+class SmartIntercomMqttTransportPosix : public SmartIntercomMqttTransport {
+private:
+  int smartIntercomFd;
+  SmartIntercomMqttLink smartIntercomLink;
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomMqttTransportPosix();
+  ~SmartIntercomMqttTransportPosix();
+
+  // SmartIntercom Transport Implementation
+  bool smartIntercomConnect(const char* host, uint16_t port) override;
+  SmartIntercomMqttLink smartIntercomGetLink() override;
+  size_t smartIntercomRead(uint8_t* buffer, size_t size) override;
+  size_t smartIntercomWrite(const uint8_t* data, size_t length) override;
+  void smartIntercomClose() override;
+};
+
+#endif // SMARTINTERCOM_MQTT_POSIX_H
@@ -0,0 +1,195 @@
+/*
+ * smartintercom_httpd.cpp - HTTP-сервер SmartIntercom на рабочей станции
+ *
+ * Запускает те же SmartIntercomHttpServer и SmartIntercomApi, что и
+ * прошивка, поверх epoll (SmartIntercomHttpTransportPosix) и
+ * симулированной платы, часы которой идут в реальном времени.
+ * Предназначен для нагрузочного тестирования обработчиков:
+ *
+ *   smartintercom_httpd --port 8080 &
+ *   wrk -c 6 -d 10 http://127.0.0.1:8080/api/status
+ *
+ * Использование:
+ *   smartintercom_httpd [--port P] [--duration-s D] [--ring-period-ms R]
+ *
+ * --ring-period-ms подает звонок каждые R мс (0 - без звонков),
+ * --duration-s останавливает сервер через D секунд (0 - до Ctrl+C).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <SmartIntercom.h>
+#include <SmartIntercomApi.h>
+#include "SmartIntercomHttpPosix.h"
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Host Server Pins
+#define SMARTINTERCOM_HTTPD_DOORBELL_PIN D1
+#define SMARTINTERCOM_HTTPD_DOOR_PIN D2
+#define SMARTINTERCOM_HTTPD_HANDSET_PIN D3
+#define SMARTINTERCOM_HTTPD_LED_PIN D4
+
+// SmartIntercom Host Server Ring Levels (0-1023)
+#define SMARTINTERCOM_HTTPD_RING_LEVEL 800
+#define SMARTINTERCOM_HTTPD_IDLE_LEVEL 100
+#define SMARTINTERCOM_HTTPD_RING_LENGTH_MS 2000
+
+/*
+ * SmartIntercomHttpdOptions - Параметры хостового сервера SmartIntercom
+ */
+struct SmartIntercomHttpdOptions {
+  unsigned long port;
+  unsigned long durationS;
+  unsigned long ringPeriodMs;
+};
+
+static volatile sig_atomic_t smartIntercomHttpdStop = 0;
+
+static void smartIntercomHttpdSignal(int signal) {
+  (void)signal;
+  smartIntercomHttpdStop = 1;
+}
+
+/*
+ * SmartIntercom Httpd Ring Source
+ * Звонок SmartIntercom: последние 2 с каждого периода
+ */
+static int smartIntercomHttpdRingSource(void* context, uint64_t timeUs) {
+  const SmartIntercomHttpdOptions* options = static_cast<const SmartIntercomHttpdOptions*>(context);
+  if (options->ringPeriodMs == 0) {
+    return SMARTINTERCOM_HTTPD_IDLE_LEVEL;
+  }
+  uint64_t phaseMs = (timeUs / 1000) % options->ringPeriodMs;
+  bool ringing = phaseMs + SMARTINTERCOM_HTTPD_RING_LENGTH_MS >= options->ringPeriodMs;
+  return ringing ? SMARTINTERCOM_HTTPD_RING_LEVEL : SMARTINTERCOM_HTTPD_IDLE_LEVEL;
+}
+
+static bool smartIntercomHttpdWifiProbe(void* context) {
+  (void)context;
+  return true;
+}
+
+/*
+ * SmartIntercom Httpd Parse Options
+ */
+static bool smartIntercomHttpdParseOptions(int argc, char** argv, SmartIntercomHttpdOptions* options) {
+  options->port = 8080;
+  options->durationS = 0;
+  options->ringPeriodMs = 60000;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--port") == 0 && hasValue) {
+      options->port = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--duration-s") == 0 && hasValue) {
+      options->durationS = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--ring-period-ms") == 0 && hasValue) {
+      options->ringPeriodMs = strtoul(argv[++i], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--port P] [--duration-s D] [--ring-period-ms R]\n", argv[0]);
+      return false;
+    }
+  }
+  if (options->ringPeriodMs != 0 && options->ringPeriodMs <= SMARTINTERCOM_HTTPD_RING_LENGTH_MS) {
+    options->ringPeriodMs = SMARTINTERCOM_HTTPD_RING_LENGTH_MS + 1;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  SmartIntercomHttpdOptions options;
+  if (!smartIntercomHttpdParseOptions(argc, argv, &options)) {
+    return 2;
+  }
+  signal(SIGINT, smartIntercomHttpdSignal);
+  signal(SIGTERM, smartIntercomHttpdSignal);
+
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(false);
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_HTTPD_DOORBELL_PIN, smartIntercomHttpdRingSource, &options);
+
+  SmartIntercom smartIntercom;
+  SmartIntercomConfig config;
+  config.doorbellPin = SMARTINTERCOM_HTTPD_DOORBELL_PIN;
+  config.doorOpenPin = SMARTINTERCOM_HTTPD_DOOR_PIN;
+  config.handsetPin = SMARTINTERCOM_HTTPD_HANDSET_PIN;
+  config.ledPin = SMARTINTERCOM_HTTPD_LED_PIN;
+  config.openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = SMARTINTERCOM_DEFAULT_RING_TIMEOUT;
+  config.autoOpenEnabled = false;
+  config.alwaysOpenEnabled = false;
+  config.openDelay = 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  smartIntercom.smartIntercomBegin(config);
+
+  // SmartIntercom Config journal on simulated flash, as in the firmware
+  SmartIntercomSimFlash flash;
+  SmartIntercomConfigStore store;
+  store.smartIntercomBegin(&flash);
+  smartIntercom.smartIntercomAttachConfigStore(&store);
+
+  // SmartIntercom Statistics for /api/stats
+  SmartIntercomSimFlash statsFlash(2);
+  SmartIntercomStats stats;
+  stats.smartIntercomBegin(&statsFlash);
+  smartIntercom.smartIntercomAttachStats(&stats);
+
+  // SmartIntercom Latency histograms for /api/metrics
+  SmartIntercomMetrics metrics;
+  smartIntercom.smartIntercomAttachMetrics(&metrics);
+
+  SmartIntercomHttpTransportPosix transport;
+  SmartIntercomHttpServer server;
+  SmartIntercomApi api;
+  if (!server.smartIntercomBegin(&transport, (uint16_t)options.port)) {
+    fprintf(stderr, "SmartIntercom: cannot listen on port %lu\n", options.port);
+    return 1;
+  }
+  server.smartIntercomSetServiceHistogram(&metrics.smartIntercomGetHistogram(SMARTINTERCOM_METRIC_REQUEST_TIME));
+  api.smartIntercomBegin(smartIntercom, server, "SmartIntercom Host", SMARTINTERCOM_LIB_VERSION);
+  api.smartIntercomSetWifiProbe(smartIntercomHttpdWifiProbe, nullptr);
+  printf("SmartIntercom: listening on http://127.0.0.1:%lu/\n", options.port);
+  fflush(stdout);
+
+  // SmartIntercom Board clock follows wall time so timeouts behave as on the device
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  uint64_t boardUs = 0;
+  while (!smartIntercomHttpdStop) {
+    // SmartIntercom Block in epoll until a socket is ready or the library's next deadline
+    server.smartIntercomRun(smartIntercom.smartIntercomGetIdleTime());
+    uint64_t elapsedUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - started).count();
+    if (elapsedUs > boardUs) {
+      board.smartIntercomAdvance(elapsedUs - boardUs);
+      boardUs = elapsedUs;
+    }
+    smartIntercom.smartIntercomUpdate();
+    api.smartIntercomUpdate();
+    if (options.durationS > 0 && boardUs >= options.durationS * 1000000ULL) {
+      break;
+    }
+  }
+  smartIntercomLogFlush();
+
+  printf("requests_served: %lu\n", (unsigned long)server.smartIntercomGetRequestsServed());
+  printf("connections_accepted: %lu\n", (unsigned long)server.smartIntercomGetConnectionsAccepted());
+  printf("connections_rejected: %lu\n", (unsigned long)server.smartIntercomGetConnectionsRejected());
+  printf("streams_dropped: %lu\n", (unsigned long)server.smartIntercomGetStreamsDropped());
+  printf("config_commits: %lu\n", (unsigned long)store.smartIntercomGetCommits());
+  printf("stats_rings: %lu\n", (unsigned long)stats.smartIntercomGetTotal(SMARTINTERCOM_STATS_RINGS));
+  SmartIntercomHistogram& requestTime = metrics.smartIntercomGetHistogram(SMARTINTERCOM_METRIC_REQUEST_TIME);
+  printf("request_time_p50_us: %lu\n", (unsigned long)requestTime.smartIntercomGetPercentile(500));
+  printf("request_time_p99_us: %lu\n", (unsigned long)requestTime.smartIntercomGetPercentile(990));
+  printf("status_rebuilds: %lu\n", (unsigned long)api.smartIntercomGetSnapshot().smartIntercomGetRebuilds());
+  return 0;
+}
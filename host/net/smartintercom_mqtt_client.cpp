@@ -0,0 +1,196 @@
+/*
+ * smartintercom_mqtt_client.cpp - MQTT-интеграция SmartIntercom на рабочей станции
+ *
+ * Запускает тот же SmartIntercomMqtt, что и прошивка, поверх сокетов
+ * POSIX (SmartIntercomMqttTransportPosix) и симулированной платы,
+ * часы которой идут в реальном времени. Брокер - локальный mosquitto
+ * или его заменитель из tools/:
+ *
+ *   python3 tools/smartintercom_mqtt_broker.py --port 1883 --drop-every 5 &
+ *   smartintercom_mqtt_client --port 1883 --ring-period-ms 5000 --duration-s 30
+ *
+ * Использование:
+ *   smartintercom_mqtt_client [--host H] [--port P] [--duration-s D] [--ring-period-ms R] [--auto-open]
+ *
+ * --ring-period-ms подает звонок каждые R мс (0 - без звонков),
+ * --duration-s останавливает клиент через D секунд (0 - до Ctrl+C).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <SmartIntercom.h>
+#include <SmartIntercomMqtt.h>
+#include "SmartIntercomMqttPosix.h"
+#include "SmartIntercomSimBoard.h"
+
+// SmartIntercom Host Client Pins
+#define SMARTINTERCOM_MQTT_CLIENT_DOORBELL_PIN D1
+#define SMARTINTERCOM_MQTT_CLIENT_DOOR_PIN D2
+#define SMARTINTERCOM_MQTT_CLIENT_HANDSET_PIN D3
+#define SMARTINTERCOM_MQTT_CLIENT_LED_PIN D4
+
+// SmartIntercom Host Client Ring Levels (0-1023)
+#define SMARTINTERCOM_MQTT_CLIENT_RING_LEVEL 800
+#define SMARTINTERCOM_MQTT_CLIENT_IDLE_LEVEL 100
+#define SMARTINTERCOM_MQTT_CLIENT_RING_LENGTH_MS 2000
+
+/*
+ * SmartIntercomMqttClientOptions - Параметры хостового MQTT-клиента SmartIntercom
+ */
+struct SmartIntercomMqttClientOptions {
+  const char* host;
+  unsigned long port;
+  unsigned long durationS;
+  unsigned long ringPeriodMs;
+  bool autoOpen;
+};
+
+static volatile sig_atomic_t smartIntercomMqttClientStop = 0;
+
+static void smartIntercomMqttClientSignal(int signal) {
+  (void)signal;
+  smartIntercomMqttClientStop = 1;
+}
+
+/*
+ * SmartIntercom Mqtt Client Ring Source
+ * Звонок SmartIntercom: последние 2 с каждого периода
+ */
+static int smartIntercomMqttClientRingSource(void* context, uint64_t timeUs) {
+  const SmartIntercomMqttClientOptions* options = static_cast<const SmartIntercomMqttClientOptions*>(context);
+  if (options->ringPeriodMs == 0) {
+    return SMARTINTERCOM_MQTT_CLIENT_IDLE_LEVEL;
+  }
+  uint64_t phaseMs = (timeUs / 1000) % options->ringPeriodMs;
+  bool ringing = phaseMs + SMARTINTERCOM_MQTT_CLIENT_RING_LENGTH_MS >= options->ringPeriodMs;
+  return ringing ? SMARTINTERCOM_MQTT_CLIENT_RING_LEVEL : SMARTINTERCOM_MQTT_CLIENT_IDLE_LEVEL;
+}
+
+/*
+ * SmartIntercom Mqtt Client Parse Options
+ */
+static bool smartIntercomMqttClientParseOptions(int argc, char** argv, SmartIntercomMqttClientOptions* options) {
+  options->host = "127.0.0.1";
+  options->port = 1883;
+  options->durationS = 0;
+  options->ringPeriodMs = 10000;
+  options->autoOpen = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--host") == 0 && hasValue) {
+      options->host = argv[++i];
+    } else if (strcmp(argv[i], "--port") == 0 && hasValue) {
+      options->port = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--duration-s") == 0 && hasValue) {
+      options->durationS = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--ring-period-ms") == 0 && hasValue) {
+      options->ringPeriodMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--auto-open") == 0) {
+      options->autoOpen = true;
+    } else {
+      fprintf(stderr,
+              "usage: %s [--host H] [--port P] [--duration-s D] [--ring-period-ms R] [--auto-open]\n", argv[0]);
+      return false;
+    }
+  }
+  if (options->ringPeriodMs != 0 && options->ringPeriodMs <= SMARTINTERCOM_MQTT_CLIENT_RING_LENGTH_MS) {
+    options->ringPeriodMs = SMARTINTERCOM_MQTT_CLIENT_RING_LENGTH_MS + 1;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  SmartIntercomMqttClientOptions options;
+  if (!smartIntercomMqttClientParseOptions(argc, argv, &options)) {
+    return 2;
+  }
+  signal(SIGINT, smartIntercomMqttClientSignal);
+  signal(SIGTERM, smartIntercomMqttClientSignal);
+
+  SmartIntercomSimBoard board;
+  board.smartIntercomSetRecording(false);
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(false);
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_MQTT_CLIENT_DOORBELL_PIN, smartIntercomMqttClientRingSource,
+                                     &options);
+
+  SmartIntercom smartIntercom;
+  SmartIntercomConfig config;
+  config.doorbellPin = SMARTINTERCOM_MQTT_CLIENT_DOORBELL_PIN;
+  config.doorOpenPin = SMARTINTERCOM_MQTT_CLIENT_DOOR_PIN;
+  config.handsetPin = SMARTINTERCOM_MQTT_CLIENT_HANDSET_PIN;
+  config.ledPin = SMARTINTERCOM_MQTT_CLIENT_LED_PIN;
+  config.openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = SMARTINTERCOM_DEFAULT_RING_TIMEOUT;
+  config.autoOpenEnabled = options.autoOpen;
+  config.alwaysOpenEnabled = false;
+  config.openDelay = 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  smartIntercom.smartIntercomBegin(config);
+
+  SmartIntercomMqttSettings settings;
+  settings.server = options.host;
+  settings.port = (uint16_t)options.port;
+  settings.user = "";
+  settings.password = "";
+  settings.clientId = "smartintercom-host";
+  settings.topicStatus = "smartintercom/status";
+  settings.topicEvents = "smartintercom/events";
+  settings.topicCommands = "smartintercom/commands";
+  settings.qos = 1;
+  settings.retain = true;
+  settings.keepAliveS = SMARTINTERCOM_MQTT_KEEPALIVE_S;
+
+  SmartIntercomMqttTransportPosix transport;
+  SmartIntercomMqtt mqtt;
+  mqtt.smartIntercomBegin(smartIntercom, &transport, settings);
+  printf("SmartIntercom: MQTT client for %s:%lu\n", options.host, options.port);
+  fflush(stdout);
+
+  // SmartIntercom Board clock follows wall time so keep-alive and reconnect pauses behave as on the device
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  uint64_t boardUs = 0;
+  while (!smartIntercomMqttClientStop) {
+    unsigned long idleMs = mqtt.smartIntercomGetIdleTime(smartIntercom.smartIntercomGetIdleTime());
+    if (idleMs > 0) {
+      usleep((useconds_t)(idleMs * 1000UL));
+    }
+    uint64_t elapsedUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - started).count();
+    if (elapsedUs > boardUs) {
+      board.smartIntercomAdvance(elapsedUs - boardUs);
+      boardUs = elapsedUs;
+    }
+    smartIntercom.smartIntercomUpdate();
+    mqtt.smartIntercomUpdate();
+    if (options.durationS > 0 && boardUs >= options.durationS * 1000000ULL) {
+      break;
+    }
+  }
+
+  SmartIntercomMqttClient& client = mqtt.smartIntercomGetClient();
+  SmartIntercomMqttOutbox& outbox = client.smartIntercomGetOutbox();
+  unsigned long pending = outbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_QUEUED) +
+                          outbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_INFLIGHT);
+  client.smartIntercomDisconnect();
+  smartIntercomLogFlush();
+
+  printf("mqtt_connects: %lu\n", (unsigned long)client.smartIntercomGetConnects());
+  printf("mqtt_published: %lu\n", (unsigned long)client.smartIntercomGetPublished());
+  printf("mqtt_acked: %lu\n", (unsigned long)client.smartIntercomGetAcked());
+  printf("mqtt_retransmitted: %lu\n", (unsigned long)client.smartIntercomGetRetransmitted());
+  printf("mqtt_coalesced: %lu\n", (unsigned long)outbox.smartIntercomGetCoalesced());
+  printf("mqtt_dropped: %lu\n", (unsigned long)outbox.smartIntercomGetDropped());
+  printf("mqtt_outbox_pending: %lu\n", pending);
+  printf("mqtt_commands: %lu\n", (unsigned long)mqtt.smartIntercomGetCommands());
+  return 0;
+}
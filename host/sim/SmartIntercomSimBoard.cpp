@@ -0,0 +1,321 @@
+/*
+ * SmartIntercomSimBoard.cpp - Реализация симулятора платы SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomSimBoard.h"
+
+/*
+ * SmartIntercomSimBoard Constructor
+ * Все пины SmartIntercom - входы с низким уровнем, время 0
+ */
+SmartIntercomSimBoard::SmartIntercomSimBoard() {
+  smartIntercomTimeUs = 0;
+  smartIntercomRecording = true;
+  smartIntercomAnalogReads = 0;
+  smartIntercomOutputCommits = 0;
+  smartIntercomSetHeap(0, 0);
+  smartIntercomCommit = 0;
+  smartIntercomTimerCallback = nullptr;
+  smartIntercomTimerContext = nullptr;
+  smartIntercomTimerPeriodUs = 0;
+  smartIntercomTimerNextUs = 0;
+  for (int i = 0; i < SMARTINTERCOM_SIM_PIN_COUNT; i++) {
+    smartIntercomPins[i].mode = INPUT;
+    smartIntercomPins[i].level = LOW;
+    smartIntercomPins[i].pwm = 0;
+    smartIntercomPins[i].scriptCursor = 0;
+    smartIntercomPins[i].analogValue = 0;
+    smartIntercomPins[i].source = nullptr;
+    smartIntercomPins[i].sourceContext = nullptr;
+  }
+}
+
+/*
+ * SmartIntercomSimBoard Get Pin
+ * Пины вне диапазона (например, -1 для отключенной трубки) игнорируются
+ */
+SmartIntercomSimBoard::SmartIntercomSimPin* SmartIntercomSimBoard::smartIntercomGetPin(int pin) {
+  if (pin < 0 || pin >= SMARTINTERCOM_SIM_PIN_COUNT) {
+    return nullptr;
+  }
+  return &smartIntercomPins[pin];
+}
+
+/*
+ * SmartIntercomSimBoard Record
+ * Запись изменения GPIO SmartIntercom с виртуальным временем
+ */
+void SmartIntercomSimBoard::smartIntercomRecord(int pin, int value, SmartIntercomSimEventKind kind) {
+  if (!smartIntercomRecording) {
+    return;
+  }
+  SmartIntercomSimEvent event;
+  event.timeUs = smartIntercomTimeUs;
+  event.pin = pin;
+  event.value = value;
+  event.kind = kind;
+  event.commit = smartIntercomCommit;
+  smartIntercomEvents.push_back(event);
+}
+
+// ============================================================================
+// SmartIntercom HAL Implementation
+// ============================================================================
+
+unsigned long SmartIntercomSimBoard::smartIntercomMillis() {
+  return (unsigned long)(smartIntercomTimeUs / 1000);
+}
+
+unsigned long SmartIntercomSimBoard::smartIntercomMicros() {
+  return (unsigned long)smartIntercomTimeUs;
+}
+
+void SmartIntercomSimBoard::smartIntercomDelay(unsigned long ms) {
+  smartIntercomAdvanceMillis(ms);
+}
+
+void SmartIntercomSimBoard::smartIntercomPinMode(int pin, int mode) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->mode = mode;
+  smartIntercomRecord(pin, mode, SMARTINTERCOM_SIM_PIN_MODE);
+}
+
+void SmartIntercomSimBoard::smartIntercomDigitalWrite(int pin, int value) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->level = value ? HIGH : LOW;
+  smartIntercomRecord(pin, simPin->level, SMARTINTERCOM_SIM_DIGITAL_WRITE);
+}
+
+/*
+ * SmartIntercomSimBoard Write Outputs
+ * Пакет выходов SmartIntercom: все пины меняются в один момент виртуального времени
+ */
+void SmartIntercomSimBoard::smartIntercomWriteOutputs(uint32_t setMask, uint32_t clearMask) {
+  smartIntercomOutputCommits++;
+  smartIntercomCommit = smartIntercomOutputCommits;
+  for (int pin = 0; pin < SMARTINTERCOM_SIM_PIN_COUNT; pin++) {
+    uint32_t bit = 1UL << pin;
+    if (((setMask | clearMask) & bit) == 0) {
+      continue;
+    }
+    smartIntercomPins[pin].level = (setMask & bit) ? HIGH : LOW;
+    smartIntercomRecord(pin, smartIntercomPins[pin].level, SMARTINTERCOM_SIM_DIGITAL_WRITE);
+  }
+  smartIntercomCommit = 0;
+}
+
+int SmartIntercomSimBoard::smartIntercomDigitalRead(int pin) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  return simPin ? simPin->level : LOW;
+}
+
+/*
+ * SmartIntercomSimBoard Analog Read
+ * Значение АЦП SmartIntercom из генератора или сценария на текущее время
+ */
+int SmartIntercomSimBoard::smartIntercomAnalogRead(int pin) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return 0;
+  }
+  smartIntercomAnalogReads++;
+
+  if (simPin->source) {
+    return simPin->source(simPin->sourceContext, smartIntercomTimeUs);
+  }
+
+  // SmartIntercom Scripts are sorted and time is monotonic, so the cursor only moves forward
+  while (simPin->scriptCursor < simPin->script.size() &&
+         simPin->script[simPin->scriptCursor].timeUs <= smartIntercomTimeUs) {
+    simPin->analogValue = simPin->script[simPin->scriptCursor].value;
+    simPin->scriptCursor++;
+  }
+  return simPin->analogValue;
+}
+
+void SmartIntercomSimBoard::smartIntercomAnalogWrite(int pin, int value) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->pwm = value;
+  smartIntercomRecord(pin, value, SMARTINTERCOM_SIM_ANALOG_WRITE);
+}
+
+/*
+ * SmartIntercomSimBoard Start Timer
+ * Виртуальный таймер SmartIntercom: первый тик через periodUs
+ */
+bool SmartIntercomSimBoard::smartIntercomStartTimer(unsigned long periodUs,
+                                                    SmartIntercomTimerCallback callback, void* context) {
+  if (periodUs == 0 || callback == nullptr) {
+    return false;
+  }
+  smartIntercomTimerCallback = callback;
+  smartIntercomTimerContext = context;
+  smartIntercomTimerPeriodUs = periodUs;
+  smartIntercomTimerNextUs = smartIntercomTimeUs + periodUs;
+  return true;
+}
+
+void SmartIntercomSimBoard::smartIntercomStopTimer() {
+  smartIntercomTimerCallback = nullptr;
+}
+
+// ============================================================================
+// SmartIntercom Virtual Clock
+// ============================================================================
+
+/*
+ * SmartIntercomSimBoard Advance
+ * Сдвиг виртуального времени SmartIntercom; тики таймера вызываются
+ * с часами, выставленными точно на момент тика
+ */
+void SmartIntercomSimBoard::smartIntercomAdvance(uint64_t us) {
+  uint64_t targetUs = smartIntercomTimeUs + us;
+  while (smartIntercomTimerCallback && smartIntercomTimerNextUs <= targetUs) {
+    smartIntercomTimeUs = smartIntercomTimerNextUs;
+    smartIntercomTimerNextUs += smartIntercomTimerPeriodUs;
+    smartIntercomTimerCallback(smartIntercomTimerContext);
+    smartIntercomRunTimerHook();
+  }
+  smartIntercomTimeUs = targetUs;
+}
+
+/*
+ * SmartIntercomSimBoard Idle Wait
+ * Сон SmartIntercom в виртуальном времени: до maxMs или до такта таймера,
+ * в котором прерывание вызвало smartIntercomWake()
+ */
+void SmartIntercomSimBoard::smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check, void* context) {
+  uint64_t targetUs = smartIntercomTimeUs + (uint64_t)maxMs * 1000;
+  bool woken = smartIntercomWakePending || (check != nullptr && check(context));
+  while (!woken && smartIntercomTimerCallback && smartIntercomTimerNextUs <= targetUs) {
+    smartIntercomTimeUs = smartIntercomTimerNextUs;
+    smartIntercomTimerNextUs += smartIntercomTimerPeriodUs;
+    smartIntercomTimerCallback(smartIntercomTimerContext);
+    smartIntercomRunTimerHook();
+    woken = smartIntercomWakePending || (check != nullptr && check(context));
+  }
+  if (!woken) {
+    smartIntercomTimeUs = targetUs;
+  }
+  smartIntercomWakePending = false;
+}
+
+void SmartIntercomSimBoard::smartIntercomAdvanceMillis(unsigned long ms) {
+  smartIntercomAdvance((uint64_t)ms * 1000);
+}
+
+uint64_t SmartIntercomSimBoard::smartIntercomGetTimeUs() {
+  return smartIntercomTimeUs;
+}
+
+// ============================================================================
+// SmartIntercom Scripted Inputs
+// ============================================================================
+
+/*
+ * SmartIntercomSimBoard Script Analog
+ * Значение АЦП SmartIntercom, начиная с момента atMs (шаги по возрастанию)
+ */
+void SmartIntercomSimBoard::smartIntercomScriptAnalog(int pin, unsigned long atMs, int value) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  SmartIntercomSimStep step;
+  step.timeUs = (uint64_t)atMs * 1000;
+  step.value = value;
+  simPin->script.push_back(step);
+}
+
+void SmartIntercomSimBoard::smartIntercomSetAnalog(int pin, int value) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->script.clear();
+  simPin->scriptCursor = 0;
+  simPin->analogValue = value;
+}
+
+void SmartIntercomSimBoard::smartIntercomSetAnalogSource(int pin, SmartIntercomSimAnalogSource source,
+                                                         void* context) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->source = source;
+  simPin->sourceContext = context;
+}
+
+void SmartIntercomSimBoard::smartIntercomSetDigitalInput(int pin, int level) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  if (simPin == nullptr) {
+    return;
+  }
+  simPin->level = level ? HIGH : LOW;
+}
+
+/*
+ * SmartIntercomSimBoard Set Heap
+ * Сценарная куча SmartIntercom; фрагментация - доля свободной памяти вне наибольшего блока
+ */
+void SmartIntercomSimBoard::smartIntercomSetHeap(uint32_t freeBytes, uint32_t largestBlock) {
+  smartIntercomHeap.freeBytes = freeBytes;
+  smartIntercomHeap.largestBlock = largestBlock < freeBytes ? largestBlock : freeBytes;
+  smartIntercomHeap.fragmentation =
+    freeBytes > 0 ? (uint8_t)(100 - (uint64_t)smartIntercomHeap.largestBlock * 100 / freeBytes) : 0;
+}
+
+uint32_t SmartIntercomSimBoard::smartIntercomGetFreeHeap() {
+  return smartIntercomHeap.freeBytes;
+}
+
+bool SmartIntercomSimBoard::smartIntercomGetHeap(SmartIntercomHeapInfo* info) {
+  if (smartIntercomHeap.freeBytes == 0) {
+    return false;
+  }
+  *info = smartIntercomHeap;
+  return true;
+}
+
+// ============================================================================
+// SmartIntercom Recorded Outputs
+// ============================================================================
+
+void SmartIntercomSimBoard::smartIntercomSetRecording(bool enabled) {
+  smartIntercomRecording = enabled;
+}
+
+const std::vector<SmartIntercomSimEvent>& SmartIntercomSimBoard::smartIntercomGetEvents() {
+  return smartIntercomEvents;
+}
+
+void SmartIntercomSimBoard::smartIntercomClearEvents() {
+  smartIntercomEvents.clear();
+}
+
+int SmartIntercomSimBoard::smartIntercomGetPinLevel(int pin) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  return simPin ? simPin->level : LOW;
+}
+
+int SmartIntercomSimBoard::smartIntercomGetPinPWM(int pin) {
+  SmartIntercomSimPin* simPin = smartIntercomGetPin(pin);
+  return simPin ? simPin->pwm : 0;
+}
+
+unsigned long SmartIntercomSimBoard::smartIntercomGetAnalogReads() {
+  return smartIntercomAnalogReads;
+}
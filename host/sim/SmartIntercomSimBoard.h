@@ -0,0 +1,137 @@
+/*
+ * SmartIntercomSimBoard.h - Симулятор платы SmartIntercom для хоста
+ *
+ * Реализация SmartIntercomHAL с детерминированными виртуальными
+ * часами, сценарными значениями АЦП и записью всех изменений GPIO.
+ * Позволяет прогонять настоящий SmartIntercom.cpp на x86 со скоростью
+ * в миллионы итераций цикла в секунду.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_SIM_BOARD_H
+#define SMARTINTERCOM_SIM_BOARD_H
+
+#include <stdint.h>
+#include <vector>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Simulator Configuration
+#define SMARTINTERCOM_SIM_PIN_COUNT 18
+
+// SmartIntercom Simulator Event Kinds
+enum SmartIntercomSimEventKind {
+  SMARTINTERCOM_SIM_PIN_MODE,
+  SMARTINTERCOM_SIM_DIGITAL_WRITE,
+  SMARTINTERCOM_SIM_ANALOG_WRITE
+};
+
+/*
+ * SmartIntercomSimEvent - Записанное изменение GPIO SmartIntercom
+ *
+ * commit - номер пакета smartIntercomWriteOutputs(), в котором пин
+ * изменился (0 - отдельный digitalWrite); изменения одного пакета
+ * произошли одновременно.
+ */
+struct SmartIntercomSimEvent {
+  uint64_t timeUs;
+  int pin;
+  int value;
+  SmartIntercomSimEventKind kind;
+  uint32_t commit;
+};
+
+/*
+ * SmartIntercomSimAnalogSource - Генератор значений АЦП SmartIntercom
+ *
+ * Вызывается при каждом analogRead() с текущим виртуальным временем.
+ */
+typedef int (*SmartIntercomSimAnalogSource)(void* context, uint64_t timeUs);
+
+/*
+ * SmartIntercomSimBoard - Симулированная плата SmartIntercom
+ */
+class SmartIntercomSimBoard : public SmartIntercomHAL {
+private:
+  struct SmartIntercomSimStep {
+    uint64_t timeUs;
+    int value;
+  };
+
+  struct SmartIntercomSimPin {
+    int mode;
+    int level;
+    int pwm;
+    std::vector<SmartIntercomSimStep> script;
+    size_t scriptCursor;
+    int analogValue;
+    SmartIntercomSimAnalogSource source;
+    void* sourceContext;
+  };
+
+  uint64_t smartIntercomTimeUs;
+  bool smartIntercomRecording;
+  SmartIntercomSimPin smartIntercomPins[SMARTINTERCOM_SIM_PIN_COUNT];
+  std::vector<SmartIntercomSimEvent> smartIntercomEvents;
+  unsigned long smartIntercomAnalogReads;
+  uint32_t smartIntercomOutputCommits;
+  uint32_t smartIntercomCommit;
+  SmartIntercomHeapInfo smartIntercomHeap;
+
+  // SmartIntercom Simulated Periodic Timer
+  SmartIntercomTimerCallback smartIntercomTimerCallback;
+  void* smartIntercomTimerContext;
+  uint64_t smartIntercomTimerPeriodUs;
+  uint64_t smartIntercomTimerNextUs;
+
+  // SmartIntercom Internal Methods
+  SmartIntercomSimPin* smartIntercomGetPin(int pin);
+  void smartIntercomRecord(int pin, int value, SmartIntercomSimEventKind kind);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomSimBoard();
+
+  // SmartIntercom HAL Implementation
+  unsigned long smartIntercomMillis() override;
+  unsigned long smartIntercomMicros() override;
+  void smartIntercomDelay(unsigned long ms) override;
+  void smartIntercomPinMode(int pin, int mode) override;
+  void smartIntercomDigitalWrite(int pin, int value) override;
+  int smartIntercomDigitalRead(int pin) override;
+  int smartIntercomAnalogRead(int pin) override;
+  void smartIntercomAnalogWrite(int pin, int value) override;
+  void smartIntercomWriteOutputs(uint32_t setMask, uint32_t clearMask) override;
+  bool smartIntercomStartTimer(unsigned long periodUs, SmartIntercomTimerCallback callback,
+                               void* context) override;
+  void smartIntercomStopTimer() override;
+  void smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check, void* context) override;
+  uint32_t smartIntercomGetFreeHeap() override;
+  bool smartIntercomGetHeap(SmartIntercomHeapInfo* info) override;
+
+  // SmartIntercom Virtual Clock (таймер срабатывает на каждой границе периода)
+  void smartIntercomAdvance(uint64_t us);
+  void smartIntercomAdvanceMillis(unsigned long ms);
+  uint64_t smartIntercomGetTimeUs();
+
+  // SmartIntercom Scripted Inputs
+  void smartIntercomScriptAnalog(int pin, unsigned long atMs, int value);
+  void smartIntercomSetAnalog(int pin, int value);
+  void smartIntercomSetAnalogSource(int pin, SmartIntercomSimAnalogSource source, void* context);
+  void smartIntercomSetDigitalInput(int pin, int level);
+
+  // SmartIntercom Scripted Heap (куча платы ESP8266; 0 свободных байт - куча не сообщается)
+  void smartIntercomSetHeap(uint32_t freeBytes, uint32_t largestBlock);
+
+  // SmartIntercom Recorded Outputs
+  void smartIntercomSetRecording(bool enabled);
+  const std::vector<SmartIntercomSimEvent>& smartIntercomGetEvents();
+  void smartIntercomClearEvents();
+  int smartIntercomGetPinLevel(int pin);
+  int smartIntercomGetPinPWM(int pin);
+  unsigned long smartIntercomGetAnalogReads();
+  uint32_t smartIntercomGetOutputCommits() { return smartIntercomOutputCommits; }
+};
+
+#endif // SMARTINTERCOM_SIM_BOARD_H
@@ -0,0 +1,75 @@
+/*
+ * SmartIntercomSimFlash.cpp - Реализация симулятора флеш-памяти SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomSimFlash.h"
+#include <string.h>
+
+/*
+ * SmartIntercomSimFlash Constructor
+ */
+SmartIntercomSimFlash::SmartIntercomSimFlash(uint16_t sectorCount, uint32_t sectorSize)
+  : smartIntercomSectorCount(sectorCount),
+    smartIntercomSectorSize(sectorSize),
+    smartIntercomData((size_t)sectorCount * sectorSize, 0xFF),
+    smartIntercomEraseCounts(sectorCount, 0),
+    smartIntercomBytesWritten(0),
+    smartIntercomTearAfter(-1) {
+}
+
+bool SmartIntercomSimFlash::smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) {
+  if (sector >= smartIntercomSectorCount || offset + length > smartIntercomSectorSize) {
+    return false;
+  }
+  memcpy(data, &smartIntercomData[(size_t)sector * smartIntercomSectorSize + offset], length);
+  return true;
+}
+
+/*
+ * SmartIntercomSimFlash Write
+ * Запись SmartIntercom как в NOR: биты только сбрасываются
+ */
+bool SmartIntercomSimFlash::smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data,
+                                               size_t length) {
+  if (sector >= smartIntercomSectorCount || offset + length > smartIntercomSectorSize ||
+      (offset & 3) != 0 || (length & 3) != 0) {
+    return false;
+  }
+  size_t count = length;
+  if (smartIntercomTearAfter >= 0 && (size_t)smartIntercomTearAfter < count) {
+    count = (size_t)smartIntercomTearAfter;
+  }
+  smartIntercomTearAfter = -1;
+
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint8_t* target = &smartIntercomData[(size_t)sector * smartIntercomSectorSize + offset];
+  for (size_t i = 0; i < count; i++) {
+    target[i] &= bytes[i];
+  }
+  smartIntercomBytesWritten += count;
+  return count == length;
+}
+
+bool SmartIntercomSimFlash::smartIntercomErase(uint16_t sector) {
+  if (sector >= smartIntercomSectorCount) {
+    return false;
+  }
+  memset(&smartIntercomData[(size_t)sector * smartIntercomSectorSize], 0xFF, smartIntercomSectorSize);
+  smartIntercomEraseCounts[sector]++;
+  return true;
+}
+
+uint32_t SmartIntercomSimFlash::smartIntercomGetEraseCount(uint16_t sector) {
+  return sector < smartIntercomSectorCount ? smartIntercomEraseCounts[sector] : 0;
+}
+
+uint32_t SmartIntercomSimFlash::smartIntercomGetTotalErases() {
+  uint32_t total = 0;
+  for (uint16_t i = 0; i < smartIntercomSectorCount; i++) {
+    total += smartIntercomEraseCounts[i];
+  }
+  return total;
+}
@@ -0,0 +1,51 @@
+/*
+ * SmartIntercomSimFlash.h - Симулятор флеш-памяти SmartIntercom для хоста
+ *
+ * Сектора в RAM с семантикой NOR: стирание в 0xFF, запись только
+ * сбрасывает биты. Считает стирания по секторам и умеет оборвать
+ * запись на заданном байте, как при пропадании питания.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_SIM_FLASH_H
+#define SMARTINTERCOM_SIM_FLASH_H
+
+#include <stdint.h>
+#include <vector>
+#include "SmartIntercomConfigStore.h"
+
+/*
+ * SmartIntercomSimFlash - Симулированная флеш-память SmartIntercom
+ */
+class SmartIntercomSimFlash : public SmartIntercomFlash {
+private:
+  uint16_t smartIntercomSectorCount;
+  uint32_t smartIntercomSectorSize;
+  std::vector<uint8_t> smartIntercomData;
+  std::vector<uint32_t> smartIntercomEraseCounts;
+  uint32_t smartIntercomBytesWritten;
+  long smartIntercomTearAfter;
+
+public:
+  // SmartIntercom Constructor (по умолчанию - один сектор EEPROM ESP8266)
+  SmartIntercomSimFlash(uint16_t sectorCount = 1, uint32_t sectorSize = 4096);
+
+  // SmartIntercom Flash Implementation
+  uint16_t smartIntercomGetSectorCount() override { return smartIntercomSectorCount; }
+  uint32_t smartIntercomGetSectorSize() override { return smartIntercomSectorSize; }
+  bool smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) override;
+  bool smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data, size_t length) override;
+  bool smartIntercomErase(uint16_t sector) override;
+
+  // SmartIntercom Fault Injection (следующая запись оборвется после bytes байт)
+  void smartIntercomTearNextWrite(long bytes) { smartIntercomTearAfter = bytes; }
+
+  // SmartIntercom Wear Statistics
+  uint32_t smartIntercomGetEraseCount(uint16_t sector);
+  uint32_t smartIntercomGetTotalErases();
+  uint32_t smartIntercomGetBytesWritten() { return smartIntercomBytesWritten; }
+};
+
+#endif // SMARTINTERCOM_SIM_FLASH_H
@@ -0,0 +1,408 @@
+/*
+ * smartintercom_replay.cpp - Воспроизведение трасс АЦП SmartIntercom
+ *
+ * Прогоняет записанную трассу .sitr (GET /api/trace или
+ * smartintercom_sim --capture) через настоящий SmartIntercomRing на
+ * симулированной плате и считает звонки. Трасса с выборкой по таймеру
+ * подается тактами таймера с ее периодом, трасса опроса - вызовами
+ * smartIntercomCheck() в записанные моменты времени. Печатается
+ * пропускная способность: отсчетов в секунду и во сколько раз
+ * воспроизведение быстрее реального времени.
+ *
+ * Использование:
+ *   smartintercom_replay [--tone-hz F] [--expect-rings N] [--repeat R] FILE.sitr
+ *   smartintercom_replay --manifest FILE [--repeat R]
+ *   smartintercom_replay --encode IN.txt OUT.sitr [--period-us U]
+ *   smartintercom_replay --decode FILE.sitr
+ *
+ * Манифест - строки "файл ожидаемых_звонков [тон_Гц]" (пути от каталога
+ * манифеста, # - комментарий). Код выхода 1, если число звонков
+ * хотя бы одной трассы не совпало с ожидаемым: так корпус трасс
+ * проверяет изменения детектора звонка.
+ *
+ * --encode переводит текстовую трассу (одно значение АЦП на строку,
+ * шаг U мкс) в .sitr, --decode печатает отсчеты .sitr строками
+ * "время_мкс значение".
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <SmartIntercom.h>
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Replay Pin
+#define SMARTINTERCOM_REPLAY_PIN D1
+
+// SmartIntercom Replay Loop Step (тактов таймера между вызовами smartIntercomCheck)
+#define SMARTINTERCOM_REPLAY_BATCH_TICKS 64
+
+/*
+ * SmartIntercomReplayTrace - Декодированная трасса SmartIntercom
+ */
+struct SmartIntercomReplayTrace {
+  std::vector<uint16_t> values;
+  std::vector<uint32_t> timesUs;
+  uint32_t periodUs;
+  bool sampled;
+};
+
+/*
+ * SmartIntercomReplaySource - Позиция воспроизведения SmartIntercom для источника АЦП
+ */
+struct SmartIntercomReplaySource {
+  const SmartIntercomReplayTrace* trace;
+  size_t position;
+  bool advance;
+};
+
+/*
+ * SmartIntercomReplayResult - Итог прогона одной трассы SmartIntercom
+ */
+struct SmartIntercomReplayResult {
+  int rings;
+  double wallSeconds;
+  double traceSeconds;
+};
+
+/*
+ * SmartIntercom Replay Read File
+ */
+static bool smartIntercomReplayReadFile(const char* path, std::vector<uint8_t>* bytes) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  uint8_t chunk[4096];
+  size_t length = 0;
+  bytes->clear();
+  while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    bytes->insert(bytes->end(), chunk, chunk + length);
+  }
+  fclose(file);
+  return true;
+}
+
+/*
+ * SmartIntercom Replay Load
+ * Все отсчеты трассы SmartIntercom в память (время от первого отсчета)
+ */
+static bool smartIntercomReplayLoad(const char* path, SmartIntercomReplayTrace* trace) {
+  std::vector<uint8_t> bytes;
+  if (!smartIntercomReplayReadFile(path, &bytes)) {
+    fprintf(stderr, "smartintercom_replay: cannot read %s\n", path);
+    return false;
+  }
+  SmartIntercomTraceReader reader(bytes.data(), bytes.size());
+  if (!reader.smartIntercomBegin()) {
+    fprintf(stderr, "smartintercom_replay: %s is not a SmartIntercom trace\n", path);
+    return false;
+  }
+
+  uint16_t value = 0;
+  uint32_t timeUs = 0;
+  uint32_t startUs = 0;
+  trace->values.clear();
+  trace->timesUs.clear();
+  while (reader.smartIntercomNext(&value, &timeUs)) {
+    if (trace->values.empty()) {
+      startUs = timeUs;
+      trace->periodUs = reader.smartIntercomGetPeriodUs();
+      trace->sampled = reader.smartIntercomIsSampled();
+    }
+    trace->values.push_back(value);
+    trace->timesUs.push_back(timeUs - startUs);
+  }
+  if (trace->values.size() != reader.smartIntercomGetDeclaredSamples()) {
+    fprintf(stderr, "smartintercom_replay: %s: %lu of %lu samples decoded\n", path,
+            (unsigned long)trace->values.size(), (unsigned long)reader.smartIntercomGetDeclaredSamples());
+  }
+  return !trace->values.empty();
+}
+
+/*
+ * SmartIntercom Replay Analog Source
+ * Отсчет трассы SmartIntercom: по такту таймера - следующий, при опросе - текущий
+ */
+static int smartIntercomReplayAnalogSource(void* context, uint64_t timeUs) {
+  (void)timeUs;
+  SmartIntercomReplaySource* source = static_cast<SmartIntercomReplaySource*>(context);
+  const std::vector<uint16_t>& values = source->trace->values;
+  size_t position = source->position < values.size() ? source->position : values.size() - 1;
+  if (source->advance) {
+    source->position++;
+  }
+  return values[position];
+}
+
+/*
+ * SmartIntercom Replay Run
+ * Один прогон трассы SmartIntercom через свежий детектор звонка
+ *
+ * Плата общая для всех прогонов, поэтому время трассы отсчитывается
+ * от текущего времени платы.
+ */
+static SmartIntercomReplayResult smartIntercomReplayRun(SmartIntercomSimBoard& board,
+                                                        const SmartIntercomReplayTrace& trace, unsigned int toneHz) {
+  SmartIntercomReplaySource source = { &trace, 0, trace.sampled };
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_REPLAY_PIN, smartIntercomReplayAnalogSource, &source);
+
+  SmartIntercomRing ring(SMARTINTERCOM_REPLAY_PIN);
+  size_t count = trace.values.size();
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  if (trace.sampled) {
+    ring.smartIntercomBeginSampling(trace.periodUs);
+    ring.smartIntercomSetToneFrequency(toneHz);
+    while (source.position < count) {
+      size_t ticks = count - source.position;
+      ticks = ticks < SMARTINTERCOM_REPLAY_BATCH_TICKS ? ticks : SMARTINTERCOM_REPLAY_BATCH_TICKS;
+      board.smartIntercomAdvance((uint64_t)ticks * trace.periodUs);
+      ring.smartIntercomCheck();
+    }
+    ring.smartIntercomCheck();
+    ring.smartIntercomEndSampling();
+  } else {
+    ring.smartIntercomSetToneFrequency(toneHz);
+    uint64_t traceUs = 0;
+    for (size_t i = 0; i < count; i++) {
+      board.smartIntercomAdvance(trace.timesUs[i] - traceUs);
+      traceUs = trace.timesUs[i];
+      source.position = i;
+      ring.smartIntercomCheck();
+    }
+  }
+
+  SmartIntercomReplayResult result;
+  result.rings = ring.smartIntercomGetCount();
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  result.traceSeconds = trace.timesUs.back() / 1e6;
+  return result;
+}
+
+/*
+ * SmartIntercom Replay File
+ * Прогоны трассы SmartIntercom; лучшее время из repeat
+ */
+static bool smartIntercomReplayFile(SmartIntercomSimBoard& board, const char* path, unsigned int toneHz,
+                                    long expectRings, unsigned long repeat) {
+  SmartIntercomReplayTrace trace;
+  if (!smartIntercomReplayLoad(path, &trace)) {
+    return false;
+  }
+  SmartIntercomReplayResult best = smartIntercomReplayRun(board, trace, toneHz);
+  for (unsigned long i = 1; i < repeat; i++) {
+    SmartIntercomReplayResult result = smartIntercomReplayRun(board, trace, toneHz);
+    if (result.wallSeconds < best.wallSeconds) {
+      best = result;
+    }
+  }
+  smartIntercomLogFlush();
+
+  bool passed = expectRings < 0 || best.rings == expectRings;
+  printf("%-32s %-7s %9lu %7.1fs %5d", path, trace.sampled ? "sampled" : "polled", (unsigned long)trace.values.size(),
+         best.traceSeconds, best.rings);
+  if (expectRings >= 0) {
+    printf(" / %-5ld", expectRings);
+  } else {
+    printf("         ");
+  }
+  printf(" %12.0f %9.0fx %s\n", best.wallSeconds > 0 ? trace.values.size() / best.wallSeconds : 0.0,
+         best.wallSeconds > 0 ? best.traceSeconds / best.wallSeconds : 0.0, passed ? "ok" : "MISMATCH");
+  return passed;
+}
+
+static void smartIntercomReplayPrintHeader() {
+  printf("%-32s %-7s %9s %8s %13s %12s %10s\n", "Trace", "Input", "Samples", "Length", "Rings/expect", "Samples/s",
+         "Speedup");
+}
+
+/*
+ * SmartIntercom Replay Manifest
+ * Все трассы корпуса SmartIntercom; false - хотя бы одна не совпала
+ */
+static bool smartIntercomReplayManifest(SmartIntercomSimBoard& board, const char* path, unsigned long repeat) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    fprintf(stderr, "smartintercom_replay: cannot read %s\n", path);
+    return false;
+  }
+  std::string directory(path);
+  size_t slash = directory.rfind('/');
+  directory = slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+
+  char line[256];
+  unsigned long traces = 0;
+  unsigned long failed = 0;
+  smartIntercomReplayPrintHeader();
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    char name[192];
+    long expectRings = 0;
+    unsigned int toneHz = 0;
+    char* hash = strchr(line, '#');
+    if (hash != nullptr) {
+      *hash = '\0';
+    }
+    int fields = sscanf(line, "%191s %ld %u", name, &expectRings, &toneHz);
+    if (fields <= 0) {
+      continue;
+    }
+    if (fields < 2) {
+      fprintf(stderr, "smartintercom_replay: %s: missing expected rings for %s\n", path, name);
+      failed++;
+      continue;
+    }
+    std::string tracePath = name[0] == '/' ? std::string(name) : directory + name;
+    traces++;
+    if (!smartIntercomReplayFile(board, tracePath.c_str(), toneHz, expectRings, repeat)) {
+      failed++;
+    }
+  }
+  fclose(file);
+  printf("traces: %lu, mismatches: %lu\n", traces, failed);
+  return failed == 0 && traces > 0;
+}
+
+/*
+ * SmartIntercom Replay Encode
+ * Текстовая трасса SmartIntercom в .sitr тем же кодировщиком, что в прошивке
+ */
+static bool smartIntercomReplayEncode(const char* input, const char* output, unsigned long periodUs) {
+  FILE* file = fopen(input, "r");
+  if (file == nullptr) {
+    fprintf(stderr, "smartintercom_replay: cannot read %s\n", input);
+    return false;
+  }
+  std::vector<uint16_t> values;
+  long value = 0;
+  while (fscanf(file, "%ld", &value) == 1) {
+    values.push_back((uint16_t)(value < 0 ? 0 : (value > 1023 ? 1023 : value)));
+  }
+  fclose(file);
+
+  // SmartIntercom At least ~19 samples fit a block even at worst-case encoding
+  uint64_t sectors = values.size() / 300 + 2;
+  SmartIntercomSimFlash flash((uint16_t)(sectors > UINT16_MAX ? UINT16_MAX : sectors));
+  SmartIntercomTrace trace;
+  trace.smartIntercomBegin(&flash);
+  trace.smartIntercomStart(SMARTINTERCOM_TRACE_ONESHOT);
+  for (size_t i = 0; i < values.size(); i++) {
+    trace.smartIntercomRecord(values[i], (uint32_t)(i * periodUs), periodUs);
+  }
+  trace.smartIntercomStop();
+
+  file = fopen(output, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "smartintercom_replay: cannot write %s\n", output);
+    return false;
+  }
+  char chunk[1024];
+  uint32_t cursor = 0;
+  size_t length = 0;
+  unsigned long bytes = 0;
+  while ((length = SmartIntercomTrace::smartIntercomWriteFile(chunk, sizeof(chunk), &cursor, &trace)) > 0) {
+    fwrite(chunk, 1, length, file);
+    bytes += length;
+  }
+  fclose(file);
+  smartIntercomLogFlush();
+  printf("%s: %lu samples, %lu bytes (%.3f bytes/sample)\n", output, (unsigned long)trace.smartIntercomGetSamples(),
+         bytes, values.empty() ? 0.0 : (double)bytes / values.size());
+  return trace.smartIntercomGetSamples() == values.size();
+}
+
+/*
+ * SmartIntercom Replay Decode
+ */
+static bool smartIntercomReplayDecode(const char* path) {
+  std::vector<uint8_t> bytes;
+  if (!smartIntercomReplayReadFile(path, &bytes)) {
+    fprintf(stderr, "smartintercom_replay: cannot read %s\n", path);
+    return false;
+  }
+  SmartIntercomTraceReader reader(bytes.data(), bytes.size());
+  if (!reader.smartIntercomBegin()) {
+    fprintf(stderr, "smartintercom_replay: %s is not a SmartIntercom trace\n", path);
+    return false;
+  }
+  uint16_t value = 0;
+  uint32_t timeUs = 0;
+  while (reader.smartIntercomNext(&value, &timeUs)) {
+    printf("%lu %u\n", (unsigned long)timeUs, value);
+  }
+  return true;
+}
+
+static void smartIntercomReplayUsage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [--tone-hz F] [--expect-rings N] [--repeat R] FILE.sitr\n"
+          "       %s --manifest FILE [--repeat R]\n"
+          "       %s --encode IN.txt OUT.sitr [--period-us U]\n"
+          "       %s --decode FILE.sitr\n", name, name, name, name);
+}
+
+int main(int argc, char** argv) {
+  const char* manifest = nullptr;
+  const char* encodeInput = nullptr;
+  const char* encodeOutput = nullptr;
+  const char* decode = nullptr;
+  const char* path = nullptr;
+  unsigned int toneHz = 0;
+  long expectRings = -1;
+  unsigned long repeat = 1;
+  unsigned long periodUs = 1000;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--manifest") == 0 && hasValue) {
+      manifest = argv[++i];
+    } else if (strcmp(argv[i], "--encode") == 0 && i + 2 < argc) {
+      encodeInput = argv[++i];
+      encodeOutput = argv[++i];
+    } else if (strcmp(argv[i], "--decode") == 0 && hasValue) {
+      decode = argv[++i];
+    } else if (strcmp(argv[i], "--tone-hz") == 0 && hasValue) {
+      toneHz = (unsigned int)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--expect-rings") == 0 && hasValue) {
+      expectRings = strtol(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--repeat") == 0 && hasValue) {
+      repeat = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--period-us") == 0 && hasValue) {
+      periodUs = strtoul(argv[++i], nullptr, 10);
+    } else if (argv[i][0] != '-' && path == nullptr) {
+      path = argv[i];
+    } else {
+      smartIntercomReplayUsage(argv[0]);
+      return 2;
+    }
+  }
+  if (repeat == 0) {
+    repeat = 1;
+  }
+
+  SmartIntercomSimBoard board;
+  smartIntercomSetHAL(&board);
+  board.smartIntercomSetRecording(false);
+  Serial.smartIntercomSetEnabled(false);
+  if (encodeInput != nullptr) {
+    return smartIntercomReplayEncode(encodeInput, encodeOutput, periodUs > 0 ? periodUs : 1000) ? 0 : 1;
+  }
+  if (decode != nullptr) {
+    return smartIntercomReplayDecode(decode) ? 0 : 1;
+  }
+  if (manifest != nullptr) {
+    return smartIntercomReplayManifest(board, manifest, repeat) ? 0 : 1;
+  }
+  if (path == nullptr) {
+    smartIntercomReplayUsage(argv[0]);
+    return 2;
+  }
+  smartIntercomReplayPrintHeader();
+  return smartIntercomReplayFile(board, path, toneHz, expectRings, repeat) ? 0 : 1;
+}
@@ -0,0 +1,552 @@
+/*
+ * smartintercom_sim.cpp - Хостовый симулятор SmartIntercom
+ *
+ * Прогоняет настоящий цикл smartIntercomUpdate() на симулированной
+ * плате: звонки подаются сценарием АЦП, открытия двери считаются
+ * по записанным фронтам реле. В конце печатается производительность
+ * в итерациях цикла в секунду.
+ *
+ * Использование:
+ *   smartintercom_sim [--iterations N] [--step-us U] [--ring-period-ms P]
+ *                     [--ring-length-ms L] [--sample-us S] [--ring-tone-hz F]
+ *                     [--noise A] [--tone-check] [--auto-open] [--verbose]
+ *                     [--config-toggle-ms T] [--flash-sectors N] [--tickless]
+ *                     [--lines N] [--capture FILE]
+ *
+ * --sample-us включает выборку АЦП звонка по таймеру с периодом S мкс.
+ * --ring-tone-hz подает звонок синусом F Гц вместо ступеньки уровня,
+ * --noise добавляет к линии равномерный шум +-A отсчетов, --tone-check
+ * включает в классификаторе проверку тона на частоте F.
+ *
+ * --tickless вместо шага U мкс на каждый проход спит через
+ * smartIntercomIdle() до следующего срока или пробуждения от прерывания
+ * выборки (то же виртуальное время N * U); loop_passes показывает,
+ * сколько раз цикл действительно просыпался.
+ *
+ * --config-toggle-ms переключает авто-открытие каждые T мс виртуального
+ * времени с журналом конфигурации на симулированной флеш-памяти из N
+ * секторов; в конце журнал читается заново, как после перезагрузки.
+ *
+ * --lines N прогоняет вместо одноканального устройства многоканальный
+ * SmartIntercomLines с N линиями (не больше SMARTINTERCOM_LINES):
+ * звонки линий сдвинуты по фазе на P / N, печатаются звонки и
+ * открытия каждой линии и стоимость опроса одной линии.
+ *
+ * --capture записывает все отсчеты входа звонка в трассу .sitr
+ * (SmartIntercomTrace на симулированной флеш-памяти, однократная
+ * запись) - так собирается корпус для smartintercom_replay.
+ *
+ * Статистика SmartIntercom ведется всегда (снимки на отдельной
+ * симулированной флеш-памяти); в конце снимок записывается и
+ * восстанавливается заново, печатаются итоги за час и за сутки.
+ * Гистограммы задержек тоже ведутся всегда; печатаются квантили
+ * задержки звонок -> реле и периода цикла в виртуальном времени.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <SmartIntercom.h>
+#include <SmartIntercomLines.h>
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Simulator Pins
+#define SMARTINTERCOM_SIM_DOORBELL_PIN D1
+#define SMARTINTERCOM_SIM_DOOR_PIN D2
+#define SMARTINTERCOM_SIM_HANDSET_PIN D3
+#define SMARTINTERCOM_SIM_LED_PIN D4
+
+// SmartIntercom Simulator Ring Levels (0-1023)
+#define SMARTINTERCOM_SIM_RING_LEVEL 800
+#define SMARTINTERCOM_SIM_IDLE_LEVEL 100
+#define SMARTINTERCOM_SIM_TONE_BIAS 512
+#define SMARTINTERCOM_SIM_TONE_AMPLITUDE 300
+
+// SmartIntercom Simulator Line Pins (--lines: ring pins 0..N-1, door pins after them)
+#define SMARTINTERCOM_SIM_LINE_RING_PIN(line) (line)
+#define SMARTINTERCOM_SIM_LINE_DOOR_PIN(line) (SMARTINTERCOM_LINES + (line))
+
+/*
+ * SmartIntercomSimOptions - Параметры прогона симулятора SmartIntercom
+ */
+struct SmartIntercomSimOptions {
+  unsigned long iterations;
+  unsigned long stepUs;
+  unsigned long ringPeriodMs;
+  unsigned long ringLengthMs;
+  unsigned long sampleUs;
+  unsigned long ringToneHz;
+  unsigned long noise;
+  unsigned long configToggleMs;
+  unsigned long flashSectors;
+  unsigned long lines;
+  const char* captureFile;
+  bool toneCheck;
+  bool autoOpen;
+  bool verbose;
+  bool tickless;
+};
+
+/*
+ * SmartIntercomSimLine - Источник звонка одной линии SmartIntercom (--lines)
+ */
+struct SmartIntercomSimLine {
+  const SmartIntercomSimOptions* options;
+  uint64_t offsetUs;
+  unsigned long rings;
+  unsigned long opens;
+};
+
+// SmartIntercom Simulator Counters
+static unsigned long smartIntercomSimRings = 0;
+static unsigned long smartIntercomSimOpens = 0;
+
+/*
+ * SmartIntercom Sim Ring Source
+ * Периодический звонок SmartIntercom: последние ringLengthMs каждого периода
+ */
+static int smartIntercomSimRingSource(void* context, uint64_t timeUs) {
+  const SmartIntercomSimOptions* options = static_cast<const SmartIntercomSimOptions*>(context);
+  uint64_t phaseMs = (timeUs / 1000) % options->ringPeriodMs;
+  bool ringing = phaseMs + options->ringLengthMs >= options->ringPeriodMs;
+  int value;
+
+  if (options->ringToneHz == 0) {
+    value = ringing ? SMARTINTERCOM_SIM_RING_LEVEL : SMARTINTERCOM_SIM_IDLE_LEVEL;
+  } else {
+    value = SMARTINTERCOM_SIM_TONE_BIAS;
+    if (ringing) {
+      value += (int)lround(SMARTINTERCOM_SIM_TONE_AMPLITUDE * sin(2.0 * M_PI * options->ringToneHz * timeUs / 1e6));
+    }
+  }
+
+  if (options->noise > 0) {
+    // SmartIntercom Deterministic noise: hash of the sample time
+    uint32_t hash = (uint32_t)(timeUs * 2654435761ULL >> 16);
+    value += (int)(hash % (2 * options->noise + 1)) - (int)options->noise;
+  }
+  return value < 0 ? 0 : (value > 1023 ? 1023 : value);
+}
+
+/*
+ * SmartIntercom Sim Line Source
+ * Звонок линии SmartIntercom: тот же сценарий со сдвигом фазы
+ */
+static int smartIntercomSimLineSource(void* context, uint64_t timeUs) {
+  const SmartIntercomSimLine* line = static_cast<const SmartIntercomSimLine*>(context);
+  return smartIntercomSimRingSource((void*)line->options, timeUs + line->offsetUs);
+}
+
+/*
+ * SmartIntercom Sim Event Handler
+ */
+static void smartIntercomSimEventHandler(const SmartIntercomEvent& event, void* context) {
+  (void)context;
+  if (event.type == SMARTINTERCOM_EVENT_RING) {
+    smartIntercomSimRings++;
+  } else if (event.type == SMARTINTERCOM_EVENT_OPEN) {
+    smartIntercomSimOpens++;
+  }
+}
+
+/*
+ * SmartIntercom Sim Line Event Handler
+ * Счетчики по линиям SmartIntercom из SmartIntercomEvent::channel
+ */
+static void smartIntercomSimLineEventHandler(const SmartIntercomEvent& event, void* context) {
+  SmartIntercomSimLine* lines = static_cast<SmartIntercomSimLine*>(context);
+  if (event.type == SMARTINTERCOM_EVENT_RING) {
+    lines[event.channel].rings++;
+  } else if (event.type == SMARTINTERCOM_EVENT_OPEN) {
+    lines[event.channel].opens++;
+  }
+}
+
+/*
+ * SmartIntercom Sim Parse Options
+ */
+static bool smartIntercomSimParseOptions(int argc, char** argv, SmartIntercomSimOptions* options) {
+  options->iterations = 10000000UL;
+  options->stepUs = 1000;
+  options->ringPeriodMs = 20000;
+  options->ringLengthMs = 2000;
+  options->sampleUs = 0;
+  options->ringToneHz = 0;
+  options->noise = 0;
+  options->configToggleMs = 0;
+  options->flashSectors = 1;
+  options->lines = 0;
+  options->captureFile = nullptr;
+  options->toneCheck = false;
+  options->autoOpen = false;
+  options->verbose = false;
+  options->tickless = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--iterations") == 0 && hasValue) {
+      options->iterations = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--step-us") == 0 && hasValue) {
+      options->stepUs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--ring-period-ms") == 0 && hasValue) {
+      options->ringPeriodMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--ring-length-ms") == 0 && hasValue) {
+      options->ringLengthMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--sample-us") == 0 && hasValue) {
+      options->sampleUs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--ring-tone-hz") == 0 && hasValue) {
+      options->ringToneHz = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--noise") == 0 && hasValue) {
+      options->noise = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--config-toggle-ms") == 0 && hasValue) {
+      options->configToggleMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--flash-sectors") == 0 && hasValue) {
+      options->flashSectors = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--lines") == 0 && hasValue) {
+      options->lines = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--capture") == 0 && hasValue) {
+      options->captureFile = argv[++i];
+    } else if (strcmp(argv[i], "--tone-check") == 0) {
+      options->toneCheck = true;
+    } else if (strcmp(argv[i], "--auto-open") == 0) {
+      options->autoOpen = true;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      options->verbose = true;
+    } else if (strcmp(argv[i], "--tickless") == 0) {
+      options->tickless = true;
+    } else {
+      fprintf(stderr,
+              "usage: %s [--iterations N] [--step-us U] [--ring-period-ms P]\n"
+              "          [--ring-length-ms L] [--sample-us S] [--ring-tone-hz F]\n"
+              "          [--noise A] [--tone-check] [--auto-open] [--verbose]\n"
+              "          [--config-toggle-ms T] [--flash-sectors N] [--tickless]\n"
+              "          [--lines N] [--capture FILE]\n", argv[0]);
+      return false;
+    }
+  }
+  if (options->ringPeriodMs == 0) {
+    options->ringPeriodMs = 1;
+  }
+  if (options->flashSectors == 0) {
+    options->flashSectors = 1;
+  }
+  if (options->lines > SMARTINTERCOM_LINES) {
+    fprintf(stderr, "%s: --lines is limited to SMARTINTERCOM_LINES (%d)\n", argv[0], SMARTINTERCOM_LINES);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * SmartIntercom Sim Count Rising Edges
+ * Число включений пина SmartIntercom по записанным событиям
+ */
+static unsigned long smartIntercomSimCountRisingEdges(SmartIntercomSimBoard& board, int pin) {
+  unsigned long edges = 0;
+  int level = LOW;
+  const std::vector<SmartIntercomSimEvent>& events = board.smartIntercomGetEvents();
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].pin != pin || events[i].kind != SMARTINTERCOM_SIM_DIGITAL_WRITE) {
+      continue;
+    }
+    if (events[i].value == HIGH && level == LOW) {
+      edges++;
+    }
+    level = events[i].value;
+  }
+  return edges;
+}
+
+/*
+ * SmartIntercom Sim Count Multi-Pin Commits
+ * Число пакетов выходов SmartIntercom, переключивших больше одного пина сразу
+ */
+static unsigned long smartIntercomSimCountMultiPinCommits(SmartIntercomSimBoard& board) {
+  unsigned long commits = 0;
+  uint32_t current = 0;
+  unsigned long pins = 0;
+  const std::vector<SmartIntercomSimEvent>& events = board.smartIntercomGetEvents();
+  for (size_t i = 0; i <= events.size(); i++) {
+    uint32_t commit = i < events.size() ? events[i].commit : 0;
+    if (commit != current) {
+      commits += pins > 1 ? 1 : 0;
+      current = commit;
+      pins = 0;
+    }
+    pins += commit != 0 ? 1 : 0;
+  }
+  return commits;
+}
+
+/*
+ * SmartIntercom Sim Write Trace
+ * Файл трассы SmartIntercom тем же генератором, что отдает GET /api/trace
+ */
+static bool smartIntercomSimWriteTrace(SmartIntercomTrace& trace, const char* path, unsigned long* bytes) {
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  char chunk[1024];
+  uint32_t cursor = 0;
+  size_t length = 0;
+  *bytes = 0;
+  while ((length = SmartIntercomTrace::smartIntercomWriteFile(chunk, sizeof(chunk), &cursor, &trace)) > 0) {
+    fwrite(chunk, 1, length, file);
+    *bytes += length;
+  }
+  return fclose(file) == 0;
+}
+
+/*
+ * SmartIntercom Sim Run Lines
+ * Прогон многоканального SmartIntercomLines (--lines N)
+ */
+static int smartIntercomSimRunLines(SmartIntercomSimBoard& board, const SmartIntercomSimOptions& options) {
+  static SmartIntercomSimLine simLines[SMARTINTERCOM_LINES];
+  static SmartIntercomLines lines;
+
+  for (uint8_t line = 0; line < options.lines; line++) {
+    simLines[line].options = &options;
+    simLines[line].offsetUs = (uint64_t)options.ringPeriodMs * 1000 * line / options.lines;
+    board.smartIntercomSetAnalogSource(SMARTINTERCOM_SIM_LINE_RING_PIN(line), smartIntercomSimLineSource,
+                                       &simLines[line]);
+
+    SmartIntercomLineConfig config;
+    config.ringPin = SMARTINTERCOM_SIM_LINE_RING_PIN(line);
+    config.doorPin = SMARTINTERCOM_SIM_LINE_DOOR_PIN(line);
+    config.onLevel = SMARTINTERCOM_RING_ENVELOPE_ON;
+    config.openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+    config.autoOpenEnabled = false;
+    config.alwaysOpenEnabled = options.autoOpen;
+    lines.smartIntercomBeginLine(line, config);
+  }
+  lines.smartIntercomSubscribe(smartIntercomSimLineEventHandler, simLines,
+                               SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_RING) |
+                                   SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_OPEN));
+
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  uint64_t endUs = (uint64_t)options.iterations * options.stepUs;
+  unsigned long passes = 0;
+  while (options.tickless ? board.smartIntercomGetTimeUs() < endUs : passes < options.iterations) {
+    lines.smartIntercomUpdate();
+    passes++;
+    if (options.tickless) {
+      uint64_t passStartUs = board.smartIntercomGetTimeUs();
+      lines.smartIntercomIdle();
+      if (board.smartIntercomGetTimeUs() == passStartUs) {
+        board.smartIntercomAdvance(1);
+      }
+    } else {
+      board.smartIntercomAdvance(options.stepUs);
+    }
+  }
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  smartIntercomLogFlush();
+
+  unsigned long rings = 0;
+  unsigned long opens = 0;
+  unsigned long relayPulses = 0;
+  for (uint8_t line = 0; line < options.lines; line++) {
+    unsigned long pulses = smartIntercomSimCountRisingEdges(board, SMARTINTERCOM_SIM_LINE_DOOR_PIN(line));
+    printf("line_%u: rings=%lu opens=%lu relay_pulses=%lu\n", line, simLines[line].rings, simLines[line].opens,
+           pulses);
+    rings += simLines[line].rings;
+    opens += simLines[line].opens;
+    relayPulses += pulses;
+  }
+  uint32_t scans = lines.smartIntercomGetScans();
+  printf("lines: %lu\n", options.lines);
+  printf("simulated_seconds: %.3f\n", board.smartIntercomGetTimeUs() / 1e6);
+  printf("wall_seconds: %.3f\n", wallSeconds);
+  printf("loop_passes: %lu\n", passes);
+  printf("line_scans: %lu\n", (unsigned long)scans);
+  printf("scan_ns_per_line: %.1f\n", scans > 0 ? wallSeconds * 1e9 / scans / options.lines : 0.0);
+  printf("rings: %lu\n", rings);
+  printf("opens: %lu\n", opens);
+  printf("relay_pulses: %lu\n", relayPulses);
+  printf("gpio_commits: %lu\n", (unsigned long)board.smartIntercomGetOutputCommits());
+  printf("gpio_multi_pin_commits: %lu\n", smartIntercomSimCountMultiPinCommits(board));
+  printf("adc_reads: %lu\n", board.smartIntercomGetAnalogReads());
+  printf("events_posted: %lu\n", (unsigned long)lines.smartIntercomGetEvents().smartIntercomGetPosted());
+  printf("events_lost: %lu\n", (unsigned long)lines.smartIntercomGetEvents().smartIntercomGetLost());
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  SmartIntercomSimOptions options;
+  if (!smartIntercomSimParseOptions(argc, argv, &options)) {
+    return 2;
+  }
+
+  SmartIntercomSimBoard board;
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(options.verbose);
+  if (options.lines > 0) {
+    return smartIntercomSimRunLines(board, options);
+  }
+  board.smartIntercomSetAnalogSource(SMARTINTERCOM_SIM_DOORBELL_PIN, smartIntercomSimRingSource, &options);
+
+  SmartIntercom smartIntercom;
+  SmartIntercomConfig config;
+  config.doorbellPin = SMARTINTERCOM_SIM_DOORBELL_PIN;
+  config.doorOpenPin = SMARTINTERCOM_SIM_DOOR_PIN;
+  config.handsetPin = SMARTINTERCOM_SIM_HANDSET_PIN;
+  config.ledPin = SMARTINTERCOM_SIM_LED_PIN;
+  config.openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = SMARTINTERCOM_DEFAULT_RING_TIMEOUT;
+  config.autoOpenEnabled = false;
+  config.alwaysOpenEnabled = options.autoOpen;
+  config.openDelay = 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  smartIntercom.smartIntercomBegin(config);
+  smartIntercom.smartIntercomSubscribe(smartIntercomSimEventHandler, nullptr,
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_RING) |
+                                          SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_OPEN));
+  if (options.toneCheck) {
+    smartIntercom.smartIntercomSetRingTone(options.ringToneHz);
+  }
+  if (options.sampleUs > 0) {
+    smartIntercom.smartIntercomEnableRingSampling(options.sampleUs);
+  }
+
+  // SmartIntercom Config journal on simulated flash (only with --config-toggle-ms)
+  SmartIntercomSimFlash flash((uint16_t)options.flashSectors);
+  SmartIntercomConfigStore store;
+  unsigned long toggles = 0;
+  uint64_t nextToggleUs = (uint64_t)options.configToggleMs * 1000;
+  if (options.configToggleMs > 0) {
+    store.smartIntercomBegin(&flash);
+    smartIntercom.smartIntercomAttachConfigStore(&store);
+  }
+
+  // SmartIntercom Statistics with snapshots on a separate simulated flash
+  SmartIntercomSimFlash statsFlash(2);
+  SmartIntercomStats stats;
+  stats.smartIntercomBegin(&statsFlash);
+  smartIntercom.smartIntercomAttachStats(&stats);
+  SmartIntercomMetrics metrics;
+  smartIntercom.smartIntercomAttachMetrics(&metrics);
+
+  // SmartIntercom ADC trace capture (--capture): flash sized for the worst-case encoding,
+  // at least ~19 samples per block and 16 blocks per sector
+  uint64_t captureSamples = options.sampleUs > 0 ? (uint64_t)options.iterations * options.stepUs / options.sampleUs
+                                                 : options.iterations;
+  uint64_t captureSectors = options.captureFile != nullptr ? captureSamples / 300 + 2 : 1;
+  SmartIntercomSimFlash traceFlash((uint16_t)(captureSectors > UINT16_MAX ? UINT16_MAX : captureSectors));
+  SmartIntercomTrace trace;
+  if (options.captureFile != nullptr) {
+    trace.smartIntercomBegin(&traceFlash);
+    trace.smartIntercomStart(SMARTINTERCOM_TRACE_ONESHOT);
+    smartIntercom.smartIntercomAttachTrace(&trace);
+  }
+
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  uint64_t endUs = (uint64_t)options.iterations * options.stepUs;
+  unsigned long passes = 0;
+  while (options.tickless ? board.smartIntercomGetTimeUs() < endUs : passes < options.iterations) {
+    smartIntercom.smartIntercomUpdate();
+    passes++;
+    if (options.tickless) {
+      // SmartIntercom A loop pass costs at least one microsecond of board time
+      uint64_t passStartUs = board.smartIntercomGetTimeUs();
+      smartIntercom.smartIntercomIdle();
+      if (board.smartIntercomGetTimeUs() == passStartUs) {
+        board.smartIntercomAdvance(1);
+      }
+    } else {
+      board.smartIntercomAdvance(options.stepUs);
+    }
+    if (options.configToggleMs > 0 && board.smartIntercomGetTimeUs() >= nextToggleUs) {
+      smartIntercom.smartIntercomToggleAutoOpen();
+      toggles++;
+      nextToggleUs += (uint64_t)options.configToggleMs * 1000;
+    }
+  }
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  smartIntercomLogFlush();
+
+  double simulatedSeconds = board.smartIntercomGetTimeUs() / 1e6;
+  printf("iterations: %lu\n", options.iterations);
+  printf("simulated_seconds: %.3f\n", simulatedSeconds);
+  printf("wall_seconds: %.3f\n", wallSeconds);
+  printf("iterations_per_second: %.0f\n", wallSeconds > 0 ? options.iterations / wallSeconds : 0.0);
+  printf("loop_passes: %lu\n", passes);
+  printf("rings: %lu\n", smartIntercomSimRings);
+  printf("opens: %lu\n", smartIntercomSimOpens);
+  printf("relay_pulses: %lu\n", smartIntercomSimCountRisingEdges(board, SMARTINTERCOM_SIM_DOOR_PIN));
+  printf("gpio_events: %lu\n", (unsigned long)board.smartIntercomGetEvents().size());
+  printf("gpio_commits: %lu\n", (unsigned long)board.smartIntercomGetOutputCommits());
+  printf("gpio_multi_pin_commits: %lu\n", smartIntercomSimCountMultiPinCommits(board));
+  printf("gpio_batched_writes: %lu\n", (unsigned long)smartIntercomOutputGetBatchedWrites());
+  printf("adc_reads: %lu\n", board.smartIntercomGetAnalogReads());
+  printf("dropped_samples: %lu\n", (unsigned long)smartIntercom.smartIntercomGetDroppedRingSamples());
+
+  SmartIntercomHistogram& ringToOpen = metrics.smartIntercomGetHistogram(SMARTINTERCOM_METRIC_RING_TO_OPEN);
+  SmartIntercomHistogram& loopPeriod = metrics.smartIntercomGetHistogram(SMARTINTERCOM_METRIC_LOOP_PERIOD);
+  printf("ring_to_open_count: %lu\n", (unsigned long)ringToOpen.smartIntercomGetCount());
+  printf("ring_to_open_p50_us: %lu\n", (unsigned long)ringToOpen.smartIntercomGetPercentile(500));
+  printf("ring_to_open_p99_us: %lu\n", (unsigned long)ringToOpen.smartIntercomGetPercentile(990));
+  printf("loop_period_p99_us: %lu\n", (unsigned long)loopPeriod.smartIntercomGetPercentile(990));
+  SmartIntercomEventQueue& events = smartIntercom.smartIntercomGetEvents();
+  printf("events_posted: %lu\n", (unsigned long)events.smartIntercomGetPosted());
+  printf("events_lost: %lu\n", (unsigned long)events.smartIntercomGetLost());
+
+  if (options.captureFile != nullptr) {
+    unsigned long bytes = 0;
+    trace.smartIntercomStop();
+    bool written = smartIntercomSimWriteTrace(trace, options.captureFile, &bytes);
+    smartIntercomLogFlush();
+    if (!written) {
+      fprintf(stderr, "smartintercom_sim: cannot write %s\n", options.captureFile);
+      return 1;
+    }
+    printf("capture_samples: %lu\n", (unsigned long)trace.smartIntercomGetSamples());
+    printf("capture_blocks: %lu\n", (unsigned long)trace.smartIntercomGetBlocks());
+    printf("capture_bytes: %lu\n", bytes);
+    printf("capture_bytes_per_sample: %.3f\n",
+           trace.smartIntercomGetSamples() > 0 ? (double)bytes / trace.smartIntercomGetSamples() : 0.0);
+  }
+
+  // SmartIntercom Reboot: restore statistics from the last snapshot
+  stats.smartIntercomSave();
+  SmartIntercomStats restoredStats;
+  bool statsRestored = restoredStats.smartIntercomBegin(&statsFlash);
+  smartIntercomLogFlush();
+  printf("stats_rings_total: %lu\n", (unsigned long)stats.smartIntercomGetTotal(SMARTINTERCOM_STATS_RINGS));
+  printf("stats_opens_last_hour: %lu\n",
+         (unsigned long)stats.smartIntercomGetSum(SMARTINTERCOM_STATS_MINUTE, SMARTINTERCOM_STATS_OPENS,
+                                                   SMARTINTERCOM_STATS_MINUTES));
+  printf("stats_opens_last_day: %lu\n",
+         (unsigned long)stats.smartIntercomGetSum(SMARTINTERCOM_STATS_HOUR, SMARTINTERCOM_STATS_OPENS, 24));
+  printf("stats_saves: %lu\n", (unsigned long)stats.smartIntercomGetSaves());
+  printf("stats_restored: %s\n",
+         statsRestored && restoredStats.smartIntercomGetTotal(SMARTINTERCOM_STATS_OPENS) ==
+                              stats.smartIntercomGetTotal(SMARTINTERCOM_STATS_OPENS) ? "yes" : "no");
+
+  if (options.configToggleMs > 0) {
+    // SmartIntercom Reboot: replay the journal into a fresh store
+    smartIntercom.smartIntercomSaveConfigNow();
+    SmartIntercomConfigStore replayed;
+    SmartIntercomConfig restored = smartIntercom.smartIntercomGetConfig();
+    restored.autoOpenEnabled = !restored.autoOpenEnabled;
+    bool found = replayed.smartIntercomBegin(&flash) && replayed.smartIntercomLoad(&restored);
+    smartIntercomLogFlush();
+    printf("config_toggles: %lu\n", toggles);
+    printf("store_commits: %lu\n", (unsigned long)store.smartIntercomGetCommits());
+    printf("store_coalesced: %lu\n", (unsigned long)store.smartIntercomGetCoalesced());
+    printf("store_erases: %lu\n", (unsigned long)flash.smartIntercomGetTotalErases());
+    printf("store_bytes_written: %lu\n", (unsigned long)flash.smartIntercomGetBytesWritten());
+    printf("store_replayed_records: %u\n", replayed.smartIntercomGetReplayedRecords());
+    printf("store_restored: %s\n",
+           found && restored.autoOpenEnabled == smartIntercom.smartIntercomGetConfig().autoOpenEnabled ? "yes" : "no");
+  }
+  return 0;
+}
@@ -0,0 +1,479 @@
+/*
+ * smartintercom_state_test.cpp - Проверка переходов состояний SmartIntercom
+ *
+ * Ставит настоящий SmartIntercom на симулированной плате в каждое
+ * состояние, подает каждый вход и сверяет новое состояние, срок
+ * входа TIMEOUT и записи в пины с ожидаемой таблицей. Таблица задана
+ * здесь заново, а не берется из smartIntercomTransitions: так тест
+ * ловит и ошибку в таблице, и ошибку в smartIntercomDispatchInput().
+ *
+ * Затем те же переходы проходятся через публичный API и цикл
+ * smartIntercomUpdate() в виртуальном времени: звонок без ответа,
+ * повторный звонок, открытие и закрытие двери по сроку, закрытие
+ * командой, сброс и повторная инициализация.
+ *
+ * Все проверки выполняются дважды: для SmartIntercom с пинами из
+ * SmartIntercomConfig и для SmartIntercomFixed с теми же пинами из
+ * Config, чтобы выходы с пинами в шаблоне вели себя так же.
+ *
+ * Использование:
+ *   smartintercom_state_test [--verbose]
+ *
+ * Код выхода 1, если хотя бы одна проверка не прошла.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SmartIntercom.h>
+#include <SmartIntercomFixed.h>
+#include "SmartIntercomSimBoard.h"
+
+// SmartIntercom Test Board
+#define SMARTINTERCOM_TEST_DOORBELL_PIN A0
+#define SMARTINTERCOM_TEST_DOOR_PIN 5
+#define SMARTINTERCOM_TEST_LED_PIN LED_BUILTIN
+#define SMARTINTERCOM_TEST_HANDSET_PIN 4
+#define SMARTINTERCOM_TEST_OPEN_TIME 2000
+#define SMARTINTERCOM_TEST_RING_TIMEOUT 10000
+
+// SmartIntercom Test Board for SmartIntercomFixed (те же пины и времена)
+struct SmartIntercomTestBoard : SmartIntercomFixedDefaults {
+  static const int doorbellPin = SMARTINTERCOM_TEST_DOORBELL_PIN;
+  static const int doorOpenPin = SMARTINTERCOM_TEST_DOOR_PIN;
+  static const int handsetPin = SMARTINTERCOM_TEST_HANDSET_PIN;
+  static const int ledPin = SMARTINTERCOM_TEST_LED_PIN;
+  static const int openTime = SMARTINTERCOM_TEST_OPEN_TIME;
+  static const int ringTimeout = SMARTINTERCOM_TEST_RING_TIMEOUT;
+};
+
+// SmartIntercom Срок, которым тест помечает состояние перед входом (KEEP должен его сохранить)
+#define SMARTINTERCOM_TEST_SENTINEL_MS 777
+
+// SmartIntercom Expected Transition Effects
+enum SmartIntercomTestEffect {
+  SMARTINTERCOM_TEST_NOTHING,    // SmartIntercom пины не меняются
+  SMARTINTERCOM_TEST_LED_OFF,    // SmartIntercom светодиод гаснет, дверь остается открытой
+  SMARTINTERCOM_TEST_CLOSE       // SmartIntercom дверь закрывается, светодиод гаснет
+};
+
+/*
+ * SmartIntercomTestRow - Ожидаемый результат входа в состоянии SmartIntercom
+ *
+ * next == SMARTINTERCOM_STATES - вход игнорируется, срок и пины не меняются.
+ */
+struct SmartIntercomTestRow {
+  SmartIntercomDeviceState next;
+  SmartIntercomTestEffect effect;
+  SmartIntercomStateTimeout timeout;
+};
+
+#define SMARTINTERCOM_TEST_GO(next, effect, timeout) \
+  { SMARTINTERCOM_STATE_##next, SMARTINTERCOM_TEST_##effect, SMARTINTERCOM_TIMEOUT_##timeout }
+#define SMARTINTERCOM_TEST_IGNORED { SMARTINTERCOM_STATES, SMARTINTERCOM_TEST_NOTHING, SMARTINTERCOM_TIMEOUT_KEEP }
+
+// SmartIntercom Expected Transitions: BEGIN, RING, OPEN, CLOSE, TIMEOUT, RESET
+static const SmartIntercomTestRow smartIntercomTestRows[SMARTINTERCOM_STATES][SMARTINTERCOM_INPUTS] = {
+  { // INIT
+    SMARTINTERCOM_TEST_GO(READY, NOTHING, NONE), SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_IGNORED,
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // READY
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_IGNORED,
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // IDLE
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_IGNORED,
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // RINGING
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_IGNORED,
+    SMARTINTERCOM_TEST_GO(IDLE, LED_OFF, NONE), SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // OPENING
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_TEST_GO(OPEN, NOTHING, DOOR), SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // OPEN
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_TEST_GO(IDLE, CLOSE, NONE), SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // CLOSING
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) },
+  { // ERROR
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(RINGING, NOTHING, RING),
+    SMARTINTERCOM_TEST_GO(OPENING, NOTHING, IMMEDIATE), SMARTINTERCOM_TEST_IGNORED,
+    SMARTINTERCOM_TEST_IGNORED, SMARTINTERCOM_TEST_GO(INIT, NOTHING, NONE) }
+};
+
+#undef SMARTINTERCOM_TEST_GO
+#undef SMARTINTERCOM_TEST_IGNORED
+
+static const char* const smartIntercomTestStateNames[SMARTINTERCOM_STATES + 1] = {
+  "INIT", "READY", "IDLE", "RINGING", "OPENING", "OPEN", "CLOSING", "ERROR", "IGNORED"
+};
+static const char* const smartIntercomTestInputNames[SMARTINTERCOM_INPUTS] = {
+  "BEGIN", "RING", "OPEN", "CLOSE", "TIMEOUT", "RESET"
+};
+
+/*
+ * SmartIntercomStateTest - Проверки переходов SmartIntercom
+ *
+ * Друг SmartIntercom: состояния CLOSING и ERROR не достижимы через
+ * публичный API, поэтому тест ставит состояние и срок напрямую.
+ */
+class SmartIntercomStateTest {
+private:
+  SmartIntercomSimBoard& smartIntercomBoard;
+  SmartIntercom& smartIntercom;
+  const char* smartIntercomName;
+  unsigned long smartIntercomChecks;
+  unsigned long smartIntercomFailures;
+  bool smartIntercomVerbose;
+
+  // SmartIntercom Check Helpers
+  void smartIntercomCheck(bool ok, const char* scope, const char* what);
+  void smartIntercomRun(unsigned long ms);
+  bool smartIntercomLedOn();
+  bool smartIntercomDoorOpen();
+  bool smartIntercomOnlyLedWrites();
+  void smartIntercomPrepare(uint8_t state);
+
+  // SmartIntercom Scenarios
+  void smartIntercomCheckPair(uint8_t state, uint8_t input);
+  void smartIntercomCheckUnansweredRing();
+  void smartIntercomCheckDoorTimeout();
+  void smartIntercomCheckCloseCommand();
+  void smartIntercomCheckReset();
+
+public:
+  SmartIntercomStateTest(SmartIntercomSimBoard& board, SmartIntercom& smartIntercom, const char* name,
+                         bool verbose);
+
+  unsigned long smartIntercomRunAll();
+  unsigned long smartIntercomGetChecks() { return smartIntercomChecks; }
+};
+
+/*
+ * SmartIntercomStateTest Constructor
+ */
+SmartIntercomStateTest::SmartIntercomStateTest(SmartIntercomSimBoard& board, SmartIntercom& smartIntercom,
+                                               const char* name, bool verbose)
+    : smartIntercomBoard(board), smartIntercom(smartIntercom), smartIntercomName(name) {
+  smartIntercomChecks = 0;
+  smartIntercomFailures = 0;
+  smartIntercomVerbose = verbose;
+
+  SmartIntercomConfig config;
+  config.doorbellPin = SMARTINTERCOM_TEST_DOORBELL_PIN;
+  config.doorOpenPin = SMARTINTERCOM_TEST_DOOR_PIN;
+  config.handsetPin = SMARTINTERCOM_TEST_HANDSET_PIN;
+  config.ledPin = SMARTINTERCOM_TEST_LED_PIN;
+  config.openTime = SMARTINTERCOM_TEST_OPEN_TIME;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = SMARTINTERCOM_TEST_RING_TIMEOUT;
+  config.autoOpenEnabled = false;
+  config.alwaysOpenEnabled = false;
+  config.openDelay = 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  smartIntercomBoard.smartIntercomSetAnalog(SMARTINTERCOM_TEST_DOORBELL_PIN, 0);
+  smartIntercom.smartIntercomBegin(config);
+}
+
+/*
+ * SmartIntercomStateTest Check
+ */
+void SmartIntercomStateTest::smartIntercomCheck(bool ok, const char* scope, const char* what) {
+  smartIntercomChecks++;
+  if (!ok) {
+    smartIntercomFailures++;
+    printf("FAIL %s %s: %s\n", smartIntercomName, scope, what);
+  } else if (smartIntercomVerbose) {
+    printf("ok   %s %s: %s\n", smartIntercomName, scope, what);
+  }
+}
+
+/*
+ * SmartIntercomStateTest Run
+ * Проходы цикла SmartIntercom каждую миллисекунду виртуального времени
+ */
+void SmartIntercomStateTest::smartIntercomRun(unsigned long ms) {
+  for (unsigned long i = 0; i < ms; i++) {
+    smartIntercomBoard.smartIntercomAdvanceMillis(1);
+    smartIntercom.smartIntercomUpdate();
+  }
+}
+
+bool SmartIntercomStateTest::smartIntercomLedOn() {
+  return smartIntercomBoard.smartIntercomGetPinLevel(SMARTINTERCOM_TEST_LED_PIN) == HIGH;
+}
+
+bool SmartIntercomStateTest::smartIntercomDoorOpen() {
+  return smartIntercom.smartIntercomDoorCheck();
+}
+
+/*
+ * SmartIntercomStateTest Only LED Writes
+ * С момента smartIntercomClearEvents() пины менял только светодиод, и только в LOW
+ */
+bool SmartIntercomStateTest::smartIntercomOnlyLedWrites() {
+  const std::vector<SmartIntercomSimEvent>& events = smartIntercomBoard.smartIntercomGetEvents();
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].pin != SMARTINTERCOM_TEST_LED_PIN || events[i].value != LOW) {
+      return false;
+    }
+  }
+  return !events.empty();
+}
+
+/*
+ * SmartIntercomStateTest Prepare
+ * Открытая дверь, горящий светодиод, состояние state со сроком-меткой
+ */
+void SmartIntercomStateTest::smartIntercomPrepare(uint8_t state) {
+  // SmartIntercom Let the previous relay pulse and LED sequences finish
+  smartIntercom.smartIntercomDoorClose();
+  for (unsigned long ms = 0; ms < SMARTINTERCOM_TEST_OPEN_TIME + 1000; ms += 10) {
+    smartIntercomBoard.smartIntercomAdvanceMillis(10);
+    smartIntercomScheduler.smartIntercomRun();
+  }
+
+  smartIntercom.smartIntercomDoorOpen();
+  smartIntercom.smartIntercomLEDWrite(true);
+  smartIntercom.smartIntercomState = (SmartIntercomDeviceState)state;
+  smartIntercom.smartIntercomStateDeadline = smartIntercomMillis() + SMARTINTERCOM_TEST_SENTINEL_MS;
+  smartIntercom.smartIntercomStateArmed = true;
+
+  // SmartIntercom Past the LED debounce so the action's write is not swallowed
+  smartIntercomBoard.smartIntercomAdvanceMillis(SMARTINTERCOM_DEFAULT_DEBOUNCE * 2);
+  smartIntercomBoard.smartIntercomClearEvents();
+}
+
+/*
+ * SmartIntercomStateTest Check Pair
+ * Вход input в состоянии state против smartIntercomTestRows
+ */
+void SmartIntercomStateTest::smartIntercomCheckPair(uint8_t state, uint8_t input) {
+  const SmartIntercomTestRow& row = smartIntercomTestRows[state][input];
+  char scope[64];
+  snprintf(scope, sizeof(scope), "%s + %s -> %s", smartIntercomTestStateNames[state],
+           smartIntercomTestInputNames[input], smartIntercomTestStateNames[row.next]);
+
+  smartIntercomPrepare(state);
+  unsigned long sentinel = smartIntercom.smartIntercomStateDeadline;
+  unsigned long now = smartIntercomMillis();
+  bool handled = smartIntercom.smartIntercomDispatchInput((SmartIntercomStateInput)input);
+
+  bool ignored = row.next == SMARTINTERCOM_STATES;
+  smartIntercomCheck(handled == !ignored, scope, "dispatch reports whether the input is handled");
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == (ignored ? state : row.next), scope,
+                     "resulting state");
+
+  // SmartIntercom Deadline of the TIMEOUT input in the new state
+  bool armed = smartIntercom.smartIntercomStateArmed;
+  unsigned long deadline = smartIntercom.smartIntercomStateDeadline;
+  switch (row.timeout) {
+    case SMARTINTERCOM_TIMEOUT_KEEP:
+      smartIntercomCheck(armed && deadline == sentinel, scope, "deadline kept");
+      break;
+    case SMARTINTERCOM_TIMEOUT_NONE:
+      smartIntercomCheck(!armed, scope, "deadline cleared");
+      break;
+    case SMARTINTERCOM_TIMEOUT_IMMEDIATE:
+      smartIntercomCheck(armed && deadline == now, scope, "deadline on the next pass");
+      break;
+    case SMARTINTERCOM_TIMEOUT_RING:
+      smartIntercomCheck(armed && deadline == now + SMARTINTERCOM_TEST_RING_TIMEOUT, scope,
+                         "deadline after ringTimeout");
+      break;
+    case SMARTINTERCOM_TIMEOUT_DOOR:
+      smartIntercomCheck(armed && deadline == now + SMARTINTERCOM_TEST_OPEN_TIME + 1000, scope,
+                         "deadline after openTime + 1 s");
+      break;
+  }
+
+  // SmartIntercom Actions of the transition (the relay pulse is never cut by a transition)
+  switch (row.effect) {
+    case SMARTINTERCOM_TEST_NOTHING:
+      smartIntercomCheck(smartIntercomBoard.smartIntercomGetEvents().empty(), scope, "no pin writes");
+      smartIntercomCheck(smartIntercomLedOn() && smartIntercomDoorOpen(), scope, "LED on, door open");
+      break;
+    case SMARTINTERCOM_TEST_LED_OFF:
+      smartIntercomCheck(smartIntercomOnlyLedWrites() && !smartIntercomLedOn(), scope, "LED off");
+      smartIntercomCheck(smartIntercomDoorOpen(), scope, "door left open");
+      break;
+    case SMARTINTERCOM_TEST_CLOSE:
+      smartIntercomCheck(smartIntercomOnlyLedWrites() && !smartIntercomLedOn(), scope, "LED off");
+      smartIntercomCheck(!smartIntercomDoorOpen(), scope, "door closed");
+      break;
+  }
+  smartIntercomCheck(smartIntercomBoard.smartIntercomGetPinLevel(SMARTINTERCOM_TEST_DOOR_PIN) == HIGH, scope,
+                     "relay pulse still held");
+}
+
+/*
+ * SmartIntercomStateTest Check Unanswered Ring
+ * Звонок без ответа: RINGING, повторный звонок продлевает срок, по сроку IDLE
+ */
+void SmartIntercomStateTest::smartIntercomCheckUnansweredRing() {
+  const char* scope = "unanswered ring";
+  smartIntercom.smartIntercomReset();
+  smartIntercomRun(100);
+
+  smartIntercom.smartIntercomProcessRing();
+  unsigned long deadline = 0;
+  unsigned long first = smartIntercomMillis();
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_RINGING, scope, "RINGING");
+
+  smartIntercomRun(SMARTINTERCOM_TEST_RING_TIMEOUT / 2);
+  smartIntercom.smartIntercomProcessRing();
+  unsigned long second = smartIntercomMillis();
+  smartIntercomCheck(second != first, scope, "second ring later than the first");
+  smartIntercomRun(1000);
+  smartIntercomCheck(smartIntercom.smartIntercomGetNextDeadline(&deadline) &&
+                         deadline == second + SMARTINTERCOM_TEST_RING_TIMEOUT,
+                     scope, "second ring extends the deadline");
+
+  smartIntercomRun(second + SMARTINTERCOM_TEST_RING_TIMEOUT - smartIntercomMillis() - 1);
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_RINGING, scope,
+                     "still RINGING 1 ms before the deadline");
+  smartIntercomBoard.smartIntercomClearEvents();
+  smartIntercomRun(1);
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_IDLE, scope,
+                     "IDLE at the deadline");
+  smartIntercomCheck(!smartIntercomLedOn(), scope, "LED off");
+  smartIntercomCheck(!smartIntercom.smartIntercomGetNextDeadline(&deadline), scope, "nothing left to wake for");
+}
+
+/*
+ * SmartIntercomStateTest Check Door Timeout
+ * Открытие: OPENING, на следующем проходе OPEN, по сроку двери IDLE
+ */
+void SmartIntercomStateTest::smartIntercomCheckDoorTimeout() {
+  const char* scope = "door timeout";
+  smartIntercom.smartIntercomReset();
+  smartIntercomRun(100);
+
+  smartIntercom.smartIntercomOpenDoor();
+  unsigned long opened = smartIntercomMillis();
+  unsigned long deadline = 0;
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_OPENING, scope, "OPENING");
+  smartIntercomCheck(smartIntercomBoard.smartIntercomGetPinLevel(SMARTINTERCOM_TEST_DOOR_PIN) == HIGH &&
+                         smartIntercomLedOn(),
+                     scope, "relay and LED on");
+  smartIntercomCheck(smartIntercom.smartIntercomGetNextDeadline(&deadline) && deadline == opened, scope,
+                     "OPENING is due immediately");
+
+  smartIntercomRun(1);
+  unsigned long open = smartIntercomMillis();
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_OPEN, scope,
+                     "OPEN on the next pass");
+  smartIntercomCheck(smartIntercom.smartIntercomStateArmed &&
+                         smartIntercom.smartIntercomStateDeadline == open + SMARTINTERCOM_TEST_OPEN_TIME + 1000,
+                     scope, "OPEN deadline after openTime + 1 s");
+
+  smartIntercomRun(SMARTINTERCOM_TEST_OPEN_TIME);
+  smartIntercomCheck(smartIntercomBoard.smartIntercomGetPinLevel(SMARTINTERCOM_TEST_DOOR_PIN) == LOW, scope,
+                     "relay released after openTime");
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_OPEN && smartIntercomLedOn(),
+                     scope, "still OPEN with the LED on");
+
+  smartIntercomRun(open + SMARTINTERCOM_TEST_OPEN_TIME + 1000 - smartIntercomMillis());
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_IDLE, scope,
+                     "IDLE at the deadline");
+  smartIntercomCheck(!smartIntercomDoorOpen() && !smartIntercomLedOn(), scope, "door closed, LED off");
+  smartIntercomCheck(!smartIntercom.smartIntercomGetNextDeadline(&deadline), scope, "nothing left to wake for");
+}
+
+/*
+ * SmartIntercomStateTest Check Close Command
+ * Закрытие командой в OPEN - IDLE без срока; в RINGING команда игнорируется
+ */
+void SmartIntercomStateTest::smartIntercomCheckCloseCommand() {
+  const char* scope = "close command";
+  smartIntercom.smartIntercomReset();
+  smartIntercomRun(100);
+
+  smartIntercom.smartIntercomOpenDoor();
+  smartIntercomRun(SMARTINTERCOM_DEFAULT_DEBOUNCE * 2);
+  smartIntercom.smartIntercomCloseDoor();
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_IDLE, scope, "OPEN -> IDLE");
+  smartIntercomCheck(!smartIntercom.smartIntercomStateArmed, scope, "no deadline");
+  smartIntercomCheck(!smartIntercomDoorOpen() && !smartIntercomLedOn(), scope, "door closed, LED off");
+
+  smartIntercomRun(SMARTINTERCOM_TEST_OPEN_TIME);
+  smartIntercom.smartIntercomProcessRing();
+  unsigned long deadline = smartIntercom.smartIntercomStateDeadline;
+  smartIntercomRun(SMARTINTERCOM_DEFAULT_DEBOUNCE * 2);
+  smartIntercom.smartIntercomCloseDoor();
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_RINGING &&
+                         smartIntercom.smartIntercomStateDeadline == deadline,
+                     scope, "ignored in RINGING");
+}
+
+/*
+ * SmartIntercomStateTest Check Reset
+ * Сброс в OPEN - INIT без срока, повторный smartIntercomBegin() - READY
+ */
+void SmartIntercomStateTest::smartIntercomCheckReset() {
+  const char* scope = "reset";
+  smartIntercom.smartIntercomOpenDoor();
+  smartIntercomRun(1);
+  smartIntercom.smartIntercomReset();
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_INIT, scope, "INIT");
+  smartIntercomCheck(!smartIntercom.smartIntercomStateArmed, scope, "no deadline");
+  smartIntercomCheck(!smartIntercomLedOn(), scope, "LED off");
+
+  smartIntercom.smartIntercomBegin(smartIntercom.smartIntercomGetConfig());
+  smartIntercomCheck(smartIntercom.smartIntercomGetState() == SMARTINTERCOM_STATE_READY, scope,
+                     "begin moves INIT to READY");
+}
+
+/*
+ * SmartIntercomStateTest Run All
+ * Возвращает число непройденных проверок
+ */
+unsigned long SmartIntercomStateTest::smartIntercomRunAll() {
+  for (uint8_t state = 0; state < SMARTINTERCOM_STATES; state++) {
+    for (uint8_t input = 0; input < SMARTINTERCOM_INPUTS; input++) {
+      smartIntercomCheckPair(state, input);
+    }
+  }
+  smartIntercomCheckUnansweredRing();
+  smartIntercomCheckDoorTimeout();
+  smartIntercomCheckCloseCommand();
+  smartIntercomCheckReset();
+  return smartIntercomFailures;
+}
+
+int main(int argc, char** argv) {
+  bool verbose = argc > 1 && strcmp(argv[1], "--verbose") == 0;
+
+  SmartIntercomSimBoard board;
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(false);
+
+  // SmartIntercom One device at a time: both drive the same simulated pins
+  unsigned long failures = 0;
+  {
+    SmartIntercom smartIntercom;
+    SmartIntercomStateTest test(board, smartIntercom, "SmartIntercom", verbose);
+    unsigned long variantFailures = test.smartIntercomRunAll();
+    printf("SmartIntercom transitions: %d, checks: %lu, failures: %lu\n",
+           SMARTINTERCOM_STATES * SMARTINTERCOM_INPUTS, test.smartIntercomGetChecks(), variantFailures);
+    failures += variantFailures;
+  }
+  {
+    SmartIntercomFixed<SmartIntercomTestBoard> smartIntercom;
+    SmartIntercomStateTest test(board, smartIntercom, "SmartIntercomFixed", verbose);
+    unsigned long variantFailures = test.smartIntercomRunAll();
+    printf("SmartIntercomFixed transitions: %d, checks: %lu, failures: %lu\n",
+           SMARTINTERCOM_STATES * SMARTINTERCOM_INPUTS, test.smartIntercomGetChecks(), variantFailures);
+    failures += variantFailures;
+  }
+  return failures == 0 ? 0 : 1;
+}
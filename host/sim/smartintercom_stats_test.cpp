@@ -0,0 +1,226 @@
+/*
+ * smartintercom_stats_test.cpp - Проверка статистики SmartIntercom и ее снимков
+ *
+ * SmartIntercomStats получает события по известному расписанию на
+ * симулированной плате в виртуальном времени (трое суток с лишним,
+ * каждую минуту свое число звонков, открытий, авто-открытий и
+ * ошибок). Суммы окон минутного, часового и суточного рядов и итоги
+ * сверяются с расписанием, посчитанным здесь заново.
+ *
+ * Затем снимок сохраняется в SmartIntercomSimFlash, и новый экземпляр
+ * после «перезагрузки» (с простоем) должен вернуть те же итоги, минуту
+ * и суммы окон и продолжить счет с минуты снимка. Оборванная запись
+ * следующего снимка не должна портить предыдущий.
+ *
+ * Использование:
+ *   smartintercom_stats_test [--verbose]
+ *
+ * Код выхода 1, если хотя бы одна проверка не прошла.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SmartIntercom.h>
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Test Schedule: трое суток и пять часов событий
+#define SMARTINTERCOM_TEST_MINUTES (3 * 1440 + 300)
+#define SMARTINTERCOM_TEST_MINUTE_MS 60000UL
+#define SMARTINTERCOM_TEST_DOWNTIME_MS (10UL * 3600UL * 1000UL)
+
+// SmartIntercom Test Windows (ряд и число интервалов)
+struct SmartIntercomTestWindow {
+  SmartIntercomStatsRange range;
+  uint16_t intervals;
+  uint32_t minutesPerInterval;
+};
+
+static const SmartIntercomTestWindow smartIntercomTestWindows[] = {
+  { SMARTINTERCOM_STATS_MINUTE, 1, 1 },
+  { SMARTINTERCOM_STATS_MINUTE, 15, 1 },
+  { SMARTINTERCOM_STATS_MINUTE, SMARTINTERCOM_STATS_MINUTES, 1 },
+  { SMARTINTERCOM_STATS_HOUR, 1, 60 },
+  { SMARTINTERCOM_STATS_HOUR, 24, 60 },
+  { SMARTINTERCOM_STATS_HOUR, SMARTINTERCOM_STATS_HOURS, 60 },
+  { SMARTINTERCOM_STATS_DAY, 1, 1440 },
+  { SMARTINTERCOM_STATS_DAY, 2, 1440 },
+  { SMARTINTERCOM_STATS_DAY, SMARTINTERCOM_STATS_DAYS, 1440 }
+};
+
+static const char* const smartIntercomTestCounterNames[SMARTINTERCOM_STATS_COUNTERS] = {
+  "rings", "opens", "auto_opens", "errors"
+};
+static const char* const smartIntercomTestRangeNames[SMARTINTERCOM_STATS_RANGES] = { "minute", "hour", "day" };
+
+/*
+ * SmartIntercom Test Schedule
+ * Число событий счетчика SmartIntercom в минуту minute
+ */
+static uint32_t smartIntercomTestEvents(uint32_t minute, uint8_t counter) {
+  switch (counter) {
+    case SMARTINTERCOM_STATS_RINGS: return (minute * 7) % 5;
+    case SMARTINTERCOM_STATS_OPENS: return minute % 10 == 0 ? 1 : 0;
+    case SMARTINTERCOM_STATS_AUTO_OPENS: return minute % 30 == 0 ? 1 : 0;
+    default: return minute % 97 == 0 ? 1 : 0;
+  }
+}
+
+/*
+ * SmartIntercomStatsTest - Проверки статистики SmartIntercom
+ */
+class SmartIntercomStatsTest {
+private:
+  SmartIntercomSimBoard& smartIntercomBoard;
+  bool smartIntercomVerbose;
+  unsigned long smartIntercomChecks;
+  unsigned long smartIntercomFailures;
+
+  // SmartIntercom Check Helpers
+  void smartIntercomCheck(bool ok, const char* scope, const char* what);
+  void smartIntercomRecordUntil(SmartIntercomStats& stats, uint32_t from, uint32_t to);
+  static uint32_t smartIntercomExpectedSum(uint32_t recorded, uint32_t current, const SmartIntercomTestWindow& window,
+                                           uint8_t counter);
+  void smartIntercomCheckSeries(SmartIntercomStats& stats, uint32_t recorded, uint32_t current, const char* scope);
+
+public:
+  SmartIntercomStatsTest(SmartIntercomSimBoard& board, bool verbose);
+
+  unsigned long smartIntercomRunAll();
+  unsigned long smartIntercomGetChecks() { return smartIntercomChecks; }
+};
+
+/*
+ * SmartIntercomStatsTest Constructor
+ */
+SmartIntercomStatsTest::SmartIntercomStatsTest(SmartIntercomSimBoard& board, bool verbose)
+  : smartIntercomBoard(board), smartIntercomVerbose(verbose), smartIntercomChecks(0), smartIntercomFailures(0) {
+}
+
+/*
+ * SmartIntercomStatsTest Check
+ */
+void SmartIntercomStatsTest::smartIntercomCheck(bool ok, const char* scope, const char* what) {
+  smartIntercomChecks++;
+  if (!ok) {
+    smartIntercomFailures++;
+    printf("FAIL %s: %s\n", scope, what);
+  } else if (smartIntercomVerbose) {
+    printf("ok   %s: %s\n", scope, what);
+  }
+}
+
+/*
+ * SmartIntercomStatsTest Record Until
+ * События расписания SmartIntercom за минуты [from, to); после
+ * возврата статистика стоит в начале минуты to
+ */
+void SmartIntercomStatsTest::smartIntercomRecordUntil(SmartIntercomStats& stats, uint32_t from, uint32_t to) {
+  for (uint32_t minute = from; minute < to; minute++) {
+    smartIntercomBoard.smartIntercomAdvanceMillis(1000);
+    for (uint8_t counter = 0; counter < SMARTINTERCOM_STATS_COUNTERS; counter++) {
+      for (uint32_t i = smartIntercomTestEvents(minute, counter); i > 0; i--) {
+        stats.smartIntercomRecord((SmartIntercomStatsCounter)counter);
+      }
+    }
+    smartIntercomBoard.smartIntercomAdvanceMillis(SMARTINTERCOM_TEST_MINUTE_MS - 1000);
+  }
+}
+
+/*
+ * SmartIntercomStatsTest Expected Sum
+ * Сумма расписания SmartIntercom за окно: события минут [0, recorded),
+ * попавших в последние intervals интервалов до минуты current
+ */
+uint32_t SmartIntercomStatsTest::smartIntercomExpectedSum(uint32_t recorded, uint32_t current,
+                                                          const SmartIntercomTestWindow& window, uint8_t counter) {
+  uint32_t last = current / window.minutesPerInterval;
+  uint32_t sum = 0;
+  for (uint32_t minute = 0; minute < recorded; minute++) {
+    uint32_t interval = minute / window.minutesPerInterval;
+    if (interval <= last && last - interval < window.intervals) {
+      sum += smartIntercomTestEvents(minute, counter);
+    }
+  }
+  return sum;
+}
+
+/*
+ * SmartIntercomStatsTest Check Series
+ * Минута, итоги и суммы всех окон SmartIntercom против расписания
+ */
+void SmartIntercomStatsTest::smartIntercomCheckSeries(SmartIntercomStats& stats, uint32_t recorded, uint32_t current,
+                                                      const char* scope) {
+  char what[96];
+  smartIntercomCheck(stats.smartIntercomGetMinute() == current, scope, "minute");
+  for (uint8_t counter = 0; counter < SMARTINTERCOM_STATS_COUNTERS; counter++) {
+    uint32_t total = 0;
+    for (uint32_t minute = 0; minute < recorded; minute++) {
+      total += smartIntercomTestEvents(minute, counter);
+    }
+    snprintf(what, sizeof(what), "%s total %lu", smartIntercomTestCounterNames[counter], (unsigned long)total);
+    smartIntercomCheck(stats.smartIntercomGetTotal((SmartIntercomStatsCounter)counter) == total, scope, what);
+
+    for (size_t i = 0; i < sizeof(smartIntercomTestWindows) / sizeof(smartIntercomTestWindows[0]); i++) {
+      const SmartIntercomTestWindow& window = smartIntercomTestWindows[i];
+      uint32_t expected = smartIntercomExpectedSum(recorded, current, window, counter);
+      uint32_t sum = stats.smartIntercomGetSum(window.range, (SmartIntercomStatsCounter)counter, window.intervals);
+      snprintf(what, sizeof(what), "%s last %u %s: %lu (expected %lu)", smartIntercomTestCounterNames[counter],
+               window.intervals, smartIntercomTestRangeNames[window.range], (unsigned long)sum,
+               (unsigned long)expected);
+      smartIntercomCheck(sum == expected, scope, what);
+    }
+  }
+}
+
+/*
+ * SmartIntercomStatsTest Run All
+ */
+unsigned long SmartIntercomStatsTest::smartIntercomRunAll() {
+  SmartIntercomSimFlash flash(2);
+
+  // SmartIntercom Live series against the schedule
+  SmartIntercomStats stats;
+  smartIntercomCheck(!stats.smartIntercomBegin(&flash), "live", "no snapshot on blank flash");
+  smartIntercomRecordUntil(stats, 0, SMARTINTERCOM_TEST_MINUTES);
+  smartIntercomCheckSeries(stats, SMARTINTERCOM_TEST_MINUTES, SMARTINTERCOM_TEST_MINUTES, "live");
+  smartIntercomCheck(stats.smartIntercomSave(), "live", "snapshot saved");
+
+  // SmartIntercom Reboot after downtime: the snapshot comes back, downtime is not counted
+  smartIntercomBoard.smartIntercomAdvanceMillis(SMARTINTERCOM_TEST_DOWNTIME_MS);
+  SmartIntercomStats restored;
+  smartIntercomCheck(restored.smartIntercomBegin(&flash), "restored", "snapshot found");
+  smartIntercomCheckSeries(restored, SMARTINTERCOM_TEST_MINUTES, SMARTINTERCOM_TEST_MINUTES, "restored");
+
+  // SmartIntercom Counting goes on from the snapshot minute
+  uint32_t resumed = SMARTINTERCOM_TEST_MINUTES + 90;
+  smartIntercomRecordUntil(restored, SMARTINTERCOM_TEST_MINUTES, resumed);
+  smartIntercomCheckSeries(restored, resumed, resumed, "resumed");
+  smartIntercomCheck(restored.smartIntercomSave(), "resumed", "second snapshot saved");
+
+  // SmartIntercom Torn third snapshot: the second one stays in the other sector
+  smartIntercomRecordUntil(restored, resumed, resumed + 30);
+  flash.smartIntercomTearNextWrite(256);
+  smartIntercomCheck(!restored.smartIntercomSave(), "torn", "torn snapshot reports failure");
+  SmartIntercomStats fallback;
+  smartIntercomCheck(fallback.smartIntercomBegin(&flash), "torn", "previous snapshot found");
+  smartIntercomCheckSeries(fallback, resumed, resumed, "torn");
+  return smartIntercomFailures;
+}
+
+int main(int argc, char** argv) {
+  bool verbose = argc > 1 && strcmp(argv[1], "--verbose") == 0;
+
+  SmartIntercomSimBoard board;
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(false);
+
+  SmartIntercomStatsTest test(board, verbose);
+  unsigned long failures = test.smartIntercomRunAll();
+  printf("SmartIntercomStats minutes: %d, checks: %lu, failures: %lu\n", SMARTINTERCOM_TEST_MINUTES + 120,
+         test.smartIntercomGetChecks(), failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+/*
+ * smartintercom_store_test.cpp - Проверка журнала конфигурации SmartIntercom при обрыве записи
+ *
+ * Журнал SmartIntercomConfigStore пишется в симулированную флеш-память,
+ * питание пропадает посреди записи (запись обрывается на заданном
+ * байте, дальше флеш-память ничего не принимает), затем новый
+ * экземпляр журнала восстанавливается с той же памяти, как после
+ * перезагрузки. smartIntercomBegin()/smartIntercomLoad() должны вернуть
+ * последнюю целиком записанную конфигурацию:
+ *
+ *   - обрыв записи в каждом месте записи (заголовок, данные, CRC);
+ *   - обрыв заголовка нового сектора при переходе (магия без поколения,
+ *     пустой заголовок) и обрыв первой записи после целого заголовка;
+ *   - журнал в одном секторе (EEPROM ESP8266).
+ *
+ * После каждого восстановления журнал пишет новую запись, и следующая
+ * перезагрузка должна вернуть ее: оборванный слот не мешает работе.
+ *
+ * Использование:
+ *   smartintercom_store_test [--verbose]
+ *
+ * Код выхода 1, если хотя бы одна проверка не прошла.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SmartIntercom.h>
+#include "SmartIntercomSimBoard.h"
+#include "SmartIntercomSimFlash.h"
+
+// SmartIntercom Test Journal: заголовок и три записи на сектор
+#define SMARTINTERCOM_TEST_SECTOR_SIZE 128
+#define SMARTINTERCOM_TEST_RECORDS_PER_SECTOR \
+  ((SMARTINTERCOM_TEST_SECTOR_SIZE - SMARTINTERCOM_STORE_HEADER_SIZE) / SMARTINTERCOM_STORE_RECORD_SIZE)
+
+/*
+ * SmartIntercomPowerCutFlash - Флеш-память SmartIntercom с пропаданием питания
+ *
+ * После smartIntercomCutPower() пропускает writes записей целиком,
+ * обрывает следующую после bytes байт и дальше отказывает в записи и
+ * стирании, пока питание не вернут.
+ */
+class SmartIntercomPowerCutFlash : public SmartIntercomSimFlash {
+private:
+  bool smartIntercomArmed;
+  bool smartIntercomDead;
+  uint8_t smartIntercomWritesLeft;
+  long smartIntercomTearBytes;
+
+public:
+  SmartIntercomPowerCutFlash(uint16_t sectorCount)
+    : SmartIntercomSimFlash(sectorCount, SMARTINTERCOM_TEST_SECTOR_SIZE),
+      smartIntercomArmed(false),
+      smartIntercomDead(false),
+      smartIntercomWritesLeft(0),
+      smartIntercomTearBytes(0) {
+  }
+
+  void smartIntercomCutPower(uint8_t writes, long bytes) {
+    smartIntercomArmed = true;
+    smartIntercomWritesLeft = writes;
+    smartIntercomTearBytes = bytes;
+  }
+  void smartIntercomRestorePower() { smartIntercomArmed = smartIntercomDead = false; }
+  bool smartIntercomIsDead() { return smartIntercomDead; }
+
+  bool smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data, size_t length) override {
+    if (smartIntercomDead) {
+      return false;
+    }
+    if (smartIntercomArmed && smartIntercomWritesLeft-- == 0) {
+      smartIntercomTearNextWrite(smartIntercomTearBytes);
+      SmartIntercomSimFlash::smartIntercomWrite(sector, offset, data, length);
+      smartIntercomDead = true;
+      return false;
+    }
+    return SmartIntercomSimFlash::smartIntercomWrite(sector, offset, data, length);
+  }
+
+  bool smartIntercomErase(uint16_t sector) override {
+    return !smartIntercomDead && SmartIntercomSimFlash::smartIntercomErase(sector);
+  }
+};
+
+/*
+ * SmartIntercomStoreTest - Проверки журнала конфигурации SmartIntercom
+ */
+class SmartIntercomStoreTest {
+private:
+  bool smartIntercomVerbose;
+  unsigned long smartIntercomChecks;
+  unsigned long smartIntercomFailures;
+  unsigned long smartIntercomTears;
+
+  // SmartIntercom Check Helpers
+  void smartIntercomCheck(bool ok, const char* scope, const char* what);
+  static SmartIntercomConfig smartIntercomMakeConfig(int openTime);
+  bool smartIntercomSave(SmartIntercomConfigStore& store, int openTime);
+  void smartIntercomCheckReboot(SmartIntercomPowerCutFlash& flash, int expected, const char* scope);
+
+  // SmartIntercom Scenarios
+  void smartIntercomCheckRecordTear(uint16_t sectors, long bytes);
+  void smartIntercomCheckHeaderTear(uint8_t writes, long bytes, const char* what);
+
+public:
+  SmartIntercomStoreTest(bool verbose);
+
+  unsigned long smartIntercomRunAll();
+  unsigned long smartIntercomGetChecks() { return smartIntercomChecks; }
+  unsigned long smartIntercomGetTears() { return smartIntercomTears; }
+};
+
+/*
+ * SmartIntercomStoreTest Constructor
+ */
+SmartIntercomStoreTest::SmartIntercomStoreTest(bool verbose)
+  : smartIntercomVerbose(verbose), smartIntercomChecks(0), smartIntercomFailures(0), smartIntercomTears(0) {
+}
+
+/*
+ * SmartIntercomStoreTest Check
+ */
+void SmartIntercomStoreTest::smartIntercomCheck(bool ok, const char* scope, const char* what) {
+  smartIntercomChecks++;
+  if (!ok) {
+    smartIntercomFailures++;
+    printf("FAIL %s: %s\n", scope, what);
+  } else if (smartIntercomVerbose) {
+    printf("ok   %s: %s\n", scope, what);
+  }
+}
+
+/*
+ * SmartIntercomStoreTest Make Config
+ * Конфигурация SmartIntercom, узнаваемая по времени открытия
+ */
+SmartIntercomConfig SmartIntercomStoreTest::smartIntercomMakeConfig(int openTime) {
+  SmartIntercomConfig config;
+  memset(&config, 0, sizeof(config));
+  config.openTime = openTime;
+  config.debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  config.ringTimeout = 30000;
+  config.autoOpenEnabled = (openTime & 1) != 0;
+  config.gpioMode = SMARTINTERCOM_MODE_NORMAL;
+  return config;
+}
+
+/*
+ * SmartIntercomStoreTest Save
+ */
+bool SmartIntercomStoreTest::smartIntercomSave(SmartIntercomConfigStore& store, int openTime) {
+  store.smartIntercomRequestSave(smartIntercomMakeConfig(openTime));
+  return store.smartIntercomCommit();
+}
+
+/*
+ * SmartIntercomStoreTest Check Reboot
+ * Перезагрузка SmartIntercom: новый журнал с той же памяти должен
+ * вернуть expected, а затем сохранить и вернуть следующую запись
+ */
+void SmartIntercomStoreTest::smartIntercomCheckReboot(SmartIntercomPowerCutFlash& flash, int expected,
+                                                      const char* scope) {
+  flash.smartIntercomRestorePower();
+  SmartIntercomConfigStore store;
+  SmartIntercomConfig config = smartIntercomMakeConfig(-1);
+  bool begun = store.smartIntercomBegin(&flash);
+  bool loaded = store.smartIntercomLoad(&config);
+  smartIntercomCheck(begun && loaded, scope, "journal restored after the tear");
+  smartIntercomCheck(config.openTime == expected && config.autoOpenEnabled == ((expected & 1) != 0), scope,
+                     "last complete config restored");
+
+  int next = expected + 1;
+  smartIntercomCheck(smartIntercomSave(store, next), scope, "next save after the tear");
+  SmartIntercomConfigStore again;
+  config = smartIntercomMakeConfig(-1);
+  smartIntercomCheck(again.smartIntercomBegin(&flash) && again.smartIntercomLoad(&config) &&
+                     config.openTime == next, scope, "next save restored");
+}
+
+/*
+ * SmartIntercomStoreTest Check Record Tear
+ * Обрыв записи SmartIntercom посреди сектора после bytes байт
+ */
+void SmartIntercomStoreTest::smartIntercomCheckRecordTear(uint16_t sectors, long bytes) {
+  char scope[64];
+  snprintf(scope, sizeof(scope), "record tear at %ld, %u sector(s)", bytes, sectors);
+
+  SmartIntercomPowerCutFlash flash(sectors);
+  SmartIntercomConfigStore store;
+  smartIntercomCheck(!store.smartIntercomBegin(&flash), scope, "empty journal on blank flash");
+  smartIntercomCheck(smartIntercomSave(store, 1001), scope, "first save");
+  smartIntercomCheck(smartIntercomSave(store, 1002), scope, "second save");
+
+  smartIntercomTears++;
+  flash.smartIntercomCutPower(0, bytes);
+  smartIntercomCheck(!smartIntercomSave(store, 2000), scope, "torn save reports failure");
+  smartIntercomCheck(flash.smartIntercomIsDead(), scope, "power cut during the record write");
+  smartIntercomCheckReboot(flash, 1002, scope);
+}
+
+/*
+ * SmartIntercomStoreTest Check Header Tear
+ * Обрыв SmartIntercom при переходе в новый сектор: writes записей
+ * проходят (0 - обрывается заголовок, 1 - первая запись), следующая
+ * обрывается после bytes байт
+ */
+void SmartIntercomStoreTest::smartIntercomCheckHeaderTear(uint8_t writes, long bytes, const char* what) {
+  char scope[64];
+  snprintf(scope, sizeof(scope), "sector rollover, %s", what);
+
+  SmartIntercomPowerCutFlash flash(2);
+  SmartIntercomConfigStore store;
+  store.smartIntercomBegin(&flash);
+  int last = 0;
+  for (int i = 1; i <= SMARTINTERCOM_TEST_RECORDS_PER_SECTOR; i++) {
+    last = 3000 + i;
+    smartIntercomCheck(smartIntercomSave(store, last), scope, "first sector filled");
+  }
+  smartIntercomCheck(flash.smartIntercomGetEraseCount(1) == 0, scope, "second sector untouched");
+
+  smartIntercomTears++;
+  flash.smartIntercomCutPower(writes, bytes);
+  smartIntercomCheck(!smartIntercomSave(store, 4000), scope, "torn save reports failure");
+  smartIntercomCheck(flash.smartIntercomIsDead() && flash.smartIntercomGetEraseCount(1) == 1, scope,
+                     "power cut after the second sector was erased");
+  smartIntercomCheckReboot(flash, last, scope);
+}
+
+/*
+ * SmartIntercomStoreTest Run All
+ */
+unsigned long SmartIntercomStoreTest::smartIntercomRunAll() {
+  static const long smartIntercomTearPoints[] = { 0, 4, 12, 28 };
+  for (size_t i = 0; i < sizeof(smartIntercomTearPoints) / sizeof(smartIntercomTearPoints[0]); i++) {
+    smartIntercomCheckRecordTear(2, smartIntercomTearPoints[i]);
+    smartIntercomCheckRecordTear(1, smartIntercomTearPoints[i]);
+  }
+  smartIntercomCheckHeaderTear(0, 0, "blank header");
+  smartIntercomCheckHeaderTear(0, 4, "magic without generation");
+  smartIntercomCheckHeaderTear(1, 12, "header without records");
+  return smartIntercomFailures;
+}
+
+int main(int argc, char** argv) {
+  bool verbose = argc > 1 && strcmp(argv[1], "--verbose") == 0;
+
+  SmartIntercomSimBoard board;
+  smartIntercomSetHAL(&board);
+  Serial.smartIntercomSetEnabled(false);
+
+  SmartIntercomStoreTest test(verbose);
+  unsigned long failures = test.smartIntercomRunAll();
+  printf("SmartIntercomConfigStore tears: %lu, checks: %lu, failures: %lu\n", test.smartIntercomGetTears(),
+         test.smartIntercomGetChecks(), failures);
+  return failures == 0 ? 0 : 1;
+}
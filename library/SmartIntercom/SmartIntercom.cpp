@@ -9,11 +9,15 @@
  */
 
 #include "SmartIntercom.h"
+#include <new>
 
 // ============================================================================
 // SmartIntercomGPIO Implementation
 // ============================================================================
 
+// SmartIntercom Runtime pin sequences (declared extern in SmartIntercom.h)
+template class SmartIntercomGPIOSequence<SmartIntercomGPIOPin>;
+
 /*
  * SmartIntercomGPIO Constructor
  * Инициализирует пин SmartIntercom с заданным режимом
@@ -22,254 +26,252 @@ SmartIntercomGPIO::SmartIntercomGPIO(int pin, SmartIntercomGPIOMode mode, bool i
   smartIntercomPin = pin;
   smartIntercomMode = mode;
   smartIntercomInverted = inverted;
-  smartIntercomCurrentState = false;
-  smartIntercomLastToggle = 0;
   smartIntercomDebounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
 }
 
 /*
- * SmartIntercomGPIO Begin
- * Инициализация пина SmartIntercom
- */
-void SmartIntercomGPIO::smartIntercomBegin() {
-  pinMode(smartIntercomPin, OUTPUT);
-  smartIntercomWritePin(false);
-  Serial.print("SmartIntercom: GPIO ");
-  Serial.print(smartIntercomPin);
-  Serial.println(" initialized");
-}
-
-/*
- * SmartIntercomGPIO Check Debounce
- * Проверка антидребезга для SmartIntercom
+ * SmartIntercomGPIO Read Analog
+ * Чтение аналогового значения для SmartIntercom
  */
-bool SmartIntercomGPIO::smartIntercomCheckDebounce() {
-  unsigned long currentTime = millis();
-  if (currentTime - smartIntercomLastToggle < smartIntercomDebounceTime) {
-    return false;
-  }
-  smartIntercomLastToggle = currentTime;
-  return true;
+int SmartIntercomGPIO::smartIntercomReadAnalog() {
+  return smartIntercomAnalogRead(smartIntercomPin);
 }
 
 /*
- * SmartIntercomGPIO Write Pin
- * Запись состояния в пин SmartIntercom
+ * SmartIntercomGPIO Set Debounce
+ * Установить время антидребезга для SmartIntercom
  */
-void SmartIntercomGPIO::smartIntercomWritePin(bool state) {
-  bool actualState = smartIntercomInverted ? !state : state;
-  digitalWrite(smartIntercomPin, actualState ? HIGH : LOW);
-  smartIntercomCurrentState = state;
+void SmartIntercomGPIO::smartIntercomSetDebounce(int ms) {
+  smartIntercomDebounceTime = ms;
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Debounce set to %d ms", ms);
 }
 
 /*
- * SmartIntercomGPIO Set High
- * Установить HIGH на пине SmartIntercom
+ * SmartIntercomGPIO Set Mode
+ * Установить режим работы GPIO SmartIntercom
  */
-void SmartIntercomGPIO::smartIntercomSetHigh() {
-  smartIntercomSetState(true);
+void SmartIntercomGPIO::smartIntercomSetMode(SmartIntercomGPIOMode mode) {
+  smartIntercomMode = mode;
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: GPIO mode changed to %d", mode);
 }
 
-/*
- * SmartIntercomGPIO Set Low
- * Установить LOW на пине SmartIntercom
- */
-void SmartIntercomGPIO::smartIntercomSetLow() {
-  smartIntercomSetState(false);
-}
+// ============================================================================
+// SmartIntercomRing Implementation
+// ============================================================================
 
 /*
- * SmartIntercomGPIO Set State
- * Установить состояние пина SmartIntercom
+ * SmartIntercomRing Constructor
+ * Инициализация детектора звонка SmartIntercom
  */
-void SmartIntercomGPIO::smartIntercomSetState(bool state) {
-  if (smartIntercomCheckDebounce()) {
-    smartIntercomWritePin(state);
-    Serial.print("SmartIntercom: GPIO ");
-    Serial.print(smartIntercomPin);
-    Serial.print(" set to ");
-    Serial.println(state ? "HIGH" : "LOW");
-  }
+SmartIntercomRing::SmartIntercomRing(int pin, int threshold)
+    : smartIntercomDetector(pin, SMARTINTERCOM_MODE_NORMAL) {
+  smartIntercomThreshold = threshold;
+  smartIntercomRinging = false;
+  smartIntercomRingStart = 0;
+  smartIntercomRingEnd = 0;
+  smartIntercomRingCount = 0;
+  smartIntercomSamplePeriodUs = SMARTINTERCOM_RING_SAMPLE_PERIOD_US;
+  smartIntercomSampling = false;
+  smartIntercomPauseDepth = 0;
+  smartIntercomWakeCenter = 0;
+  smartIntercomWakeSpan = 0;
+  smartIntercomToneHz = SMARTINTERCOM_RING_TONE_HZ;
+  smartIntercomTrace = nullptr;
+  smartIntercomClassifier.smartIntercomSetLevels(threshold,
+                                                 threshold * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100);
+  smartIntercomPinMode(pin, INPUT);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring detector initialized");
 }
 
 /*
- * SmartIntercomGPIO Toggle
- * Переключить состояние пина SmartIntercom
+ * SmartIntercomRing Destructor
+ * Прерывание выборки SmartIntercom держит указатель на детектор
  */
-void SmartIntercomGPIO::smartIntercomToggle() {
-  smartIntercomSetState(!smartIntercomCurrentState);
+SmartIntercomRing::~SmartIntercomRing() {
+  smartIntercomEndSampling();
 }
 
 /*
- * SmartIntercomGPIO Pulse
- * Создать импульс на пине SmartIntercom
+ * SmartIntercomRing Process Sample
+ * Обработка одного отсчета АЦП SmartIntercom с моментом его захвата
  */
-void SmartIntercomGPIO::smartIntercomPulse(unsigned long duration) {
-  smartIntercomSetHigh();
-  delay(duration);
-  smartIntercomSetLow();
-  Serial.print("SmartIntercom: GPIO ");
-  Serial.print(smartIntercomPin);
-  Serial.print(" pulsed for ");
-  Serial.print(duration);
-  Serial.println(" ms");
-}
+bool SmartIntercomRing::smartIntercomProcessSample(int value, unsigned long timeMs) {
+  SmartIntercomRingEvent event = smartIntercomClassifier.smartIntercomProcess(value, timeMs);
 
-/*
- * SmartIntercomGPIO Pulse Pattern
- * Создать паттерн импульсов для SmartIntercom
- */
-void SmartIntercomGPIO::smartIntercomPulsePattern(int* pattern, int length) {
-  for (int i = 0; i < length; i++) {
-    if (i % 2 == 0) {
-      smartIntercomSetHigh();
-    } else {
-      smartIntercomSetLow();
-    }
-    delay(pattern[i]);
+  if (event == SMARTINTERCOM_RING_EVENT_START) {
+    smartIntercomRinging = true;
+    smartIntercomRingStart = smartIntercomClassifier.smartIntercomGetEdgeTime();
+    smartIntercomRingCount++;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring detected! Count: %d", smartIntercomRingCount);
+    return true;
+  } else if (event == SMARTINTERCOM_RING_EVENT_END) {
+    smartIntercomRinging = false;
+    smartIntercomRingEnd = smartIntercomClassifier.smartIntercomGetEdgeTime();
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring ended");
   }
-  smartIntercomSetLow();
-  Serial.println("SmartIntercom: Pulse pattern completed");
+
+  return false;
 }
 
 /*
- * SmartIntercomGPIO Set PWM
- * Установить PWM значение для SmartIntercom
+ * SmartIntercomRing Check
+ * Проверка звонка для SmartIntercom
+ *
+ * В режиме выборки по таймеру обрабатывает пачками все отсчеты,
+ * накопленные с прошлого вызова, иначе читает АЦП один раз.
  */
-void SmartIntercomGPIO::smartIntercomSetPWM(int value) {
-  if (smartIntercomMode == SMARTINTERCOM_MODE_PWM) {
-    analogWrite(smartIntercomPin, value);
-    Serial.print("SmartIntercom: PWM set to ");
-    Serial.println(value);
+bool SmartIntercomRing::smartIntercomCheck() {
+  if (!smartIntercomSampling) {
+    int value = smartIntercomDetector.smartIntercomReadAnalog();
+    if (smartIntercomTrace != nullptr) {
+      smartIntercomTrace->smartIntercomRecord((uint16_t)value, smartIntercomMicros(), 0);
+    }
+    return smartIntercomProcessSample(value, smartIntercomMillis());
   }
-}
 
-/*
- * SmartIntercomGPIO Fade
- * Плавное изменение яркости для SmartIntercom LED
- */
-void SmartIntercomGPIO::smartIntercomFade(int from, int to, unsigned long duration) {
-  int steps = 50;
-  int stepDelay = duration / steps;
-  int stepSize = (to - from) / steps;
-  int current = from;
+  uint16_t batch[SMARTINTERCOM_RING_BATCH_SIZE];
+  unsigned long nowUs = smartIntercomMicros();
+  uint16_t pending = smartIntercomSamples.smartIntercomAvailable();
+  uint16_t processed = 0;
+  bool ringStarted = false;
 
-  for (int i = 0; i < steps; i++) {
-    current += stepSize;
-    smartIntercomSetPWM(current);
-    delay(stepDelay);
+  // SmartIntercom Drain at most one buffer's worth so a fast producer cannot starve the loop
+  while (processed < SMARTINTERCOM_SAMPLE_BUFFER_SIZE) {
+    uint16_t count = smartIntercomSamples.smartIntercomPopBatch(batch, SMARTINTERCOM_RING_BATCH_SIZE);
+    if (count == 0) {
+      break;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      // SmartIntercom The newest pending sample was taken just before nowUs
+      uint16_t age = processed < pending ? pending - 1 - processed : 0;
+      unsigned long sampleUs = nowUs - (unsigned long)age * smartIntercomSamplePeriodUs;
+      if (smartIntercomTrace != nullptr) {
+        smartIntercomTrace->smartIntercomRecord(batch[i], sampleUs, smartIntercomSamplePeriodUs);
+      }
+      if (smartIntercomProcessSample(batch[i], sampleUs / 1000)) {
+        ringStarted = true;
+      }
+      processed++;
+    }
   }
-  smartIntercomSetPWM(to);
-  Serial.print("SmartIntercom: Faded from ");
-  Serial.print(from);
-  Serial.print(" to ");
-  Serial.println(to);
+
+  smartIntercomPublishWake();
+  return ringStarted;
 }
 
 /*
- * SmartIntercomGPIO Blink
- * Мигание светодиода SmartIntercom
+ * SmartIntercomRing Publish Wake
+ * Уровни пробуждения главного цикла SmartIntercom для прерывания выборки
+ *
+ * Пока звонка нет, отсчет, отклонившийся от базовой линии на порог
+ * выключения, будит цикл сразу: начало звонка обрабатывается без
+ * ожидания заполнения буфера. Во время звонка (конец звонка не срочен)
+ * цикл просыпается только по заполнению.
  */
-void SmartIntercomGPIO::smartIntercomBlink(int times, int onTime, int offTime) {
-  for (int i = 0; i < times; i++) {
-    smartIntercomSetHigh();
-    delay(onTime);
-    smartIntercomSetLow();
-    if (i < times - 1) {
-      delay(offTime);
-    }
+void SmartIntercomRing::smartIntercomPublishWake() {
+  uint16_t span = 0;
+  if (!smartIntercomRinging) {
+    span = (uint16_t)(smartIntercomThreshold * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100);
   }
-  Serial.print("SmartIntercom: Blinked ");
-  Serial.print(times);
-  Serial.println(" times");
+  smartIntercomWakeSpan = 0;
+  SMARTINTERCOM_COMPILER_BARRIER();
+  smartIntercomWakeCenter = (int16_t)smartIntercomClassifier.smartIntercomGetBaseline();
+  SMARTINTERCOM_COMPILER_BARRIER();
+  smartIntercomWakeSpan = span;
 }
 
 /*
- * SmartIntercomGPIO Blink Pattern
- * Паттерн мигания для SmartIntercom
+ * SmartIntercomRing Sample Tick
+ * Прерывание таймера SmartIntercom: один отсчет АЦП в буфер
  */
-void SmartIntercomGPIO::smartIntercomBlinkPattern(int* pattern, int length) {
-  smartIntercomPulsePattern(pattern, length);
+void IRAM_ATTR SmartIntercomRing::smartIntercomSampleTick(void* context) {
+  SmartIntercomRing* ring = static_cast<SmartIntercomRing*>(context);
+  int sample = ring->smartIntercomDetector.smartIntercomReadAnalog();
+  ring->smartIntercomSamples.smartIntercomPush((uint16_t)sample);
+
+  // SmartIntercom Wake the loop on a possible ring edge or when the buffer is half full
+  int deviation = sample - ring->smartIntercomWakeCenter;
+  uint16_t span = ring->smartIntercomWakeSpan;
+  if (ring->smartIntercomSamples.smartIntercomAvailable() >= SMARTINTERCOM_RING_WAKE_SAMPLES ||
+      (span > 0 && (deviation < 0 ? -deviation : deviation) >= span)) {
+    smartIntercomWake();
+  }
 }
 
 /*
- * SmartIntercomGPIO Get State
- * Получить текущее состояние пина SmartIntercom
+ * SmartIntercomRing Begin Sampling
+ * Включить выборку АЦП SmartIntercom по таймеру с периодом periodUs
+ *
+ * Возвращает false, если HAL не поддерживает таймер; тогда
+ * детектор продолжает читать АЦП из главного цикла.
  */
-bool SmartIntercomGPIO::smartIntercomGetState() {
-  return smartIntercomCurrentState;
+bool SmartIntercomRing::smartIntercomBeginSampling(unsigned long periodUs) {
+  smartIntercomEndSampling();
+  smartIntercomSamplePeriodUs = periodUs;
+  smartIntercomSamples.smartIntercomClear();
+  smartIntercomWakeSpan = 0;
+  smartIntercomSampling = smartIntercomStartTimer(periodUs, smartIntercomSampleTick, this);
+  smartIntercomClassifier.smartIntercomSetTone(smartIntercomSampling ? periodUs : 0, smartIntercomToneHz);
+  if (smartIntercomSampling) {
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring sampling every %lu us", periodUs);
+  } else {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Ring sampling unavailable, polling from loop");
+  }
+  return smartIntercomSampling;
 }
 
 /*
- * SmartIntercomGPIO Read Analog
- * Чтение аналогового значения для SmartIntercom
+ * SmartIntercomRing End Sampling
+ * Вернуть детектор SmartIntercom к чтению АЦП из главного цикла
  */
-int SmartIntercomGPIO::smartIntercomReadAnalog() {
-  return analogRead(smartIntercomPin);
+void SmartIntercomRing::smartIntercomEndSampling() {
+  if (smartIntercomSampling) {
+    smartIntercomStopTimer();
+    smartIntercomSampling = false;
+    smartIntercomClassifier.smartIntercomSetTone(0, smartIntercomToneHz);
+  }
 }
 
 /*
- * SmartIntercomGPIO Set Debounce
- * Установить время антидребезга для SmartIntercom
+ * SmartIntercomRing Pause Sampling
+ * Остановить таймер выборки SmartIntercom на время записи во флеш
+ *
+ * На ESP8266 стирание и запись флеш-памяти отключают кэш инструкций,
+ * поэтому прерывание выборки не должно срабатывать в это время.
+ * Классификатор и накопленные отсчеты не сбрасываются. Паузы
+ * вкладываются: таймер запускается последним smartIntercomResumeSampling().
  */
-void SmartIntercomGPIO::smartIntercomSetDebounce(int ms) {
-  smartIntercomDebounceTime = ms;
-  Serial.print("SmartIntercom: Debounce set to ");
-  Serial.print(ms);
-  Serial.println(" ms");
+void SmartIntercomRing::smartIntercomPauseSampling() {
+  if (smartIntercomPauseDepth++ == 0 && smartIntercomSampling) {
+    smartIntercomStopTimer();
+  }
 }
 
 /*
- * SmartIntercomGPIO Set Mode
- * Установить режим работы GPIO SmartIntercom
+ * SmartIntercomRing Resume Sampling
  */
-void SmartIntercomGPIO::smartIntercomSetMode(SmartIntercomGPIOMode mode) {
-  smartIntercomMode = mode;
-  Serial.print("SmartIntercom: GPIO mode changed to ");
-  Serial.println(mode);
+void SmartIntercomRing::smartIntercomResumeSampling() {
+  if (smartIntercomPauseDepth == 0) {
+    return;
+  }
+  if (--smartIntercomPauseDepth == 0 && smartIntercomSampling) {
+    smartIntercomSampling = smartIntercomStartTimer(smartIntercomSamplePeriodUs, smartIntercomSampleTick, this);
+  }
 }
 
-// ============================================================================
-// SmartIntercomRing Implementation
-// ============================================================================
-
 /*
- * SmartIntercomRing Constructor
- * Инициализация детектора звонка SmartIntercom
+ * SmartIntercomRing Is Sampling
  */
-SmartIntercomRing::SmartIntercomRing(int pin, int threshold) {
-  smartIntercomDetector = new SmartIntercomGPIO(pin, SMARTINTERCOM_MODE_NORMAL);
-  smartIntercomThreshold = threshold;
-  smartIntercomRinging = false;
-  smartIntercomRingStart = 0;
-  smartIntercomRingEnd = 0;
-  smartIntercomRingCount = 0;
-  pinMode(pin, INPUT);
-  Serial.println("SmartIntercom: Ring detector initialized");
+bool SmartIntercomRing::smartIntercomIsSampling() {
+  return smartIntercomSampling;
 }
 
 /*
- * SmartIntercomRing Check
- * Проверка звонка для SmartIntercom
+ * SmartIntercomRing Get Dropped Samples
+ * Число отсчетов SmartIntercom, потерянных из-за переполнения буфера
  */
-bool SmartIntercomRing::smartIntercomCheck() {
-  int value = smartIntercomDetector->smartIntercomReadAnalog();
-  bool currentlyRinging = value > smartIntercomThreshold;
-
-  if (currentlyRinging && !smartIntercomRinging) {
-    smartIntercomRinging = true;
-    smartIntercomRingStart = millis();
-    smartIntercomRingCount++;
-    Serial.print("SmartIntercom: Ring detected! Count: ");
-    Serial.println(smartIntercomRingCount);
-    return true;
-  } else if (!currentlyRinging && smartIntercomRinging) {
-    smartIntercomRinging = false;
-    smartIntercomRingEnd = millis();
-    Serial.println("SmartIntercom: Ring ended");
-  }
-
-  return false;
+uint32_t SmartIntercomRing::smartIntercomGetDroppedSamples() {
+  return smartIntercomSamples.smartIntercomGetDropped();
 }
 
 /*
@@ -286,7 +288,7 @@ bool SmartIntercomRing::smartIntercomIsRinging() {
  */
 unsigned long SmartIntercomRing::smartIntercomGetDuration() {
   if (smartIntercomRinging) {
-    return millis() - smartIntercomRingStart;
+    return smartIntercomMillis() - smartIntercomRingStart;
   } else if (smartIntercomRingEnd > smartIntercomRingStart) {
     return smartIntercomRingEnd - smartIntercomRingStart;
   }
@@ -310,17 +312,45 @@ void SmartIntercomRing::smartIntercomReset() {
   smartIntercomRinging = false;
   smartIntercomRingStart = 0;
   smartIntercomRingEnd = 0;
-  Serial.println("SmartIntercom: Ring detector reset");
+  smartIntercomClassifier.smartIntercomReset();
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring detector reset");
 }
 
 /*
  * SmartIntercomRing Set Threshold
  * Установить порог срабатывания для SmartIntercom
+ *
+ * Порог задается для огибающей отклонения сигнала от базовой линии
+ * (отсчеты АЦП); порог отпускания - SMARTINTERCOM_RING_HYSTERESIS_PERCENT от него.
  */
 void SmartIntercomRing::smartIntercomSetThreshold(int threshold) {
   smartIntercomThreshold = threshold;
-  Serial.print("SmartIntercom: Ring threshold set to ");
-  Serial.println(threshold);
+  smartIntercomClassifier.smartIntercomSetLevels(threshold,
+                                                 threshold * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100);
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Ring threshold set to %d", threshold);
+}
+
+/*
+ * SmartIntercomRing Set Tone Frequency
+ * Частота тона звонка SmartIntercom для фильтра Гёрцеля (0 - отключить)
+ *
+ * Проверка тона действует только при выборке АЦП по таймеру.
+ */
+void SmartIntercomRing::smartIntercomSetToneFrequency(unsigned int toneHz) {
+  smartIntercomToneHz = toneHz;
+  smartIntercomClassifier.smartIntercomSetTone(smartIntercomSampling ? smartIntercomSamplePeriodUs : 0, toneHz);
+}
+
+/*
+ * SmartIntercomRing Diagnostics
+ * Текущая огибающая и доля тона в последнем блоке SmartIntercom
+ */
+int SmartIntercomRing::smartIntercomGetEnvelope() {
+  return smartIntercomClassifier.smartIntercomGetEnvelope();
+}
+
+int SmartIntercomRing::smartIntercomGetTonePercent() {
+  return smartIntercomClassifier.smartIntercomGetTonePercent();
 }
 
 // ============================================================================
@@ -331,25 +361,49 @@ void SmartIntercomRing::smartIntercomSetThreshold(int threshold) {
  * SmartIntercomDoor Constructor
  * Инициализация контроллера двери SmartIntercom
  */
-SmartIntercomDoor::SmartIntercomDoor(int pin, int openTime) {
-  smartIntercomOpenRelay = new SmartIntercomGPIO(pin, SMARTINTERCOM_MODE_PULSE);
-  smartIntercomOpenRelay->smartIntercomBegin();
+SmartIntercomDoor::SmartIntercomDoor(int pin, int openTime)
+    : smartIntercomOpenRelay(pin, SMARTINTERCOM_MODE_PULSE) {
+  smartIntercomOpenRelay.smartIntercomBegin();
   smartIntercomOpenTime = openTime;
   smartIntercomIsOpen = false;
   smartIntercomOpenStart = 0;
-  Serial.println("SmartIntercom: Door controller initialized");
+  smartIntercomDelayedJob = SMARTINTERCOM_JOB_NONE;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Door controller initialized");
+}
+
+/*
+ * SmartIntercomDoor Destructor
+ * Отменить отложенное открытие SmartIntercom (задача держит указатель на дверь)
+ */
+SmartIntercomDoor::~SmartIntercomDoor() {
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomDelayedJob);
 }
 
 /*
  * SmartIntercomDoor Open
  * Открыть дверь SmartIntercom
+ *
+ * Реле удерживается планировщиком, метод возвращается сразу.
  */
 void SmartIntercomDoor::smartIntercomOpen() {
-  Serial.println("SmartIntercom: Opening door...");
-  smartIntercomOpenRelay->smartIntercomPulse(smartIntercomOpenTime);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Opening door...");
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomDelayedJob);
+  smartIntercomDelayedJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomOpenRelay.smartIntercomPulse(smartIntercomOpenTime);
   smartIntercomIsOpen = true;
-  smartIntercomOpenStart = millis();
-  Serial.println("SmartIntercom: Door opened");
+  smartIntercomOpenStart = smartIntercomMillis();
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Door opened");
+}
+
+/*
+ * SmartIntercomDoor Delayed Open Step
+ * Задача планировщика для отложенного открытия SmartIntercom
+ */
+long SmartIntercomDoor::smartIntercomDelayedOpenStep(void* context, int step) {
+  SmartIntercomDoor* door = static_cast<SmartIntercomDoor*>(context);
+  door->smartIntercomDelayedJob = SMARTINTERCOM_JOB_NONE;
+  door->smartIntercomOpen();
+  return SMARTINTERCOM_JOB_DONE;
 }
 
 /*
@@ -357,20 +411,23 @@ void SmartIntercomDoor::smartIntercomOpen() {
  * Открыть дверь SmartIntercom с задержкой
  */
 void SmartIntercomDoor::smartIntercomOpenDelayed(int delay) {
-  Serial.print("SmartIntercom: Opening door with delay ");
-  Serial.print(delay);
-  Serial.println(" ms");
-  ::delay(delay);
-  smartIntercomOpen();
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Opening door with delay %d ms", delay);
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomDelayedJob);
+  smartIntercomDelayedJob = smartIntercomScheduler.smartIntercomSchedule(
+    delay, smartIntercomDelayedOpenStep, this);
 }
 
 /*
  * SmartIntercomDoor Close
  * Закрыть дверь SmartIntercom
+ *
+ * Отменяет отложенное открытие, если оно еще не выполнено.
  */
 void SmartIntercomDoor::smartIntercomClose() {
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomDelayedJob);
+  smartIntercomDelayedJob = SMARTINTERCOM_JOB_NONE;
   smartIntercomIsOpen = false;
-  Serial.println("SmartIntercom: Door closed");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Door closed");
 }
 
 /*
@@ -379,21 +436,27 @@ void SmartIntercomDoor::smartIntercomClose() {
  */
 bool SmartIntercomDoor::smartIntercomCheckState() {
   if (smartIntercomIsOpen &&
-      (millis() - smartIntercomOpenStart > smartIntercomOpenTime + 1000)) {
+      (smartIntercomMillis() - smartIntercomOpenStart > (unsigned long)smartIntercomOpenTime + 1000)) {
     smartIntercomClose();
   }
   return smartIntercomIsOpen;
 }
 
+/*
+ * SmartIntercomDoor Is Relay Active
+ * Проверка, удерживается ли реле двери SmartIntercom
+ */
+bool SmartIntercomDoor::smartIntercomIsRelayActive() {
+  return smartIntercomOpenRelay.smartIntercomIsSequenceRunning();
+}
+
 /*
  * SmartIntercomDoor Set Open Time
  * Установить время открытия для SmartIntercom
  */
 void SmartIntercomDoor::smartIntercomSetOpenTime(int ms) {
   smartIntercomOpenTime = ms;
-  Serial.print("SmartIntercom: Door open time set to ");
-  Serial.print(ms);
-  Serial.println(" ms");
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Door open time set to %d ms", ms);
 }
 
 /*
@@ -404,6 +467,22 @@ int SmartIntercomDoor::smartIntercomGetOpenTime() {
   return smartIntercomOpenTime;
 }
 
+// ============================================================================
+// SmartIntercomOutputs Implementation
+// ============================================================================
+
+/*
+ * SmartIntercomOutputs Constructor
+ * Построение и инициализация выходов SmartIntercom по конфигурации
+ */
+SmartIntercomOutputs::SmartIntercomOutputs(const SmartIntercomConfig& config)
+    : smartIntercomDoor(config.doorOpenPin, config.openTime),
+      smartIntercomLED(config.ledPin, SMARTINTERCOM_MODE_PWM),
+      smartIntercomHandset(config.handsetPin) {
+  smartIntercomLED.smartIntercomBegin();
+  smartIntercomHandset.smartIntercomBegin();
+}
+
 // ============================================================================
 // SmartIntercom Main Class Implementation
 // ============================================================================
@@ -415,13 +494,108 @@ int SmartIntercomDoor::smartIntercomGetOpenTime() {
 SmartIntercom::SmartIntercom() {
   smartIntercomState = SMARTINTERCOM_STATE_INIT;
   smartIntercomRingDetector = nullptr;
-  smartIntercomDoorController = nullptr;
-  smartIntercomLED = nullptr;
-  smartIntercomHandset = nullptr;
+  smartIntercomOutputs = nullptr;
   smartIntercomEventCallback = nullptr;
-  smartIntercomLastUpdate = 0;
+  smartIntercomCallbackSubscriber = SMARTINTERCOM_EVENT_NO_SUBSCRIBER;
+  smartIntercomConfigStore = nullptr;
+  smartIntercomStats = nullptr;
+  smartIntercomMetrics = nullptr;
+  smartIntercomLastUpdateUs = 0;
+  smartIntercomStateDeadline = 0;
+  smartIntercomStateArmed = false;
+  smartIntercomRingEdge = 0;
+  smartIntercomAwaitingOpen = false;
+  smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomInitialized = false;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Main class instantiated");
+}
+
+/*
+ * SmartIntercom Destructor
+ */
+SmartIntercom::~SmartIntercom() {
+  smartIntercomReleaseComponents();
+}
+
+/*
+ * SmartIntercom Release Components
+ * Разобрать компоненты SmartIntercom, построенные smartIntercomBegin()
+ *
+ * Деструкторы снимают задачи планировщика и таймер выборки, которые
+ * указывают на компоненты, поэтому хранилище можно строить заново.
+ */
+void SmartIntercom::smartIntercomReleaseComponents() {
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomPendingOpenJob);
+  smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  if (smartIntercomRingDetector != nullptr) {
+    smartIntercomRingDetector->~SmartIntercomRing();
+    smartIntercomRingDetector = nullptr;
+  }
+  smartIntercomReleaseOutputs();
   smartIntercomInitialized = false;
-  Serial.println("SmartIntercom: Main class instantiated");
+}
+
+/*
+ * SmartIntercom Begin Outputs
+ * Построить дверь, LED и трубку SmartIntercom в хранилище выходов
+ */
+void SmartIntercom::smartIntercomBeginOutputs(const SmartIntercomConfig& config) {
+  smartIntercomOutputs = new (smartIntercomOutputStorage) SmartIntercomOutputs(config);
+}
+
+/*
+ * SmartIntercom Release Outputs
+ * Разобрать выходы SmartIntercom, построенные smartIntercomBeginOutputs()
+ */
+void SmartIntercom::smartIntercomReleaseOutputs() {
+  if (smartIntercomOutputs != nullptr) {
+    smartIntercomOutputs->~SmartIntercomOutputs();
+    smartIntercomOutputs = nullptr;
+  }
+}
+
+/*
+ * SmartIntercom Output Hooks
+ * Доступ к выходам SmartIntercom, построенным по конфигурации
+ */
+void SmartIntercom::smartIntercomDoorOpen() {
+  smartIntercomOutputs->smartIntercomDoor.smartIntercomOpen();
+}
+
+void SmartIntercom::smartIntercomDoorClose() {
+  smartIntercomOutputs->smartIntercomDoor.smartIntercomClose();
+}
+
+bool SmartIntercom::smartIntercomDoorCheck() {
+  return smartIntercomOutputs->smartIntercomDoor.smartIntercomCheckState();
+}
+
+int SmartIntercom::smartIntercomDoorGetOpenTime() {
+  return smartIntercomOutputs->smartIntercomDoor.smartIntercomGetOpenTime();
+}
+
+void SmartIntercom::smartIntercomDoorSetOpenTime(int ms) {
+  smartIntercomOutputs->smartIntercomDoor.smartIntercomSetOpenTime(ms);
+}
+
+void SmartIntercom::smartIntercomLEDWrite(bool state) {
+  smartIntercomOutputs->smartIntercomLED.smartIntercomSetState(state);
+}
+
+void SmartIntercom::smartIntercomLEDStartBlink(int times) {
+  smartIntercomOutputs->smartIntercomLED.smartIntercomBlink(times, 200, 200);
+}
+
+void SmartIntercom::smartIntercomLEDWritePWM(int value) {
+  smartIntercomOutputs->smartIntercomLED.smartIntercomSetPWM(value);
+}
+
+void SmartIntercom::smartIntercomHandsetWrite(bool state) {
+  smartIntercomOutputs->smartIntercomHandset.smartIntercomSetState(state);
+}
+
+void SmartIntercom::smartIntercomHandsetFlip() {
+  smartIntercomOutputs->smartIntercomHandset.smartIntercomToggle();
 }
 
 /*
@@ -429,33 +603,22 @@ SmartIntercom::SmartIntercom() {
  * Инициализация SmartIntercom с конфигурацией
  */
 void SmartIntercom::smartIntercomBegin(SmartIntercomConfig config) {
-  Serial.println("==================================");
-  Serial.println("SmartIntercom Premium Starting...");
-  Serial.println("==================================");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom Premium Starting...");
 
+  // SmartIntercom Repeated begin rebuilds the components in the same storage
+  smartIntercomReleaseComponents();
   smartIntercomConfiguration = config;
 
   // SmartIntercom Initialize Ring Detector
-  smartIntercomRingDetector = new SmartIntercomRing(config.doorbellPin);
+  smartIntercomRingDetector = new (smartIntercomRingStorage) SmartIntercomRing(config.doorbellPin);
 
-  // SmartIntercom Initialize Door Controller
-  smartIntercomDoorController = new SmartIntercomDoor(config.doorOpenPin, config.openTime);
+  // SmartIntercom Initialize Door Controller, LED and Handset
+  smartIntercomBeginOutputs(config);
 
-  // SmartIntercom Initialize LED
-  smartIntercomLED = new SmartIntercomGPIO(config.ledPin, SMARTINTERCOM_MODE_PWM);
-  smartIntercomLED->smartIntercomBegin();
-
-  // SmartIntercom Initialize Handset
-  smartIntercomHandset = new SmartIntercomGPIO(config.handsetPin);
-  smartIntercomHandset->smartIntercomBegin();
-
-  smartIntercomState = SMARTINTERCOM_STATE_READY;
+  smartIntercomDispatchInput(SMARTINTERCOM_INPUT_BEGIN);
   smartIntercomInitialized = true;
 
-  Serial.println("SmartIntercom: Initialization complete!");
-  Serial.print("SmartIntercom Version: ");
-  Serial.println(SMARTINTERCOM_LIB_VERSION);
-  Serial.println("==================================\n");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Initialization complete! Version: %s", SMARTINTERCOM_LIB_VERSION);
 
   // SmartIntercom Startup Indication
   smartIntercomLEDBlink(3);
@@ -488,6 +651,20 @@ void SmartIntercom::smartIntercomBeginDefault(int doorbellPin, int doorOpenPin)
  */
 void SmartIntercom::smartIntercomUpdate() {
   if (!smartIntercomInitialized) return;
+  uint8_t phase = smartIntercomMarkPhase(SMARTINTERCOM_PHASE_UPDATE);
+
+  // SmartIntercom Loop period (time since the previous pass)
+  if (smartIntercomMetrics) {
+    unsigned long nowUs = smartIntercomMicros();
+    smartIntercomMetrics->smartIntercomRecord(SMARTINTERCOM_METRIC_LOOP_PERIOD, nowUs - smartIntercomLastUpdateUs);
+    smartIntercomLastUpdateUs = nowUs;
+  }
+
+  // SmartIntercom Outputs changed by this pass are committed together
+  smartIntercomOutputBegin();
+
+  // SmartIntercom Run due scheduler jobs
+  smartIntercomScheduler.smartIntercomRun();
 
   // SmartIntercom Check for ring
   if (smartIntercomRingDetector->smartIntercomCheck()) {
@@ -495,14 +672,28 @@ void SmartIntercom::smartIntercomUpdate() {
   }
 
   // SmartIntercom Update door state
-  if (smartIntercomDoorController) {
-    smartIntercomDoorController->smartIntercomCheckState();
-  }
+  smartIntercomDoorCheck();
 
-  // SmartIntercom Update state
+  // SmartIntercom State timeout (single deadline, no per-state polling)
   smartIntercomUpdateState();
+  smartIntercomOutputCommit();
+
+  // SmartIntercom Persist coalesced configuration changes
+  if (smartIntercomConfigStore && smartIntercomConfigStore->smartIntercomIsCommitDue()) {
+    smartIntercomCommitConfig();
+  }
+
+  // SmartIntercom Periodic statistics snapshot
+  if (smartIntercomStats && smartIntercomStats->smartIntercomIsSaveDue()) {
+    smartIntercomSaveStats();
+  }
 
-  smartIntercomLastUpdate = millis();
+  // SmartIntercom Deliver queued events to subscribers in batches
+  smartIntercomEvents.smartIntercomDispatch();
+
+  // SmartIntercom Emit deferred log lines while the UART has room
+  smartIntercomLogDrain();
+  smartIntercomMarkPhase(phase);
 }
 
 /*
@@ -510,59 +701,117 @@ void SmartIntercom::smartIntercomUpdate() {
  * Обработка звонка SmartIntercom
  */
 void SmartIntercom::smartIntercomProcessRing() {
-  Serial.println("SmartIntercom: Processing ring...");
-  smartIntercomState = SMARTINTERCOM_STATE_RINGING;
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Processing ring...");
+  smartIntercomDispatchInput(SMARTINTERCOM_INPUT_RING);
+  if (smartIntercomStats) {
+    smartIntercomStats->smartIntercomRecord(SMARTINTERCOM_STATS_RINGS);
+  }
 
   // SmartIntercom LED indication
   smartIntercomLEDBlink(2);
 
   // SmartIntercom Trigger event
-  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_RING);
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_RING, smartIntercomRingDetector->smartIntercomGetCount());
 
   // SmartIntercom Auto-open logic
   if (smartIntercomConfiguration.autoOpenEnabled ||
       smartIntercomConfiguration.alwaysOpenEnabled) {
-    Serial.println("SmartIntercom: Auto-open triggered");
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open triggered");
+    if (smartIntercomStats) {
+      smartIntercomStats->smartIntercomRecord(SMARTINTERCOM_STATS_AUTO_OPENS);
+    }
+    smartIntercomRingEdge = smartIntercomRingDetector->smartIntercomGetRingStart();
+    smartIntercomAwaitingOpen = true;
 
     if (smartIntercomConfiguration.openDelay > 0) {
-      Serial.print("SmartIntercom: Delaying for ");
-      Serial.print(smartIntercomConfiguration.openDelay);
-      Serial.println(" ms");
-      delay(smartIntercomConfiguration.openDelay);
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: Delaying for %d ms", smartIntercomConfiguration.openDelay);
+      if (!smartIntercomScheduleOpen(smartIntercomConfiguration.openDelay)) {
+        smartIntercomAwaitingOpen = false;
+      }
+    } else {
+      smartIntercomOpenDoor();
     }
 
-    smartIntercomOpenDoor();
-
     // SmartIntercom Disable auto-open after use
     if (!smartIntercomConfiguration.alwaysOpenEnabled) {
       smartIntercomConfiguration.autoOpenEnabled = false;
-      Serial.println("SmartIntercom: Auto-open disabled after use");
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open disabled after use");
+      smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
     }
   }
 }
 
 /*
  * SmartIntercom Update State
- * Обновление состояния SmartIntercom
+ * Вход TIMEOUT SmartIntercom, когда наступил срок текущего состояния
  */
 void SmartIntercom::smartIntercomUpdateState() {
-  // SmartIntercom State machine logic
-  switch (smartIntercomState) {
-    case SMARTINTERCOM_STATE_RINGING:
-      if (millis() - smartIntercomLastUpdate > smartIntercomConfiguration.ringTimeout) {
-        smartIntercomState = SMARTINTERCOM_STATE_IDLE;
-        Serial.println("SmartIntercom: Ring timeout, returning to idle");
-      }
+  if (smartIntercomStateArmed && (long)(smartIntercomMillis() - smartIntercomStateDeadline) >= 0) {
+    smartIntercomStateArmed = false;
+    smartIntercomDispatchInput(SMARTINTERCOM_INPUT_TIMEOUT);
+  }
+}
+
+/*
+ * SmartIntercom Dispatch Input
+ * Переход SmartIntercom по таблице smartIntercomTransitions
+ *
+ * Срок нового состояния взводится до действия, действие выполняется
+ * после смены состояния. Возвращает false, если вход игнорируется.
+ */
+bool SmartIntercom::smartIntercomDispatchInput(SmartIntercomStateInput input) {
+  const SmartIntercomTransition& transition = smartIntercomTransitionFor(smartIntercomState, input);
+  if (transition.next == SMARTINTERCOM_STATES) {
+    return false;
+  }
+
+  unsigned long now = smartIntercomMillis();
+  switch (transition.timeout) {
+    case SMARTINTERCOM_TIMEOUT_NONE:
+      smartIntercomStateArmed = false;
+      break;
+    case SMARTINTERCOM_TIMEOUT_IMMEDIATE:
+      smartIntercomStateDeadline = now;
+      smartIntercomStateArmed = true;
+      break;
+    case SMARTINTERCOM_TIMEOUT_RING:
+      smartIntercomStateDeadline = now + smartIntercomConfiguration.ringTimeout;
+      smartIntercomStateArmed = true;
+      break;
+    case SMARTINTERCOM_TIMEOUT_DOOR:
+      smartIntercomStateDeadline = now + smartIntercomDoorGetOpenTime() + 1000;
+      smartIntercomStateArmed = true;
+      break;
+    default:
       break;
+  }
+
+  smartIntercomChangeState((SmartIntercomDeviceState)transition.next);
+  smartIntercomRunAction(transition.action);
+  return true;
+}
 
-    case SMARTINTERCOM_STATE_OPENING:
-      smartIntercomState = SMARTINTERCOM_STATE_OPEN;
+/*
+ * SmartIntercom Run Action
+ * Действие перехода SmartIntercom
+ */
+void SmartIntercom::smartIntercomRunAction(uint8_t action) {
+  switch (action) {
+    case SMARTINTERCOM_ACTION_LED_OFF:
+      smartIntercomLEDWrite(false);
       break;
 
-    case SMARTINTERCOM_STATE_OPEN:
-      if (!smartIntercomDoorController->smartIntercomCheckState()) {
-        smartIntercomState = SMARTINTERCOM_STATE_IDLE;
+    case SMARTINTERCOM_ACTION_RING_TIMEOUT:
+      smartIntercomLEDWrite(false);
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: Ring timeout, returning to idle");
+      break;
+
+    case SMARTINTERCOM_ACTION_CLOSE_DOOR:
+      // SmartIntercom The door normally closed itself in smartIntercomCheckState() already
+      if (smartIntercomDoorCheck()) {
+        smartIntercomDoorClose();
       }
+      smartIntercomLEDWrite(false);
       break;
 
     default:
@@ -570,14 +819,149 @@ void SmartIntercom::smartIntercomUpdateState() {
   }
 }
 
+/*
+ * SmartIntercom Get Next Deadline
+ * Когда SmartIntercom нужен следующий проход цикла (false - сроков нет)
+ *
+ * Учитывает срок текущего состояния и задачи планировщика.
+ */
+bool SmartIntercom::smartIntercomGetNextDeadline(unsigned long* deadline) {
+  bool found = smartIntercomStateArmed;
+  *deadline = smartIntercomStateDeadline;
+  if (smartIntercomScheduler.smartIntercomHasPending()) {
+    unsigned long jobDeadline = smartIntercomScheduler.smartIntercomGetNextDeadline();
+    if (!found || (long)(jobDeadline - *deadline) < 0) {
+      *deadline = jobDeadline;
+    }
+    found = true;
+  }
+  return found;
+}
+
+/*
+ * SmartIntercom Get Idle Time
+ * Сколько миллисекунд главный цикл SmartIntercom может спать (не больше maxMs)
+ *
+ * 0 - работа уже есть (события для рассылки, отложенная запись,
+ * снимок статистики). Без выборки по таймеру АЦП звонка опрашивается
+ * из цикла, поэтому сон ограничен SMARTINTERCOM_RING_POLL_MS.
+ */
+unsigned long SmartIntercom::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (!smartIntercomInitialized) {
+    return maxMs;
+  }
+  if (smartIntercomEvents.smartIntercomHasPending() ||
+      (smartIntercomConfigStore && smartIntercomConfigStore->smartIntercomIsCommitDue()) ||
+      (smartIntercomStats && smartIntercomStats->smartIntercomIsSaveDue())) {
+    return 0;
+  }
+
+  unsigned long budget = maxMs;
+  if (!smartIntercomRingDetector->smartIntercomIsSampling() && budget > SMARTINTERCOM_RING_POLL_MS) {
+    budget = SMARTINTERCOM_RING_POLL_MS;
+  }
+  if (smartIntercomLogGetPending() > 0 && budget > SMARTINTERCOM_IDLE_SLICE_MS) {
+    budget = SMARTINTERCOM_IDLE_SLICE_MS;
+  }
+
+  unsigned long now = smartIntercomMillis();
+  unsigned long deadline;
+  if (smartIntercomGetNextDeadline(&deadline)) {
+    long remaining = (long)(deadline - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    if ((unsigned long)remaining < budget) {
+      budget = (unsigned long)remaining;
+    }
+  }
+  if (smartIntercomConfigStore && smartIntercomConfigStore->smartIntercomIsPending()) {
+    long remaining = (long)(smartIntercomConfigStore->smartIntercomGetCommitDeadline() - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    if ((unsigned long)remaining < budget) {
+      budget = (unsigned long)remaining;
+    }
+  }
+  return budget;
+}
+
+/*
+ * SmartIntercom Idle
+ * Сон SmartIntercom до следующего срока вместо delay() в loop()
+ *
+ * Просыпается раньше по smartIntercomWake(): прерывание выборки
+ * звонка, события из прерываний, обработчики пользователя.
+ */
+void SmartIntercom::smartIntercomIdle(unsigned long maxMs) {
+  unsigned long budget = smartIntercomGetIdleTime(maxMs);
+  if (budget > 0) {
+    smartIntercomIdleWait(budget);
+  }
+}
+
 /*
  * SmartIntercom Trigger Event
- * Вызов callback события SmartIntercom
+ * Событие SmartIntercom в очередь подписчиков
+ *
+ * Сохранение конфигурации и учет ошибок выполняются сразу,
+ * подписчики получат запись в следующей рассылке.
+ */
+void SmartIntercom::smartIntercomTriggerEvent(SmartIntercomEventType event, int32_t value) {
+  if (event == SMARTINTERCOM_EVENT_CONFIG) {
+    if (smartIntercomConfigStore) {
+      smartIntercomConfigStore->smartIntercomRequestSave(smartIntercomConfiguration);
+    }
+    value = (smartIntercomConfiguration.autoOpenEnabled ? SMARTINTERCOM_CONFIG_FLAG_AUTO_OPEN : 0) |
+            (smartIntercomConfiguration.alwaysOpenEnabled ? SMARTINTERCOM_CONFIG_FLAG_ALWAYS_OPEN : 0);
+  }
+  if (event == SMARTINTERCOM_EVENT_ERROR && smartIntercomStats) {
+    smartIntercomStats->smartIntercomRecord(SMARTINTERCOM_STATS_ERRORS);
+  }
+  smartIntercomEvents.smartIntercomPost(event, value);
+}
+
+/*
+ * SmartIntercom Change State
+ * Смена состояния SmartIntercom с событием SMARTINTERCOM_EVENT_STATE
+ *
+ * Событие отправляется только при действительной смене состояния,
+ * поэтому подписчики (живой статус веб-интерфейса) получают лишь переходы.
  */
-void SmartIntercom::smartIntercomTriggerEvent(SmartIntercomEventType event, void* data) {
-  if (smartIntercomEventCallback) {
-    smartIntercomEventCallback(event, data);
+void SmartIntercom::smartIntercomChangeState(SmartIntercomDeviceState state) {
+  if (smartIntercomState == state) {
+    return;
   }
+  smartIntercomState = state;
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_STATE, state);
+}
+
+/*
+ * SmartIntercom Delayed Open Step
+ * Задача планировщика для отложенного открытия SmartIntercom
+ */
+long SmartIntercom::smartIntercomDelayedOpenStep(void* context, int step) {
+  SmartIntercom* intercom = static_cast<SmartIntercom*>(context);
+  intercom->smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  intercom->smartIntercomOpenDoor();
+  return SMARTINTERCOM_JOB_DONE;
+}
+
+/*
+ * SmartIntercom Schedule Open
+ * Запланировать открытие двери SmartIntercom без блокировки цикла;
+ * false - в планировщике нет места, открытие не запланировано
+ */
+bool SmartIntercom::smartIntercomScheduleOpen(int delay) {
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomPendingOpenJob);
+  smartIntercomPendingOpenJob = smartIntercomScheduler.smartIntercomSchedule(
+    delay, smartIntercomDelayedOpenStep, this);
+  if (smartIntercomPendingOpenJob == SMARTINTERCOM_JOB_NONE) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Scheduler full, door open not scheduled");
+    return false;
+  }
+  return true;
 }
 
 /*
@@ -585,19 +969,34 @@ void SmartIntercom::smartIntercomTriggerEvent(SmartIntercomEventType event, void
  * Открыть дверь SmartIntercom
  */
 void SmartIntercom::smartIntercomOpenDoor() {
-  Serial.println("SmartIntercom: Manual door open");
-  smartIntercomState = SMARTINTERCOM_STATE_OPENING;
-  smartIntercomLED->smartIntercomSetHigh();
-  smartIntercomDoorController->smartIntercomOpen();
-  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_OPEN);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Manual door open");
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomPendingOpenJob);
+  smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomDispatchInput(SMARTINTERCOM_INPUT_OPEN);
+  // SmartIntercom LED and relay switch in the same instant
+  smartIntercomOutputBegin();
+  smartIntercomLEDWrite(true);
+  smartIntercomDoorOpen();
+  smartIntercomOutputCommit();
+  if (smartIntercomStats) {
+    smartIntercomStats->smartIntercomRecord(SMARTINTERCOM_STATS_OPENS);
+  }
+  if (smartIntercomAwaitingOpen && smartIntercomMetrics) {
+    smartIntercomMetrics->smartIntercomRecord(SMARTINTERCOM_METRIC_RING_TO_OPEN,
+                                              (smartIntercomMillis() - smartIntercomRingEdge) * 1000UL);
+  }
+  bool answeredRing = smartIntercomAwaitingOpen;
+  smartIntercomAwaitingOpen = false;
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_OPEN, answeredRing ? SMARTINTERCOM_OPEN_AUTO : SMARTINTERCOM_OPEN_MANUAL);
 }
 
 /*
  * SmartIntercom Open Door Delayed
- * Открыть дверь SmartIntercom с задержкой
+ * Открыть дверь SmartIntercom с задержкой; false - открытие не запланировано
  */
-void SmartIntercom::smartIntercomOpenDoorDelayed(int delay) {
-  smartIntercomDoorController->smartIntercomOpenDelayed(delay);
+bool SmartIntercom::smartIntercomOpenDoorDelayed(int delay) {
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Opening door with delay %d ms", delay);
+  return smartIntercomScheduleOpen(delay);
 }
 
 /*
@@ -605,8 +1004,14 @@ void SmartIntercom::smartIntercomOpenDoorDelayed(int delay) {
  * Закрыть дверь SmartIntercom
  */
 void SmartIntercom::smartIntercomCloseDoor() {
-  smartIntercomDoorController->smartIntercomClose();
-  smartIntercomLED->smartIntercomSetLow();
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomPendingOpenJob);
+  smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomAwaitingOpen = false;
+  smartIntercomOutputBegin();
+  smartIntercomDoorClose();
+  smartIntercomLEDWrite(false);
+  smartIntercomOutputCommit();
+  smartIntercomDispatchInput(SMARTINTERCOM_INPUT_CLOSE);
   smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CLOSE);
 }
 
@@ -616,7 +1021,8 @@ void SmartIntercom::smartIntercomCloseDoor() {
  */
 void SmartIntercom::smartIntercomEnableAutoOpen() {
   smartIntercomConfiguration.autoOpenEnabled = true;
-  Serial.println("SmartIntercom: Auto-open enabled");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open enabled");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 /*
@@ -625,7 +1031,8 @@ void SmartIntercom::smartIntercomEnableAutoOpen() {
  */
 void SmartIntercom::smartIntercomDisableAutoOpen() {
   smartIntercomConfiguration.autoOpenEnabled = false;
-  Serial.println("SmartIntercom: Auto-open disabled");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open disabled");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 /*
@@ -634,8 +1041,9 @@ void SmartIntercom::smartIntercomDisableAutoOpen() {
  */
 void SmartIntercom::smartIntercomToggleAutoOpen() {
   smartIntercomConfiguration.autoOpenEnabled = !smartIntercomConfiguration.autoOpenEnabled;
-  Serial.print("SmartIntercom: Auto-open ");
-  Serial.println(smartIntercomConfiguration.autoOpenEnabled ? "enabled" : "disabled");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open %s",
+                         smartIntercomConfiguration.autoOpenEnabled ? "enabled" : "disabled");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 /*
@@ -644,7 +1052,8 @@ void SmartIntercom::smartIntercomToggleAutoOpen() {
  */
 void SmartIntercom::smartIntercomEnableAlwaysOpen() {
   smartIntercomConfiguration.alwaysOpenEnabled = true;
-  Serial.println("SmartIntercom: Always-open enabled");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Always-open enabled");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 /*
@@ -653,43 +1062,80 @@ void SmartIntercom::smartIntercomEnableAlwaysOpen() {
  */
 void SmartIntercom::smartIntercomDisableAlwaysOpen() {
   smartIntercomConfiguration.alwaysOpenEnabled = false;
-  Serial.println("SmartIntercom: Always-open disabled");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Always-open disabled");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 /*
  * SmartIntercom LED Control Functions
  */
 void SmartIntercom::smartIntercomLEDOn() {
-  smartIntercomLED->smartIntercomSetHigh();
+  smartIntercomLEDWrite(true);
 }
 
 void SmartIntercom::smartIntercomLEDOff() {
-  smartIntercomLED->smartIntercomSetLow();
+  smartIntercomLEDWrite(false);
 }
 
 void SmartIntercom::smartIntercomLEDBlink(int times) {
-  smartIntercomLED->smartIntercomBlink(times, 200, 200);
+  smartIntercomLEDStartBlink(times);
 }
 
 void SmartIntercom::smartIntercomLEDSetBrightness(int brightness) {
-  smartIntercomLED->smartIntercomSetPWM(brightness);
+  smartIntercomLEDWritePWM(brightness);
+}
+
+/*
+ * SmartIntercom Ring Sampling Control
+ * Выборка АЦП звонка SmartIntercom по таймеру вместо опроса из loop()
+ */
+bool SmartIntercom::smartIntercomEnableRingSampling(unsigned long periodUs) {
+  return smartIntercomRingDetector->smartIntercomBeginSampling(periodUs);
+}
+
+/*
+ * SmartIntercom Pause / Resume Ring Sampling
+ * Остановка выборки звонка SmartIntercom на время работы с флеш-памятью
+ */
+void SmartIntercom::smartIntercomPauseRingSampling() {
+  if (smartIntercomRingDetector != nullptr) {
+    smartIntercomRingDetector->smartIntercomPauseSampling();
+  }
+}
+
+void SmartIntercom::smartIntercomResumeRingSampling() {
+  if (smartIntercomRingDetector != nullptr) {
+    smartIntercomRingDetector->smartIntercomResumeSampling();
+  }
+}
+
+void SmartIntercom::smartIntercomDisableRingSampling() {
+  smartIntercomRingDetector->smartIntercomEndSampling();
+}
+
+uint32_t SmartIntercom::smartIntercomGetDroppedRingSamples() {
+  return smartIntercomRingDetector->smartIntercomGetDroppedSamples();
+}
+
+void SmartIntercom::smartIntercomSetRingTone(unsigned int toneHz) {
+  smartIntercomRingDetector->smartIntercomSetToneFrequency(toneHz);
 }
 
 /*
  * SmartIntercom Handset Control Functions
  */
 void SmartIntercom::smartIntercomPickupHandset() {
-  smartIntercomHandset->smartIntercomSetHigh();
-  Serial.println("SmartIntercom: Handset picked up");
+  smartIntercomHandsetWrite(true);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Handset picked up");
 }
 
 void SmartIntercom::smartIntercomHangupHandset() {
-  smartIntercomHandset->smartIntercomSetLow();
-  Serial.println("SmartIntercom: Handset hung up");
+  smartIntercomHandsetWrite(false);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Handset hung up");
 }
 
 void SmartIntercom::smartIntercomToggleHandset() {
-  smartIntercomHandset->smartIntercomToggle();
+  smartIntercomHandsetFlip();
 }
 
 /*
@@ -730,7 +1176,8 @@ bool SmartIntercom::smartIntercomIsReady() {
  */
 void SmartIntercom::smartIntercomSetConfig(SmartIntercomConfig config) {
   smartIntercomConfiguration = config;
-  Serial.println("SmartIntercom: Configuration updated");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Configuration updated");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 SmartIntercomConfig SmartIntercom::smartIntercomGetConfig() {
@@ -739,22 +1186,159 @@ SmartIntercomConfig SmartIntercom::smartIntercomGetConfig() {
 
 void SmartIntercom::smartIntercomSetOpenDelay(int ms) {
   smartIntercomConfiguration.openDelay = ms;
-  Serial.print("SmartIntercom: Open delay set to ");
-  Serial.print(ms);
-  Serial.println(" ms");
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Open delay set to %d ms", ms);
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
 }
 
 void SmartIntercom::smartIntercomSetOpenTime(int ms) {
   smartIntercomConfiguration.openTime = ms;
-  smartIntercomDoorController->smartIntercomSetOpenTime(ms);
+  smartIntercomDoorSetOpenTime(ms);
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
+}
+
+/*
+ * SmartIntercom Attach Config Store
+ * Подключить журнал конфигурации SmartIntercom и восстановить настройки
+ *
+ * Вызывается после smartIntercomBegin() и smartIntercomBegin() журнала.
+ * Дальше каждое изменение конфигурации сохраняется автоматически,
+ * с объединением частых изменений в одну запись.
+ */
+bool SmartIntercom::smartIntercomAttachConfigStore(SmartIntercomConfigStore* store) {
+  smartIntercomConfigStore = store;
+  if (store == nullptr || !smartIntercomInitialized) {
+    return false;
+  }
+  SmartIntercomConfig restored = smartIntercomConfiguration;
+  if (!store->smartIntercomLoad(&restored)) {
+    return false;
+  }
+  smartIntercomConfiguration = restored;
+  smartIntercomDoorSetOpenTime(restored.openTime);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Configuration restored (auto-open %d, always-open %d)",
+                         restored.autoOpenEnabled, restored.alwaysOpenEnabled);
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
+  return true;
+}
+
+/*
+ * SmartIntercom Save Config Now
+ * Немедленная запись отложенной конфигурации SmartIntercom (перед перезагрузкой)
+ */
+bool SmartIntercom::smartIntercomSaveConfigNow() {
+  if (smartIntercomConfigStore == nullptr) {
+    return false;
+  }
+  if (!smartIntercomConfigStore->smartIntercomIsPending()) {
+    return true;
+  }
+  return smartIntercomCommitConfig();
+}
+
+/*
+ * SmartIntercom Commit Config
+ * Запись журнала SmartIntercom с остановленной выборкой звонка
+ */
+bool SmartIntercom::smartIntercomCommitConfig() {
+  smartIntercomRingDetector->smartIntercomPauseSampling();
+  bool saved = smartIntercomConfigStore->smartIntercomCommit();
+  smartIntercomRingDetector->smartIntercomResumeSampling();
+  if (!saved) {
+    smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_ERROR, SMARTINTERCOM_ERROR_CONFIG_SAVE);
+  }
+  return saved;
+}
+
+/*
+ * SmartIntercom Attach Stats
+ * Подключить статистику SmartIntercom (после smartIntercomBegin() статистики)
+ */
+void SmartIntercom::smartIntercomAttachStats(SmartIntercomStats* stats) {
+  smartIntercomStats = stats;
+}
+
+/*
+ * SmartIntercom Attach Metrics
+ * Подключить гистограммы задержек SmartIntercom (звонок -> реле, период цикла)
+ */
+void SmartIntercom::smartIntercomAttachMetrics(SmartIntercomMetrics* metrics) {
+  smartIntercomMetrics = metrics;
+  smartIntercomLastUpdateUs = smartIntercomMicros();
+}
+
+/*
+ * SmartIntercom Attach Trace
+ * Подключить запись трассы АЦП SmartIntercom (после smartIntercomBegin())
+ */
+void SmartIntercom::smartIntercomAttachTrace(SmartIntercomTrace* trace) {
+  if (smartIntercomRingDetector != nullptr) {
+    smartIntercomRingDetector->smartIntercomAttachTrace(trace);
+  }
+}
+
+/*
+ * SmartIntercom Save Stats
+ * Снимок статистики SmartIntercom с остановленной выборкой звонка
+ */
+bool SmartIntercom::smartIntercomSaveStats() {
+  smartIntercomRingDetector->smartIntercomPauseSampling();
+  bool saved = smartIntercomStats->smartIntercomSave();
+  smartIntercomRingDetector->smartIntercomResumeSampling();
+  if (!saved) {
+    smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_ERROR, SMARTINTERCOM_ERROR_STATS_SAVE);
+  }
+  return saved;
 }
 
 /*
  * SmartIntercom Set Event Callback
+ * Прежний единственный callback SmartIntercom - теперь один из подписчиков очереди
  */
 void SmartIntercom::smartIntercomSetEventCallback(SmartIntercomCallback callback) {
   smartIntercomEventCallback = callback;
-  Serial.println("SmartIntercom: Event callback registered");
+  if (callback != nullptr && smartIntercomCallbackSubscriber == SMARTINTERCOM_EVENT_NO_SUBSCRIBER) {
+    smartIntercomCallbackSubscriber = smartIntercomEvents.smartIntercomSubscribe(smartIntercomCallbackStep, this);
+  } else if (callback == nullptr) {
+    smartIntercomEvents.smartIntercomUnsubscribe(smartIntercomCallbackSubscriber);
+    smartIntercomCallbackSubscriber = SMARTINTERCOM_EVENT_NO_SUBSCRIBER;
+  }
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Event callback registered");
+}
+
+/*
+ * SmartIntercom Callback Step
+ * Подписчик-переходник: запись события SmartIntercom -> SmartIntercomCallback
+ *
+ * data как раньше: для STATE - состояние из записи события, для
+ * CONFIG - текущая конфигурация, для остальных событий nullptr.
+ */
+void SmartIntercom::smartIntercomCallbackStep(const SmartIntercomEvent& event, void* context) {
+  SmartIntercom* intercom = static_cast<SmartIntercom*>(context);
+  if (intercom->smartIntercomEventCallback == nullptr) {
+    return;
+  }
+  SmartIntercomEventType type = (SmartIntercomEventType)event.type;
+  if (type == SMARTINTERCOM_EVENT_STATE) {
+    SmartIntercomDeviceState state = (SmartIntercomDeviceState)event.value;
+    intercom->smartIntercomEventCallback(type, &state);
+  } else if (type == SMARTINTERCOM_EVENT_CONFIG) {
+    intercom->smartIntercomEventCallback(type, &intercom->smartIntercomConfiguration);
+  } else {
+    intercom->smartIntercomEventCallback(type, nullptr);
+  }
+}
+
+/*
+ * SmartIntercom Subscribe
+ * Подписка на события SmartIntercom (mask - SMARTINTERCOM_EVENT_MASK(тип) | ...)
+ */
+uint8_t SmartIntercom::smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context, uint16_t mask,
+                                              uint8_t batch) {
+  return smartIntercomEvents.smartIntercomSubscribe(handler, context, mask, batch);
+}
+
+void SmartIntercom::smartIntercomUnsubscribe(uint8_t id) {
+  smartIntercomEvents.smartIntercomUnsubscribe(id);
 }
 
 /*
@@ -775,12 +1359,45 @@ String SmartIntercom::smartIntercomGetName() {
  * SmartIntercom Reset
  */
 void SmartIntercom::smartIntercomReset() {
-  Serial.println("SmartIntercom: Resetting...");
-  smartIntercomState = SMARTINTERCOM_STATE_INIT;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Resetting...");
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomPendingOpenJob);
+  smartIntercomPendingOpenJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomDispatchInput(SMARTINTERCOM_INPUT_RESET);
   smartIntercomRingDetector->smartIntercomReset();
-  smartIntercomLED->smartIntercomSetLow();
-  smartIntercomHandset->smartIntercomSetLow();
+  smartIntercomLEDWrite(false);
+  smartIntercomHandsetWrite(false);
   smartIntercomConfiguration.autoOpenEnabled = false;
   smartIntercomConfiguration.alwaysOpenEnabled = false;
-  Serial.println("SmartIntercom: Reset complete");
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Reset complete");
+  smartIntercomTriggerEvent(SMARTINTERCOM_EVENT_CONFIG);
+}
+
+// ============================================================================
+// SmartIntercomFlashGuard Implementation
+// ============================================================================
+
+/*
+ * SmartIntercomFlashGuard Read / Write / Erase
+ * Операция флеш-памяти SmartIntercom с остановленной выборкой звонка
+ */
+bool SmartIntercomFlashGuard::smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) {
+  smartIntercomDevice.smartIntercomPauseRingSampling();
+  bool ok = smartIntercomTarget.smartIntercomRead(sector, offset, data, length);
+  smartIntercomDevice.smartIntercomResumeRingSampling();
+  return ok;
+}
+
+bool SmartIntercomFlashGuard::smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data,
+                                                 size_t length) {
+  smartIntercomDevice.smartIntercomPauseRingSampling();
+  bool ok = smartIntercomTarget.smartIntercomWrite(sector, offset, data, length);
+  smartIntercomDevice.smartIntercomResumeRingSampling();
+  return ok;
+}
+
+bool SmartIntercomFlashGuard::smartIntercomErase(uint16_t sector) {
+  smartIntercomDevice.smartIntercomPauseRingSampling();
+  bool ok = smartIntercomTarget.smartIntercomErase(sector);
+  smartIntercomDevice.smartIntercomResumeRingSampling();
+  return ok;
 }
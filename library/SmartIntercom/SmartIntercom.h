@@ -15,6 +15,19 @@
 #define SMARTINTERCOM_H
 
 #include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomLog.h"
+#include "SmartIntercomScheduler.h"
+#include "SmartIntercomGPIOSequence.h"
+#include "SmartIntercomSampleBuffer.h"
+#include "SmartIntercomRingClassifier.h"
+#include "SmartIntercomStatus.h"
+#include "SmartIntercomConfigStore.h"
+#include "SmartIntercomStats.h"
+#include "SmartIntercomMetrics.h"
+#include "SmartIntercomTrace.h"
+#include "SmartIntercomEventQueue.h"
+#include "SmartIntercomStateMachine.h"
 
 // SmartIntercom Version Information
 #define SMARTINTERCOM_LIB_VERSION "2.0.0"
@@ -25,6 +38,12 @@
 #define SMARTINTERCOM_DEFAULT_DEBOUNCE 50
 #define SMARTINTERCOM_DEFAULT_RING_TIMEOUT 30000
 
+// SmartIntercom Ring Sampling Configuration
+#define SMARTINTERCOM_RING_SAMPLE_PERIOD_US 1000
+#define SMARTINTERCOM_RING_BATCH_SIZE 32
+#define SMARTINTERCOM_RING_WAKE_SAMPLES (SMARTINTERCOM_SAMPLE_BUFFER_SIZE / 2)  // Пробуждение цикла по заполнению
+#define SMARTINTERCOM_RING_POLL_MS 10             // Сон цикла без выборки по таймеру (АЦП опрашивается)
+
 // SmartIntercom GPIO Modes
 enum SmartIntercomGPIOMode {
   SMARTINTERCOM_MODE_NORMAL,      // SmartIntercom обычный режим
@@ -33,27 +52,33 @@ enum SmartIntercomGPIOMode {
   SMARTINTERCOM_MODE_PULSE        // SmartIntercom импульсный режим
 };
 
-// SmartIntercom Device States
-enum SmartIntercomDeviceState {
-  SMARTINTERCOM_STATE_INIT,       // SmartIntercom инициализация
-  SMARTINTERCOM_STATE_READY,      // SmartIntercom готов
-  SMARTINTERCOM_STATE_IDLE,       // SmartIntercom ожидание
-  SMARTINTERCOM_STATE_RINGING,    // SmartIntercom звонок
-  SMARTINTERCOM_STATE_OPENING,    // SmartIntercom открытие
-  SMARTINTERCOM_STATE_OPEN,       // SmartIntercom открыто
-  SMARTINTERCOM_STATE_CLOSING,    // SmartIntercom закрытие
-  SMARTINTERCOM_STATE_ERROR       // SmartIntercom ошибка
-};
-
-// SmartIntercom Event Types
+// SmartIntercom Event Types (value в SmartIntercomEvent)
 enum SmartIntercomEventType {
-  SMARTINTERCOM_EVENT_RING,       // SmartIntercom событие звонка
-  SMARTINTERCOM_EVENT_OPEN,       // SmartIntercom событие открытия
+  SMARTINTERCOM_EVENT_RING,       // SmartIntercom событие звонка (value - номер звонка)
+  SMARTINTERCOM_EVENT_OPEN,       // SmartIntercom событие открытия (value - SmartIntercomOpenSource)
   SMARTINTERCOM_EVENT_CLOSE,      // SmartIntercom событие закрытия
-  SMARTINTERCOM_EVENT_ERROR,      // SmartIntercom событие ошибки
-  SMARTINTERCOM_EVENT_CONFIG      // SmartIntercom событие конфигурации
+  SMARTINTERCOM_EVENT_ERROR,      // SmartIntercom событие ошибки (value - SmartIntercomErrorCode)
+  SMARTINTERCOM_EVENT_CONFIG,     // SmartIntercom событие конфигурации (value - SMARTINTERCOM_CONFIG_FLAG_*)
+  SMARTINTERCOM_EVENT_STATE       // SmartIntercom смена состояния (value / data - SmartIntercomDeviceState)
+};
+
+// SmartIntercom Open Sources
+enum SmartIntercomOpenSource {
+  SMARTINTERCOM_OPEN_MANUAL,      // SmartIntercom открытие командой
+  SMARTINTERCOM_OPEN_AUTO         // SmartIntercom авто-открытие по звонку
+};
+
+// SmartIntercom Error Codes
+enum SmartIntercomErrorCode {
+  SMARTINTERCOM_ERROR_NONE,
+  SMARTINTERCOM_ERROR_CONFIG_SAVE,  // SmartIntercom конфигурация не записана во flash
+  SMARTINTERCOM_ERROR_STATS_SAVE    // SmartIntercom статистика не записана во flash
 };
 
+// SmartIntercom Config Event Flags
+#define SMARTINTERCOM_CONFIG_FLAG_AUTO_OPEN 0x01
+#define SMARTINTERCOM_CONFIG_FLAG_ALWAYS_OPEN 0x02
+
 // SmartIntercom Callback Function Type
 typedef void (*SmartIntercomCallback)(SmartIntercomEventType event, void* data);
 
@@ -77,51 +102,43 @@ struct SmartIntercomConfig {
 };
 
 /*
- * SmartIntercomGPIO - Класс управления GPIO для SmartIntercom
+ * SmartIntercomGPIOPin - Пин SmartIntercomGPIO, заданный во время работы
  *
- * SmartIntercomGPIO обеспечивает надежное управление пинами
- * с поддержкой различных алгоритмов переключения SmartIntercom
+ * Политика пина SmartIntercomGPIOSequence для SmartIntercomGPIO.
  */
-class SmartIntercomGPIO {
-private:
+struct SmartIntercomGPIOPin {
   int smartIntercomPin;
   SmartIntercomGPIOMode smartIntercomMode;
   bool smartIntercomInverted;
-  bool smartIntercomCurrentState;
-  unsigned long smartIntercomLastToggle;
   int smartIntercomDebounceTime;
 
-  // SmartIntercom Internal Methods
-  bool smartIntercomCheckDebounce();
-  void smartIntercomWritePin(bool state);
+  int smartIntercomGetPin() const { return smartIntercomPin; }
+  bool smartIntercomIsInverted() const { return smartIntercomInverted; }
+  bool smartIntercomIsPWM() const { return smartIntercomMode == SMARTINTERCOM_MODE_PWM; }
+  int smartIntercomGetDebounce() const { return smartIntercomDebounceTime; }
+};
+
+// SmartIntercom Runtime pin sequences are compiled once, in SmartIntercom.cpp
+extern template class SmartIntercomGPIOSequence<SmartIntercomGPIOPin>;
 
+/*
+ * SmartIntercomGPIO - Класс управления GPIO для SmartIntercom
+ *
+ * SmartIntercomGPIO обеспечивает надежное управление пинами
+ * с поддержкой различных алгоритмов переключения SmartIntercom.
+ * Последовательности - SmartIntercomGPIOSequence, пин, режим и
+ * полярность задаются во время работы.
+ */
+class SmartIntercomGPIO : public SmartIntercomGPIOSequence<SmartIntercomGPIOPin> {
 public:
   // SmartIntercom Constructor
   SmartIntercomGPIO(int pin, SmartIntercomGPIOMode mode = SMARTINTERCOM_MODE_NORMAL, bool inverted = false);
 
-  // SmartIntercom Initialization
-  void smartIntercomBegin();
-
-  // SmartIntercom State Control
-  void smartIntercomSetHigh();
-  void smartIntercomSetLow();
-  void smartIntercomSetState(bool state);
-  void smartIntercomToggle();
-
-  // SmartIntercom Pulse Control
-  void smartIntercomPulse(unsigned long duration);
-  void smartIntercomPulsePattern(int* pattern, int length);
-
-  // SmartIntercom PWM Control
-  void smartIntercomSetPWM(int value);
-  void smartIntercomFade(int from, int to, unsigned long duration);
-
-  // SmartIntercom Blink Patterns
-  void smartIntercomBlink(int times, int onTime, int offTime);
-  void smartIntercomBlinkPattern(int* pattern, int length);
+  // SmartIntercom Not copyable (задача последовательности держит указатель на пин)
+  SmartIntercomGPIO(const SmartIntercomGPIO&) = delete;
+  SmartIntercomGPIO& operator=(const SmartIntercomGPIO&) = delete;
 
   // SmartIntercom State Reading
-  bool smartIntercomGetState();
   int smartIntercomReadAnalog();
 
   // SmartIntercom Configuration
@@ -137,21 +154,45 @@ public:
  */
 class SmartIntercomRing {
 private:
-  SmartIntercomGPIO* smartIntercomDetector;
+  SmartIntercomGPIO smartIntercomDetector;
   int smartIntercomThreshold;
   bool smartIntercomRinging;
   unsigned long smartIntercomRingStart;
   unsigned long smartIntercomRingEnd;
   int smartIntercomRingCount;
 
+  // SmartIntercom Fixed-Rate Sampling
+  SmartIntercomSampleBuffer smartIntercomSamples;
+  unsigned long smartIntercomSamplePeriodUs;
+  bool smartIntercomSampling;
+  uint8_t smartIntercomPauseDepth;                  // SmartIntercom вложенные паузы выборки (запись во флеш)
+
+  // SmartIntercom Loop Wakeup (отклонение от базовой линии, 0 - только по заполнению)
+  volatile int16_t smartIntercomWakeCenter;
+  volatile uint16_t smartIntercomWakeSpan;
+
+  // SmartIntercom Signal Classification
+  SmartIntercomRingClassifier smartIntercomClassifier;
+  unsigned int smartIntercomToneHz;
+
+  // SmartIntercom Trace Capture (nullptr - запись не подключена)
+  SmartIntercomTrace* smartIntercomTrace;
+
+  // SmartIntercom Internal Methods
+  bool smartIntercomProcessSample(int value, unsigned long timeMs);
+  void smartIntercomPublishWake();
+  static void smartIntercomSampleTick(void* context);
+
 public:
-  // SmartIntercom Constructor
-  SmartIntercomRing(int pin, int threshold = 512);
+  // SmartIntercom Constructor / Destructor (деструктор останавливает выборку)
+  SmartIntercomRing(int pin, int threshold = SMARTINTERCOM_RING_ENVELOPE_ON);
+  ~SmartIntercomRing();
 
   // SmartIntercom Ring Detection
   bool smartIntercomCheck();
   bool smartIntercomIsRinging();
   unsigned long smartIntercomGetDuration();
+  unsigned long smartIntercomGetRingStart() { return smartIntercomRingStart; }
   int smartIntercomGetCount();
 
   // SmartIntercom Reset
@@ -159,6 +200,20 @@ public:
 
   // SmartIntercom Configuration
   void smartIntercomSetThreshold(int threshold);
+  void smartIntercomSetToneFrequency(unsigned int toneHz);
+  int smartIntercomGetEnvelope();
+  int smartIntercomGetTonePercent();
+
+  // SmartIntercom Fixed-Rate Sampling
+  bool smartIntercomBeginSampling(unsigned long periodUs = SMARTINTERCOM_RING_SAMPLE_PERIOD_US);
+  void smartIntercomEndSampling();
+  void smartIntercomPauseSampling();
+  void smartIntercomResumeSampling();
+  bool smartIntercomIsSampling();
+  uint32_t smartIntercomGetDroppedSamples();
+
+  // SmartIntercom Trace Capture (каждый отсчет, дошедший до детектора)
+  void smartIntercomAttachTrace(SmartIntercomTrace* trace) { smartIntercomTrace = trace; }
 };
 
 /*
@@ -169,55 +224,128 @@ public:
  */
 class SmartIntercomDoor {
 private:
-  SmartIntercomGPIO* smartIntercomOpenRelay;
+  SmartIntercomGPIO smartIntercomOpenRelay;
   int smartIntercomOpenTime;
   bool smartIntercomIsOpen;
   unsigned long smartIntercomOpenStart;
+  uint16_t smartIntercomDelayedJob;
+
+  // SmartIntercom Internal Methods
+  static long smartIntercomDelayedOpenStep(void* context, int step);
 
 public:
-  // SmartIntercom Constructor
+  // SmartIntercom Constructor / Destructor
   SmartIntercomDoor(int pin, int openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME);
+  ~SmartIntercomDoor();
 
   // SmartIntercom Door Control
   void smartIntercomOpen();
   void smartIntercomOpenDelayed(int delay);
   void smartIntercomClose();
   bool smartIntercomCheckState();
+  bool smartIntercomIsRelayActive();
 
   // SmartIntercom Configuration
   void smartIntercomSetOpenTime(int ms);
   int smartIntercomGetOpenTime();
 };
 
+/*
+ * SmartIntercomOutputs - Выходы SmartIntercom с пинами из конфигурации
+ *
+ * Дверь, LED и трубка, которые smartIntercomBegin() строит на месте
+ * в хранилище SmartIntercom. SmartIntercomFixed кладет в то же
+ * хранилище свои выходы с пинами и полярностью из Config.
+ */
+struct SmartIntercomOutputs {
+  SmartIntercomDoor smartIntercomDoor;
+  SmartIntercomGPIO smartIntercomLED;
+  SmartIntercomGPIO smartIntercomHandset;
+
+  explicit SmartIntercomOutputs(const SmartIntercomConfig& config);
+};
+
 /*
  * SmartIntercom - Главный класс управления SmartIntercom Premium
  *
  * Класс SmartIntercom объединяет все компоненты и предоставляет
- * высокоуровневый API для управления умным домофоном SmartIntercom
+ * высокоуровневый API для управления умным домофоном SmartIntercom.
+ *
+ * Компоненты (детектор звонка, дверь, LED, трубка) лежат внутри
+ * объекта: smartIntercomBegin() строит их на месте по пинам
+ * конфигурации, повторный вызов сначала разбирает предыдущие.
+ * Куча не используется. Конфигурация времени компиляции -
+ * SmartIntercomFixed<Config> (SmartIntercomFixed.h).
  */
 class SmartIntercom {
 private:
   SmartIntercomConfig smartIntercomConfiguration;
   SmartIntercomDeviceState smartIntercomState;
-  SmartIntercomRing* smartIntercomRingDetector;
-  SmartIntercomDoor* smartIntercomDoorController;
-  SmartIntercomGPIO* smartIntercomLED;
-  SmartIntercomGPIO* smartIntercomHandset;
-  SmartIntercomCallback smartIntercomEventCallback;
+  SmartIntercomRing* smartIntercomRingDetector;     // SmartIntercom nullptr до smartIntercomBegin()
+  SmartIntercomOutputs* smartIntercomOutputs;       // SmartIntercom nullptr до smartIntercomBegin() и в SmartIntercomFixed
 
-  unsigned long smartIntercomLastUpdate;
+  // SmartIntercom Component Storage (компоненты строятся здесь в smartIntercomBegin)
+  alignas(SmartIntercomRing) uint8_t smartIntercomRingStorage[sizeof(SmartIntercomRing)];
+  SmartIntercomCallback smartIntercomEventCallback;
+  uint8_t smartIntercomCallbackSubscriber;
+  SmartIntercomEventQueue smartIntercomEvents;
+  SmartIntercomConfigStore* smartIntercomConfigStore;
+  SmartIntercomStats* smartIntercomStats;
+  SmartIntercomMetrics* smartIntercomMetrics;
+
+  unsigned long smartIntercomLastUpdateUs;
+  unsigned long smartIntercomStateDeadline;
+  bool smartIntercomStateArmed;
+  unsigned long smartIntercomRingEdge;
+  bool smartIntercomAwaitingOpen;
+  uint16_t smartIntercomPendingOpenJob;
   bool smartIntercomInitialized;
 
   // SmartIntercom Internal Methods
+  void smartIntercomReleaseComponents();
+  static long smartIntercomDelayedOpenStep(void* context, int step);
+  bool smartIntercomScheduleOpen(int delay);
   void smartIntercomProcessRing();
   void smartIntercomUpdateState();
-  void smartIntercomTriggerEvent(SmartIntercomEventType event, void* data = nullptr);
+  bool smartIntercomDispatchInput(SmartIntercomStateInput input);
+  void smartIntercomRunAction(uint8_t action);
+  void smartIntercomChangeState(SmartIntercomDeviceState state);
+  bool smartIntercomCommitConfig();
+  bool smartIntercomSaveStats();
+  void smartIntercomTriggerEvent(SmartIntercomEventType event, int32_t value = 0);
+  static void smartIntercomCallbackStep(const SmartIntercomEvent& event, void* context);
+
+  // SmartIntercom Host transition test sets states the public API cannot reach
+  friend class SmartIntercomStateTest;
+
+protected:
+  // SmartIntercom Output Storage (SmartIntercomOutputs или выходы SmartIntercomFixed)
+  alignas(SmartIntercomOutputs) uint8_t smartIntercomOutputStorage[sizeof(SmartIntercomOutputs)];
+
+  // SmartIntercom Output Hooks (SmartIntercomFixed заменяет выходы с пинами из Config)
+  virtual void smartIntercomBeginOutputs(const SmartIntercomConfig& config);
+  virtual void smartIntercomReleaseOutputs();
+  virtual void smartIntercomDoorOpen();
+  virtual void smartIntercomDoorClose();
+  virtual bool smartIntercomDoorCheck();
+  virtual int smartIntercomDoorGetOpenTime();
+  virtual void smartIntercomDoorSetOpenTime(int ms);
+  virtual void smartIntercomLEDWrite(bool state);
+  virtual void smartIntercomLEDStartBlink(int times);
+  virtual void smartIntercomLEDWritePWM(int value);
+  virtual void smartIntercomHandsetWrite(bool state);
+  virtual void smartIntercomHandsetFlip();
 
 public:
-  // SmartIntercom Constructor
+  // SmartIntercom Constructor / Destructor
   SmartIntercom();
+  virtual ~SmartIntercom();
+
+  // SmartIntercom Not copyable (компоненты и задачи планировщика указывают внутрь объекта)
+  SmartIntercom(const SmartIntercom&) = delete;
+  SmartIntercom& operator=(const SmartIntercom&) = delete;
 
-  // SmartIntercom Initialization
+  // SmartIntercom Initialization (повторный вызов перестраивает компоненты)
   void smartIntercomBegin(SmartIntercomConfig config);
   void smartIntercomBeginDefault(int doorbellPin, int doorOpenPin);
 
@@ -227,7 +355,7 @@ public:
 
   // SmartIntercom Door Control
   void smartIntercomOpenDoor();
-  void smartIntercomOpenDoorDelayed(int delay);
+  bool smartIntercomOpenDoorDelayed(int delay);
   void smartIntercomCloseDoor();
 
   // SmartIntercom Auto-Open Control
@@ -237,6 +365,14 @@ public:
   void smartIntercomEnableAlwaysOpen();
   void smartIntercomDisableAlwaysOpen();
 
+  // SmartIntercom Ring Sampling Control
+  bool smartIntercomEnableRingSampling(unsigned long periodUs = SMARTINTERCOM_RING_SAMPLE_PERIOD_US);
+  void smartIntercomPauseRingSampling();
+  void smartIntercomResumeRingSampling();
+  void smartIntercomDisableRingSampling();
+  uint32_t smartIntercomGetDroppedRingSamples();
+  void smartIntercomSetRingTone(unsigned int toneHz);
+
   // SmartIntercom Handset Control
   void smartIntercomPickupHandset();
   void smartIntercomHangupHandset();
@@ -250,6 +386,12 @@ public:
 
   // SmartIntercom State
   SmartIntercomDeviceState smartIntercomGetState();
+  bool smartIntercomIsOpenPending() const { return smartIntercomPendingOpenJob != SMARTINTERCOM_JOB_NONE; }
+  bool smartIntercomGetNextDeadline(unsigned long* deadline);
+
+  // SmartIntercom Tickless Idle (вместо delay() в конце loop())
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs = SMARTINTERCOM_IDLE_MAX_MS);
+  void smartIntercomIdle(unsigned long maxMs = SMARTINTERCOM_IDLE_MAX_MS);
   String smartIntercomGetStateName();
   bool smartIntercomIsReady();
 
@@ -259,7 +401,26 @@ public:
   void smartIntercomSetOpenDelay(int ms);
   void smartIntercomSetOpenTime(int ms);
 
-  // SmartIntercom Events
+  // SmartIntercom Persistent Configuration (журнал во флеш-памяти)
+  bool smartIntercomAttachConfigStore(SmartIntercomConfigStore* store);
+  bool smartIntercomSaveConfigNow();
+
+  // SmartIntercom Statistics (ряды по минутам, часам и дням)
+  void smartIntercomAttachStats(SmartIntercomStats* stats);
+  SmartIntercomStats* smartIntercomGetStats() { return smartIntercomStats; }
+
+  // SmartIntercom Latency Metrics (гистограммы для /api/metrics)
+  void smartIntercomAttachMetrics(SmartIntercomMetrics* metrics);
+  SmartIntercomMetrics* smartIntercomGetMetrics() { return smartIntercomMetrics; }
+
+  // SmartIntercom ADC Trace Capture (запись входа звонка для воспроизведения на хосте)
+  void smartIntercomAttachTrace(SmartIntercomTrace* trace);
+
+  // SmartIntercom Events (очередь с подписчиками, рассылка из smartIntercomUpdate)
+  uint8_t smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context = nullptr,
+                                 uint16_t mask = SMARTINTERCOM_EVENT_ALL, uint8_t batch = SMARTINTERCOM_EVENT_BATCH);
+  void smartIntercomUnsubscribe(uint8_t id);
+  SmartIntercomEventQueue& smartIntercomGetEvents() { return smartIntercomEvents; }
   void smartIntercomSetEventCallback(SmartIntercomCallback callback);
 
   // SmartIntercom Information
@@ -270,4 +431,30 @@ public:
   void smartIntercomReset();
 };
 
+/*
+ * SmartIntercomFlashGuard - Флеш-память с остановкой выборки звонка SmartIntercom
+ *
+ * Чтение, стирание и запись флеш-памяти ESP8266 отключают кэш
+ * инструкций, а прерывание выборки звонка исполняет код из флеш-памяти.
+ * Обертка останавливает выборку вокруг каждой операции. Через нее
+ * подключаются модули, которые пишут во флеш из цикла (трасса АЦП,
+ * кэш WiFi); журнал конфигурации и статистика останавливают выборку
+ * в smartIntercomCommitConfig() и smartIntercomSaveStats().
+ */
+class SmartIntercomFlashGuard : public SmartIntercomFlash {
+private:
+  SmartIntercom& smartIntercomDevice;
+  SmartIntercomFlash& smartIntercomTarget;
+
+public:
+  SmartIntercomFlashGuard(SmartIntercom& device, SmartIntercomFlash& flash)
+      : smartIntercomDevice(device), smartIntercomTarget(flash) {}
+
+  uint16_t smartIntercomGetSectorCount() override { return smartIntercomTarget.smartIntercomGetSectorCount(); }
+  uint32_t smartIntercomGetSectorSize() override { return smartIntercomTarget.smartIntercomGetSectorSize(); }
+  bool smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) override;
+  bool smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data, size_t length) override;
+  bool smartIntercomErase(uint16_t sector) override;
+};
+
 #endif // SMARTINTERCOM_H
@@ -0,0 +1,914 @@
+/*
+ * SmartIntercomApi.cpp - Реализация REST API SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomApi.h"
+
+// ============================================================================
+// SmartIntercom API JSON Helpers
+// ============================================================================
+
+/*
+ * SmartIntercom API Find Value
+ * Значение ключа плоского JSON-объекта SmartIntercom (после двоеточия)
+ *
+ * Тело запроса завершено нулем сервером. Вложенные объекты не
+ * поддерживаются: конфигурации они не нужны.
+ */
+static const char* smartIntercomApiFindValue(const char* json, const char* key) {
+  size_t keyLength = strlen(key);
+  const char* cursor = json;
+  while ((cursor = strchr(cursor, '"')) != nullptr) {
+    cursor++;
+    if (strncmp(cursor, key, keyLength) == 0 && cursor[keyLength] == '"') {
+      const char* value = cursor + keyLength + 1;
+      while (*value == ' ' || *value == '\t' || *value == '\r' || *value == '\n') {
+        value++;
+      }
+      if (*value != ':') {
+        continue;
+      }
+      value++;
+      while (*value == ' ' || *value == '\t' || *value == '\r' || *value == '\n') {
+        value++;
+      }
+      return value;
+    }
+    // SmartIntercom Skip the rest of this string token
+    while (*cursor != '\0' && *cursor != '"') {
+      cursor += (*cursor == '\\' && cursor[1] != '\0') ? 2 : 1;
+    }
+    if (*cursor == '\0') {
+      break;
+    }
+    cursor++;
+  }
+  return nullptr;
+}
+
+static bool smartIntercomApiGetBool(const char* json, const char* key, bool* out) {
+  const char* value = smartIntercomApiFindValue(json, key);
+  if (value == nullptr) {
+    return false;
+  }
+  if (strncmp(value, "true", 4) == 0) {
+    *out = true;
+    return true;
+  }
+  if (strncmp(value, "false", 5) == 0) {
+    *out = false;
+    return true;
+  }
+  return false;
+}
+
+static bool smartIntercomApiIsString(const char* json, const char* key, const char* text) {
+  const char* value = smartIntercomApiFindValue(json, key);
+  size_t length = strlen(text);
+  return value != nullptr && *value == '"' && strncmp(value + 1, text, length) == 0 && value[length + 1] == '"';
+}
+
+static bool smartIntercomApiGetInt(const char* json, const char* key, int* out) {
+  const char* value = smartIntercomApiFindValue(json, key);
+  if (value == nullptr) {
+    return false;
+  }
+  char* end = nullptr;
+  long number = strtol(value, &end, 10);
+  if (end == value) {
+    return false;
+  }
+  *out = (int)number;
+  return true;
+}
+
+/*
+ * SmartIntercom API Stats Ranges
+ * Маска рядов статистики SmartIntercom из query "range=minute,hour,day"
+ *
+ * Без параметра - все ряды; 0 - ни одного известного ряда.
+ */
+static uint8_t smartIntercomApiStatsRanges(const char* query) {
+  static const char* const names[SMARTINTERCOM_STATS_RANGES] = { "minute", "hour", "day" };
+  const char* value = query;
+  while (value != nullptr && strncmp(value, "range=", 6) != 0) {
+    value = strchr(value, '&');
+    value = value ? value + 1 : nullptr;
+  }
+  if (value == nullptr) {
+    return (1 << SMARTINTERCOM_STATS_RANGES) - 1;
+  }
+
+  uint8_t mask = 0;
+  value += 6;
+  while (*value != '\0' && *value != '&') {
+    size_t length = strcspn(value, ",&");
+    for (uint8_t range = 0; range < SMARTINTERCOM_STATS_RANGES; range++) {
+      if (strlen(names[range]) == length && strncmp(value, names[range], length) == 0) {
+        mask |= 1 << range;
+      }
+    }
+    value += length;
+    if (*value == ',') {
+      value++;
+    }
+  }
+  return mask;
+}
+
+// ============================================================================
+// SmartIntercomApi Implementation
+// ============================================================================
+
+/*
+ * SmartIntercomApi Constructor
+ */
+SmartIntercomApi::SmartIntercomApi() {
+  smartIntercomDevice = nullptr;
+  smartIntercomLines = nullptr;
+  smartIntercomTrace = nullptr;
+  smartIntercomWatchdog = nullptr;
+  smartIntercomHeap = nullptr;
+  smartIntercomServer = nullptr;
+  smartIntercomDeviceName = "";
+  smartIntercomVersion = "";
+  smartIntercomWifiProbe = nullptr;
+  smartIntercomWifiContext = nullptr;
+  smartIntercomLedBrightness = 255;
+  smartIntercomPushed.state = SMARTINTERCOM_STATE_INIT;
+  smartIntercomPushed.autoOpen = false;
+  smartIntercomPushed.wifiConnected = false;
+  smartIntercomChanged = true;
+  smartIntercomLastFrame = 0;
+  memset(smartIntercomOps, 0, sizeof(smartIntercomOps));
+  smartIntercomLastOpId = 0;
+  smartIntercomOpsChanged = false;
+}
+
+/*
+ * SmartIntercomApi Begin
+ * Регистрация маршрутов /api SmartIntercom на сервере
+ */
+void SmartIntercomApi::smartIntercomBegin(SmartIntercom& intercom, SmartIntercomHttpServer& server,
+                                          const char* deviceName, const char* version) {
+  smartIntercomDevice = &intercom;
+  smartIntercomServer = &server;
+  smartIntercomDeviceName = deviceName;
+  smartIntercomVersion = version;
+  smartIntercomSnapshot.smartIntercomBegin(smartIntercomWriteStatus, this);
+
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/status", smartIntercomHandleStatus, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/events", smartIntercomHandleEvents, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/open", smartIntercomHandleOpen, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/ops/*", smartIntercomHandleGetOp, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/config", smartIntercomHandleGetConfig, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/config", smartIntercomHandleSetConfig, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/auto-open", smartIntercomHandleAutoOpen, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/stats", smartIntercomHandleStats, this);
+  server.smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/metrics", smartIntercomHandleMetrics, this);
+
+  // SmartIntercom Status snapshot and door operations follow the device events
+  intercom.smartIntercomSubscribe(smartIntercomHandleDeviceEvent, this,
+                                  SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_RING) |
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_OPEN) |
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_CLOSE) |
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_CONFIG) |
+                                      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_STATE));
+}
+
+/*
+ * SmartIntercomApi Attach Lines
+ * Маршруты /api/lines многоканального контроллера SmartIntercom
+ */
+void SmartIntercomApi::smartIntercomAttachLines(SmartIntercomLines& lines) {
+  smartIntercomLines = &lines;
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/lines", smartIntercomHandleGetLines, this);
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/lines", smartIntercomHandleSetLines, this);
+}
+
+/*
+ * SmartIntercomApi Attach Trace
+ * Маршруты /api/trace записи трассы АЦП SmartIntercom
+ */
+void SmartIntercomApi::smartIntercomAttachTrace(SmartIntercomTrace& trace) {
+  smartIntercomTrace = &trace;
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/trace", smartIntercomHandleGetTrace, this);
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/trace", smartIntercomHandleSetTrace, this);
+}
+
+/*
+ * SmartIntercomApi Attach Watchdog
+ * Маршруты /api/watchdog сторожа главного цикла SmartIntercom
+ */
+void SmartIntercomApi::smartIntercomAttachWatchdog(SmartIntercomWatchdog& watchdog) {
+  smartIntercomWatchdog = &watchdog;
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/watchdog", smartIntercomHandleGetWatchdog, this);
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/watchdog", smartIntercomHandleSetWatchdog, this);
+}
+
+/*
+ * SmartIntercomApi Attach Heap
+ * Маршруты кучи SmartIntercom; в ответ попадает и арена запроса сервера
+ */
+void SmartIntercomApi::smartIntercomAttachHeap(SmartIntercomHeap& heap) {
+  smartIntercomHeap = &heap;
+  heap.smartIntercomAttachArena(&smartIntercomServer->smartIntercomGetArena());
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_GET, "/api/heap", smartIntercomHandleGetHeap, this);
+  smartIntercomServer->smartIntercomOn(SMARTINTERCOM_HTTP_POST, "/api/heap", smartIntercomHandleSetHeap, this);
+}
+
+/*
+ * SmartIntercomApi Set WiFi Probe
+ */
+void SmartIntercomApi::smartIntercomSetWifiProbe(SmartIntercomApiProbe probe, void* context) {
+  smartIntercomWifiProbe = probe;
+  smartIntercomWifiContext = context;
+  smartIntercomMarkChanged();
+}
+
+/*
+ * SmartIntercomApi Mark Changed
+ * Снимок /api/status и поток /api/events обновятся при следующем обращении
+ */
+void SmartIntercomApi::smartIntercomMarkChanged() {
+  smartIntercomChanged = true;
+  smartIntercomSnapshot.smartIntercomInvalidate();
+}
+
+bool SmartIntercomApi::smartIntercomIsWifiConnected() {
+  return smartIntercomWifiProbe ? smartIntercomWifiProbe(smartIntercomWifiContext) : false;
+}
+
+/*
+ * SmartIntercomApi Get State Label
+ * Короткое имя состояния SmartIntercom для веб-интерфейса
+ */
+const char* SmartIntercomApi::smartIntercomGetStateLabel(SmartIntercomDeviceState state) {
+  switch (state) {
+    case SMARTINTERCOM_STATE_READY:
+    case SMARTINTERCOM_STATE_IDLE: return "Ожидание";
+    case SMARTINTERCOM_STATE_RINGING: return "Звонок";
+    case SMARTINTERCOM_STATE_OPENING: return "Открытие";
+    case SMARTINTERCOM_STATE_OPEN: return "Открыто";
+    case SMARTINTERCOM_STATE_ERROR: return "Ошибка";
+    default: return "Неизвестно";
+  }
+}
+
+/*
+ * SmartIntercomApi Write Status
+ * Сериализатор снимка статуса SmartIntercom: вызывается только после изменений
+ */
+size_t SmartIntercomApi::smartIntercomWriteStatus(char* out, size_t size, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  int length = snprintf_P(out, size,
+                          PSTR("{\"device\":\"%s\",\"version\":\"%s\",\"state\":\"%s\","
+                               "\"auto_open\":%s,\"wifi_connected\":%s}"),
+                          api->smartIntercomDeviceName, api->smartIntercomVersion,
+                          smartIntercomGetStateLabel(api->smartIntercomDevice->smartIntercomGetState()),
+                          api->smartIntercomDevice->smartIntercomGetConfig().autoOpenEnabled ? "true" : "false",
+                          api->smartIntercomIsWifiConnected() ? "true" : "false");
+  return length < 0 ? 0 : (size_t)length;
+}
+
+// ============================================================================
+// SmartIntercomApi Door Operations
+// ============================================================================
+
+/*
+ * SmartIntercomApi Get Op State Name
+ */
+const char* SmartIntercomApi::smartIntercomGetOpStateName(uint8_t state) {
+  switch (state) {
+    case SMARTINTERCOM_API_OP_QUEUED: return "queued";
+    case SMARTINTERCOM_API_OP_RUNNING: return "running";
+    case SMARTINTERCOM_API_OP_DONE: return "done";
+    case SMARTINTERCOM_API_OP_CANCELLED: return "cancelled";
+    default: return "unknown";
+  }
+}
+
+/*
+ * SmartIntercomApi Find Op
+ * Операция SmartIntercom по номеру; nullptr - неизвестна или уже вытеснена
+ */
+SmartIntercomApi::SmartIntercomApiOp* SmartIntercomApi::smartIntercomFindOp(uint32_t id) {
+  SmartIntercomApiOp& op = smartIntercomOps[id % SMARTINTERCOM_API_MAX_OPS];
+  return id != 0 && op.id == id ? &op : nullptr;
+}
+
+/*
+ * SmartIntercomApi Cancel Op
+ * Ожидающая операция SmartIntercom отменяется, кадр op уходит подписчикам
+ */
+void SmartIntercomApi::smartIntercomCancelOp(SmartIntercomApiOp* op) {
+  op->state = SMARTINTERCOM_API_OP_CANCELLED;
+  op->finishedMs = smartIntercomMillis();
+  smartIntercomOpsChanged = true;
+}
+
+/*
+ * SmartIntercomApi Expire Ops
+ * Последняя страховка SmartIntercom: операция не ждет открытия дольше
+ * SMARTINTERCOM_API_OP_QUEUE_TIMEOUT_MS; застрявшее отложенное открытие
+ * снимается, чтобы дверь не открылась после отмены
+ */
+void SmartIntercomApi::smartIntercomExpireOps(unsigned long now) {
+  SmartIntercomApiOp* op = smartIntercomFindOp(smartIntercomLastOpId);
+  if (op != nullptr && op->state == SMARTINTERCOM_API_OP_QUEUED &&
+      now - op->acceptedMs >= SMARTINTERCOM_API_OP_QUEUE_TIMEOUT_MS) {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Operation %lu timed out in queue", (unsigned long)op->id);
+    if (smartIntercomDevice->smartIntercomIsOpenPending()) {
+      smartIntercomDevice->smartIntercomCloseDoor();
+    }
+    smartIntercomCancelOp(op);
+  }
+}
+
+/*
+ * SmartIntercomApi Format Op
+ * JSON операции SmartIntercom: время в очереди и время открытия в мс
+ */
+size_t SmartIntercomApi::smartIntercomFormatOp(const SmartIntercomApiOp& op, char* out, size_t size) {
+  unsigned long now = smartIntercomMillis();
+  unsigned long queuedMs = (op.state == SMARTINTERCOM_API_OP_QUEUED ? now : op.openedMs) - op.acceptedMs;
+  unsigned long openMs = 0;
+  if (op.state == SMARTINTERCOM_API_OP_RUNNING) {
+    openMs = now - op.openedMs;
+  } else if (op.state == SMARTINTERCOM_API_OP_DONE) {
+    openMs = op.finishedMs - op.openedMs;
+  } else if (op.state == SMARTINTERCOM_API_OP_CANCELLED) {
+    queuedMs = op.finishedMs - op.acceptedMs;
+  }
+  int length = snprintf_P(out, size,
+                          PSTR("{\"id\":%lu,\"action\":\"open\",\"state\":\"%s\",\"requests\":%u,"
+                               "\"queued_ms\":%lu,\"open_ms\":%lu}"),
+                          (unsigned long)op.id, smartIntercomGetOpStateName(op.state), op.requests, queuedMs, openMs);
+  return length < 0 || (size_t)length >= size ? 0 : (size_t)length;
+}
+
+/*
+ * SmartIntercomApi Handle Device Event
+ * Снимок статуса и операции SmartIntercom по событиям устройства
+ *
+ * Каждое событие подписки (звонок, открытие, закрытие, конфигурация,
+ * смена состояния) помечает статус измененным, поэтому /api/status и
+ * /api/events не зависят от подписчиков скетча. OPEN переводит ожидающую операцию в running, уход состояния из
+ * «Открытие»/«Открыто» завершает открытую, CLOSE до открытия
+ * отменяет ожидающую (smartIntercomCloseDoor снимает отложенное открытие).
+ * Сброс и возврат в «Ожидание» без отложенного открытия тоже отменяют
+ * ожидающую: smartIntercomReset снимает открытие без CLOSE.
+ */
+void SmartIntercomApi::smartIntercomHandleDeviceEvent(const SmartIntercomEvent& event, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  api->smartIntercomMarkChanged();
+  SmartIntercomApiOp* op = api->smartIntercomFindOp(api->smartIntercomLastOpId);
+  if (op == nullptr) {
+    return;
+  }
+
+  uint8_t state = op->state;
+  if (event.type == SMARTINTERCOM_EVENT_OPEN && state == SMARTINTERCOM_API_OP_QUEUED) {
+    op->state = SMARTINTERCOM_API_OP_RUNNING;
+    op->openedMs = smartIntercomMillis();
+  } else if (event.type == SMARTINTERCOM_EVENT_CLOSE && state == SMARTINTERCOM_API_OP_QUEUED) {
+    op->state = SMARTINTERCOM_API_OP_CANCELLED;
+    op->finishedMs = smartIntercomMillis();
+  } else if (state == SMARTINTERCOM_API_OP_QUEUED && !api->smartIntercomDevice->smartIntercomIsOpenPending() &&
+             (event.type == SMARTINTERCOM_EVENT_CONFIG ||
+              (event.type == SMARTINTERCOM_EVENT_STATE && event.value == SMARTINTERCOM_STATE_IDLE))) {
+    op->state = SMARTINTERCOM_API_OP_CANCELLED;
+    op->finishedMs = smartIntercomMillis();
+  } else if (event.type == SMARTINTERCOM_EVENT_STATE && state == SMARTINTERCOM_API_OP_RUNNING &&
+             event.value != SMARTINTERCOM_STATE_OPENING && event.value != SMARTINTERCOM_STATE_OPEN) {
+    op->state = SMARTINTERCOM_API_OP_DONE;
+    op->finishedMs = smartIntercomMillis();
+  }
+  if (op->state != state) {
+    api->smartIntercomOpsChanged = true;
+  }
+}
+
+/*
+ * SmartIntercomApi Push Ops
+ * Кадры SSE "event: op" для операций SmartIntercom, сменивших состояние
+ */
+bool SmartIntercomApi::smartIntercomPushOps() {
+  bool pushed = false;
+  smartIntercomOpsChanged = false;
+  for (uint8_t i = 0; i < SMARTINTERCOM_API_MAX_OPS; i++) {
+    SmartIntercomApiOp& op = smartIntercomOps[i];
+    if (op.id == 0 || op.pushedState == op.state) {
+      continue;
+    }
+    op.pushedState = op.state;
+    char frame[SMARTINTERCOM_API_FRAME_MAX];
+    size_t length = snprintf_P(frame, sizeof(frame), PSTR("event: op\ndata: "));
+    size_t body = smartIntercomFormatOp(op, frame + length, sizeof(frame) - length - 2);
+    if (body == 0) {
+      continue;
+    }
+    length += body;
+    frame[length++] = '\n';
+    frame[length++] = '\n';
+    if (smartIntercomServer->smartIntercomGetStreamCount() > 0) {
+      smartIntercomServer->smartIntercomBroadcast(frame, length);
+      pushed = true;
+    }
+  }
+  return pushed;
+}
+
+// ============================================================================
+// SmartIntercomApi Live Status (Server-Sent Events)
+// ============================================================================
+
+/*
+ * SmartIntercomApi Capture
+ */
+void SmartIntercomApi::smartIntercomCapture(SmartIntercomApiLiveStatus* status) {
+  status->state = smartIntercomDevice->smartIntercomGetState();
+  status->autoOpen = smartIntercomDevice->smartIntercomGetConfig().autoOpenEnabled;
+  status->wifiConnected = smartIntercomIsWifiConnected();
+}
+
+/*
+ * SmartIntercomApi Format Frame
+ * Кадр SSE "event: status": при full - все поля, иначе только изменившиеся
+ * относительно previous. Возвращает 0, если изменений нет.
+ */
+size_t SmartIntercomApi::smartIntercomFormatFrame(const SmartIntercomApiLiveStatus& previous,
+                                                  const SmartIntercomApiLiveStatus& current, bool full, char* out,
+                                                  size_t size) {
+  size_t length = snprintf_P(out, size, PSTR("event: status\ndata: {"));
+  size_t fieldsStart = length;
+
+  if (full) {
+    length += snprintf_P(out + length, size - length, PSTR("\"device\":\"%s\",\"version\":\"%s\","),
+                         smartIntercomDeviceName, smartIntercomVersion);
+  }
+  if (full || current.state != previous.state) {
+    length += snprintf_P(out + length, size - length, PSTR("\"state\":\"%s\","),
+                         smartIntercomGetStateLabel(current.state));
+  }
+  if (full || current.autoOpen != previous.autoOpen) {
+    length += snprintf_P(out + length, size - length, PSTR("\"auto_open\":%s,"),
+                         current.autoOpen ? "true" : "false");
+  }
+  if (full || current.wifiConnected != previous.wifiConnected) {
+    length += snprintf_P(out + length, size - length, PSTR("\"wifi_connected\":%s,"),
+                         current.wifiConnected ? "true" : "false");
+  }
+
+  if (length == fieldsStart || length + 4 > size) {
+    return 0;
+  }
+  // SmartIntercom Replace the trailing comma with the closing brace
+  length--;
+  length += snprintf_P(out + length, size - length, PSTR("}\n\n"));
+  return length;
+}
+
+/*
+ * SmartIntercomApi Update
+ * Рассылка изменений подписчикам; без изменений - только редкий keepalive
+ */
+void SmartIntercomApi::smartIntercomUpdate() {
+  if (smartIntercomServer == nullptr) {
+    return;
+  }
+
+  char frame[SMARTINTERCOM_API_FRAME_MAX];
+  size_t length = 0;
+  unsigned long now = smartIntercomMillis();
+
+  smartIntercomExpireOps(now);
+  if (smartIntercomOpsChanged && smartIntercomPushOps()) {
+    smartIntercomLastFrame = now;
+  }
+  if (smartIntercomChanged) {
+    smartIntercomChanged = false;
+    SmartIntercomApiLiveStatus current;
+    smartIntercomCapture(&current);
+    length = smartIntercomFormatFrame(smartIntercomPushed, current, false, frame, sizeof(frame));
+    smartIntercomPushed = current;
+  }
+  if (length == 0) {
+    if (now - smartIntercomLastFrame < SMARTINTERCOM_API_KEEPALIVE_MS) {
+      return;
+    }
+    // SmartIntercom SSE comment line: ignored by EventSource, detects dead connections
+    memcpy_P(frame, PSTR(":\n\n"), 4);
+    length = 3;
+  }
+  smartIntercomLastFrame = now;
+
+  if (smartIntercomServer->smartIntercomGetStreamCount() > 0) {
+    smartIntercomServer->smartIntercomBroadcast(frame, length);
+  }
+}
+
+// ============================================================================
+// SmartIntercomApi Route Handlers
+// ============================================================================
+
+/*
+ * SmartIntercomApi Handle Status
+ * Готовый JSON из снимка; клиент с актуальным ETag получает 304 без тела
+ */
+void SmartIntercomApi::smartIntercomHandleStatus(const SmartIntercomHttpRequest& request,
+                                                 SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomStatusSnapshot& snapshot = api->smartIntercomSnapshot;
+
+  size_t length = 0;
+  const char* json = snapshot.smartIntercomGetJson(&length);
+  response.smartIntercomAddHeader("ETag", snapshot.smartIntercomGetETag());
+  response.smartIntercomAddHeader("Cache-Control", "no-cache");
+  if (snapshot.smartIntercomMatches(request.ifNoneMatch)) {
+    response.smartIntercomSetStatus(304);
+    return;
+  }
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomWrite(json, length);
+}
+
+/*
+ * SmartIntercomApi Handle Events
+ * Подписка на живой статус: ответ text/event-stream остается открытым,
+ * первым кадром уходит полный статус, дальше - только изменения
+ */
+void SmartIntercomApi::smartIntercomHandleEvents(const SmartIntercomHttpRequest& request,
+                                                 SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  if (api->smartIntercomServer->smartIntercomGetStreamCount() >= SMARTINTERCOM_API_MAX_STREAMS) {
+    response.smartIntercomSend(503, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: слишком много подписчиков\"}");
+    return;
+  }
+
+  char* frame = static_cast<char*>(response.smartIntercomAllocate(SMARTINTERCOM_API_FRAME_MAX));
+  if (frame == nullptr) {
+    response.smartIntercomSend(503, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: нет памяти запроса\"}");
+    return;
+  }
+  SmartIntercomApiLiveStatus current;
+  api->smartIntercomCapture(&current);
+  size_t length = api->smartIntercomFormatFrame(current, current, true, frame, SMARTINTERCOM_API_FRAME_MAX);
+
+  response.smartIntercomBeginStream("text/event-stream");
+  response.smartIntercomAddHeader("Cache-Control", "no-cache");
+  response.smartIntercomWrite(frame, length);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Live status subscriber %u connected", request.connection);
+}
+
+/*
+ * SmartIntercomApi Handle Open
+ * Открытие SmartIntercom ставится в очередь, ответ 202 уходит сразу
+ *
+ * Запрос, пришедший, пока предыдущая операция ждет или дверь открыта,
+ * сливается с ней: импульс не перезапускается, возвращается тот же
+ * номер. Дверь, открытая звонком или MQTT, тоже не открывается
+ * повторно - операция сразу получает состояние running. Ожидающая
+ * операция без отложенного открытия (сброс) отменяется, а не принимает
+ * новые запросы; нет места в планировщике - ответ 503, операция cancelled.
+ */
+void SmartIntercomApi::smartIntercomHandleOpen(const SmartIntercomHttpRequest& request,
+                                               SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomApiOp* op = api->smartIntercomFindOp(api->smartIntercomLastOpId);
+  SmartIntercomDeviceState state = api->smartIntercomDevice->smartIntercomGetState();
+  bool doorOpen = state == SMARTINTERCOM_STATE_OPENING || state == SMARTINTERCOM_STATE_OPEN;
+  if (op != nullptr && op->state == SMARTINTERCOM_API_OP_QUEUED && !doorOpen &&
+      !api->smartIntercomDevice->smartIntercomIsOpenPending()) {
+    api->smartIntercomCancelOp(op);
+  }
+  bool coalesced = op != nullptr &&
+                   (op->state == SMARTINTERCOM_API_OP_QUEUED || op->state == SMARTINTERCOM_API_OP_RUNNING);
+  if (coalesced) {
+    op->requests++;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Door open request merged into operation %lu", (unsigned long)op->id);
+  } else {
+    uint32_t id = ++api->smartIntercomLastOpId;
+    if (id == 0) {
+      id = ++api->smartIntercomLastOpId;
+    }
+    op = &api->smartIntercomOps[id % SMARTINTERCOM_API_MAX_OPS];
+    op->id = id;
+    op->state = doorOpen ? SMARTINTERCOM_API_OP_RUNNING : SMARTINTERCOM_API_OP_QUEUED;
+    op->pushedState = SMARTINTERCOM_API_OP_STATES;
+    op->requests = 1;
+    op->acceptedMs = smartIntercomMillis();
+    op->openedMs = op->acceptedMs;
+    op->finishedMs = 0;
+    api->smartIntercomOpsChanged = true;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Manual door open requested via API, operation %lu", (unsigned long)id);
+    if (!doorOpen && !api->smartIntercomDevice->smartIntercomOpenDoorDelayed(0)) {
+      api->smartIntercomCancelOp(op);
+      response.smartIntercomSetStatus(503);
+      response.smartIntercomSetContentType("application/json");
+      response.smartIntercomPrintf(PSTR("{\"success\":false,\"message\":\"SmartIntercom: планировщик занят\","
+                                        "\"id\":%lu,\"state\":\"%s\"}"),
+                                   (unsigned long)op->id, smartIntercomGetOpStateName(op->state));
+      return;
+    }
+  }
+
+  char location[24];
+  snprintf_P(location, sizeof(location), PSTR("/api/ops/%lu"), (unsigned long)op->id);
+  response.smartIntercomAddHeader("Location", location);
+  response.smartIntercomSetStatus(202);
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomPrintf(PSTR("{\"success\":true,\"message\":\"SmartIntercom открывает дверь\","
+                                    "\"id\":%lu,\"state\":\"%s\",\"coalesced\":%s}"),
+                               (unsigned long)op->id, smartIntercomGetOpStateName(op->state),
+                               coalesced ? "true" : "false");
+}
+
+/*
+ * SmartIntercomApi Handle Get Op
+ * Состояние операции SmartIntercom /api/ops/{id}
+ */
+void SmartIntercomApi::smartIntercomHandleGetOp(const SmartIntercomHttpRequest& request,
+                                                SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  const char* digits = request.path + sizeof("/api/ops/") - 1;
+  char* end = nullptr;
+  unsigned long id = strtoul(digits, &end, 10);
+  SmartIntercomApiOp* op = end != digits && *end == '\0' ? api->smartIntercomFindOp((uint32_t)id) : nullptr;
+  if (op == nullptr) {
+    response.smartIntercomSend(404, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: операция не найдена\"}");
+    return;
+  }
+  char* json = static_cast<char*>(response.smartIntercomAllocate(SMARTINTERCOM_API_FRAME_MAX));
+  if (json == nullptr) {
+    response.smartIntercomSend(503, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: нет памяти запроса\"}");
+    return;
+  }
+  size_t length = api->smartIntercomFormatOp(*op, json, SMARTINTERCOM_API_FRAME_MAX);
+  response.smartIntercomAddHeader("Cache-Control", "no-cache");
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomWrite(json, length);
+}
+
+/*
+ * SmartIntercomApi Handle Get Config
+ */
+void SmartIntercomApi::smartIntercomHandleGetConfig(const SmartIntercomHttpRequest& request,
+                                                    SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomConfig config = api->smartIntercomDevice->smartIntercomGetConfig();
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomPrintf(PSTR("{\"auto_open\":%s,\"always_open\":%s,\"open_delay\":%d,\"led_brightness\":%d}"),
+                               config.autoOpenEnabled ? "true" : "false",
+                               config.alwaysOpenEnabled ? "true" : "false", config.openDelay,
+                               api->smartIntercomLedBrightness);
+}
+
+/*
+ * SmartIntercomApi Handle Set Config
+ * Изменяются только переданные ключи плоского JSON
+ */
+void SmartIntercomApi::smartIntercomHandleSetConfig(const SmartIntercomHttpRequest& request,
+                                                    SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  if (request.bodyLength == 0) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неверный запрос\"}");
+    return;
+  }
+
+  SmartIntercomConfig config = api->smartIntercomDevice->smartIntercomGetConfig();
+  smartIntercomApiGetBool(request.body, "auto_open", &config.autoOpenEnabled);
+  smartIntercomApiGetBool(request.body, "always_open", &config.alwaysOpenEnabled);
+  smartIntercomApiGetInt(request.body, "open_delay", &config.openDelay);
+  smartIntercomApiGetInt(request.body, "led_brightness", &api->smartIntercomLedBrightness);
+
+  api->smartIntercomDevice->smartIntercomSetConfig(config);
+  response.smartIntercomSend(200, "application/json",
+                             "{\"success\":true,\"message\":\"SmartIntercom конфигурация обновлена\"}");
+}
+
+/*
+ * SmartIntercomApi Handle Auto Open
+ */
+void SmartIntercomApi::smartIntercomHandleAutoOpen(const SmartIntercomHttpRequest& request,
+                                                   SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  api->smartIntercomDevice->smartIntercomToggleAutoOpen();
+  bool enabled = api->smartIntercomDevice->smartIntercomGetConfig().autoOpenEnabled;
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomPrintf(PSTR("{\"success\":true,\"auto_open\":%s,\"message\":\"%s\"}"),
+                               enabled ? "true" : "false",
+                               enabled ? "SmartIntercom: авто-открытие включено" : "SmartIntercom: авто-открытие выключено");
+}
+
+/*
+ * SmartIntercomApi Handle Stats
+ * Ряды статистики собираются генератором по частям (chunked), без буфера на весь ответ
+ */
+void SmartIntercomApi::smartIntercomHandleStats(const SmartIntercomHttpRequest& request,
+                                                SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomStats* stats = api->smartIntercomDevice->smartIntercomGetStats();
+  if (stats == nullptr) {
+    response.smartIntercomSend(503, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: статистика не подключена\"}");
+    return;
+  }
+  uint8_t ranges = smartIntercomApiStatsRanges(request.query);
+  if (ranges == 0) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неизвестный range\"}");
+    return;
+  }
+  response.smartIntercomSendGenerated(200, "application/json", SmartIntercomStats::smartIntercomWriteJson, stats,
+                                      SmartIntercomStats::smartIntercomJsonCursor(ranges));
+}
+
+/*
+ * SmartIntercomApi Handle Metrics
+ * Гистограммы задержек в текстовом формате Prometheus (chunked)
+ */
+void SmartIntercomApi::smartIntercomHandleMetrics(const SmartIntercomHttpRequest& request,
+                                                  SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomMetrics* metrics = api->smartIntercomDevice->smartIntercomGetMetrics();
+  if (metrics == nullptr) {
+    response.smartIntercomSend(503, "text/plain", "SmartIntercom: metrics not attached\n");
+    return;
+  }
+  response.smartIntercomSendGenerated(200, "text/plain; version=0.0.4", SmartIntercomMetrics::smartIntercomWritePrometheus,
+                                      metrics);
+}
+
+/*
+ * SmartIntercomApi Handle Get Lines
+ * Состояние всех линий SmartIntercom (chunked, по элементу на линию)
+ */
+void SmartIntercomApi::smartIntercomHandleGetLines(const SmartIntercomHttpRequest& request,
+                                                   SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  response.smartIntercomSendGenerated(200, "application/json", SmartIntercomLines::smartIntercomWriteJson,
+                                      api->smartIntercomLines);
+}
+
+/*
+ * SmartIntercomApi Handle Set Lines
+ * Команда одной линии SmartIntercom: {"line":N, ...}
+ *
+ * "open":true открывает замок линии, "open":false закрывает;
+ * auto_open, always_open, open_time и threshold меняют только
+ * переданные настройки линии.
+ */
+void SmartIntercomApi::smartIntercomHandleSetLines(const SmartIntercomHttpRequest& request,
+                                                   SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomLines* lines = api->smartIntercomLines;
+  int line = -1;
+  SmartIntercomLineConfig config;
+  if (request.bodyLength == 0 || !smartIntercomApiGetInt(request.body, "line", &line) || line < 0 ||
+      line >= SMARTINTERCOM_LINES || (lines->smartIntercomGetEnabledLines() & SMARTINTERCOM_LINE_BIT(line)) == 0 ||
+      !lines->smartIntercomGetLineConfig((uint8_t)line, &config)) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неизвестная линия\"}");
+    return;
+  }
+
+  smartIntercomApiGetBool(request.body, "auto_open", &config.autoOpenEnabled);
+  smartIntercomApiGetBool(request.body, "always_open", &config.alwaysOpenEnabled);
+  smartIntercomApiGetInt(request.body, "open_time", &config.openTime);
+  smartIntercomApiGetInt(request.body, "threshold", &config.onLevel);
+  lines->smartIntercomSetLineConfig((uint8_t)line, config);
+
+  bool open = false;
+  if (smartIntercomApiGetBool(request.body, "open", &open)) {
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Line %d %s requested via API", line, open ? "open" : "close");
+    if (open) {
+      lines->smartIntercomOpenDoor((uint8_t)line);
+    } else {
+      lines->smartIntercomCloseDoor((uint8_t)line);
+    }
+  }
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomPrintf(PSTR("{\"success\":true,\"line\":%d,\"open\":%s}"), line,
+                               (lines->smartIntercomGetOpenLines() & SMARTINTERCOM_LINE_BIT(line)) ? "true" : "false");
+}
+
+/*
+ * SmartIntercomApi Handle Get Trace
+ * Файл трассы SmartIntercom (chunked, по блоку за раз)
+ *
+ * Во время записи блоки меняются, поэтому сначала нужен stop.
+ */
+void SmartIntercomApi::smartIntercomHandleGetTrace(const SmartIntercomHttpRequest& request,
+                                                   SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  if (api->smartIntercomTrace->smartIntercomIsRecording()) {
+    response.smartIntercomSend(409, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: запись трассы идет, сначала stop\"}");
+    return;
+  }
+  response.smartIntercomAddHeader("Content-Disposition", "attachment; filename=\"smartintercom.sitr\"");
+  response.smartIntercomSendGenerated(200, "application/octet-stream", SmartIntercomTrace::smartIntercomWriteFile,
+                                      api->smartIntercomTrace);
+}
+
+/*
+ * SmartIntercomApi Handle Set Trace
+ * Управление записью трассы SmartIntercom: {"action":"start","mode":"ring"}
+ *
+ * action - start, stop, clear или status; mode для start - ring
+ * (кольцо последних блоков) или oneshot (до заполнения).
+ */
+void SmartIntercomApi::smartIntercomHandleSetTrace(const SmartIntercomHttpRequest& request,
+                                                   SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  SmartIntercomTrace* trace = api->smartIntercomTrace;
+  const char* body = request.bodyLength > 0 ? request.body : "";
+  if (smartIntercomApiIsString(body, "action", "start")) {
+    trace->smartIntercomStart(smartIntercomApiIsString(body, "mode", "oneshot") ? SMARTINTERCOM_TRACE_ONESHOT
+                                                                                 : SMARTINTERCOM_TRACE_RING);
+  } else if (smartIntercomApiIsString(body, "action", "stop")) {
+    trace->smartIntercomStop();
+  } else if (smartIntercomApiIsString(body, "action", "clear")) {
+    trace->smartIntercomClear();
+  } else if (!smartIntercomApiIsString(body, "action", "status")) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неизвестное действие\"}");
+    return;
+  }
+  response.smartIntercomSetContentType("application/json");
+  response.smartIntercomPrintf(PSTR("{\"success\":true,\"recording\":%s,\"samples\":%lu,\"blocks\":%lu,"
+                                    "\"capacity\":%lu,\"flash\":%s}"),
+                               trace->smartIntercomIsRecording() ? "true" : "false",
+                               (unsigned long)trace->smartIntercomGetSamples(),
+                               (unsigned long)trace->smartIntercomGetBlocks(),
+                               (unsigned long)trace->smartIntercomGetCapacityBlocks(),
+                               trace->smartIntercomHasFlash() ? "true" : "false");
+}
+
+/*
+ * SmartIntercomApi Handle Get Watchdog
+ * Профиль фаз и журнал зависаний SmartIntercom (chunked, по объекту за раз)
+ */
+void SmartIntercomApi::smartIntercomHandleGetWatchdog(const SmartIntercomHttpRequest& request,
+                                                      SmartIntercomHttpResponse& response, void* context) {
+  (void)request;
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  response.smartIntercomSendGenerated(200, "application/json", SmartIntercomWatchdog::smartIntercomWriteJson,
+                                      api->smartIntercomWatchdog);
+}
+
+/*
+ * SmartIntercomApi Handle Set Watchdog
+ * {"action":"clear"} - SmartIntercom начинает профиль и журнал заново
+ */
+void SmartIntercomApi::smartIntercomHandleSetWatchdog(const SmartIntercomHttpRequest& request,
+                                                      SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  const char* body = request.bodyLength > 0 ? request.body : "";
+  if (!smartIntercomApiIsString(body, "action", "clear")) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неизвестное действие\"}");
+    return;
+  }
+  api->smartIntercomWatchdog->smartIntercomClear();
+  response.smartIntercomSend(200, "application/json", "{\"success\":true}");
+}
+
+/*
+ * SmartIntercomApi Handle Get Heap
+ * Куча, ряд и высшие отметки SmartIntercom (chunked, по объекту за раз)
+ */
+void SmartIntercomApi::smartIntercomHandleGetHeap(const SmartIntercomHttpRequest& request,
+                                                  SmartIntercomHttpResponse& response, void* context) {
+  (void)request;
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  response.smartIntercomAddHeader("Cache-Control", "no-cache");
+  response.smartIntercomSendGenerated(200, "application/json", SmartIntercomHeap::smartIntercomWriteJson,
+                                      api->smartIntercomHeap);
+}
+
+/*
+ * SmartIntercomApi Handle Set Heap
+ * {"action":"clear"} - SmartIntercom начинает ряд и высшие отметки заново
+ */
+void SmartIntercomApi::smartIntercomHandleSetHeap(const SmartIntercomHttpRequest& request,
+                                                  SmartIntercomHttpResponse& response, void* context) {
+  SmartIntercomApi* api = static_cast<SmartIntercomApi*>(context);
+  const char* body = request.bodyLength > 0 ? request.body : "";
+  if (!smartIntercomApiIsString(body, "action", "clear")) {
+    response.smartIntercomSend(400, "application/json",
+                               "{\"success\":false,\"message\":\"SmartIntercom: неизвестное действие\"}");
+    return;
+  }
+  api->smartIntercomHeap->smartIntercomClear();
+  response.smartIntercomSend(200, "application/json", "{\"success\":true}");
+}
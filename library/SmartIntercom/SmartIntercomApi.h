@@ -0,0 +1,217 @@
+/*
+ * SmartIntercomApi.h - REST API SmartIntercom поверх SmartIntercomHttpServer
+ *
+ * Маршруты /api прошивки SmartIntercom Premium:
+ *
+ *   GET  /api/status     - статус из SmartIntercomStatusSnapshot (ETag, 304)
+ *   GET  /api/events     - живой статус (Server-Sent Events, только изменения)
+ *   POST /api/open       - открыть дверь (202 и номер операции сразу)
+ *   GET  /api/ops/{id}   - состояние операции открытия
+ *   GET  /api/config     - конфигурация
+ *   POST /api/config     - изменить конфигурацию (плоский JSON)
+ *   POST /api/auto-open  - переключить авто-открытие
+ *   GET  /api/stats      - статистика по минутам, часам и дням (?range=)
+ *   GET  /api/metrics    - гистограммы задержек (текстовый формат Prometheus)
+ *
+ * С подключенным многоканальным контроллером (smartIntercomAttachLines):
+ *
+ *   GET  /api/lines      - состояние и настройки всех линий
+ *   POST /api/lines      - открыть линию или изменить ее настройки
+ *
+ * С подключенной записью трассы АЦП (smartIntercomAttachTrace):
+ *
+ *   GET  /api/trace      - файл трассы .sitr (после остановки записи)
+ *   POST /api/trace      - start/stop/clear/status записи
+ *
+ * С подключенным сторожем главного цикла (smartIntercomAttachWatchdog):
+ *
+ *   GET  /api/watchdog   - профиль фаз loop() и журнал зависаний
+ *   POST /api/watchdog   - clear (сбросить профиль и журнал)
+ *
+ * С подключенным наблюдением за кучей (smartIntercomAttachHeap):
+ *
+ *   GET  /api/heap       - куча, ряд, высшие отметки фаз и арена запроса
+ *   POST /api/heap       - clear (начать ряд и отметки заново)
+ *
+ * Обработчики не зависят от платформы и собираются и в прошивке,
+ * и на хосте (host/net, нагрузочное тестирование на Linux).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_API_H
+#define SMARTINTERCOM_API_H
+
+#include <Arduino.h>
+#include "SmartIntercom.h"
+#include "SmartIntercomHttp.h"
+#include "SmartIntercomStatus.h"
+#include "SmartIntercomLines.h"
+#include "SmartIntercomTrace.h"
+#include "SmartIntercomWatchdog.h"
+#include "SmartIntercomHeap.h"
+
+// SmartIntercom Live Status Configuration (Server-Sent Events)
+#ifndef SMARTINTERCOM_API_MAX_STREAMS
+#define SMARTINTERCOM_API_MAX_STREAMS 3
+#endif
+
+#define SMARTINTERCOM_API_KEEPALIVE_MS 15000
+#define SMARTINTERCOM_API_FRAME_MAX 256
+
+// SmartIntercom Door Operations (последние операции /api/open для /api/ops/{id})
+#ifndef SMARTINTERCOM_API_MAX_OPS
+#define SMARTINTERCOM_API_MAX_OPS 8
+#endif
+#ifndef SMARTINTERCOM_API_OP_QUEUE_TIMEOUT_MS
+#define SMARTINTERCOM_API_OP_QUEUE_TIMEOUT_MS 10000  // Операция в очереди дольше - отменена
+#endif
+
+// SmartIntercom Operation States
+enum SmartIntercomApiOpState {
+  SMARTINTERCOM_API_OP_QUEUED,      // SmartIntercom принята, дверь еще не открыта
+  SMARTINTERCOM_API_OP_RUNNING,     // SmartIntercom дверь открыта
+  SMARTINTERCOM_API_OP_DONE,        // SmartIntercom дверь снова закрыта
+  SMARTINTERCOM_API_OP_CANCELLED,   // SmartIntercom закрыта, сброшена или не открылась до открытия
+  SMARTINTERCOM_API_OP_STATES
+};
+
+/*
+ * SmartIntercomApiProbe - Опрос внешнего состояния для SmartIntercom API
+ *
+ * Например, подключена ли станция WiFi; вызывается только при
+ * пересборке статуса, а не на каждый запрос.
+ */
+typedef bool (*SmartIntercomApiProbe)(void* context);
+
+/*
+ * SmartIntercomApi - Обработчики REST API SmartIntercom
+ */
+class SmartIntercomApi {
+private:
+  // SmartIntercom Live Status Fields (то, что уже отправлено подписчикам)
+  struct SmartIntercomApiLiveStatus {
+    SmartIntercomDeviceState state;
+    bool autoOpen;
+    bool wifiConnected;
+  };
+
+  // SmartIntercom Door Operation (одно открытие и все запросы, слитые с ним)
+  struct SmartIntercomApiOp {
+    uint32_t id;
+    uint8_t state;
+    uint8_t pushedState;
+    uint16_t requests;
+    unsigned long acceptedMs;
+    unsigned long openedMs;
+    unsigned long finishedMs;
+  };
+
+  SmartIntercom* smartIntercomDevice;
+  SmartIntercomLines* smartIntercomLines;
+  SmartIntercomTrace* smartIntercomTrace;
+  SmartIntercomWatchdog* smartIntercomWatchdog;
+  SmartIntercomHeap* smartIntercomHeap;
+  SmartIntercomHttpServer* smartIntercomServer;
+  const char* smartIntercomDeviceName;
+  const char* smartIntercomVersion;
+  SmartIntercomApiProbe smartIntercomWifiProbe;
+  void* smartIntercomWifiContext;
+  int smartIntercomLedBrightness;
+
+  // SmartIntercom Status Caching and Push
+  SmartIntercomStatusSnapshot smartIntercomSnapshot;
+  SmartIntercomApiLiveStatus smartIntercomPushed;
+  volatile bool smartIntercomChanged;
+  unsigned long smartIntercomLastFrame;
+
+  // SmartIntercom Door Operations
+  SmartIntercomApiOp smartIntercomOps[SMARTINTERCOM_API_MAX_OPS];
+  uint32_t smartIntercomLastOpId;
+  bool smartIntercomOpsChanged;
+
+  // SmartIntercom Internal Methods
+  bool smartIntercomIsWifiConnected();
+  void smartIntercomCapture(SmartIntercomApiLiveStatus* status);
+  size_t smartIntercomFormatFrame(const SmartIntercomApiLiveStatus& previous, const SmartIntercomApiLiveStatus& current,
+                                  bool full, char* out, size_t size);
+  static size_t smartIntercomWriteStatus(char* out, size_t size, void* context);
+  SmartIntercomApiOp* smartIntercomFindOp(uint32_t id);
+  void smartIntercomCancelOp(SmartIntercomApiOp* op);
+  void smartIntercomExpireOps(unsigned long now);
+  size_t smartIntercomFormatOp(const SmartIntercomApiOp& op, char* out, size_t size);
+  bool smartIntercomPushOps();
+  static void smartIntercomHandleDeviceEvent(const SmartIntercomEvent& event, void* context);
+
+  // SmartIntercom Route Handlers
+  static void smartIntercomHandleStatus(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                        void* context);
+  static void smartIntercomHandleEvents(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                        void* context);
+  static void smartIntercomHandleOpen(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                      void* context);
+  static void smartIntercomHandleGetOp(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                       void* context);
+  static void smartIntercomHandleGetConfig(const SmartIntercomHttpRequest& request,
+                                           SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleSetConfig(const SmartIntercomHttpRequest& request,
+                                           SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleAutoOpen(const SmartIntercomHttpRequest& request,
+                                          SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleStats(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                       void* context);
+  static void smartIntercomHandleMetrics(const SmartIntercomHttpRequest& request,
+                                         SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleGetLines(const SmartIntercomHttpRequest& request,
+                                          SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleSetLines(const SmartIntercomHttpRequest& request,
+                                          SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleGetTrace(const SmartIntercomHttpRequest& request,
+                                          SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleSetTrace(const SmartIntercomHttpRequest& request,
+                                          SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleGetWatchdog(const SmartIntercomHttpRequest& request,
+                                             SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleSetWatchdog(const SmartIntercomHttpRequest& request,
+                                             SmartIntercomHttpResponse& response, void* context);
+  static void smartIntercomHandleGetHeap(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                         void* context);
+  static void smartIntercomHandleSetHeap(const SmartIntercomHttpRequest& request, SmartIntercomHttpResponse& response,
+                                         void* context);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomApi();
+
+  // SmartIntercom Initialization (регистрирует маршруты /api)
+  void smartIntercomBegin(SmartIntercom& intercom, SmartIntercomHttpServer& server, const char* deviceName,
+                          const char* version);
+  void smartIntercomSetWifiProbe(SmartIntercomApiProbe probe, void* context);
+
+  // SmartIntercom Multi-Line Routes (/api/lines, после smartIntercomBegin)
+  void smartIntercomAttachLines(SmartIntercomLines& lines);
+
+  // SmartIntercom ADC Trace Routes (/api/trace, после smartIntercomBegin)
+  void smartIntercomAttachTrace(SmartIntercomTrace& trace);
+
+  // SmartIntercom Loop Watchdog Routes (/api/watchdog, после smartIntercomBegin)
+  void smartIntercomAttachWatchdog(SmartIntercomWatchdog& watchdog);
+
+  // SmartIntercom Heap Routes (/api/heap, после smartIntercomBegin; подключает арену сервера)
+  void smartIntercomAttachHeap(SmartIntercomHeap& heap);
+
+  // SmartIntercom Change Notification (события библиотеки Api отмечает сам; WiFi и прочее - скетч)
+  void smartIntercomMarkChanged();
+
+  // SmartIntercom Main Loop (рассылка изменений и keepalive подписчикам)
+  void smartIntercomUpdate();
+
+  // SmartIntercom API State
+  SmartIntercomStatusSnapshot& smartIntercomGetSnapshot() { return smartIntercomSnapshot; }
+  int smartIntercomGetLedBrightness() { return smartIntercomLedBrightness; }
+  static const char* smartIntercomGetStateLabel(SmartIntercomDeviceState state);
+  static const char* smartIntercomGetOpStateName(uint8_t state);
+};
+
+#endif // SMARTINTERCOM_API_H
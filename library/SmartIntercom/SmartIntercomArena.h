@@ -0,0 +1,84 @@
+/*
+ * SmartIntercomArena.h - Арена запроса SmartIntercom
+ *
+ * Линейный (bump) распределитель поверх фиксированного буфера:
+ * выделение - сдвиг указателя с выравниванием, освобождения по одному
+ * блоку нет, вся арена сбрасывается разом. SmartIntercomHttpServer
+ * держит одну арену и сбрасывает ее после каждого ответа, поэтому
+ * обработчики берут из нее временную память запроса (кадры JSON,
+ * разобранные значения) без общей кучи и без больших массивов на
+ * стеке ядра (4 КБ на ESP8266).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_ARENA_H
+#define SMARTINTERCOM_ARENA_H
+
+#include <Arduino.h>
+
+// SmartIntercom Arena Alignment (uint32_t и указатели)
+#define SMARTINTERCOM_ARENA_ALIGN 4
+
+/*
+ * SmartIntercomArena - Линейная арена SmartIntercom
+ */
+class SmartIntercomArena {
+private:
+  uint8_t* smartIntercomBuffer;
+  size_t smartIntercomCapacity;
+  size_t smartIntercomUsed;
+  size_t smartIntercomHighWater;
+  uint32_t smartIntercomFailures;
+
+public:
+  // SmartIntercom Constructor (без буфера любое выделение неудачно)
+  SmartIntercomArena() {
+    smartIntercomBuffer = nullptr;
+    smartIntercomCapacity = 0;
+    smartIntercomUsed = 0;
+    smartIntercomHighWater = 0;
+    smartIntercomFailures = 0;
+  }
+
+  // SmartIntercom Initialization (буфер выровнен на SMARTINTERCOM_ARENA_ALIGN)
+  void smartIntercomBegin(void* buffer, size_t capacity) {
+    smartIntercomBuffer = static_cast<uint8_t*>(buffer);
+    smartIntercomCapacity = buffer != nullptr ? capacity : 0;
+    smartIntercomUsed = 0;
+  }
+
+  /*
+   * SmartIntercomArena Allocate
+   * size байт SmartIntercom до следующего smartIntercomReset(); nullptr - арена заполнена
+   */
+  void* smartIntercomAllocate(size_t size) {
+    size_t aligned = (size + SMARTINTERCOM_ARENA_ALIGN - 1) & ~(size_t)(SMARTINTERCOM_ARENA_ALIGN - 1);
+    if (aligned < size || aligned > smartIntercomCapacity - smartIntercomUsed) {
+      smartIntercomFailures++;
+      return nullptr;
+    }
+    void* block = smartIntercomBuffer + smartIntercomUsed;
+    smartIntercomUsed += aligned;
+    if (smartIntercomUsed > smartIntercomHighWater) {
+      smartIntercomHighWater = smartIntercomUsed;
+    }
+    return block;
+  }
+
+  // SmartIntercom Release all blocks at once
+  void smartIntercomReset() { smartIntercomUsed = 0; }
+
+  // SmartIntercom Arena Statistics
+  size_t smartIntercomGetCapacity() const { return smartIntercomCapacity; }
+  size_t smartIntercomGetUsed() const { return smartIntercomUsed; }
+  size_t smartIntercomGetHighWater() const { return smartIntercomHighWater; }
+  uint32_t smartIntercomGetFailures() const { return smartIntercomFailures; }
+  void smartIntercomClearStats() {
+    smartIntercomHighWater = smartIntercomUsed;
+    smartIntercomFailures = 0;
+  }
+};
+
+#endif // SMARTINTERCOM_ARENA_H
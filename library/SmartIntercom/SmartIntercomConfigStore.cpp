@@ -0,0 +1,425 @@
+/*
+ * SmartIntercomConfigStore.cpp - Реализация журнала конфигурации SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomConfigStore.h"
+#include "SmartIntercom.h"
+
+// SmartIntercom Journal Layout Checks
+static_assert(SMARTINTERCOM_STORE_RECORD_SIZE % 4 == 0, "SmartIntercom: record size must be word aligned");
+static_assert(SMARTINTERCOM_STORE_HEADER_SIZE % 4 == 0, "SmartIntercom: header size must be word aligned");
+
+#define SMARTINTERCOM_STORE_FLAG_AUTO_OPEN 0x01
+#define SMARTINTERCOM_STORE_FLAG_ALWAYS_OPEN 0x02
+#define SMARTINTERCOM_STORE_WRITE_ATTEMPTS 3
+
+// ============================================================================
+// SmartIntercom ESP8266 Flash
+// ============================================================================
+
+#ifdef ESP8266
+extern "C" uint32_t _EEPROM_start;
+extern "C" uint32_t _FS_start;
+extern "C" uint32_t _FS_end;
+
+/*
+ * SmartIntercomFlashESP8266 Constructor
+ * Номер сектора EEPROM берется из карты памяти ядра (как в EEPROM.cpp)
+ */
+SmartIntercomFlashESP8266::SmartIntercomFlashESP8266() {
+  smartIntercomFirstSector = ((uint32_t)&_EEPROM_start - 0x40200000) / SPI_FLASH_SEC_SIZE;
+  smartIntercomSectorCount = 1;
+}
+
+/*
+ * SmartIntercomFlashESP8266 Constructor
+ * fsTailSectors секторов в конце области FS перед skipSectors последними
+ * (0 секторов, если FS в карте памяти нет или она меньше)
+ */
+SmartIntercomFlashESP8266::SmartIntercomFlashESP8266(uint16_t fsTailSectors, uint16_t skipSectors) {
+  uint32_t fsStart = ((uint32_t)&_FS_start - 0x40200000) / SPI_FLASH_SEC_SIZE;
+  uint32_t fsEnd = ((uint32_t)&_FS_end - 0x40200000) / SPI_FLASH_SEC_SIZE;
+  uint32_t available = fsEnd > fsStart ? fsEnd - fsStart : 0;
+  smartIntercomSectorCount = available >= (uint32_t)fsTailSectors + skipSectors ? fsTailSectors : 0;
+  smartIntercomFirstSector = fsEnd - skipSectors - smartIntercomSectorCount;
+}
+
+uint32_t SmartIntercomFlashESP8266::smartIntercomGetSectorSize() {
+  return SPI_FLASH_SEC_SIZE;
+}
+
+bool SmartIntercomFlashESP8266::smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) {
+  return ESP.flashRead((smartIntercomFirstSector + sector) * SPI_FLASH_SEC_SIZE + offset, data, length);
+}
+
+bool SmartIntercomFlashESP8266::smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data,
+                                                   size_t length) {
+  return ESP.flashWrite((smartIntercomFirstSector + sector) * SPI_FLASH_SEC_SIZE + offset,
+                        const_cast<uint32_t*>(data), length);
+}
+
+bool SmartIntercomFlashESP8266::smartIntercomErase(uint16_t sector) {
+  return ESP.flashEraseSector(smartIntercomFirstSector + sector);
+}
+#endif
+
+// ============================================================================
+// SmartIntercom Config Store
+// ============================================================================
+
+/*
+ * SmartIntercomConfigStore Constructor
+ */
+SmartIntercomConfigStore::SmartIntercomConfigStore() {
+  static_assert(sizeof(SmartIntercomStoreRecord) == SMARTINTERCOM_STORE_RECORD_SIZE,
+                "SmartIntercom: journal record layout changed");
+  smartIntercomFlash = nullptr;
+  smartIntercomSector = 0;
+  smartIntercomSectorGeneration = 0;
+  smartIntercomWriteOffset = 0;
+  smartIntercomSequence = 0;
+  memset(&smartIntercomCommitted, 0, sizeof(smartIntercomCommitted));
+  smartIntercomHasCommitted = false;
+  memset(&smartIntercomPending, 0, sizeof(smartIntercomPending));
+  smartIntercomHasPending = false;
+  smartIntercomFirstRequest = 0;
+  smartIntercomLastRequest = 0;
+  smartIntercomCommits = 0;
+  smartIntercomErases = 0;
+  smartIntercomCoalesced = 0;
+  smartIntercomReplayed = 0;
+}
+
+/*
+ * SmartIntercomConfigStore Crc32
+ * CRC-32 (IEEE) SmartIntercom, побитно - записи журнала всего 28 байт
+ */
+uint32_t SmartIntercomConfigStore::smartIntercomCrc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/*
+ * SmartIntercomConfigStore Encode
+ */
+void SmartIntercomConfigStore::smartIntercomEncode(const SmartIntercomConfig& config,
+                                                   SmartIntercomStoreRecord* record) {
+  memset(record, 0, sizeof(*record));
+  record->magic = SMARTINTERCOM_STORE_RECORD_MAGIC;
+  record->type = SMARTINTERCOM_STORE_RECORD_CONFIG;
+  record->length = (uint8_t)(offsetof(SmartIntercomStoreRecord, crc) - offsetof(SmartIntercomStoreRecord, openTime));
+  record->openTime = config.openTime;
+  record->debounceTime = config.debounceTime;
+  record->ringTimeout = config.ringTimeout;
+  record->openDelay = config.openDelay;
+  record->flags = (config.autoOpenEnabled ? SMARTINTERCOM_STORE_FLAG_AUTO_OPEN : 0) |
+                  (config.alwaysOpenEnabled ? SMARTINTERCOM_STORE_FLAG_ALWAYS_OPEN : 0);
+  record->gpioMode = (uint8_t)config.gpioMode;
+}
+
+/*
+ * SmartIntercomConfigStore Same Payload
+ * Совпадают ли настройки двух записей SmartIntercom (без номера и CRC)
+ */
+bool SmartIntercomConfigStore::smartIntercomSamePayload(const SmartIntercomStoreRecord& a,
+                                                        const SmartIntercomStoreRecord& b) {
+  size_t start = offsetof(SmartIntercomStoreRecord, openTime);
+  size_t end = offsetof(SmartIntercomStoreRecord, crc);
+  return memcmp((const uint8_t*)&a + start, (const uint8_t*)&b + start, end - start) == 0;
+}
+
+/*
+ * SmartIntercomConfigStore Begin
+ * Восстановление журнала SmartIntercom при загрузке
+ *
+ * Сектора перебираются от нового поколения к старому; действует
+ * последняя верная запись первого сектора, где она нашлась. Сектор
+ * с заголовком, но без записей (питание пропало при переносе),
+ * пропускается, а старый сектор остается источником конфигурации.
+ */
+bool SmartIntercomConfigStore::smartIntercomBegin(SmartIntercomFlash* flash) {
+  smartIntercomFlash = flash;
+  smartIntercomHasCommitted = false;
+  smartIntercomWriteOffset = 0;
+  smartIntercomReplayed = 0;
+  if (flash == nullptr || flash->smartIntercomGetSectorCount() == 0) {
+    return false;
+  }
+
+  uint16_t sectors = flash->smartIntercomGetSectorCount();
+  uint32_t upperBound = 0xFFFFFFFFUL;
+  for (uint16_t pass = 0; pass < sectors; pass++) {
+    // SmartIntercom Newest sector generation below the previous pass
+    bool found = false;
+    uint16_t newest = 0;
+    uint32_t newestGeneration = 0;
+    for (uint16_t sector = 0; sector < sectors; sector++) {
+      uint32_t generation;
+      if (smartIntercomReadHeader(sector, &generation) && generation < upperBound &&
+          (!found || generation > newestGeneration)) {
+        found = true;
+        newest = sector;
+        newestGeneration = generation;
+      }
+    }
+    if (!found) {
+      break;
+    }
+    upperBound = newestGeneration;
+    if (smartIntercomReplaySector(newest)) {
+      smartIntercomSector = newest;
+      smartIntercomSectorGeneration = newestGeneration;
+      smartIntercomHasCommitted = true;
+      smartIntercomSequence = smartIntercomCommitted.sequence;
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: Config journal replayed (%u records, sequence %lu)",
+                             smartIntercomReplayed, (unsigned long)smartIntercomSequence);
+      return true;
+    }
+  }
+
+  smartIntercomWriteOffset = 0;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Config journal empty, using defaults");
+  return false;
+}
+
+/*
+ * SmartIntercomConfigStore Read Header
+ */
+bool SmartIntercomConfigStore::smartIntercomReadHeader(uint16_t sector, uint32_t* generation) {
+  uint32_t header[SMARTINTERCOM_STORE_HEADER_SIZE / 4];
+  if (!smartIntercomFlash->smartIntercomRead(sector, 0, header, sizeof(header))) {
+    return false;
+  }
+  if (header[0] != SMARTINTERCOM_STORE_SECTOR_MAGIC || header[1] == 0xFFFFFFFFUL) {
+    return false;
+  }
+  *generation = header[1];
+  return true;
+}
+
+/*
+ * SmartIntercomConfigStore Replay Sector
+ * Один проход по записям сектора SmartIntercom до первого чистого слота
+ */
+bool SmartIntercomConfigStore::smartIntercomReplaySector(uint16_t sector) {
+  uint32_t sectorSize = smartIntercomFlash->smartIntercomGetSectorSize();
+  uint32_t offset = SMARTINTERCOM_STORE_HEADER_SIZE;
+  bool found = false;
+  SmartIntercomStoreRecord record;
+
+  while (offset + SMARTINTERCOM_STORE_RECORD_SIZE <= sectorSize) {
+    if (!smartIntercomFlash->smartIntercomRead(sector, offset, (uint32_t*)&record, sizeof(record))) {
+      break;
+    }
+    const uint32_t* words = (const uint32_t*)&record;
+    bool erased = true;
+    for (size_t i = 0; i < sizeof(record) / 4; i++) {
+      erased = erased && words[i] == 0xFFFFFFFFUL;
+    }
+    if (erased) {
+      break;
+    }
+    smartIntercomReplayed++;
+
+    // SmartIntercom Torn or foreign records are skipped, their slot stays used
+    if (record.magic == SMARTINTERCOM_STORE_RECORD_MAGIC && record.type == SMARTINTERCOM_STORE_RECORD_CONFIG &&
+        record.crc == smartIntercomCrc32((const uint8_t*)&record, offsetof(SmartIntercomStoreRecord, crc))) {
+      smartIntercomCommitted = record;
+      found = true;
+    }
+    offset += SMARTINTERCOM_STORE_RECORD_SIZE;
+  }
+
+  smartIntercomWriteOffset = offset;
+  return found;
+}
+
+/*
+ * SmartIntercomConfigStore Slot Erased
+ */
+bool SmartIntercomConfigStore::smartIntercomSlotErased(uint32_t offset) {
+  uint32_t words[SMARTINTERCOM_STORE_RECORD_SIZE / 4];
+  if (!smartIntercomFlash->smartIntercomRead(smartIntercomSector, offset, words, sizeof(words))) {
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(words) / 4; i++) {
+    if (words[i] != 0xFFFFFFFFUL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * SmartIntercomConfigStore Start Sector
+ * Стереть сектор SmartIntercom и записать заголовок нового поколения
+ */
+bool SmartIntercomConfigStore::smartIntercomStartSector(uint16_t sector, uint32_t generation) {
+  smartIntercomErases++;
+  if (!smartIntercomFlash->smartIntercomErase(sector)) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Config sector %u erase failed", sector);
+    return false;
+  }
+  uint32_t header[SMARTINTERCOM_STORE_HEADER_SIZE / 4] = { SMARTINTERCOM_STORE_SECTOR_MAGIC, generation };
+  if (!smartIntercomFlash->smartIntercomWrite(sector, 0, header, sizeof(header))) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Config sector %u header write failed", sector);
+    return false;
+  }
+  smartIntercomSector = sector;
+  smartIntercomSectorGeneration = generation;
+  smartIntercomWriteOffset = SMARTINTERCOM_STORE_HEADER_SIZE;
+  return true;
+}
+
+/*
+ * SmartIntercomConfigStore Append
+ * Дописать запись SmartIntercom; при заполнении - перейти в следующий сектор
+ *
+ * Записанное сразу читается обратно: слот с ошибкой записи
+ * пропускается, как оборванная запись при загрузке.
+ */
+bool SmartIntercomConfigStore::smartIntercomAppend(SmartIntercomStoreRecord* record) {
+  uint32_t sectorSize = smartIntercomFlash->smartIntercomGetSectorSize();
+  uint16_t sectors = smartIntercomFlash->smartIntercomGetSectorCount();
+
+  record->sequence = smartIntercomSequence + 1;
+  record->crc = smartIntercomCrc32((const uint8_t*)record, offsetof(SmartIntercomStoreRecord, crc));
+
+  uint8_t failures = 0;
+  while (failures < SMARTINTERCOM_STORE_WRITE_ATTEMPTS) {
+    if (smartIntercomWriteOffset == 0 || smartIntercomWriteOffset + SMARTINTERCOM_STORE_RECORD_SIZE > sectorSize) {
+      uint16_t next = smartIntercomWriteOffset == 0 ? 0 : (uint16_t)((smartIntercomSector + 1) % sectors);
+      if (!smartIntercomStartSector(next, smartIntercomSectorGeneration + 1)) {
+        smartIntercomWriteOffset = 0;
+        failures++;
+        continue;
+      }
+    }
+
+    uint32_t offset = smartIntercomWriteOffset;
+    smartIntercomWriteOffset += SMARTINTERCOM_STORE_RECORD_SIZE;
+    if (!smartIntercomSlotErased(offset)) {
+      continue;
+    }
+
+    SmartIntercomStoreRecord verify;
+    if (smartIntercomFlash->smartIntercomWrite(smartIntercomSector, offset, (const uint32_t*)record, sizeof(*record)) &&
+        smartIntercomFlash->smartIntercomRead(smartIntercomSector, offset, (uint32_t*)&verify, sizeof(verify)) &&
+        memcmp(&verify, record, sizeof(verify)) == 0) {
+      smartIntercomSequence = record->sequence;
+      return true;
+    }
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Config record at %lu failed verification", (unsigned long)offset);
+    failures++;
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomConfigStore Load
+ * Применить сохраненные настройки SmartIntercom поверх config
+ */
+bool SmartIntercomConfigStore::smartIntercomLoad(SmartIntercomConfig* config) {
+  if (!smartIntercomHasCommitted) {
+    return false;
+  }
+  const SmartIntercomStoreRecord& record = smartIntercomCommitted;
+  config->openTime = record.openTime;
+  config->debounceTime = record.debounceTime;
+  config->ringTimeout = record.ringTimeout;
+  config->openDelay = record.openDelay;
+  config->autoOpenEnabled = (record.flags & SMARTINTERCOM_STORE_FLAG_AUTO_OPEN) != 0;
+  config->alwaysOpenEnabled = (record.flags & SMARTINTERCOM_STORE_FLAG_ALWAYS_OPEN) != 0;
+  config->gpioMode = (SmartIntercomGPIOMode)record.gpioMode;
+  return true;
+}
+
+/*
+ * SmartIntercomConfigStore Request Save
+ * Запомнить конфигурацию SmartIntercom для отложенной записи
+ *
+ * Изменения в пределах окна объединяются в одну запись, а возврат
+ * к уже записанной конфигурации отменяет запись совсем.
+ */
+void SmartIntercomConfigStore::smartIntercomRequestSave(const SmartIntercomConfig& config) {
+  if (smartIntercomFlash == nullptr) {
+    return;
+  }
+  SmartIntercomStoreRecord record;
+  smartIntercomEncode(config, &record);
+
+  if (smartIntercomHasCommitted && smartIntercomSamePayload(record, smartIntercomCommitted)) {
+    if (smartIntercomHasPending) {
+      smartIntercomHasPending = false;
+      smartIntercomCoalesced++;
+    }
+    return;
+  }
+
+  unsigned long now = smartIntercomMillis();
+  if (smartIntercomHasPending) {
+    smartIntercomCoalesced++;
+  } else {
+    smartIntercomFirstRequest = now;
+  }
+  smartIntercomPending = record;
+  smartIntercomHasPending = true;
+  smartIntercomLastRequest = now;
+}
+
+/*
+ * SmartIntercomConfigStore Is Commit Due
+ */
+bool SmartIntercomConfigStore::smartIntercomIsCommitDue() {
+  if (!smartIntercomHasPending) {
+    return false;
+  }
+  unsigned long now = smartIntercomMillis();
+  return now - smartIntercomLastRequest >= SMARTINTERCOM_STORE_COALESCE_MS ||
+         now - smartIntercomFirstRequest >= SMARTINTERCOM_STORE_MAX_DEFER_MS;
+}
+
+/*
+ * SmartIntercomConfigStore Get Commit Deadline
+ * Когда отложенная запись SmartIntercom станет обязательной (при smartIntercomIsPending())
+ */
+unsigned long SmartIntercomConfigStore::smartIntercomGetCommitDeadline() {
+  unsigned long quiet = smartIntercomLastRequest + SMARTINTERCOM_STORE_COALESCE_MS;
+  unsigned long forced = smartIntercomFirstRequest + SMARTINTERCOM_STORE_MAX_DEFER_MS;
+  return (long)(forced - quiet) < 0 ? forced : quiet;
+}
+
+/*
+ * SmartIntercomConfigStore Commit
+ * Записать отложенную конфигурацию SmartIntercom в журнал
+ * (при ошибке запись остается отложенной и повторяется через окно слияния)
+ */
+bool SmartIntercomConfigStore::smartIntercomCommit() {
+  if (!smartIntercomHasPending) {
+    return true;
+  }
+
+  SmartIntercomStoreRecord record = smartIntercomPending;
+  if (!smartIntercomAppend(&record)) {
+    // SmartIntercom Keep the change and re-arm the deadline instead of retrying every loop()
+    smartIntercomFirstRequest = smartIntercomLastRequest = smartIntercomMillis();
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Config save failed, retrying later");
+    return false;
+  }
+  smartIntercomHasPending = false;
+  smartIntercomCommitted = record;
+  smartIntercomHasCommitted = true;
+  smartIntercomCommits++;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Config saved (record %lu, sector %u)",
+                         (unsigned long)record.sequence, smartIntercomSector);
+  return true;
+}
@@ -0,0 +1,176 @@
+/*
+ * SmartIntercomConfigStore.h - Журнал конфигурации SmartIntercom во флеш-памяти
+ *
+ * Конфигурация хранится не перезаписью сектора, а журналом: каждое
+ * сохранение дописывает в сектор запись фиксированного размера с
+ * номером и CRC32, стирание нужно только когда сектор заполнен.
+ * При загрузке журнал читается один раз (не больше записей одного
+ * сектора), и действует последняя запись с верной CRC - оборванная
+ * при пропадании питания запись просто пропускается.
+ *
+ * Частые изменения (автоматизации, переключающие авто-открытие)
+ * объединяются: запись выполняется после паузы в изменениях, а
+ * совпадающая с уже записанной конфигурация не пишется вовсе.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_CONFIG_STORE_H
+#define SMARTINTERCOM_CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Config Store Configuration
+#ifndef SMARTINTERCOM_STORE_COALESCE_MS
+#define SMARTINTERCOM_STORE_COALESCE_MS 2000     // Пауза в изменениях перед записью (мс)
+#endif
+
+#ifndef SMARTINTERCOM_STORE_MAX_DEFER_MS
+#define SMARTINTERCOM_STORE_MAX_DEFER_MS 30000   // Предельная задержка записи при непрерывных изменениях (мс)
+#endif
+
+#define SMARTINTERCOM_STORE_SECTOR_MAGIC 0x4A495331UL  // "SIJ1"
+#define SMARTINTERCOM_STORE_RECORD_MAGIC 0x5343
+#define SMARTINTERCOM_STORE_RECORD_CONFIG 1
+#define SMARTINTERCOM_STORE_HEADER_SIZE 8
+#define SMARTINTERCOM_STORE_RECORD_SIZE 32
+
+struct SmartIntercomConfig;
+
+/*
+ * SmartIntercomFlash - Флеш-память для журнала SmartIntercom
+ *
+ * Семантика NOR: стирание переводит сектор в 0xFF, запись только
+ * сбрасывает биты. Смещения и длины кратны 4 байтам.
+ */
+class SmartIntercomFlash {
+public:
+  virtual ~SmartIntercomFlash() {}
+
+  virtual uint16_t smartIntercomGetSectorCount() = 0;
+  virtual uint32_t smartIntercomGetSectorSize() = 0;
+  virtual bool smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) = 0;
+  virtual bool smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data, size_t length) = 0;
+  virtual bool smartIntercomErase(uint16_t sector) = 0;
+};
+
+#ifdef ESP8266
+/*
+ * SmartIntercomFlashESP8266 - Сектор EEPROM ESP8266 для журнала SmartIntercom
+ *
+ * Использует сектор, который ядро выделяет под эмуляцию EEPROM,
+ * напрямую через ESP.flashRead/Write/EraseSector, без копии сектора
+ * в RAM и без стирания на каждый EEPROM.commit().
+ *
+ * Конструктор с числом секторов берет последние сектора области
+ * файловой системы (прошивка SmartIntercom ее не монтирует) - там
+ * хранятся снимки статистики. skipSectors отступает от конца области,
+ * чтобы несколько хранилищ (статистика, трасса АЦП) не пересекались.
+ */
+class SmartIntercomFlashESP8266 : public SmartIntercomFlash {
+private:
+  uint32_t smartIntercomFirstSector;
+  uint16_t smartIntercomSectorCount;
+
+public:
+  SmartIntercomFlashESP8266();
+  explicit SmartIntercomFlashESP8266(uint16_t fsTailSectors, uint16_t skipSectors = 0);
+
+  uint16_t smartIntercomGetSectorCount() override { return smartIntercomSectorCount; }
+  uint32_t smartIntercomGetSectorSize() override;
+  bool smartIntercomRead(uint16_t sector, uint32_t offset, uint32_t* data, size_t length) override;
+  bool smartIntercomWrite(uint16_t sector, uint32_t offset, const uint32_t* data, size_t length) override;
+  bool smartIntercomErase(uint16_t sector) override;
+};
+#endif
+
+/*
+ * SmartIntercomConfigStore - Журнал конфигурации SmartIntercom
+ *
+ * Хранятся настройки, меняемые во время работы (времена, флаги
+ * открытия, режим GPIO); номера пинов задаются прошивкой и при
+ * восстановлении не меняются.
+ *
+ * При нескольких секторах новый сектор заполняется до стирания
+ * старого, и пропадание питания во время переноса не теряет
+ * конфигурацию. С одним сектором (EEPROM ESP8266) такое окно есть
+ * на время стирания - раз в (размер сектора / 32) записей.
+ */
+class SmartIntercomConfigStore {
+private:
+  // SmartIntercom Journal Record (ровно SMARTINTERCOM_STORE_RECORD_SIZE байт)
+  struct SmartIntercomStoreRecord {
+    uint16_t magic;
+    uint8_t type;
+    uint8_t length;
+    uint32_t sequence;
+    int32_t openTime;
+    int32_t debounceTime;
+    int32_t ringTimeout;
+    int32_t openDelay;
+    uint8_t flags;
+    uint8_t gpioMode;
+    uint16_t reserved;
+    uint32_t crc;
+  };
+
+  SmartIntercomFlash* smartIntercomFlash;
+  uint16_t smartIntercomSector;
+  uint32_t smartIntercomSectorGeneration;
+  uint32_t smartIntercomWriteOffset;
+  uint32_t smartIntercomSequence;
+
+  // SmartIntercom Committed and Pending Configuration
+  SmartIntercomStoreRecord smartIntercomCommitted;
+  bool smartIntercomHasCommitted;
+  SmartIntercomStoreRecord smartIntercomPending;
+  bool smartIntercomHasPending;
+  unsigned long smartIntercomFirstRequest;
+  unsigned long smartIntercomLastRequest;
+
+  // SmartIntercom Store Statistics
+  uint32_t smartIntercomCommits;
+  uint32_t smartIntercomErases;
+  uint32_t smartIntercomCoalesced;
+  uint16_t smartIntercomReplayed;
+
+  // SmartIntercom Internal Methods
+  static void smartIntercomEncode(const SmartIntercomConfig& config, SmartIntercomStoreRecord* record);
+  static bool smartIntercomSamePayload(const SmartIntercomStoreRecord& a, const SmartIntercomStoreRecord& b);
+  bool smartIntercomReadHeader(uint16_t sector, uint32_t* generation);
+  bool smartIntercomReplaySector(uint16_t sector);
+  bool smartIntercomSlotErased(uint32_t offset);
+  bool smartIntercomStartSector(uint16_t sector, uint32_t generation);
+  bool smartIntercomAppend(SmartIntercomStoreRecord* record);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomConfigStore();
+
+  // SmartIntercom Initialization (чтение журнала)
+  bool smartIntercomBegin(SmartIntercomFlash* flash);
+
+  // SmartIntercom Restore (поверх config, пины не меняются)
+  bool smartIntercomLoad(SmartIntercomConfig* config);
+
+  // SmartIntercom Save (отложенная, с объединением изменений)
+  void smartIntercomRequestSave(const SmartIntercomConfig& config);
+  bool smartIntercomIsCommitDue();
+  unsigned long smartIntercomGetCommitDeadline();
+  bool smartIntercomIsPending() { return smartIntercomHasPending; }
+  bool smartIntercomCommit();
+
+  // SmartIntercom Store Statistics
+  uint32_t smartIntercomGetCommits() { return smartIntercomCommits; }
+  uint32_t smartIntercomGetErases() { return smartIntercomErases; }
+  uint32_t smartIntercomGetCoalesced() { return smartIntercomCoalesced; }
+  uint16_t smartIntercomGetReplayedRecords() { return smartIntercomReplayed; }
+  uint32_t smartIntercomGetSequence() { return smartIntercomSequence; }
+
+  // SmartIntercom CRC-32 (IEEE), общая для снимков во флеш-памяти
+  static uint32_t smartIntercomCrc32(const uint8_t* data, size_t length);
+};
+
+#endif // SMARTINTERCOM_CONFIG_STORE_H
@@ -0,0 +1,201 @@
+/*
+ * SmartIntercomEventQueue.cpp - Реализация очереди событий SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomEventQueue.h"
+
+#define SMARTINTERCOM_EVENT_QUEUE_MASK (SMARTINTERCOM_EVENT_QUEUE_SIZE - 1)
+#define SMARTINTERCOM_EVENT_ISR_QUEUE_MASK (SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE - 1)
+
+/*
+ * SmartIntercomEventQueue Constructor
+ */
+SmartIntercomEventQueue::SmartIntercomEventQueue() {
+  memset(smartIntercomEvents, 0, sizeof(smartIntercomEvents));
+  smartIntercomHead = 0;
+  smartIntercomPosted = 0;
+  smartIntercomLost = 0;
+  memset(smartIntercomIsrEvents, 0, sizeof(smartIntercomIsrEvents));
+  smartIntercomIsrHead = 0;
+  smartIntercomIsrTail = 0;
+  smartIntercomIsrDropped = 0;
+  memset(smartIntercomSubscribers, 0, sizeof(smartIntercomSubscribers));
+  smartIntercomDispatching = false;
+}
+
+/*
+ * SmartIntercomEventQueue Append
+ * Записать событие SmartIntercom в кольцо (самая старая запись перезаписывается)
+ */
+void SmartIntercomEventQueue::smartIntercomAppend(const SmartIntercomEvent& event) {
+  smartIntercomEvents[smartIntercomHead & SMARTINTERCOM_EVENT_QUEUE_MASK] = event;
+  smartIntercomHead++;
+  smartIntercomPosted++;
+}
+
+/*
+ * SmartIntercomEventQueue Post
+ * Событие SmartIntercom из главного цикла
+ */
+void SmartIntercomEventQueue::smartIntercomPost(uint8_t type, int32_t value, uint8_t channel) {
+  SmartIntercomEvent event;
+  event.timeUs = smartIntercomMicros();
+  event.type = type;
+  event.fromIsr = 0;
+  event.channel = channel;
+  event.reserved = 0;
+  event.value = value;
+  smartIntercomAppend(event);
+}
+
+/*
+ * SmartIntercomEventQueue Post From ISR
+ * Событие SmartIntercom из прерывания (только один контекст прерывания)
+ *
+ * При заполненном буфере прерывания событие отбрасывается
+ * и учитывается в smartIntercomGetIsrDropped().
+ */
+bool IRAM_ATTR SmartIntercomEventQueue::smartIntercomPostFromISR(uint8_t type, int32_t value) {
+  uint8_t head = smartIntercomIsrHead;
+  if ((uint8_t)(head - smartIntercomIsrTail) >= SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE) {
+    smartIntercomIsrDropped = smartIntercomIsrDropped + 1;
+    return false;
+  }
+  SmartIntercomEvent& event = smartIntercomIsrEvents[head & SMARTINTERCOM_EVENT_ISR_QUEUE_MASK];
+  event.timeUs = smartIntercomMicros();
+  event.type = type;
+  event.fromIsr = 1;
+  event.channel = 0;
+  event.reserved = 0;
+  event.value = value;
+  SMARTINTERCOM_COMPILER_BARRIER();
+  smartIntercomIsrHead = head + 1;
+  smartIntercomWake();
+  return true;
+}
+
+/*
+ * SmartIntercomEventQueue Drain Isr
+ * Перенести события прерываний SmartIntercom в общее кольцо
+ */
+void SmartIntercomEventQueue::smartIntercomDrainIsr() {
+  uint8_t tail = smartIntercomIsrTail;
+  uint8_t head = smartIntercomIsrHead;
+  SMARTINTERCOM_COMPILER_BARRIER();
+  while (tail != head) {
+    smartIntercomAppend(smartIntercomIsrEvents[tail & SMARTINTERCOM_EVENT_ISR_QUEUE_MASK]);
+    tail++;
+  }
+  SMARTINTERCOM_COMPILER_BARRIER();
+  smartIntercomIsrTail = tail;
+}
+
+/*
+ * SmartIntercomEventQueue Subscribe
+ * Зарегистрировать подписчика SmartIntercom с фильтром типов и размером пачки
+ */
+uint8_t SmartIntercomEventQueue::smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context,
+                                                       uint16_t mask, uint8_t batch) {
+  if (handler == nullptr) {
+    return SMARTINTERCOM_EVENT_NO_SUBSCRIBER;
+  }
+  for (uint8_t id = 0; id < SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS; id++) {
+    SmartIntercomEventSubscriber& subscriber = smartIntercomSubscribers[id];
+    if (subscriber.handler != nullptr) {
+      continue;
+    }
+    subscriber.handler = handler;
+    subscriber.context = context;
+    subscriber.mask = mask;
+    subscriber.batch = batch > 0 ? batch : 1;
+    subscriber.cursor = smartIntercomHead;
+    subscriber.lost = 0;
+    return id;
+  }
+  return SMARTINTERCOM_EVENT_NO_SUBSCRIBER;
+}
+
+void SmartIntercomEventQueue::smartIntercomUnsubscribe(uint8_t id) {
+  if (id < SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS) {
+    smartIntercomSubscribers[id].handler = nullptr;
+  }
+}
+
+/*
+ * SmartIntercomEventQueue Dispatch
+ * Доставить подписчикам SmartIntercom до batch событий каждому
+ *
+ * Подписчик, отставший больше чем на размер кольца, переносится
+ * на самую старую сохраненную запись, пропуск добавляется к его
+ * счетчику и к общему счетчику потерь. Повторный вызов из
+ * обработчика ничего не делает.
+ */
+uint16_t SmartIntercomEventQueue::smartIntercomDispatch() {
+  if (smartIntercomDispatching) {
+    return 0;
+  }
+  smartIntercomDispatching = true;
+  smartIntercomDrainIsr();
+
+  uint16_t delivered = 0;
+  uint8_t phase = smartIntercomMarkPhase(SMARTINTERCOM_PHASE_CALLBACK);
+  for (uint8_t id = 0; id < SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS; id++) {
+    SmartIntercomEventSubscriber& subscriber = smartIntercomSubscribers[id];
+    uint8_t count = 0;
+    while (subscriber.handler != nullptr && subscriber.cursor != smartIntercomHead && count < subscriber.batch) {
+      uint32_t lag = smartIntercomHead - subscriber.cursor;
+      if (lag > SMARTINTERCOM_EVENT_QUEUE_SIZE) {
+        subscriber.lost += lag - SMARTINTERCOM_EVENT_QUEUE_SIZE;
+        smartIntercomLost += lag - SMARTINTERCOM_EVENT_QUEUE_SIZE;
+        subscriber.cursor = smartIntercomHead - SMARTINTERCOM_EVENT_QUEUE_SIZE;
+      }
+      // SmartIntercom Copy first: the handler may post and overwrite this slot
+      SmartIntercomEvent event = smartIntercomEvents[subscriber.cursor & SMARTINTERCOM_EVENT_QUEUE_MASK];
+      subscriber.cursor++;
+      if ((subscriber.mask & SMARTINTERCOM_EVENT_MASK(event.type)) == 0) {
+        continue;
+      }
+      subscriber.handler(event, subscriber.context);
+      count++;
+      delivered++;
+    }
+  }
+
+  smartIntercomMarkPhase(phase);
+  smartIntercomDispatching = false;
+  return delivered;
+}
+
+uint32_t SmartIntercomEventQueue::smartIntercomGetSubscriberLost(uint8_t id) {
+  return id < SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS ? smartIntercomSubscribers[id].lost : 0;
+}
+
+/*
+ * SmartIntercomEventQueue Has Pending
+ * Есть ли события SmartIntercom для следующей рассылки
+ */
+bool SmartIntercomEventQueue::smartIntercomHasPending() {
+  if (smartIntercomIsrHead != smartIntercomIsrTail) {
+    return true;
+  }
+  for (uint8_t id = 0; id < SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS; id++) {
+    if (smartIntercomSubscribers[id].handler != nullptr && smartIntercomSubscribers[id].cursor != smartIntercomHead) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomEventQueue Get Pending
+ * Сколько событий SmartIntercom подписчик еще не получил (с учетом перезаписанных)
+ */
+uint32_t SmartIntercomEventQueue::smartIntercomGetPending(uint8_t id) {
+  if (id >= SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS || smartIntercomSubscribers[id].handler == nullptr) {
+    return 0;
+  }
+  return smartIntercomHead - smartIntercomSubscribers[id].cursor;
+}
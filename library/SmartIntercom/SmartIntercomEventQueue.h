@@ -0,0 +1,136 @@
+/*
+ * SmartIntercomEventQueue.h - Очередь событий SmartIntercom с подписчиками
+ *
+ * События SmartIntercom - записи фиксированного размера с типом,
+ * значением и временем в микросекундах. Они складываются в кольцевой
+ * буфер, а подписчики получают их пачками из главного цикла, каждый
+ * по своему курсору. Медленный подписчик не задерживает звонок
+ * и остальных подписчиков: буфер перезаписывает самые старые записи,
+ * а отставший подписчик узнает об этом по курсору и учитывает
+ * пропущенные события в своем счетчике.
+ *
+ * Из прерываний события кладутся в отдельный SPSC-буфер без блокировок
+ * (как SmartIntercomSampleBuffer), будят главный цикл (smartIntercomWake)
+ * и переносятся в общий буфер при рассылке, поэтому их порядок среди событий главного цикла
+ * определяется временем записи, а не позицией в очереди.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_EVENT_QUEUE_H
+#define SMARTINTERCOM_EVENT_QUEUE_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Event Queue Configuration (размеры - степени двойки)
+#ifndef SMARTINTERCOM_EVENT_QUEUE_SIZE
+#define SMARTINTERCOM_EVENT_QUEUE_SIZE 32
+#endif
+
+#ifndef SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE
+#define SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE 8
+#endif
+
+#ifndef SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS
+#define SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS 4
+#endif
+
+#ifndef SMARTINTERCOM_EVENT_BATCH
+#define SMARTINTERCOM_EVENT_BATCH 8               // Событий на подписчика за проход цикла
+#endif
+
+#if (SMARTINTERCOM_EVENT_QUEUE_SIZE & (SMARTINTERCOM_EVENT_QUEUE_SIZE - 1)) != 0 || \
+    (SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE & (SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE - 1)) != 0
+#error "SmartIntercom event queue sizes must be powers of two"
+#endif
+
+#define SMARTINTERCOM_EVENT_ALL 0xFFFF
+#define SMARTINTERCOM_EVENT_NO_SUBSCRIBER 0xFF
+#define SMARTINTERCOM_EVENT_MASK(type) ((uint16_t)(1U << (type)))
+
+/*
+ * SmartIntercomEvent - Запись события SmartIntercom
+ *
+ * value зависит от типа (SmartIntercomEventType): номер звонка,
+ * источник открытия, новое состояние, флаги конфигурации, код ошибки.
+ * channel - номер линии в многоканальном режиме (SmartIntercomLines),
+ * у одноканального SmartIntercom всегда 0.
+ */
+struct SmartIntercomEvent {
+  uint32_t timeUs;
+  uint8_t type;
+  uint8_t fromIsr;
+  uint8_t channel;
+  uint8_t reserved;
+  int32_t value;
+};
+
+/*
+ * SmartIntercomEventHandler - Подписчик событий SmartIntercom
+ *
+ * Вызывается из главного цикла; может сам порождать события
+ * (они придут в следующих пачках).
+ */
+typedef void (*SmartIntercomEventHandler)(const SmartIntercomEvent& event, void* context);
+
+/*
+ * SmartIntercomEventQueue - Очередь событий SmartIntercom
+ */
+class SmartIntercomEventQueue {
+private:
+  struct SmartIntercomEventSubscriber {
+    SmartIntercomEventHandler handler;
+    void* context;
+    uint16_t mask;
+    uint8_t batch;
+    uint32_t cursor;
+    uint32_t lost;
+  };
+
+  // SmartIntercom Broadcast Ring (только главный цикл)
+  SmartIntercomEvent smartIntercomEvents[SMARTINTERCOM_EVENT_QUEUE_SIZE];
+  uint32_t smartIntercomHead;
+  uint32_t smartIntercomPosted;
+  uint32_t smartIntercomLost;
+
+  // SmartIntercom Interrupt Lane (SPSC: прерывание -> главный цикл)
+  SmartIntercomEvent smartIntercomIsrEvents[SMARTINTERCOM_EVENT_ISR_QUEUE_SIZE];
+  volatile uint8_t smartIntercomIsrHead;
+  volatile uint8_t smartIntercomIsrTail;
+  volatile uint32_t smartIntercomIsrDropped;
+
+  SmartIntercomEventSubscriber smartIntercomSubscribers[SMARTINTERCOM_EVENT_MAX_SUBSCRIBERS];
+  bool smartIntercomDispatching;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomAppend(const SmartIntercomEvent& event);
+  void smartIntercomDrainIsr();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomEventQueue();
+
+  // SmartIntercom Producers
+  void smartIntercomPost(uint8_t type, int32_t value = 0, uint8_t channel = 0);
+  bool smartIntercomPostFromISR(uint8_t type, int32_t value = 0);
+
+  // SmartIntercom Subscribers (новый подписчик получает только следующие события)
+  uint8_t smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context = nullptr,
+                                 uint16_t mask = SMARTINTERCOM_EVENT_ALL, uint8_t batch = SMARTINTERCOM_EVENT_BATCH);
+  void smartIntercomUnsubscribe(uint8_t id);
+
+  // SmartIntercom Main Loop (рассылка пачками, возвращает число доставленных)
+  uint16_t smartIntercomDispatch();
+
+  // SmartIntercom Queue Statistics
+  uint32_t smartIntercomGetPosted() { return smartIntercomPosted; }
+  uint32_t smartIntercomGetLost() { return smartIntercomLost; }
+  uint32_t smartIntercomGetSubscriberLost(uint8_t id);
+  uint32_t smartIntercomGetIsrDropped() { return smartIntercomIsrDropped; }
+  uint32_t smartIntercomGetPending(uint8_t id);
+  bool smartIntercomHasPending();
+};
+
+#endif // SMARTINTERCOM_EVENT_QUEUE_H
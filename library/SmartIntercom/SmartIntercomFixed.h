@@ -0,0 +1,304 @@
+/*
+ * SmartIntercomFixed.h - SmartIntercom с конфигурацией времени компиляции
+ *
+ * Для платы с известной разводкой пины, полярность выходов, времена и
+ * режим выборки звонка задаются константами структуры Config, а не
+ * SmartIntercomConfig во время работы:
+ *
+ *   struct SmartIntercomBoard : SmartIntercomFixedDefaults {
+ *     static const int doorbellPin = A0;
+ *     static const int doorOpenPin = 5;
+ *     static const bool inverted = true;
+ *     static const unsigned long ringSamplePeriodUs = 1000;
+ *   };
+ *   SmartIntercomFixed<SmartIntercomBoard> smartIntercom;
+ *
+ * Ошибки разводки (совпавшие пины, нулевое время открытия) ловит
+ * static_assert при сборке. Пины, полярность и режим выходов -
+ * параметры шаблонов SmartIntercomFixedGPIO и SmartIntercomFixedDoor:
+ * запись в пин сворачивается компилятором в вызов с константами, без
+ * ветвей по режиму и полярности. Выходы лежат по значению внутри
+ * объекта, куча не используется. SmartIntercomFixed - наследник
+ * SmartIntercom, поэтому SmartIntercomApi и SmartIntercomMqtt
+ * подключаются к нему без изменений.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_FIXED_H
+#define SMARTINTERCOM_FIXED_H
+
+#include <Arduino.h>
+#include <new>
+#include "SmartIntercom.h"
+
+/*
+ * SmartIntercomFixedDefaults - Константы Config SmartIntercomFixed по умолчанию
+ *
+ * Config наследует структуру и переопределяет нужные константы;
+ * doorbellPin и doorOpenPin задаются всегда.
+ */
+struct SmartIntercomFixedDefaults {
+  static const int handsetPin = -1;                                     // SmartIntercom -1 - трубка не подключена
+  static const int ledPin = LED_BUILTIN;
+  static const bool inverted = false;                                   // SmartIntercom true - реле и трубка: активный низкий
+  static const int openTime = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  static const int debounceTime = SMARTINTERCOM_DEFAULT_DEBOUNCE;
+  static const int ringTimeout = SMARTINTERCOM_DEFAULT_RING_TIMEOUT;
+  static const int openDelay = 0;
+  static const bool autoOpenEnabled = false;
+  static const bool alwaysOpenEnabled = false;
+  static const unsigned long ringSamplePeriodUs = 0;                    // SmartIntercom 0 - АЦП опрашивается из loop()
+  static const unsigned int ringToneHz = SMARTINTERCOM_RING_TONE_HZ;    // SmartIntercom 0 - звонок по уровню
+};
+
+/*
+ * SmartIntercomFixedPin - Пин SmartIntercomFixedGPIO из параметров шаблона
+ *
+ * Политика пина SmartIntercomGPIOSequence: все значения - константы,
+ * ветви по режиму и полярности сворачиваются при сборке.
+ */
+template <int Pin, bool Inverted, SmartIntercomGPIOMode Mode>
+struct SmartIntercomFixedPin {
+  static int smartIntercomGetPin() { return Pin; }
+  static bool smartIntercomIsInverted() { return Inverted; }
+  static bool smartIntercomIsPWM() { return Mode == SMARTINTERCOM_MODE_PWM; }
+  static int smartIntercomGetDebounce() { return SMARTINTERCOM_DEFAULT_DEBOUNCE; }
+};
+
+/*
+ * SmartIntercomFixedGPIO - Выход SmartIntercom с пином и полярностью из шаблона
+ *
+ * Последовательности те же, что у SmartIntercomGPIO
+ * (SmartIntercomGPIOSequence), антидребезг SMARTINTERCOM_DEFAULT_DEBOUNCE.
+ * Pin < 0 - выход не подключен, запись выбрасывается при сборке.
+ */
+template <int Pin, bool Inverted = false, SmartIntercomGPIOMode Mode = SMARTINTERCOM_MODE_NORMAL>
+class SmartIntercomFixedGPIO : public SmartIntercomGPIOSequence<SmartIntercomFixedPin<Pin, Inverted, Mode> > {
+  static_assert(Mode != SMARTINTERCOM_MODE_INVERTED,
+                "SmartIntercomFixedGPIO: polarity is the Inverted parameter, not a mode");
+
+public:
+  /*
+   * SmartIntercomFixedGPIO Set PWM
+   * Установить PWM значение SmartIntercom (только выход SMARTINTERCOM_MODE_PWM)
+   */
+  void smartIntercomSetPWM(int value) {
+    static_assert(Mode == SMARTINTERCOM_MODE_PWM, "SmartIntercomFixedGPIO: PWM needs SMARTINTERCOM_MODE_PWM");
+    SmartIntercomGPIOSequence<SmartIntercomFixedPin<Pin, Inverted, Mode> >::smartIntercomSetPWM(value);
+  }
+};
+
+/*
+ * SmartIntercomFixedDoor - Дверь SmartIntercom с реле на пине из шаблона
+ *
+ * Время открытия остается параметром времени работы: его меняют
+ * API и журнал конфигурации.
+ */
+template <int Pin, bool Inverted = false>
+class SmartIntercomFixedDoor {
+private:
+  SmartIntercomFixedGPIO<Pin, Inverted, SMARTINTERCOM_MODE_PULSE> smartIntercomOpenRelay;
+  int smartIntercomOpenTime;
+  bool smartIntercomIsOpen;
+  unsigned long smartIntercomOpenStart;
+
+public:
+  // SmartIntercom Constructor (реле настраивается в smartIntercomBegin)
+  explicit SmartIntercomFixedDoor(int openTime)
+      : smartIntercomOpenTime(openTime), smartIntercomIsOpen(false), smartIntercomOpenStart(0) {}
+
+  /*
+   * SmartIntercomFixedDoor Begin
+   * Инициализация контроллера двери SmartIntercom
+   */
+  void smartIntercomBegin(int openTime) {
+    smartIntercomOpenRelay.smartIntercomBegin();
+    smartIntercomOpenTime = openTime;
+    smartIntercomIsOpen = false;
+    smartIntercomOpenStart = 0;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Door controller initialized");
+  }
+
+  /*
+   * SmartIntercomFixedDoor End
+   * Снять импульс реле SmartIntercom с планировщика (пин не меняется)
+   */
+  void smartIntercomEnd() {
+    smartIntercomOpenRelay.smartIntercomCancelSequence();
+  }
+
+  /*
+   * SmartIntercomFixedDoor Open
+   * Открыть дверь SmartIntercom, реле удерживается планировщиком
+   */
+  void smartIntercomOpen() {
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Opening door...");
+    smartIntercomOpenRelay.smartIntercomPulse(smartIntercomOpenTime);
+    smartIntercomIsOpen = true;
+    smartIntercomOpenStart = smartIntercomMillis();
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Door opened");
+  }
+
+  void smartIntercomClose() {
+    smartIntercomIsOpen = false;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Door closed");
+  }
+
+  /*
+   * SmartIntercomFixedDoor Check State
+   * Проверить состояние двери SmartIntercom (закрыть через openTime + 1 с)
+   */
+  bool smartIntercomCheckState() {
+    if (smartIntercomIsOpen &&
+        (smartIntercomMillis() - smartIntercomOpenStart > (unsigned long)smartIntercomOpenTime + 1000)) {
+      smartIntercomClose();
+    }
+    return smartIntercomIsOpen;
+  }
+
+  bool smartIntercomIsRelayActive() { return smartIntercomOpenRelay.smartIntercomIsSequenceRunning(); }
+  void smartIntercomSetOpenTime(int ms) { smartIntercomOpenTime = ms; }
+  int smartIntercomGetOpenTime() { return smartIntercomOpenTime; }
+};
+
+/*
+ * SmartIntercomFixedOutputs - Дверь, LED и трубка SmartIntercomFixed<Config>
+ */
+template <class Config>
+struct SmartIntercomFixedOutputs {
+  SmartIntercomFixedDoor<Config::doorOpenPin, Config::inverted> smartIntercomDoor;
+  SmartIntercomFixedGPIO<Config::ledPin, false, SMARTINTERCOM_MODE_PWM> smartIntercomLED;
+  SmartIntercomFixedGPIO<Config::handsetPin, Config::inverted> smartIntercomHandset;
+
+  SmartIntercomFixedOutputs() : smartIntercomDoor(Config::openTime) {}
+};
+
+/*
+ * SmartIntercomFixed - SmartIntercom с конфигурацией из Config
+ *
+ * Выходы строятся один раз в конструкторе в хранилище выходов
+ * SmartIntercom и адресуются по постоянному смещению от объекта;
+ * smartIntercomBegin() только заново инициализирует пины.
+ */
+template <class Config>
+class SmartIntercomFixed final : public SmartIntercom {
+  static_assert(Config::doorbellPin >= 0 && Config::doorOpenPin >= 0,
+                "SmartIntercomFixed: doorbellPin and doorOpenPin are required");
+  static_assert(Config::doorbellPin != Config::doorOpenPin && Config::ledPin != Config::doorOpenPin &&
+                    Config::handsetPin != Config::doorOpenPin,
+                "SmartIntercomFixed: the door relay pin is shared with another component");
+  static_assert(Config::handsetPin < 0 || (Config::handsetPin != Config::doorbellPin &&
+                                           Config::handsetPin != Config::ledPin),
+                "SmartIntercomFixed: the handset pin is shared with another component");
+  static_assert(Config::openTime > 0 && Config::ringTimeout > 0 && Config::openDelay >= 0,
+                "SmartIntercomFixed: openTime and ringTimeout must be positive, openDelay non-negative");
+  static_assert(sizeof(SmartIntercomFixedOutputs<Config>) <= sizeof(SmartIntercomOutputs) &&
+                    alignof(SmartIntercomFixedOutputs<Config>) <= alignof(SmartIntercomOutputs),
+                "SmartIntercomFixed: the fixed outputs do not fit the SmartIntercom output storage");
+
+  SmartIntercomFixedOutputs<Config>& smartIntercomFixedOutputs() {
+    return *reinterpret_cast<SmartIntercomFixedOutputs<Config>*>(smartIntercomOutputStorage);
+  }
+
+protected:
+  // SmartIntercom Output Hooks (пины и полярность - константы Config)
+  void smartIntercomBeginOutputs(const SmartIntercomConfig& config) override {
+    smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomBegin(config.openTime);
+    smartIntercomFixedOutputs().smartIntercomLED.smartIntercomBegin();
+    smartIntercomFixedOutputs().smartIntercomHandset.smartIntercomBegin();
+  }
+
+  void smartIntercomReleaseOutputs() override {
+    smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomEnd();
+    smartIntercomFixedOutputs().smartIntercomLED.smartIntercomCancelSequence();
+    smartIntercomFixedOutputs().smartIntercomHandset.smartIntercomCancelSequence();
+  }
+
+  void smartIntercomDoorOpen() override {
+    smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomOpen();
+  }
+
+  void smartIntercomDoorClose() override {
+    smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomClose();
+  }
+
+  bool smartIntercomDoorCheck() override {
+    return smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomCheckState();
+  }
+
+  int smartIntercomDoorGetOpenTime() override {
+    return smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomGetOpenTime();
+  }
+
+  void smartIntercomDoorSetOpenTime(int ms) override {
+    smartIntercomFixedOutputs().smartIntercomDoor.smartIntercomSetOpenTime(ms);
+  }
+
+  void smartIntercomLEDWrite(bool state) override {
+    smartIntercomFixedOutputs().smartIntercomLED.smartIntercomSetState(state);
+  }
+
+  void smartIntercomLEDStartBlink(int times) override {
+    smartIntercomFixedOutputs().smartIntercomLED.smartIntercomBlink(times, 200, 200);
+  }
+
+  void smartIntercomLEDWritePWM(int value) override {
+    smartIntercomFixedOutputs().smartIntercomLED.smartIntercomSetPWM(value);
+  }
+
+  void smartIntercomHandsetWrite(bool state) override {
+    smartIntercomFixedOutputs().smartIntercomHandset.smartIntercomSetState(state);
+  }
+
+  void smartIntercomHandsetFlip() override {
+    smartIntercomFixedOutputs().smartIntercomHandset.smartIntercomToggle();
+  }
+
+public:
+  SmartIntercomFixed() {
+    new (smartIntercomOutputStorage) SmartIntercomFixedOutputs<Config>();
+  }
+
+  // SmartIntercom Base destructor cannot reach these outputs (its virtual calls resolve to SmartIntercom)
+  ~SmartIntercomFixed() {
+    smartIntercomFixedOutputs().~SmartIntercomFixedOutputs();
+  }
+
+  /*
+   * SmartIntercomFixed Get Fixed Config
+   * SmartIntercomConfig SmartIntercom, собранная из констант Config
+   */
+  static SmartIntercomConfig smartIntercomGetFixedConfig() {
+    SmartIntercomConfig config;
+    config.doorbellPin = Config::doorbellPin;
+    config.doorOpenPin = Config::doorOpenPin;
+    config.handsetPin = Config::handsetPin;
+    config.ledPin = Config::ledPin;
+    config.openTime = Config::openTime;
+    config.debounceTime = Config::debounceTime;
+    config.ringTimeout = Config::ringTimeout;
+    config.autoOpenEnabled = Config::autoOpenEnabled;
+    config.alwaysOpenEnabled = Config::alwaysOpenEnabled;
+    config.openDelay = Config::openDelay;
+    config.gpioMode = Config::inverted ? SMARTINTERCOM_MODE_INVERTED : SMARTINTERCOM_MODE_NORMAL;
+    return config;
+  }
+
+  /*
+   * SmartIntercomFixed Begin
+   * Инициализация SmartIntercom по Config (заменяет smartIntercomBegin(config))
+   */
+  void smartIntercomBegin() {
+    SmartIntercom::smartIntercomBegin(smartIntercomGetFixedConfig());
+    if (Config::ringToneHz > 0) {
+      smartIntercomSetRingTone(Config::ringToneHz);
+    }
+    if (Config::ringSamplePeriodUs > 0) {
+      smartIntercomEnableRingSampling(Config::ringSamplePeriodUs);
+    }
+  }
+};
+
+#endif // SMARTINTERCOM_FIXED_H
@@ -0,0 +1,408 @@
+/*
+ * SmartIntercomGPIOSequence.h - Последовательности выходов SmartIntercom
+ *
+ * Общая часть SmartIntercomGPIO и SmartIntercomFixedGPIO: антидребезг,
+ * импульс, паттерн, мигание, плавная яркость на планировщике и переход
+ * с ШИМ на цифровую запись. Пин, полярность, режим и антидребезг
+ * задает политика пина PinPolicy:
+ *
+ *   int smartIntercomGetPin();
+ *   bool smartIntercomIsInverted();
+ *   bool smartIntercomIsPWM();
+ *   int smartIntercomGetDebounce();
+ *
+ * У SmartIntercomGPIO это поля, заданные во время работы, у
+ * SmartIntercomFixedGPIO - константы шаблона, и ветви по ним
+ * сворачиваются компилятором.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_GPIO_SEQUENCE_H
+#define SMARTINTERCOM_GPIO_SEQUENCE_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomLog.h"
+#include "SmartIntercomScheduler.h"
+
+// SmartIntercom GPIO Sequence Configuration
+#define SMARTINTERCOM_GPIO_PATTERN_MAX 16
+#define SMARTINTERCOM_GPIO_FADE_STEPS 50
+
+// SmartIntercom GPIO Sequence Types
+enum SmartIntercomGPIOSequenceType {
+  SMARTINTERCOM_SEQUENCE_NONE,
+  SMARTINTERCOM_SEQUENCE_PULSE,
+  SMARTINTERCOM_SEQUENCE_PATTERN,
+  SMARTINTERCOM_SEQUENCE_BLINK,
+  SMARTINTERCOM_SEQUENCE_FADE
+};
+
+/*
+ * SmartIntercomGPIOSequence - Выход SmartIntercom с последовательностями
+ */
+template <class PinPolicy>
+class SmartIntercomGPIOSequence : protected PinPolicy {
+private:
+  bool smartIntercomCurrentState;
+  bool smartIntercomPwmActive;
+  unsigned long smartIntercomLastToggle;
+
+  // SmartIntercom Sequence State
+  uint16_t smartIntercomSequenceJob;
+  uint8_t smartIntercomSequenceType;
+  int smartIntercomSequencePattern[SMARTINTERCOM_GPIO_PATTERN_MAX];
+  int smartIntercomSequenceLength;
+  int smartIntercomSequenceOnTime;
+  int smartIntercomSequenceOffTime;
+  int smartIntercomSequenceFrom;
+  int smartIntercomSequenceTo;
+  unsigned long smartIntercomSequenceDuration;
+
+  // SmartIntercom Internal Methods
+  bool smartIntercomCheckDebounce();
+  void smartIntercomWritePin(bool state);
+  void smartIntercomApplyState(bool state);
+  void smartIntercomApplyPWM(int value);
+  void smartIntercomStartSequence(uint8_t type, unsigned long firstDelay);
+  static long smartIntercomSequenceStep(void* context, int step);
+
+public:
+  // SmartIntercom Constructor / Destructor (деструктор отменяет последовательность)
+  SmartIntercomGPIOSequence();
+  ~SmartIntercomGPIOSequence();
+
+  // SmartIntercom Not copyable (задача последовательности держит указатель на пин)
+  SmartIntercomGPIOSequence(const SmartIntercomGPIOSequence&) = delete;
+  SmartIntercomGPIOSequence& operator=(const SmartIntercomGPIOSequence&) = delete;
+
+  // SmartIntercom Initialization
+  void smartIntercomBegin();
+
+  // SmartIntercom State Control
+  void smartIntercomSetHigh() { smartIntercomSetState(true); }
+  void smartIntercomSetLow() { smartIntercomSetState(false); }
+  void smartIntercomSetState(bool state);
+  void smartIntercomToggle() { smartIntercomSetState(!smartIntercomCurrentState); }
+
+  // SmartIntercom Pulse Control
+  void smartIntercomPulse(unsigned long duration);
+  void smartIntercomPulsePattern(int* pattern, int length);
+
+  // SmartIntercom PWM Control
+  void smartIntercomSetPWM(int value);
+  void smartIntercomFade(int from, int to, unsigned long duration);
+
+  // SmartIntercom Blink Patterns
+  void smartIntercomBlink(int times, int onTime, int offTime);
+  void smartIntercomBlinkPattern(int* pattern, int length) { smartIntercomPulsePattern(pattern, length); }
+
+  // SmartIntercom Sequence Control
+  void smartIntercomCancelSequence();
+  bool smartIntercomIsSequenceRunning() { return smartIntercomSequenceJob != SMARTINTERCOM_JOB_NONE; }
+
+  // SmartIntercom State Reading
+  bool smartIntercomGetState() { return smartIntercomCurrentState; }
+};
+
+/*
+ * SmartIntercomGPIOSequence Constructor
+ * Пин настраивается в smartIntercomBegin()
+ */
+template <class PinPolicy>
+SmartIntercomGPIOSequence<PinPolicy>::SmartIntercomGPIOSequence() {
+  smartIntercomCurrentState = false;
+  smartIntercomPwmActive = false;
+  smartIntercomLastToggle = 0;
+  smartIntercomSequenceJob = SMARTINTERCOM_JOB_NONE;
+  smartIntercomSequenceType = SMARTINTERCOM_SEQUENCE_NONE;
+  smartIntercomSequenceLength = 0;
+  smartIntercomSequenceOnTime = 0;
+  smartIntercomSequenceOffTime = 0;
+  smartIntercomSequenceFrom = 0;
+  smartIntercomSequenceTo = 0;
+  smartIntercomSequenceDuration = 0;
+}
+
+/*
+ * SmartIntercomGPIOSequence Destructor
+ * Задача последовательности SmartIntercom держит указатель на пин
+ */
+template <class PinPolicy>
+SmartIntercomGPIOSequence<PinPolicy>::~SmartIntercomGPIOSequence() {
+  smartIntercomCancelSequence();
+}
+
+/*
+ * SmartIntercomGPIOSequence Begin
+ * Инициализация пина SmartIntercom (пин < 0 - выход не подключен)
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomBegin() {
+  if (this->smartIntercomGetPin() >= 0) {
+    smartIntercomPinMode(this->smartIntercomGetPin(), OUTPUT);
+  }
+  smartIntercomWritePin(false);
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: GPIO %d initialized", this->smartIntercomGetPin());
+}
+
+/*
+ * SmartIntercomGPIOSequence Check Debounce
+ * Проверка антидребезга для SmartIntercom
+ */
+template <class PinPolicy>
+bool SmartIntercomGPIOSequence<PinPolicy>::smartIntercomCheckDebounce() {
+  unsigned long currentTime = smartIntercomMillis();
+  if (currentTime - smartIntercomLastToggle < (unsigned long)this->smartIntercomGetDebounce()) {
+    return false;
+  }
+  smartIntercomLastToggle = currentTime;
+  return true;
+}
+
+/*
+ * SmartIntercomGPIOSequence Write Pin
+ * Запись состояния в пин SmartIntercom
+ *
+ * Пин пишется через пакет выходов (внутри пакета - вместе с
+ * остальными пинами перехода). Первая запись после analogWrite()
+ * идет сразу: digitalWrite() останавливает на пине ШИМ, а регистры
+ * set/clear - нет.
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomWritePin(bool state) {
+  smartIntercomCurrentState = state;
+  int pin = this->smartIntercomGetPin();
+  if (pin < 0) {
+    return;
+  }
+  int level = state != this->smartIntercomIsInverted() ? HIGH : LOW;
+  if (this->smartIntercomIsPWM() && smartIntercomPwmActive) {
+    smartIntercomDigitalWrite(pin, level);
+    smartIntercomPwmActive = false;
+  } else {
+    smartIntercomOutputWrite(pin, level);
+  }
+}
+
+/*
+ * SmartIntercomGPIOSequence Apply State
+ * Установка состояния пина SmartIntercom без отмены последовательности
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomApplyState(bool state) {
+  if (smartIntercomCheckDebounce()) {
+    smartIntercomWritePin(state);
+    SMARTINTERCOM_LOG_DEBUG("SmartIntercom: GPIO %d set to %s", this->smartIntercomGetPin(), state ? "HIGH" : "LOW");
+  }
+}
+
+/*
+ * SmartIntercomGPIOSequence Apply PWM
+ * Установка PWM SmartIntercom без отмены последовательности
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomApplyPWM(int value) {
+  if (this->smartIntercomIsPWM() && this->smartIntercomGetPin() >= 0) {
+    smartIntercomAnalogWrite(this->smartIntercomGetPin(), value);
+    smartIntercomPwmActive = true;
+    SMARTINTERCOM_LOG_DEBUG("SmartIntercom: PWM set to %d", value);
+  }
+}
+
+/*
+ * SmartIntercomGPIOSequence Start Sequence
+ * Запуск неблокирующей последовательности SmartIntercom
+ *
+ * Предыдущая последовательность на этом пине отменяется.
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomStartSequence(uint8_t type, unsigned long firstDelay) {
+  smartIntercomScheduler.smartIntercomCancel(smartIntercomSequenceJob);
+  smartIntercomSequenceType = type;
+  smartIntercomSequenceJob = smartIntercomScheduler.smartIntercomSchedule(
+    firstDelay, smartIntercomSequenceStep, this);
+  if (smartIntercomSequenceJob == SMARTINTERCOM_JOB_NONE) {
+    smartIntercomSequenceType = SMARTINTERCOM_SEQUENCE_NONE;
+  }
+}
+
+/*
+ * SmartIntercomGPIOSequence Sequence Step
+ * Шаг последовательности SmartIntercom, вызывается планировщиком
+ */
+template <class PinPolicy>
+long SmartIntercomGPIOSequence<PinPolicy>::smartIntercomSequenceStep(void* context, int step) {
+  SmartIntercomGPIOSequence* gpio = static_cast<SmartIntercomGPIOSequence*>(context);
+  long next = SMARTINTERCOM_JOB_DONE;
+
+  switch (gpio->smartIntercomSequenceType) {
+    case SMARTINTERCOM_SEQUENCE_PULSE:
+      // SmartIntercom Release bypasses debounce so the relay is never left energized
+      gpio->smartIntercomWritePin(false);
+      SMARTINTERCOM_LOG_DEBUG("SmartIntercom: GPIO %d pulsed for %lu ms", gpio->smartIntercomGetPin(),
+                              gpio->smartIntercomSequenceDuration);
+      break;
+
+    case SMARTINTERCOM_SEQUENCE_PATTERN: {
+      int index = step + 1;
+      if (index < gpio->smartIntercomSequenceLength) {
+        gpio->smartIntercomApplyState(index % 2 == 0);
+        next = gpio->smartIntercomSequencePattern[index];
+      } else {
+        gpio->smartIntercomWritePin(false);
+        SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Pulse pattern completed");
+      }
+      break;
+    }
+
+    case SMARTINTERCOM_SEQUENCE_BLINK:
+      if (step % 2 == 0) {
+        gpio->smartIntercomApplyState(false);
+        if (step / 2 < gpio->smartIntercomSequenceLength - 1) {
+          next = gpio->smartIntercomSequenceOffTime;
+        } else {
+          SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Blinked %d times", gpio->smartIntercomSequenceLength);
+        }
+      } else {
+        gpio->smartIntercomApplyState(true);
+        next = gpio->smartIntercomSequenceOnTime;
+      }
+      break;
+
+    case SMARTINTERCOM_SEQUENCE_FADE: {
+      int from = gpio->smartIntercomSequenceFrom;
+      int to = gpio->smartIntercomSequenceTo;
+      if (step < SMARTINTERCOM_GPIO_FADE_STEPS) {
+        int stepSize = (to - from) / SMARTINTERCOM_GPIO_FADE_STEPS;
+        gpio->smartIntercomApplyPWM(from + stepSize * (step + 1));
+        next = gpio->smartIntercomSequenceDuration / SMARTINTERCOM_GPIO_FADE_STEPS;
+      } else {
+        gpio->smartIntercomApplyPWM(to);
+        SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Faded from %d to %d", from, to);
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  // SmartIntercom The scheduler drops a job on any negative delay, so every one ends the sequence
+  if (next < 0) {
+    if (next != SMARTINTERCOM_JOB_DONE) {
+      gpio->smartIntercomWritePin(false);
+    }
+    gpio->smartIntercomSequenceJob = SMARTINTERCOM_JOB_NONE;
+    gpio->smartIntercomSequenceType = SMARTINTERCOM_SEQUENCE_NONE;
+    return SMARTINTERCOM_JOB_DONE;
+  }
+  return next;
+}
+
+/*
+ * SmartIntercomGPIOSequence Set State
+ * Установить состояние пина SmartIntercom
+ *
+ * Прямая установка состояния отменяет активную последовательность.
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomSetState(bool state) {
+  smartIntercomCancelSequence();
+  smartIntercomApplyState(state);
+}
+
+/*
+ * SmartIntercomGPIOSequence Pulse
+ * Создать импульс на пине SmartIntercom
+ *
+ * Возвращается сразу, пин сбрасывается планировщиком через duration мс.
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomPulse(unsigned long duration) {
+  smartIntercomCancelSequence();
+  smartIntercomApplyState(true);
+  smartIntercomSequenceDuration = duration;
+  smartIntercomStartSequence(SMARTINTERCOM_SEQUENCE_PULSE, duration);
+}
+
+/*
+ * SmartIntercomGPIOSequence Pulse Pattern
+ * Создать паттерн импульсов для SmartIntercom
+ *
+ * Паттерн копируется, массив вызывающего кода можно освободить сразу.
+ * Отрицательные длительности считаются нулевыми.
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomPulsePattern(int* pattern, int length) {
+  smartIntercomCancelSequence();
+  if (length > SMARTINTERCOM_GPIO_PATTERN_MAX) {
+    length = SMARTINTERCOM_GPIO_PATTERN_MAX;
+  }
+  if (pattern == nullptr || length <= 0) {
+    smartIntercomApplyState(false);
+    return;
+  }
+  for (int i = 0; i < length; i++) {
+    smartIntercomSequencePattern[i] = pattern[i] < 0 ? 0 : pattern[i];
+  }
+  smartIntercomSequenceLength = length;
+  smartIntercomApplyState(true);
+  smartIntercomStartSequence(SMARTINTERCOM_SEQUENCE_PATTERN, smartIntercomSequencePattern[0]);
+}
+
+/*
+ * SmartIntercomGPIOSequence Set PWM
+ * Установить PWM значение для SmartIntercom
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomSetPWM(int value) {
+  smartIntercomCancelSequence();
+  smartIntercomApplyPWM(value);
+}
+
+/*
+ * SmartIntercomGPIOSequence Fade
+ * Плавное изменение яркости для SmartIntercom LED
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomFade(int from, int to, unsigned long duration) {
+  smartIntercomSequenceFrom = from;
+  smartIntercomSequenceTo = to;
+  smartIntercomSequenceDuration = duration;
+  smartIntercomStartSequence(SMARTINTERCOM_SEQUENCE_FADE, 0);
+}
+
+/*
+ * SmartIntercomGPIOSequence Blink
+ * Мигание светодиода SmartIntercom
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomBlink(int times, int onTime, int offTime) {
+  smartIntercomCancelSequence();
+  if (times <= 0) {
+    return;
+  }
+  smartIntercomSequenceLength = times;
+  smartIntercomSequenceOnTime = onTime;
+  smartIntercomSequenceOffTime = offTime;
+  smartIntercomApplyState(true);
+  smartIntercomStartSequence(SMARTINTERCOM_SEQUENCE_BLINK, onTime);
+}
+
+/*
+ * SmartIntercomGPIOSequence Cancel Sequence
+ * Отменить активную последовательность SmartIntercom
+ */
+template <class PinPolicy>
+void SmartIntercomGPIOSequence<PinPolicy>::smartIntercomCancelSequence() {
+  if (smartIntercomSequenceJob != SMARTINTERCOM_JOB_NONE) {
+    smartIntercomScheduler.smartIntercomCancel(smartIntercomSequenceJob);
+    smartIntercomSequenceJob = SMARTINTERCOM_JOB_NONE;
+  }
+  smartIntercomSequenceType = SMARTINTERCOM_SEQUENCE_NONE;
+}
+
+#endif // SMARTINTERCOM_GPIO_SEQUENCE_H
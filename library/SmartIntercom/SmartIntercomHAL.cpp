@@ -0,0 +1,286 @@
+/*
+ * SmartIntercomHAL.cpp - Реализация HAL SmartIntercom для Arduino
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Loop Phase
+volatile uint8_t smartIntercomPhase = SMARTINTERCOM_PHASE_SETUP;
+volatile uint32_t smartIntercomPhaseMarks = 0;
+SmartIntercomPhaseHook smartIntercomPhaseHook = nullptr;
+void* smartIntercomPhaseHookContext = nullptr;
+
+static const char* const smartIntercomPhaseNames[SMARTINTERCOM_PHASES] = {
+  "setup", "idle", "http", "mdns", "update", "callback", "wifi", "api", "mqtt"
+};
+
+/*
+ * SmartIntercom Set Phase Hook
+ * Подключить наблюдателя отметок фаз SmartIntercom (из главного цикла)
+ */
+void smartIntercomSetPhaseHook(SmartIntercomPhaseHook hook, void* context) {
+  smartIntercomPhaseHookContext = context;
+  smartIntercomPhaseHook = hook;
+}
+
+const char* smartIntercomGetPhaseName(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomPhaseNames[phase] : "unknown";
+}
+
+#ifdef ARDUINO
+
+#if defined(ESP8266)
+#include <core_version.h>
+#if defined(ARDUINO_ESP8266_MAJOR) && ARDUINO_ESP8266_MAJOR >= 3
+#include <coredecls.h>
+#define SMARTINTERCOM_HAS_ESP_DELAY 1
+#endif
+
+// SmartIntercom Timer1 Configuration: 80 MHz / 16 = 5 ticks per microsecond
+#define SMARTINTERCOM_TIMER1_TICKS_PER_US 5
+
+static SmartIntercomTimerCallback smartIntercomTimerCallback = nullptr;
+static void* smartIntercomTimerContext = nullptr;
+
+/*
+ * SmartIntercom Timer1 ISR
+ * Трамплин прерывания timer1 к обработчику SmartIntercom
+ */
+static void IRAM_ATTR smartIntercomTimer1ISR() {
+  if (smartIntercomTimerCallback) {
+    smartIntercomTimerCallback(smartIntercomTimerContext);
+  }
+  smartIntercomActiveHAL->smartIntercomRunTimerHook();
+}
+#endif
+
+/*
+ * SmartIntercomArduinoHAL - HAL SmartIntercom поверх Arduino API
+ */
+class SmartIntercomArduinoHAL : public SmartIntercomHAL {
+public:
+  unsigned long smartIntercomMillis() override { return millis(); }
+  unsigned long smartIntercomMicros() override { return micros(); }
+  void smartIntercomDelay(unsigned long ms) override { delay(ms); }
+  void smartIntercomPinMode(int pin, int mode) override { pinMode(pin, mode); }
+  void smartIntercomDigitalWrite(int pin, int value) override { digitalWrite(pin, value); }
+  int smartIntercomDigitalRead(int pin) override { return digitalRead(pin); }
+  int smartIntercomAnalogRead(int pin) override { return analogRead(pin); }
+  void smartIntercomAnalogWrite(int pin, int value) override { analogWrite(pin, value); }
+
+#if defined(ESP8266)
+  /*
+   * SmartIntercomArduinoHAL Write Outputs
+   * Пакет выходов SmartIntercom: GPIO0-15 одной записью в GPOS и одной в GPOC
+   *
+   * GPIO16 живет в отдельном регистре RTC (GP16O) и пишется следом.
+   */
+  void smartIntercomWriteOutputs(uint32_t setMask, uint32_t clearMask) override {
+    GPOS = setMask & 0xFFFF;
+    GPOC = clearMask & 0xFFFF;
+    if ((setMask | clearMask) & (1UL << 16)) {
+      GP16O = (setMask & (1UL << 16)) ? 1 : 0;
+    }
+  }
+#endif
+
+  /*
+   * SmartIntercomArduinoHAL Start Timer
+   * Периодический таймер SmartIntercom на timer1 (ESP8266)
+   */
+  bool smartIntercomStartTimer(unsigned long periodUs, SmartIntercomTimerCallback callback,
+                               void* context) override {
+#if defined(ESP8266)
+    timer1_disable();
+    smartIntercomTimerCallback = callback;
+    smartIntercomTimerContext = context;
+    timer1_attachInterrupt(smartIntercomTimer1ISR);
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+    timer1_write(periodUs * SMARTINTERCOM_TIMER1_TICKS_PER_US);
+    return true;
+#else
+    (void)periodUs;
+    (void)callback;
+    (void)context;
+    return false;
+#endif
+  }
+
+  void smartIntercomStopTimer() override {
+#if defined(ESP8266)
+    timer1_disable();
+    timer1_detachInterrupt();
+    smartIntercomTimerCallback = nullptr;
+#endif
+  }
+
+#if defined(ESP8266)
+  /*
+   * SmartIntercomArduinoHAL Heap
+   * Куча SmartIntercom (umm_malloc): свободно, наибольший блок и фрагментация
+   * одним проходом под блокировкой, поэтому три значения согласованы
+   */
+  uint32_t smartIntercomGetFreeHeap() override { return ESP.getFreeHeap(); }
+
+  bool smartIntercomGetHeap(SmartIntercomHeapInfo* info) override {
+    uint32_t freeBytes = 0;
+    uint16_t largestBlock = 0;
+    uint8_t fragmentation = 0;
+    ESP.getHeapStats(&freeBytes, &largestBlock, &fragmentation);
+    info->freeBytes = freeBytes;
+    info->largestBlock = largestBlock;
+    info->fragmentation = fragmentation;
+    return true;
+  }
+#endif
+
+#if defined(SMARTINTERCOM_HAS_ESP_DELAY)
+  /*
+   * SmartIntercomArduinoHAL Idle Wait
+   * Сон SmartIntercom в esp_delay(): процессор простаивает в SDK (WiFi в modem sleep),
+   * пробуждение - по сроку, smartIntercomWake() из прерывания или check
+   */
+  void smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check, void* context) override {
+    esp_delay(maxMs, [this, check, context]() {
+      return !smartIntercomWakePending && (check == nullptr || !check(context));
+    }, check != nullptr ? SMARTINTERCOM_IDLE_SLICE_MS : maxMs);
+    smartIntercomWakePending = false;
+  }
+
+  void IRAM_ATTR smartIntercomWake() override {
+    smartIntercomWakePending = true;
+    esp_schedule();
+  }
+#endif
+};
+
+static SmartIntercomArduinoHAL smartIntercomArduinoHAL;
+SmartIntercomHAL* smartIntercomActiveHAL = &smartIntercomArduinoHAL;
+
+#else
+
+// SmartIntercom Host builds must install a HAL (e.g. the simulator board)
+SmartIntercomHAL* smartIntercomActiveHAL = nullptr;
+
+#endif
+
+/*
+ * SmartIntercomHAL Idle Wait
+ * Сон SmartIntercom отрезками по SMARTINTERCOM_IDLE_SLICE_MS через smartIntercomDelay()
+ *
+ * Реализация по умолчанию для ядер без пробуждения из прерывания:
+ * smartIntercomWake() и check замечаются на границе отрезка.
+ */
+void SmartIntercomHAL::smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check, void* context) {
+  unsigned long start = smartIntercomMillis();
+  while (!smartIntercomWakePending && (check == nullptr || !check(context))) {
+    unsigned long elapsed = smartIntercomMillis() - start;
+    if (elapsed >= maxMs) {
+      break;
+    }
+    unsigned long slice = maxMs - elapsed;
+    smartIntercomDelay(slice < SMARTINTERCOM_IDLE_SLICE_MS ? slice : SMARTINTERCOM_IDLE_SLICE_MS);
+  }
+  smartIntercomWakePending = false;
+}
+
+/*
+ * SmartIntercomHAL Write Outputs
+ * Реализация по умолчанию: по digitalWrite на пин, сначала установки, затем сбросы
+ */
+void SmartIntercomHAL::smartIntercomWriteOutputs(uint32_t setMask, uint32_t clearMask) {
+  for (int pin = 0; setMask != 0; pin++, setMask >>= 1) {
+    if (setMask & 1) {
+      smartIntercomDigitalWrite(pin, HIGH);
+    }
+  }
+  for (int pin = 0; clearMask != 0; pin++, clearMask >>= 1) {
+    if (clearMask & 1) {
+      smartIntercomDigitalWrite(pin, LOW);
+    }
+  }
+}
+
+// ============================================================================
+// SmartIntercom Output Batch
+// ============================================================================
+
+static uint32_t smartIntercomShadowSet = 0;
+static uint32_t smartIntercomShadowClear = 0;
+static uint8_t smartIntercomBatchDepth = 0;
+static uint32_t smartIntercomBatchCommits = 0;
+static uint32_t smartIntercomBatchWrites = 0;
+
+/*
+ * SmartIntercom Output Begin
+ * Открыть пакет выходов SmartIntercom (пакеты вкладываются)
+ */
+void smartIntercomOutputBegin() {
+  smartIntercomBatchDepth++;
+}
+
+/*
+ * SmartIntercom Output Write
+ * Отметить уровень пина SmartIntercom в теневых масках (вне пакета - сразу)
+ */
+void smartIntercomOutputWrite(int pin, int value) {
+  if (smartIntercomBatchDepth == 0 || pin < 0 || pin >= SMARTINTERCOM_OUTPUT_BATCH_PINS) {
+    smartIntercomDigitalWrite(pin, value);
+    return;
+  }
+  uint32_t bit = 1UL << pin;
+  if (value) {
+    smartIntercomShadowSet |= bit;
+    smartIntercomShadowClear &= ~bit;
+  } else {
+    smartIntercomShadowClear |= bit;
+    smartIntercomShadowSet &= ~bit;
+  }
+  smartIntercomBatchWrites++;
+}
+
+/*
+ * SmartIntercom Output Commit
+ * Закрыть пакет SmartIntercom; внешний commit пишет маски одной операцией HAL
+ */
+void smartIntercomOutputCommit() {
+  if (smartIntercomBatchDepth == 0 || --smartIntercomBatchDepth > 0) {
+    return;
+  }
+  if ((smartIntercomShadowSet | smartIntercomShadowClear) == 0) {
+    return;
+  }
+  uint32_t setMask = smartIntercomShadowSet;
+  uint32_t clearMask = smartIntercomShadowClear;
+  smartIntercomShadowSet = 0;
+  smartIntercomShadowClear = 0;
+  smartIntercomBatchCommits++;
+  smartIntercomActiveHAL->smartIntercomWriteOutputs(setMask, clearMask);
+}
+
+uint32_t smartIntercomOutputGetCommits() {
+  return smartIntercomBatchCommits;
+}
+
+uint32_t smartIntercomOutputGetBatchedWrites() {
+  return smartIntercomBatchWrites;
+}
+
+/*
+ * SmartIntercom Get HAL
+ * Получить активную реализацию HAL SmartIntercom
+ */
+SmartIntercomHAL* smartIntercomGetHAL() {
+  return smartIntercomActiveHAL;
+}
+
+/*
+ * SmartIntercom Set HAL
+ * Подключить реализацию HAL SmartIntercom
+ */
+void smartIntercomSetHAL(SmartIntercomHAL* hal) {
+  smartIntercomActiveHAL = hal;
+}
@@ -0,0 +1,269 @@
+/*
+ * SmartIntercomHAL.h - Слой абстракции оборудования SmartIntercom
+ *
+ * Все обращения библиотеки SmartIntercom к времени, GPIO и АЦП
+ * проходят через интерфейс SmartIntercomHAL. На плате используется
+ * реализация поверх Arduino API, на хосте - симулятор платы
+ * с детерминированными виртуальными часами (см. host/).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HAL_H
+#define SMARTINTERCOM_HAL_H
+
+#include <Arduino.h>
+
+// SmartIntercom Interrupt Attribute (not every core defines it)
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// SmartIntercom Compiler Barrier for ISR/loop shared data
+#define SMARTINTERCOM_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/*
+ * SmartIntercomTimerCallback - Обработчик периодического таймера SmartIntercom
+ *
+ * Вызывается из контекста прерывания: без Serial, без new и без delay().
+ */
+typedef void (*SmartIntercomTimerCallback)(void* context);
+
+/*
+ * SmartIntercomIdleCheck - Проверка готовой работы во время простоя SmartIntercom
+ *
+ * Возвращает true, если ждать больше не нужно (например, пришли данные).
+ */
+typedef bool (*SmartIntercomIdleCheck)(void* context);
+
+// SmartIntercom Idle Configuration
+#ifndef SMARTINTERCOM_IDLE_MAX_MS
+#define SMARTINTERCOM_IDLE_MAX_MS 1000        // Наибольший сон главного цикла (мс)
+#endif
+
+#ifndef SMARTINTERCOM_IDLE_SLICE_MS
+#define SMARTINTERCOM_IDLE_SLICE_MS 2         // Шаг повторной проверки SmartIntercomIdleCheck (мс)
+#endif
+
+/*
+ * SmartIntercomPhase - Фаза главного цикла SmartIntercom
+ *
+ * Отмечается вызовом smartIntercomMarkPhase() при входе в часть loop();
+ * SmartIntercomWatchdog по таймеру смотрит, какая фаза идет и как долго.
+ */
+enum SmartIntercomPhase {
+  SMARTINTERCOM_PHASE_SETUP,          // setup() и все до первой отметки
+  SMARTINTERCOM_PHASE_IDLE,           // Сон в smartIntercomIdleWait() (не зависание)
+  SMARTINTERCOM_PHASE_HTTP,           // Обслуживание соединений HTTP-сервера
+  SMARTINTERCOM_PHASE_MDNS,           // MDNS.update()
+  SMARTINTERCOM_PHASE_UPDATE,         // smartIntercomUpdate(): звонок, дверь, таймеры
+  SMARTINTERCOM_PHASE_CALLBACK,       // Обработчики событий (подписчики, callback)
+  SMARTINTERCOM_PHASE_WIFI,           // Подключение WiFi
+  SMARTINTERCOM_PHASE_API,            // Рассылка статуса API
+  SMARTINTERCOM_PHASE_MQTT,           // MQTT-клиент
+  SMARTINTERCOM_PHASES
+};
+
+/*
+ * SmartIntercomPhaseHook - Наблюдатель смены фаз SmartIntercom
+ *
+ * Вызывается из smartIntercomMarkPhase() (только главный цикл) после
+ * каждой отметки: previous - фаза, которая закончилась.
+ */
+typedef void (*SmartIntercomPhaseHook)(uint8_t previous, uint8_t phase, void* context);
+
+/*
+ * SmartIntercomHeapInfo - Состояние кучи SmartIntercom
+ */
+struct SmartIntercomHeapInfo {
+  uint32_t freeBytes;                 // Свободно всего
+  uint32_t largestBlock;              // Самый большой свободный блок
+  uint8_t fragmentation;              // Фрагментация, % (0 - вся свободная память одним блоком)
+};
+
+// SmartIntercom Output Batch Configuration (пины 0..31 попадают в теневые маски)
+#define SMARTINTERCOM_OUTPUT_BATCH_PINS 32
+
+/*
+ * SmartIntercomHAL - Интерфейс оборудования SmartIntercom
+ *
+ * Реализация подключается через smartIntercomSetHAL() до вызова
+ * smartIntercomBegin(). На Arduino реализация по умолчанию
+ * активна без дополнительной настройки.
+ */
+class SmartIntercomHAL {
+protected:
+  volatile bool smartIntercomWakePending;
+  SmartIntercomTimerCallback smartIntercomTimerHook;
+  void* smartIntercomTimerHookContext;
+
+public:
+  SmartIntercomHAL() : smartIntercomWakePending(false), smartIntercomTimerHook(nullptr),
+                       smartIntercomTimerHookContext(nullptr) {}
+  virtual ~SmartIntercomHAL() {}
+
+  // SmartIntercom Time
+  virtual unsigned long smartIntercomMillis() = 0;
+  virtual unsigned long smartIntercomMicros() = 0;
+  virtual void smartIntercomDelay(unsigned long ms) = 0;
+
+  // SmartIntercom GPIO
+  virtual void smartIntercomPinMode(int pin, int mode) = 0;
+  virtual void smartIntercomDigitalWrite(int pin, int value) = 0;
+  virtual int smartIntercomDigitalRead(int pin) = 0;
+  virtual int smartIntercomAnalogRead(int pin) = 0;
+  virtual void smartIntercomAnalogWrite(int pin, int value) = 0;
+
+  // SmartIntercom Batched Outputs (бит N - пин N; одна запись set/clear на плате)
+  virtual void smartIntercomWriteOutputs(uint32_t setMask, uint32_t clearMask);
+
+  // SmartIntercom Periodic Timer (один аппаратный таймер на плату)
+  virtual bool smartIntercomStartTimer(unsigned long periodUs, SmartIntercomTimerCallback callback,
+                                       void* context) = 0;
+  virtual void smartIntercomStopTimer() = 0;
+
+  // SmartIntercom Timer Hook (второй обработчик на тех же тиках, после основного; из прерывания)
+  void smartIntercomSetTimerHook(SmartIntercomTimerCallback hook, void* context) {
+    smartIntercomTimerHook = nullptr;
+    SMARTINTERCOM_COMPILER_BARRIER();
+    smartIntercomTimerHookContext = context;
+    SMARTINTERCOM_COMPILER_BARRIER();
+    smartIntercomTimerHook = hook;
+  }
+  inline void smartIntercomRunTimerHook() {
+    SmartIntercomTimerCallback hook = smartIntercomTimerHook;
+    if (hook != nullptr) {
+      hook(smartIntercomTimerHookContext);
+    }
+  }
+
+  // SmartIntercom Heap (0 и false - платформа не сообщает состояние кучи)
+  virtual uint32_t smartIntercomGetFreeHeap() { return 0; }
+  virtual bool smartIntercomGetHeap(SmartIntercomHeapInfo* info) {
+    (void)info;
+    return false;
+  }
+
+  // SmartIntercom Idle (сон до maxMs, раньше - по smartIntercomWake() или check)
+  virtual void smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check, void* context);
+  virtual void smartIntercomWake() { smartIntercomWakePending = true; }
+};
+
+// SmartIntercom HAL Selection
+SmartIntercomHAL* smartIntercomGetHAL();
+void smartIntercomSetHAL(SmartIntercomHAL* hal);
+
+// SmartIntercom Active HAL (используется inline-обертками ниже)
+extern SmartIntercomHAL* smartIntercomActiveHAL;
+
+/*
+ * SmartIntercom HAL Wrappers
+ * Короткие обертки над активной реализацией HAL SmartIntercom
+ */
+inline unsigned long smartIntercomMillis() {
+  return smartIntercomActiveHAL->smartIntercomMillis();
+}
+
+inline unsigned long smartIntercomMicros() {
+  return smartIntercomActiveHAL->smartIntercomMicros();
+}
+
+inline void smartIntercomDelay(unsigned long ms) {
+  smartIntercomActiveHAL->smartIntercomDelay(ms);
+}
+
+inline void smartIntercomPinMode(int pin, int mode) {
+  smartIntercomActiveHAL->smartIntercomPinMode(pin, mode);
+}
+
+inline void smartIntercomDigitalWrite(int pin, int value) {
+  smartIntercomActiveHAL->smartIntercomDigitalWrite(pin, value);
+}
+
+inline int smartIntercomDigitalRead(int pin) {
+  return smartIntercomActiveHAL->smartIntercomDigitalRead(pin);
+}
+
+inline int smartIntercomAnalogRead(int pin) {
+  return smartIntercomActiveHAL->smartIntercomAnalogRead(pin);
+}
+
+inline void smartIntercomAnalogWrite(int pin, int value) {
+  smartIntercomActiveHAL->smartIntercomAnalogWrite(pin, value);
+}
+
+inline bool smartIntercomStartTimer(unsigned long periodUs, SmartIntercomTimerCallback callback,
+                                    void* context) {
+  return smartIntercomActiveHAL->smartIntercomStartTimer(periodUs, callback, context);
+}
+
+inline void smartIntercomStopTimer() {
+  smartIntercomActiveHAL->smartIntercomStopTimer();
+}
+
+inline uint32_t smartIntercomGetFreeHeap() {
+  return smartIntercomActiveHAL->smartIntercomGetFreeHeap();
+}
+
+inline bool smartIntercomGetHeap(SmartIntercomHeapInfo* info) {
+  return smartIntercomActiveHAL->smartIntercomGetHeap(info);
+}
+
+inline void smartIntercomSetTimerHook(SmartIntercomTimerCallback hook, void* context) {
+  smartIntercomActiveHAL->smartIntercomSetTimerHook(hook, context);
+}
+
+// SmartIntercom Loop Phase (текущая фаза и число отметок; читаются из прерывания)
+extern volatile uint8_t smartIntercomPhase;
+extern volatile uint32_t smartIntercomPhaseMarks;
+extern SmartIntercomPhaseHook smartIntercomPhaseHook;
+extern void* smartIntercomPhaseHookContext;
+
+// SmartIntercom Phase Hook (один наблюдатель; nullptr - отключить)
+void smartIntercomSetPhaseHook(SmartIntercomPhaseHook hook, void* context);
+const char* smartIntercomGetPhaseName(uint8_t phase);
+
+// SmartIntercom Mark Phase (возвращает прошлую фазу, чтобы вернуть ее после вложенной части)
+inline uint8_t smartIntercomMarkPhase(uint8_t phase) {
+  uint8_t previous = smartIntercomPhase;
+  smartIntercomPhase = phase;
+  smartIntercomPhaseMarks = smartIntercomPhaseMarks + 1;
+  if (smartIntercomPhaseHook != nullptr) {
+    smartIntercomPhaseHook(previous, phase, smartIntercomPhaseHookContext);
+  }
+  return previous;
+}
+
+inline void smartIntercomIdleWait(unsigned long maxMs, SmartIntercomIdleCheck check = nullptr,
+                                  void* context = nullptr) {
+  uint8_t phase = smartIntercomMarkPhase(SMARTINTERCOM_PHASE_IDLE);
+  smartIntercomActiveHAL->smartIntercomIdleWait(maxMs, check, context);
+  smartIntercomMarkPhase(phase);
+}
+
+// SmartIntercom Wake (можно вызывать из прерывания)
+inline void smartIntercomWake() {
+  smartIntercomActiveHAL->smartIntercomWake();
+}
+
+/*
+ * SmartIntercom Output Batch - Теневые регистры выходов SmartIntercom
+ *
+ * Между smartIntercomOutputBegin() и smartIntercomOutputCommit()
+ * smartIntercomOutputWrite() только отмечает пин в теневых масках
+ * установки и сброса (последняя запись пина побеждает). Commit
+ * переключает все отмеченные пины одной записью в регистры set/clear
+ * (GPOS/GPOC на ESP8266), поэтому переходы нескольких пинов - трубка,
+ * реле замка, LED - происходят одновременно и без промежуточных
+ * состояний. Пары begin/commit могут вкладываться, запись выполняет
+ * внешний commit. Вне пакета запись идет сразу через digitalWrite.
+ * Только главный цикл; пины с PWM через пакет не пишутся.
+ */
+void smartIntercomOutputBegin();
+void smartIntercomOutputWrite(int pin, int value);
+void smartIntercomOutputCommit();
+uint32_t smartIntercomOutputGetCommits();
+uint32_t smartIntercomOutputGetBatchedWrites();
+
+#endif // SMARTINTERCOM_HAL_H
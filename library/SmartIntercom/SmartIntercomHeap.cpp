@@ -0,0 +1,272 @@
+/*
+ * SmartIntercomHeap.cpp - Реализация наблюдения за кучей SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomHeap.h"
+#include "SmartIntercomLog.h"
+
+/*
+ * SmartIntercomHeap Constructor
+ */
+SmartIntercomHeap::SmartIntercomHeap() {
+  smartIntercomArena = nullptr;
+  smartIntercomPeriodMs = SMARTINTERCOM_HEAP_PERIOD_MS;
+  smartIntercomLastSampleMs = 0;
+  smartIntercomActive = false;
+  smartIntercomLast.freeBytes = 0;
+  smartIntercomLast.largestBlock = 0;
+  smartIntercomLast.fragmentation = 0;
+  smartIntercomClear();
+}
+
+/*
+ * SmartIntercomHeap Begin
+ * Первый отсчет SmartIntercom и наблюдатель отметок фаз
+ */
+bool SmartIntercomHeap::smartIntercomBegin(unsigned long periodMs) {
+  smartIntercomEnd();
+  SmartIntercomHeapInfo info;
+  if (!smartIntercomGetHeap(&info)) {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Heap state is not available on this platform");
+    return false;
+  }
+  smartIntercomPeriodMs = periodMs > 0 ? periodMs : SMARTINTERCOM_HEAP_PERIOD_MS;
+  smartIntercomActive = true;
+  smartIntercomClear();
+  smartIntercomSample();
+  smartIntercomSetPhaseHook(smartIntercomOnPhase, this);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Heap %lu bytes free, largest block %lu, fragmentation %u%%",
+                         (unsigned long)smartIntercomLast.freeBytes, (unsigned long)smartIntercomLast.largestBlock,
+                         smartIntercomLast.fragmentation);
+  return true;
+}
+
+void SmartIntercomHeap::smartIntercomEnd() {
+  if (smartIntercomActive) {
+    smartIntercomSetPhaseHook(nullptr, nullptr);
+  }
+  smartIntercomActive = false;
+}
+
+/*
+ * SmartIntercomHeap Clear
+ * Худшие значения SmartIntercom начинаются с текущего состояния кучи
+ */
+void SmartIntercomHeap::smartIntercomClear() {
+  smartIntercomHistoryHead = 0;
+  smartIntercomMinFree = 0xFFFFFFFFUL;
+  smartIntercomMinLargest = 0xFFFFFFFFUL;
+  smartIntercomMaxFragmentation = 0;
+  smartIntercomLowWarned = false;
+  SmartIntercomHeapInfo info;
+  if (!smartIntercomRead(&info)) {
+    smartIntercomMinFree = smartIntercomLast.freeBytes;
+    smartIntercomMinLargest = smartIntercomLast.largestBlock;
+  }
+  smartIntercomMarkFree = smartIntercomLast.freeBytes;
+  for (uint8_t phase = 0; phase < SMARTINTERCOM_PHASES; phase++) {
+    smartIntercomHighWater[phase] = 0;
+    smartIntercomLowFree[phase] = 0;
+  }
+  if (smartIntercomArena != nullptr) {
+    smartIntercomArena->smartIntercomClearStats();
+  }
+}
+
+/*
+ * SmartIntercomHeap On Phase
+ * Отметка фазы SmartIntercom: сколько кучи ушло за закончившийся проход
+ *
+ * Только чтение счетчика свободной памяти - без обхода списка блоков,
+ * поэтому отметки в горячих местах (обработчики событий) дешевы.
+ */
+void SmartIntercomHeap::smartIntercomOnPhase(uint8_t previous, uint8_t phase, void* context) {
+  (void)phase;
+  SmartIntercomHeap* heap = static_cast<SmartIntercomHeap*>(context);
+  uint32_t freeBytes = smartIntercomGetFreeHeap();
+  if (previous < SMARTINTERCOM_PHASES) {
+    if (heap->smartIntercomMarkFree > freeBytes &&
+        heap->smartIntercomMarkFree - freeBytes > heap->smartIntercomHighWater[previous]) {
+      heap->smartIntercomHighWater[previous] = heap->smartIntercomMarkFree - freeBytes;
+    }
+    if (heap->smartIntercomLowFree[previous] == 0 || freeBytes < heap->smartIntercomLowFree[previous]) {
+      heap->smartIntercomLowFree[previous] = freeBytes;
+    }
+  }
+  if (freeBytes < heap->smartIntercomMinFree) {
+    heap->smartIntercomMinFree = freeBytes;
+  }
+  heap->smartIntercomMarkFree = freeBytes;
+}
+
+/*
+ * SmartIntercomHeap Read
+ * Полное чтение кучи SmartIntercom (обход свободных блоков) и худшие значения
+ */
+bool SmartIntercomHeap::smartIntercomRead(SmartIntercomHeapInfo* info) {
+  if (!smartIntercomActive || !smartIntercomGetHeap(info)) {
+    return false;
+  }
+  smartIntercomLast = *info;
+  if (info->freeBytes < smartIntercomMinFree) {
+    smartIntercomMinFree = info->freeBytes;
+  }
+  if (info->largestBlock < smartIntercomMinLargest) {
+    smartIntercomMinLargest = info->largestBlock;
+  }
+  if (info->fragmentation > smartIntercomMaxFragmentation) {
+    smartIntercomMaxFragmentation = info->fragmentation;
+  }
+  if (info->largestBlock < SMARTINTERCOM_HEAP_LOW_BLOCK) {
+    if (!smartIntercomLowWarned) {
+      smartIntercomLowWarned = true;
+      SMARTINTERCOM_LOG_WARNING("SmartIntercom: Largest free heap block is %lu bytes (%lu free, %u%% fragmented)",
+                                (unsigned long)info->largestBlock, (unsigned long)info->freeBytes,
+                                info->fragmentation);
+    }
+  } else {
+    smartIntercomLowWarned = false;
+  }
+  return true;
+}
+
+/*
+ * SmartIntercomHeap Sample
+ * Отсчет ряда SmartIntercom (кольцо, старые отсчеты перезаписываются)
+ */
+void SmartIntercomHeap::smartIntercomSample() {
+  SmartIntercomHeapInfo info;
+  smartIntercomLastSampleMs = smartIntercomMillis();
+  if (!smartIntercomRead(&info)) {
+    return;
+  }
+  SmartIntercomHeapSample& sample = smartIntercomHistory[smartIntercomHistoryHead % SMARTINTERCOM_HEAP_HISTORY];
+  sample.timeS = smartIntercomLastSampleMs / 1000UL;
+  sample.freeBytes = info.freeBytes;
+  sample.largestBlock = info.largestBlock < 0xFFFF ? (uint16_t)info.largestBlock : 0xFFFF;
+  sample.fragmentation = info.fragmentation;
+  sample.reserved = 0;
+  smartIntercomHistoryHead++;
+}
+
+/*
+ * SmartIntercomHeap Update
+ */
+void SmartIntercomHeap::smartIntercomUpdate() {
+  if (smartIntercomActive && smartIntercomMillis() - smartIntercomLastSampleMs >= smartIntercomPeriodMs) {
+    smartIntercomSample();
+  }
+}
+
+unsigned long SmartIntercomHeap::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (!smartIntercomActive) {
+    return maxMs;
+  }
+  unsigned long elapsed = smartIntercomMillis() - smartIntercomLastSampleMs;
+  if (elapsed >= smartIntercomPeriodMs) {
+    return 0;
+  }
+  unsigned long remaining = smartIntercomPeriodMs - elapsed;
+  return remaining < maxMs ? remaining : maxMs;
+}
+
+// ============================================================================
+// SmartIntercom Heap Queries
+// ============================================================================
+
+uint32_t SmartIntercomHeap::smartIntercomGetHighWater(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomHighWater[phase] : 0;
+}
+
+uint32_t SmartIntercomHeap::smartIntercomGetLowFree(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomLowFree[phase] : 0;
+}
+
+uint32_t SmartIntercomHeap::smartIntercomGetSampleCount() {
+  return smartIntercomHistoryHead < SMARTINTERCOM_HEAP_HISTORY ? smartIntercomHistoryHead : SMARTINTERCOM_HEAP_HISTORY;
+}
+
+bool SmartIntercomHeap::smartIntercomGetSample(uint32_t index, SmartIntercomHeapSample* sample) {
+  uint32_t count = smartIntercomGetSampleCount();
+  if (index >= count) {
+    return false;
+  }
+  *sample = smartIntercomHistory[(smartIntercomHistoryHead - count + index) % SMARTINTERCOM_HEAP_HISTORY];
+  return true;
+}
+
+/*
+ * SmartIntercomHeap Write JSON
+ * Тело GET /api/heap SmartIntercom: по одному объекту за вызов генератора
+ *
+ * Позиция в младших 24 битах cursor, число отсчетов ряда на момент
+ * первого вызова - в старших 8, чтобы новый отсчет посреди ответа
+ * не сдвинул массив.
+ */
+size_t SmartIntercomHeap::smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomHeap* heap = static_cast<SmartIntercomHeap*>(context);
+  if (*cursor == 0) {
+    *cursor = heap->smartIntercomGetSampleCount() << 24;
+  }
+  uint32_t count = *cursor >> 24;
+  uint32_t historyAt = SMARTINTERCOM_PHASES + 1;
+  size_t used = 0;
+
+  while ((*cursor & 0xFFFFFF) <= historyAt + count) {
+    uint32_t position = *cursor & 0xFFFFFF;
+    char* item = out + used;
+    size_t space = size - used;
+    int written;
+    if (position == 0) {
+      SmartIntercomHeapInfo info;
+      heap->smartIntercomRead(&info);
+      const SmartIntercomHeapInfo& last = heap->smartIntercomLast;
+      written = snprintf(item, space,
+                         "{\"free\":%lu,\"largest_block\":%lu,\"fragmentation\":%u,\"min_free\":%lu,"
+                         "\"min_largest_block\":%lu,\"max_fragmentation\":%u,\"period_ms\":%lu,",
+                         (unsigned long)last.freeBytes, (unsigned long)last.largestBlock, last.fragmentation,
+                         (unsigned long)heap->smartIntercomMinFree, (unsigned long)heap->smartIntercomMinLargest,
+                         heap->smartIntercomMaxFragmentation, heap->smartIntercomPeriodMs);
+      SmartIntercomArena* arena = heap->smartIntercomArena;
+      if (written >= 0 && (size_t)written < space) {
+        int tail = arena != nullptr
+                     ? snprintf(item + written, space - written,
+                                "\"arena\":{\"capacity\":%lu,\"high_water\":%lu,\"failures\":%lu},\"phases\":[",
+                                (unsigned long)arena->smartIntercomGetCapacity(),
+                                (unsigned long)arena->smartIntercomGetHighWater(),
+                                (unsigned long)arena->smartIntercomGetFailures())
+                     : snprintf(item + written, space - written, "\"arena\":null,\"phases\":[");
+        written = tail >= 0 ? written + tail : tail;
+      }
+    } else if (position <= SMARTINTERCOM_PHASES) {
+      uint8_t phase = (uint8_t)(position - 1);
+      written = snprintf(item, space, "%s{\"phase\":\"%s\",\"high_water\":%lu,\"low_free\":%lu}",
+                         phase > 0 ? "," : "", smartIntercomGetPhaseName(phase),
+                         (unsigned long)heap->smartIntercomHighWater[phase],
+                         (unsigned long)heap->smartIntercomLowFree[phase]);
+    } else if (position == historyAt + count) {
+      written = snprintf(item, space, "%s]}", count > 0 ? "" : "],\"history\":[");
+    } else {
+      SmartIntercomHeapSample sample;
+      uint32_t index = position - historyAt;
+      if (!heap->smartIntercomGetSample(index + heap->smartIntercomGetSampleCount() - count, &sample)) {
+        sample.timeS = 0;
+        sample.freeBytes = 0;
+        sample.largestBlock = 0;
+        sample.fragmentation = 0;
+      }
+      written = snprintf(item, space, "%s{\"s\":%lu,\"free\":%lu,\"largest_block\":%u,\"fragmentation\":%u}",
+                         index == 0 ? "],\"history\":[" : ",", (unsigned long)sample.timeS,
+                         (unsigned long)sample.freeBytes, sample.largestBlock, sample.fragmentation);
+    }
+    if (written < 0 || (size_t)written >= space) {
+      break;
+    }
+    used += written;
+    (*cursor)++;
+  }
+  return used;
+}
@@ -0,0 +1,131 @@
+/*
+ * SmartIntercomHeap.h - Наблюдение за кучей SmartIntercom
+ *
+ * Куча ESP8266 (umm_malloc) за дни работы фрагментируется: свободной
+ * памяти хватает, но наибольший свободный блок уменьшается, и
+ * выделения, которым нужен непрерывный кусок (буферы lwIP, TLS),
+ * начинают отказывать. SmartIntercomHeap показывает, к чему идет дело:
+ *
+ *   Ряд            раз в SMARTINTERCOM_HEAP_PERIOD_MS - свободно,
+ *                  наибольший блок и фрагментация; последние
+ *                  SMARTINTERCOM_HEAP_HISTORY отсчетов и худшие
+ *                  значения с момента старта.
+ *   Фазы           на каждой отметке smartIntercomMarkPhase()
+ *                  (SmartIntercomHAL.h) читается свободная память;
+ *                  для каждой фазы loop() запоминается наибольшая
+ *                  убыль кучи за один проход (high_water) и меньше
+ *                  всего свободной памяти на выходе из нее (low_free).
+ *                  Выделения SDK и lwIP между проходами loop()
+ *                  попадают в фазу idle.
+ *   Арена          заполнение арены запроса HTTP-сервера
+ *                  (SmartIntercomArena.h), если она подключена.
+ *
+ * Куча читается через HAL: на хосте симулятор платы отдает
+ * сценарные значения (smartIntercomSetHeap).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HEAP_H
+#define SMARTINTERCOM_HEAP_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomArena.h"
+
+// SmartIntercom Heap Configuration
+#ifndef SMARTINTERCOM_HEAP_PERIOD_MS
+#define SMARTINTERCOM_HEAP_PERIOD_MS 60000            // Период отсчетов ряда
+#endif
+
+#ifndef SMARTINTERCOM_HEAP_HISTORY
+#define SMARTINTERCOM_HEAP_HISTORY 32                 // Отсчетов в ряду
+#endif
+
+#if SMARTINTERCOM_HEAP_HISTORY > 255
+#error "SMARTINTERCOM_HEAP_HISTORY must fit the 8-bit count of the JSON cursor"
+#endif
+
+#ifndef SMARTINTERCOM_HEAP_LOW_BLOCK
+#define SMARTINTERCOM_HEAP_LOW_BLOCK 4096             // Наибольший блок меньше - предупреждение в журнал
+#endif
+
+/*
+ * SmartIntercomHeapSample - Отсчет ряда кучи SmartIntercom
+ */
+struct SmartIntercomHeapSample {
+  uint32_t timeS;                     // SmartIntercom секунды с момента старта
+  uint32_t freeBytes;
+  uint16_t largestBlock;
+  uint8_t fragmentation;
+  uint8_t reserved;
+};
+
+/*
+ * SmartIntercomHeap - Ряд и высшие отметки кучи SmartIntercom
+ */
+class SmartIntercomHeap {
+private:
+  SmartIntercomArena* smartIntercomArena;
+  unsigned long smartIntercomPeriodMs;
+  unsigned long smartIntercomLastSampleMs;
+  bool smartIntercomActive;
+  bool smartIntercomLowWarned;
+
+  // SmartIntercom Heap Series
+  SmartIntercomHeapSample smartIntercomHistory[SMARTINTERCOM_HEAP_HISTORY];
+  uint32_t smartIntercomHistoryHead;  // SmartIntercom отсчетов за все время
+  SmartIntercomHeapInfo smartIntercomLast;
+  uint32_t smartIntercomMinFree;
+  uint32_t smartIntercomMinLargest;
+  uint8_t smartIntercomMaxFragmentation;
+
+  // SmartIntercom Phase High-Water Marks
+  uint32_t smartIntercomMarkFree;
+  uint32_t smartIntercomHighWater[SMARTINTERCOM_PHASES];
+  uint32_t smartIntercomLowFree[SMARTINTERCOM_PHASES];
+
+  // SmartIntercom Internal Methods
+  static void smartIntercomOnPhase(uint8_t previous, uint8_t phase, void* context);
+  bool smartIntercomRead(SmartIntercomHeapInfo* info);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomHeap();
+
+  // SmartIntercom Initialization (false - платформа не сообщает состояние кучи)
+  bool smartIntercomBegin(unsigned long periodMs = SMARTINTERCOM_HEAP_PERIOD_MS);
+  void smartIntercomEnd();
+  void smartIntercomAttachArena(SmartIntercomArena* arena) { smartIntercomArena = arena; }
+
+  // SmartIntercom Main Loop
+  void smartIntercomUpdate();
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs);
+
+  // SmartIntercom Take a series sample now
+  void smartIntercomSample();
+
+  // SmartIntercom Reset series, worst values and high-water marks
+  void smartIntercomClear();
+
+  // SmartIntercom Heap State (последнее чтение и худшие значения)
+  bool smartIntercomIsActive() { return smartIntercomActive; }
+  const SmartIntercomHeapInfo& smartIntercomGetLast() { return smartIntercomLast; }
+  uint32_t smartIntercomGetMinFree() { return smartIntercomMinFree; }
+  uint32_t smartIntercomGetMinLargestBlock() { return smartIntercomMinLargest; }
+  uint8_t smartIntercomGetMaxFragmentation() { return smartIntercomMaxFragmentation; }
+
+  // SmartIntercom Phase High-Water Marks (0 - фаза еще не заканчивалась)
+  uint32_t smartIntercomGetHighWater(uint8_t phase);
+  uint32_t smartIntercomGetLowFree(uint8_t phase);
+
+  // SmartIntercom Heap Series (index 0 - самый старый отсчет)
+  uint32_t smartIntercomGetSampleCount();
+  bool smartIntercomGetSample(uint32_t index, SmartIntercomHeapSample* sample);
+
+  // SmartIntercom JSON (генератор тела GET /api/heap)
+  static size_t smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context);
+};
+
+#endif // SMARTINTERCOM_HEAP_H
@@ -0,0 +1,943 @@
+/*
+ * SmartIntercomHttp.cpp - Реализация событийного HTTP-сервера SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomHttp.h"
+#include "SmartIntercomMetrics.h"
+#include "SmartIntercomLog.h"
+#include <stdarg.h>
+
+// ============================================================================
+// SmartIntercomHttpResponse Implementation
+// ============================================================================
+
+/*
+ * SmartIntercomHttpResponse Reset
+ * Пустой ответ SmartIntercom: 200 без тела
+ */
+void SmartIntercomHttpResponse::smartIntercomReset() {
+  smartIntercomStatus = 200;
+  smartIntercomContentType = nullptr;
+  smartIntercomHeadersLength = 0;
+  smartIntercomBodyLength = 0;
+  smartIntercomOverflow = false;
+  smartIntercomStaticBody = nullptr;
+  smartIntercomStaticLength = 0;
+  smartIntercomStaticFlash = false;
+  smartIntercomGenerator = nullptr;
+  smartIntercomGeneratorContext = nullptr;
+  smartIntercomGeneratorCursor = 0;
+  smartIntercomStream = false;
+}
+
+/*
+ * SmartIntercomHttpResponse Add Header
+ * Дополнительный заголовок ответа SmartIntercom (имя и значение копируются)
+ */
+void SmartIntercomHttpResponse::smartIntercomAddHeader(const char* name, const char* value) {
+  size_t space = sizeof(smartIntercomHeaders) - smartIntercomHeadersLength;
+  int written = snprintf(smartIntercomHeaders + smartIntercomHeadersLength, space, "%s: %s\r\n", name, value);
+  if (written < 0 || (size_t)written >= space) {
+    smartIntercomOverflow = true;
+    return;
+  }
+  smartIntercomHeadersLength += written;
+}
+
+/*
+ * SmartIntercomHttpResponse Write
+ * Дописать байты в тело ответа SmartIntercom
+ */
+void SmartIntercomHttpResponse::smartIntercomWrite(const char* data, size_t length) {
+  if (length > sizeof(smartIntercomBody) - smartIntercomBodyLength) {
+    smartIntercomOverflow = true;
+    return;
+  }
+  memcpy(smartIntercomBody + smartIntercomBodyLength, data, length);
+  smartIntercomBodyLength += length;
+}
+
+void SmartIntercomHttpResponse::smartIntercomPrint(const char* text) {
+  smartIntercomWrite(text, strlen(text));
+}
+
+/*
+ * SmartIntercomHttpResponse Printf
+ * Форматированный вывод в тело ответа SmartIntercom (формат - PSTR)
+ */
+size_t SmartIntercomHttpResponse::smartIntercomPrintf(const char* format, ...) {
+  size_t space = sizeof(smartIntercomBody) - smartIntercomBodyLength;
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf_P(smartIntercomBody + smartIntercomBodyLength, space, format, args);
+  va_end(args);
+  if (written < 0 || (size_t)written >= space) {
+    smartIntercomOverflow = true;
+    return 0;
+  }
+  smartIntercomBodyLength += written;
+  return written;
+}
+
+/*
+ * SmartIntercomHttpResponse Send
+ * Статус, тип и тело ответа SmartIntercom одним вызовом
+ */
+void SmartIntercomHttpResponse::smartIntercomSend(int status, const char* contentType, const char* body) {
+  smartIntercomStatus = status;
+  smartIntercomContentType = contentType;
+  smartIntercomBodyLength = 0;
+  if (body) {
+    smartIntercomPrint(body);
+  }
+}
+
+/*
+ * SmartIntercomHttpResponse Send Static
+ * Тело из неизменяемых данных SmartIntercom (flash - из PROGMEM), без копии
+ */
+void SmartIntercomHttpResponse::smartIntercomSendStatic(int status, const char* contentType, const uint8_t* data,
+                                                        size_t length, bool flash) {
+  smartIntercomStatus = status;
+  smartIntercomContentType = contentType;
+  smartIntercomBodyLength = 0;
+  smartIntercomStaticBody = data;
+  smartIntercomStaticLength = length;
+  smartIntercomStaticFlash = flash;
+}
+
+/*
+ * SmartIntercomHttpResponse Send Generated
+ * Тело ответа SmartIntercom от генератора (HTTP/1.1 - chunked)
+ */
+void SmartIntercomHttpResponse::smartIntercomSendGenerated(int status, const char* contentType,
+                                                           SmartIntercomHttpGenerator generator, void* context,
+                                                           uint32_t cursor) {
+  smartIntercomStatus = status;
+  smartIntercomContentType = contentType;
+  smartIntercomBodyLength = 0;
+  smartIntercomGenerator = generator;
+  smartIntercomGeneratorContext = context;
+  smartIntercomGeneratorCursor = cursor;
+}
+
+/*
+ * SmartIntercomHttpResponse Begin Stream
+ * Потоковый ответ SmartIntercom: соединение остается открытым для рассылки
+ */
+void SmartIntercomHttpResponse::smartIntercomBeginStream(const char* contentType) {
+  smartIntercomStatus = 200;
+  smartIntercomContentType = contentType;
+  smartIntercomStream = true;
+}
+
+// ============================================================================
+// SmartIntercomHttpServer Implementation
+// ============================================================================
+
+/*
+ * SmartIntercom HTTP Header Match
+ * Сравнение имени заголовка SmartIntercom без учета регистра
+ */
+static bool smartIntercomHttpHeaderIs(const char* line, size_t nameLength, const char* name) {
+  if (strlen(name) != nameLength) {
+    return false;
+  }
+  for (size_t i = 0; i < nameLength; i++) {
+    char a = line[i];
+    char b = name[i];
+    if (a >= 'A' && a <= 'Z') a += 'a' - 'A';
+    if (b >= 'A' && b <= 'Z') b += 'a' - 'A';
+    if (a != b) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * SmartIntercom HTTP Keep Header
+ * Читает ли сервер SmartIntercom заголовок (line - строка или ее начало)
+ */
+static bool smartIntercomHttpKeepHeader(const char* line, size_t length) {
+  const char* colon = (const char*)memchr(line, ':', length);
+  if (colon == nullptr) {
+    return false;
+  }
+  size_t nameLength = colon - line;
+  return smartIntercomHttpHeaderIs(line, nameLength, "Content-Length") ||
+         smartIntercomHttpHeaderIs(line, nameLength, "Connection") ||
+         smartIntercomHttpHeaderIs(line, nameLength, "If-None-Match");
+}
+
+/*
+ * SmartIntercom HTTP Contains Token
+ * Есть ли токен SmartIntercom (keep-alive, close) в значении заголовка
+ */
+static bool smartIntercomHttpHasToken(const char* value, size_t length, const char* token) {
+  size_t tokenLength = strlen(token);
+  for (size_t i = 0; i + tokenLength <= length; i++) {
+    if (smartIntercomHttpHeaderIs(value + i, tokenLength, token)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomHttpServer Constructor
+ */
+SmartIntercomHttpServer::SmartIntercomHttpServer() {
+  smartIntercomTransport = nullptr;
+  smartIntercomRouteCount = 0;
+  smartIntercomRequestsServed = 0;
+  smartIntercomServiceTime = nullptr;
+  smartIntercomConnectionsAccepted = 0;
+  smartIntercomConnectionsRejected = 0;
+  smartIntercomStreamsDropped = 0;
+  smartIntercomArena.smartIntercomBegin(smartIntercomArenaBuffer, sizeof(smartIntercomArenaBuffer));
+  smartIntercomResponse.smartIntercomArena = &smartIntercomArena;
+  for (uint8_t i = 0; i < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; i++) {
+    smartIntercomConnections[i].state = SMARTINTERCOM_HTTP_FREE;
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Begin
+ * Запуск сервера SmartIntercom на транспорте
+ */
+bool SmartIntercomHttpServer::smartIntercomBegin(SmartIntercomHttpTransport* transport, uint16_t port) {
+  smartIntercomTransport = transport;
+  if (transport == nullptr || !transport->smartIntercomListen(port)) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: HTTP server failed to listen on port %u", port);
+    return false;
+  }
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: HTTP server listening on port %u, %u connections", port,
+                         SMARTINTERCOM_HTTP_MAX_CONNECTIONS);
+  return true;
+}
+
+/*
+ * SmartIntercomHttpServer On
+ * Регистрация маршрута SmartIntercom (путь сравнивается целиком, без query;
+ * путь с '*' в конце совпадает с любым продолжением)
+ */
+bool SmartIntercomHttpServer::smartIntercomOn(SmartIntercomHttpMethod method, const char* path,
+                                              SmartIntercomHttpHandler handler, void* context) {
+  if (smartIntercomRouteCount >= SMARTINTERCOM_HTTP_MAX_ROUTES) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: HTTP route table full, %s not registered", path);
+    return false;
+  }
+  SmartIntercomHttpRoute& route = smartIntercomRoutes[smartIntercomRouteCount++];
+  route.method = method;
+  route.path = path;
+  route.handler = handler;
+  route.context = context;
+  return true;
+}
+
+/*
+ * SmartIntercomHttpServer Run
+ * События транспорта SmartIntercom и закрытие простаивающих соединений
+ */
+void SmartIntercomHttpServer::smartIntercomRun(unsigned long timeoutMs) {
+  if (smartIntercomTransport == nullptr) {
+    return;
+  }
+  smartIntercomTransport->smartIntercomPoll(*this, timeoutMs);
+
+  unsigned long now = smartIntercomMillis();
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+    if (connection.state == SMARTINTERCOM_HTTP_READING || connection.state == SMARTINTERCOM_HTTP_WRITING) {
+      if (now - connection.lastActivity > SMARTINTERCOM_HTTP_IDLE_TIMEOUT_MS) {
+        smartIntercomDrop(id);
+      }
+    }
+  }
+}
+
+/*
+ * SmartIntercomHttpServer On Accept
+ * Новое соединение SmartIntercom; SMARTINTERCOM_HTTP_NO_CONNECTION - нет мест
+ */
+uint8_t SmartIntercomHttpServer::smartIntercomOnAccept() {
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+    if (connection.state != SMARTINTERCOM_HTTP_FREE) {
+      continue;
+    }
+    connection.state = SMARTINTERCOM_HTTP_READING;
+    connection.keepAlive = false;
+    connection.headOnly = false;
+    connection.requests = 0;
+    connection.requestTimed = false;
+    connection.lastActivity = smartIntercomMillis();
+    connection.requestLength = 0;
+    smartIntercomResetHead(id);
+    connection.responseLength = 0;
+    connection.responseOffset = 0;
+    connection.staticBody = nullptr;
+    connection.staticRemaining = 0;
+    connection.staticFlash = false;
+    connection.generator = nullptr;
+    connection.chunked = false;
+    smartIntercomConnectionsAccepted++;
+    return id;
+  }
+  smartIntercomConnectionsRejected++;
+  return SMARTINTERCOM_HTTP_NO_CONNECTION;
+}
+
+/*
+ * SmartIntercomHttpServer Get Receive Space
+ * Свободное место в буфере запроса SmartIntercom для чтения из сокета
+ *
+ * Транспорт читает прямо в буфер соединения и сообщает длину через
+ * smartIntercomOnReceived(). 0 - буфер полон, читать пока не нужно.
+ */
+size_t SmartIntercomHttpServer::smartIntercomGetReceiveSpace(uint8_t id, char** buffer) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || smartIntercomConnections[id].state == SMARTINTERCOM_HTTP_FREE) {
+    return 0;
+  }
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  if (connection.state == SMARTINTERCOM_HTTP_STREAMING) {
+    // SmartIntercom Stream subscribers do not send requests: input is read and discarded
+    connection.requestLength = 0;
+    smartIntercomResetHead(id);
+  }
+  *buffer = connection.request + connection.requestLength;
+  return SMARTINTERCOM_HTTP_REQUEST_MAX - connection.requestLength;
+}
+
+/*
+ * SmartIntercomHttpServer On Received
+ * Транспорт дописал length байт в буфер соединения SmartIntercom
+ */
+void SmartIntercomHttpServer::smartIntercomOnReceived(uint8_t id, size_t length) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || smartIntercomConnections[id].state == SMARTINTERCOM_HTTP_FREE) {
+    return;
+  }
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  if (connection.state == SMARTINTERCOM_HTTP_STREAMING) {
+    return;
+  }
+  connection.requestLength += length;
+  connection.lastActivity = smartIntercomMillis();
+  if (connection.state == SMARTINTERCOM_HTTP_READING) {
+    smartIntercomProcess(id);
+  }
+}
+
+/*
+ * SmartIntercomHttpServer On Writable
+ * Сокет SmartIntercom снова принимает данные: дописать ответ
+ */
+void SmartIntercomHttpServer::smartIntercomOnWritable(uint8_t id) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || smartIntercomConnections[id].state == SMARTINTERCOM_HTTP_FREE) {
+    return;
+  }
+  smartIntercomFlush(id);
+  if (smartIntercomConnections[id].state == SMARTINTERCOM_HTTP_READING) {
+    // SmartIntercom Pipelined requests may already be buffered
+    smartIntercomProcess(id);
+  }
+}
+
+/*
+ * SmartIntercomHttpServer On Closed
+ * Клиент SmartIntercom закрыл соединение (сокет транспорт уже освободил)
+ */
+void SmartIntercomHttpServer::smartIntercomOnClosed(uint8_t id) {
+  if (id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS) {
+    smartIntercomConnections[id].state = SMARTINTERCOM_HTTP_FREE;
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Wants Write
+ * Есть ли у соединения SmartIntercom неотправленные данные
+ */
+bool SmartIntercomHttpServer::smartIntercomWantsWrite(uint8_t id) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS) {
+    return false;
+  }
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  return connection.state != SMARTINTERCOM_HTTP_FREE &&
+         (connection.responseOffset < connection.responseLength || connection.staticRemaining > 0 ||
+          connection.generator != nullptr);
+}
+
+/*
+ * SmartIntercomHttpServer Drop
+ * Закрыть соединение SmartIntercom со стороны сервера
+ */
+void SmartIntercomHttpServer::smartIntercomDrop(uint8_t id) {
+  smartIntercomConnections[id].state = SMARTINTERCOM_HTTP_FREE;
+  smartIntercomTransport->smartIntercomClose(id);
+}
+
+// ============================================================================
+// SmartIntercomHttpServer Request Handling
+// ============================================================================
+
+/*
+ * SmartIntercomHttpServer Process
+ * Обработка всех полностью принятых запросов соединения SmartIntercom
+ */
+void SmartIntercomHttpServer::smartIntercomProcess(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+
+  while (connection.state == SMARTINTERCOM_HTTP_READING && connection.requestLength > 0) {
+    SmartIntercomHttpRequest request;
+    size_t consumed = 0;
+    int error = 0;
+
+    if (!smartIntercomParse(id, &request, &consumed, &error)) {
+      if (error == 0 && connection.requestLength < SMARTINTERCOM_HTTP_REQUEST_MAX) {
+        return;
+      }
+      // SmartIntercom Malformed or oversized request: answer and close
+      connection.keepAlive = false;
+      connection.headOnly = false;
+      connection.requestLength = 0;
+      smartIntercomResetHead(id);
+      smartIntercomQueueError(id, error ? error : 413);
+      smartIntercomFlush(id);
+      return;
+    }
+
+    // SmartIntercom Terminate the body for the handler, then restore the first pipelined byte
+    char saved = connection.request[consumed];
+    connection.request[consumed] = '\0';
+    smartIntercomDispatch(id, request);
+    connection.request[consumed] = saved;
+
+    // SmartIntercom Keep pipelined bytes that follow this request
+    memmove(connection.request, connection.request + consumed, connection.requestLength - consumed);
+    connection.requestLength -= consumed;
+    smartIntercomResetHead(id);
+
+    smartIntercomFlush(id);
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Reset Head
+ * Следующий запрос соединения SmartIntercom начинается с начала буфера
+ */
+void SmartIntercomHttpServer::smartIntercomResetHead(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  connection.headScanned = 0;
+  connection.headDone = false;
+  connection.headSkipping = false;
+}
+
+/*
+ * SmartIntercomHttpServer Trim Head
+ * Выбросить из буфера SmartIntercom заголовки, которые сервер не читает
+ *
+ * Браузер присылает сотни байт User-Agent, Accept-*, Cookie и Referer.
+ * По мере приема в буфере остаются только строка запроса,
+ * Content-Length, Connection и If-None-Match, поэтому
+ * SMARTINTERCOM_HTTP_REQUEST_MAX ограничивает их и тело, а не весь
+ * заголовок. Ненужная строка, которая не помещается в буфер
+ * целиком, выбрасывается частями до конца строки.
+ */
+void SmartIntercomHttpServer::smartIntercomTrimHead(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  char* buffer = connection.request;
+
+  while (!connection.headDone) {
+    char* line = buffer + connection.headScanned;
+    size_t available = connection.requestLength - connection.headScanned;
+    char* newline = (char*)memchr(line, '\n', available);
+    size_t drop = 0;
+
+    if (connection.headSkipping) {
+      drop = newline != nullptr ? newline - line + 1 : available;
+      connection.headSkipping = newline == nullptr;
+    } else if (newline == nullptr) {
+      // SmartIntercom A partial line that fills the buffer can only be an unused header
+      if (connection.requestLength < SMARTINTERCOM_HTTP_REQUEST_MAX || connection.headScanned == 0 ||
+          smartIntercomHttpKeepHeader(line, available)) {
+        return;
+      }
+      connection.headSkipping = true;
+      continue;
+    } else {
+      size_t lineLength = newline - line + 1;
+      if (connection.headScanned > 0 && lineLength == 2 && line[0] == '\r') {
+        connection.headDone = true;
+        return;
+      }
+      if (connection.headScanned == 0 || smartIntercomHttpKeepHeader(line, lineLength)) {
+        connection.headScanned += lineLength;
+        continue;
+      }
+      drop = lineLength;
+    }
+
+    memmove(line, line + drop, available - drop);
+    connection.requestLength -= drop;
+    if (connection.headSkipping) {
+      return;
+    }
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Parse
+ * Разбор запроса SmartIntercom на месте (строки завершаются нулями)
+ *
+ * false и error = 0 - запрос еще не принят целиком; error != 0 -
+ * код ответа об ошибке. consumed - длина запроса вместе с телом.
+ */
+bool SmartIntercomHttpServer::smartIntercomParse(uint8_t id, SmartIntercomHttpRequest* request, size_t* consumed,
+                                                 int* error) {
+  smartIntercomTrimHead(id);
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  char* buffer = connection.request;
+  buffer[connection.requestLength] = '\0';
+  *error = 0;
+
+  char* headEnd = strstr(buffer, "\r\n\r\n");
+  if (headEnd == nullptr) {
+    return false;
+  }
+  size_t headLength = headEnd - buffer + 4;
+
+  // SmartIntercom First pass: request line, headers we care about, body length
+  char* lineEnd = strstr(buffer, "\r\n");
+  bool http11 = lineEnd - buffer >= 8 && memcmp(lineEnd - 8, "HTTP/1.1", 8) == 0;
+  bool keepAlive = http11;
+  size_t contentLength = 0;
+  char* ifNoneMatch = nullptr;
+
+  char* line = lineEnd + 2;
+  while (line < headEnd + 2) {
+    char* next = strstr(line, "\r\n");
+    char* colon = (char*)memchr(line, ':', next - line);
+    if (colon != nullptr) {
+      char* value = colon + 1;
+      while (value < next && (*value == ' ' || *value == '\t')) {
+        value++;
+      }
+      size_t nameLength = colon - line;
+      size_t valueLength = next - value;
+      if (smartIntercomHttpHeaderIs(line, nameLength, "Content-Length")) {
+        contentLength = strtoul(value, nullptr, 10);
+      } else if (smartIntercomHttpHeaderIs(line, nameLength, "Connection")) {
+        if (smartIntercomHttpHasToken(value, valueLength, "close")) {
+          keepAlive = false;
+        } else if (smartIntercomHttpHasToken(value, valueLength, "keep-alive")) {
+          keepAlive = true;
+        }
+      } else if (smartIntercomHttpHeaderIs(line, nameLength, "If-None-Match")) {
+        ifNoneMatch = value;
+      }
+    }
+    line = next + 2;
+  }
+
+  if (contentLength > SMARTINTERCOM_HTTP_REQUEST_MAX - headLength) {
+    *error = 413;
+    return false;
+  }
+  if (connection.requestLength < headLength + contentLength) {
+    return false;
+  }
+
+  // SmartIntercom Second pass: terminate strings in place
+  *lineEnd = '\0';
+  for (char* cursor = lineEnd + 2; cursor < headEnd; cursor++) {
+    if (cursor[0] == '\r' && cursor[1] == '\n') {
+      cursor[0] = '\0';
+    }
+  }
+  *headEnd = '\0';
+
+  char* method = buffer;
+  char* target = strchr(method, ' ');
+  if (target == nullptr) {
+    *error = 400;
+    return false;
+  }
+  *target++ = '\0';
+  char* version = strchr(target, ' ');
+  if (version != nullptr) {
+    *version = '\0';
+  }
+  if (target[0] != '/') {
+    *error = 400;
+    return false;
+  }
+
+  char* query = strchr(target, '?');
+  if (query != nullptr) {
+    *query++ = '\0';
+  }
+
+  if (strcmp(method, "GET") == 0) {
+    request->method = SMARTINTERCOM_HTTP_GET;
+  } else if (strcmp(method, "HEAD") == 0) {
+    request->method = SMARTINTERCOM_HTTP_HEAD;
+  } else if (strcmp(method, "POST") == 0) {
+    request->method = SMARTINTERCOM_HTTP_POST;
+  } else {
+    request->method = SMARTINTERCOM_HTTP_OTHER;
+  }
+  request->path = target;
+  request->query = query ? query : "";
+  request->ifNoneMatch = ifNoneMatch;
+  request->connection = id;
+
+  request->body = buffer + headLength;
+  request->bodyLength = contentLength;
+
+  connection.http11 = http11;
+  connection.keepAlive = keepAlive && connection.requests + 1 < SMARTINTERCOM_HTTP_KEEPALIVE_MAX;
+  connection.headOnly = request->method == SMARTINTERCOM_HTTP_HEAD;
+  *consumed = headLength + contentLength;
+  return true;
+}
+
+/*
+ * SmartIntercomHttpServer Dispatch
+ * Поиск маршрута SmartIntercom и вызов обработчика
+ */
+void SmartIntercomHttpServer::smartIntercomDispatch(uint8_t id, const SmartIntercomHttpRequest& request) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  connection.requests++;
+  connection.requestStartUs = smartIntercomMicros();
+  connection.requestTimed = true;
+  smartIntercomRequestsServed++;
+
+  SmartIntercomHttpMethod method = request.method == SMARTINTERCOM_HTTP_HEAD ? SMARTINTERCOM_HTTP_GET : request.method;
+  bool pathFound = false;
+  for (uint8_t i = 0; i < smartIntercomRouteCount; i++) {
+    SmartIntercomHttpRoute& route = smartIntercomRoutes[i];
+    if (!smartIntercomMatchPath(route.path, request.path)) {
+      continue;
+    }
+    pathFound = true;
+    if (route.method != method) {
+      continue;
+    }
+    smartIntercomResponse.smartIntercomReset();
+    route.handler(request, smartIntercomResponse, route.context);
+    smartIntercomQueueResponse(id, smartIntercomResponse);
+    return;
+  }
+  smartIntercomQueueError(id, pathFound ? 405 : 404);
+}
+
+/*
+ * SmartIntercomHttpServer Match Path
+ */
+bool SmartIntercomHttpServer::smartIntercomMatchPath(const char* route, const char* path) {
+  size_t length = strlen(route);
+  if (length > 0 && route[length - 1] == '*') {
+    return strncmp(route, path, length - 1) == 0;
+  }
+  return strcmp(route, path) == 0;
+}
+
+/*
+ * SmartIntercomHttpServer Reason
+ */
+const char* SmartIntercomHttpServer::smartIntercomReason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Queue Error
+ * Ответ SmartIntercom об ошибке в JSON, как у обработчиков API
+ */
+void SmartIntercomHttpServer::smartIntercomQueueError(uint8_t id, int status) {
+  smartIntercomResponse.smartIntercomReset();
+  smartIntercomResponse.smartIntercomSetStatus(status);
+  smartIntercomResponse.smartIntercomSetContentType("application/json");
+  smartIntercomResponse.smartIntercomPrintf(PSTR("{\"success\":false,\"message\":\"SmartIntercom: %d %s\"}"),
+                                            status, smartIntercomReason(status));
+  smartIntercomQueueResponse(id, smartIntercomResponse);
+}
+
+/*
+ * SmartIntercomHttpServer Queue Response
+ * Сериализация заголовков и тела ответа SmartIntercom в буфер соединения
+ */
+void SmartIntercomHttpServer::smartIntercomQueueResponse(uint8_t id, SmartIntercomHttpResponse& response) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+
+  if (response.smartIntercomOverflow) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: HTTP response too large, sending 500");
+    response.smartIntercomReset();
+    response.smartIntercomStatus = 500;
+  }
+
+  bool stream = response.smartIntercomStream;
+  bool bodyAllowed = response.smartIntercomStatus != 304 && response.smartIntercomStatus != 204;
+  bool generated = response.smartIntercomGenerator != nullptr && bodyAllowed;
+  if (generated && !connection.http11) {
+    // SmartIntercom HTTP/1.0 has no chunked encoding: the body ends when the connection closes
+    connection.keepAlive = false;
+  }
+  size_t bodyLength = response.smartIntercomStaticBody ? response.smartIntercomStaticLength
+                                                       : response.smartIntercomBodyLength;
+  if (!bodyAllowed) {
+    bodyLength = 0;
+  }
+
+  char* out = (char*)connection.response;
+  size_t size = sizeof(connection.response);
+  int length = snprintf(out, size, "HTTP/1.1 %d %s\r\n", response.smartIntercomStatus,
+                        smartIntercomReason(response.smartIntercomStatus));
+  if (response.smartIntercomContentType && bodyAllowed) {
+    length += snprintf(out + length, size - length, "Content-Type: %s\r\n", response.smartIntercomContentType);
+  }
+  if (generated && connection.http11) {
+    length += snprintf(out + length, size - length, "Transfer-Encoding: chunked\r\n");
+  } else if (!stream && !generated && bodyAllowed) {
+    length += snprintf(out + length, size - length, "Content-Length: %u\r\n", (unsigned int)bodyLength);
+  }
+  length += snprintf(out + length, size - length, "Connection: %s\r\n",
+                     stream || connection.keepAlive ? "keep-alive" : "close");
+  if ((size_t)length + response.smartIntercomHeadersLength + 2 > size) {
+    // SmartIntercom Cannot happen with the configured sizes, but never overrun the buffer
+    connection.keepAlive = false;
+    length = snprintf(out, size, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n"
+                      "Connection: close\r\n");
+    bodyLength = 0;
+    generated = false;
+    response.smartIntercomHeadersLength = 0;
+    response.smartIntercomStaticBody = nullptr;
+  }
+  memcpy(out + length, response.smartIntercomHeaders, response.smartIntercomHeadersLength);
+  length += response.smartIntercomHeadersLength;
+  memcpy(out + length, "\r\n", 2);
+  length += 2;
+
+  connection.staticBody = nullptr;
+  connection.staticRemaining = 0;
+  connection.generator = nullptr;
+  if (generated && !connection.headOnly) {
+    connection.generator = response.smartIntercomGenerator;
+    connection.generatorContext = response.smartIntercomGeneratorContext;
+    connection.generatorCursor = response.smartIntercomGeneratorCursor;
+    connection.chunked = connection.http11;
+  }
+  if (bodyLength > 0 && !connection.headOnly) {
+    if (response.smartIntercomStaticBody) {
+      connection.staticBody = response.smartIntercomStaticBody;
+      connection.staticRemaining = bodyLength;
+      connection.staticFlash = response.smartIntercomStaticFlash;
+    } else {
+      // SmartIntercom Dynamic bodies are bounded by SMARTINTERCOM_HTTP_BODY_MAX and always fit
+      memcpy(out + length, response.smartIntercomBody, bodyLength);
+      length += bodyLength;
+    }
+  }
+
+  connection.responseLength = length;
+  connection.responseOffset = 0;
+  connection.state = stream ? SMARTINTERCOM_HTTP_STREAMING : SMARTINTERCOM_HTTP_WRITING;
+
+  // SmartIntercom The body is in the connection buffer now: the request arena is free for the next one
+  smartIntercomArena.smartIntercomReset();
+}
+
+/*
+ * SmartIntercomHttpServer Flush
+ * Отдать транспорту столько ответа SmartIntercom, сколько он примет сейчас
+ */
+void SmartIntercomHttpServer::smartIntercomFlush(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+
+  while (connection.state == SMARTINTERCOM_HTTP_WRITING || connection.state == SMARTINTERCOM_HTTP_STREAMING) {
+    if (connection.responseOffset < connection.responseLength) {
+      size_t wanted = connection.responseLength - connection.responseOffset;
+      size_t sent = smartIntercomTransport->smartIntercomSend(id, connection.response + connection.responseOffset,
+                                                              wanted);
+      if (connection.state == SMARTINTERCOM_HTTP_FREE) {
+        return;
+      }
+      if (sent > 0) {
+        connection.responseOffset += sent;
+        connection.lastActivity = smartIntercomMillis();
+      }
+      if (sent < wanted) {
+        return;
+      }
+      continue;
+    }
+
+    if (connection.staticRemaining > 0) {
+      // SmartIntercom Refill the connection buffer with the next chunk of the static body
+      size_t chunk = connection.staticRemaining;
+      if (chunk > sizeof(connection.response)) {
+        chunk = sizeof(connection.response);
+      }
+      if (connection.staticFlash) {
+        memcpy_P(connection.response, connection.staticBody, chunk);
+      } else {
+        memcpy(connection.response, connection.staticBody, chunk);
+      }
+      connection.staticBody += chunk;
+      connection.staticRemaining -= chunk;
+      connection.responseLength = chunk;
+      connection.responseOffset = 0;
+      continue;
+    }
+
+    if (connection.generator != nullptr) {
+      smartIntercomRefillGenerated(id);
+      continue;
+    }
+
+    connection.responseLength = 0;
+    connection.responseOffset = 0;
+    if (connection.state == SMARTINTERCOM_HTTP_WRITING) {
+      smartIntercomFinishResponse(id);
+    }
+    return;
+  }
+}
+
+/*
+ * SmartIntercomHttpServer Refill Generated
+ * Следующая часть тела SmartIntercom от генератора в буфер соединения
+ *
+ * В режиме chunked часть обрамляется длиной в hex и CRLF, пустая
+ * часть от генератора превращается в завершающий "0\r\n\r\n".
+ */
+void SmartIntercomHttpServer::smartIntercomRefillGenerated(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  char* out = (char*)connection.response;
+  size_t prefix = connection.chunked ? 6 : 0;
+  size_t reserve = connection.chunked ? prefix + 2 : 0;
+
+  size_t produced = connection.generator(out + prefix, sizeof(connection.response) - reserve,
+                                         &connection.generatorCursor, connection.generatorContext);
+  connection.responseOffset = 0;
+  if (produced == 0) {
+    connection.generator = nullptr;
+    connection.responseLength = 0;
+    if (connection.chunked) {
+      memcpy(out, "0\r\n\r\n", 5);
+      connection.responseLength = 5;
+    }
+    return;
+  }
+  if (!connection.chunked) {
+    connection.responseLength = produced;
+    return;
+  }
+
+  char header[8];
+  int headerLength = snprintf(header, sizeof(header), "%x\r\n", (unsigned int)produced);
+  memmove(out + headerLength, out + prefix, produced);
+  memcpy(out, header, headerLength);
+  memcpy(out + headerLength + produced, "\r\n", 2);
+  connection.responseLength = headerLength + produced + 2;
+}
+
+/*
+ * SmartIntercomHttpServer Finish Response
+ * Ответ SmartIntercom отправлен: ждать следующий запрос или закрыть
+ */
+void SmartIntercomHttpServer::smartIntercomFinishResponse(uint8_t id) {
+  SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+  if (connection.requestTimed && smartIntercomServiceTime) {
+    smartIntercomServiceTime->smartIntercomRecord(smartIntercomMicros() - connection.requestStartUs);
+  }
+  connection.requestTimed = false;
+  if (!connection.keepAlive) {
+    smartIntercomDrop(id);
+    return;
+  }
+  connection.state = SMARTINTERCOM_HTTP_READING;
+  connection.lastActivity = smartIntercomMillis();
+}
+
+// ============================================================================
+// SmartIntercomHttpServer Streaming
+// ============================================================================
+
+/*
+ * SmartIntercomHttpServer Broadcast
+ * Кадр SmartIntercom всем потоковым соединениям
+ *
+ * Кадр копируется в буфер каждого соединения. Подписчик, у которого
+ * не осталось места (не успевает читать), отключается: клиент
+ * переподключится и получит полное состояние заново. Возвращает
+ * число подписчиков, получивших кадр.
+ */
+uint8_t SmartIntercomHttpServer::smartIntercomBroadcast(const char* data, size_t length) {
+  uint8_t delivered = 0;
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    SmartIntercomHttpConnection& connection = smartIntercomConnections[id];
+    if (connection.state != SMARTINTERCOM_HTTP_STREAMING) {
+      continue;
+    }
+
+    size_t pending = connection.responseLength - connection.responseOffset;
+    if (pending + length > sizeof(connection.response)) {
+      smartIntercomStreamsDropped++;
+      SMARTINTERCOM_LOG_WARNING("SmartIntercom: Slow stream subscriber %u dropped", id);
+      smartIntercomDrop(id);
+      continue;
+    }
+    memmove(connection.response, connection.response + connection.responseOffset, pending);
+    memcpy(connection.response + pending, data, length);
+    connection.responseLength = pending + length;
+    connection.responseOffset = 0;
+    smartIntercomFlush(id);
+    if (connection.state == SMARTINTERCOM_HTTP_STREAMING) {
+      delivered++;
+    }
+  }
+  return delivered;
+}
+
+/*
+ * SmartIntercomHttpServer Get Stream Count
+ */
+uint8_t SmartIntercomHttpServer::smartIntercomGetStreamCount() {
+  uint8_t count = 0;
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    if (smartIntercomConnections[id].state == SMARTINTERCOM_HTTP_STREAMING) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/*
+ * SmartIntercomHttpServer Get Active Connections
+ */
+uint8_t SmartIntercomHttpServer::smartIntercomGetActiveConnections() {
+  uint8_t count = 0;
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    if (smartIntercomConnections[id].state != SMARTINTERCOM_HTTP_FREE) {
+      count++;
+    }
+  }
+  return count;
+}
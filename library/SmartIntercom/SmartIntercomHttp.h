@@ -0,0 +1,293 @@
+/*
+ * SmartIntercomHttp.h - Событийный HTTP-сервер SmartIntercom
+ *
+ * Сервер обслуживает несколько соединений одновременно и никогда
+ * не ждет сеть: транспорт сообщает о событиях (новое соединение,
+ * пришли данные, можно писать, соединение закрыто), а сервер
+ * разбирает запросы в фиксированных буферах соединений, вызывает
+ * обработчики маршрутов и отдает ответ столько, сколько транспорт
+ * принимает без блокировки. Остаток дописывается по событию записи.
+ *
+ * Поддерживаются HTTP/1.1 keep-alive и конвейерные запросы, ответы
+ * из флеш-памяти без копирования целиком (страница интерфейса),
+ * тела любой длины, собираемые по частям (chunked), и потоковые
+ * ответы (Server-Sent Events) с рассылкой кадров.
+ *
+ * Код сервера не зависит от платформы: на ESP8266 транспорт -
+ * SmartIntercomHttpTransportWiFi, на Linux - epoll (host/net), что
+ * позволяет нагружать те же обработчики на рабочей станции.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HTTP_H
+#define SMARTINTERCOM_HTTP_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomArena.h"
+
+// SmartIntercom HTTP Configuration (память: соединения x (запрос + ответ))
+#ifndef SMARTINTERCOM_HTTP_MAX_CONNECTIONS
+#define SMARTINTERCOM_HTTP_MAX_CONNECTIONS 6
+#endif
+
+#ifndef SMARTINTERCOM_HTTP_REQUEST_MAX
+#define SMARTINTERCOM_HTTP_REQUEST_MAX 512            // Строка запроса, нужные заголовки и тело (прочие заголовки выбрасываются)
+#endif
+
+#ifndef SMARTINTERCOM_HTTP_RESPONSE_MAX
+#define SMARTINTERCOM_HTTP_RESPONSE_MAX 640
+#endif
+
+#ifndef SMARTINTERCOM_HTTP_MAX_ROUTES
+#define SMARTINTERCOM_HTTP_MAX_ROUTES 20
+#endif
+
+#ifndef SMARTINTERCOM_HTTP_ARENA_MAX
+#define SMARTINTERCOM_HTTP_ARENA_MAX 512               // Арена запроса (обработчики вызываются по одному)
+#endif
+
+#define SMARTINTERCOM_HTTP_HEADERS_MAX 160
+#define SMARTINTERCOM_HTTP_BODY_MAX (SMARTINTERCOM_HTTP_RESPONSE_MAX - SMARTINTERCOM_HTTP_HEADERS_MAX - 160)
+#define SMARTINTERCOM_HTTP_IDLE_TIMEOUT_MS 5000
+#define SMARTINTERCOM_HTTP_KEEPALIVE_MAX 100
+#define SMARTINTERCOM_HTTP_NO_CONNECTION 0xFF
+
+// SmartIntercom HTTP Methods
+enum SmartIntercomHttpMethod {
+  SMARTINTERCOM_HTTP_GET,
+  SMARTINTERCOM_HTTP_HEAD,
+  SMARTINTERCOM_HTTP_POST,
+  SMARTINTERCOM_HTTP_OTHER
+};
+
+/*
+ * SmartIntercomHttpRequest - Разобранный запрос SmartIntercom
+ *
+ * Строки указывают в буфер соединения и действительны только
+ * во время вызова обработчика.
+ */
+struct SmartIntercomHttpRequest {
+  SmartIntercomHttpMethod method;
+  const char* path;
+  const char* query;
+  const char* body;
+  size_t bodyLength;
+  const char* ifNoneMatch;
+  uint8_t connection;
+};
+
+/*
+ * SmartIntercomHttpGenerator - Тело ответа SmartIntercom, собираемое по частям
+ *
+ * Заполняет out (не более size байт) следующей частью тела и
+ * возвращает ее длину, 0 - тело закончено. cursor хранит позицию
+ * между вызовами; генератор вызывается по мере освобождения буфера
+ * соединения, поэтому размер тела не ограничен буферами сервера.
+ */
+typedef size_t (*SmartIntercomHttpGenerator)(char* out, size_t size, uint32_t* cursor, void* context);
+
+/*
+ * SmartIntercomHttpResponse - Ответ SmartIntercom, заполняемый обработчиком
+ *
+ * Тело собирается в общем буфере сервера (обработчики вызываются
+ * по одному) или указывает на неизменяемые данные, в том числе
+ * во флеш-памяти, которые отдаются частями по мере отправки.
+ *
+ * smartIntercomAllocate() выдает временную память из арены запроса:
+ * она действительна до постановки ответа в очередь, поэтому годится
+ * для сборки тела перед smartIntercomWrite(), но не для
+ * smartIntercomSendStatic() и не для контекста генератора.
+ */
+class SmartIntercomHttpResponse {
+  friend class SmartIntercomHttpServer;
+
+private:
+  int smartIntercomStatus;
+  const char* smartIntercomContentType;
+  char smartIntercomHeaders[SMARTINTERCOM_HTTP_HEADERS_MAX];
+  size_t smartIntercomHeadersLength;
+  char smartIntercomBody[SMARTINTERCOM_HTTP_BODY_MAX];
+  size_t smartIntercomBodyLength;
+  bool smartIntercomOverflow;
+  const uint8_t* smartIntercomStaticBody;
+  size_t smartIntercomStaticLength;
+  bool smartIntercomStaticFlash;
+  SmartIntercomHttpGenerator smartIntercomGenerator;
+  void* smartIntercomGeneratorContext;
+  uint32_t smartIntercomGeneratorCursor;
+  bool smartIntercomStream;
+  SmartIntercomArena* smartIntercomArena;
+
+  void smartIntercomReset();
+
+public:
+  // SmartIntercom Response Setup
+  void smartIntercomSetStatus(int status) { smartIntercomStatus = status; }
+  void smartIntercomSetContentType(const char* contentType) { smartIntercomContentType = contentType; }
+  void smartIntercomAddHeader(const char* name, const char* value);
+
+  // SmartIntercom Response Body
+  void smartIntercomWrite(const char* data, size_t length);
+  void smartIntercomPrint(const char* text);
+  size_t smartIntercomPrintf(const char* format, ...);
+  void smartIntercomSend(int status, const char* contentType, const char* body);
+  void smartIntercomSendStatic(int status, const char* contentType, const uint8_t* data, size_t length,
+                               bool flash);
+  void smartIntercomSendGenerated(int status, const char* contentType, SmartIntercomHttpGenerator generator,
+                                  void* context, uint32_t cursor = 0);
+
+  // SmartIntercom Streaming Response (text/event-stream)
+  void smartIntercomBeginStream(const char* contentType);
+
+  // SmartIntercom Request Arena (nullptr - арена заполнена)
+  void* smartIntercomAllocate(size_t size) { return smartIntercomArena->smartIntercomAllocate(size); }
+};
+
+/*
+ * SmartIntercomHttpHandler - Обработчик маршрута SmartIntercom
+ *
+ * Вызывается из smartIntercomRun() (главный цикл), никогда из
+ * прерываний или сетевого стека; не должен блокировать.
+ */
+typedef void (*SmartIntercomHttpHandler)(const SmartIntercomHttpRequest& request,
+                                         SmartIntercomHttpResponse& response, void* context);
+
+class SmartIntercomHttpServer;
+class SmartIntercomHistogram;
+
+/*
+ * SmartIntercomHttpTransport - Сетевой транспорт сервера SmartIntercom
+ *
+ * Транспорт владеет сокетами, номер сокета совпадает с номером
+ * соединения сервера. smartIntercomPoll() доставляет накопившиеся
+ * события серверу, smartIntercomSend() принимает столько байт,
+ * сколько помещается без ожидания.
+ */
+class SmartIntercomHttpTransport {
+public:
+  virtual ~SmartIntercomHttpTransport() {}
+
+  virtual bool smartIntercomListen(uint16_t port) = 0;
+  virtual void smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) = 0;
+  virtual size_t smartIntercomSend(uint8_t connection, const uint8_t* data, size_t length) = 0;
+  virtual void smartIntercomClose(uint8_t connection) = 0;
+};
+
+/*
+ * SmartIntercomHttpServer - HTTP-сервер SmartIntercom
+ */
+class SmartIntercomHttpServer {
+private:
+  // SmartIntercom Connection States
+  enum {
+    SMARTINTERCOM_HTTP_FREE,
+    SMARTINTERCOM_HTTP_READING,
+    SMARTINTERCOM_HTTP_WRITING,
+    SMARTINTERCOM_HTTP_STREAMING
+  };
+
+  struct SmartIntercomHttpConnection {
+    uint8_t state;
+    bool keepAlive;
+    bool headOnly;
+    bool http11;
+    uint16_t requests;
+    unsigned long lastActivity;
+    unsigned long requestStartUs;
+    bool requestTimed;
+    char request[SMARTINTERCOM_HTTP_REQUEST_MAX + 1];
+    size_t requestLength;
+    size_t headScanned;       // SmartIntercom начало следующей непросмотренной строки заголовка
+    bool headDone;            // SmartIntercom пустая строка принята, дальше тело
+    bool headSkipping;        // SmartIntercom выбрасывается остаток длинной ненужной строки
+    uint8_t response[SMARTINTERCOM_HTTP_RESPONSE_MAX];
+    size_t responseLength;
+    size_t responseOffset;
+    const uint8_t* staticBody;
+    size_t staticRemaining;
+    bool staticFlash;
+    SmartIntercomHttpGenerator generator;
+    void* generatorContext;
+    uint32_t generatorCursor;
+    bool chunked;
+  };
+
+  struct SmartIntercomHttpRoute {
+    SmartIntercomHttpMethod method;
+    const char* path;
+    SmartIntercomHttpHandler handler;
+    void* context;
+  };
+
+  SmartIntercomHttpTransport* smartIntercomTransport;
+  SmartIntercomHttpConnection smartIntercomConnections[SMARTINTERCOM_HTTP_MAX_CONNECTIONS];
+  SmartIntercomHttpRoute smartIntercomRoutes[SMARTINTERCOM_HTTP_MAX_ROUTES];
+  uint8_t smartIntercomRouteCount;
+  SmartIntercomHttpResponse smartIntercomResponse;
+  uint32_t smartIntercomArenaBuffer[(SMARTINTERCOM_HTTP_ARENA_MAX + 3) / 4];
+  SmartIntercomArena smartIntercomArena;
+
+  // SmartIntercom Server Statistics
+  uint32_t smartIntercomRequestsServed;
+  uint32_t smartIntercomConnectionsAccepted;
+  uint32_t smartIntercomConnectionsRejected;
+  uint32_t smartIntercomStreamsDropped;
+  SmartIntercomHistogram* smartIntercomServiceTime;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomProcess(uint8_t id);
+  void smartIntercomResetHead(uint8_t id);
+  void smartIntercomTrimHead(uint8_t id);
+  bool smartIntercomParse(uint8_t id, SmartIntercomHttpRequest* request, size_t* consumed, int* error);
+  void smartIntercomDispatch(uint8_t id, const SmartIntercomHttpRequest& request);
+  void smartIntercomQueueResponse(uint8_t id, SmartIntercomHttpResponse& response);
+  void smartIntercomQueueError(uint8_t id, int status);
+  void smartIntercomFlush(uint8_t id);
+  void smartIntercomRefillGenerated(uint8_t id);
+  void smartIntercomFinishResponse(uint8_t id);
+  void smartIntercomDrop(uint8_t id);
+  static const char* smartIntercomReason(int status);
+  static bool smartIntercomMatchPath(const char* route, const char* path);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomHttpServer();
+
+  // SmartIntercom Initialization (путь маршрута с '*' в конце - префикс, например "/api/ops/*")
+  bool smartIntercomBegin(SmartIntercomHttpTransport* transport, uint16_t port);
+  bool smartIntercomOn(SmartIntercomHttpMethod method, const char* path, SmartIntercomHttpHandler handler,
+                       void* context = nullptr);
+
+  // SmartIntercom Main Loop (события транспорта, таймауты)
+  void smartIntercomRun(unsigned long timeoutMs = 0);
+
+  // SmartIntercom Transport Events
+  uint8_t smartIntercomOnAccept();
+  size_t smartIntercomGetReceiveSpace(uint8_t connection, char** buffer);
+  void smartIntercomOnReceived(uint8_t connection, size_t length);
+  void smartIntercomOnWritable(uint8_t connection);
+  void smartIntercomOnClosed(uint8_t connection);
+  bool smartIntercomWantsWrite(uint8_t connection);
+
+  // SmartIntercom Streaming
+  uint8_t smartIntercomBroadcast(const char* data, size_t length);
+  uint8_t smartIntercomGetStreamCount();
+
+  // SmartIntercom Server Statistics
+  uint8_t smartIntercomGetActiveConnections();
+  uint32_t smartIntercomGetRequestsServed() { return smartIntercomRequestsServed; }
+  uint32_t smartIntercomGetConnectionsAccepted() { return smartIntercomConnectionsAccepted; }
+  uint32_t smartIntercomGetConnectionsRejected() { return smartIntercomConnectionsRejected; }
+  uint32_t smartIntercomGetStreamsDropped() { return smartIntercomStreamsDropped; }
+
+  // SmartIntercom Request Arena (сбрасывается после каждого ответа)
+  SmartIntercomArena& smartIntercomGetArena() { return smartIntercomArena; }
+
+  // SmartIntercom Service Time (от разбора запроса до последнего байта ответа)
+  void smartIntercomSetServiceHistogram(SmartIntercomHistogram* histogram) { smartIntercomServiceTime = histogram; }
+};
+
+#endif // SMARTINTERCOM_HTTP_H
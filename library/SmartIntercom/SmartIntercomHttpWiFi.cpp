@@ -0,0 +1,148 @@
+/*
+ * SmartIntercomHttpWiFi.cpp - Реализация транспорта SmartIntercom для ESP8266
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomHttpWiFi.h"
+
+#ifdef ESP8266
+
+/*
+ * SmartIntercomHttpTransportWiFi Constructor
+ */
+SmartIntercomHttpTransportWiFi::SmartIntercomHttpTransportWiFi() : smartIntercomListener(80) {
+  smartIntercomServer = nullptr;
+  for (uint8_t i = 0; i < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; i++) {
+    smartIntercomActive[i] = false;
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportWiFi Listen
+ */
+bool SmartIntercomHttpTransportWiFi::smartIntercomListen(uint16_t port) {
+  smartIntercomListener.begin(port);
+  smartIntercomListener.setNoDelay(true);
+  return true;
+}
+
+/*
+ * SmartIntercomHttpTransportWiFi Poll
+ * Доставить серверу SmartIntercom накопившиеся события сокетов
+ *
+ * Пока все соединения заняты, новые клиенты ждут в очереди
+ * WiFiServer и принимаются, как только место освободится.
+ */
+void SmartIntercomHttpTransportWiFi::smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) {
+  smartIntercomServer = &server;
+
+  // SmartIntercom Sleep until a socket needs service (lwIP keeps receiving meanwhile)
+  if (timeoutMs > 0 && !smartIntercomHasSocketWork(this)) {
+    smartIntercomIdleWait(timeoutMs, smartIntercomHasSocketWork, this);
+  }
+
+  // SmartIntercom Accept pending clients while there is a free connection
+  while (server.smartIntercomGetActiveConnections() < SMARTINTERCOM_HTTP_MAX_CONNECTIONS &&
+         smartIntercomListener.hasClient()) {
+    uint8_t id = server.smartIntercomOnAccept();
+    if (id == SMARTINTERCOM_HTTP_NO_CONNECTION) {
+      break;
+    }
+    smartIntercomClients[id] = smartIntercomListener.accept();
+    smartIntercomClients[id].setNoDelay(true);
+    smartIntercomActive[id] = true;
+  }
+
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    if (!smartIntercomActive[id]) {
+      continue;
+    }
+    WiFiClient& client = smartIntercomClients[id];
+
+    // SmartIntercom Read only what has already arrived
+    int available = client.available();
+    while (available > 0 && smartIntercomActive[id]) {
+      char* buffer = nullptr;
+      size_t space = server.smartIntercomGetReceiveSpace(id, &buffer);
+      if (space == 0) {
+        break;
+      }
+      int received = client.read((uint8_t*)buffer, (size_t)available < space ? (size_t)available : space);
+      if (received <= 0) {
+        break;
+      }
+      server.smartIntercomOnReceived(id, received);
+      available = smartIntercomActive[id] ? client.available() : 0;
+    }
+    if (!smartIntercomActive[id]) {
+      continue;
+    }
+
+    if (server.smartIntercomWantsWrite(id) && client.availableForWrite() > 0) {
+      server.smartIntercomOnWritable(id);
+    }
+    if (!smartIntercomActive[id]) {
+      continue;
+    }
+
+    if (!client.connected() && client.available() == 0) {
+      smartIntercomActive[id] = false;
+      client.stop();
+      server.smartIntercomOnClosed(id);
+    }
+  }
+}
+
+/*
+ * SmartIntercomHttpTransportWiFi Has Socket Work
+ * Есть ли для сервера SmartIntercom новый клиент, данные, место для записи или закрытие
+ */
+bool SmartIntercomHttpTransportWiFi::smartIntercomHasSocketWork(void* context) {
+  SmartIntercomHttpTransportWiFi* transport = static_cast<SmartIntercomHttpTransportWiFi*>(context);
+  SmartIntercomHttpServer& server = *transport->smartIntercomServer;
+  if (server.smartIntercomGetActiveConnections() < SMARTINTERCOM_HTTP_MAX_CONNECTIONS &&
+      transport->smartIntercomListener.hasClient()) {
+    return true;
+  }
+  for (uint8_t id = 0; id < SMARTINTERCOM_HTTP_MAX_CONNECTIONS; id++) {
+    if (!transport->smartIntercomActive[id]) {
+      continue;
+    }
+    WiFiClient& client = transport->smartIntercomClients[id];
+    if (client.available() > 0 || !client.connected() ||
+        (server.smartIntercomWantsWrite(id) && client.availableForWrite() > 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomHttpTransportWiFi Send
+ * Записать не больше свободного места в окне TCP, без ожидания
+ */
+size_t SmartIntercomHttpTransportWiFi::smartIntercomSend(uint8_t id, const uint8_t* data, size_t length) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || !smartIntercomActive[id]) {
+    return 0;
+  }
+  size_t room = smartIntercomClients[id].availableForWrite();
+  if (room == 0) {
+    return 0;
+  }
+  return smartIntercomClients[id].write(data, length < room ? length : room);
+}
+
+/*
+ * SmartIntercomHttpTransportWiFi Close
+ */
+void SmartIntercomHttpTransportWiFi::smartIntercomClose(uint8_t id) {
+  if (id >= SMARTINTERCOM_HTTP_MAX_CONNECTIONS || !smartIntercomActive[id]) {
+    return;
+  }
+  smartIntercomActive[id] = false;
+  smartIntercomClients[id].stop();
+}
+
+#endif // ESP8266
@@ -0,0 +1,52 @@
+/*
+ * SmartIntercomHttpWiFi.h - Транспорт HTTP-сервера SmartIntercom для ESP8266
+ *
+ * Сокеты - WiFiServer/WiFiClient ядра ESP8266. Колбэки lwIP на ESP8266
+ * выполняются в системном контексте, где нельзя трогать планировщик
+ * и GPIO библиотеки, поэтому транспорт превращает готовность сокетов
+ * в события сервера из главного цикла: принимает новые соединения,
+ * читает только уже пришедшие байты и пишет не больше, чем
+ * availableForWrite(). Ни один вызов не ждет сеть, кроме явного
+ * простоя smartIntercomPoll(timeoutMs > 0), который спит до прихода
+ * данных или нового клиента, smartIntercomWake() или истечения срока.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_HTTP_WIFI_H
+#define SMARTINTERCOM_HTTP_WIFI_H
+
+#ifdef ESP8266
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "SmartIntercomHttp.h"
+
+/*
+ * SmartIntercomHttpTransportWiFi - Неблокирующий транспорт SmartIntercom на WiFiServer
+ */
+class SmartIntercomHttpTransportWiFi : public SmartIntercomHttpTransport {
+private:
+  WiFiServer smartIntercomListener;
+  WiFiClient smartIntercomClients[SMARTINTERCOM_HTTP_MAX_CONNECTIONS];
+  bool smartIntercomActive[SMARTINTERCOM_HTTP_MAX_CONNECTIONS];
+  SmartIntercomHttpServer* smartIntercomServer;
+
+  // SmartIntercom Internal Methods
+  static bool smartIntercomHasSocketWork(void* context);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomHttpTransportWiFi();
+
+  // SmartIntercom Transport Implementation
+  bool smartIntercomListen(uint16_t port) override;
+  void smartIntercomPoll(SmartIntercomHttpServer& server, unsigned long timeoutMs) override;
+  size_t smartIntercomSend(uint8_t connection, const uint8_t* data, size_t length) override;
+  void smartIntercomClose(uint8_t connection) override;
+};
+
+#endif // ESP8266
+
+#endif // SMARTINTERCOM_HTTP_WIFI_H
@@ -0,0 +1,402 @@
+/*
+ * SmartIntercomLines.cpp - Реализация многоканального режима SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomLines.h"
+
+/*
+ * SmartIntercomLines Constructor
+ * Все линии выключены до smartIntercomBeginLine()
+ */
+SmartIntercomLines::SmartIntercomLines() {
+  memset(smartIntercomRingPins, 0, sizeof(smartIntercomRingPins));
+  memset(smartIntercomDoorPins, 0, sizeof(smartIntercomDoorPins));
+  memset(smartIntercomBaselines, 0, sizeof(smartIntercomBaselines));
+  memset(smartIntercomEnvelopes, 0, sizeof(smartIntercomEnvelopes));
+  memset(smartIntercomPendingSince, 0, sizeof(smartIntercomPendingSince));
+  memset(smartIntercomDoorDeadlines, 0, sizeof(smartIntercomDoorDeadlines));
+  memset(smartIntercomRingCounts, 0, sizeof(smartIntercomRingCounts));
+  memset(smartIntercomOpenCounts, 0, sizeof(smartIntercomOpenCounts));
+  for (uint8_t line = 0; line < SMARTINTERCOM_LINES; line++) {
+    smartIntercomOnLevels[line] = (int32_t)SMARTINTERCOM_RING_ENVELOPE_ON << SMARTINTERCOM_RING_ENVELOPE_Q;
+    smartIntercomOffLevels[line] = smartIntercomOnLevels[line] * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100;
+    smartIntercomOpenTimes[line] = SMARTINTERCOM_DEFAULT_OPEN_TIME;
+  }
+  smartIntercomEnabledMask = 0;
+  smartIntercomAutoOpenMask = 0;
+  smartIntercomAlwaysOpenMask = 0;
+  smartIntercomPrimedMask = 0;
+  smartIntercomRingingMask = 0;
+  smartIntercomPendingMask = 0;
+  smartIntercomDoorOpenMask = 0;
+  smartIntercomLastScan = 0;
+  smartIntercomScans = 0;
+}
+
+/*
+ * SmartIntercomLines Begin Line
+ * Настроить пины линии SmartIntercom и включить ее опрос
+ */
+bool SmartIntercomLines::smartIntercomBeginLine(uint8_t line, const SmartIntercomLineConfig& config) {
+  if (line >= SMARTINTERCOM_LINES) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Line %u out of range", line);
+    return false;
+  }
+  SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+  smartIntercomRingPins[line] = (uint8_t)config.ringPin;
+  smartIntercomDoorPins[line] = (uint8_t)config.doorPin;
+  smartIntercomPinMode(config.ringPin, INPUT);
+  smartIntercomPinMode(config.doorPin, OUTPUT);
+  smartIntercomDigitalWrite(config.doorPin, LOW);
+
+  smartIntercomPrimedMask &= ~bit;
+  smartIntercomRingingMask &= ~bit;
+  smartIntercomPendingMask &= ~bit;
+  smartIntercomDoorOpenMask &= ~bit;
+  smartIntercomEnvelopes[line] = 0;
+  smartIntercomEnabledMask |= bit;
+  smartIntercomSetLineConfig(line, config);
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Line %u ready (ring pin %d, door pin %d)", line, config.ringPin,
+                         config.doorPin);
+  return true;
+}
+
+/*
+ * SmartIntercomLines Disable Line
+ * Снять линию SmartIntercom с опроса (реле отпускается)
+ */
+void SmartIntercomLines::smartIntercomDisableLine(uint8_t line) {
+  if (line >= SMARTINTERCOM_LINES || (smartIntercomEnabledMask & SMARTINTERCOM_LINE_BIT(line)) == 0) {
+    return;
+  }
+  smartIntercomCloseDoor(line);
+  smartIntercomEnabledMask &= ~SMARTINTERCOM_LINE_BIT(line);
+}
+
+/*
+ * SmartIntercomLines Set Line Config
+ * Пороги, время открытия и режимы авто-открытия линии SmartIntercom
+ *
+ * Пины задаются только в smartIntercomBeginLine(); здесь они
+ * игнорируются, поэтому конфигурация из API не может их переназначить.
+ */
+bool SmartIntercomLines::smartIntercomSetLineConfig(uint8_t line, const SmartIntercomLineConfig& config) {
+  if (line >= SMARTINTERCOM_LINES) {
+    return false;
+  }
+  SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+  int onLevel = config.onLevel > 0 ? config.onLevel : SMARTINTERCOM_RING_ENVELOPE_ON;
+  smartIntercomOnLevels[line] = (int32_t)onLevel << SMARTINTERCOM_RING_ENVELOPE_Q;
+  smartIntercomOffLevels[line] = smartIntercomOnLevels[line] * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100;
+  int openTime = config.openTime < 100 ? 100 : config.openTime;
+  smartIntercomOpenTimes[line] = (uint16_t)(openTime > 60000 ? 60000 : openTime);
+
+  SmartIntercomLineMask autoOpen = config.autoOpenEnabled ? bit : 0;
+  SmartIntercomLineMask alwaysOpen = config.alwaysOpenEnabled ? bit : 0;
+  bool changed = (smartIntercomAutoOpenMask & bit) != autoOpen || (smartIntercomAlwaysOpenMask & bit) != alwaysOpen;
+  smartIntercomAutoOpenMask = (smartIntercomAutoOpenMask & ~bit) | autoOpen;
+  smartIntercomAlwaysOpenMask = (smartIntercomAlwaysOpenMask & ~bit) | alwaysOpen;
+  if (changed) {
+    smartIntercomPostConfig(line);
+  }
+  return true;
+}
+
+/*
+ * SmartIntercomLines Get Line Config
+ */
+bool SmartIntercomLines::smartIntercomGetLineConfig(uint8_t line, SmartIntercomLineConfig* config) {
+  if (line >= SMARTINTERCOM_LINES) {
+    return false;
+  }
+  SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+  config->ringPin = smartIntercomRingPins[line];
+  config->doorPin = smartIntercomDoorPins[line];
+  config->onLevel = smartIntercomOnLevels[line] >> SMARTINTERCOM_RING_ENVELOPE_Q;
+  config->openTime = smartIntercomOpenTimes[line];
+  config->autoOpenEnabled = (smartIntercomAutoOpenMask & bit) != 0;
+  config->alwaysOpenEnabled = (smartIntercomAlwaysOpenMask & bit) != 0;
+  return true;
+}
+
+/*
+ * SmartIntercomLines Post Config
+ * Событие CONFIG линии SmartIntercom с флагами SMARTINTERCOM_CONFIG_FLAG_*
+ */
+void SmartIntercomLines::smartIntercomPostConfig(uint8_t line) {
+  SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+  int32_t flags = ((smartIntercomAutoOpenMask & bit) ? SMARTINTERCOM_CONFIG_FLAG_AUTO_OPEN : 0) |
+                  ((smartIntercomAlwaysOpenMask & bit) ? SMARTINTERCOM_CONFIG_FLAG_ALWAYS_OPEN : 0);
+  smartIntercomEvents.smartIntercomPost(SMARTINTERCOM_EVENT_CONFIG, flags, line);
+}
+
+/*
+ * SmartIntercomLines Scan
+ * Один отсчет каждой включенной линии SmartIntercom
+ *
+ * Арифметика та же, что в SmartIntercomRingClassifier::smartIntercomProcess(),
+ * только состояние берется из массивов по номеру линии, а флаги -
+ * из масок. Возвращает маску линий, на которых начался звонок.
+ */
+SmartIntercomLineMask SmartIntercomLines::smartIntercomScan(unsigned long now) {
+  SmartIntercomLineMask started = 0;
+  SmartIntercomLineMask enabled = smartIntercomEnabledMask;
+  SmartIntercomLineMask ringing = smartIntercomRingingMask;
+  SmartIntercomLineMask pending = smartIntercomPendingMask;
+  SmartIntercomLineMask primed = smartIntercomPrimedMask;
+
+  for (uint8_t line = 0; line < SMARTINTERCOM_LINES; line++) {
+    SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+    if ((enabled & bit) == 0) {
+      continue;
+    }
+    int32_t scaled = (int32_t)smartIntercomAnalogRead(smartIntercomRingPins[line]) << SMARTINTERCOM_RING_BASELINE_Q;
+    if ((primed & bit) == 0) {
+      smartIntercomBaselines[line] = scaled;
+      primed |= bit;
+    }
+
+    // SmartIntercom Baseline is nearly frozen while the line rings
+    bool lineRinging = (ringing & bit) != 0;
+    int baselineShift = SMARTINTERCOM_RING_BASELINE_SHIFT + (lineRinging ? SMARTINTERCOM_RING_BASELINE_HOLD_SHIFT : 0);
+    smartIntercomBaselines[line] += (scaled - smartIntercomBaselines[line]) >> baselineShift;
+    int32_t deviation = (scaled - smartIntercomBaselines[line]) >> SMARTINTERCOM_RING_BASELINE_Q;
+
+    // SmartIntercom Envelope: rectify, fast attack, slow release
+    int32_t rectified = (deviation < 0 ? -deviation : deviation) << SMARTINTERCOM_RING_ENVELOPE_Q;
+    int32_t envelope = smartIntercomEnvelopes[line];
+    if (rectified > envelope) {
+      envelope += (rectified - envelope) >> SMARTINTERCOM_RING_ATTACK_SHIFT;
+    } else {
+      envelope -= (envelope - rectified) >> SMARTINTERCOM_RING_RELEASE_SHIFT;
+    }
+    smartIntercomEnvelopes[line] = envelope;
+
+    // SmartIntercom Hysteresis with dwell time
+    bool crossing = lineRinging ? envelope < smartIntercomOffLevels[line] : envelope >= smartIntercomOnLevels[line];
+    if (!crossing) {
+      pending &= ~bit;
+      continue;
+    }
+    if ((pending & bit) == 0) {
+      pending |= bit;
+      smartIntercomPendingSince[line] = now;
+    }
+    unsigned long dwell = lineRinging ? SMARTINTERCOM_RING_RELEASE_MS : SMARTINTERCOM_RING_MIN_ON_MS;
+    if (now - smartIntercomPendingSince[line] < dwell) {
+      continue;
+    }
+    pending &= ~bit;
+    ringing ^= bit;
+    if (!lineRinging) {
+      started |= bit;
+    }
+  }
+
+  smartIntercomRingingMask = ringing;
+  smartIntercomPendingMask = pending;
+  smartIntercomPrimedMask = primed;
+  return started;
+}
+
+/*
+ * SmartIntercomLines Process Ring
+ * Звонок на линии SmartIntercom: событие и авто-открытие
+ *
+ * Как и в одноканальном режиме, авто-открытие однократное:
+ * после срабатывания оно выключается, если не включено постоянное.
+ */
+void SmartIntercomLines::smartIntercomProcessRing(uint8_t line) {
+  SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+  smartIntercomRingCounts[line]++;
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Ring on line %u", line);
+  smartIntercomEvents.smartIntercomPost(SMARTINTERCOM_EVENT_RING, smartIntercomRingCounts[line], line);
+
+  if (((smartIntercomAutoOpenMask | smartIntercomAlwaysOpenMask) & bit) == 0) {
+    return;
+  }
+  smartIntercomOpenLine(line, SMARTINTERCOM_OPEN_AUTO);
+  if ((smartIntercomAlwaysOpenMask & bit) == 0) {
+    smartIntercomAutoOpenMask &= ~bit;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Auto-open disabled after use on line %u", line);
+    smartIntercomPostConfig(line);
+  }
+}
+
+/*
+ * SmartIntercomLines Update
+ * Главный цикл многоканального SmartIntercom
+ *
+ * Раз в SMARTINTERCOM_LINES_POLL_MS все линии опрашиваются одним
+ * проходом; затем обрабатываются только линии из масок начавшихся
+ * звонков и истекших открытий.
+ */
+void SmartIntercomLines::smartIntercomUpdate() {
+  unsigned long now = smartIntercomMillis();
+  if (smartIntercomScans == 0 || now - smartIntercomLastScan >= SMARTINTERCOM_LINES_POLL_MS) {
+    smartIntercomLastScan = now;
+    smartIntercomScans++;
+    // SmartIntercom Relays of all lines switch with one register write per pass
+    smartIntercomOutputBegin();
+
+    SmartIntercomLineMask expired = 0;
+    SmartIntercomLineMask open = smartIntercomDoorOpenMask;
+    for (uint8_t line = 0; open != 0; line++, open >>= 1) {
+      if ((open & 1) && (long)(now - smartIntercomDoorDeadlines[line]) >= 0) {
+        expired |= SMARTINTERCOM_LINE_BIT(line);
+      }
+    }
+    for (uint8_t line = 0; expired != 0; line++, expired >>= 1) {
+      if (expired & 1) {
+        smartIntercomCloseDoor(line);
+      }
+    }
+
+    SmartIntercomLineMask started = smartIntercomScan(now);
+    for (uint8_t line = 0; started != 0; line++, started >>= 1) {
+      if (started & 1) {
+        smartIntercomProcessRing(line);
+      }
+    }
+    smartIntercomOutputCommit();
+  }
+
+  smartIntercomEvents.smartIntercomDispatch();
+}
+
+/*
+ * SmartIntercomLines Get Idle Time
+ * Сколько главный цикл может спать до следующего опроса линий SmartIntercom
+ */
+unsigned long SmartIntercomLines::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (smartIntercomEnabledMask == 0) {
+    return maxMs;
+  }
+  if (smartIntercomEvents.smartIntercomHasPending()) {
+    return 0;
+  }
+  long remaining = (long)(smartIntercomLastScan + SMARTINTERCOM_LINES_POLL_MS - smartIntercomMillis());
+  if (remaining <= 0) {
+    return 0;
+  }
+  return (unsigned long)remaining < maxMs ? (unsigned long)remaining : maxMs;
+}
+
+void SmartIntercomLines::smartIntercomIdle(unsigned long maxMs) {
+  unsigned long budget = smartIntercomGetIdleTime(maxMs);
+  if (budget > 0) {
+    smartIntercomIdleWait(budget);
+  }
+}
+
+/*
+ * SmartIntercomLines Open Line
+ * Открыть замок линии SmartIntercom на ее время открытия
+ *
+ * Повторное открытие уже открытой линии продлевает срок.
+ */
+bool SmartIntercomLines::smartIntercomOpenLine(uint8_t line, SmartIntercomOpenSource source) {
+  if (line >= SMARTINTERCOM_LINES || (smartIntercomEnabledMask & SMARTINTERCOM_LINE_BIT(line)) == 0) {
+    return false;
+  }
+  smartIntercomOutputWrite(smartIntercomDoorPins[line], HIGH);
+  smartIntercomDoorDeadlines[line] = smartIntercomMillis() + smartIntercomOpenTimes[line];
+  smartIntercomDoorOpenMask |= SMARTINTERCOM_LINE_BIT(line);
+  smartIntercomOpenCounts[line]++;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Door opened on line %u", line);
+  smartIntercomEvents.smartIntercomPost(SMARTINTERCOM_EVENT_OPEN, source, line);
+  return true;
+}
+
+bool SmartIntercomLines::smartIntercomOpenDoor(uint8_t line) {
+  return smartIntercomOpenLine(line, SMARTINTERCOM_OPEN_MANUAL);
+}
+
+/*
+ * SmartIntercomLines Close Door
+ */
+bool SmartIntercomLines::smartIntercomCloseDoor(uint8_t line) {
+  if (line >= SMARTINTERCOM_LINES || (smartIntercomDoorOpenMask & SMARTINTERCOM_LINE_BIT(line)) == 0) {
+    return false;
+  }
+  smartIntercomOutputWrite(smartIntercomDoorPins[line], LOW);
+  smartIntercomDoorOpenMask &= ~SMARTINTERCOM_LINE_BIT(line);
+  smartIntercomEvents.smartIntercomPost(SMARTINTERCOM_EVENT_CLOSE, 0, line);
+  return true;
+}
+
+uint16_t SmartIntercomLines::smartIntercomGetRingCount(uint8_t line) {
+  return line < SMARTINTERCOM_LINES ? smartIntercomRingCounts[line] : 0;
+}
+
+uint16_t SmartIntercomLines::smartIntercomGetOpenCount(uint8_t line) {
+  return line < SMARTINTERCOM_LINES ? smartIntercomOpenCounts[line] : 0;
+}
+
+int SmartIntercomLines::smartIntercomGetEnvelope(uint8_t line) {
+  return line < SMARTINTERCOM_LINES ? smartIntercomEnvelopes[line] >> SMARTINTERCOM_RING_ENVELOPE_Q : 0;
+}
+
+/*
+ * SmartIntercomLines Subscribe
+ */
+uint8_t SmartIntercomLines::smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context, uint16_t mask,
+                                                   uint8_t batch) {
+  return smartIntercomEvents.smartIntercomSubscribe(handler, context, mask, batch);
+}
+
+void SmartIntercomLines::smartIntercomUnsubscribe(uint8_t id) {
+  smartIntercomEvents.smartIntercomUnsubscribe(id);
+}
+
+/*
+ * SmartIntercomLines Write Json
+ * Генератор тела /api/lines SmartIntercom: по элементу на линию
+ *
+ * Курсор - номер следующей линии; SMARTINTERCOM_LINES означает
+ * закрывающую скобку, дальше тело закончено.
+ */
+size_t SmartIntercomLines::smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomLines* lines = static_cast<SmartIntercomLines*>(context);
+  size_t used = 0;
+
+  while (*cursor <= SMARTINTERCOM_LINES) {
+    char* item = out + used;
+    size_t space = size - used;
+    int written;
+    if (*cursor == SMARTINTERCOM_LINES) {
+      if (space < 4) {
+        break;
+      }
+      written = snprintf(item, space, "%s]}", lines->smartIntercomEnabledMask ? "" : "{\"lines\":[");
+    } else {
+      uint8_t line = (uint8_t)*cursor;
+      SmartIntercomLineMask bit = SMARTINTERCOM_LINE_BIT(line);
+      if ((lines->smartIntercomEnabledMask & bit) == 0) {
+        (*cursor)++;
+        continue;
+      }
+      // SmartIntercom The object opening travels with the first enabled line
+      bool first = (lines->smartIntercomEnabledMask & (bit - 1)) == 0;
+      SmartIntercomLineConfig config;
+      lines->smartIntercomGetLineConfig(line, &config);
+      written = snprintf(item, space,
+                         "%s{\"line\":%u,\"ringing\":%s,\"open\":%s,\"auto_open\":%s,\"always_open\":%s,"
+                         "\"open_time\":%d,\"threshold\":%d,\"envelope\":%d,\"rings\":%u,\"opens\":%u}",
+                         first ? "{\"lines\":[" : ",", line, (lines->smartIntercomRingingMask & bit) ? "true" : "false",
+                         (lines->smartIntercomDoorOpenMask & bit) ? "true" : "false",
+                         config.autoOpenEnabled ? "true" : "false", config.alwaysOpenEnabled ? "true" : "false",
+                         config.openTime, config.onLevel, lines->smartIntercomGetEnvelope(line),
+                         lines->smartIntercomRingCounts[line], lines->smartIntercomOpenCounts[line]);
+    }
+    if (written < 0 || (size_t)written >= space) {
+      break;
+    }
+    used += written;
+    (*cursor)++;
+  }
+  return used;
+}
@@ -0,0 +1,147 @@
+/*
+ * SmartIntercomLines.h - Многоканальный режим SmartIntercom (N линий домофона)
+ *
+ * Один контроллер SmartIntercom обслуживает до 16 линий: у каждой свой
+ * вход звонка, свое реле замка, свои пороги, время открытия и режим
+ * авто-открытия. Число линий задается при сборке (SMARTINTERCOM_LINES),
+ * все состояние лежит в статических таблицах "структура массивов":
+ * отдельный массив на каждое поле и битовые маски флагов, по биту на
+ * линию. Так проход цикла читает подряд лежащие поля всех линий,
+ * флаги проверяются одной операцией над маской, а память не выделяется
+ * ни при запуске, ни в работе - период цикла растет только на
+ * постоянную стоимость опроса линии.
+ *
+ * Детектор звонка каждой линии - та же целочисленная цепочка, что в
+ * SmartIntercomRingClassifier (базовая линия, огибающая, гистерезис
+ * и выдержки), без фильтра Гёрцеля: он требует выборки по таймеру,
+ * а линии опрашиваются из loop(). На ESP8266 АЦП один (A0), поэтому
+ * звонки линий подаются на цифровые входы: analogRead() цифрового
+ * пина возвращает 0 или 1023, и детектор работает как для звонка
+ * уровнем.
+ *
+ * События RING/OPEN/CLOSE/CONFIG приходят через собственную очередь
+ * с номером линии в SmartIntercomEvent::channel.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_LINES_H
+#define SMARTINTERCOM_LINES_H
+
+#include <Arduino.h>
+#include "SmartIntercom.h"
+
+// SmartIntercom Lines Configuration
+#ifndef SMARTINTERCOM_LINES
+#define SMARTINTERCOM_LINES 8
+#endif
+
+#if SMARTINTERCOM_LINES < 1 || SMARTINTERCOM_LINES > 16
+#error "SmartIntercom supports 1 to 16 lines (one bit per line in a 16-bit mask)"
+#endif
+
+#define SMARTINTERCOM_LINES_POLL_MS 5             // Период опроса линий из loop()
+#define SMARTINTERCOM_LINES_ALL ((SmartIntercomLineMask)((1UL << SMARTINTERCOM_LINES) - 1))
+#define SMARTINTERCOM_LINE_BIT(line) ((SmartIntercomLineMask)(1U << (line)))
+
+// SmartIntercom Line Mask (бит на линию)
+typedef uint16_t SmartIntercomLineMask;
+
+/*
+ * SmartIntercomLineConfig - Настройки одной линии SmartIntercom
+ *
+ * Используется только для обмена с приложением и API; внутри
+ * SmartIntercomLines поля хранятся в отдельных массивах.
+ */
+struct SmartIntercomLineConfig {
+  int ringPin;                      // SmartIntercom вход звонка линии
+  int doorPin;                      // SmartIntercom реле замка линии
+  int onLevel;                      // SmartIntercom порог огибающей (отсчеты АЦП)
+  int openTime;                     // SmartIntercom время открытия, мс
+  bool autoOpenEnabled;             // SmartIntercom авто-открытие (однократное)
+  bool alwaysOpenEnabled;           // SmartIntercom постоянное открытие
+};
+
+/*
+ * SmartIntercomLines - Многоканальный контроллер SmartIntercom
+ */
+class SmartIntercomLines {
+private:
+  // SmartIntercom Line Configuration
+  uint8_t smartIntercomRingPins[SMARTINTERCOM_LINES];
+  uint8_t smartIntercomDoorPins[SMARTINTERCOM_LINES];
+  int32_t smartIntercomOnLevels[SMARTINTERCOM_LINES];
+  int32_t smartIntercomOffLevels[SMARTINTERCOM_LINES];
+  uint16_t smartIntercomOpenTimes[SMARTINTERCOM_LINES];
+  SmartIntercomLineMask smartIntercomEnabledMask;
+  SmartIntercomLineMask smartIntercomAutoOpenMask;
+  SmartIntercomLineMask smartIntercomAlwaysOpenMask;
+
+  // SmartIntercom Detector State
+  int32_t smartIntercomBaselines[SMARTINTERCOM_LINES];
+  int32_t smartIntercomEnvelopes[SMARTINTERCOM_LINES];
+  uint32_t smartIntercomPendingSince[SMARTINTERCOM_LINES];
+  SmartIntercomLineMask smartIntercomPrimedMask;
+  SmartIntercomLineMask smartIntercomRingingMask;
+  SmartIntercomLineMask smartIntercomPendingMask;
+
+  // SmartIntercom Door State
+  uint32_t smartIntercomDoorDeadlines[SMARTINTERCOM_LINES];
+  SmartIntercomLineMask smartIntercomDoorOpenMask;
+
+  // SmartIntercom Line Counters
+  uint16_t smartIntercomRingCounts[SMARTINTERCOM_LINES];
+  uint16_t smartIntercomOpenCounts[SMARTINTERCOM_LINES];
+
+  SmartIntercomEventQueue smartIntercomEvents;
+  unsigned long smartIntercomLastScan;
+  uint32_t smartIntercomScans;
+
+  // SmartIntercom Internal Methods
+  SmartIntercomLineMask smartIntercomScan(unsigned long now);
+  void smartIntercomProcessRing(uint8_t line);
+  bool smartIntercomOpenLine(uint8_t line, SmartIntercomOpenSource source);
+  void smartIntercomPostConfig(uint8_t line);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomLines();
+
+  // SmartIntercom Initialization (линия включается при настройке)
+  bool smartIntercomBeginLine(uint8_t line, const SmartIntercomLineConfig& config);
+  void smartIntercomDisableLine(uint8_t line);
+
+  // SmartIntercom Main Loop (один проход по всем линиям)
+  void smartIntercomUpdate();
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs = SMARTINTERCOM_IDLE_MAX_MS);
+  void smartIntercomIdle(unsigned long maxMs = SMARTINTERCOM_IDLE_MAX_MS);
+
+  // SmartIntercom Door Control
+  bool smartIntercomOpenDoor(uint8_t line);
+  bool smartIntercomCloseDoor(uint8_t line);
+
+  // SmartIntercom Line Configuration
+  bool smartIntercomSetLineConfig(uint8_t line, const SmartIntercomLineConfig& config);
+  bool smartIntercomGetLineConfig(uint8_t line, SmartIntercomLineConfig* config);
+
+  // SmartIntercom Line State
+  SmartIntercomLineMask smartIntercomGetEnabledLines() { return smartIntercomEnabledMask; }
+  SmartIntercomLineMask smartIntercomGetRingingLines() { return smartIntercomRingingMask; }
+  SmartIntercomLineMask smartIntercomGetOpenLines() { return smartIntercomDoorOpenMask; }
+  uint16_t smartIntercomGetRingCount(uint8_t line);
+  uint16_t smartIntercomGetOpenCount(uint8_t line);
+  int smartIntercomGetEnvelope(uint8_t line);
+  uint32_t smartIntercomGetScans() { return smartIntercomScans; }
+
+  // SmartIntercom Events (channel - номер линии)
+  uint8_t smartIntercomSubscribe(SmartIntercomEventHandler handler, void* context = nullptr,
+                                 uint16_t mask = SMARTINTERCOM_EVENT_ALL, uint8_t batch = SMARTINTERCOM_EVENT_BATCH);
+  void smartIntercomUnsubscribe(uint8_t id);
+  SmartIntercomEventQueue& smartIntercomGetEvents() { return smartIntercomEvents; }
+
+  // SmartIntercom JSON (генератор тела /api/lines, курсор - номер линии)
+  static size_t smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context);
+};
+
+#endif // SMARTINTERCOM_LINES_H
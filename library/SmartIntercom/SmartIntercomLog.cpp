@@ -0,0 +1,325 @@
+/*
+ * SmartIntercomLog.cpp - Реализация журнала SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomLog.h"
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Log Storage (при отключенном журнале буфер не нужен)
+#if SMARTINTERCOM_LOG_ACTIVE_LEVEL > SMARTINTERCOM_LOG_NONE
+#define SMARTINTERCOM_LOG_STORAGE SMARTINTERCOM_LOG_BUFFER_SIZE
+#else
+#define SMARTINTERCOM_LOG_STORAGE 1
+#endif
+
+static SmartIntercomLogRecord smartIntercomLogRecords[SMARTINTERCOM_LOG_STORAGE];
+static uint16_t smartIntercomLogHead = 0;
+static uint16_t smartIntercomLogCount = 0;
+static uint32_t smartIntercomLogDropped = 0;
+static uint32_t smartIntercomLogReportedDropped = 0;
+
+// SmartIntercom Pending Output Line (частично отданная строка)
+static char smartIntercomLogLine[SMARTINTERCOM_LOG_LINE_MAX];
+static size_t smartIntercomLogLineLength = 0;
+static size_t smartIntercomLogLineOffset = 0;
+
+/*
+ * SmartIntercom Log Serial Sink
+ * Вывод в Serial SmartIntercom без ожидания: только свободное место FIFO
+ */
+static size_t smartIntercomLogSerialSink(const char* text, size_t length, void* context) {
+  (void)context;
+  int available = Serial.availableForWrite();
+  if (available <= 0) {
+    return 0;
+  }
+  if ((size_t)available < length) {
+    length = (size_t)available;
+  }
+  return Serial.write((const uint8_t*)text, length);
+}
+
+static SmartIntercomLogSink smartIntercomLogSinkHandler = smartIntercomLogSerialSink;
+static void* smartIntercomLogSinkContext = nullptr;
+
+// ============================================================================
+// SmartIntercom Log Recording
+// ============================================================================
+
+/*
+ * SmartIntercom Log Write
+ * Сохранить двоичную запись журнала SmartIntercom
+ *
+ * При заполненном буфере новая запись отбрасывается и учитывается;
+ * о потерях сообщается строкой при следующем выводе.
+ */
+void smartIntercomLogWrite(uint8_t level, const char* format, const SmartIntercomLogArg* args, uint8_t count) {
+  if (smartIntercomLogCount >= SMARTINTERCOM_LOG_STORAGE) {
+    smartIntercomLogDropped++;
+    return;
+  }
+
+  uint16_t index = (smartIntercomLogHead + smartIntercomLogCount) % SMARTINTERCOM_LOG_STORAGE;
+  SmartIntercomLogRecord& record = smartIntercomLogRecords[index];
+  record.timeMs = smartIntercomActiveHAL ? smartIntercomMillis() : 0;
+  record.format = format;
+  record.level = level;
+  record.argCount = count > SMARTINTERCOM_LOG_MAX_ARGS ? SMARTINTERCOM_LOG_MAX_ARGS : count;
+  for (uint8_t i = 0; i < record.argCount; i++) {
+    record.args[i] = args[i];
+  }
+  smartIntercomLogCount++;
+}
+
+// ============================================================================
+// SmartIntercom Log Formatting
+// ============================================================================
+
+/*
+ * SmartIntercom Log Append
+ * Дописать символ в строку SmartIntercom с учетом размера
+ */
+static inline void smartIntercomLogAppend(char* out, size_t size, size_t* length, char c) {
+  if (*length + 1 < size) {
+    out[*length] = c;
+  }
+  (*length)++;
+}
+
+/*
+ * SmartIntercom Log Append Number
+ * Целое SmartIntercom в заданной системе счисления с шириной поля
+ */
+static void smartIntercomLogAppendNumber(char* out, size_t size, size_t* length, unsigned long value,
+                                         bool negative, unsigned int base, bool upper, int width, char pad) {
+  char digits[24];
+  int count = 0;
+  const char* alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  do {
+    digits[count++] = alphabet[value % base];
+    value /= base;
+  } while (value > 0 && count < (int)sizeof(digits));
+
+  int total = count + (negative ? 1 : 0);
+  if (negative && pad == '0') {
+    smartIntercomLogAppend(out, size, length, '-');
+  }
+  for (; total < width; total++) {
+    smartIntercomLogAppend(out, size, length, pad);
+  }
+  if (negative && pad != '0') {
+    smartIntercomLogAppend(out, size, length, '-');
+  }
+  while (count > 0) {
+    smartIntercomLogAppend(out, size, length, digits[--count]);
+  }
+}
+
+/*
+ * SmartIntercom Log Format
+ * Собрать текст записи SmartIntercom по строке формата из флеш-памяти
+ *
+ * Поддерживаются %d %i %u %x %X %c %s %% с флагами '-', '0', шириной
+ * и модификатором l (игнорируется: аргументы уже приведены).
+ * Возвращает длину строки без учета обрезки.
+ */
+size_t smartIntercomLogFormat(const SmartIntercomLogRecord& record, char* out, size_t size) {
+  static const char smartIntercomLogLevels[] = "-EWID";
+  size_t length = 0;
+  uint8_t argIndex = 0;
+
+  // SmartIntercom Record prefix: "<ms> <level> "
+  smartIntercomLogAppendNumber(out, size, &length, record.timeMs, false, 10, false, 0, ' ');
+  smartIntercomLogAppend(out, size, &length, ' ');
+  smartIntercomLogAppend(out, size, &length, smartIntercomLogLevels[record.level <= 4 ? record.level : 0]);
+  smartIntercomLogAppend(out, size, &length, ' ');
+
+  const char* cursor = record.format;
+  char c;
+  while ((c = (char)pgm_read_byte(cursor++)) != '\0') {
+    if (c != '%') {
+      smartIntercomLogAppend(out, size, &length, c);
+      continue;
+    }
+
+    bool leftAlign = false;
+    char pad = ' ';
+    int width = 0;
+    c = (char)pgm_read_byte(cursor++);
+    while (c == '-' || c == '0') {
+      if (c == '-') {
+        leftAlign = true;
+      } else {
+        pad = '0';
+      }
+      c = (char)pgm_read_byte(cursor++);
+    }
+    while (c >= '0' && c <= '9') {
+      width = width * 10 + (c - '0');
+      c = (char)pgm_read_byte(cursor++);
+    }
+    while (c == 'l') {
+      c = (char)pgm_read_byte(cursor++);
+    }
+    if (c == '\0') {
+      break;
+    }
+    if (c == '%') {
+      smartIntercomLogAppend(out, size, &length, '%');
+      continue;
+    }
+
+    SmartIntercomLogArg arg = argIndex < record.argCount ? record.args[argIndex] : 0;
+    argIndex++;
+    size_t start = length;
+
+    switch (c) {
+      case 'd':
+      case 'i': {
+        long value = (long)(intptr_t)arg;
+        unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+        smartIntercomLogAppendNumber(out, size, &length, magnitude, value < 0, 10, false,
+                                     leftAlign ? 0 : width, pad);
+        break;
+      }
+      case 'u':
+        smartIntercomLogAppendNumber(out, size, &length, (unsigned long)arg, false, 10, false,
+                                     leftAlign ? 0 : width, pad);
+        break;
+      case 'x':
+      case 'X':
+        smartIntercomLogAppendNumber(out, size, &length, (unsigned long)arg, false, 16, c == 'X',
+                                     leftAlign ? 0 : width, pad);
+        break;
+      case 'c':
+        smartIntercomLogAppend(out, size, &length, (char)arg);
+        break;
+      case 's': {
+        const char* text = (const char*)arg;
+        if (text == nullptr) {
+          text = "(null)";
+        }
+        char t;
+        while ((t = (char)pgm_read_byte(text++)) != '\0') {
+          smartIntercomLogAppend(out, size, &length, t);
+        }
+        break;
+      }
+      default:
+        smartIntercomLogAppend(out, size, &length, '%');
+        smartIntercomLogAppend(out, size, &length, c);
+        break;
+    }
+
+    if (leftAlign) {
+      for (size_t printed = length - start; printed < (size_t)width; printed++) {
+        smartIntercomLogAppend(out, size, &length, ' ');
+      }
+    }
+  }
+
+  smartIntercomLogAppend(out, size, &length, '\n');
+  if (size > 0) {
+    out[length < size ? length : size - 1] = '\0';
+    if (length >= size && size > 1) {
+      out[size - 2] = '\n';
+    }
+  }
+  return length;
+}
+
+// ============================================================================
+// SmartIntercom Log Output
+// ============================================================================
+
+/*
+ * SmartIntercom Log Next Line
+ * Подготовить следующую строку SmartIntercom к выводу
+ */
+static bool smartIntercomLogNextLine() {
+  if (smartIntercomLogDropped != smartIntercomLogReportedDropped) {
+    SmartIntercomLogRecord notice;
+    notice.timeMs = smartIntercomActiveHAL ? smartIntercomMillis() : 0;
+    notice.format = PSTR("SmartIntercom: %lu log records dropped");
+    notice.level = SMARTINTERCOM_LOG_WARNING_LEVEL;
+    notice.argCount = 1;
+    notice.args[0] = smartIntercomLogDropped - smartIntercomLogReportedDropped;
+    smartIntercomLogReportedDropped = smartIntercomLogDropped;
+    smartIntercomLogFormat(notice, smartIntercomLogLine, sizeof(smartIntercomLogLine));
+  } else if (smartIntercomLogCount > 0) {
+    smartIntercomLogFormat(smartIntercomLogRecords[smartIntercomLogHead], smartIntercomLogLine,
+                           sizeof(smartIntercomLogLine));
+    smartIntercomLogHead = (smartIntercomLogHead + 1) % SMARTINTERCOM_LOG_STORAGE;
+    smartIntercomLogCount--;
+  } else {
+    return false;
+  }
+  smartIntercomLogLineLength = strlen(smartIntercomLogLine);
+  smartIntercomLogLineOffset = 0;
+  return true;
+}
+
+/*
+ * SmartIntercom Log Drain
+ * Вывести до maxRecords записей SmartIntercom, не дожидаясь UART
+ *
+ * Возвращает число полностью выведенных строк.
+ */
+uint16_t smartIntercomLogDrain(uint16_t maxRecords) {
+  uint16_t written = 0;
+  while (written < maxRecords) {
+    if (smartIntercomLogLineOffset >= smartIntercomLogLineLength && !smartIntercomLogNextLine()) {
+      break;
+    }
+    size_t remaining = smartIntercomLogLineLength - smartIntercomLogLineOffset;
+    size_t accepted = smartIntercomLogSinkHandler(smartIntercomLogLine + smartIntercomLogLineOffset, remaining,
+                                                  smartIntercomLogSinkContext);
+    smartIntercomLogLineOffset += accepted;
+    if (accepted < remaining) {
+      break;
+    }
+    written++;
+  }
+  return written;
+}
+
+/*
+ * SmartIntercom Log Flush
+ * Вывести весь журнал SmartIntercom (блокирующе: setup, перед перезагрузкой)
+ */
+void smartIntercomLogFlush() {
+  while (smartIntercomLogGetPending() > 0) {
+    if (smartIntercomLogDrain(SMARTINTERCOM_LOG_STORAGE) == 0) {
+      yield();
+    }
+  }
+}
+
+/*
+ * SmartIntercom Log Set Sink
+ * Заменить получателя строк журнала SmartIntercom (nullptr - Serial)
+ */
+void smartIntercomLogSetSink(SmartIntercomLogSink sink, void* context) {
+  smartIntercomLogSinkHandler = sink ? sink : smartIntercomLogSerialSink;
+  smartIntercomLogSinkContext = sink ? context : nullptr;
+}
+
+/*
+ * SmartIntercom Log Get Pending
+ * Записи SmartIntercom, еще не отданные получателю (включая текущую строку)
+ */
+uint16_t smartIntercomLogGetPending() {
+  bool linePending = smartIntercomLogLineOffset < smartIntercomLogLineLength;
+  bool noticePending = smartIntercomLogDropped != smartIntercomLogReportedDropped;
+  return smartIntercomLogCount + (linePending ? 1 : 0) + (noticePending ? 1 : 0);
+}
+
+/*
+ * SmartIntercom Log Get Dropped
+ */
+uint32_t smartIntercomLogGetDropped() {
+  return smartIntercomLogDropped;
+}
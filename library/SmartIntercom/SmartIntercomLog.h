@@ -0,0 +1,152 @@
+/*
+ * SmartIntercomLog.h - Журнал SmartIntercom с уровнями и отложенным выводом
+ *
+ * Уровни журнала отсекаются на этапе компиляции: вызовы выше
+ * SMARTINTERCOM_LOG_LEVEL не порождают кода и не вычисляют аргументы.
+ * Разрешенные сообщения записываются в кольцевой буфер в ОЗУ как
+ * компактные двоичные записи (время, уровень, указатель на строку
+ * формата во флеш-памяти, до SMARTINTERCOM_LOG_MAX_ARGS аргументов).
+ * Текст собирается позже, в smartIntercomLogDrain(), и отдается
+ * в Serial только в пределах свободного места в FIFO UART,
+ * поэтому журнал не блокирует главный цикл.
+ *
+ * Уровни и флаги задаются флагами сборки библиотеки, например
+ * build_flags = -DSMARTINTERCOM_LOG_LEVEL=4 (PlatformIO).
+ *
+ * Аргументы %s должны указывать на строки со статическим временем
+ * жизни (литералы, PSTR): они читаются при выводе, а не при записи.
+ * Писать в журнал из прерываний нельзя.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_LOG_H
+#define SMARTINTERCOM_LOG_H
+
+#include <Arduino.h>
+
+// SmartIntercom Log Levels
+#define SMARTINTERCOM_LOG_NONE 0
+#define SMARTINTERCOM_LOG_ERROR_LEVEL 1
+#define SMARTINTERCOM_LOG_WARNING_LEVEL 2
+#define SMARTINTERCOM_LOG_INFO_LEVEL 3
+#define SMARTINTERCOM_LOG_DEBUG_LEVEL 4
+
+// SmartIntercom Log Configuration
+#ifndef SMARTINTERCOM_DEBUG_ENABLED
+#define SMARTINTERCOM_DEBUG_ENABLED true
+#endif
+
+#ifndef SMARTINTERCOM_LOG_LEVEL
+#define SMARTINTERCOM_LOG_LEVEL SMARTINTERCOM_LOG_INFO_LEVEL
+#endif
+
+#ifndef SMARTINTERCOM_LOG_BUFFER_SIZE
+#define SMARTINTERCOM_LOG_BUFFER_SIZE 32
+#endif
+
+#define SMARTINTERCOM_LOG_MAX_ARGS 4
+#define SMARTINTERCOM_LOG_LINE_MAX 160
+#define SMARTINTERCOM_LOG_DRAIN_BUDGET 4
+
+#if SMARTINTERCOM_DEBUG_ENABLED
+#define SMARTINTERCOM_LOG_ACTIVE_LEVEL SMARTINTERCOM_LOG_LEVEL
+#else
+#define SMARTINTERCOM_LOG_ACTIVE_LEVEL SMARTINTERCOM_LOG_NONE
+#endif
+
+// SmartIntercom Log Argument (целое или указатель на строку)
+typedef uintptr_t SmartIntercomLogArg;
+
+/*
+ * SmartIntercomLogRecord - Двоичная запись журнала SmartIntercom
+ */
+struct SmartIntercomLogRecord {
+  uint32_t timeMs;
+  const char* format;
+  uint8_t level;
+  uint8_t argCount;
+  SmartIntercomLogArg args[SMARTINTERCOM_LOG_MAX_ARGS];
+};
+
+/*
+ * SmartIntercomLogSink - Получатель готовых строк журнала SmartIntercom
+ *
+ * Возвращает число принятых байт; меньше length - остаток будет
+ * предложен снова при следующем smartIntercomLogDrain().
+ */
+typedef size_t (*SmartIntercomLogSink)(const char* text, size_t length, void* context);
+
+// SmartIntercom Log Core
+void smartIntercomLogWrite(uint8_t level, const char* format, const SmartIntercomLogArg* args, uint8_t count);
+uint16_t smartIntercomLogDrain(uint16_t maxRecords = SMARTINTERCOM_LOG_DRAIN_BUDGET);
+void smartIntercomLogFlush();
+size_t smartIntercomLogFormat(const SmartIntercomLogRecord& record, char* out, size_t size);
+void smartIntercomLogSetSink(SmartIntercomLogSink sink, void* context);
+uint16_t smartIntercomLogGetPending();
+uint32_t smartIntercomLogGetDropped();
+
+/*
+ * SmartIntercom Log Argument Conversion
+ * Целые (со знаком и без) и указатели сохраняются как SmartIntercomLogArg
+ */
+template <typename T>
+inline SmartIntercomLogArg smartIntercomLogArgValue(T value) {
+  return (SmartIntercomLogArg)value;
+}
+
+inline SmartIntercomLogArg smartIntercomLogArgValue(const char* value) {
+  return (SmartIntercomLogArg)value;
+}
+
+/*
+ * SmartIntercom Log
+ * Запись сообщения SmartIntercom с произвольным (до 4) числом аргументов
+ */
+inline void smartIntercomLog(uint8_t level, const char* format) {
+  smartIntercomLogWrite(level, format, nullptr, 0);
+}
+
+template <typename... Args>
+inline void smartIntercomLog(uint8_t level, const char* format, Args... args) {
+  static_assert(sizeof...(Args) <= SMARTINTERCOM_LOG_MAX_ARGS, "SmartIntercom: too many log arguments");
+  const SmartIntercomLogArg values[] = { smartIntercomLogArgValue(args)... };
+  smartIntercomLogWrite(level, format, values, (uint8_t)sizeof...(Args));
+}
+
+/*
+ * SmartIntercom Log Macros
+ * Строка формата всегда размещается во флеш-памяти (PSTR)
+ */
+#define SMARTINTERCOM_LOG_EMPTY() do {} while (0)
+
+#if SMARTINTERCOM_LOG_ACTIVE_LEVEL >= SMARTINTERCOM_LOG_ERROR_LEVEL
+#define SMARTINTERCOM_LOG_ERROR(format, ...) \
+  smartIntercomLog(SMARTINTERCOM_LOG_ERROR_LEVEL, PSTR(format), ##__VA_ARGS__)
+#else
+#define SMARTINTERCOM_LOG_ERROR(format, ...) SMARTINTERCOM_LOG_EMPTY()
+#endif
+
+#if SMARTINTERCOM_LOG_ACTIVE_LEVEL >= SMARTINTERCOM_LOG_WARNING_LEVEL
+#define SMARTINTERCOM_LOG_WARNING(format, ...) \
+  smartIntercomLog(SMARTINTERCOM_LOG_WARNING_LEVEL, PSTR(format), ##__VA_ARGS__)
+#else
+#define SMARTINTERCOM_LOG_WARNING(format, ...) SMARTINTERCOM_LOG_EMPTY()
+#endif
+
+#if SMARTINTERCOM_LOG_ACTIVE_LEVEL >= SMARTINTERCOM_LOG_INFO_LEVEL
+#define SMARTINTERCOM_LOG_INFO(format, ...) \
+  smartIntercomLog(SMARTINTERCOM_LOG_INFO_LEVEL, PSTR(format), ##__VA_ARGS__)
+#else
+#define SMARTINTERCOM_LOG_INFO(format, ...) SMARTINTERCOM_LOG_EMPTY()
+#endif
+
+#if SMARTINTERCOM_LOG_ACTIVE_LEVEL >= SMARTINTERCOM_LOG_DEBUG_LEVEL
+#define SMARTINTERCOM_LOG_DEBUG(format, ...) \
+  smartIntercomLog(SMARTINTERCOM_LOG_DEBUG_LEVEL, PSTR(format), ##__VA_ARGS__)
+#else
+#define SMARTINTERCOM_LOG_DEBUG(format, ...) SMARTINTERCOM_LOG_EMPTY()
+#endif
+
+#endif // SMARTINTERCOM_LOG_H
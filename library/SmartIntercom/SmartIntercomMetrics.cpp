@@ -0,0 +1,214 @@
+/*
+ * SmartIntercomMetrics.cpp - Реализация гистограмм SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomMetrics.h"
+
+#define SMARTINTERCOM_METRICS_LINE_MAX 128
+#define SMARTINTERCOM_METRICS_QUANTILES 4
+
+// SmartIntercom Exported Histograms (границы le - степени двойки мкс от minShift до maxShift)
+struct SmartIntercomMetricInfo {
+  const char* name;
+  const char* help;
+  uint8_t minShift;
+  uint8_t maxShift;
+};
+
+static const SmartIntercomMetricInfo smartIntercomMetricInfo[SMARTINTERCOM_METRICS] = {
+  { "ring_to_open", "Ring edge to door relay on auto-open", 10, 24 },
+  { "api_request", "API request received to last response byte sent", 6, 22 },
+  { "loop_period", "Time between main loop passes", 8, 20 },
+  { "wifi_reconnect", "WiFi link lost to IP address acquired", 16, 26 },
+  { "wifi_connect", "WiFi connect attempt started to IP address acquired", 14, 25 }
+};
+
+static const uint16_t smartIntercomMetricQuantiles[SMARTINTERCOM_METRICS_QUANTILES] = { 500, 900, 990, 999 };
+static const char* const smartIntercomMetricQuantileLabels[SMARTINTERCOM_METRICS_QUANTILES] = {
+  "0.5", "0.9", "0.99", "0.999"
+};
+
+// ============================================================================
+// SmartIntercom Histogram
+// ============================================================================
+
+/*
+ * SmartIntercomHistogram Constructor
+ */
+SmartIntercomHistogram::SmartIntercomHistogram() {
+  smartIntercomClear();
+}
+
+void SmartIntercomHistogram::smartIntercomClear() {
+  memset(smartIntercomBuckets, 0, sizeof(smartIntercomBuckets));
+  smartIntercomCount = 0;
+  smartIntercomMax = 0;
+  smartIntercomSum = 0;
+}
+
+/*
+ * SmartIntercomHistogram Bucket Index
+ * Ячейка SmartIntercom: старший бит задает степень, следующие SUB_BITS - подъячейку
+ *
+ * Значения меньше 2^(SUB_BITS+1) ложатся в ячейки один к одному.
+ */
+uint8_t SmartIntercomHistogram::smartIntercomBucketIndex(uint32_t valueUs) {
+  if (valueUs < (2UL << SMARTINTERCOM_METRICS_SUB_BITS)) {
+    return (uint8_t)valueUs;
+  }
+  uint8_t msb = 31;
+  while ((valueUs & (1UL << msb)) == 0) {
+    msb--;
+  }
+  uint8_t shift = msb - SMARTINTERCOM_METRICS_SUB_BITS;
+  return (uint8_t)((shift + 1) * SMARTINTERCOM_METRICS_SUB_BUCKETS +
+                   ((valueUs >> shift) - SMARTINTERCOM_METRICS_SUB_BUCKETS));
+}
+
+/*
+ * SmartIntercomHistogram Bucket Upper
+ * Наибольшее значение SmartIntercom, попадающее в ячейку index
+ */
+uint32_t SmartIntercomHistogram::smartIntercomBucketUpper(uint8_t index) {
+  if (index < 2 * SMARTINTERCOM_METRICS_SUB_BUCKETS) {
+    return index;
+  }
+  uint8_t shift = index / SMARTINTERCOM_METRICS_SUB_BUCKETS - 1;
+  uint32_t lowest = (uint32_t)(index % SMARTINTERCOM_METRICS_SUB_BUCKETS + SMARTINTERCOM_METRICS_SUB_BUCKETS) << shift;
+  return lowest + ((1UL << shift) - 1);
+}
+
+/*
+ * SmartIntercomHistogram Record
+ */
+void SmartIntercomHistogram::smartIntercomRecord(uint32_t valueUs) {
+  smartIntercomBuckets[smartIntercomBucketIndex(valueUs)]++;
+  smartIntercomCount++;
+  smartIntercomSum += valueUs;
+  if (valueUs > smartIntercomMax) {
+    smartIntercomMax = valueUs;
+  }
+}
+
+/*
+ * SmartIntercomHistogram Get Count Below
+ * Число значений SmartIntercom меньше limitUs (точно для степеней двойки)
+ */
+uint32_t SmartIntercomHistogram::smartIntercomGetCountBelow(uint32_t limitUs) {
+  uint8_t end = smartIntercomBucketIndex(limitUs);
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < end; i++) {
+    count += smartIntercomBuckets[i];
+  }
+  return count;
+}
+
+/*
+ * SmartIntercomHistogram Get Percentile
+ * Верхняя граница ячейки SmartIntercom, где накопилось permille/1000 значений
+ */
+uint32_t SmartIntercomHistogram::smartIntercomGetPercentile(uint16_t permille) {
+  if (smartIntercomCount == 0) {
+    return 0;
+  }
+  uint32_t target = (uint32_t)(((uint64_t)smartIntercomCount * permille + 999) / 1000);
+  if (target == 0) {
+    target = 1;
+  }
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < SMARTINTERCOM_METRICS_BUCKETS; i++) {
+    seen += smartIntercomBuckets[i];
+    if (seen >= target) {
+      uint32_t upper = smartIntercomBucketUpper(i);
+      return upper < smartIntercomMax ? upper : smartIntercomMax;
+    }
+  }
+  return smartIntercomMax;
+}
+
+// ============================================================================
+// SmartIntercom Prometheus Exposition
+// ============================================================================
+
+/*
+ * SmartIntercomMetrics Format Line
+ * Строка line гистограммы metric в текстовом формате Prometheus (0 - строки кончились)
+ *
+ * Для каждой гистограммы: HELP/TYPE, накопительные ячейки le,
+ * _sum и _count, затем отдельный gauge с квантилями по точным
+ * ячейкам (quantile="1" - максимум).
+ */
+size_t SmartIntercomMetrics::smartIntercomFormatLine(uint8_t metric, uint16_t line, char* out, size_t size) {
+  const SmartIntercomMetricInfo& info = smartIntercomMetricInfo[metric];
+  SmartIntercomHistogram& histogram = smartIntercomHistograms[metric];
+  uint16_t buckets = info.maxShift - info.minShift + 1;
+  int written = 0;
+
+  if (line == 0) {
+    written = snprintf(out, size, "# HELP smartintercom_%s_seconds %s.\n", info.name, info.help);
+  } else if (line == 1) {
+    written = snprintf(out, size, "# TYPE smartintercom_%s_seconds histogram\n", info.name);
+  } else if (line < 2 + buckets) {
+    uint32_t limitUs = 1UL << (info.minShift + line - 2);
+    written = snprintf(out, size, "smartintercom_%s_seconds_bucket{le=\"%lu.%06lu\"} %lu\n", info.name,
+                       (unsigned long)(limitUs / 1000000UL), (unsigned long)(limitUs % 1000000UL),
+                       (unsigned long)histogram.smartIntercomGetCountBelow(limitUs));
+  } else if (line == 2 + buckets) {
+    written = snprintf(out, size, "smartintercom_%s_seconds_bucket{le=\"+Inf\"} %lu\n", info.name,
+                       (unsigned long)histogram.smartIntercomGetCount());
+  } else if (line == 3 + buckets) {
+    uint64_t sum = histogram.smartIntercomGetSum();
+    written = snprintf(out, size, "smartintercom_%s_seconds_sum %lu.%06lu\n", info.name,
+                       (unsigned long)(sum / 1000000ULL), (unsigned long)(sum % 1000000ULL));
+  } else if (line == 4 + buckets) {
+    written = snprintf(out, size, "smartintercom_%s_seconds_count %lu\n", info.name,
+                       (unsigned long)histogram.smartIntercomGetCount());
+  } else if (line == 5 + buckets) {
+    written = snprintf(out, size, "# HELP smartintercom_%s_quantile_seconds %s, quantiles.\n", info.name, info.help);
+  } else if (line == 6 + buckets) {
+    written = snprintf(out, size, "# TYPE smartintercom_%s_quantile_seconds gauge\n", info.name);
+  } else if (line < 7 + buckets + SMARTINTERCOM_METRICS_QUANTILES + 1) {
+    uint16_t quantile = line - 7 - buckets;
+    bool isMax = quantile == SMARTINTERCOM_METRICS_QUANTILES;
+    const char* label = isMax ? "1" : smartIntercomMetricQuantileLabels[quantile];
+    if (histogram.smartIntercomGetCount() == 0) {
+      written = snprintf(out, size, "smartintercom_%s_quantile_seconds{quantile=\"%s\"} NaN\n", info.name, label);
+    } else {
+      uint32_t valueUs = isMax ? histogram.smartIntercomGetMax()
+                               : histogram.smartIntercomGetPercentile(smartIntercomMetricQuantiles[quantile]);
+      written = snprintf(out, size, "smartintercom_%s_quantile_seconds{quantile=\"%s\"} %lu.%06lu\n", info.name,
+                         label, (unsigned long)(valueUs / 1000000UL), (unsigned long)(valueUs % 1000000UL));
+    }
+  }
+  return written > 0 ? (size_t)written : 0;
+}
+
+/*
+ * SmartIntercomMetrics Write Prometheus
+ * Генератор тела /api/metrics SmartIntercom: целые строки, пока помещаются
+ *
+ * Курсор - номер гистограммы (старшие 16 бит) и строки в ней.
+ */
+size_t SmartIntercomMetrics::smartIntercomWritePrometheus(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomMetrics* metrics = (SmartIntercomMetrics*)context;
+  size_t used = 0;
+
+  while (size - used > SMARTINTERCOM_METRICS_LINE_MAX) {
+    uint8_t metric = (uint8_t)(*cursor >> 16);
+    uint16_t line = (uint16_t)(*cursor & 0xFFFF);
+    if (metric >= SMARTINTERCOM_METRICS) {
+      break;
+    }
+    size_t written = metrics->smartIntercomFormatLine(metric, line, out + used, size - used);
+    if (written == 0) {
+      *cursor = (uint32_t)(metric + 1) << 16;
+      continue;
+    }
+    used += written;
+    *cursor = ((uint32_t)metric << 16) | (uint32_t)(line + 1);
+  }
+  return used;
+}
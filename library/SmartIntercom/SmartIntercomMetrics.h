@@ -0,0 +1,95 @@
+/*
+ * SmartIntercomMetrics.h - Гистограммы задержек SmartIntercom для Prometheus
+ *
+ * Гистограммы в стиле HDR: значение в микросекундах попадает в
+ * логарифмическую ячейку (степень двойки), разделенную на
+ * 2^SMARTINTERCOM_METRICS_SUB_BITS линейных подъячеек, поэтому
+ * относительная погрешность одинакова от микросекунд до часов,
+ * а память постоянна и занята при старте.
+ *
+ * Измеряются задержка от фронта звонка до включения реле при
+ * авто-открытии, время обслуживания запроса API, период главного
+ * цикла и время переподключения WiFi. Все записи выполняются из
+ * главного цикла, без прерываний.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_METRICS_H
+#define SMARTINTERCOM_METRICS_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Histogram Layout
+#define SMARTINTERCOM_METRICS_SUB_BITS 2
+#define SMARTINTERCOM_METRICS_SUB_BUCKETS (1 << SMARTINTERCOM_METRICS_SUB_BITS)
+#define SMARTINTERCOM_METRICS_BUCKETS ((32 - SMARTINTERCOM_METRICS_SUB_BITS + 1) * SMARTINTERCOM_METRICS_SUB_BUCKETS)
+
+// SmartIntercom Histograms
+enum SmartIntercomMetric {
+  SMARTINTERCOM_METRIC_RING_TO_OPEN,    // Фронт звонка -> реле (авто-открытие)
+  SMARTINTERCOM_METRIC_REQUEST_TIME,    // Запрос API -> последний байт ответа
+  SMARTINTERCOM_METRIC_LOOP_PERIOD,     // Между вызовами smartIntercomUpdate()
+  SMARTINTERCOM_METRIC_WIFI_RECONNECT,  // Потеря связи -> получен IP
+  SMARTINTERCOM_METRIC_WIFI_CONNECT,    // Начало попытки подключения -> получен IP
+  SMARTINTERCOM_METRICS
+};
+
+/*
+ * SmartIntercomHistogram - Логарифмическая гистограмма SmartIntercom
+ *
+ * Значения до 2^32 мкс; счетчики ячеек 32-битные.
+ */
+class SmartIntercomHistogram {
+private:
+  uint32_t smartIntercomBuckets[SMARTINTERCOM_METRICS_BUCKETS];
+  uint32_t smartIntercomCount;
+  uint32_t smartIntercomMax;
+  uint64_t smartIntercomSum;
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomHistogram();
+
+  // SmartIntercom Recording (O(1))
+  void smartIntercomRecord(uint32_t valueUs);
+  void smartIntercomClear();
+
+  // SmartIntercom Queries
+  uint32_t smartIntercomGetCount() { return smartIntercomCount; }
+  uint64_t smartIntercomGetSum() { return smartIntercomSum; }
+  uint32_t smartIntercomGetMax() { return smartIntercomMax; }
+  uint32_t smartIntercomGetCountBelow(uint32_t limitUs);
+  uint32_t smartIntercomGetPercentile(uint16_t permille);
+
+  // SmartIntercom Bucket Layout
+  static uint8_t smartIntercomBucketIndex(uint32_t valueUs);
+  static uint32_t smartIntercomBucketUpper(uint8_t index);
+};
+
+/*
+ * SmartIntercomMetrics - Набор гистограмм SmartIntercom
+ */
+class SmartIntercomMetrics {
+private:
+  SmartIntercomHistogram smartIntercomHistograms[SMARTINTERCOM_METRICS];
+
+  // SmartIntercom Prometheus Exposition
+  size_t smartIntercomFormatLine(uint8_t metric, uint16_t line, char* out, size_t size);
+
+public:
+  // SmartIntercom Recording
+  void smartIntercomRecord(SmartIntercomMetric metric, uint32_t valueUs) {
+    smartIntercomHistograms[metric].smartIntercomRecord(valueUs);
+  }
+  SmartIntercomHistogram& smartIntercomGetHistogram(SmartIntercomMetric metric) {
+    return smartIntercomHistograms[metric];
+  }
+
+  // SmartIntercom Prometheus Text Format (генератор для SmartIntercomHttpResponse)
+  static size_t smartIntercomWritePrometheus(char* out, size_t size, uint32_t* cursor, void* context);
+};
+
+#endif // SMARTINTERCOM_METRICS_H
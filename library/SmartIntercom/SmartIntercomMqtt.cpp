@@ -0,0 +1,1003 @@
+/*
+ * SmartIntercomMqtt.cpp - Реализация MQTT-клиента SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomMqtt.h"
+#include "SmartIntercom.h"
+#include "SmartIntercomLog.h"
+
+// SmartIntercom MQTT Control Packet Types (старшие 4 бита первого байта)
+#define SMARTINTERCOM_MQTT_CONNECT 0x10
+#define SMARTINTERCOM_MQTT_CONNACK 0x20
+#define SMARTINTERCOM_MQTT_PUBLISH 0x30
+#define SMARTINTERCOM_MQTT_PUBACK 0x40
+#define SMARTINTERCOM_MQTT_SUBSCRIBE 0x82
+#define SMARTINTERCOM_MQTT_SUBACK 0x90
+#define SMARTINTERCOM_MQTT_PINGREQ 0xC0
+#define SMARTINTERCOM_MQTT_PINGRESP 0xD0
+#define SMARTINTERCOM_MQTT_DISCONNECT 0xE0
+
+// SmartIntercom MQTT Flags
+#define SMARTINTERCOM_MQTT_PUBLISH_DUP 0x08
+#define SMARTINTERCOM_MQTT_PUBLISH_RETAIN 0x01
+#define SMARTINTERCOM_MQTT_CONNECT_USER 0x80
+#define SMARTINTERCOM_MQTT_CONNECT_PASSWORD 0x40
+#define SMARTINTERCOM_MQTT_CONNECT_WILL_RETAIN 0x20
+#define SMARTINTERCOM_MQTT_CONNECT_WILL_QOS1 0x08
+#define SMARTINTERCOM_MQTT_CONNECT_WILL 0x04
+
+#define SMARTINTERCOM_MQTT_SUBSCRIBE_ID 1
+#define SMARTINTERCOM_MQTT_COMMAND_MAX 32
+
+static size_t smartIntercomMqttLengthSize(size_t remaining) {
+  size_t size = 1;
+  while (remaining >= 128) {
+    remaining >>= 7;
+    size++;
+  }
+  return size;
+}
+
+static size_t smartIntercomMqttStringLength(const char* text) {
+  return text ? strlen(text) : 0;
+}
+
+// ============================================================================
+// SmartIntercom MQTT Outbox
+// ============================================================================
+
+/*
+ * SmartIntercomMqttOutbox Constructor
+ */
+SmartIntercomMqttOutbox::SmartIntercomMqttOutbox() {
+  memset(smartIntercomSlots, 0, sizeof(smartIntercomSlots));
+  smartIntercomSequence = 0;
+  smartIntercomNextPacketId = 1;
+  smartIntercomCoalesced = 0;
+  smartIntercomDropped = 0;
+}
+
+/*
+ * SmartIntercomMqttOutbox Find Free
+ * Свободная ячейка SmartIntercom; при переполнении вытесняется самое старое
+ * неотправленное сообщение (повторные отправки не вытесняются)
+ */
+SmartIntercomMqttMessage* SmartIntercomMqttOutbox::smartIntercomFindFree() {
+  SmartIntercomMqttMessage* oldest = nullptr;
+  for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+    SmartIntercomMqttMessage& message = smartIntercomSlots[i];
+    if (message.state == SMARTINTERCOM_MQTT_SLOT_FREE) {
+      return &message;
+    }
+    if (message.state == SMARTINTERCOM_MQTT_SLOT_QUEUED && !message.duplicate &&
+        (oldest == nullptr || (int32_t)(message.sequence - oldest->sequence) < 0)) {
+      oldest = &message;
+    }
+  }
+  if (oldest) {
+    smartIntercomDropped++;
+  }
+  return oldest;
+}
+
+/*
+ * SmartIntercomMqttOutbox Add
+ * Поставить сообщение SmartIntercom в очередь (топик и данные копируются;
+ * топик от SMARTINTERCOM_MQTT_TOPIC_MAX символов не принимается)
+ *
+ * Сообщение с coalesce хранится в одном экземпляре на топик: то же
+ * значение, которое уже ждет отправки или PUBACK (в том числе повтор
+ * с DUP после переподключения), не ставится второй раз, а новое
+ * значение заменяет неотправленное и снимает отправленное старое.
+ */
+bool SmartIntercomMqttOutbox::smartIntercomAdd(const char* topic, const char* payload, size_t length, uint8_t qos,
+                                              bool retain, bool coalesce) {
+  size_t topicLength = strlen(topic);
+  if (length > SMARTINTERCOM_MQTT_PAYLOAD_MAX || topicLength >= SMARTINTERCOM_MQTT_TOPIC_MAX) {
+    smartIntercomDropped++;
+    return false;
+  }
+
+  SmartIntercomMqttMessage* message = nullptr;
+  if (coalesce) {
+    for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+      SmartIntercomMqttMessage& candidate = smartIntercomSlots[i];
+      if (candidate.state == SMARTINTERCOM_MQTT_SLOT_FREE || !candidate.coalesce ||
+          strcmp(candidate.topic, topic) != 0) {
+        continue;
+      }
+      smartIntercomCoalesced++;
+      if (candidate.length == length && memcmp(candidate.payload, payload, length) == 0) {
+        return true;
+      }
+      if (candidate.state == SMARTINTERCOM_MQTT_SLOT_QUEUED && !candidate.duplicate) {
+        message = &candidate;
+      } else {
+        // SmartIntercom A sent older value is superseded; its PUBACK is no longer awaited
+        candidate.state = SMARTINTERCOM_MQTT_SLOT_FREE;
+      }
+      break;
+    }
+  }
+  if (message == nullptr) {
+    message = smartIntercomFindFree();
+    if (message == nullptr) {
+      smartIntercomDropped++;
+      return false;
+    }
+    message->sequence = ++smartIntercomSequence;
+    message->packetId = SMARTINTERCOM_MQTT_NO_PACKET_ID;
+    message->duplicate = false;
+  }
+
+  message->state = SMARTINTERCOM_MQTT_SLOT_QUEUED;
+  message->qos = qos > 0 ? 1 : 0;
+  message->retain = retain;
+  message->coalesce = coalesce;
+  memcpy(message->topic, topic, topicLength + 1);
+  message->length = (uint16_t)length;
+  memcpy(message->payload, payload, length);
+  return true;
+}
+
+/*
+ * SmartIntercomMqttOutbox Next Queued
+ * Самое старое сообщение SmartIntercom в очереди; номер пакета QoS 1
+ * назначается здесь и сохраняется до PUBACK
+ */
+SmartIntercomMqttMessage* SmartIntercomMqttOutbox::smartIntercomNextQueued() {
+  SmartIntercomMqttMessage* oldest = nullptr;
+  for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+    SmartIntercomMqttMessage& message = smartIntercomSlots[i];
+    if (message.state == SMARTINTERCOM_MQTT_SLOT_QUEUED &&
+        (oldest == nullptr || (int32_t)(message.sequence - oldest->sequence) < 0)) {
+      oldest = &message;
+    }
+  }
+  if (oldest == nullptr || oldest->qos == 0 || oldest->packetId != SMARTINTERCOM_MQTT_NO_PACKET_ID) {
+    return oldest;
+  }
+
+  // SmartIntercom Packet ids are unique among messages still waiting for PUBACK
+  for (;;) {
+    uint16_t id = smartIntercomNextPacketId++;
+    if (smartIntercomNextPacketId == SMARTINTERCOM_MQTT_NO_PACKET_ID) {
+      smartIntercomNextPacketId = 1;
+    }
+    bool used = false;
+    for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+      if (smartIntercomSlots[i].state != SMARTINTERCOM_MQTT_SLOT_FREE && smartIntercomSlots[i].packetId == id) {
+        used = true;
+        break;
+      }
+    }
+    if (!used && id != SMARTINTERCOM_MQTT_NO_PACKET_ID) {
+      oldest->packetId = id;
+      return oldest;
+    }
+  }
+}
+
+/*
+ * SmartIntercomMqttOutbox Mark Sent
+ */
+void SmartIntercomMqttOutbox::smartIntercomMarkSent(SmartIntercomMqttMessage* message) {
+  message->state = message->qos > 0 ? SMARTINTERCOM_MQTT_SLOT_INFLIGHT : SMARTINTERCOM_MQTT_SLOT_FREE;
+}
+
+/*
+ * SmartIntercomMqttOutbox Acknowledge
+ * PUBACK SmartIntercom: освободить сообщение с номером packetId
+ */
+bool SmartIntercomMqttOutbox::smartIntercomAcknowledge(uint16_t packetId) {
+  for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+    SmartIntercomMqttMessage& message = smartIntercomSlots[i];
+    if (message.state == SMARTINTERCOM_MQTT_SLOT_INFLIGHT && message.packetId == packetId) {
+      message.state = SMARTINTERCOM_MQTT_SLOT_FREE;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomMqttOutbox Requeue Inflight
+ * Разрыв связи SmartIntercom: неподтвержденные сообщения снова в очередь с DUP
+ */
+uint8_t SmartIntercomMqttOutbox::smartIntercomRequeueInflight() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+    SmartIntercomMqttMessage& message = smartIntercomSlots[i];
+    if (message.state == SMARTINTERCOM_MQTT_SLOT_INFLIGHT) {
+      message.state = SMARTINTERCOM_MQTT_SLOT_QUEUED;
+      message.duplicate = true;
+      count++;
+    }
+  }
+  return count;
+}
+
+uint8_t SmartIntercomMqttOutbox::smartIntercomGetCount(uint8_t state) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < SMARTINTERCOM_MQTT_OUTBOX_SIZE; i++) {
+    if (smartIntercomSlots[i].state == state) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// ============================================================================
+// SmartIntercom MQTT Client
+// ============================================================================
+
+/*
+ * SmartIntercomMqttClient Constructor
+ */
+SmartIntercomMqttClient::SmartIntercomMqttClient() {
+  smartIntercomTransport = nullptr;
+  memset(&smartIntercomSettings, 0, sizeof(smartIntercomSettings));
+  smartIntercomHandler = nullptr;
+  smartIntercomHandlerContext = nullptr;
+  smartIntercomConnectHandler = nullptr;
+  smartIntercomConnectContext = nullptr;
+  smartIntercomWillTopic = nullptr;
+  smartIntercomWillPayload = nullptr;
+  smartIntercomState = SMARTINTERCOM_MQTT_DISCONNECTED;
+  smartIntercomStateSince = 0;
+  smartIntercomRetryAt = 0;
+  smartIntercomBackoffMs = SMARTINTERCOM_MQTT_RECONNECT_MS;
+  smartIntercomLastTx = 0;
+  smartIntercomLastRx = 0;
+  smartIntercomPingSentAt = 0;
+  smartIntercomPingPending = false;
+  smartIntercomTxLength = 0;
+  smartIntercomRxLength = 0;
+  smartIntercomConnects = 0;
+  smartIntercomPublished = 0;
+  smartIntercomAcked = 0;
+  smartIntercomRetransmitted = 0;
+  smartIntercomReceived = 0;
+}
+
+/*
+ * SmartIntercomMqttClient Begin
+ * Первая попытка подключения SmartIntercom - в ближайшем smartIntercomUpdate()
+ */
+void SmartIntercomMqttClient::smartIntercomBegin(SmartIntercomMqttTransport* transport,
+                                                 const SmartIntercomMqttSettings& settings) {
+  smartIntercomTransport = transport;
+  smartIntercomSettings = settings;
+  if (smartIntercomSettings.keepAliveS == 0) {
+    smartIntercomSettings.keepAliveS = SMARTINTERCOM_MQTT_KEEPALIVE_S;
+  }
+  smartIntercomState = SMARTINTERCOM_MQTT_DISCONNECTED;
+  smartIntercomRetryAt = smartIntercomMillis();
+  smartIntercomBackoffMs = SMARTINTERCOM_MQTT_RECONNECT_MS;
+}
+
+/*
+ * SmartIntercomMqttClient Publish
+ */
+bool SmartIntercomMqttClient::smartIntercomPublish(const char* topic, const char* payload, size_t length, uint8_t qos,
+                                                   bool retain, bool coalesce) {
+  if (topic == nullptr || topic[0] == '\0') {
+    return false;
+  }
+  return smartIntercomOutbox.smartIntercomAdd(topic, payload, length, qos, retain, coalesce);
+}
+
+// ============================================================================
+// SmartIntercom MQTT Packet Encoding
+// ============================================================================
+
+/*
+ * SmartIntercomMqttClient Begin Packet
+ * Заголовок пакета SmartIntercom, если весь пакет помещается в буфер передачи
+ */
+bool SmartIntercomMqttClient::smartIntercomBeginPacket(uint8_t header, size_t remaining) {
+  size_t total = 1 + smartIntercomMqttLengthSize(remaining) + remaining;
+  if (smartIntercomTxLength + total > SMARTINTERCOM_MQTT_TX_BUFFER_SIZE) {
+    return false;
+  }
+  smartIntercomPutByte(header);
+  do {
+    uint8_t digit = remaining & 0x7F;
+    remaining >>= 7;
+    smartIntercomPutByte(remaining > 0 ? (digit | 0x80) : digit);
+  } while (remaining > 0);
+  return true;
+}
+
+void SmartIntercomMqttClient::smartIntercomPutByte(uint8_t value) {
+  smartIntercomTx[smartIntercomTxLength++] = value;
+}
+
+void SmartIntercomMqttClient::smartIntercomPutWord(uint16_t value) {
+  smartIntercomPutByte((uint8_t)(value >> 8));
+  smartIntercomPutByte((uint8_t)(value & 0xFF));
+}
+
+void SmartIntercomMqttClient::smartIntercomPutString(const char* text, size_t length) {
+  smartIntercomPutWord((uint16_t)length);
+  memcpy(smartIntercomTx + smartIntercomTxLength, text, length);
+  smartIntercomTxLength += length;
+}
+
+/*
+ * SmartIntercomMqttClient Send Connect
+ * CONNECT SmartIntercom с сохраняемой сессией, Last Will и учетными данными
+ */
+bool SmartIntercomMqttClient::smartIntercomSendConnect() {
+  size_t clientLength = smartIntercomMqttStringLength(smartIntercomSettings.clientId);
+  size_t userLength = smartIntercomMqttStringLength(smartIntercomSettings.user);
+  size_t passwordLength = smartIntercomMqttStringLength(smartIntercomSettings.password);
+  size_t willTopicLength = smartIntercomMqttStringLength(smartIntercomWillTopic);
+  size_t willPayloadLength = smartIntercomMqttStringLength(smartIntercomWillPayload);
+
+  uint8_t flags = 0;
+  size_t remaining = 10 + 2 + clientLength;
+  if (willTopicLength > 0) {
+    flags |= SMARTINTERCOM_MQTT_CONNECT_WILL | SMARTINTERCOM_MQTT_CONNECT_WILL_QOS1 |
+             SMARTINTERCOM_MQTT_CONNECT_WILL_RETAIN;
+    remaining += 2 + willTopicLength + 2 + willPayloadLength;
+  }
+  if (userLength > 0) {
+    flags |= SMARTINTERCOM_MQTT_CONNECT_USER;
+    remaining += 2 + userLength;
+    if (passwordLength > 0) {
+      flags |= SMARTINTERCOM_MQTT_CONNECT_PASSWORD;
+      remaining += 2 + passwordLength;
+    }
+  }
+
+  if (!smartIntercomBeginPacket(SMARTINTERCOM_MQTT_CONNECT, remaining)) {
+    return false;
+  }
+  smartIntercomPutString("MQTT", 4);
+  smartIntercomPutByte(4);  // SmartIntercom Protocol level 3.1.1
+  smartIntercomPutByte(flags);
+  smartIntercomPutWord(smartIntercomSettings.keepAliveS);
+  smartIntercomPutString(smartIntercomSettings.clientId, clientLength);
+  if (flags & SMARTINTERCOM_MQTT_CONNECT_WILL) {
+    smartIntercomPutString(smartIntercomWillTopic, willTopicLength);
+    smartIntercomPutString(smartIntercomWillPayload, willPayloadLength);
+  }
+  if (flags & SMARTINTERCOM_MQTT_CONNECT_USER) {
+    smartIntercomPutString(smartIntercomSettings.user, userLength);
+  }
+  if (flags & SMARTINTERCOM_MQTT_CONNECT_PASSWORD) {
+    smartIntercomPutString(smartIntercomSettings.password, passwordLength);
+  }
+  return true;
+}
+
+/*
+ * SmartIntercomMqttClient Send Subscribe
+ */
+bool SmartIntercomMqttClient::smartIntercomSendSubscribe() {
+  size_t topicLength = smartIntercomMqttStringLength(smartIntercomSettings.topicCommands);
+  if (topicLength == 0) {
+    return true;
+  }
+  if (!smartIntercomBeginPacket(SMARTINTERCOM_MQTT_SUBSCRIBE, 2 + 2 + topicLength + 1)) {
+    return false;
+  }
+  smartIntercomPutWord(SMARTINTERCOM_MQTT_SUBSCRIBE_ID);
+  smartIntercomPutString(smartIntercomSettings.topicCommands, topicLength);
+  smartIntercomPutByte(smartIntercomSettings.qos > 0 ? 1 : 0);
+  return true;
+}
+
+/*
+ * SmartIntercomMqttClient Send Publish
+ */
+bool SmartIntercomMqttClient::smartIntercomSendPublish(SmartIntercomMqttMessage* message) {
+  size_t topicLength = strlen(message->topic);
+  uint8_t header = SMARTINTERCOM_MQTT_PUBLISH | (uint8_t)(message->qos << 1);
+  if (message->retain) {
+    header |= SMARTINTERCOM_MQTT_PUBLISH_RETAIN;
+  }
+  if (message->duplicate) {
+    header |= SMARTINTERCOM_MQTT_PUBLISH_DUP;
+  }
+  size_t remaining = 2 + topicLength + (message->qos > 0 ? 2 : 0) + message->length;
+  if (!smartIntercomBeginPacket(header, remaining)) {
+    return false;
+  }
+  smartIntercomPutString(message->topic, topicLength);
+  if (message->qos > 0) {
+    smartIntercomPutWord(message->packetId);
+  }
+  memcpy(smartIntercomTx + smartIntercomTxLength, message->payload, message->length);
+  smartIntercomTxLength += message->length;
+  return true;
+}
+
+/*
+ * SmartIntercomMqttClient Send Short
+ * Пакет SmartIntercom без полезной нагрузки (PUBACK, PINGREQ, DISCONNECT)
+ */
+bool SmartIntercomMqttClient::smartIntercomSendShort(uint8_t header, uint16_t packetId, bool withId) {
+  if (!smartIntercomBeginPacket(header, withId ? 2 : 0)) {
+    return false;
+  }
+  if (withId) {
+    smartIntercomPutWord(packetId);
+  }
+  return true;
+}
+
+// ============================================================================
+// SmartIntercom MQTT Session
+// ============================================================================
+
+/*
+ * SmartIntercomMqttClient Start Connect
+ */
+void SmartIntercomMqttClient::smartIntercomStartConnect(unsigned long now) {
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: MQTT connecting to %s:%d", smartIntercomSettings.server,
+                         smartIntercomSettings.port);
+  smartIntercomTxLength = 0;
+  smartIntercomRxLength = 0;
+  if (smartIntercomTransport == nullptr ||
+      !smartIntercomTransport->smartIntercomConnect(smartIntercomSettings.server, smartIntercomSettings.port)) {
+    smartIntercomDropLink(now);
+    return;
+  }
+  smartIntercomState = SMARTINTERCOM_MQTT_CONNECTING;
+  smartIntercomStateSince = now;
+}
+
+/*
+ * SmartIntercomMqttClient Drop Link
+ * Закрыть соединение SmartIntercom и запланировать переподключение
+ *
+ * Неподтвержденные сообщения остаются в outbox и уйдут повторно.
+ */
+void SmartIntercomMqttClient::smartIntercomDropLink(unsigned long now) {
+  if (smartIntercomTransport) {
+    smartIntercomTransport->smartIntercomClose();
+  }
+  if (smartIntercomState == SMARTINTERCOM_MQTT_CONNECTED) {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: MQTT connection lost, %d messages to resend",
+                              smartIntercomOutbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_INFLIGHT));
+  } else {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: MQTT connect failed, retry in %lu ms", smartIntercomBackoffMs);
+  }
+  smartIntercomOutbox.smartIntercomRequeueInflight();
+  smartIntercomTxLength = 0;
+  smartIntercomRxLength = 0;
+  smartIntercomPingPending = false;
+  smartIntercomState = SMARTINTERCOM_MQTT_DISCONNECTED;
+  smartIntercomRetryAt = now + smartIntercomBackoffMs;
+  smartIntercomBackoffMs *= 2;
+  if (smartIntercomBackoffMs > SMARTINTERCOM_MQTT_RECONNECT_MAX_MS) {
+    smartIntercomBackoffMs = SMARTINTERCOM_MQTT_RECONNECT_MAX_MS;
+  }
+}
+
+/*
+ * SmartIntercomMqttClient Receive
+ * Прочитать пришедшие байты SmartIntercom и разобрать целые пакеты
+ */
+void SmartIntercomMqttClient::smartIntercomReceive(unsigned long now) {
+  for (;;) {
+    size_t space = SMARTINTERCOM_MQTT_RX_BUFFER_SIZE - smartIntercomRxLength;
+    size_t received = space > 0 ? smartIntercomTransport->smartIntercomRead(smartIntercomRx + smartIntercomRxLength,
+                                                                             space)
+                                : 0;
+    smartIntercomRxLength += received;
+
+    size_t consumed = 0;
+    while (smartIntercomRxLength - consumed >= 2) {
+      const uint8_t* packet = smartIntercomRx + consumed;
+      size_t available = smartIntercomRxLength - consumed;
+      size_t remaining = 0;
+      size_t offset = 1;
+      uint8_t shift = 0;
+      bool complete = false;
+      while (offset < available && offset <= 4) {
+        uint8_t digit = packet[offset++];
+        remaining |= (size_t)(digit & 0x7F) << shift;
+        shift += 7;
+        if ((digit & 0x80) == 0) {
+          complete = true;
+          break;
+        }
+      }
+      if (!complete) {
+        if (offset > 4) {
+          smartIntercomDropLink(now);
+          return;
+        }
+        break;
+      }
+      if (offset + remaining > SMARTINTERCOM_MQTT_RX_BUFFER_SIZE) {
+        SMARTINTERCOM_LOG_WARNING("SmartIntercom: MQTT packet of %d bytes exceeds the receive buffer",
+                                  (int)(offset + remaining));
+        smartIntercomDropLink(now);
+        return;
+      }
+      if (offset + remaining > available) {
+        break;
+      }
+      smartIntercomLastRx = now;
+      if (!smartIntercomHandlePacket(packet, offset + remaining, offset)) {
+        smartIntercomDropLink(now);
+        return;
+      }
+      consumed += offset + remaining;
+    }
+
+    if (consumed > 0) {
+      memmove(smartIntercomRx, smartIntercomRx + consumed, smartIntercomRxLength - consumed);
+      smartIntercomRxLength -= consumed;
+    }
+    if (received == 0) {
+      return;
+    }
+  }
+}
+
+/*
+ * SmartIntercomMqttClient Handle Packet
+ * Обработать входящий пакет SmartIntercom (false - разорвать соединение)
+ */
+bool SmartIntercomMqttClient::smartIntercomHandlePacket(const uint8_t* packet, size_t length, size_t offset) {
+  const uint8_t* body = packet + offset;
+  size_t bodyLength = length - offset;
+
+  switch (packet[0] & 0xF0) {
+    case SMARTINTERCOM_MQTT_CONNACK:
+      if (bodyLength < 2 || smartIntercomState != SMARTINTERCOM_MQTT_AWAIT_CONNACK) {
+        return false;
+      }
+      if (body[1] != 0) {
+        SMARTINTERCOM_LOG_ERROR("SmartIntercom: MQTT broker refused connection, code %d", body[1]);
+        return false;
+      }
+      smartIntercomState = SMARTINTERCOM_MQTT_CONNECTED;
+      smartIntercomConnects++;
+      smartIntercomBackoffMs = SMARTINTERCOM_MQTT_RECONNECT_MS;
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: MQTT connected (session present: %d, resending %d)", body[0] & 0x01,
+                             smartIntercomOutbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_QUEUED));
+      if (smartIntercomConnectHandler) {
+        smartIntercomConnectHandler(smartIntercomConnectContext);
+      }
+      return smartIntercomSendSubscribe();
+
+    case SMARTINTERCOM_MQTT_PUBLISH: {
+      uint8_t qos = (packet[0] >> 1) & 0x03;
+      if (bodyLength < 2) {
+        return false;
+      }
+      size_t topicLength = ((size_t)body[0] << 8) | body[1];
+      size_t position = 2 + topicLength;
+      uint16_t packetId = 0;
+      if (qos > 0) {
+        if (position + 2 > bodyLength) {
+          return false;
+        }
+        packetId = (uint16_t)((body[position] << 8) | body[position + 1]);
+        position += 2;
+      }
+      if (position > bodyLength) {
+        return false;
+      }
+      smartIntercomReceived++;
+      if (smartIntercomHandler) {
+        smartIntercomHandler((const char*)(body + 2), topicLength, body + position, bodyLength - position,
+                             smartIntercomHandlerContext);
+      }
+      if (qos == 1) {
+        smartIntercomSendShort(SMARTINTERCOM_MQTT_PUBACK, packetId, true);
+      }
+      return true;
+    }
+
+    case SMARTINTERCOM_MQTT_PUBACK:
+      if (bodyLength >= 2 &&
+          smartIntercomOutbox.smartIntercomAcknowledge((uint16_t)((body[0] << 8) | body[1]))) {
+        smartIntercomAcked++;
+      }
+      return true;
+
+    case SMARTINTERCOM_MQTT_SUBACK:
+      if (bodyLength >= 3 && body[2] == 0x80) {
+        SMARTINTERCOM_LOG_WARNING("SmartIntercom: MQTT broker rejected the command subscription");
+      }
+      return true;
+
+    case SMARTINTERCOM_MQTT_PINGRESP:
+      smartIntercomPingPending = false;
+      return true;
+
+    default:
+      return true;
+  }
+}
+
+/*
+ * SmartIntercomMqttClient Fill Publishes
+ * Пачка PUBLISH SmartIntercom: сколько позволяют окно QoS 1 и буфер передачи
+ */
+void SmartIntercomMqttClient::smartIntercomFillPublishes() {
+  uint8_t inflight = smartIntercomOutbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_INFLIGHT);
+  while (inflight < SMARTINTERCOM_MQTT_INFLIGHT_MAX) {
+    SmartIntercomMqttMessage* message = smartIntercomOutbox.smartIntercomNextQueued();
+    if (message == nullptr || !smartIntercomSendPublish(message)) {
+      return;
+    }
+    if (message->duplicate) {
+      smartIntercomRetransmitted++;
+    }
+    if (message->qos > 0) {
+      inflight++;
+    }
+    smartIntercomOutbox.smartIntercomMarkSent(message);
+    smartIntercomPublished++;
+  }
+}
+
+/*
+ * SmartIntercomMqttClient Flush
+ * Записать в сокет SmartIntercom столько буфера передачи, сколько он примет
+ */
+void SmartIntercomMqttClient::smartIntercomFlush(unsigned long now) {
+  if (smartIntercomTxLength == 0) {
+    return;
+  }
+  size_t written = smartIntercomTransport->smartIntercomWrite(smartIntercomTx, smartIntercomTxLength);
+  if (written == 0) {
+    return;
+  }
+  memmove(smartIntercomTx, smartIntercomTx + written, smartIntercomTxLength - written);
+  smartIntercomTxLength -= written;
+  smartIntercomLastTx = now;
+}
+
+/*
+ * SmartIntercomMqttClient Update
+ * Шаг клиента SmartIntercom из главного цикла (никогда не ждет сеть)
+ */
+void SmartIntercomMqttClient::smartIntercomUpdate() {
+  if (smartIntercomTransport == nullptr) {
+    return;
+  }
+  unsigned long now = smartIntercomMillis();
+
+  if (smartIntercomState == SMARTINTERCOM_MQTT_DISCONNECTED) {
+    if ((long)(now - smartIntercomRetryAt) >= 0) {
+      smartIntercomStartConnect(now);
+    }
+    return;
+  }
+
+  SmartIntercomMqttLink link = smartIntercomTransport->smartIntercomGetLink();
+  if (link == SMARTINTERCOM_MQTT_LINK_DOWN) {
+    smartIntercomDropLink(now);
+    return;
+  }
+
+  if (smartIntercomState == SMARTINTERCOM_MQTT_CONNECTING) {
+    if (link == SMARTINTERCOM_MQTT_LINK_CONNECTING) {
+      if (now - smartIntercomStateSince >= SMARTINTERCOM_MQTT_CONNACK_TIMEOUT_MS) {
+        smartIntercomDropLink(now);
+      }
+      return;
+    }
+    if (!smartIntercomSendConnect()) {
+      smartIntercomDropLink(now);
+      return;
+    }
+    smartIntercomState = SMARTINTERCOM_MQTT_AWAIT_CONNACK;
+    smartIntercomStateSince = now;
+    smartIntercomLastRx = now;
+  }
+
+  smartIntercomReceive(now);
+  if (smartIntercomState == SMARTINTERCOM_MQTT_DISCONNECTED) {
+    return;
+  }
+
+  if (smartIntercomState == SMARTINTERCOM_MQTT_AWAIT_CONNACK) {
+    if (now - smartIntercomStateSince >= SMARTINTERCOM_MQTT_CONNACK_TIMEOUT_MS) {
+      smartIntercomDropLink(now);
+      return;
+    }
+  } else {
+    smartIntercomFillPublishes();
+
+    // SmartIntercom Keep-alive: ping after half the interval of silence, give up after another half
+    unsigned long keepAliveMs = (unsigned long)smartIntercomSettings.keepAliveS * 1000UL;
+    if (smartIntercomPingPending && now - smartIntercomPingSentAt >= keepAliveMs / 2 &&
+        now - smartIntercomLastRx >= keepAliveMs / 2) {
+      smartIntercomDropLink(now);
+      return;
+    }
+    if (!smartIntercomPingPending && now - smartIntercomLastTx >= keepAliveMs / 2 &&
+        smartIntercomSendShort(SMARTINTERCOM_MQTT_PINGREQ, 0, false)) {
+      smartIntercomPingPending = true;
+      smartIntercomPingSentAt = now;
+    }
+  }
+
+  smartIntercomFlush(now);
+}
+
+/*
+ * SmartIntercomMqttClient Get Idle Time
+ * Сколько цикл может спать, не задерживая клиент SmartIntercom
+ *
+ * WiFiClient не будит цикл при приходе данных, поэтому при открытом
+ * соединении сон ограничен SMARTINTERCOM_MQTT_POLL_MS.
+ */
+unsigned long SmartIntercomMqttClient::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (smartIntercomTransport == nullptr) {
+    return maxMs;
+  }
+  unsigned long now = smartIntercomMillis();
+  unsigned long budget = maxMs;
+
+  if (smartIntercomState == SMARTINTERCOM_MQTT_DISCONNECTED) {
+    long remaining = (long)(smartIntercomRetryAt - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    return (unsigned long)remaining < budget ? (unsigned long)remaining : budget;
+  }
+
+  if (smartIntercomState == SMARTINTERCOM_MQTT_CONNECTED) {
+    if (smartIntercomOutbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_QUEUED) > 0 &&
+        smartIntercomOutbox.smartIntercomGetCount(SMARTINTERCOM_MQTT_SLOT_INFLIGHT) < SMARTINTERCOM_MQTT_INFLIGHT_MAX &&
+        smartIntercomTxLength == 0) {
+      return 0;
+    }
+    unsigned long pingAt = smartIntercomLastTx + (unsigned long)smartIntercomSettings.keepAliveS * 500UL;
+    long remaining = (long)(pingAt - now);
+    if (!smartIntercomPingPending && remaining <= 0) {
+      return 0;
+    }
+    if (!smartIntercomPingPending && (unsigned long)remaining < budget) {
+      budget = (unsigned long)remaining;
+    }
+  }
+  if (smartIntercomTxLength > 0 && budget > SMARTINTERCOM_IDLE_SLICE_MS) {
+    budget = SMARTINTERCOM_IDLE_SLICE_MS;
+  }
+  return budget < SMARTINTERCOM_MQTT_POLL_MS ? budget : SMARTINTERCOM_MQTT_POLL_MS;
+}
+
+/*
+ * SmartIntercomMqttClient Disconnect
+ * Штатное отключение SmartIntercom (брокер не публикует Last Will)
+ */
+void SmartIntercomMqttClient::smartIntercomDisconnect() {
+  if (smartIntercomTransport == nullptr) {
+    return;
+  }
+  if (smartIntercomState == SMARTINTERCOM_MQTT_CONNECTED &&
+      smartIntercomSendShort(SMARTINTERCOM_MQTT_DISCONNECT, 0, false)) {
+    smartIntercomFlush(smartIntercomMillis());
+  }
+  smartIntercomTransport->smartIntercomClose();
+  smartIntercomOutbox.smartIntercomRequeueInflight();
+  smartIntercomTxLength = 0;
+  smartIntercomRxLength = 0;
+  smartIntercomState = SMARTINTERCOM_MQTT_DISCONNECTED;
+  smartIntercomTransport = nullptr;
+}
+
+// ============================================================================
+// SmartIntercom MQTT Integration
+// ============================================================================
+
+static const char* const smartIntercomMqttStateKeys[SMARTINTERCOM_STATES] = {
+  "init", "ready", "idle", "ringing", "opening", "open", "closing", "error"
+};
+
+/*
+ * SmartIntercomMqtt Constructor
+ */
+SmartIntercomMqtt::SmartIntercomMqtt() {
+  smartIntercomDevice = nullptr;
+  memset(&smartIntercomSettings, 0, sizeof(smartIntercomSettings));
+  smartIntercomSubscriber = SMARTINTERCOM_EVENT_NO_SUBSCRIBER;
+  smartIntercomStatusDirty = false;
+  smartIntercomEventId = 0;
+  smartIntercomRingCount = 0;
+  smartIntercomCommands = 0;
+}
+
+/*
+ * SmartIntercomMqtt Begin
+ * Подписать MQTT-интеграцию SmartIntercom на события устройства
+ */
+void SmartIntercomMqtt::smartIntercomBegin(SmartIntercom& device, SmartIntercomMqttTransport* transport,
+                                           const SmartIntercomMqttSettings& settings) {
+  smartIntercomDevice = &device;
+  smartIntercomSettings = settings;
+  smartIntercomClient.smartIntercomBegin(transport, settings);
+  smartIntercomClient.smartIntercomSetWill(settings.topicStatus, "{\"state\":\"offline\"}");
+  smartIntercomClient.smartIntercomSetHandler(smartIntercomHandleMessage, this);
+  smartIntercomClient.smartIntercomSetConnectHandler(smartIntercomHandleConnected, this);
+  smartIntercomSubscriber = device.smartIntercomSubscribe(
+    smartIntercomHandleEvent, this,
+    SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_RING) | SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_OPEN) |
+      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_CLOSE) | SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_STATE) |
+      SMARTINTERCOM_EVENT_MASK(SMARTINTERCOM_EVENT_CONFIG));
+  smartIntercomStatusDirty = true;
+}
+
+/*
+ * SmartIntercomMqtt Handle Event
+ * Звонки, открытия и закрытия SmartIntercom - в топик событий,
+ * остальное только помечает статус измененным
+ */
+void SmartIntercomMqtt::smartIntercomHandleEvent(const SmartIntercomEvent& event, void* context) {
+  SmartIntercomMqtt* mqtt = static_cast<SmartIntercomMqtt*>(context);
+  char payload[SMARTINTERCOM_MQTT_PAYLOAD_MAX];
+  int length = 0;
+
+  switch (event.type) {
+    case SMARTINTERCOM_EVENT_RING:
+      mqtt->smartIntercomRingCount = event.value;
+      length = snprintf_P(payload, sizeof(payload), PSTR("{\"event\":\"ring\",\"count\":%ld,\"id\":%lu}"),
+                          (long)event.value, (unsigned long)++mqtt->smartIntercomEventId);
+      break;
+    case SMARTINTERCOM_EVENT_OPEN:
+      length = snprintf_P(payload, sizeof(payload), PSTR("{\"event\":\"open\",\"source\":\"%s\",\"id\":%lu}"),
+                          event.value == SMARTINTERCOM_OPEN_AUTO ? "auto" : "manual",
+                          (unsigned long)++mqtt->smartIntercomEventId);
+      break;
+    case SMARTINTERCOM_EVENT_CLOSE:
+      length = snprintf_P(payload, sizeof(payload), PSTR("{\"event\":\"close\",\"id\":%lu}"),
+                          (unsigned long)++mqtt->smartIntercomEventId);
+      break;
+    default:
+      break;
+  }
+  if (length > 0) {
+    mqtt->smartIntercomPublishEvent(payload, length);
+  }
+  mqtt->smartIntercomStatusDirty = true;
+}
+
+void SmartIntercomMqtt::smartIntercomPublishEvent(const char* payload, int length) {
+  if ((size_t)length >= SMARTINTERCOM_MQTT_PAYLOAD_MAX) {
+    return;
+  }
+  smartIntercomClient.smartIntercomPublish(smartIntercomSettings.topicEvents, payload, (size_t)length,
+                                           smartIntercomSettings.qos, false);
+}
+
+/*
+ * SmartIntercomMqtt Publish Status
+ * Статус SmartIntercom с retain; в outbox остается только последний
+ */
+void SmartIntercomMqtt::smartIntercomPublishStatus() {
+  SmartIntercomConfig config = smartIntercomDevice->smartIntercomGetConfig();
+  uint8_t state = smartIntercomDevice->smartIntercomGetState();
+  char payload[SMARTINTERCOM_MQTT_PAYLOAD_MAX];
+  int length = snprintf_P(payload, sizeof(payload),
+                          PSTR("{\"state\":\"%s\",\"auto_open\":%s,\"always_open\":%s,\"rings\":%ld}"),
+                          state < SMARTINTERCOM_STATES ? smartIntercomMqttStateKeys[state] : "unknown",
+                          config.autoOpenEnabled ? "true" : "false", config.alwaysOpenEnabled ? "true" : "false",
+                          (long)smartIntercomRingCount);
+  if (length > 0 && (size_t)length < sizeof(payload)) {
+    smartIntercomClient.smartIntercomPublish(smartIntercomSettings.topicStatus, payload, (size_t)length,
+                                             smartIntercomSettings.qos, smartIntercomSettings.retain, true);
+  }
+}
+
+/*
+ * SmartIntercomMqtt Handle Connected
+ * Статус SmartIntercom заново после каждого подключения: брокер мог
+ * заменить его сообщением Last Will или потерять при перезапуске
+ * (еще не отправленный статус просто обновляется)
+ */
+void SmartIntercomMqtt::smartIntercomHandleConnected(void* context) {
+  SmartIntercomMqtt* mqtt = static_cast<SmartIntercomMqtt*>(context);
+  mqtt->smartIntercomStatusDirty = false;
+  mqtt->smartIntercomPublishStatus();
+}
+
+/*
+ * SmartIntercomMqtt Handle Message
+ */
+void SmartIntercomMqtt::smartIntercomHandleMessage(const char* topic, size_t topicLength, const uint8_t* payload,
+                                                   size_t length, void* context) {
+  SmartIntercomMqtt* mqtt = static_cast<SmartIntercomMqtt*>(context);
+  const char* commands = mqtt->smartIntercomSettings.topicCommands;
+  if (commands == nullptr || strlen(commands) != topicLength || memcmp(commands, topic, topicLength) != 0) {
+    return;
+  }
+  mqtt->smartIntercomExecute((const char*)payload, length);
+}
+
+/*
+ * SmartIntercomMqtt Execute
+ * Команда SmartIntercom из топика команд: open, close, auto-open [on|off],
+ * always-open on|off, status
+ */
+void SmartIntercomMqtt::smartIntercomExecute(const char* command, size_t length) {
+  char text[SMARTINTERCOM_MQTT_COMMAND_MAX];
+  while (length > 0 && isspace((unsigned char)command[length - 1])) {
+    length--;
+  }
+  while (length > 0 && isspace((unsigned char)command[0])) {
+    command++;
+    length--;
+  }
+  if (length == 0 || length >= sizeof(text)) {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: MQTT command of %d bytes ignored", (int)length);
+    return;
+  }
+  memcpy(text, command, length);
+  text[length] = '\0';
+
+  char* argument = strchr(text, ' ');
+  if (argument) {
+    *argument++ = '\0';
+    while (*argument == ' ') {
+      argument++;
+    }
+  }
+  bool hasArgument = argument != nullptr && *argument != '\0';
+  bool on = hasArgument && (strcmp(argument, "on") == 0 || strcmp(argument, "1") == 0 ||
+                            strcmp(argument, "true") == 0);
+  bool off = hasArgument && (strcmp(argument, "off") == 0 || strcmp(argument, "0") == 0 ||
+                             strcmp(argument, "false") == 0);
+
+  if (strcmp(text, "open") == 0) {
+    smartIntercomDevice->smartIntercomOpenDoor();
+  } else if (strcmp(text, "close") == 0) {
+    smartIntercomDevice->smartIntercomCloseDoor();
+  } else if (strcmp(text, "auto-open") == 0 && (on || off || !hasArgument)) {
+    if (on) {
+      smartIntercomDevice->smartIntercomEnableAutoOpen();
+    } else if (off) {
+      smartIntercomDevice->smartIntercomDisableAutoOpen();
+    } else {
+      smartIntercomDevice->smartIntercomToggleAutoOpen();
+    }
+  } else if (strcmp(text, "always-open") == 0 && (on || off)) {
+    if (on) {
+      smartIntercomDevice->smartIntercomEnableAlwaysOpen();
+    } else {
+      smartIntercomDevice->smartIntercomDisableAlwaysOpen();
+    }
+  } else if (strcmp(text, "status") == 0) {
+    smartIntercomStatusDirty = true;
+  } else {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Unknown MQTT command");
+    return;
+  }
+  smartIntercomCommands++;
+}
+
+/*
+ * SmartIntercomMqtt Update
+ * Шаг MQTT-интеграции SmartIntercom (после smartIntercomUpdate() устройства)
+ */
+void SmartIntercomMqtt::smartIntercomUpdate() {
+  if (smartIntercomDevice == nullptr) {
+    return;
+  }
+  if (smartIntercomStatusDirty) {
+    smartIntercomStatusDirty = false;
+    smartIntercomPublishStatus();
+  }
+  smartIntercomClient.smartIntercomUpdate();
+}
+
+unsigned long SmartIntercomMqtt::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (smartIntercomStatusDirty) {
+    return 0;
+  }
+  return smartIntercomClient.smartIntercomGetIdleTime(maxMs);
+}
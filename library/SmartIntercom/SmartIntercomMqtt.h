@@ -0,0 +1,367 @@
+/*
+ * SmartIntercomMqtt.h - Встроенный MQTT-клиент SmartIntercom
+ *
+ * Клиент MQTT 3.1.1 без выделения памяти: CONNECT с сохраняемой
+ * сессией (clean session = 0), PUBLISH с QoS 0/1, SUBSCRIBE на топик
+ * команд, PINGREQ по keep-alive. Исходящие сообщения лежат в исходящем
+ * буфере (outbox) фиксированного размера и уходят пачками: за один
+ * проход цикла в буфер передачи складывается столько PUBLISH, сколько
+ * позволяет окно неподтвержденных сообщений, и все они отправляются
+ * одной записью в сокет.
+ *
+ * Сообщение QoS 1 остается в outbox до PUBACK. При разрыве связи
+ * неподтвержденные сообщения возвращаются в очередь и после
+ * переподключения отправляются повторно с флагом DUP и тем же номером
+ * пакета, поэтому буфер переживает переподключения (но не перезагрузку:
+ * запись во флеш на каждое событие изнашивала бы сектор, а статус все
+ * равно публикуется заново после старта). Сообщения с признаком
+ * coalesce (статус с retain) не копятся: новое значение заменяет
+ * старое, даже отправленное и ждущее PUBACK, а то же значение не
+ * ставится повторно. При переполнении вытесняется самое старое
+ * неотправленное событие.
+ *
+ * Сеть скрыта за SmartIntercomMqttTransport: WiFiClient на ESP8266
+ * (SmartIntercomMqttWiFi.h) и неблокирующие сокеты POSIX на хосте
+ * (host/net/SmartIntercomMqttPosix.h).
+ *
+ * SmartIntercomMqtt связывает клиент с SmartIntercom: звонки,
+ * открытия и закрытия идут в топик событий, состояние - в топик
+ * статуса с retain, команды из топика команд выполняются в главном
+ * цикле. Подробности - docs/MQTT.md.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_MQTT_H
+#define SMARTINTERCOM_MQTT_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomEventQueue.h"
+
+class SmartIntercom;
+
+// SmartIntercom MQTT Client Configuration
+#ifndef SMARTINTERCOM_MQTT_OUTBOX_SIZE
+#define SMARTINTERCOM_MQTT_OUTBOX_SIZE 8          // Сообщений в исходящем буфере
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_INFLIGHT_MAX
+#define SMARTINTERCOM_MQTT_INFLIGHT_MAX 4         // Окно QoS 1 без PUBACK
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_PAYLOAD_MAX
+#define SMARTINTERCOM_MQTT_PAYLOAD_MAX 160
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_TOPIC_MAX
+#define SMARTINTERCOM_MQTT_TOPIC_MAX 64           // Топик сообщения в outbox вместе с '\0'
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_TX_BUFFER_SIZE
+#define SMARTINTERCOM_MQTT_TX_BUFFER_SIZE 512
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_RX_BUFFER_SIZE
+#define SMARTINTERCOM_MQTT_RX_BUFFER_SIZE 256     // Наибольший входящий пакет
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_KEEPALIVE_S
+#define SMARTINTERCOM_MQTT_KEEPALIVE_S 30
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_RECONNECT_MS
+#define SMARTINTERCOM_MQTT_RECONNECT_MS 1000      // Первая пауза перед переподключением
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_RECONNECT_MAX_MS
+#define SMARTINTERCOM_MQTT_RECONNECT_MAX_MS 60000 // Пауза удваивается до этого предела
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_CONNACK_TIMEOUT_MS
+#define SMARTINTERCOM_MQTT_CONNACK_TIMEOUT_MS 10000
+#endif
+
+#ifndef SMARTINTERCOM_MQTT_POLL_MS
+#define SMARTINTERCOM_MQTT_POLL_MS 50             // Сон цикла при открытом соединении (прием команд)
+#endif
+
+#define SMARTINTERCOM_MQTT_NO_PACKET_ID 0
+
+// SmartIntercom MQTT Link State (транспорт)
+enum SmartIntercomMqttLink {
+  SMARTINTERCOM_MQTT_LINK_DOWN,
+  SMARTINTERCOM_MQTT_LINK_CONNECTING,
+  SMARTINTERCOM_MQTT_LINK_UP
+};
+
+// SmartIntercom MQTT Session State (клиент)
+enum SmartIntercomMqttState {
+  SMARTINTERCOM_MQTT_DISCONNECTED,  // Пауза перед следующей попыткой
+  SMARTINTERCOM_MQTT_CONNECTING,    // TCP-соединение устанавливается
+  SMARTINTERCOM_MQTT_AWAIT_CONNACK, // CONNECT отправлен
+  SMARTINTERCOM_MQTT_CONNECTED
+};
+
+// SmartIntercom MQTT Outbox Slot State
+enum SmartIntercomMqttSlotState {
+  SMARTINTERCOM_MQTT_SLOT_FREE,
+  SMARTINTERCOM_MQTT_SLOT_QUEUED,   // Ждет отправки (или повторной отправки с DUP)
+  SMARTINTERCOM_MQTT_SLOT_INFLIGHT  // Отправлен, ждет PUBACK
+};
+
+/*
+ * SmartIntercomMqttSettings - Параметры подключения SmartIntercom к брокеру
+ *
+ * Строки не копируются и должны жить все время работы клиента
+ * (обычно это литералы SMARTINTERCOM_MQTT_* из конфигурации).
+ * Пустые user/password не передаются брокеру.
+ */
+struct SmartIntercomMqttSettings {
+  const char* server;
+  uint16_t port;
+  const char* user;
+  const char* password;
+  const char* clientId;
+  const char* topicStatus;
+  const char* topicEvents;
+  const char* topicCommands;
+  uint8_t qos;
+  bool retain;
+  uint16_t keepAliveS;
+};
+
+/*
+ * SmartIntercomMqttTransport - Неблокирующий TCP-транспорт MQTT SmartIntercom
+ *
+ * smartIntercomConnect() начинает соединение и может вернуться до
+ * его установки (состояние CONNECTING). Чтение и запись никогда не
+ * ждут: возвращается то, что уже пришло, и принимается столько, сколько
+ * помещается в буфер сокета. Ошибка или закрытие сокета переводит
+ * транспорт в LINK_DOWN.
+ */
+class SmartIntercomMqttTransport {
+public:
+  virtual ~SmartIntercomMqttTransport() {}
+  virtual bool smartIntercomConnect(const char* host, uint16_t port) = 0;
+  virtual SmartIntercomMqttLink smartIntercomGetLink() = 0;
+  virtual size_t smartIntercomRead(uint8_t* buffer, size_t size) = 0;
+  virtual size_t smartIntercomWrite(const uint8_t* data, size_t length) = 0;
+  virtual void smartIntercomClose() = 0;
+};
+
+/*
+ * SmartIntercomMqttMessage - Сообщение в исходящем буфере SmartIntercom
+ *
+ * Топик копируется вместе с данными: буфер вызывающего может
+ * освободиться до отправки или повтора с DUP.
+ */
+struct SmartIntercomMqttMessage {
+  uint8_t state;
+  uint8_t qos;
+  bool retain;
+  bool coalesce;
+  bool duplicate;
+  uint16_t packetId;
+  uint16_t length;
+  uint32_t sequence;
+  char topic[SMARTINTERCOM_MQTT_TOPIC_MAX];
+  char payload[SMARTINTERCOM_MQTT_PAYLOAD_MAX];
+};
+
+/*
+ * SmartIntercomMqttOutbox - Исходящий буфер SmartIntercom фиксированного размера
+ *
+ * Порядок отправки - порядок постановки (sequence); повторные
+ * отправки старше новых сообщений и уходят первыми.
+ */
+class SmartIntercomMqttOutbox {
+private:
+  SmartIntercomMqttMessage smartIntercomSlots[SMARTINTERCOM_MQTT_OUTBOX_SIZE];
+  uint32_t smartIntercomSequence;
+  uint16_t smartIntercomNextPacketId;
+  uint32_t smartIntercomCoalesced;
+  uint32_t smartIntercomDropped;
+
+  // SmartIntercom Internal Methods
+  SmartIntercomMqttMessage* smartIntercomFindFree();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomMqttOutbox();
+
+  // SmartIntercom Producers
+  bool smartIntercomAdd(const char* topic, const char* payload, size_t length, uint8_t qos, bool retain,
+                        bool coalesce);
+
+  // SmartIntercom Session
+  SmartIntercomMqttMessage* smartIntercomNextQueued();
+  void smartIntercomMarkSent(SmartIntercomMqttMessage* message);
+  bool smartIntercomAcknowledge(uint16_t packetId);
+  uint8_t smartIntercomRequeueInflight();
+
+  // SmartIntercom Outbox Statistics
+  uint8_t smartIntercomGetCount(uint8_t state);
+  uint32_t smartIntercomGetCoalesced() { return smartIntercomCoalesced; }
+  uint32_t smartIntercomGetDropped() { return smartIntercomDropped; }
+};
+
+/*
+ * SmartIntercomMqttHandler - Входящее сообщение SmartIntercom
+ *
+ * Вызывается из главного цикла; payload не завершается нулем.
+ */
+typedef void (*SmartIntercomMqttHandler)(const char* topic, size_t topicLength, const uint8_t* payload,
+                                         size_t length, void* context);
+
+/*
+ * SmartIntercomMqttConnectHandler - Сессия SmartIntercom установлена
+ *
+ * Вызывается после CONNACK до отправки очереди, поэтому опубликованное
+ * здесь сообщение уходит в той же пачке, что и повторы.
+ */
+typedef void (*SmartIntercomMqttConnectHandler)(void* context);
+
+/*
+ * SmartIntercomMqttClient - Неблокирующий MQTT-клиент SmartIntercom
+ */
+class SmartIntercomMqttClient {
+private:
+  SmartIntercomMqttTransport* smartIntercomTransport;
+  SmartIntercomMqttSettings smartIntercomSettings;
+  SmartIntercomMqttHandler smartIntercomHandler;
+  void* smartIntercomHandlerContext;
+  SmartIntercomMqttConnectHandler smartIntercomConnectHandler;
+  void* smartIntercomConnectContext;
+  const char* smartIntercomWillTopic;
+  const char* smartIntercomWillPayload;
+  SmartIntercomMqttOutbox smartIntercomOutbox;
+
+  uint8_t smartIntercomState;
+  unsigned long smartIntercomStateSince;
+  unsigned long smartIntercomRetryAt;
+  unsigned long smartIntercomBackoffMs;
+  unsigned long smartIntercomLastTx;
+  unsigned long smartIntercomLastRx;
+  unsigned long smartIntercomPingSentAt;
+  bool smartIntercomPingPending;
+
+  uint8_t smartIntercomTx[SMARTINTERCOM_MQTT_TX_BUFFER_SIZE];
+  size_t smartIntercomTxLength;
+  uint8_t smartIntercomRx[SMARTINTERCOM_MQTT_RX_BUFFER_SIZE];
+  size_t smartIntercomRxLength;
+
+  // SmartIntercom Client Statistics
+  uint32_t smartIntercomConnects;
+  uint32_t smartIntercomPublished;
+  uint32_t smartIntercomAcked;
+  uint32_t smartIntercomRetransmitted;
+  uint32_t smartIntercomReceived;
+
+  // SmartIntercom Packet Encoding (false - пакет не помещается в буфер передачи)
+  bool smartIntercomBeginPacket(uint8_t header, size_t remaining);
+  void smartIntercomPutByte(uint8_t value);
+  void smartIntercomPutWord(uint16_t value);
+  void smartIntercomPutString(const char* text, size_t length);
+  bool smartIntercomSendConnect();
+  bool smartIntercomSendSubscribe();
+  bool smartIntercomSendPublish(SmartIntercomMqttMessage* message);
+  bool smartIntercomSendShort(uint8_t header, uint16_t packetId, bool withId);
+
+  // SmartIntercom Session Internals
+  void smartIntercomStartConnect(unsigned long now);
+  void smartIntercomDropLink(unsigned long now);
+  void smartIntercomReceive(unsigned long now);
+  bool smartIntercomHandlePacket(const uint8_t* packet, size_t length, size_t offset);
+  void smartIntercomFillPublishes();
+  void smartIntercomFlush(unsigned long now);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomMqttClient();
+
+  // SmartIntercom Initialization
+  void smartIntercomBegin(SmartIntercomMqttTransport* transport, const SmartIntercomMqttSettings& settings);
+  void smartIntercomSetWill(const char* topic, const char* payload) {
+    smartIntercomWillTopic = topic;
+    smartIntercomWillPayload = payload;
+  }
+  void smartIntercomSetHandler(SmartIntercomMqttHandler handler, void* context = nullptr) {
+    smartIntercomHandler = handler;
+    smartIntercomHandlerContext = context;
+  }
+  void smartIntercomSetConnectHandler(SmartIntercomMqttConnectHandler handler, void* context = nullptr) {
+    smartIntercomConnectHandler = handler;
+    smartIntercomConnectContext = context;
+  }
+
+  // SmartIntercom Publishing (топик и данные копируются в outbox; отправка из smartIntercomUpdate)
+  bool smartIntercomPublish(const char* topic, const char* payload, size_t length, uint8_t qos, bool retain,
+                            bool coalesce = false);
+
+  // SmartIntercom Main Loop
+  void smartIntercomUpdate();
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs);
+  void smartIntercomDisconnect();
+
+  // SmartIntercom Client Status
+  bool smartIntercomIsConnected() { return smartIntercomState == SMARTINTERCOM_MQTT_CONNECTED; }
+  uint8_t smartIntercomGetState() { return smartIntercomState; }
+  SmartIntercomMqttOutbox& smartIntercomGetOutbox() { return smartIntercomOutbox; }
+  uint32_t smartIntercomGetConnects() { return smartIntercomConnects; }
+  uint32_t smartIntercomGetPublished() { return smartIntercomPublished; }
+  uint32_t smartIntercomGetAcked() { return smartIntercomAcked; }
+  uint32_t smartIntercomGetRetransmitted() { return smartIntercomRetransmitted; }
+  uint32_t smartIntercomGetReceived() { return smartIntercomReceived; }
+};
+
+/*
+ * SmartIntercomMqtt - MQTT-интеграция SmartIntercom
+ *
+ * Топик событий: {"event":"ring","count":N,"id":K}, {"event":"open",
+ * "source":"manual|auto","id":K}, {"event":"close","id":K}; id растет
+ * с каждым событием и позволяет отбросить повтор QoS 1.
+ * Топик статуса (retain): {"state":"idle","auto_open":false,...};
+ * при потере связи брокер публикует {"state":"offline"} (Last Will).
+ * Команды (текст): open, close, auto-open on|off, always-open on|off,
+ * status.
+ */
+class SmartIntercomMqtt {
+private:
+  SmartIntercom* smartIntercomDevice;
+  SmartIntercomMqttClient smartIntercomClient;
+  SmartIntercomMqttSettings smartIntercomSettings;
+  uint8_t smartIntercomSubscriber;
+  bool smartIntercomStatusDirty;
+  uint32_t smartIntercomEventId;
+  int32_t smartIntercomRingCount;
+  uint32_t smartIntercomCommands;
+
+  // SmartIntercom Internal Methods
+  static void smartIntercomHandleEvent(const SmartIntercomEvent& event, void* context);
+  static void smartIntercomHandleMessage(const char* topic, size_t topicLength, const uint8_t* payload,
+                                         size_t length, void* context);
+  static void smartIntercomHandleConnected(void* context);
+  void smartIntercomExecute(const char* command, size_t length);
+  void smartIntercomPublishEvent(const char* payload, int length);
+  void smartIntercomPublishStatus();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomMqtt();
+
+  // SmartIntercom Initialization
+  void smartIntercomBegin(SmartIntercom& device, SmartIntercomMqttTransport* transport,
+                          const SmartIntercomMqttSettings& settings);
+
+  // SmartIntercom Main Loop (после smartIntercomUpdate() устройства)
+  void smartIntercomUpdate();
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs);
+
+  // SmartIntercom Integration Status
+  SmartIntercomMqttClient& smartIntercomGetClient() { return smartIntercomClient; }
+  uint32_t smartIntercomGetCommands() { return smartIntercomCommands; }
+};
+
+#endif // SMARTINTERCOM_MQTT_H
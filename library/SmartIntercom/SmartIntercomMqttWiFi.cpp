@@ -0,0 +1,60 @@
+/*
+ * SmartIntercomMqttWiFi.cpp - Реализация транспорта MQTT SmartIntercom для ESP8266
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomMqttWiFi.h"
+
+#ifdef ESP8266
+
+/*
+ * SmartIntercomMqttTransportWiFi Connect
+ * Без WiFi SmartIntercom не пытается соединиться (клиент повторит позже)
+ */
+bool SmartIntercomMqttTransportWiFi::smartIntercomConnect(const char* host, uint16_t port) {
+  if (WiFi.status() != WL_CONNECTED) {
+    return false;
+  }
+  smartIntercomSocket.setTimeout(SMARTINTERCOM_MQTT_CONNECT_TIMEOUT_MS);
+  if (!smartIntercomSocket.connect(host, port)) {
+    return false;
+  }
+  smartIntercomSocket.setNoDelay(true);
+  return true;
+}
+
+SmartIntercomMqttLink SmartIntercomMqttTransportWiFi::smartIntercomGetLink() {
+  return smartIntercomSocket.connected() ? SMARTINTERCOM_MQTT_LINK_UP : SMARTINTERCOM_MQTT_LINK_DOWN;
+}
+
+/*
+ * SmartIntercomMqttTransportWiFi Read
+ */
+size_t SmartIntercomMqttTransportWiFi::smartIntercomRead(uint8_t* buffer, size_t size) {
+  int available = smartIntercomSocket.available();
+  if (available <= 0) {
+    return 0;
+  }
+  int received = smartIntercomSocket.read(buffer, (size_t)available < size ? (size_t)available : size);
+  return received > 0 ? (size_t)received : 0;
+}
+
+/*
+ * SmartIntercomMqttTransportWiFi Write
+ * Не больше, чем помещается в буфер TCP SmartIntercom
+ */
+size_t SmartIntercomMqttTransportWiFi::smartIntercomWrite(const uint8_t* data, size_t length) {
+  size_t space = smartIntercomSocket.availableForWrite();
+  if (space == 0) {
+    return 0;
+  }
+  return smartIntercomSocket.write(data, length < space ? length : space);
+}
+
+void SmartIntercomMqttTransportWiFi::smartIntercomClose() {
+  smartIntercomSocket.stop();
+}
+
+#endif // ESP8266
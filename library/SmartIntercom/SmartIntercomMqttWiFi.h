@@ -0,0 +1,46 @@
+/*
+ * SmartIntercomMqttWiFi.h - Транспорт MQTT-клиента SmartIntercom для ESP8266
+ *
+ * Сокет - WiFiClient ядра ESP8266. Чтение отдает только уже пришедшие
+ * байты, запись не превышает availableForWrite(), поэтому обмен с
+ * брокером не задерживает главный цикл. Исключение - установка
+ * соединения: WiFiClient::connect() разрешает имя и ждет TCP-рукопожатие,
+ * поэтому ожидание ограничено SMARTINTERCOM_MQTT_CONNECT_TIMEOUT_MS,
+ * а попытки разнесены паузой переподключения клиента.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_MQTT_WIFI_H
+#define SMARTINTERCOM_MQTT_WIFI_H
+
+#ifdef ESP8266
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "SmartIntercomMqtt.h"
+
+#ifndef SMARTINTERCOM_MQTT_CONNECT_TIMEOUT_MS
+#define SMARTINTERCOM_MQTT_CONNECT_TIMEOUT_MS 1000
+#endif
+
+/*
+ * SmartIntercomMqttTransportWiFi - Транспорт SmartIntercom на WiFiClient
+ */
+class SmartIntercomMqttTransportWiFi : public SmartIntercomMqttTransport {
+private:
+  WiFiClient smartIntercomSocket;
+
+public:
+  // SmartIntercom Transport Implementation
+  bool smartIntercomConnect(const char* host, uint16_t port) override;
+  SmartIntercomMqttLink smartIntercomGetLink() override;
+  size_t smartIntercomRead(uint8_t* buffer, size_t size) override;
+  size_t smartIntercomWrite(const uint8_t* data, size_t length) override;
+  void smartIntercomClose() override;
+};
+
+#endif // ESP8266
+
+#endif // SMARTINTERCOM_MQTT_WIFI_H
@@ -0,0 +1,193 @@
+/*
+ * SmartIntercomRingClassifier.cpp - Реализация классификатора звонка SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomRingClassifier.h"
+#include "SmartIntercomLog.h"
+#include <math.h>
+
+/*
+ * SmartIntercomRingClassifier Constructor
+ */
+SmartIntercomRingClassifier::SmartIntercomRingClassifier() {
+  smartIntercomToneHz = 0;
+  smartIntercomCoeff = 0;
+  smartIntercomSetLevels(SMARTINTERCOM_RING_ENVELOPE_ON,
+                         SMARTINTERCOM_RING_ENVELOPE_ON * SMARTINTERCOM_RING_HYSTERESIS_PERCENT / 100);
+  smartIntercomReset();
+}
+
+/*
+ * SmartIntercomRingClassifier Set Levels
+ * Пороги огибающей SmartIntercom в отсчетах АЦП (выключение ниже включения)
+ */
+void SmartIntercomRingClassifier::smartIntercomSetLevels(int onLevel, int offLevel) {
+  if (offLevel > onLevel) {
+    offLevel = onLevel;
+  }
+  smartIntercomOnLevel = (int32_t)onLevel << SMARTINTERCOM_RING_ENVELOPE_Q;
+  smartIntercomOffLevel = (int32_t)offLevel << SMARTINTERCOM_RING_ENVELOPE_Q;
+}
+
+/*
+ * SmartIntercomRingClassifier Set Tone
+ * Настройка фильтра Гёрцеля SmartIntercom на ближайший к toneHz бин
+ *
+ * toneHz = 0 или samplePeriodUs = 0 (опрос из loop()) отключают
+ * проверку тона. Коэффициент вычисляется один раз здесь, обработка
+ * отсчетов остается целочисленной.
+ */
+void SmartIntercomRingClassifier::smartIntercomSetTone(unsigned long samplePeriodUs, unsigned int toneHz) {
+  smartIntercomToneHz = 0;
+  smartIntercomCoeff = 0;
+
+  if (toneHz > 0 && samplePeriodUs > 0) {
+    // SmartIntercom Bin index k = N * f / fs, fs = 1e6 / periodUs
+    uint32_t k = (uint32_t)(((uint64_t)SMARTINTERCOM_RING_GOERTZEL_BLOCK * toneHz * samplePeriodUs + 500000) /
+                            1000000);
+    if (k >= 1 && k < SMARTINTERCOM_RING_GOERTZEL_BLOCK / 2) {
+      double omega = 2.0 * M_PI * k / SMARTINTERCOM_RING_GOERTZEL_BLOCK;
+      smartIntercomCoeff = (int32_t)lround(2.0 * cos(omega) * (1L << SMARTINTERCOM_RING_COEFF_Q));
+      smartIntercomToneHz = toneHz;
+    } else {
+      SMARTINTERCOM_LOG_WARNING("SmartIntercom: Ring tone %u Hz outside sampling band, tone check disabled",
+                                toneHz);
+    }
+  }
+
+  smartIntercomS1 = 0;
+  smartIntercomS2 = 0;
+  smartIntercomBlockEnergy = 0;
+  smartIntercomBlockCount = 0;
+  smartIntercomToneOk = false;
+  smartIntercomTonePercent = 0;
+}
+
+/*
+ * SmartIntercomRingClassifier Reset
+ * Сброс состояния фильтров SmartIntercom (настройки сохраняются)
+ */
+void SmartIntercomRingClassifier::smartIntercomReset() {
+  smartIntercomPrimed = false;
+  smartIntercomBaseline = 0;
+  smartIntercomEnvelope = 0;
+  smartIntercomRinging = false;
+  smartIntercomPending = false;
+  smartIntercomPendingSince = 0;
+  smartIntercomEdgeTime = 0;
+  smartIntercomS1 = 0;
+  smartIntercomS2 = 0;
+  smartIntercomBlockEnergy = 0;
+  smartIntercomBlockCount = 0;
+  smartIntercomToneOk = false;
+  smartIntercomTonePercent = 0;
+}
+
+/*
+ * SmartIntercomRingClassifier Goertzel Step
+ * Один шаг фильтра Гёрцеля SmartIntercom; раз в блок - решение о тоне
+ *
+ * Для чистого тона на частоте бина мощность бина P равна N/2 от
+ * энергии блока E, для белого шума - около E. Тон считается найденным,
+ * если P/E не меньше SMARTINTERCOM_RING_TONE_PERCENT от идеала.
+ */
+void SmartIntercomRingClassifier::smartIntercomGoertzelStep(int32_t deviation) {
+  int32_t s0 = deviation +
+               (int32_t)(((int64_t)smartIntercomCoeff * smartIntercomS1) >> SMARTINTERCOM_RING_COEFF_Q) -
+               smartIntercomS2;
+  smartIntercomS2 = smartIntercomS1;
+  smartIntercomS1 = s0;
+  smartIntercomBlockEnergy += (uint32_t)(deviation * deviation);
+
+  if (++smartIntercomBlockCount < SMARTINTERCOM_RING_GOERTZEL_BLOCK) {
+    return;
+  }
+
+  int64_t s1 = smartIntercomS1;
+  int64_t s2 = smartIntercomS2;
+  int64_t power = s1 * s1 + s2 * s2 - ((smartIntercomCoeff * s1) >> SMARTINTERCOM_RING_COEFF_Q) * s2;
+  int64_t ideal = (int64_t)smartIntercomBlockEnergy * SMARTINTERCOM_RING_GOERTZEL_BLOCK;
+
+  if (power > 0 && ideal > 0) {
+    int64_t percent = power * 200 / ideal;
+    smartIntercomTonePercent = percent > 100 ? 100 : (uint16_t)percent;
+  } else {
+    smartIntercomTonePercent = 0;
+  }
+  smartIntercomToneOk = smartIntercomTonePercent >= SMARTINTERCOM_RING_TONE_PERCENT;
+
+  smartIntercomS1 = 0;
+  smartIntercomS2 = 0;
+  smartIntercomBlockEnergy = 0;
+  smartIntercomBlockCount = 0;
+}
+
+/*
+ * SmartIntercomRingClassifier Process
+ * Обработка одного отсчета АЦП SmartIntercom
+ *
+ * Возвращает START/END на фронтах звонка; момент фронта (начало
+ * выдержки, а не момент подтверждения) - smartIntercomGetEdgeTime().
+ */
+SmartIntercomRingEvent SmartIntercomRingClassifier::smartIntercomProcess(int sample, unsigned long timeMs) {
+  int32_t scaled = (int32_t)sample << SMARTINTERCOM_RING_BASELINE_Q;
+  if (!smartIntercomPrimed) {
+    smartIntercomBaseline = scaled;
+    smartIntercomPrimed = true;
+  }
+
+  // SmartIntercom Baseline: very slow low-pass, tracks bias drift only. During a ring it
+  // is nearly frozen so a level-type ring is not absorbed, but still heals if the
+  // classifier was primed in the middle of a ring.
+  int baselineShift = SMARTINTERCOM_RING_BASELINE_SHIFT;
+  if (smartIntercomRinging) {
+    baselineShift += SMARTINTERCOM_RING_BASELINE_HOLD_SHIFT;
+  }
+  smartIntercomBaseline += (scaled - smartIntercomBaseline) >> baselineShift;
+  int32_t deviation = (scaled - smartIntercomBaseline) >> SMARTINTERCOM_RING_BASELINE_Q;
+
+  // SmartIntercom Envelope: rectify, fast attack, slow release
+  int32_t rectified = (deviation < 0 ? -deviation : deviation) << SMARTINTERCOM_RING_ENVELOPE_Q;
+  if (rectified > smartIntercomEnvelope) {
+    smartIntercomEnvelope += (rectified - smartIntercomEnvelope) >> SMARTINTERCOM_RING_ATTACK_SHIFT;
+  } else {
+    smartIntercomEnvelope -= (smartIntercomEnvelope - rectified) >> SMARTINTERCOM_RING_RELEASE_SHIFT;
+  }
+
+  bool toneOk = true;
+  if (smartIntercomToneHz > 0) {
+    smartIntercomGoertzelStep(deviation);
+    toneOk = smartIntercomToneOk;
+  }
+
+  // SmartIntercom Hysteresis: the level must hold for the whole dwell time
+  bool crossing;
+  unsigned long dwell;
+  if (smartIntercomRinging) {
+    crossing = smartIntercomEnvelope < smartIntercomOffLevel || !toneOk;
+    dwell = SMARTINTERCOM_RING_RELEASE_MS;
+  } else {
+    crossing = smartIntercomEnvelope >= smartIntercomOnLevel && toneOk;
+    dwell = SMARTINTERCOM_RING_MIN_ON_MS;
+  }
+
+  if (!crossing) {
+    smartIntercomPending = false;
+    return SMARTINTERCOM_RING_EVENT_NONE;
+  }
+  if (!smartIntercomPending) {
+    smartIntercomPending = true;
+    smartIntercomPendingSince = timeMs;
+  }
+  if (timeMs - smartIntercomPendingSince < dwell) {
+    return SMARTINTERCOM_RING_EVENT_NONE;
+  }
+
+  smartIntercomPending = false;
+  smartIntercomRinging = !smartIntercomRinging;
+  smartIntercomEdgeTime = smartIntercomPendingSince;
+  return smartIntercomRinging ? SMARTINTERCOM_RING_EVENT_START : SMARTINTERCOM_RING_EVENT_END;
+}
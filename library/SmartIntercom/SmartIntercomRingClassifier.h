@@ -0,0 +1,114 @@
+/*
+ * SmartIntercomRingClassifier.h - Потоковый классификатор звонка SmartIntercom
+ *
+ * Классификатор получает отсчеты АЦП линии домофона по одному и
+ * сообщает о начале и конце звонка. Вся обработка отсчета выполняется
+ * в целых числах с фиксированной точкой и стоит постоянное число
+ * операций, поэтому подходит и для ESP8266 без FPU:
+ *
+ *   1. Медленная базовая линия (ФНЧ) убирает постоянную составляющую.
+ *   2. Выпрямленное отклонение сглаживается детектором огибающей
+ *      с быстрой атакой и медленным спадом.
+ *   3. Гистерезис (порог включения/выключения) и выдержки по времени
+ *      убирают дребезг на переменном сигнале звонка.
+ *   4. Необязательный фильтр Гёрцеля на частоте тона звонка отсекает
+ *      широкополосные помехи линии.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_RING_CLASSIFIER_H
+#define SMARTINTERCOM_RING_CLASSIFIER_H
+
+#include <Arduino.h>
+
+// SmartIntercom Ring Envelope Levels (отклонение от базовой линии, отсчеты АЦП)
+#define SMARTINTERCOM_RING_ENVELOPE_ON 160
+#define SMARTINTERCOM_RING_HYSTERESIS_PERCENT 50
+
+// SmartIntercom Ring Timing (миллисекунды)
+#define SMARTINTERCOM_RING_MIN_ON_MS 20
+#define SMARTINTERCOM_RING_RELEASE_MS 150
+
+// SmartIntercom Ring Filter Constants (сдвиги: постоянная времени = 2^N отсчетов)
+#define SMARTINTERCOM_RING_BASELINE_SHIFT 13
+#define SMARTINTERCOM_RING_BASELINE_HOLD_SHIFT 4
+#define SMARTINTERCOM_RING_ATTACK_SHIFT 2
+#define SMARTINTERCOM_RING_RELEASE_SHIFT 6
+
+// SmartIntercom Ring Tone Detection (0 Гц - только огибающая)
+#define SMARTINTERCOM_RING_TONE_HZ 0
+#define SMARTINTERCOM_RING_GOERTZEL_BLOCK 64
+#define SMARTINTERCOM_RING_TONE_PERCENT 25
+
+// SmartIntercom Fixed-Point Formats
+#define SMARTINTERCOM_RING_BASELINE_Q 16
+#define SMARTINTERCOM_RING_ENVELOPE_Q 8
+#define SMARTINTERCOM_RING_COEFF_Q 14
+
+// SmartIntercom Ring Classifier Events
+enum SmartIntercomRingEvent {
+  SMARTINTERCOM_RING_EVENT_NONE,
+  SMARTINTERCOM_RING_EVENT_START,
+  SMARTINTERCOM_RING_EVENT_END
+};
+
+/*
+ * SmartIntercomRingClassifier - Классификатор звонка SmartIntercom
+ *
+ * Время отсчетов передается явно: при выборке по таймеру это
+ * восстановленный момент захвата, при опросе из loop() - millis().
+ * Фильтр Гёрцеля работает только при известной частоте выборки.
+ */
+class SmartIntercomRingClassifier {
+private:
+  // SmartIntercom Levels
+  int32_t smartIntercomOnLevel;
+  int32_t smartIntercomOffLevel;
+
+  // SmartIntercom Filter State
+  bool smartIntercomPrimed;
+  int32_t smartIntercomBaseline;
+  int32_t smartIntercomEnvelope;
+
+  // SmartIntercom Hysteresis State
+  bool smartIntercomRinging;
+  bool smartIntercomPending;
+  unsigned long smartIntercomPendingSince;
+  unsigned long smartIntercomEdgeTime;
+
+  // SmartIntercom Goertzel State
+  unsigned int smartIntercomToneHz;
+  int32_t smartIntercomCoeff;
+  int32_t smartIntercomS1;
+  int32_t smartIntercomS2;
+  uint32_t smartIntercomBlockEnergy;
+  uint16_t smartIntercomBlockCount;
+  bool smartIntercomToneOk;
+  uint16_t smartIntercomTonePercent;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomGoertzelStep(int32_t deviation);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomRingClassifier();
+
+  // SmartIntercom Configuration
+  void smartIntercomSetLevels(int onLevel, int offLevel);
+  void smartIntercomSetTone(unsigned long samplePeriodUs, unsigned int toneHz);
+
+  // SmartIntercom Processing
+  SmartIntercomRingEvent smartIntercomProcess(int sample, unsigned long timeMs);
+  void smartIntercomReset();
+
+  // SmartIntercom State
+  bool smartIntercomIsRinging() { return smartIntercomRinging; }
+  unsigned long smartIntercomGetEdgeTime() { return smartIntercomEdgeTime; }
+  int smartIntercomGetBaseline() { return smartIntercomBaseline >> SMARTINTERCOM_RING_BASELINE_Q; }
+  int smartIntercomGetEnvelope() { return smartIntercomEnvelope >> SMARTINTERCOM_RING_ENVELOPE_Q; }
+  int smartIntercomGetTonePercent() { return smartIntercomTonePercent; }
+};
+
+#endif // SMARTINTERCOM_RING_CLASSIFIER_H
@@ -0,0 +1,102 @@
+/*
+ * SmartIntercomSampleBuffer.h - Кольцевой буфер отсчетов АЦП SmartIntercom
+ *
+ * Буфер без блокировок для одного производителя (прерывание таймера)
+ * и одного потребителя (главный цикл). Производитель меняет только
+ * индекс головы, потребитель - только индекс хвоста, поэтому
+ * запрещать прерывания не требуется.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_SAMPLE_BUFFER_H
+#define SMARTINTERCOM_SAMPLE_BUFFER_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Sample Buffer Configuration (степень двойки)
+#ifndef SMARTINTERCOM_SAMPLE_BUFFER_SIZE
+#define SMARTINTERCOM_SAMPLE_BUFFER_SIZE 256
+#endif
+
+#if (SMARTINTERCOM_SAMPLE_BUFFER_SIZE & (SMARTINTERCOM_SAMPLE_BUFFER_SIZE - 1)) != 0
+#error "SMARTINTERCOM_SAMPLE_BUFFER_SIZE must be a power of two"
+#endif
+
+#define SMARTINTERCOM_SAMPLE_BUFFER_MASK (SMARTINTERCOM_SAMPLE_BUFFER_SIZE - 1)
+
+/*
+ * SmartIntercomSampleBuffer - SPSC буфер отсчетов SmartIntercom
+ *
+ * Индексы растут непрерывно (uint16_t с переполнением), позиция
+ * в массиве берется по маске. Заполненность = head - tail.
+ */
+class SmartIntercomSampleBuffer {
+private:
+  uint16_t smartIntercomSamples[SMARTINTERCOM_SAMPLE_BUFFER_SIZE];
+  volatile uint16_t smartIntercomHead;
+  volatile uint16_t smartIntercomTail;
+  volatile uint32_t smartIntercomDropped;
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomSampleBuffer() {
+    smartIntercomHead = 0;
+    smartIntercomTail = 0;
+    smartIntercomDropped = 0;
+  }
+
+  /*
+   * SmartIntercomSampleBuffer Push
+   * Добавить отсчет SmartIntercom (только производитель, из прерывания)
+   *
+   * При переполнении отсчет отбрасывается и учитывается в счетчике.
+   */
+  inline bool smartIntercomPush(uint16_t sample) {
+    uint16_t head = smartIntercomHead;
+    if ((uint16_t)(head - smartIntercomTail) >= SMARTINTERCOM_SAMPLE_BUFFER_SIZE) {
+      smartIntercomDropped = smartIntercomDropped + 1;
+      return false;
+    }
+    smartIntercomSamples[head & SMARTINTERCOM_SAMPLE_BUFFER_MASK] = sample;
+    SMARTINTERCOM_COMPILER_BARRIER();
+    smartIntercomHead = head + 1;
+    return true;
+  }
+
+  /*
+   * SmartIntercomSampleBuffer Pop Batch
+   * Забрать до maxCount отсчетов SmartIntercom (только потребитель)
+   */
+  inline uint16_t smartIntercomPopBatch(uint16_t* out, uint16_t maxCount) {
+    uint16_t tail = smartIntercomTail;
+    uint16_t available = (uint16_t)(smartIntercomHead - tail);
+    SMARTINTERCOM_COMPILER_BARRIER();
+    if (available > maxCount) {
+      available = maxCount;
+    }
+    for (uint16_t i = 0; i < available; i++) {
+      out[i] = smartIntercomSamples[(uint16_t)(tail + i) & SMARTINTERCOM_SAMPLE_BUFFER_MASK];
+    }
+    SMARTINTERCOM_COMPILER_BARRIER();
+    smartIntercomTail = tail + available;
+    return available;
+  }
+
+  // SmartIntercom Buffer State
+  inline uint16_t smartIntercomAvailable() { return (uint16_t)(smartIntercomHead - smartIntercomTail); }
+  inline uint32_t smartIntercomGetDropped() { return smartIntercomDropped; }
+
+  /*
+   * SmartIntercomSampleBuffer Clear
+   * Сброс буфера SmartIntercom (только при остановленном производителе)
+   */
+  inline void smartIntercomClear() {
+    smartIntercomTail = smartIntercomHead;
+    smartIntercomDropped = 0;
+  }
+};
+
+#endif // SMARTINTERCOM_SAMPLE_BUFFER_H
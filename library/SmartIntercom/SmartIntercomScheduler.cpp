@@ -0,0 +1,267 @@
+/*
+ * SmartIntercomScheduler.cpp - Реализация планировщика SmartIntercom
+ *
+ * Min-heap дедлайнов фиксированного размера без динамической памяти.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomScheduler.h"
+#include "SmartIntercomLog.h"
+
+// SmartIntercom Global Scheduler Instance
+SmartIntercomScheduler smartIntercomScheduler;
+
+/*
+ * SmartIntercomScheduler Constructor
+ * Инициализация пустой очереди задач SmartIntercom
+ */
+SmartIntercomScheduler::SmartIntercomScheduler() {
+  smartIntercomJobCount = 0;
+  smartIntercomNextId = 1;
+  smartIntercomRunningId = SMARTINTERCOM_JOB_NONE;
+  smartIntercomRunningCancelled = false;
+}
+
+/*
+ * SmartIntercomScheduler Before
+ * Сравнение дедлайнов SmartIntercom с учетом переполнения millis()
+ */
+bool SmartIntercomScheduler::smartIntercomBefore(unsigned long a, unsigned long b) {
+  return (long)(a - b) < 0;
+}
+
+/*
+ * SmartIntercomScheduler Sift Up
+ * Восстановление кучи SmartIntercom вверх
+ */
+void SmartIntercomScheduler::smartIntercomSiftUp(uint8_t index) {
+  while (index > 0) {
+    uint8_t parent = (index - 1) / 2;
+    if (!smartIntercomBefore(smartIntercomJobs[index].deadline, smartIntercomJobs[parent].deadline)) {
+      break;
+    }
+    SmartIntercomJob tmp = smartIntercomJobs[index];
+    smartIntercomJobs[index] = smartIntercomJobs[parent];
+    smartIntercomJobs[parent] = tmp;
+    index = parent;
+  }
+}
+
+/*
+ * SmartIntercomScheduler Sift Down
+ * Восстановление кучи SmartIntercom вниз
+ */
+void SmartIntercomScheduler::smartIntercomSiftDown(uint8_t index) {
+  while (true) {
+    uint8_t left = index * 2 + 1;
+    uint8_t right = left + 1;
+    uint8_t smallest = index;
+
+    if (left < smartIntercomJobCount &&
+        smartIntercomBefore(smartIntercomJobs[left].deadline, smartIntercomJobs[smallest].deadline)) {
+      smallest = left;
+    }
+    if (right < smartIntercomJobCount &&
+        smartIntercomBefore(smartIntercomJobs[right].deadline, smartIntercomJobs[smallest].deadline)) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      break;
+    }
+
+    SmartIntercomJob tmp = smartIntercomJobs[index];
+    smartIntercomJobs[index] = smartIntercomJobs[smallest];
+    smartIntercomJobs[smallest] = tmp;
+    index = smallest;
+  }
+}
+
+/*
+ * SmartIntercomScheduler Remove At
+ * Удаление задачи SmartIntercom из произвольной позиции кучи
+ */
+void SmartIntercomScheduler::smartIntercomRemoveAt(uint8_t index) {
+  smartIntercomJobCount--;
+  if (index == smartIntercomJobCount) {
+    return;
+  }
+  smartIntercomJobs[index] = smartIntercomJobs[smartIntercomJobCount];
+  smartIntercomSiftDown(index);
+  smartIntercomSiftUp(index);
+}
+
+/*
+ * SmartIntercomScheduler Push
+ * Добавление задачи SmartIntercom в кучу
+ */
+void SmartIntercomScheduler::smartIntercomPush(const SmartIntercomJob& job) {
+  smartIntercomJobs[smartIntercomJobCount] = job;
+  smartIntercomJobCount++;
+  smartIntercomSiftUp(smartIntercomJobCount - 1);
+}
+
+/*
+ * SmartIntercomScheduler Allocate Id
+ * Выдача идентификатора задачи SmartIntercom (0 зарезервирован)
+ */
+uint16_t SmartIntercomScheduler::smartIntercomAllocateId() {
+  uint16_t id = smartIntercomNextId++;
+  if (smartIntercomNextId == SMARTINTERCOM_JOB_NONE) {
+    smartIntercomNextId = 1;
+  }
+  return id;
+}
+
+/*
+ * SmartIntercomScheduler Schedule
+ * Запланировать задачу SmartIntercom через delayMs миллисекунд
+ *
+ * Возвращает идентификатор задачи или SMARTINTERCOM_JOB_NONE,
+ * если очередь SmartIntercom заполнена. Пока выполняется задача,
+ * ее слот зарезервирован за ней: следующий шаг импульса или
+ * паттерна не может быть вытеснен задачами, созданными в обработчике.
+ */
+uint16_t SmartIntercomScheduler::smartIntercomSchedule(unsigned long delayMs,
+                                                       SmartIntercomJobHandler handler,
+                                                       void* context) {
+  uint8_t capacity = SMARTINTERCOM_SCHEDULER_CAPACITY;
+  if (smartIntercomRunningId != SMARTINTERCOM_JOB_NONE && !smartIntercomRunningCancelled) {
+    capacity--;
+  }
+  if (handler == nullptr || smartIntercomJobCount >= capacity) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Scheduler queue full");
+    return SMARTINTERCOM_JOB_NONE;
+  }
+
+  SmartIntercomJob job;
+  job.deadline = smartIntercomMillis() + delayMs;
+  job.handler = handler;
+  job.context = context;
+  job.step = 0;
+  job.id = smartIntercomAllocateId();
+  smartIntercomPush(job);
+  return job.id;
+}
+
+/*
+ * SmartIntercomScheduler Cancel
+ * Отменить задачу SmartIntercom по идентификатору
+ */
+bool SmartIntercomScheduler::smartIntercomCancel(uint16_t id) {
+  if (id == SMARTINTERCOM_JOB_NONE) {
+    return false;
+  }
+  if (id == smartIntercomRunningId) {
+    smartIntercomRunningCancelled = true;
+    return true;
+  }
+  for (uint8_t i = 0; i < smartIntercomJobCount; i++) {
+    if (smartIntercomJobs[i].id == id) {
+      smartIntercomRemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomScheduler Cancel Context
+ * Отменить все задачи SmartIntercom с заданным контекстом
+ */
+uint8_t SmartIntercomScheduler::smartIntercomCancelContext(void* context) {
+  uint8_t cancelled = 0;
+  uint8_t i = 0;
+  while (i < smartIntercomJobCount) {
+    if (smartIntercomJobs[i].context == context) {
+      smartIntercomRemoveAt(i);
+      cancelled++;
+    } else {
+      i++;
+    }
+  }
+  return cancelled;
+}
+
+/*
+ * SmartIntercomScheduler Is Pending
+ * Проверка, ожидает ли задача SmartIntercom выполнения
+ */
+bool SmartIntercomScheduler::smartIntercomIsPending(uint16_t id) {
+  if (id == SMARTINTERCOM_JOB_NONE) {
+    return false;
+  }
+  if (id == smartIntercomRunningId) {
+    return !smartIntercomRunningCancelled;
+  }
+  for (uint8_t i = 0; i < smartIntercomJobCount; i++) {
+    if (smartIntercomJobs[i].id == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomScheduler Run
+ * Выполнить все задачи SmartIntercom с наступившим дедлайном
+ *
+ * Число шагов за один вызов ограничено, поэтому задача, которая
+ * постоянно возвращает нулевую задержку, не может заблокировать цикл.
+ */
+void SmartIntercomScheduler::smartIntercomRun() {
+  unsigned long now = smartIntercomMillis();
+  uint8_t budget = SMARTINTERCOM_SCHEDULER_CAPACITY * 2;
+
+  while (smartIntercomJobCount > 0 && budget > 0 &&
+         !smartIntercomBefore(now, smartIntercomJobs[0].deadline)) {
+    SmartIntercomJob job = smartIntercomJobs[0];
+    smartIntercomRemoveAt(0);
+    budget--;
+
+    smartIntercomRunningId = job.id;
+    smartIntercomRunningCancelled = false;
+    long next = job.handler(job.context, job.step);
+    bool cancelled = smartIntercomRunningCancelled;
+    smartIntercomRunningId = SMARTINTERCOM_JOB_NONE;
+
+    if (next < 0 || cancelled) {
+      continue;
+    }
+
+    // SmartIntercom Drift-free rescheduling relative to the previous deadline
+    job.deadline += (unsigned long)next;
+    if (smartIntercomBefore(job.deadline, now)) {
+      job.deadline = now;
+    }
+    job.step++;
+    // SmartIntercom The running job's slot is reserved by smartIntercomSchedule, so this always fits
+    smartIntercomPush(job);
+  }
+}
+
+/*
+ * SmartIntercomScheduler Has Pending
+ */
+bool SmartIntercomScheduler::smartIntercomHasPending() {
+  return smartIntercomJobCount > 0;
+}
+
+/*
+ * SmartIntercomScheduler Get Pending Count
+ */
+uint8_t SmartIntercomScheduler::smartIntercomGetPendingCount() {
+  return smartIntercomJobCount;
+}
+
+/*
+ * SmartIntercomScheduler Get Next Deadline
+ * Ближайший дедлайн SmartIntercom (значение millis())
+ */
+unsigned long SmartIntercomScheduler::smartIntercomGetNextDeadline() {
+  if (smartIntercomJobCount == 0) {
+    return smartIntercomMillis();
+  }
+  return smartIntercomJobs[0].deadline;
+}
@@ -0,0 +1,89 @@
+/*
+ * SmartIntercomScheduler.h - Планировщик задач SmartIntercom
+ *
+ * Кооперативный планировщик SmartIntercom на основе min-heap
+ * дедлайнов. Все последовательности GPIO (импульсы, мигание,
+ * паттерны, плавное изменение яркости) выполняются как отменяемые
+ * неблокирующие задачи вместо delay().
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_SCHEDULER_H
+#define SMARTINTERCOM_SCHEDULER_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Scheduler Configuration
+#ifndef SMARTINTERCOM_SCHEDULER_CAPACITY
+#define SMARTINTERCOM_SCHEDULER_CAPACITY 16
+#endif
+
+#define SMARTINTERCOM_JOB_NONE 0
+#define SMARTINTERCOM_JOB_DONE -1
+
+/*
+ * SmartIntercomJobHandler - Обработчик задачи SmartIntercom
+ *
+ * Вызывается при наступлении дедлайна с номером шага (0, 1, 2, ...).
+ * Возвращает задержку до следующего шага в мс или
+ * SMARTINTERCOM_JOB_DONE для завершения задачи.
+ */
+typedef long (*SmartIntercomJobHandler)(void* context, int step);
+
+/*
+ * SmartIntercomScheduler - Планировщик задач SmartIntercom
+ *
+ * SmartIntercomScheduler хранит задачи в куче фиксированного размера,
+ * упорядоченной по дедлайну. Вызов smartIntercomRun() из главного цикла
+ * выполняет только задачи с наступившим дедлайном и сразу возвращается.
+ */
+class SmartIntercomScheduler {
+private:
+  struct SmartIntercomJob {
+    unsigned long deadline;
+    SmartIntercomJobHandler handler;
+    void* context;
+    int step;
+    uint16_t id;
+  };
+
+  SmartIntercomJob smartIntercomJobs[SMARTINTERCOM_SCHEDULER_CAPACITY];
+  uint8_t smartIntercomJobCount;
+  uint16_t smartIntercomNextId;
+  uint16_t smartIntercomRunningId;
+  bool smartIntercomRunningCancelled;
+
+  // SmartIntercom Internal Methods
+  static bool smartIntercomBefore(unsigned long a, unsigned long b);
+  void smartIntercomSiftUp(uint8_t index);
+  void smartIntercomSiftDown(uint8_t index);
+  void smartIntercomRemoveAt(uint8_t index);
+  void smartIntercomPush(const SmartIntercomJob& job);
+  uint16_t smartIntercomAllocateId();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomScheduler();
+
+  // SmartIntercom Job Control
+  uint16_t smartIntercomSchedule(unsigned long delayMs, SmartIntercomJobHandler handler, void* context);
+  bool smartIntercomCancel(uint16_t id);
+  uint8_t smartIntercomCancelContext(void* context);
+  bool smartIntercomIsPending(uint16_t id);
+
+  // SmartIntercom Main Loop
+  void smartIntercomRun();
+
+  // SmartIntercom Scheduler State
+  bool smartIntercomHasPending();
+  uint8_t smartIntercomGetPendingCount();
+  unsigned long smartIntercomGetNextDeadline();
+};
+
+// SmartIntercom Global Scheduler
+extern SmartIntercomScheduler smartIntercomScheduler;
+
+#endif // SMARTINTERCOM_SCHEDULER_H
@@ -0,0 +1,199 @@
+/*
+ * SmartIntercomStateMachine.h - Таблица переходов состояний SmartIntercom
+ *
+ * Состояние устройства меняется только по входам (звонок, открытие,
+ * закрытие, истечение срока, сброс) через таблицу переходов
+ * (состояние, вход) -> (действие, новое состояние, срок). Обработка
+ * входа - одно обращение к таблице, а вместо опроса таймеров в каждом
+ * состоянии хранится единственный срок следующего входа TIMEOUT.
+ *
+ * Таблица constexpr, поэтому ее свойства проверяются static_assert
+ * при компиляции (и на плате, и в хостовой сборке).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_STATE_MACHINE_H
+#define SMARTINTERCOM_STATE_MACHINE_H
+
+#include <Arduino.h>
+
+// SmartIntercom Device States
+enum SmartIntercomDeviceState {
+  SMARTINTERCOM_STATE_INIT,       // SmartIntercom инициализация
+  SMARTINTERCOM_STATE_READY,      // SmartIntercom готов
+  SMARTINTERCOM_STATE_IDLE,       // SmartIntercom ожидание
+  SMARTINTERCOM_STATE_RINGING,    // SmartIntercom звонок
+  SMARTINTERCOM_STATE_OPENING,    // SmartIntercom открытие
+  SMARTINTERCOM_STATE_OPEN,       // SmartIntercom открыто
+  SMARTINTERCOM_STATE_CLOSING,    // SmartIntercom закрытие
+  SMARTINTERCOM_STATE_ERROR,      // SmartIntercom ошибка
+  SMARTINTERCOM_STATES
+};
+
+// SmartIntercom State Machine Inputs
+enum SmartIntercomStateInput {
+  SMARTINTERCOM_INPUT_BEGIN,      // SmartIntercom инициализация завершена
+  SMARTINTERCOM_INPUT_RING,       // SmartIntercom обнаружен звонок
+  SMARTINTERCOM_INPUT_OPEN,       // SmartIntercom дверь открывается
+  SMARTINTERCOM_INPUT_CLOSE,      // SmartIntercom дверь закрыта командой
+  SMARTINTERCOM_INPUT_TIMEOUT,    // SmartIntercom истек срок состояния
+  SMARTINTERCOM_INPUT_RESET,      // SmartIntercom сброс
+  SMARTINTERCOM_INPUTS
+};
+
+// SmartIntercom Transition Actions
+enum SmartIntercomStateAction {
+  SMARTINTERCOM_ACTION_NONE,
+  SMARTINTERCOM_ACTION_LED_OFF,       // SmartIntercom погасить светодиод
+  SMARTINTERCOM_ACTION_RING_TIMEOUT,  // SmartIntercom звонок без ответа: погасить светодиод
+  SMARTINTERCOM_ACTION_CLOSE_DOOR     // SmartIntercom закрыть дверь и погасить светодиод
+};
+
+// SmartIntercom Transition Timeouts (срок входа TIMEOUT в новом состоянии)
+enum SmartIntercomStateTimeout {
+  SMARTINTERCOM_TIMEOUT_KEEP,       // SmartIntercom срок не меняется
+  SMARTINTERCOM_TIMEOUT_NONE,       // SmartIntercom срока нет
+  SMARTINTERCOM_TIMEOUT_IMMEDIATE,  // SmartIntercom на следующем проходе цикла
+  SMARTINTERCOM_TIMEOUT_RING,       // SmartIntercom через ringTimeout
+  SMARTINTERCOM_TIMEOUT_DOOR        // SmartIntercom через время открытия двери + 1 с
+};
+
+/*
+ * SmartIntercomTransition - Строка таблицы переходов SmartIntercom
+ *
+ * next == SMARTINTERCOM_STATES - вход в этом состоянии игнорируется.
+ */
+struct SmartIntercomTransition {
+  uint8_t next;
+  uint8_t action;
+  uint8_t timeout;
+};
+
+#define SMARTINTERCOM_GO(next, action, timeout) \
+  { SMARTINTERCOM_STATE_##next, SMARTINTERCOM_ACTION_##action, SMARTINTERCOM_TIMEOUT_##timeout }
+#define SMARTINTERCOM_IGNORE { SMARTINTERCOM_STATES, SMARTINTERCOM_ACTION_NONE, SMARTINTERCOM_TIMEOUT_KEEP }
+
+// SmartIntercom Transition Table: BEGIN, RING, OPEN, CLOSE, TIMEOUT, RESET
+static constexpr SmartIntercomTransition smartIntercomTransitions[SMARTINTERCOM_STATES][SMARTINTERCOM_INPUTS] = {
+  { // INIT
+    SMARTINTERCOM_GO(READY, NONE, NONE), SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_IGNORE,
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // READY
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_IGNORE,
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // IDLE
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_IGNORE,
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // RINGING (повторный звонок продлевает срок)
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_IGNORE,
+    SMARTINTERCOM_GO(IDLE, RING_TIMEOUT, NONE), SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // OPENING
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_GO(OPEN, NONE, DOOR), SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // OPEN
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_GO(IDLE, CLOSE_DOOR, NONE), SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // CLOSING
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_GO(IDLE, LED_OFF, NONE),
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(INIT, NONE, NONE) },
+  { // ERROR
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(RINGING, NONE, RING),
+    SMARTINTERCOM_GO(OPENING, NONE, IMMEDIATE), SMARTINTERCOM_IGNORE,
+    SMARTINTERCOM_IGNORE, SMARTINTERCOM_GO(INIT, NONE, NONE) }
+};
+
+#undef SMARTINTERCOM_GO
+#undef SMARTINTERCOM_IGNORE
+
+/*
+ * SmartIntercom Transition Lookup
+ * Переход SmartIntercom для (состояние, вход) - O(1)
+ */
+constexpr const SmartIntercomTransition& smartIntercomTransitionFor(uint8_t state, uint8_t input) {
+  return smartIntercomTransitions[state][input];
+}
+
+// ============================================================================
+// SmartIntercom Transition Checks (выполняются компилятором)
+// ============================================================================
+
+constexpr bool smartIntercomTransitionIs(uint8_t state, uint8_t input, uint8_t next, uint8_t action,
+                                         uint8_t timeout) {
+  return smartIntercomTransitionFor(state, input).next == next &&
+         smartIntercomTransitionFor(state, input).action == action &&
+         smartIntercomTransitionFor(state, input).timeout == timeout;
+}
+
+constexpr bool smartIntercomTransitionHandled(uint8_t state, uint8_t input) {
+  return smartIntercomTransitionFor(state, input).next != SMARTINTERCOM_STATES;
+}
+
+// Срок, взведенный переходом, должен вести в состояние, где TIMEOUT обрабатывается
+constexpr bool smartIntercomTimeoutReachable(uint8_t state, uint8_t input) {
+  return !smartIntercomTransitionHandled(state, input) ||
+         smartIntercomTransitionFor(state, input).timeout < SMARTINTERCOM_TIMEOUT_IMMEDIATE ||
+         smartIntercomTransitionHandled(smartIntercomTransitionFor(state, input).next, SMARTINTERCOM_INPUT_TIMEOUT);
+}
+
+// Переход по TIMEOUT обязан снять или заново взвести срок, иначе он сработает снова
+constexpr bool smartIntercomTimeoutConsumed(uint8_t state) {
+  return !smartIntercomTransitionHandled(state, SMARTINTERCOM_INPUT_TIMEOUT) ||
+         smartIntercomTransitionFor(state, SMARTINTERCOM_INPUT_TIMEOUT).timeout != SMARTINTERCOM_TIMEOUT_KEEP;
+}
+
+constexpr bool smartIntercomStateChecked(uint8_t state, uint8_t input) {
+  return input == SMARTINTERCOM_INPUTS ||
+         (smartIntercomTimeoutReachable(state, input) && smartIntercomTimeoutConsumed(state) &&
+          smartIntercomTransitionIs(state, SMARTINTERCOM_INPUT_RING, SMARTINTERCOM_STATE_RINGING,
+                                    SMARTINTERCOM_ACTION_NONE, SMARTINTERCOM_TIMEOUT_RING) &&
+          smartIntercomTransitionIs(state, SMARTINTERCOM_INPUT_OPEN, SMARTINTERCOM_STATE_OPENING,
+                                    SMARTINTERCOM_ACTION_NONE, SMARTINTERCOM_TIMEOUT_IMMEDIATE) &&
+          smartIntercomTransitionIs(state, SMARTINTERCOM_INPUT_RESET, SMARTINTERCOM_STATE_INIT,
+                                    SMARTINTERCOM_ACTION_NONE, SMARTINTERCOM_TIMEOUT_NONE) &&
+          (state == SMARTINTERCOM_STATE_INIT || !smartIntercomTransitionHandled(state, SMARTINTERCOM_INPUT_BEGIN)) &&
+          smartIntercomStateChecked(state, input + 1));
+}
+
+constexpr bool smartIntercomTableChecked(uint8_t state) {
+  return state == SMARTINTERCOM_STATES ||
+         (smartIntercomStateChecked(state, 0) && smartIntercomTableChecked(state + 1));
+}
+
+static_assert(smartIntercomTableChecked(0), "SmartIntercom transition table is inconsistent");
+static_assert(smartIntercomTransitionIs(SMARTINTERCOM_STATE_INIT, SMARTINTERCOM_INPUT_BEGIN,
+                                        SMARTINTERCOM_STATE_READY, SMARTINTERCOM_ACTION_NONE,
+                                        SMARTINTERCOM_TIMEOUT_NONE),
+              "SmartIntercom begin must move INIT to READY");
+static_assert(smartIntercomTransitionIs(SMARTINTERCOM_STATE_RINGING, SMARTINTERCOM_INPUT_TIMEOUT,
+                                        SMARTINTERCOM_STATE_IDLE, SMARTINTERCOM_ACTION_RING_TIMEOUT,
+                                        SMARTINTERCOM_TIMEOUT_NONE),
+              "SmartIntercom unanswered ring must return to IDLE");
+static_assert(smartIntercomTransitionIs(SMARTINTERCOM_STATE_OPENING, SMARTINTERCOM_INPUT_TIMEOUT,
+                                        SMARTINTERCOM_STATE_OPEN, SMARTINTERCOM_ACTION_NONE,
+                                        SMARTINTERCOM_TIMEOUT_DOOR),
+              "SmartIntercom OPENING must become OPEN on the next pass");
+static_assert(smartIntercomTransitionIs(SMARTINTERCOM_STATE_OPEN, SMARTINTERCOM_INPUT_TIMEOUT,
+                                        SMARTINTERCOM_STATE_IDLE, SMARTINTERCOM_ACTION_CLOSE_DOOR,
+                                        SMARTINTERCOM_TIMEOUT_NONE),
+              "SmartIntercom OPEN must close the door when its time is up");
+static_assert(smartIntercomTransitionIs(SMARTINTERCOM_STATE_OPEN, SMARTINTERCOM_INPUT_CLOSE,
+                                        SMARTINTERCOM_STATE_IDLE, SMARTINTERCOM_ACTION_LED_OFF,
+                                        SMARTINTERCOM_TIMEOUT_NONE) &&
+              smartIntercomTransitionIs(SMARTINTERCOM_STATE_OPENING, SMARTINTERCOM_INPUT_CLOSE,
+                                        SMARTINTERCOM_STATE_IDLE, SMARTINTERCOM_ACTION_LED_OFF,
+                                        SMARTINTERCOM_TIMEOUT_NONE),
+              "SmartIntercom close command must end OPENING and OPEN");
+static_assert(!smartIntercomTransitionHandled(SMARTINTERCOM_STATE_IDLE, SMARTINTERCOM_INPUT_CLOSE) &&
+              !smartIntercomTransitionHandled(SMARTINTERCOM_STATE_RINGING, SMARTINTERCOM_INPUT_CLOSE),
+              "SmartIntercom close command must not leave IDLE or RINGING");
+
+#endif // SMARTINTERCOM_STATE_MACHINE_H
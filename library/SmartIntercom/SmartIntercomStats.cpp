@@ -0,0 +1,382 @@
+/*
+ * SmartIntercomStats.cpp - Реализация статистики SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomStats.h"
+#include "SmartIntercomLog.h"
+
+#define SMARTINTERCOM_STATS_MINUTE_MS 60000UL
+#define SMARTINTERCOM_STATS_SNAPSHOT_SECTORS 2
+
+// SmartIntercom JSON Cursor Layout (фаза, ряд, счетчик, маска рядов, индекс ячейки)
+#define SMARTINTERCOM_STATS_CURSOR_PHASE(cursor) (((cursor) >> 28) & 0x0F)
+#define SMARTINTERCOM_STATS_CURSOR_RANGE(cursor) (((cursor) >> 26) & 0x03)
+#define SMARTINTERCOM_STATS_CURSOR_COUNTER(cursor) (((cursor) >> 24) & 0x03)
+#define SMARTINTERCOM_STATS_CURSOR_MASK(cursor) (((cursor) >> 21) & 0x07)
+#define SMARTINTERCOM_STATS_CURSOR_INDEX(cursor) ((cursor) & 0xFFFF)
+#define SMARTINTERCOM_STATS_CURSOR(phase, range, counter, mask, index)                                      \
+  (((uint32_t)(phase) << 28) | ((uint32_t)(range) << 26) | ((uint32_t)(counter) << 24) |                   \
+   ((uint32_t)(mask) << 21) | (uint32_t)(index))
+
+#define SMARTINTERCOM_STATS_JSON_HEADER 0
+#define SMARTINTERCOM_STATS_JSON_SERIES 1
+#define SMARTINTERCOM_STATS_JSON_CLOSE 2
+#define SMARTINTERCOM_STATS_JSON_DONE 3
+#define SMARTINTERCOM_STATS_JSON_ITEM_MAX 48
+
+// SmartIntercom JSON Names
+static const char* const smartIntercomStatsCounterNames[SMARTINTERCOM_STATS_COUNTERS] = {
+  "rings", "opens", "auto_opens", "errors"
+};
+static const char* const smartIntercomStatsRangeNames[SMARTINTERCOM_STATS_RANGES] = {
+  "minute", "hour", "day"
+};
+
+/*
+ * SmartIntercomStats Constructor
+ */
+SmartIntercomStats::SmartIntercomStats() {
+  memset(&smartIntercomImage, 0, sizeof(smartIntercomImage));
+  smartIntercomLastTick = 0;
+  smartIntercomTickRemainder = 0;
+  smartIntercomFlash = nullptr;
+  smartIntercomSector = 0;
+  smartIntercomGeneration = 0;
+  smartIntercomLastSave = 0;
+  smartIntercomDirty = false;
+  smartIntercomSaves = 0;
+}
+
+/*
+ * SmartIntercomStats Begin
+ * Восстановление последнего верного снимка SmartIntercom
+ *
+ * Заголовок снимка пишется после данных, поэтому оборванная запись
+ * дает неверный заголовок или CRC, и действует предыдущий снимок.
+ */
+bool SmartIntercomStats::smartIntercomBegin(SmartIntercomFlash* flash) {
+  static_assert(sizeof(SmartIntercomStatsImage) % 4 == 0, "SmartIntercom: stats image must be word aligned");
+  static_assert(sizeof(SmartIntercomStatsHeader) + sizeof(SmartIntercomStatsImage) <= 4096,
+                "SmartIntercom: stats snapshot must fit one flash sector");
+
+  smartIntercomFlash = flash;
+  smartIntercomLastTick = smartIntercomMillis();
+  smartIntercomTickRemainder = 0;
+  smartIntercomLastSave = smartIntercomLastTick;
+  smartIntercomDirty = false;
+
+  if (flash != nullptr && flash->smartIntercomGetSectorSize() <
+                              sizeof(SmartIntercomStatsHeader) + sizeof(SmartIntercomStatsImage)) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Stats flash sector too small");
+    smartIntercomFlash = nullptr;
+  }
+  if (smartIntercomFlash == nullptr || smartIntercomFlash->smartIntercomGetSectorCount() == 0) {
+    memset(&smartIntercomImage, 0, sizeof(smartIntercomImage));
+    return false;
+  }
+
+  uint16_t sectors = smartIntercomFlash->smartIntercomGetSectorCount();
+  if (sectors > SMARTINTERCOM_STATS_SNAPSHOT_SECTORS) {
+    sectors = SMARTINTERCOM_STATS_SNAPSHOT_SECTORS;
+  }
+
+  // SmartIntercom Snapshots newest first, the first one with a valid CRC wins
+  SmartIntercomStatsHeader headers[SMARTINTERCOM_STATS_SNAPSHOT_SECTORS];
+  bool valid[SMARTINTERCOM_STATS_SNAPSHOT_SECTORS] = { false, false };
+  for (uint16_t sector = 0; sector < sectors; sector++) {
+    valid[sector] = smartIntercomReadSnapshot(sector, &headers[sector]);
+  }
+  for (uint16_t pass = 0; pass < sectors; pass++) {
+    int16_t newest = -1;
+    for (uint16_t sector = 0; sector < sectors; sector++) {
+      if (valid[sector] && (newest < 0 || headers[sector].generation > headers[newest].generation)) {
+        newest = sector;
+      }
+    }
+    if (newest < 0) {
+      break;
+    }
+    valid[newest] = false;
+    if (smartIntercomFlash->smartIntercomRead(newest, sizeof(SmartIntercomStatsHeader), (uint32_t*)&smartIntercomImage,
+                                              sizeof(smartIntercomImage)) &&
+        SmartIntercomConfigStore::smartIntercomCrc32((const uint8_t*)&smartIntercomImage,
+                                                     sizeof(smartIntercomImage)) == headers[newest].crc) {
+      smartIntercomSector = newest;
+      smartIntercomGeneration = headers[newest].generation;
+      SMARTINTERCOM_LOG_INFO("SmartIntercom: Stats restored (snapshot %lu, %lu minutes)",
+                             (unsigned long)smartIntercomGeneration, (unsigned long)smartIntercomImage.minute);
+      return true;
+    }
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: Stats snapshot in sector %u is corrupted", newest);
+  }
+
+  memset(&smartIntercomImage, 0, sizeof(smartIntercomImage));
+  smartIntercomSector = sectors - 1;
+  smartIntercomGeneration = 0;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Stats snapshot not found, starting empty");
+  return false;
+}
+
+/*
+ * SmartIntercomStats Read Snapshot
+ * Заголовок снимка SmartIntercom в секторе (без проверки данных)
+ */
+bool SmartIntercomStats::smartIntercomReadSnapshot(uint16_t sector, SmartIntercomStatsHeader* header) {
+  if (!smartIntercomFlash->smartIntercomRead(sector, 0, (uint32_t*)header, sizeof(*header))) {
+    return false;
+  }
+  return header->magic == SMARTINTERCOM_STATS_MAGIC && header->generation != 0xFFFFFFFFUL &&
+         header->length == sizeof(SmartIntercomStatsImage);
+}
+
+/*
+ * SmartIntercomStats Tick
+ * Учесть прошедшее время SmartIntercom (деление - раз в минуту)
+ */
+void SmartIntercomStats::smartIntercomTick() {
+  unsigned long now = smartIntercomMillis();
+  smartIntercomTickRemainder += (uint32_t)(now - smartIntercomLastTick);
+  smartIntercomLastTick = now;
+  if (smartIntercomTickRemainder < SMARTINTERCOM_STATS_MINUTE_MS) {
+    return;
+  }
+  uint32_t minutes = smartIntercomTickRemainder / SMARTINTERCOM_STATS_MINUTE_MS;
+  smartIntercomTickRemainder -= minutes * SMARTINTERCOM_STATS_MINUTE_MS;
+  smartIntercomAdvanceTo(smartIntercomImage.minute + minutes);
+}
+
+/*
+ * SmartIntercomStats Advance To
+ */
+void SmartIntercomStats::smartIntercomAdvanceTo(uint32_t minute) {
+  smartIntercomImage.minute = minute;
+  smartIntercomImage.minutes.smartIntercomAdvance(minute);
+  smartIntercomImage.hours.smartIntercomAdvance(minute / 60);
+  smartIntercomImage.days.smartIntercomAdvance(minute / 1440);
+}
+
+/*
+ * SmartIntercomStats Record
+ * Событие SmartIntercom: по инкременту в каждом ряду и в итогах
+ */
+void SmartIntercomStats::smartIntercomRecord(SmartIntercomStatsCounter counter) {
+  if (counter >= SMARTINTERCOM_STATS_COUNTERS) {
+    return;
+  }
+  smartIntercomTick();
+  smartIntercomImage.totals[counter]++;
+  smartIntercomImage.minutes.smartIntercomAdd(counter);
+  smartIntercomImage.hours.smartIntercomAdd(counter);
+  smartIntercomImage.days.smartIntercomAdd(counter);
+  smartIntercomDirty = true;
+}
+
+uint32_t SmartIntercomStats::smartIntercomGetTotal(SmartIntercomStatsCounter counter) {
+  return counter < SMARTINTERCOM_STATS_COUNTERS ? smartIntercomImage.totals[counter] : 0;
+}
+
+uint32_t SmartIntercomStats::smartIntercomGetMinute() {
+  smartIntercomTick();
+  return smartIntercomImage.minute;
+}
+
+uint16_t SmartIntercomStats::smartIntercomGetLength(SmartIntercomStatsRange range) {
+  switch (range) {
+    case SMARTINTERCOM_STATS_MINUTE:
+      return SMARTINTERCOM_STATS_MINUTES;
+    case SMARTINTERCOM_STATS_HOUR:
+      return SMARTINTERCOM_STATS_HOURS;
+    case SMARTINTERCOM_STATS_DAY:
+      return SMARTINTERCOM_STATS_DAYS;
+    default:
+      return 0;
+  }
+}
+
+/*
+ * SmartIntercomStats Get Value
+ * Значение счетчика SmartIntercom age интервалов назад (0 - текущий)
+ */
+uint16_t SmartIntercomStats::smartIntercomGetValue(SmartIntercomStatsRange range, SmartIntercomStatsCounter counter,
+                                                   uint16_t age) {
+  if (counter >= SMARTINTERCOM_STATS_COUNTERS) {
+    return 0;
+  }
+  smartIntercomTick();
+  switch (range) {
+    case SMARTINTERCOM_STATS_MINUTE:
+      return smartIntercomImage.minutes.smartIntercomGet(age, counter);
+    case SMARTINTERCOM_STATS_HOUR:
+      return smartIntercomImage.hours.smartIntercomGet(age, counter);
+    case SMARTINTERCOM_STATS_DAY:
+      return smartIntercomImage.days.smartIntercomGet(age, counter);
+    default:
+      return 0;
+  }
+}
+
+/*
+ * SmartIntercomStats Get Sum
+ * Сумма счетчика SmartIntercom за последние intervals интервалов ряда
+ */
+uint32_t SmartIntercomStats::smartIntercomGetSum(SmartIntercomStatsRange range, SmartIntercomStatsCounter counter,
+                                                 uint16_t intervals) {
+  uint16_t length = smartIntercomGetLength(range);
+  if (intervals > length) {
+    intervals = length;
+  }
+  uint32_t sum = 0;
+  for (uint16_t age = 0; age < intervals; age++) {
+    sum += smartIntercomGetValue(range, counter, age);
+  }
+  return sum;
+}
+
+// ============================================================================
+// SmartIntercom Statistics JSON
+// ============================================================================
+
+/*
+ * SmartIntercomStats Json Cursor
+ * Начальный курсор генератора SmartIntercom для набора рядов (бит 1 << range)
+ */
+uint32_t SmartIntercomStats::smartIntercomJsonCursor(uint8_t rangeMask) {
+  rangeMask &= (1 << SMARTINTERCOM_STATS_RANGES) - 1;
+  return SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_HEADER, 0, 0, rangeMask, 0);
+}
+
+/*
+ * SmartIntercomStats Write Json
+ * Генератор тела /api/stats SmartIntercom
+ *
+ * Ряды выводятся от старого интервала к текущему. Каждый вызов
+ * дописывает целые элементы, пока они помещаются в out; позиция
+ * хранится в курсоре, поэтому весь ответ не держится в памяти.
+ */
+size_t SmartIntercomStats::smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomStats* stats = (SmartIntercomStats*)context;
+  size_t used = 0;
+
+  while (used + SMARTINTERCOM_STATS_JSON_ITEM_MAX < size) {
+    uint32_t phase = SMARTINTERCOM_STATS_CURSOR_PHASE(*cursor);
+    uint8_t mask = SMARTINTERCOM_STATS_CURSOR_MASK(*cursor);
+    char* item = out + used;
+    size_t space = size - used;
+    int written = 0;
+
+    if (phase == SMARTINTERCOM_STATS_JSON_HEADER) {
+      if (space < 160) {
+        break;
+      }
+      stats->smartIntercomTick();
+      const uint32_t* totals = stats->smartIntercomImage.totals;
+      written = snprintf(item, space,
+                         "{\"uptime_s\":%lu,\"recorded_minutes\":%lu,\"totals\":{\"rings\":%lu,\"opens\":%lu,"
+                         "\"auto_opens\":%lu,\"errors\":%lu}",
+                         (unsigned long)(smartIntercomMillis() / 1000), (unsigned long)stats->smartIntercomImage.minute,
+                         (unsigned long)totals[SMARTINTERCOM_STATS_RINGS], (unsigned long)totals[SMARTINTERCOM_STATS_OPENS],
+                         (unsigned long)totals[SMARTINTERCOM_STATS_AUTO_OPENS],
+                         (unsigned long)totals[SMARTINTERCOM_STATS_ERRORS]);
+      uint8_t range = 0;
+      while (range < SMARTINTERCOM_STATS_RANGES && (mask & (1 << range)) == 0) {
+        range++;
+      }
+      *cursor = range < SMARTINTERCOM_STATS_RANGES
+                    ? SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_SERIES, range, 0, mask, 0)
+                    : SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_CLOSE, 0, 0, mask, 0);
+    } else if (phase == SMARTINTERCOM_STATS_JSON_SERIES) {
+      SmartIntercomStatsRange range = (SmartIntercomStatsRange)SMARTINTERCOM_STATS_CURSOR_RANGE(*cursor);
+      SmartIntercomStatsCounter counter = (SmartIntercomStatsCounter)SMARTINTERCOM_STATS_CURSOR_COUNTER(*cursor);
+      uint16_t index = SMARTINTERCOM_STATS_CURSOR_INDEX(*cursor);
+      uint16_t length = smartIntercomGetLength(range);
+
+      if (index < length) {
+        // SmartIntercom Series opening is written together with the first value
+        if (index == 0 && counter == 0) {
+          written = snprintf(item, space, ",\"%s\":{", smartIntercomStatsRangeNames[range]);
+        }
+        if (index == 0) {
+          written += snprintf(item + written, space - written, "%s\"%s\":[", counter == 0 ? "" : ",",
+                              smartIntercomStatsCounterNames[counter]);
+        }
+        uint16_t value = stats->smartIntercomGetValue(range, counter, length - 1 - index);
+        written += snprintf(item + written, space - written, index == 0 ? "%u" : ",%u", value);
+        *cursor = SMARTINTERCOM_STATS_CURSOR(phase, range, counter, mask, index + 1);
+      } else if (counter + 1 < SMARTINTERCOM_STATS_COUNTERS) {
+        written = snprintf(item, space, "]");
+        *cursor = SMARTINTERCOM_STATS_CURSOR(phase, range, counter + 1, mask, 0);
+      } else {
+        written = snprintf(item, space, "]}");
+        uint8_t next = range + 1;
+        while (next < SMARTINTERCOM_STATS_RANGES && (mask & (1 << next)) == 0) {
+          next++;
+        }
+        *cursor = next < SMARTINTERCOM_STATS_RANGES
+                      ? SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_SERIES, next, 0, mask, 0)
+                      : SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_CLOSE, 0, 0, mask, 0);
+      }
+    } else if (phase == SMARTINTERCOM_STATS_JSON_CLOSE) {
+      written = snprintf(item, space, "}\n");
+      *cursor = SMARTINTERCOM_STATS_CURSOR(SMARTINTERCOM_STATS_JSON_DONE, 0, 0, mask, 0);
+    } else {
+      break;
+    }
+    used += written;
+  }
+  return used;
+}
+
+// ============================================================================
+// SmartIntercom Statistics Snapshot
+// ============================================================================
+
+/*
+ * SmartIntercomStats Is Save Due
+ * Снимок SmartIntercom пишется не чаще SMARTINTERCOM_STATS_SAVE_INTERVAL и только при изменениях
+ */
+bool SmartIntercomStats::smartIntercomIsSaveDue() {
+  return smartIntercomFlash != nullptr && smartIntercomDirty &&
+         smartIntercomMillis() - smartIntercomLastSave >= (unsigned long)SMARTINTERCOM_STATS_SAVE_INTERVAL * 1000UL;
+}
+
+/*
+ * SmartIntercomStats Save
+ * Записать снимок SmartIntercom в другой сектор (предыдущий остается целым)
+ */
+bool SmartIntercomStats::smartIntercomSave() {
+  if (smartIntercomFlash == nullptr || smartIntercomFlash->smartIntercomGetSectorCount() == 0) {
+    return false;
+  }
+  uint16_t sectors = smartIntercomFlash->smartIntercomGetSectorCount();
+  if (sectors > SMARTINTERCOM_STATS_SNAPSHOT_SECTORS) {
+    sectors = SMARTINTERCOM_STATS_SNAPSHOT_SECTORS;
+  }
+  uint16_t sector = (uint16_t)((smartIntercomSector + 1) % sectors);
+
+  smartIntercomTick();
+  smartIntercomLastSave = smartIntercomMillis();
+  SmartIntercomStatsHeader header;
+  header.magic = SMARTINTERCOM_STATS_MAGIC;
+  header.generation = smartIntercomGeneration + 1;
+  header.length = sizeof(smartIntercomImage);
+  header.crc = SmartIntercomConfigStore::smartIntercomCrc32((const uint8_t*)&smartIntercomImage,
+                                                            sizeof(smartIntercomImage));
+
+  if (!smartIntercomFlash->smartIntercomErase(sector) ||
+      !smartIntercomFlash->smartIntercomWrite(sector, sizeof(header), (const uint32_t*)&smartIntercomImage,
+                                              sizeof(smartIntercomImage)) ||
+      !smartIntercomFlash->smartIntercomWrite(sector, 0, (const uint32_t*)&header, sizeof(header))) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Stats snapshot write to sector %u failed", sector);
+    return false;
+  }
+
+  smartIntercomSector = sector;
+  smartIntercomGeneration = header.generation;
+  smartIntercomDirty = false;
+  smartIntercomSaves++;
+  SMARTINTERCOM_LOG_DEBUG("SmartIntercom: Stats snapshot %lu saved", (unsigned long)smartIntercomGeneration);
+  return true;
+}
@@ -0,0 +1,169 @@
+/*
+ * SmartIntercomStats.h - Статистика SmartIntercom с фиксированным расходом памяти
+ *
+ * Звонки, открытия, авто-открытия и ошибки считаются в трех
+ * кольцевых рядах разного разрешения: по минутам за последний час,
+ * по часам за последнюю неделю и по дням за последний год. Запись
+ * события - три инкремента (O(1)), переход к новому интервалу
+ * обнуляет только пропущенные ячейки; память занята один раз
+ * при старте и не растет.
+ *
+ * Ряды периодически сохраняются снимком во флеш-память (два сектора
+ * попеременно), поэтому долгосрочная статистика переживает перезагрузку.
+ * Без часов реального времени время простоя устройства в ряды
+ * не попадает: после перезагрузки отсчет продолжается с момента
+ * последнего снимка.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_STATS_H
+#define SMARTINTERCOM_STATS_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomConfigStore.h"
+
+// SmartIntercom Statistics Configuration
+#ifndef SMARTINTERCOM_STATS_SAVE_INTERVAL
+#define SMARTINTERCOM_STATS_SAVE_INTERVAL 3600   // Интервал сохранения статистики (сек)
+#endif
+
+#define SMARTINTERCOM_STATS_MINUTES 60
+#define SMARTINTERCOM_STATS_HOURS 168
+#define SMARTINTERCOM_STATS_DAYS 366
+#define SMARTINTERCOM_STATS_MAGIC 0x53495354UL  // "SIST"
+
+// SmartIntercom Statistics Counters
+enum SmartIntercomStatsCounter {
+  SMARTINTERCOM_STATS_RINGS,
+  SMARTINTERCOM_STATS_OPENS,
+  SMARTINTERCOM_STATS_AUTO_OPENS,
+  SMARTINTERCOM_STATS_ERRORS,
+  SMARTINTERCOM_STATS_COUNTERS
+};
+
+// SmartIntercom Statistics Resolutions
+enum SmartIntercomStatsRange {
+  SMARTINTERCOM_STATS_MINUTE,
+  SMARTINTERCOM_STATS_HOUR,
+  SMARTINTERCOM_STATS_DAY,
+  SMARTINTERCOM_STATS_RANGES
+};
+
+/*
+ * SmartIntercomStatsSeries - Кольцевой ряд счетчиков SmartIntercom
+ *
+ * N ячеек по SMARTINTERCOM_STATS_COUNTERS счетчиков типа T; head -
+ * номер интервала текущей ячейки. Счетчики насыщаются, а не
+ * переполняются.
+ */
+template <typename T, uint16_t N>
+struct SmartIntercomStatsSeries {
+  T buckets[N][SMARTINTERCOM_STATS_COUNTERS];
+  uint32_t head;
+
+  void smartIntercomClear(uint32_t period) {
+    memset(buckets, 0, sizeof(buckets));
+    head = period;
+  }
+
+  /*
+   * SmartIntercomStatsSeries Advance
+   * Перейти к интервалу period, обнулив пропущенные ячейки (не больше N)
+   */
+  void smartIntercomAdvance(uint32_t period) {
+    if (period <= head) {
+      return;
+    }
+    if (period - head >= N) {
+      smartIntercomClear(period);
+      return;
+    }
+    while (head < period) {
+      head++;
+      memset(buckets[head % N], 0, sizeof(buckets[0]));
+    }
+  }
+
+  inline void smartIntercomAdd(uint8_t counter) {
+    T& value = buckets[head % N][counter];
+    if (value != (T)~(T)0) {
+      value++;
+    }
+  }
+
+  // SmartIntercom Value age intervals ago (0 - current interval)
+  inline uint16_t smartIntercomGet(uint16_t age, uint8_t counter) const {
+    return age < N ? buckets[(head % N + N - age) % N][counter] : 0;
+  }
+};
+
+/*
+ * SmartIntercomStats - Многоуровневая статистика SmartIntercom
+ */
+class SmartIntercomStats {
+private:
+  // SmartIntercom Snapshot Header (данные снимка следуют за заголовком)
+  struct SmartIntercomStatsHeader {
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t length;
+    uint32_t crc;
+  };
+
+  // SmartIntercom Persistent Image (сохраняется во флеш целиком)
+  struct SmartIntercomStatsImage {
+    uint32_t minute;
+    uint32_t totals[SMARTINTERCOM_STATS_COUNTERS];
+    SmartIntercomStatsSeries<uint8_t, SMARTINTERCOM_STATS_MINUTES> minutes;
+    SmartIntercomStatsSeries<uint8_t, SMARTINTERCOM_STATS_HOURS> hours;
+    SmartIntercomStatsSeries<uint16_t, SMARTINTERCOM_STATS_DAYS> days;
+  };
+
+  SmartIntercomStatsImage smartIntercomImage;
+  unsigned long smartIntercomLastTick;
+  uint32_t smartIntercomTickRemainder;
+
+  // SmartIntercom Snapshot State
+  SmartIntercomFlash* smartIntercomFlash;
+  uint16_t smartIntercomSector;
+  uint32_t smartIntercomGeneration;
+  unsigned long smartIntercomLastSave;
+  bool smartIntercomDirty;
+  uint32_t smartIntercomSaves;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomTick();
+  void smartIntercomAdvanceTo(uint32_t minute);
+  bool smartIntercomReadSnapshot(uint16_t sector, SmartIntercomStatsHeader* header);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomStats();
+
+  // SmartIntercom Initialization (восстановление последнего снимка)
+  bool smartIntercomBegin(SmartIntercomFlash* flash = nullptr);
+
+  // SmartIntercom Recording (O(1), из главного цикла)
+  void smartIntercomRecord(SmartIntercomStatsCounter counter);
+
+  // SmartIntercom Queries
+  uint32_t smartIntercomGetTotal(SmartIntercomStatsCounter counter);
+  uint32_t smartIntercomGetSum(SmartIntercomStatsRange range, SmartIntercomStatsCounter counter, uint16_t intervals);
+  uint16_t smartIntercomGetValue(SmartIntercomStatsRange range, SmartIntercomStatsCounter counter, uint16_t age);
+  static uint16_t smartIntercomGetLength(SmartIntercomStatsRange range);
+  uint32_t smartIntercomGetMinute();
+
+  // SmartIntercom JSON (генератор для SmartIntercomHttpResponse, диапазоны - маска бит)
+  static uint32_t smartIntercomJsonCursor(uint8_t rangeMask);
+  static size_t smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context);
+
+  // SmartIntercom Snapshot (во флеш-память)
+  bool smartIntercomIsSaveDue();
+  bool smartIntercomSave();
+  uint32_t smartIntercomGetSaves() { return smartIntercomSaves; }
+};
+
+#endif // SMARTINTERCOM_STATS_H
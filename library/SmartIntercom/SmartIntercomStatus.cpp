@@ -0,0 +1,122 @@
+/*
+ * SmartIntercomStatus.cpp - Реализация снимка статуса SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomStatus.h"
+#include "SmartIntercomLog.h"
+
+/*
+ * SmartIntercomStatusSnapshot Constructor
+ */
+SmartIntercomStatusSnapshot::SmartIntercomStatusSnapshot() {
+  smartIntercomWriter = nullptr;
+  smartIntercomContext = nullptr;
+  smartIntercomJson[0] = '\0';
+  smartIntercomLength = 0;
+  smartIntercomETag[0] = '\0';
+  smartIntercomBootTag = 0;
+  smartIntercomGeneration = 0;
+  smartIntercomRebuilds = 0;
+  smartIntercomDirty = true;
+}
+
+/*
+ * SmartIntercomStatusSnapshot Begin
+ * Назначить сериализатор статуса SmartIntercom
+ *
+ * Метка загрузки берется из аппаратного ГСЧ ESP8266 (на хосте - из
+ * времени запуска), чтобы ETag разных загрузок не пересекались.
+ */
+void SmartIntercomStatusSnapshot::smartIntercomBegin(SmartIntercomStatusWriter writer, void* context) {
+  smartIntercomWriter = writer;
+  smartIntercomContext = context;
+#ifdef ESP8266
+  smartIntercomBootTag = ESP.random();
+#else
+  smartIntercomBootTag = smartIntercomActiveHAL ? smartIntercomMicros() : 0;
+  smartIntercomBootTag ^= (uint32_t)(uintptr_t)this;
+#endif
+  smartIntercomDirty = true;
+}
+
+/*
+ * SmartIntercomStatusSnapshot Rebuild
+ * Пересобрать JSON SmartIntercom; поколение растет только при изменении
+ *
+ * Новый JSON собирается во временный буфер и сравнивается со старым:
+ * событие, не изменившее отдаваемые поля, не сбрасывает кэш клиентов.
+ */
+void SmartIntercomStatusSnapshot::smartIntercomRebuild() {
+  smartIntercomDirty = false;
+  if (smartIntercomWriter == nullptr) {
+    return;
+  }
+  smartIntercomRebuilds++;
+
+  size_t length = smartIntercomWriter(smartIntercomScratch, sizeof(smartIntercomScratch), smartIntercomContext);
+  if (length >= sizeof(smartIntercomScratch)) {
+    SMARTINTERCOM_LOG_ERROR("SmartIntercom: Status JSON truncated (%u bytes, buffer %u)",
+                            (unsigned int)length, (unsigned int)sizeof(smartIntercomScratch));
+    length = sizeof(smartIntercomScratch) - 1;
+  }
+
+  if (smartIntercomGeneration > 0 && length == smartIntercomLength &&
+      memcmp(smartIntercomScratch, smartIntercomJson, length) == 0) {
+    return;
+  }
+
+  memcpy(smartIntercomJson, smartIntercomScratch, length);
+  smartIntercomJson[length] = '\0';
+  smartIntercomLength = length;
+  smartIntercomGeneration++;
+  snprintf(smartIntercomETag, sizeof(smartIntercomETag), "\"%08lx-%lx\"",
+           (unsigned long)smartIntercomBootTag, (unsigned long)smartIntercomGeneration);
+}
+
+/*
+ * SmartIntercomStatusSnapshot Get JSON
+ * Актуальный JSON статуса SmartIntercom (пересборка только после изменений)
+ */
+const char* SmartIntercomStatusSnapshot::smartIntercomGetJson(size_t* length) {
+  if (smartIntercomDirty) {
+    smartIntercomRebuild();
+  }
+  if (length) {
+    *length = smartIntercomLength;
+  }
+  return smartIntercomJson;
+}
+
+/*
+ * SmartIntercomStatusSnapshot Get ETag
+ * ETag актуального снимка SmartIntercom вместе с кавычками
+ */
+const char* SmartIntercomStatusSnapshot::smartIntercomGetETag() {
+  if (smartIntercomDirty) {
+    smartIntercomRebuild();
+  }
+  return smartIntercomETag;
+}
+
+/*
+ * SmartIntercomStatusSnapshot Matches
+ * Проверка заголовка If-None-Match SmartIntercom против текущего ETag
+ *
+ * Принимаются "*", список через запятую и слабые теги (W/"...").
+ */
+bool SmartIntercomStatusSnapshot::smartIntercomMatches(const char* ifNoneMatch) {
+  if (ifNoneMatch == nullptr || ifNoneMatch[0] == '\0') {
+    return false;
+  }
+  const char* etag = smartIntercomGetETag();
+  if (etag[0] == '\0') {
+    return false;
+  }
+  if (ifNoneMatch[0] == '*' && ifNoneMatch[1] == '\0') {
+    return true;
+  }
+  return strstr(ifNoneMatch, etag) != nullptr;
+}
@@ -0,0 +1,80 @@
+/*
+ * SmartIntercomStatus.h - Версионированный снимок статуса SmartIntercom
+ *
+ * Снимок хранит уже сериализованный JSON статуса в статическом буфере.
+ * Изменения состояния, конфигурации и WiFi только помечают снимок
+ * устаревшим; JSON пересобирается при первом запросе после этого,
+ * а все остальные запросы отдают готовый буфер без сериализации
+ * и выделения памяти.
+ *
+ * Номер поколения растет только при изменении содержимого. ETag
+ * строится из номера поколения и метки загрузки, поэтому клиент
+ * с актуальной копией получает 304, а после перезагрузки устройства
+ * старый ETag не совпадет случайно.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_STATUS_H
+#define SMARTINTERCOM_STATUS_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Status Snapshot Configuration
+#ifndef SMARTINTERCOM_STATUS_BUFFER_SIZE
+#define SMARTINTERCOM_STATUS_BUFFER_SIZE 256
+#endif
+
+#define SMARTINTERCOM_STATUS_ETAG_SIZE 24
+
+/*
+ * SmartIntercomStatusWriter - Сериализация статуса SmartIntercom
+ *
+ * Записывает JSON в out (не более size байт с нулем) и возвращает
+ * его длину, как snprintf(); длина не меньше size означает обрезку.
+ */
+typedef size_t (*SmartIntercomStatusWriter)(char* out, size_t size, void* context);
+
+/*
+ * SmartIntercomStatusSnapshot - Кэш статуса SmartIntercom с поколениями
+ */
+class SmartIntercomStatusSnapshot {
+private:
+  SmartIntercomStatusWriter smartIntercomWriter;
+  void* smartIntercomContext;
+  char smartIntercomJson[SMARTINTERCOM_STATUS_BUFFER_SIZE];
+  char smartIntercomScratch[SMARTINTERCOM_STATUS_BUFFER_SIZE];
+  size_t smartIntercomLength;
+  char smartIntercomETag[SMARTINTERCOM_STATUS_ETAG_SIZE];
+  uint32_t smartIntercomBootTag;
+  uint32_t smartIntercomGeneration;
+  uint32_t smartIntercomRebuilds;
+  bool smartIntercomDirty;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomRebuild();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomStatusSnapshot();
+
+  // SmartIntercom Initialization
+  void smartIntercomBegin(SmartIntercomStatusWriter writer, void* context);
+
+  // SmartIntercom Invalidation (дешево, можно вызывать из обработчиков событий)
+  void smartIntercomInvalidate() { smartIntercomDirty = true; }
+  bool smartIntercomIsDirty() { return smartIntercomDirty; }
+
+  // SmartIntercom Snapshot Access
+  const char* smartIntercomGetJson(size_t* length);
+  const char* smartIntercomGetETag();
+  bool smartIntercomMatches(const char* ifNoneMatch);
+
+  // SmartIntercom Snapshot Statistics
+  uint32_t smartIntercomGetGeneration() { return smartIntercomGeneration; }
+  uint32_t smartIntercomGetRebuilds() { return smartIntercomRebuilds; }
+};
+
+#endif // SMARTINTERCOM_STATUS_H
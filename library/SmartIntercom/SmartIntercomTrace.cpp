@@ -0,0 +1,558 @@
+/*
+ * SmartIntercomTrace.cpp - Запись и воспроизведение трасс АЦП SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomTrace.h"
+#include "SmartIntercomLog.h"
+#include <stddef.h>
+
+// SmartIntercom Blocks are copied to flash and to the HTTP response as raw bytes
+static_assert(sizeof(SmartIntercomTraceBlock) == SMARTINTERCOM_TRACE_BLOCK_SIZE,
+              "SmartIntercom trace block must fill a flash slot exactly");
+static_assert(offsetof(SmartIntercomTraceBlock, data) == SMARTINTERCOM_TRACE_BLOCK_HEADER,
+              "SmartIntercom trace block header layout changed");
+
+static const uint8_t SMARTINTERCOM_TRACE_MAGIC[4] = { 'S', 'I', 'T', 'R' };
+
+static uint32_t smartIntercomTraceGet32(const uint8_t* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t smartIntercomTraceGet16(const uint8_t* data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static void smartIntercomTracePut32(uint8_t* data, uint32_t value) {
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+  data[2] = (uint8_t)(value >> 16);
+  data[3] = (uint8_t)(value >> 24);
+}
+
+// ============================================================================
+// SmartIntercomTraceEncoder
+// ============================================================================
+
+SmartIntercomTraceEncoder::SmartIntercomTraceEncoder() {
+  smartIntercomBlock = nullptr;
+  smartIntercomLastValue = 0;
+  smartIntercomLastUs = 0;
+  smartIntercomRun = 0;
+}
+
+/*
+ * SmartIntercomTraceEncoder Begin
+ * Новый блок SmartIntercom с первым отсчетом, записанным целиком
+ */
+void SmartIntercomTraceEncoder::smartIntercomBegin(SmartIntercomTraceBlock* block, uint32_t sequence, uint16_t value,
+                                                   uint32_t timeUs, uint32_t periodUs, uint8_t flags) {
+  block->sequence = sequence;
+  block->startUs = timeUs;
+  block->periodUs = periodUs;
+  block->firstValue = value;
+  block->count = 1;
+  block->length = 0;
+  block->flags = flags;
+  block->reserved = 0;
+  smartIntercomBlock = block;
+  smartIntercomLastValue = value;
+  smartIntercomLastUs = timeUs;
+  smartIntercomRun = 0;
+}
+
+/*
+ * SmartIntercomTraceEncoder Append
+ * Следующий отсчет SmartIntercom разностью к предыдущему
+ */
+bool SmartIntercomTraceEncoder::smartIntercomAppend(uint16_t value, uint32_t timeUs) {
+  SmartIntercomTraceBlock* block = smartIntercomBlock;
+  if (block->length + SMARTINTERCOM_TRACE_SAMPLE_MAX > SMARTINTERCOM_TRACE_PAYLOAD ||
+      block->count == UINT16_MAX) {
+    return false;
+  }
+
+  int32_t delta = (int32_t)value - (int32_t)smartIntercomLastValue;
+  int32_t jitter = (int32_t)(timeUs - smartIntercomLastUs - block->periodUs);
+  if (delta == 0 && jitter == 0) {
+    if (++smartIntercomRun == SMARTINTERCOM_TRACE_RUN_MAX) {
+      smartIntercomFlushRun();
+    }
+  } else {
+    smartIntercomFlushRun();
+    if (jitter == 0 && delta >= -64 && delta <= 63) {
+      block->data[block->length++] = (uint8_t)(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+    } else {
+      block->data[block->length++] = SMARTINTERCOM_TRACE_ESCAPE;
+      smartIntercomPutVarint(delta);
+      smartIntercomPutVarint(jitter);
+    }
+  }
+
+  smartIntercomLastValue = value;
+  smartIntercomLastUs = timeUs;
+  block->count++;
+  return true;
+}
+
+/*
+ * SmartIntercomTraceEncoder Finish
+ * Дописать незакрытый повтор перед сохранением блока SmartIntercom
+ */
+void SmartIntercomTraceEncoder::smartIntercomFinish() {
+  smartIntercomFlushRun();
+}
+
+void SmartIntercomTraceEncoder::smartIntercomFlushRun() {
+  if (smartIntercomRun > 0) {
+    smartIntercomBlock->data[smartIntercomBlock->length++] = (uint8_t)(SMARTINTERCOM_TRACE_ESCAPE | smartIntercomRun);
+    smartIntercomRun = 0;
+  }
+}
+
+void SmartIntercomTraceEncoder::smartIntercomPutVarint(int32_t value) {
+  uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  do {
+    uint8_t byte = zigzag & 0x7F;
+    zigzag >>= 7;
+    smartIntercomBlock->data[smartIntercomBlock->length++] = zigzag ? (uint8_t)(byte | 0x80) : byte;
+  } while (zigzag);
+}
+
+// ============================================================================
+// SmartIntercomTraceReader
+// ============================================================================
+
+SmartIntercomTraceReader::SmartIntercomTraceReader(const uint8_t* data, size_t length) {
+  smartIntercomData = data;
+  smartIntercomLength = length;
+  smartIntercomOffset = 0;
+  smartIntercomBlockEnd = 0;
+  smartIntercomBlockLeft = 0;
+  smartIntercomRun = 0;
+  smartIntercomValue = 0;
+  smartIntercomTimeUs = 0;
+  smartIntercomPeriodUs = 0;
+  smartIntercomFlags = 0;
+  smartIntercomKeyPending = false;
+}
+
+bool SmartIntercomTraceReader::smartIntercomBegin() {
+  if (smartIntercomLength < SMARTINTERCOM_TRACE_FILE_HEADER ||
+      memcmp(smartIntercomData, SMARTINTERCOM_TRACE_MAGIC, sizeof(SMARTINTERCOM_TRACE_MAGIC)) != 0 ||
+      smartIntercomData[4] != SMARTINTERCOM_TRACE_VERSION) {
+    return false;
+  }
+  smartIntercomOffset = SMARTINTERCOM_TRACE_FILE_HEADER;
+  smartIntercomBlockEnd = SMARTINTERCOM_TRACE_FILE_HEADER;
+  smartIntercomBlockLeft = 0;
+  return true;
+}
+
+uint32_t SmartIntercomTraceReader::smartIntercomGetDeclaredSamples() {
+  return smartIntercomLength >= SMARTINTERCOM_TRACE_FILE_HEADER ? smartIntercomTraceGet32(smartIntercomData + 12) : 0;
+}
+
+/*
+ * SmartIntercomTraceReader Open Block
+ * Заголовок следующего блока SmartIntercom; false - конец или повреждение
+ */
+bool SmartIntercomTraceReader::smartIntercomOpenBlock() {
+  size_t offset = smartIntercomBlockEnd;
+  if (offset + SMARTINTERCOM_TRACE_BLOCK_HEADER > smartIntercomLength) {
+    return false;
+  }
+  const uint8_t* header = smartIntercomData + offset;
+  uint16_t count = smartIntercomTraceGet16(header + 14);
+  uint16_t length = smartIntercomTraceGet16(header + 16);
+  if (count == 0 || length > SMARTINTERCOM_TRACE_PAYLOAD ||
+      offset + SMARTINTERCOM_TRACE_BLOCK_HEADER + length > smartIntercomLength) {
+    return false;
+  }
+  smartIntercomTimeUs = smartIntercomTraceGet32(header + 4);
+  smartIntercomPeriodUs = smartIntercomTraceGet32(header + 8);
+  smartIntercomValue = smartIntercomTraceGet16(header + 12);
+  smartIntercomFlags = header[18];
+  smartIntercomOffset = offset + SMARTINTERCOM_TRACE_BLOCK_HEADER;
+  smartIntercomBlockEnd = smartIntercomOffset + length;
+  smartIntercomBlockLeft = count;
+  smartIntercomRun = 0;
+  smartIntercomKeyPending = true;
+  return true;
+}
+
+bool SmartIntercomTraceReader::smartIntercomGetVarint(int32_t* value) {
+  uint32_t zigzag = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (smartIntercomOffset >= smartIntercomBlockEnd) {
+      return false;
+    }
+    uint8_t byte = smartIntercomData[smartIntercomOffset++];
+    zigzag |= (uint32_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * SmartIntercomTraceReader Next
+ * Следующий отсчет SmartIntercom; false - трасса закончилась
+ */
+bool SmartIntercomTraceReader::smartIntercomNext(uint16_t* value, uint32_t* timeUs) {
+  while (true) {
+    if (smartIntercomBlockLeft == 0 && !smartIntercomOpenBlock()) {
+      return false;
+    }
+    if (smartIntercomKeyPending) {
+      smartIntercomKeyPending = false;
+      break;
+    }
+    if (smartIntercomRun > 0) {
+      smartIntercomRun--;
+      smartIntercomTimeUs += smartIntercomPeriodUs;
+      break;
+    }
+    if (smartIntercomOffset >= smartIntercomBlockEnd) {
+      return false;
+    }
+    uint8_t byte = smartIntercomData[smartIntercomOffset++];
+    if (byte < SMARTINTERCOM_TRACE_ESCAPE) {
+      smartIntercomValue = (uint16_t)(smartIntercomValue + ((byte >> 1) ^ -(int32_t)(byte & 1)));
+      smartIntercomTimeUs += smartIntercomPeriodUs;
+      break;
+    }
+    if (byte > SMARTINTERCOM_TRACE_ESCAPE) {
+      smartIntercomRun = byte & SMARTINTERCOM_TRACE_RUN_MAX;
+      continue;
+    }
+    int32_t delta = 0;
+    int32_t jitter = 0;
+    if (!smartIntercomGetVarint(&delta) || !smartIntercomGetVarint(&jitter)) {
+      return false;
+    }
+    smartIntercomValue = (uint16_t)(smartIntercomValue + delta);
+    smartIntercomTimeUs += smartIntercomPeriodUs + (uint32_t)jitter;
+    break;
+  }
+  smartIntercomBlockLeft--;
+  *value = smartIntercomValue;
+  *timeUs = smartIntercomTimeUs;
+  return true;
+}
+
+// ============================================================================
+// SmartIntercomTrace
+// ============================================================================
+
+SmartIntercomTrace::SmartIntercomTrace() {
+  memset(smartIntercomBlocks, 0xFF, sizeof(smartIntercomBlocks));
+  smartIntercomFlash = nullptr;
+  smartIntercomSlots = 0;
+  smartIntercomSlotsPerSector = 0;
+  smartIntercomFirst = 0;
+  smartIntercomHead = 0;
+  smartIntercomSamples = 0;
+  smartIntercomPeriodUs = 0;
+  smartIntercomLastUs = 0;
+  smartIntercomMode = SMARTINTERCOM_TRACE_RING;
+  smartIntercomRecording = false;
+  smartIntercomOpen = false;
+}
+
+/*
+ * SmartIntercomTrace Begin
+ * Подключение флеш-памяти SmartIntercom и поиск последней записи в ней
+ */
+void SmartIntercomTrace::smartIntercomBegin(SmartIntercomFlash* flash) {
+  smartIntercomFlash = nullptr;
+  smartIntercomSlots = 0;
+  if (flash != nullptr) {
+    smartIntercomSlotsPerSector = flash->smartIntercomGetSectorSize() / SMARTINTERCOM_TRACE_BLOCK_SIZE;
+    smartIntercomSlots = smartIntercomSlotsPerSector * flash->smartIntercomGetSectorCount();
+    if (flash->smartIntercomGetSectorCount() < 2 || smartIntercomSlotsPerSector == 0) {
+      SMARTINTERCOM_LOG_WARNING("SmartIntercom: Trace flash needs at least 2 sectors, using RAM only");
+      smartIntercomSlots = 0;
+    } else {
+      smartIntercomFlash = flash;
+      smartIntercomRestore();
+    }
+  }
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Trace ready, %lu blocks of %u bytes", (unsigned long)smartIntercomGetCapacity(),
+                         SMARTINTERCOM_TRACE_BLOCK_SIZE);
+}
+
+/*
+ * SmartIntercomTrace Restore
+ * Последняя запись SmartIntercom во флеш-памяти по номерам блоков
+ *
+ * Блоки с номерами старше head - slots уже перезаписаны; стертые
+ * и недописанные слоты пропускаются при скачивании.
+ */
+void SmartIntercomTrace::smartIntercomRestore() {
+  uint32_t headers[SMARTINTERCOM_TRACE_BLOCK_HEADER / 4];
+  SmartIntercomTraceBlock* header = reinterpret_cast<SmartIntercomTraceBlock*>(headers);
+  bool found = false;
+  uint32_t newest = 0;
+  for (uint32_t slot = 0; slot < smartIntercomSlots; slot++) {
+    if (!smartIntercomFlash->smartIntercomRead(slot / smartIntercomSlotsPerSector,
+                                               (slot % smartIntercomSlotsPerSector) * SMARTINTERCOM_TRACE_BLOCK_SIZE,
+                                               headers, sizeof(headers))) {
+      continue;
+    }
+    if (header->sequence != UINT32_MAX && header->count > 0 && header->length <= SMARTINTERCOM_TRACE_PAYLOAD &&
+        header->sequence % smartIntercomSlots == slot && (!found || header->sequence > newest)) {
+      newest = header->sequence;
+      found = true;
+    }
+  }
+  if (!found) {
+    return;
+  }
+
+  smartIntercomHead = newest + 1;
+  smartIntercomFirst = smartIntercomHead > smartIntercomSlots ? smartIntercomHead - smartIntercomSlots : 0;
+  smartIntercomSamples = 0;
+  uint32_t first = smartIntercomHead;
+  for (uint32_t sequence = smartIntercomFirst; sequence < smartIntercomHead; sequence++) {
+    uint32_t slot = sequence % smartIntercomSlots;
+    if (smartIntercomFlash->smartIntercomRead(slot / smartIntercomSlotsPerSector,
+                                              (slot % smartIntercomSlotsPerSector) * SMARTINTERCOM_TRACE_BLOCK_SIZE,
+                                              headers, sizeof(headers)) &&
+        header->sequence == sequence) {
+      smartIntercomSamples += header->count;
+      if (first == smartIntercomHead) {
+        first = sequence;
+      }
+    }
+  }
+  smartIntercomFirst = first;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Trace restored from flash, %lu blocks, %lu samples",
+                         (unsigned long)(smartIntercomHead - smartIntercomFirst), (unsigned long)smartIntercomSamples);
+}
+
+uint32_t SmartIntercomTrace::smartIntercomGetCapacity() {
+  return smartIntercomFlash != nullptr ? smartIntercomSlots : SMARTINTERCOM_TRACE_RAM_BLOCKS;
+}
+
+/*
+ * SmartIntercomTrace Start
+ * Новая запись SmartIntercom; прошлая запись больше не скачивается
+ *
+ * Со флеш-памятью запись начинается с начала сектора: слоты пишутся
+ * только в стертый сектор.
+ */
+void SmartIntercomTrace::smartIntercomStart(SmartIntercomTraceMode mode) {
+  smartIntercomStop();
+  if (smartIntercomFlash != nullptr && smartIntercomHead % smartIntercomSlotsPerSector != 0) {
+    smartIntercomHead += smartIntercomSlotsPerSector - smartIntercomHead % smartIntercomSlotsPerSector;
+  }
+  smartIntercomFirst = smartIntercomHead;
+  smartIntercomSamples = 0;
+  smartIntercomPeriodUs = 0;
+  smartIntercomMode = mode;
+  smartIntercomRecording = true;
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: Trace capture started (%s)",
+                         mode == SMARTINTERCOM_TRACE_RING ? "ring" : "oneshot");
+}
+
+/*
+ * SmartIntercomTrace Stop
+ * Остановить запись SmartIntercom и сохранить неполный блок
+ */
+void SmartIntercomTrace::smartIntercomStop() {
+  if (smartIntercomOpen) {
+    smartIntercomCloseBlock();
+  }
+  if (smartIntercomRecording) {
+    smartIntercomRecording = false;
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: Trace capture stopped, %lu samples in %lu blocks",
+                           (unsigned long)smartIntercomSamples, (unsigned long)(smartIntercomHead - smartIntercomFirst));
+  }
+}
+
+/*
+ * SmartIntercomTrace Clear
+ * Забыть запись SmartIntercom (флеш-память не стирается: после
+ * перезагрузки она снова найдется, пока ее не перекроет новая запись)
+ */
+void SmartIntercomTrace::smartIntercomClear() {
+  smartIntercomStop();
+  smartIntercomFirst = smartIntercomHead;
+  smartIntercomSamples = 0;
+}
+
+SmartIntercomTraceBlock* SmartIntercomTrace::smartIntercomGetOpenBlock() {
+  return &smartIntercomBlocks[smartIntercomHead % SMARTINTERCOM_TRACE_RAM_BLOCKS];
+}
+
+/*
+ * SmartIntercomTrace Open Block
+ * Следующий блок SmartIntercom: освободить место в кольце или
+ * остановить однократную запись
+ */
+bool SmartIntercomTrace::smartIntercomOpenBlock(uint16_t value, uint32_t timeUs, uint8_t flags) {
+  uint32_t capacity = smartIntercomGetCapacity();
+  if (smartIntercomMode == SMARTINTERCOM_TRACE_ONESHOT && smartIntercomHead - smartIntercomFirst >= capacity) {
+    smartIntercomStop();
+    return false;
+  }
+
+  if (smartIntercomFlash != nullptr) {
+    if (smartIntercomHead % smartIntercomSlotsPerSector == 0) {
+      // SmartIntercom Entering a sector: its previous blocks are lost, then it is erased for the new ones
+      if (smartIntercomHead + smartIntercomSlotsPerSector > smartIntercomFirst + capacity) {
+        smartIntercomDropBlocks(smartIntercomHead + smartIntercomSlotsPerSector - capacity);
+      }
+      smartIntercomFlash->smartIntercomErase((smartIntercomHead % smartIntercomSlots) / smartIntercomSlotsPerSector);
+    }
+  } else if (smartIntercomHead - smartIntercomFirst >= capacity) {
+    smartIntercomDropBlocks(smartIntercomHead - capacity + 1);
+  }
+
+  smartIntercomEncoder.smartIntercomBegin(smartIntercomGetOpenBlock(), smartIntercomHead, value, timeUs,
+                                          smartIntercomPeriodUs, flags);
+  smartIntercomOpen = true;
+  return true;
+}
+
+/*
+ * SmartIntercomTrace Drop Blocks
+ * Вытеснить из кольца SmartIntercom блоки до first (до их перезаписи)
+ */
+void SmartIntercomTrace::smartIntercomDropBlocks(uint32_t first) {
+  SmartIntercomTraceBlock buffer;
+  for (; smartIntercomFirst < first; smartIntercomFirst++) {
+    const SmartIntercomTraceBlock* block = smartIntercomLoadBlock(smartIntercomFirst, &buffer);
+    if (block != nullptr) {
+      smartIntercomSamples -= block->count;
+    }
+  }
+}
+
+/*
+ * SmartIntercomTrace Close Block
+ * Блок SmartIntercom готов: он остается в RAM и копируется во флеш-память
+ */
+void SmartIntercomTrace::smartIntercomCloseBlock() {
+  smartIntercomEncoder.smartIntercomFinish();
+  if (smartIntercomFlash != nullptr) {
+    uint32_t slot = smartIntercomHead % smartIntercomSlots;
+    smartIntercomFlash->smartIntercomWrite(slot / smartIntercomSlotsPerSector,
+                                           (slot % smartIntercomSlotsPerSector) * SMARTINTERCOM_TRACE_BLOCK_SIZE,
+                                           reinterpret_cast<const uint32_t*>(smartIntercomGetOpenBlock()),
+                                           SMARTINTERCOM_TRACE_BLOCK_SIZE);
+  }
+  smartIntercomOpen = false;
+  smartIntercomHead++;
+}
+
+/*
+ * SmartIntercomTrace Record
+ * Отсчет SmartIntercom в открытый блок; новый блок, когда этот полон
+ */
+void SmartIntercomTrace::smartIntercomRecord(uint16_t value, uint32_t timeUs, uint32_t periodUs) {
+  if (!smartIntercomRecording) {
+    return;
+  }
+  uint8_t flags = periodUs > 0 ? SMARTINTERCOM_TRACE_SAMPLED : 0;
+
+  if (!smartIntercomOpen) {
+    if (periodUs > 0) {
+      smartIntercomPeriodUs = periodUs;
+    }
+    if (smartIntercomOpenBlock(value, timeUs, flags)) {
+      smartIntercomLastUs = timeUs;
+      smartIntercomSamples++;
+    }
+    return;
+  }
+
+  if (smartIntercomPeriodUs == 0) {
+    // SmartIntercom Polled input: the first step becomes the nominal period
+    smartIntercomPeriodUs = timeUs - smartIntercomLastUs;
+    smartIntercomGetOpenBlock()->periodUs = smartIntercomPeriodUs;
+  }
+  smartIntercomLastUs = timeUs;
+  if (!smartIntercomEncoder.smartIntercomAppend(value, timeUs)) {
+    smartIntercomCloseBlock();
+    if (!smartIntercomOpenBlock(value, timeUs, flags)) {
+      return;
+    }
+  }
+  smartIntercomSamples++;
+}
+
+/*
+ * SmartIntercomTrace Load Block
+ * Блок SmartIntercom по номеру: из RAM, если он еще там, иначе из флеш-памяти
+ */
+const SmartIntercomTraceBlock* SmartIntercomTrace::smartIntercomLoadBlock(uint32_t sequence,
+                                                                         SmartIntercomTraceBlock* buffer) {
+  const SmartIntercomTraceBlock* block = &smartIntercomBlocks[sequence % SMARTINTERCOM_TRACE_RAM_BLOCKS];
+  if (block->sequence == sequence) {
+    return block;
+  }
+  if (smartIntercomFlash == nullptr) {
+    return nullptr;
+  }
+  uint32_t slot = sequence % smartIntercomSlots;
+  if (!smartIntercomFlash->smartIntercomRead(slot / smartIntercomSlotsPerSector,
+                                             (slot % smartIntercomSlotsPerSector) * SMARTINTERCOM_TRACE_BLOCK_SIZE,
+                                             reinterpret_cast<uint32_t*>(buffer), SMARTINTERCOM_TRACE_BLOCK_SIZE) ||
+      buffer->sequence != sequence || buffer->count == 0 || buffer->length > SMARTINTERCOM_TRACE_PAYLOAD) {
+    return nullptr;
+  }
+  return buffer;
+}
+
+/*
+ * SmartIntercomTrace Write File
+ * Файл трассы SmartIntercom по частям: заголовок, затем целые блоки
+ *
+ * Курсор - 0 до заголовка, дальше номер следующего блока от первого
+ * плюс один. Пропавшие блоки (стертый сектор) пропускаются.
+ */
+size_t SmartIntercomTrace::smartIntercomWriteFile(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomTrace* trace = static_cast<SmartIntercomTrace*>(context);
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(out);
+  size_t used = 0;
+  if (trace->smartIntercomRecording) {
+    return 0;
+  }
+
+  if (*cursor == 0) {
+    if (size < SMARTINTERCOM_TRACE_FILE_HEADER) {
+      return 0;
+    }
+    memcpy(bytes, SMARTINTERCOM_TRACE_MAGIC, sizeof(SMARTINTERCOM_TRACE_MAGIC));
+    bytes[4] = SMARTINTERCOM_TRACE_VERSION;
+    bytes[5] = 0;
+    bytes[6] = 0;
+    bytes[7] = 0;
+    smartIntercomTracePut32(bytes + 8, trace->smartIntercomHead - trace->smartIntercomFirst);
+    smartIntercomTracePut32(bytes + 12, trace->smartIntercomSamples);
+    used = SMARTINTERCOM_TRACE_FILE_HEADER;
+    *cursor = 1;
+  }
+
+  SmartIntercomTraceBlock buffer;
+  while (*cursor - 1 < trace->smartIntercomHead - trace->smartIntercomFirst) {
+    const SmartIntercomTraceBlock* block = trace->smartIntercomLoadBlock(trace->smartIntercomFirst + *cursor - 1,
+                                                                         &buffer);
+    if (block != nullptr) {
+      size_t length = SMARTINTERCOM_TRACE_BLOCK_HEADER + block->length;
+      if (used + length > size) {
+        break;
+      }
+      memcpy(bytes + used, block, length);
+      used += length;
+    }
+    (*cursor)++;
+  }
+  return used;
+}
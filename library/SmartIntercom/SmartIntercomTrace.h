@@ -0,0 +1,205 @@
+/*
+ * SmartIntercomTrace.h - Запись и воспроизведение трасс АЦП SmartIntercom
+ *
+ * Трасса - отсчеты входа звонка с временем в микросекундах, в том виде,
+ * в каком их видит SmartIntercomRing. Запись включается по запросу
+ * (в том числе кольцом, которое хранит последние минуты и
+ * останавливается после жалобы "звонили, а домофон не заметил"),
+ * скачивается через GET /api/trace и прогоняется на хосте через
+ * настоящий детектор звонка (host/sim/smartintercom_replay).
+ *
+ * Формат (little-endian):
+ *
+ *   Заголовок файла, 16 байт: "SITR", версия, флаги, резерв (2),
+ *   число блоков (4), число отсчетов (4).
+ *
+ *   Блоки по порядку: заголовок блока (SMARTINTERCOM_TRACE_BLOCK_HEADER
+ *   байт: номер, время и значение первого отсчета, номинальный период,
+ *   число отсчетов, длина данных, флаги) и length байт данных.
+ *   Первый отсчет блока хранится целиком, остальные - разностями:
+ *
+ *     0x00-0x7F  разность значения -64..63 (zigzag), шаг = период
+ *     0x81-0xFF  повтор значения 1..127 раз, шаг = период
+ *     0x80       разность значения и отклонение шага от периода,
+ *                два varint zigzag
+ *
+ * Каждый блок декодируется независимо, поэтому кольцо блоков в RAM
+ * или во флеш-памяти теряет при перезаписи только самые старые блоки.
+ * Звонок уровнем и тишина занимают около байта на отсчет и меньше,
+ * звонок тоном 1-3 байта.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_TRACE_H
+#define SMARTINTERCOM_TRACE_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomConfigStore.h"
+
+// SmartIntercom Trace Configuration
+#ifndef SMARTINTERCOM_TRACE_RAM_BLOCKS
+#define SMARTINTERCOM_TRACE_RAM_BLOCKS 16         // Блоков в RAM (со флеш-памятью хватает 1)
+#endif
+
+#define SMARTINTERCOM_TRACE_VERSION 1
+#define SMARTINTERCOM_TRACE_FILE_HEADER 16
+#define SMARTINTERCOM_TRACE_BLOCK_SIZE 256
+#define SMARTINTERCOM_TRACE_BLOCK_HEADER 20
+#define SMARTINTERCOM_TRACE_PAYLOAD (SMARTINTERCOM_TRACE_BLOCK_SIZE - SMARTINTERCOM_TRACE_BLOCK_HEADER)
+#define SMARTINTERCOM_TRACE_ESCAPE 0x80
+#define SMARTINTERCOM_TRACE_RUN_MAX 127
+#define SMARTINTERCOM_TRACE_SAMPLE_MAX 12         // Худший случай: повтор + escape + два varint
+
+// SmartIntercom Trace Block Flags
+#define SMARTINTERCOM_TRACE_SAMPLED 0x01          // Выборка по таймеру (иначе опрос из loop())
+
+// SmartIntercom Trace Modes
+enum SmartIntercomTraceMode {
+  SMARTINTERCOM_TRACE_RING,                       // Кольцо: новые блоки вытесняют старые
+  SMARTINTERCOM_TRACE_ONESHOT                     // Однократно: остановка при заполнении
+};
+
+/*
+ * SmartIntercomTraceBlock - Блок трассы SmartIntercom (RAM и слот флеш-памяти)
+ */
+struct SmartIntercomTraceBlock {
+  uint32_t sequence;                // SmartIntercom номер блока с начала записи
+  uint32_t startUs;                 // SmartIntercom время первого отсчета
+  uint32_t periodUs;                // SmartIntercom номинальный шаг отсчетов
+  uint16_t firstValue;              // SmartIntercom значение первого отсчета
+  uint16_t count;                   // SmartIntercom отсчетов в блоке
+  uint16_t length;                  // SmartIntercom байт в data
+  uint8_t flags;                    // SmartIntercom SMARTINTERCOM_TRACE_SAMPLED
+  uint8_t reserved;
+  uint8_t data[SMARTINTERCOM_TRACE_PAYLOAD];
+};
+
+/*
+ * SmartIntercomTraceEncoder - Разностное кодирование блока трассы SmartIntercom
+ */
+class SmartIntercomTraceEncoder {
+private:
+  SmartIntercomTraceBlock* smartIntercomBlock;
+  uint16_t smartIntercomLastValue;
+  uint32_t smartIntercomLastUs;
+  uint8_t smartIntercomRun;
+
+  // SmartIntercom Internal Methods
+  void smartIntercomFlushRun();
+  void smartIntercomPutVarint(int32_t value);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomTraceEncoder();
+
+  // SmartIntercom Block Encoding (false из Append - блок полон, отсчет не записан)
+  void smartIntercomBegin(SmartIntercomTraceBlock* block, uint32_t sequence, uint16_t value, uint32_t timeUs,
+                          uint32_t periodUs, uint8_t flags);
+  bool smartIntercomAppend(uint16_t value, uint32_t timeUs);
+  void smartIntercomFinish();
+};
+
+/*
+ * SmartIntercomTraceReader - Чтение файла трассы SmartIntercom из памяти
+ *
+ * Отсчеты всех блоков подряд; поврежденный блок прерывает чтение.
+ */
+class SmartIntercomTraceReader {
+private:
+  const uint8_t* smartIntercomData;
+  size_t smartIntercomLength;
+  size_t smartIntercomOffset;
+  size_t smartIntercomBlockEnd;
+  uint16_t smartIntercomBlockLeft;
+  uint16_t smartIntercomRun;
+  uint16_t smartIntercomValue;
+  uint32_t smartIntercomTimeUs;
+  uint32_t smartIntercomPeriodUs;
+  uint8_t smartIntercomFlags;
+  bool smartIntercomKeyPending;
+
+  // SmartIntercom Internal Methods
+  bool smartIntercomOpenBlock();
+  bool smartIntercomGetVarint(int32_t* value);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomTraceReader(const uint8_t* data, size_t length);
+
+  // SmartIntercom Reading (false из Begin - не файл трассы)
+  bool smartIntercomBegin();
+  bool smartIntercomNext(uint16_t* value, uint32_t* timeUs);
+
+  // SmartIntercom Trace Properties (по текущему блоку)
+  uint32_t smartIntercomGetPeriodUs() { return smartIntercomPeriodUs; }
+  bool smartIntercomIsSampled() { return (smartIntercomFlags & SMARTINTERCOM_TRACE_SAMPLED) != 0; }
+  uint32_t smartIntercomGetDeclaredSamples();
+};
+
+/*
+ * SmartIntercomTrace - Запись трассы АЦП SmartIntercom
+ *
+ * Без флеш-памяти блоки лежат в кольце SMARTINTERCOM_TRACE_RAM_BLOCKS
+ * блоков в RAM. С флеш-памятью заполненный блок еще и копируется в
+ * очередной слот (SMARTINTERCOM_TRACE_BLOCK_SIZE байт) ее секторов,
+ * сектор стирается при входе в него, и после перезагрузки последняя
+ * запись находится по номерам блоков и доступна для скачивания.
+ *
+ * smartIntercomRecord() вызывается из главного цикла (SmartIntercomRing),
+ * не из прерывания.
+ */
+class SmartIntercomTrace {
+private:
+  SmartIntercomTraceBlock smartIntercomBlocks[SMARTINTERCOM_TRACE_RAM_BLOCKS];
+  SmartIntercomTraceEncoder smartIntercomEncoder;
+  SmartIntercomFlash* smartIntercomFlash;
+  uint32_t smartIntercomSlots;
+  uint32_t smartIntercomSlotsPerSector;
+  uint32_t smartIntercomFirst;
+  uint32_t smartIntercomHead;
+  uint32_t smartIntercomSamples;
+  uint32_t smartIntercomPeriodUs;
+  uint32_t smartIntercomLastUs;
+  SmartIntercomTraceMode smartIntercomMode;
+  bool smartIntercomRecording;
+  bool smartIntercomOpen;
+
+  // SmartIntercom Internal Methods
+  uint32_t smartIntercomGetCapacity();
+  SmartIntercomTraceBlock* smartIntercomGetOpenBlock();
+  bool smartIntercomOpenBlock(uint16_t value, uint32_t timeUs, uint8_t flags);
+  void smartIntercomCloseBlock();
+  void smartIntercomDropBlocks(uint32_t first);
+  const SmartIntercomTraceBlock* smartIntercomLoadBlock(uint32_t sequence, SmartIntercomTraceBlock* buffer);
+  void smartIntercomRestore();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomTrace();
+
+  // SmartIntercom Initialization (flash == nullptr - только RAM)
+  void smartIntercomBegin(SmartIntercomFlash* flash = nullptr);
+
+  // SmartIntercom Capture Control (start стирает прошлую запись)
+  void smartIntercomStart(SmartIntercomTraceMode mode = SMARTINTERCOM_TRACE_RING);
+  void smartIntercomStop();
+  void smartIntercomClear();
+  bool smartIntercomIsRecording() { return smartIntercomRecording; }
+
+  // SmartIntercom Sample Input (periodUs = 0 - опрос, шаг берется из первых отсчетов)
+  void smartIntercomRecord(uint16_t value, uint32_t timeUs, uint32_t periodUs);
+
+  // SmartIntercom Trace State
+  uint32_t smartIntercomGetSamples() { return smartIntercomSamples; }
+  uint32_t smartIntercomGetBlocks() { return smartIntercomHead - smartIntercomFirst; }
+  uint32_t smartIntercomGetCapacityBlocks() { return smartIntercomGetCapacity(); }
+  bool smartIntercomHasFlash() { return smartIntercomFlash != nullptr; }
+
+  // SmartIntercom Trace File (генератор тела GET /api/trace, только после stop)
+  static size_t smartIntercomWriteFile(char* out, size_t size, uint32_t* cursor, void* context);
+};
+
+#endif // SMARTINTERCOM_TRACE_H
@@ -0,0 +1,306 @@
+/*
+ * SmartIntercomWatchdog.cpp - Реализация сторожа главного цикла SmartIntercom
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomWatchdog.h"
+#include "SmartIntercomLog.h"
+
+/*
+ * SmartIntercom Sample PC
+ * Адрес прерванной команды SmartIntercom (EPC1 прерывания уровня 1 на ESP8266)
+ */
+static inline uint32_t IRAM_ATTR smartIntercomSamplePC() {
+#if defined(ESP8266)
+  uint32_t pc;
+  __asm__ __volatile__("rsr %0, epc1" : "=r"(pc));
+  return pc;
+#else
+  return 0;
+#endif
+}
+
+/*
+ * SmartIntercomWatchdog Constructor
+ */
+SmartIntercomWatchdog::SmartIntercomWatchdog() {
+  smartIntercomStallLog = &smartIntercomRamLog;
+  smartIntercomRamLog.magic = 0;
+  smartIntercomSampleUs = SMARTINTERCOM_WATCHDOG_SAMPLE_US;
+  smartIntercomBudgetUs = SMARTINTERCOM_WATCHDOG_BUDGET_MS * 1000UL;
+  smartIntercomTimeoutUs = 0;
+  smartIntercomDecimation = 1;
+  smartIntercomExpired = false;
+  smartIntercomClear();
+}
+
+/*
+ * SmartIntercomWatchdog Begin
+ * Журнал SmartIntercom с чужой сигнатурой начинается заново; запись,
+ * открытая в прошлой загрузке, закрывается с флагом reset
+ */
+void SmartIntercomWatchdog::smartIntercomBegin(unsigned long timerPeriodUs, SmartIntercomWatchdogLog* log) {
+  smartIntercomEnd();
+  smartIntercomStallLog = log != nullptr ? log : &smartIntercomRamLog;
+
+  if (smartIntercomStallLog->magic != SMARTINTERCOM_WATCHDOG_MAGIC) {
+    smartIntercomStallLog->boots = 0;
+    smartIntercomClearLog();
+    smartIntercomStallLog->magic = SMARTINTERCOM_WATCHDOG_MAGIC;
+  }
+  for (uint8_t i = 0; i < SMARTINTERCOM_WATCHDOG_RECORDS; i++) {
+    SmartIntercomWatchdogStall& stall = smartIntercomStallLog->stalls[i];
+    uint32_t info = stall.info;
+    if (info & (SMARTINTERCOM_WATCHDOG_OPEN << 8)) {
+      stall.info = (info & ~(SMARTINTERCOM_WATCHDOG_OPEN << 8)) | (SMARTINTERCOM_WATCHDOG_RESET << 8);
+      SMARTINTERCOM_LOG_WARNING("SmartIntercom: Reset during a %s stall of %lu ms",
+                                smartIntercomGetPhaseName(info & 0xFF), (unsigned long)stall.durationMs);
+    }
+  }
+  smartIntercomStallLog->boots = smartIntercomStallLog->boots + 1;
+
+  uint32_t period = timerPeriodUs > 0 ? timerPeriodUs : SMARTINTERCOM_WATCHDOG_SAMPLE_US;
+  uint32_t decimation = SMARTINTERCOM_WATCHDOG_SAMPLE_US / period;
+  smartIntercomDecimation = decimation > 0 ? (decimation < 0xFFFF ? (uint16_t)decimation : 0xFFFF) : 1;
+  smartIntercomSampleUs = period * smartIntercomDecimation;
+  smartIntercomTicks = 0;
+  smartIntercomSeenMarks = smartIntercomPhaseMarks;
+  smartIntercomStallUs = 0;
+  smartIntercomStallOpen = false;
+  smartIntercomExpired = false;
+  smartIntercomSetTimerHook(smartIntercomTick, this);
+}
+
+void SmartIntercomWatchdog::smartIntercomEnd() {
+  smartIntercomSetTimerHook(nullptr, nullptr);
+}
+
+/*
+ * SmartIntercomWatchdog Clear
+ */
+void SmartIntercomWatchdog::smartIntercomClear() {
+  smartIntercomTicks = 0;
+  smartIntercomSeenMarks = smartIntercomPhaseMarks;
+  smartIntercomStallUs = 0;
+  smartIntercomStallIndex = 0;
+  smartIntercomStallOpen = false;
+  smartIntercomTotalSamples = 0;
+  for (uint8_t phase = 0; phase < SMARTINTERCOM_PHASES; phase++) {
+    smartIntercomSamples[phase] = 0;
+    smartIntercomStalls[phase] = 0;
+    smartIntercomMaxStallMs[phase] = 0;
+    smartIntercomPCs[phase] = 0;
+  }
+  smartIntercomClearLog();
+}
+
+void SmartIntercomWatchdog::smartIntercomClearLog() {
+  smartIntercomStallLog->head = 0;
+  smartIntercomStallLog->reserved = 0;
+  for (uint8_t i = 0; i < SMARTINTERCOM_WATCHDOG_RECORDS; i++) {
+    smartIntercomStallLog->stalls[i].startMs = 0;
+    smartIntercomStallLog->stalls[i].durationMs = 0;
+    smartIntercomStallLog->stalls[i].info = 0;
+    smartIntercomStallLog->stalls[i].pc = 0;
+  }
+}
+
+// ============================================================================
+// SmartIntercom Sampler (прерывание таймера)
+// ============================================================================
+
+void IRAM_ATTR SmartIntercomWatchdog::smartIntercomTick(void* context) {
+  SmartIntercomWatchdog* watchdog = static_cast<SmartIntercomWatchdog*>(context);
+  uint16_t ticks = watchdog->smartIntercomTicks + 1;
+  if (ticks < watchdog->smartIntercomDecimation) {
+    watchdog->smartIntercomTicks = ticks;
+    return;
+  }
+  watchdog->smartIntercomTicks = 0;
+  watchdog->smartIntercomSample();
+}
+
+/*
+ * SmartIntercomWatchdog Sample
+ * Отсчет SmartIntercom: профиль фазы, затем проверка зависания
+ *
+ * Любая отметка фазы с прошлого отсчета закрывает зависание; без
+ * отметок время копится, и после бюджета запись журнала открывается
+ * и обновляется на каждом отсчете, пока фаза не сменится.
+ */
+void IRAM_ATTR SmartIntercomWatchdog::smartIntercomSample() {
+  uint32_t marks = smartIntercomPhaseMarks;
+  uint8_t phase = smartIntercomPhase;
+  uint32_t pc = smartIntercomSamplePC();
+  if (phase >= SMARTINTERCOM_PHASES) {
+    return;
+  }
+  smartIntercomTotalSamples = smartIntercomTotalSamples + 1;
+  smartIntercomSamples[phase] = smartIntercomSamples[phase] + 1;
+  smartIntercomPCs[phase] = pc;
+
+  SmartIntercomWatchdogStall& stall = smartIntercomStallLog->stalls[smartIntercomStallIndex];
+  if (marks != smartIntercomSeenMarks || phase == SMARTINTERCOM_PHASE_IDLE) {
+    if (smartIntercomStallOpen) {
+      stall.info = stall.info & ~(SMARTINTERCOM_WATCHDOG_OPEN << 8);
+      smartIntercomStallOpen = false;
+    }
+    smartIntercomSeenMarks = marks;
+    smartIntercomStallUs = 0;
+    return;
+  }
+
+  uint32_t stallUs = smartIntercomStallUs + smartIntercomSampleUs;
+  smartIntercomStallUs = stallUs;
+  if (stallUs <= smartIntercomBudgetUs) {
+    return;
+  }
+  uint32_t stallMs = stallUs / 1000UL;
+  uint8_t flags = SMARTINTERCOM_WATCHDOG_OPEN;
+  if (smartIntercomTimeoutUs > 0 && stallUs >= smartIntercomTimeoutUs) {
+    flags |= SMARTINTERCOM_WATCHDOG_TIMEOUT;
+    smartIntercomExpired = true;
+  }
+
+  if (!smartIntercomStallOpen) {
+    uint32_t head = smartIntercomStallLog->head;
+    smartIntercomStallIndex = head % SMARTINTERCOM_WATCHDOG_RECORDS;
+    SmartIntercomWatchdogStall& opened = smartIntercomStallLog->stalls[smartIntercomStallIndex];
+    opened.startMs = smartIntercomMillis() - stallMs;
+    opened.durationMs = stallMs;
+    opened.pc = pc;
+    opened.info = phase | ((uint32_t)flags << 8) | ((smartIntercomStallLog->boots & 0xFFFF) << 16);
+    smartIntercomStallLog->head = head + 1;
+    smartIntercomStallOpen = true;
+    smartIntercomStalls[phase] = smartIntercomStalls[phase] + 1;
+  } else {
+    stall.durationMs = stallMs;
+    stall.pc = pc;
+    stall.info = stall.info | ((uint32_t)flags << 8);
+  }
+  if (stallMs > smartIntercomMaxStallMs[phase]) {
+    smartIntercomMaxStallMs[phase] = stallMs;
+  }
+}
+
+// ============================================================================
+// SmartIntercom Profile and Log Queries
+// ============================================================================
+
+uint32_t SmartIntercomWatchdog::smartIntercomGetSamples(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomSamples[phase] : 0;
+}
+
+uint32_t SmartIntercomWatchdog::smartIntercomGetStalls(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomStalls[phase] : 0;
+}
+
+uint32_t SmartIntercomWatchdog::smartIntercomGetMaxStall(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomMaxStallMs[phase] : 0;
+}
+
+uint32_t SmartIntercomWatchdog::smartIntercomGetPC(uint8_t phase) {
+  return phase < SMARTINTERCOM_PHASES ? smartIntercomPCs[phase] : 0;
+}
+
+const char* SmartIntercomWatchdog::smartIntercomGetPhaseName(uint8_t phase) {
+  return ::smartIntercomGetPhaseName(phase);
+}
+
+uint32_t SmartIntercomWatchdog::smartIntercomGetStallCount() {
+  uint32_t head = smartIntercomStallLog->head;
+  return head < SMARTINTERCOM_WATCHDOG_RECORDS ? head : SMARTINTERCOM_WATCHDOG_RECORDS;
+}
+
+/*
+ * SmartIntercomWatchdog Get Stall
+ * Копия записи SmartIntercom (открытая запись может меняться в прерывании)
+ */
+bool SmartIntercomWatchdog::smartIntercomGetStall(uint32_t index, SmartIntercomWatchdogStall* stall) {
+  uint32_t head = smartIntercomStallLog->head;
+  uint32_t count = smartIntercomGetStallCount();
+  if (index >= count) {
+    return false;
+  }
+  const SmartIntercomWatchdogStall& record = smartIntercomStallLog->stalls[(head - count + index) % SMARTINTERCOM_WATCHDOG_RECORDS];
+  stall->startMs = record.startMs;
+  stall->durationMs = record.durationMs;
+  stall->info = record.info;
+  stall->pc = record.pc;
+  return true;
+}
+
+/*
+ * SmartIntercomWatchdog Write JSON
+ * Тело GET /api/watchdog по одному объекту за шаг курсора:
+ * заголовок, фазы, затем записи журнала от старой к новой
+ *
+ * Число записей запоминается в старших битах курсора на первом шаге,
+ * чтобы зависание во время ответа не сломало JSON.
+ */
+size_t SmartIntercomWatchdog::smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context) {
+  SmartIntercomWatchdog* watchdog = static_cast<SmartIntercomWatchdog*>(context);
+  if (*cursor == 0) {
+    *cursor = watchdog->smartIntercomGetStallCount() << 24;
+  }
+  uint32_t count = *cursor >> 24;
+  uint32_t stallsAt = SMARTINTERCOM_PHASES + 1;
+  size_t used = 0;
+
+  while ((*cursor & 0xFFFFFF) <= stallsAt + count) {
+    uint32_t position = *cursor & 0xFFFFFF;
+    char* item = out + used;
+    size_t space = size - used;
+    int written;
+    if (position == 0) {
+      written = snprintf(item, space,
+                         "{\"budget_ms\":%lu,\"timeout_ms\":%lu,\"sample_us\":%lu,\"boots\":%lu,\"samples\":%lu,"
+                         "\"expired\":%s,\"phases\":[",
+                         watchdog->smartIntercomGetBudget(), watchdog->smartIntercomGetTimeout(),
+                         (unsigned long)watchdog->smartIntercomSampleUs, (unsigned long)watchdog->smartIntercomGetBoots(),
+                         (unsigned long)watchdog->smartIntercomTotalSamples,
+                         watchdog->smartIntercomExpired ? "true" : "false");
+    } else if (position <= SMARTINTERCOM_PHASES) {
+      uint8_t phase = (uint8_t)(position - 1);
+      uint32_t total = watchdog->smartIntercomTotalSamples;
+      uint32_t samples = watchdog->smartIntercomSamples[phase];
+      written = snprintf(item, space,
+                         "%s{\"phase\":\"%s\",\"samples\":%lu,\"permille\":%lu,\"stalls\":%lu,\"max_ms\":%lu,"
+                         "\"pc\":\"0x%08lx\"}",
+                         phase > 0 ? "," : "", smartIntercomGetPhaseName(phase), (unsigned long)samples,
+                         total > 0 ? (unsigned long)((uint64_t)samples * 1000 / total) : 0UL,
+                         (unsigned long)watchdog->smartIntercomStalls[phase],
+                         (unsigned long)watchdog->smartIntercomMaxStallMs[phase],
+                         (unsigned long)watchdog->smartIntercomPCs[phase]);
+    } else if (position == stallsAt + count) {
+      written = snprintf(item, space, "%s]}", count > 0 ? "" : "],\"stalls\":[");
+    } else {
+      SmartIntercomWatchdogStall stall;
+      uint32_t index = position - stallsAt;
+      if (!watchdog->smartIntercomGetStall(index + watchdog->smartIntercomGetStallCount() - count, &stall)) {
+        stall.startMs = 0;
+        stall.durationMs = 0;
+        stall.info = 0;
+        stall.pc = 0;
+      }
+      uint8_t flags = (uint8_t)(stall.info >> 8);
+      written = snprintf(item, space,
+                         "%s{\"boot\":%lu,\"phase\":\"%s\",\"start_ms\":%lu,\"duration_ms\":%lu,\"pc\":\"0x%08lx\","
+                         "\"open\":%s,\"timeout\":%s,\"reset\":%s}",
+                         index == 0 ? "],\"stalls\":[" : ",", (unsigned long)(stall.info >> 16),
+                         smartIntercomGetPhaseName(stall.info & 0xFF), (unsigned long)stall.startMs,
+                         (unsigned long)stall.durationMs, (unsigned long)stall.pc,
+                         (flags & SMARTINTERCOM_WATCHDOG_OPEN) ? "true" : "false",
+                         (flags & SMARTINTERCOM_WATCHDOG_TIMEOUT) ? "true" : "false",
+                         (flags & SMARTINTERCOM_WATCHDOG_RESET) ? "true" : "false");
+    }
+    if (written < 0 || (size_t)written >= space) {
+      break;
+    }
+    used += written;
+    (*cursor)++;
+  }
+  return used;
+}
@@ -0,0 +1,158 @@
+/*
+ * SmartIntercomWatchdog.h - Сторож зависаний главного цикла SmartIntercom
+ *
+ * Части loop() отмечают себя smartIntercomMarkPhase() (SmartIntercomHAL.h):
+ * HTTP-сервер, MDNS.update(), smartIntercomUpdate(), обработчики событий,
+ * WiFi, MQTT. Сон в smartIntercomIdleWait() отмечается фазой IDLE сам.
+ *
+ * Сторож не заводит своего таймера: он вешается вторым обработчиком
+ * (smartIntercomSetTimerHook) на таймер выборки звонка и раз в
+ * SMARTINTERCOM_WATCHDOG_SAMPLE_US смотрит текущую фазу и адрес
+ * прерванной команды (PC, регистр EPC1 на ESP8266). Из этих отсчетов
+ * складывается профиль: какая доля времени уходит на каждую фазу и где
+ * фаза была в последний раз.
+ *
+ * Если фаза (кроме IDLE) не сменилась дольше бюджета, это зависание:
+ * его фаза, начало, длительность и PC записываются в журнал из
+ * SMARTINTERCOM_WATCHDOG_RECORDS записей, пока зависание продолжается.
+ * На ESP8266 журнал лежит в RTC-памяти и переживает перезагрузку,
+ * в том числе сброс аппаратным сторожем посреди зависания: такая
+ * запись после старта помечается reset. Точность длительности - один
+ * период выборки.
+ *
+ * Зависание дольше таймаута помечается timeout и поднимает
+ * smartIntercomIsExpired(); прошивка проверяет его вне главного цикла
+ * (Ticker ESP8266 срабатывает и внутри delay()/yield() застрявшей
+ * фазы) и перезагружает устройство.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_WATCHDOG_H
+#define SMARTINTERCOM_WATCHDOG_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+
+// SmartIntercom Watchdog Configuration
+#ifndef SMARTINTERCOM_WATCHDOG_SAMPLE_US
+#define SMARTINTERCOM_WATCHDOG_SAMPLE_US 10000        // Период отсчетов фазы и PC
+#endif
+
+#ifndef SMARTINTERCOM_WATCHDOG_BUDGET_MS
+#define SMARTINTERCOM_WATCHDOG_BUDGET_MS 100          // Фаза дольше - зависание
+#endif
+
+#ifndef SMARTINTERCOM_WATCHDOG_RECORDS
+#define SMARTINTERCOM_WATCHDOG_RECORDS 8              // Записей в журнале зависаний
+#endif
+
+#ifndef SMARTINTERCOM_WATCHDOG_RTC_OFFSET
+#define SMARTINTERCOM_WATCHDOG_RTC_OFFSET 48          // Блоков по 4 байта от начала RTC-памяти
+#endif
+
+#define SMARTINTERCOM_WATCHDOG_MAGIC 0x47445753UL     // "SWDG"
+
+// SmartIntercom Stall Flags
+#define SMARTINTERCOM_WATCHDOG_OPEN 0x01              // Зависание еще продолжается
+#define SMARTINTERCOM_WATCHDOG_TIMEOUT 0x02           // Превышен таймаут
+#define SMARTINTERCOM_WATCHDOG_RESET 0x04             // Устройство перезагрузилось посреди зависания
+
+/*
+ * SmartIntercomWatchdogStall - Запись журнала зависаний SmartIntercom
+ *
+ * Только 32-битные поля: RTC-память ESP8266 не пишется по байтам.
+ * info - фаза (биты 0-7), флаги (8-15), номер загрузки (16-31).
+ */
+struct SmartIntercomWatchdogStall {
+  volatile uint32_t startMs;
+  volatile uint32_t durationMs;
+  volatile uint32_t info;
+  volatile uint32_t pc;
+};
+
+/*
+ * SmartIntercomWatchdogLog - Журнал зависаний SmartIntercom (RTC-память или RAM)
+ */
+struct SmartIntercomWatchdogLog {
+  volatile uint32_t magic;
+  volatile uint32_t boots;
+  volatile uint32_t head;                             // SmartIntercom записей за все время
+  volatile uint32_t reserved;
+  SmartIntercomWatchdogStall stalls[SMARTINTERCOM_WATCHDOG_RECORDS];
+};
+
+#ifdef ESP8266
+// SmartIntercom RTC Log (пользовательская RTC-память ESP8266 начинается с 0x60001200)
+#define SMARTINTERCOM_WATCHDOG_RTC_LOG \
+  ((SmartIntercomWatchdogLog*)(0x60001200UL + SMARTINTERCOM_WATCHDOG_RTC_OFFSET * 4))
+#endif
+
+/*
+ * SmartIntercomWatchdog - Сторож и профиль фаз главного цикла SmartIntercom
+ */
+class SmartIntercomWatchdog {
+private:
+  SmartIntercomWatchdogLog* smartIntercomStallLog;
+  SmartIntercomWatchdogLog smartIntercomRamLog;
+  uint32_t smartIntercomSampleUs;
+  uint32_t smartIntercomBudgetUs;
+  uint32_t smartIntercomTimeoutUs;
+  uint16_t smartIntercomDecimation;
+
+  // SmartIntercom Sampler State (меняется в прерывании)
+  volatile uint16_t smartIntercomTicks;
+  volatile uint32_t smartIntercomSeenMarks;
+  volatile uint32_t smartIntercomStallUs;
+  volatile uint32_t smartIntercomStallIndex;
+  volatile bool smartIntercomStallOpen;
+  volatile bool smartIntercomExpired;
+  volatile uint32_t smartIntercomTotalSamples;
+  volatile uint32_t smartIntercomSamples[SMARTINTERCOM_PHASES];
+  volatile uint32_t smartIntercomStalls[SMARTINTERCOM_PHASES];
+  volatile uint32_t smartIntercomMaxStallMs[SMARTINTERCOM_PHASES];
+  volatile uint32_t smartIntercomPCs[SMARTINTERCOM_PHASES];
+
+  // SmartIntercom Internal Methods
+  static void smartIntercomTick(void* context);
+  void smartIntercomSample();
+  void smartIntercomClearLog();
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomWatchdog();
+
+  // SmartIntercom Initialization (timerPeriodUs - период таймера выборки звонка;
+  // log == nullptr - журнал в RAM, без сохранения через перезагрузку)
+  void smartIntercomBegin(unsigned long timerPeriodUs, SmartIntercomWatchdogLog* log = nullptr);
+  void smartIntercomEnd();
+
+  // SmartIntercom Limits (timeoutMs = 0 - без таймаута)
+  void smartIntercomSetBudget(unsigned long budgetMs) { smartIntercomBudgetUs = budgetMs * 1000UL; }
+  void smartIntercomSetTimeout(unsigned long timeoutMs) { smartIntercomTimeoutUs = timeoutMs * 1000UL; }
+  unsigned long smartIntercomGetBudget() { return smartIntercomBudgetUs / 1000UL; }
+  unsigned long smartIntercomGetTimeout() { return smartIntercomTimeoutUs / 1000UL; }
+  bool smartIntercomIsExpired() { return smartIntercomExpired; }
+
+  // SmartIntercom Reset profile and stall log
+  void smartIntercomClear();
+
+  // SmartIntercom Phase Profile
+  uint32_t smartIntercomGetTotalSamples() { return smartIntercomTotalSamples; }
+  uint32_t smartIntercomGetSamples(uint8_t phase);
+  uint32_t smartIntercomGetStalls(uint8_t phase);
+  uint32_t smartIntercomGetMaxStall(uint8_t phase);
+  uint32_t smartIntercomGetPC(uint8_t phase);
+  static const char* smartIntercomGetPhaseName(uint8_t phase);
+
+  // SmartIntercom Stall Log (index 0 - самая старая запись)
+  uint32_t smartIntercomGetBoots() { return smartIntercomStallLog->boots; }
+  uint32_t smartIntercomGetStallCount();
+  bool smartIntercomGetStall(uint32_t index, SmartIntercomWatchdogStall* stall);
+
+  // SmartIntercom JSON (генератор тела GET /api/watchdog)
+  static size_t smartIntercomWriteJson(char* out, size_t size, uint32_t* cursor, void* context);
+};
+
+#endif // SMARTINTERCOM_WATCHDOG_H
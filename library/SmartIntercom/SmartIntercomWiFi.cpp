@@ -0,0 +1,318 @@
+/*
+ * SmartIntercomWiFi.cpp - Реализация фонового подключения SmartIntercom к WiFi
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomWiFi.h"
+#include "SmartIntercomLog.h"
+#include <stddef.h>
+
+static const char* const smartIntercomWiFiStateNames[] = { "idle", "backoff", "connecting", "connected" };
+
+/*
+ * SmartIntercomWiFi Constructor
+ */
+SmartIntercomWiFi::SmartIntercomWiFi() {
+  smartIntercomLink = nullptr;
+  smartIntercomFlash = nullptr;
+  smartIntercomMetrics = nullptr;
+  smartIntercomSsid = "";
+  smartIntercomPassword = "";
+  memset(&smartIntercomCache, 0, sizeof(smartIntercomCache));
+  smartIntercomCacheValid = false;
+  smartIntercomCacheFromRtc = false;
+  smartIntercomFlashSlot = 0;
+  smartIntercomFlashCrc = 0;
+  smartIntercomState = SMARTINTERCOM_WIFI_IDLE;
+  smartIntercomFastAttempt = false;
+  smartIntercomLeaseAttempt = false;
+  smartIntercomLost = false;
+  smartIntercomAttemptAt = 0;
+  smartIntercomLostAt = 0;
+  smartIntercomRetryAt = 0;
+  smartIntercomBackoffMs = SMARTINTERCOM_WIFI_RECONNECT_MS;
+  smartIntercomAttempts = 0;
+  smartIntercomConnects = 0;
+  smartIntercomFastConnects = 0;
+  smartIntercomLastConnectMs = 0;
+}
+
+/*
+ * SmartIntercomWiFi Begin
+ * Первая попытка SmartIntercom запускается сразу, без ожидания результата
+ */
+void SmartIntercomWiFi::smartIntercomBegin(SmartIntercomWiFiLink* link, const char* ssid, const char* password,
+                                           SmartIntercomFlash* flash) {
+  smartIntercomLink = link;
+  smartIntercomSsid = ssid != nullptr ? ssid : "";
+  smartIntercomPassword = password != nullptr ? password : "";
+  smartIntercomFlash = flash;
+  if (smartIntercomFlash != nullptr && smartIntercomFlash->smartIntercomGetSectorCount() == 0) {
+    smartIntercomFlash = nullptr;
+  }
+
+  if (smartIntercomLink == nullptr || smartIntercomSsid[0] == '\0') {
+    smartIntercomState = SMARTINTERCOM_WIFI_IDLE;
+    return;
+  }
+  smartIntercomLoadCache();
+  smartIntercomStartAttempt(smartIntercomMillis());
+}
+
+// ============================================================================
+// SmartIntercom Access Point Cache
+// ============================================================================
+
+uint32_t SmartIntercomWiFi::smartIntercomHashSsid() {
+  return SmartIntercomConfigStore::smartIntercomCrc32((const uint8_t*)smartIntercomSsid, strlen(smartIntercomSsid));
+}
+
+bool SmartIntercomWiFi::smartIntercomCheckCache(const SmartIntercomWiFiCache* cache) {
+  return cache->magic == SMARTINTERCOM_WIFI_CACHE_MAGIC && cache->ssidHash == smartIntercomHashSsid() &&
+         cache->channel != 0 &&
+         cache->crc == SmartIntercomConfigStore::smartIntercomCrc32((const uint8_t*)cache,
+                                                                    offsetof(SmartIntercomWiFiCache, crc));
+}
+
+void SmartIntercomWiFi::smartIntercomSealCache(SmartIntercomWiFiCache* cache) {
+  cache->magic = SMARTINTERCOM_WIFI_CACHE_MAGIC;
+  cache->ssidHash = smartIntercomHashSsid();
+  cache->crc = SmartIntercomConfigStore::smartIntercomCrc32((const uint8_t*)cache,
+                                                            offsetof(SmartIntercomWiFiCache, crc));
+}
+
+/*
+ * SmartIntercomWiFi Load Cache
+ * RTC-память SmartIntercom важнее флеш-памяти: там запись после сброса
+ *
+ * Во флеш-памяти записи идут подряд в первом секторе, действует
+ * последняя с верной CRC; заодно находится первый свободный слот.
+ */
+void SmartIntercomWiFi::smartIntercomLoadCache() {
+  SmartIntercomWiFiCache record;
+  smartIntercomCacheValid = false;
+  smartIntercomCacheFromRtc = false;
+
+  if (smartIntercomFlash != nullptr) {
+    uint32_t slots = smartIntercomFlash->smartIntercomGetSectorSize() / sizeof(SmartIntercomWiFiCache);
+    smartIntercomFlashSlot = slots;
+    for (uint32_t slot = 0; slot < slots; slot++) {
+      if (!smartIntercomFlash->smartIntercomRead(0, slot * sizeof(record), (uint32_t*)&record, sizeof(record))) {
+        break;
+      }
+      if (record.magic == 0xFFFFFFFFUL) {
+        smartIntercomFlashSlot = slot;
+        break;
+      }
+      if (smartIntercomCheckCache(&record)) {
+        smartIntercomCache = record;
+        smartIntercomCacheValid = true;
+        smartIntercomFlashCrc = record.crc;
+      }
+    }
+  }
+
+  if (smartIntercomLink->smartIntercomLoadRtc(&record) && smartIntercomCheckCache(&record)) {
+    smartIntercomCache = record;
+    smartIntercomCacheValid = true;
+    smartIntercomCacheFromRtc = true;
+  }
+
+  if (smartIntercomCacheValid) {
+    SMARTINTERCOM_LOG_INFO("SmartIntercom: WiFi cached AP on channel %u (%s)", smartIntercomCache.channel,
+                           smartIntercomCacheFromRtc ? "rtc" : "flash");
+  }
+}
+
+/*
+ * SmartIntercomWiFi Save Cache
+ * В RTC SmartIntercom пишет при каждом подключении (счетчик старого IP),
+ * во флеш - только если точка или аренда изменились
+ */
+void SmartIntercomWiFi::smartIntercomSaveCache(const SmartIntercomWiFiCache* lease) {
+  SmartIntercomWiFiCache record = *lease;
+  record.reuses = 0;
+  smartIntercomSealCache(&record);
+
+  if (smartIntercomFlash != nullptr && record.crc != smartIntercomFlashCrc) {
+    uint32_t slots = smartIntercomFlash->smartIntercomGetSectorSize() / sizeof(SmartIntercomWiFiCache);
+    if (smartIntercomFlashSlot >= slots) {
+      smartIntercomFlash->smartIntercomErase(0);
+      smartIntercomFlashSlot = 0;
+    }
+    if (smartIntercomFlash->smartIntercomWrite(0, smartIntercomFlashSlot * sizeof(record), (const uint32_t*)&record,
+                                               sizeof(record))) {
+      smartIntercomFlashCrc = record.crc;
+    }
+    smartIntercomFlashSlot++;
+  }
+
+  record.reuses = smartIntercomLeaseAttempt ? (uint8_t)(smartIntercomCache.reuses + 1) : 0;
+  smartIntercomSealCache(&record);
+  smartIntercomLink->smartIntercomSaveRtc(&record);
+  smartIntercomCache = record;
+  smartIntercomCacheValid = true;
+  smartIntercomCacheFromRtc = true;
+}
+
+/*
+ * SmartIntercomWiFi Forget
+ */
+void SmartIntercomWiFi::smartIntercomForget() {
+  SmartIntercomWiFiCache record;
+  memset(&record, 0, sizeof(record));
+  smartIntercomCacheValid = false;
+  smartIntercomCacheFromRtc = false;
+  smartIntercomFlashCrc = 0;
+  if (smartIntercomLink != nullptr) {
+    smartIntercomLink->smartIntercomSaveRtc(&record);
+  }
+  if (smartIntercomFlash != nullptr) {
+    smartIntercomFlash->smartIntercomErase(0);
+    smartIntercomFlashSlot = 0;
+  }
+}
+
+// ============================================================================
+// SmartIntercom Connection Attempts
+// ============================================================================
+
+/*
+ * SmartIntercomWiFi Start Attempt
+ * С запомненной точкой SmartIntercom сначала пробует ее (старый IP - только
+ * из RTC и не больше SMARTINTERCOM_WIFI_LEASE_REUSE_MAX раз подряд)
+ */
+void SmartIntercomWiFi::smartIntercomStartAttempt(unsigned long now) {
+  smartIntercomFastAttempt = smartIntercomCacheValid;
+  smartIntercomLeaseAttempt = smartIntercomFastAttempt && smartIntercomCacheFromRtc && !smartIntercomLost &&
+                              smartIntercomConnects == 0 && smartIntercomCache.ip != 0 &&
+                              smartIntercomCache.reuses < SMARTINTERCOM_WIFI_LEASE_REUSE_MAX;
+  smartIntercomAttempts++;
+  smartIntercomAttemptAt = now;
+  smartIntercomState = SMARTINTERCOM_WIFI_CONNECTING;
+  if (!smartIntercomLink->smartIntercomConnect(smartIntercomSsid, smartIntercomPassword,
+                                               smartIntercomFastAttempt ? &smartIntercomCache : nullptr,
+                                               smartIntercomLeaseAttempt)) {
+    smartIntercomFailAttempt(now);
+  }
+}
+
+/*
+ * SmartIntercomWiFi Fail Attempt
+ * Неудача по запомненной точке сразу переходит к сканированию,
+ * обычная - к паузе, которая удваивается с каждой неудачей
+ */
+void SmartIntercomWiFi::smartIntercomFailAttempt(unsigned long now) {
+  smartIntercomLink->smartIntercomDisconnect();
+  if (smartIntercomFastAttempt) {
+    SMARTINTERCOM_LOG_WARNING("SmartIntercom: WiFi cached AP failed, scanning");
+    smartIntercomCacheValid = false;
+    smartIntercomStartAttempt(now);
+    return;
+  }
+  SMARTINTERCOM_LOG_WARNING("SmartIntercom: WiFi connect failed, retry in %lu ms", smartIntercomBackoffMs);
+  smartIntercomState = SMARTINTERCOM_WIFI_BACKOFF;
+  smartIntercomRetryAt = now + smartIntercomBackoffMs;
+  smartIntercomBackoffMs *= 2;
+  if (smartIntercomBackoffMs > SMARTINTERCOM_WIFI_RECONNECT_MAX_MS) {
+    smartIntercomBackoffMs = SMARTINTERCOM_WIFI_RECONNECT_MAX_MS;
+  }
+}
+
+/*
+ * SmartIntercomWiFi Connected
+ * Время попытки SmartIntercom идет в wifi_connect, время от потери
+ * связи - в wifi_reconnect
+ */
+void SmartIntercomWiFi::smartIntercomHandleConnected(unsigned long now) {
+  smartIntercomState = SMARTINTERCOM_WIFI_CONNECTED;
+  smartIntercomBackoffMs = SMARTINTERCOM_WIFI_RECONNECT_MS;
+  smartIntercomLastConnectMs = now - smartIntercomAttemptAt;
+  smartIntercomConnects++;
+  if (smartIntercomFastAttempt) {
+    smartIntercomFastConnects++;
+  }
+  if (smartIntercomMetrics != nullptr) {
+    smartIntercomMetrics->smartIntercomRecord(SMARTINTERCOM_METRIC_WIFI_CONNECT, smartIntercomLastConnectMs * 1000UL);
+    if (smartIntercomLost) {
+      smartIntercomMetrics->smartIntercomRecord(SMARTINTERCOM_METRIC_WIFI_RECONNECT,
+                                                (now - smartIntercomLostAt) * 1000UL);
+    }
+  }
+  smartIntercomLost = false;
+
+  SmartIntercomWiFiCache lease;
+  memset(&lease, 0, sizeof(lease));
+  if (smartIntercomLink->smartIntercomGetLease(&lease) && lease.channel != 0) {
+    smartIntercomSaveCache(&lease);
+  }
+  SMARTINTERCOM_LOG_INFO("SmartIntercom: WiFi connected in %lu ms (%s)", smartIntercomLastConnectMs,
+                         smartIntercomLeaseAttempt ? "cached lease" : smartIntercomFastAttempt ? "cached AP" : "scan");
+}
+
+/*
+ * SmartIntercomWiFi Update
+ */
+void SmartIntercomWiFi::smartIntercomUpdate() {
+  if (smartIntercomState == SMARTINTERCOM_WIFI_IDLE) {
+    return;
+  }
+  unsigned long now = smartIntercomMillis();
+  SmartIntercomWiFiLinkState link = smartIntercomLink->smartIntercomGetLink();
+
+  switch (smartIntercomState) {
+    case SMARTINTERCOM_WIFI_BACKOFF:
+      if ((long)(now - smartIntercomRetryAt) >= 0) {
+        smartIntercomStartAttempt(now);
+      }
+      break;
+
+    case SMARTINTERCOM_WIFI_CONNECTING: {
+      unsigned long timeout = smartIntercomFastAttempt ? SMARTINTERCOM_WIFI_FAST_TIMEOUT_MS
+                                                       : SMARTINTERCOM_WIFI_CONNECT_TIMEOUT_MS;
+      if (link == SMARTINTERCOM_WIFI_LINK_UP) {
+        smartIntercomHandleConnected(now);
+      } else if (link == SMARTINTERCOM_WIFI_LINK_FAILED || now - smartIntercomAttemptAt >= timeout) {
+        smartIntercomFailAttempt(now);
+      }
+      break;
+    }
+
+    case SMARTINTERCOM_WIFI_CONNECTED:
+      if (link != SMARTINTERCOM_WIFI_LINK_UP) {
+        SMARTINTERCOM_LOG_WARNING("SmartIntercom: WiFi link lost, reconnecting");
+        smartIntercomLost = true;
+        smartIntercomLostAt = now;
+        smartIntercomLink->smartIntercomDisconnect();
+        smartIntercomStartAttempt(now);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*
+ * SmartIntercomWiFi Idle Time
+ * Во время попытки SmartIntercom опрашивает радио раз в SMARTINTERCOM_WIFI_POLL_MS
+ */
+unsigned long SmartIntercomWiFi::smartIntercomGetIdleTime(unsigned long maxMs) {
+  if (smartIntercomState == SMARTINTERCOM_WIFI_BACKOFF) {
+    long remaining = (long)(smartIntercomRetryAt - smartIntercomMillis());
+    if (remaining <= 0) {
+      return 0;
+    }
+    return (unsigned long)remaining < maxMs ? (unsigned long)remaining : maxMs;
+  }
+  if (smartIntercomState == SMARTINTERCOM_WIFI_CONNECTING) {
+    return maxMs < SMARTINTERCOM_WIFI_POLL_MS ? maxMs : SMARTINTERCOM_WIFI_POLL_MS;
+  }
+  return maxMs;
+}
+
+const char* SmartIntercomWiFi::smartIntercomGetStateName(SmartIntercomWiFiState state) {
+  return state <= SMARTINTERCOM_WIFI_CONNECTED ? smartIntercomWiFiStateNames[state] : "unknown";
+}
@@ -0,0 +1,206 @@
+/*
+ * SmartIntercomWiFi.h - Неблокирующее подключение SmartIntercom к WiFi
+ *
+ * Подключение идет в фоне: smartIntercomBegin() только запускает первую
+ * попытку и возвращается сразу, а smartIntercomUpdate() из главного
+ * цикла следит за ней, поэтому детектор звонка и дверь работают с первой
+ * миллисекунды после старта, а не после получения IP.
+ *
+ * После каждого подключения точка доступа (BSSID, канал) и полученная
+ * аренда DHCP (IP, шлюз, маска, DNS) запоминаются:
+ *
+ *   RTC-память     переживает перезагрузку (но не пропадание питания),
+ *                  поэтому после сброса станция подключается к той же
+ *                  точке без сканирования и без DHCP, со старым IP.
+ *                  Старый IP используется не больше
+ *                  SMARTINTERCOM_WIFI_LEASE_REUSE_MAX перезагрузок
+ *                  подряд, затем аренда обновляется через DHCP.
+ *   Флеш-память    (необязательно) переживает пропадание питания;
+ *                  из нее берутся только BSSID и канал, IP - по DHCP,
+ *                  потому что за время без питания аренда могла
+ *                  достаться другому устройству. Запись только при
+ *                  смене точки или аренды.
+ *
+ * Быстрая попытка по запомненной точке ограничена
+ * SMARTINTERCOM_WIFI_FAST_TIMEOUT_MS; не удалась - запись забывается и
+ * сразу начинается обычное подключение со сканированием. Неудачное
+ * обычное подключение повторяется с паузой, которая удваивается от
+ * SMARTINTERCOM_WIFI_RECONNECT_MS до SMARTINTERCOM_WIFI_RECONNECT_MAX_MS.
+ * Потеря связи запускает переподключение так же, через быструю попытку.
+ *
+ * Радио скрыто за SmartIntercomWiFiLink: ESP8266WiFi на устройстве
+ * (SmartIntercomWiFiESP8266.h), на хосте - любая заглушка.
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_WIFI_H
+#define SMARTINTERCOM_WIFI_H
+
+#include <Arduino.h>
+#include "SmartIntercomHAL.h"
+#include "SmartIntercomConfigStore.h"
+#include "SmartIntercomMetrics.h"
+
+// SmartIntercom WiFi Configuration
+#ifndef SMARTINTERCOM_WIFI_FAST_TIMEOUT_MS
+#define SMARTINTERCOM_WIFI_FAST_TIMEOUT_MS 3000      // Попытка по запомненной точке
+#endif
+
+#ifndef SMARTINTERCOM_WIFI_CONNECT_TIMEOUT_MS
+#define SMARTINTERCOM_WIFI_CONNECT_TIMEOUT_MS 15000  // Попытка со сканированием и DHCP
+#endif
+
+#ifndef SMARTINTERCOM_WIFI_RECONNECT_MS
+#define SMARTINTERCOM_WIFI_RECONNECT_MS 1000         // Первая пауза после неудачи
+#endif
+
+#ifndef SMARTINTERCOM_WIFI_RECONNECT_MAX_MS
+#define SMARTINTERCOM_WIFI_RECONNECT_MAX_MS 60000    // Пауза удваивается до этого предела
+#endif
+
+#ifndef SMARTINTERCOM_WIFI_POLL_MS
+#define SMARTINTERCOM_WIFI_POLL_MS 100               // Сон цикла во время попытки
+#endif
+
+#ifndef SMARTINTERCOM_WIFI_LEASE_REUSE_MAX
+#define SMARTINTERCOM_WIFI_LEASE_REUSE_MAX 8         // Перезагрузок подряд со старым IP
+#endif
+
+#define SMARTINTERCOM_WIFI_CACHE_MAGIC 0x57494643UL  // "CFIW"
+
+// SmartIntercom WiFi Link State (радио)
+enum SmartIntercomWiFiLinkState {
+  SMARTINTERCOM_WIFI_LINK_DOWN,       // Нет связи или попытка еще идет
+  SMARTINTERCOM_WIFI_LINK_UP,         // Связь есть, IP получен
+  SMARTINTERCOM_WIFI_LINK_FAILED      // Попытка отвергнута (нет сети, неверный пароль)
+};
+
+// SmartIntercom WiFi Manager State
+enum SmartIntercomWiFiState {
+  SMARTINTERCOM_WIFI_IDLE,            // Сеть не задана
+  SMARTINTERCOM_WIFI_BACKOFF,         // Пауза перед следующей попыткой
+  SMARTINTERCOM_WIFI_CONNECTING,      // Попытка идет
+  SMARTINTERCOM_WIFI_CONNECTED
+};
+
+/*
+ * SmartIntercomWiFiCache - Запомненная точка доступа и аренда SmartIntercom
+ *
+ * Адреса - в порядке байт IPAddress (uint32_t). ssidHash отличает
+ * записи разных сетей: после смены сети запись не используется.
+ */
+struct SmartIntercomWiFiCache {
+  uint32_t magic;
+  uint32_t ssidHash;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reuses;                     // SmartIntercom подключений со старым IP подряд
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t mask;
+  uint32_t dns;
+  uint32_t crc;
+};
+
+/*
+ * SmartIntercomWiFiLink - Радио SmartIntercom в режиме станции
+ *
+ * smartIntercomConnect() начинает попытку и возвращается сразу.
+ * cache == nullptr - обычное подключение со сканированием и DHCP;
+ * иначе подключение к cache->bssid на cache->channel, а при
+ * useLease - еще и со статическим адресом из cache вместо DHCP.
+ */
+class SmartIntercomWiFiLink {
+public:
+  virtual ~SmartIntercomWiFiLink() {}
+
+  virtual bool smartIntercomConnect(const char* ssid, const char* password, const SmartIntercomWiFiCache* cache,
+                                    bool useLease) = 0;
+  virtual SmartIntercomWiFiLinkState smartIntercomGetLink() = 0;
+  virtual bool smartIntercomGetLease(SmartIntercomWiFiCache* cache) = 0;
+  virtual void smartIntercomDisconnect() = 0;
+
+  // SmartIntercom RTC Memory (false - памяти нет)
+  virtual bool smartIntercomLoadRtc(SmartIntercomWiFiCache* cache) {
+    (void)cache;
+    return false;
+  }
+  virtual bool smartIntercomSaveRtc(const SmartIntercomWiFiCache* cache) {
+    (void)cache;
+    return false;
+  }
+};
+
+/*
+ * SmartIntercomWiFi - Фоновое подключение SmartIntercom к WiFi
+ *
+ * Строки ssid и password не копируются и должны жить все время работы.
+ */
+class SmartIntercomWiFi {
+private:
+  SmartIntercomWiFiLink* smartIntercomLink;
+  SmartIntercomFlash* smartIntercomFlash;
+  SmartIntercomMetrics* smartIntercomMetrics;
+  const char* smartIntercomSsid;
+  const char* smartIntercomPassword;
+  SmartIntercomWiFiCache smartIntercomCache;
+  bool smartIntercomCacheValid;
+  bool smartIntercomCacheFromRtc;
+  uint32_t smartIntercomFlashSlot;
+  uint32_t smartIntercomFlashCrc;
+
+  SmartIntercomWiFiState smartIntercomState;
+  bool smartIntercomFastAttempt;
+  bool smartIntercomLeaseAttempt;
+  bool smartIntercomLost;
+  unsigned long smartIntercomAttemptAt;
+  unsigned long smartIntercomLostAt;
+  unsigned long smartIntercomRetryAt;
+  unsigned long smartIntercomBackoffMs;
+
+  // SmartIntercom WiFi Statistics
+  uint32_t smartIntercomAttempts;
+  uint32_t smartIntercomConnects;
+  uint32_t smartIntercomFastConnects;
+  unsigned long smartIntercomLastConnectMs;
+
+  // SmartIntercom Internal Methods
+  uint32_t smartIntercomHashSsid();
+  bool smartIntercomCheckCache(const SmartIntercomWiFiCache* cache);
+  void smartIntercomSealCache(SmartIntercomWiFiCache* cache);
+  void smartIntercomLoadCache();
+  void smartIntercomSaveCache(const SmartIntercomWiFiCache* lease);
+  void smartIntercomStartAttempt(unsigned long now);
+  void smartIntercomFailAttempt(unsigned long now);
+  void smartIntercomHandleConnected(unsigned long now);
+
+public:
+  // SmartIntercom Constructor
+  SmartIntercomWiFi();
+
+  // SmartIntercom Initialization (flash == nullptr - запоминать только в RTC;
+  // при выборке звонка передавать flash через SmartIntercomFlashGuard)
+  void smartIntercomBegin(SmartIntercomWiFiLink* link, const char* ssid, const char* password,
+                          SmartIntercomFlash* flash = nullptr);
+  void smartIntercomAttachMetrics(SmartIntercomMetrics* metrics) { smartIntercomMetrics = metrics; }
+
+  // SmartIntercom Main Loop
+  void smartIntercomUpdate();
+  unsigned long smartIntercomGetIdleTime(unsigned long maxMs);
+
+  // SmartIntercom Forget the cached access point and lease (RTC and flash)
+  void smartIntercomForget();
+
+  // SmartIntercom WiFi State
+  SmartIntercomWiFiState smartIntercomGetState() { return smartIntercomState; }
+  bool smartIntercomIsConnected() { return smartIntercomState == SMARTINTERCOM_WIFI_CONNECTED; }
+  uint32_t smartIntercomGetAttempts() { return smartIntercomAttempts; }
+  uint32_t smartIntercomGetConnects() { return smartIntercomConnects; }
+  uint32_t smartIntercomGetFastConnects() { return smartIntercomFastConnects; }
+  unsigned long smartIntercomGetLastConnectTime() { return smartIntercomLastConnectMs; }
+  static const char* smartIntercomGetStateName(SmartIntercomWiFiState state);
+};
+
+#endif // SMARTINTERCOM_WIFI_H
@@ -0,0 +1,77 @@
+/*
+ * SmartIntercomWiFiESP8266.cpp - Реализация радио SmartIntercom для ESP8266
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#include "SmartIntercomWiFiESP8266.h"
+
+#ifdef ESP8266
+
+/*
+ * SmartIntercomWiFiLinkESP8266 Connect
+ * WiFi.begin() SmartIntercom только запускает подключение в SDK
+ */
+bool SmartIntercomWiFiLinkESP8266::smartIntercomConnect(const char* ssid, const char* password,
+                                                        const SmartIntercomWiFiCache* cache, bool useLease) {
+  WiFi.persistent(false);
+  WiFi.setAutoReconnect(false);
+  if (useLease && cache != nullptr) {
+    WiFi.config(IPAddress(cache->ip), IPAddress(cache->gateway), IPAddress(cache->mask), IPAddress(cache->dns));
+  } else {
+    // SmartIntercom Zero addresses switch the station back to DHCP
+    WiFi.config(0U, 0U, 0U);
+  }
+  if (cache != nullptr) {
+    return WiFi.begin(ssid, password, cache->channel, cache->bssid, true) != WL_CONNECT_FAILED;
+  }
+  return WiFi.begin(ssid, password) != WL_CONNECT_FAILED;
+}
+
+SmartIntercomWiFiLinkState SmartIntercomWiFiLinkESP8266::smartIntercomGetLink() {
+  switch (WiFi.status()) {
+    case WL_CONNECTED:
+      return SMARTINTERCOM_WIFI_LINK_UP;
+    case WL_NO_SSID_AVAIL:
+    case WL_CONNECT_FAILED:
+      return SMARTINTERCOM_WIFI_LINK_FAILED;
+    default:
+      return SMARTINTERCOM_WIFI_LINK_DOWN;
+  }
+}
+
+/*
+ * SmartIntercomWiFiLinkESP8266 Lease
+ */
+bool SmartIntercomWiFiLinkESP8266::smartIntercomGetLease(SmartIntercomWiFiCache* cache) {
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid == nullptr) {
+    return false;
+  }
+  memcpy(cache->bssid, bssid, sizeof(cache->bssid));
+  cache->channel = (uint8_t)WiFi.channel();
+  cache->ip = (uint32_t)WiFi.localIP();
+  cache->gateway = (uint32_t)WiFi.gatewayIP();
+  cache->mask = (uint32_t)WiFi.subnetMask();
+  cache->dns = (uint32_t)WiFi.dnsIP(0);
+  return true;
+}
+
+void SmartIntercomWiFiLinkESP8266::smartIntercomDisconnect() {
+  WiFi.disconnect(false);
+}
+
+/*
+ * SmartIntercomWiFiLinkESP8266 RTC Memory
+ */
+bool SmartIntercomWiFiLinkESP8266::smartIntercomLoadRtc(SmartIntercomWiFiCache* cache) {
+  return ESP.rtcUserMemoryRead(SMARTINTERCOM_WIFI_RTC_OFFSET, (uint32_t*)cache, sizeof(*cache));
+}
+
+bool SmartIntercomWiFiLinkESP8266::smartIntercomSaveRtc(const SmartIntercomWiFiCache* cache) {
+  return ESP.rtcUserMemoryWrite(SMARTINTERCOM_WIFI_RTC_OFFSET, (uint32_t*)const_cast<SmartIntercomWiFiCache*>(cache),
+                                sizeof(*cache));
+}
+
+#endif // ESP8266
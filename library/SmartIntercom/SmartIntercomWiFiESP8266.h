@@ -0,0 +1,45 @@
+/*
+ * SmartIntercomWiFiESP8266.h - Радио SmartIntercom для ESP8266
+ *
+ * Станция ESP8266WiFi без сохранения настроек во флеш ядром
+ * (WiFi.persistent(false)) и без собственного переподключения ядра
+ * (WiFi.setAutoReconnect(false)): попытками управляет SmartIntercomWiFi.
+ * Запомненная точка лежит в пользовательской RTC-памяти начиная с
+ * блока SMARTINTERCOM_WIFI_RTC_OFFSET (первые 128 байт оставлены под
+ * команды загрузчика eboot при обновлении по воздуху).
+ *
+ * Copyright (c) 2025 SmartIntercom Team
+ * https://smartintercom.ru
+ */
+
+#ifndef SMARTINTERCOM_WIFI_ESP8266_H
+#define SMARTINTERCOM_WIFI_ESP8266_H
+
+#ifdef ESP8266
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "SmartIntercomWiFi.h"
+
+#ifndef SMARTINTERCOM_WIFI_RTC_OFFSET
+#define SMARTINTERCOM_WIFI_RTC_OFFSET 32              // Блоков по 4 байта от начала RTC-памяти
+#endif
+
+/*
+ * SmartIntercomWiFiLinkESP8266 - Станция SmartIntercom на ESP8266WiFi
+ */
+class SmartIntercomWiFiLinkESP8266 : public SmartIntercomWiFiLink {
+public:
+  // SmartIntercom Link Implementation
+  bool smartIntercomConnect(const char* ssid, const char* password, const SmartIntercomWiFiCache* cache,
+                            bool useLease) override;
+  SmartIntercomWiFiLinkState smartIntercomGetLink() override;
+  bool smartIntercomGetLease(SmartIntercomWiFiCache* cache) override;
+  void smartIntercomDisconnect() override;
+  bool smartIntercomLoadRtc(SmartIntercomWiFiCache* cache) override;
+  bool smartIntercomSaveRtc(const SmartIntercomWiFiCache* cache) override;
+};
+
+#endif // ESP8266
+
+#endif // SMARTINTERCOM_WIFI_ESP8266_H
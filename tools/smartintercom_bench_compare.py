@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+smartintercom_bench_compare.py - Сравнение результатов бенчмарков SmartIntercom
+
+Сравнивает два JSON-файла smartintercom_bench --format json (или
+Google Benchmark --benchmark_format=json): базовый и новый. Для
+каждого бенчмарка берется медиана повторов (агрегат _median, если
+запуск был с --repetitions, иначе медиана отдельных замеров) и
+печатается изменение времени в процентах. Код выхода 1, если хотя бы
+один бенчмарк стал медленнее больше чем на --threshold процентов, -
+так регрессию видно в CI до того, как прошивка попадет на устройства.
+
+Использование:
+  ./build/host/smartintercom_bench --repetitions 5 --format json --out base.json
+  ...изменения...
+  ./build/host/smartintercom_bench --repetitions 5 --format json --out new.json
+  python3 tools/smartintercom_bench_compare.py base.json new.json --threshold 10
+
+Copyright (c) 2025 SmartIntercom Team
+https://smartintercom.ru
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+
+def smartintercom_load(path, metric):
+    """Время на итерацию (нс) по имени бенчмарка SmartIntercom"""
+    with open(path, encoding="utf-8") as source:
+        report = json.load(source)
+    runs = {}
+    medians = {}
+    for entry in report.get("benchmarks", []):
+        scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[entry.get("time_unit", "ns")]
+        name = entry.get("run_name", entry["name"])
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[name] = entry[metric] * scale
+        else:
+            runs.setdefault(name, []).append(entry[metric] * scale)
+    results = {name: statistics.median(values) for name, values in runs.items()}
+    results.update(medians)
+    return results, report.get("context", {})
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Сравнение результатов бенчмарков SmartIntercom")
+    parser.add_argument("baseline", help="JSON базового запуска")
+    parser.add_argument("current", help="JSON нового запуска")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="допустимое замедление в процентах (по умолчанию 10)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="cpu_time",
+                        help="какое время сравнивать (по умолчанию cpu_time)")
+    args = parser.parse_args()
+
+    baseline, baseline_context = smartintercom_load(args.baseline, args.metric)
+    current, current_context = smartintercom_load(args.current, args.metric)
+    if baseline_context.get("host_name") != current_context.get("host_name"):
+        print("warning: results come from different hosts (%s, %s)"
+              % (baseline_context.get("host_name"), current_context.get("host_name")))
+
+    regressions = 0
+    print("%-44s %12s %12s %9s" % ("Benchmark", "Base ns", "New ns", "Change"))
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            print("%-44s %12.1f %12s %9s" % (name, baseline[name], "-", "removed"))
+            continue
+        if name not in baseline:
+            print("%-44s %12s %12.1f %9s" % (name, "-", current[name], "new"))
+            continue
+        change = (current[name] - baseline[name]) / baseline[name] * 100 if baseline[name] > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            marker = "  REGRESSION"
+            regressions += 1
+        print("%-44s %12.1f %12.1f %+8.1f%%%s" % (name, baseline[name], current[name], change, marker))
+
+    print("regressions: %d (threshold %.1f%%, %s)" % (regressions, args.threshold, args.metric))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+"""
+smartintercom_mqtt_broker.py - Минимальный MQTT-брокер для проверки SmartIntercom
+
+Заменитель mosquitto для стенда разработчика: MQTT 3.1.1, QoS 0/1,
+retain, Last Will, сохраняемые сессии (clean session = 0) и подписки
+с шаблонами + и #. Каждое принятое сообщение печатается строкой, так что
+события, статус и повторы с флагом DUP видны прямо в консоли.
+
+Для проверки исходящего буфера SmartIntercom брокер умеет рвать
+соединение: --drop-every N закрывает сокет вместо каждого N-го PUBACK,
+и клиент обязан повторить неподтвержденные сообщения после
+переподключения. --publish-at S TOPIC PAYLOAD публикует сообщение
+через S секунд после старта, как mosquitto_pub (например, команду).
+
+Использование:
+  python3 tools/smartintercom_mqtt_broker.py --port 1883
+  python3 tools/smartintercom_mqtt_broker.py --drop-every 5 --duration-s 30 \\
+      --publish-at 10 smartintercom/commands open
+
+Copyright (c) 2025 SmartIntercom Team
+https://smartintercom.ru
+"""
+
+import argparse
+import select
+import socket
+import struct
+import sys
+import time
+
+SMARTINTERCOM_CONNECT = 1
+SMARTINTERCOM_PUBLISH = 3
+SMARTINTERCOM_PUBACK = 4
+SMARTINTERCOM_SUBSCRIBE = 8
+SMARTINTERCOM_PINGREQ = 12
+SMARTINTERCOM_DISCONNECT = 14
+
+
+def smartintercom_encode_length(length):
+    out = bytearray()
+    while True:
+        digit = length & 0x7F
+        length >>= 7
+        out.append(digit | 0x80 if length else digit)
+        if not length:
+            return bytes(out)
+
+
+def smartintercom_packet(header, body):
+    return bytes([header]) + smartintercom_encode_length(len(body)) + body
+
+
+def smartintercom_string(data, offset):
+    (length,) = struct.unpack_from("!H", data, offset)
+    return data[offset + 2:offset + 2 + length], offset + 2 + length
+
+
+def smartintercom_matches(pattern, topic):
+    pattern_parts = pattern.split("/")
+    topic_parts = topic.split("/")
+    for index, part in enumerate(pattern_parts):
+        if part == "#":
+            return True
+        if index >= len(topic_parts) or (part != "+" and part != topic_parts[index]):
+            return False
+    return len(pattern_parts) == len(topic_parts)
+
+
+class SmartIntercomSession:
+    """Сессия клиента SmartIntercom: подписки переживают переподключение"""
+
+    def __init__(self):
+        self.subscriptions = {}
+        self.next_id = 1
+
+
+class SmartIntercomConnection:
+    def __init__(self, sock, address):
+        self.sock = sock
+        self.address = address
+        self.buffer = bytearray()
+        self.client_id = None
+        self.session = None
+        self.will = None
+
+
+class SmartIntercomBroker:
+    def __init__(self, args):
+        self.args = args
+        self.listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.listener.bind((args.host, args.port))
+        self.listener.listen(8)
+        self.connections = {}
+        self.sessions = {}
+        self.retained = {}
+        self.received = 0
+        self.duplicates = 0
+        self.drops = 0
+        self.acks_due = 0
+
+    def log(self, text):
+        print("%8.3f %s" % (time.monotonic() - self.started, text), flush=True)
+
+    # SmartIntercom Delivery
+    def deliver(self, topic, payload, qos, retain=False):
+        for connection in list(self.connections.values()):
+            if connection.session is None:
+                continue
+            granted = [q for pattern, q in connection.session.subscriptions.items()
+                       if smartintercom_matches(pattern, topic)]
+            if granted:
+                self.send_publish(connection, topic, payload, min(qos, max(granted)), retain)
+
+    def send_publish(self, connection, topic, payload, qos, retain):
+        header = 0x30 | (qos << 1) | (1 if retain else 0)
+        body = struct.pack("!H", len(topic)) + topic.encode()
+        if qos:
+            session = connection.session
+            body += struct.pack("!H", session.next_id)
+            session.next_id = session.next_id % 0xFFFF + 1
+        self.send(connection, smartintercom_packet(header, body + payload))
+
+    def publish(self, topic, payload, qos, retain):
+        if retain:
+            if payload:
+                self.retained[topic] = (payload, qos)
+            else:
+                self.retained.pop(topic, None)
+        self.deliver(topic, payload, qos)
+
+    def send(self, connection, data):
+        try:
+            connection.sock.sendall(data)
+        except OSError:
+            self.close(connection, abnormal=True)
+
+    def close(self, connection, abnormal):
+        if connection.sock.fileno() not in self.connections:
+            return
+        del self.connections[connection.sock.fileno()]
+        connection.sock.close()
+        if abnormal and connection.will:
+            topic, payload, qos, retain = connection.will
+            self.log("WILL     %s %s" % (topic, payload.decode(errors="replace")))
+            self.publish(topic, payload, qos, retain)
+
+    # SmartIntercom Packet Handling
+    def handle(self, connection, header, body):
+        kind = header >> 4
+        if kind == SMARTINTERCOM_CONNECT:
+            _, offset = smartintercom_string(body, 0)
+            flags = body[offset + 1]
+            keepalive = struct.unpack_from("!H", body, offset + 2)[0]
+            client_id, offset = smartintercom_string(body, offset + 4)
+            connection.client_id = client_id.decode(errors="replace")
+            if flags & 0x04:
+                will_topic, offset = smartintercom_string(body, offset)
+                will_payload, offset = smartintercom_string(body, offset)
+                connection.will = (will_topic.decode(), will_payload, (flags >> 3) & 0x03, bool(flags & 0x20))
+            clean = bool(flags & 0x02)
+            present = not clean and connection.client_id in self.sessions
+            if clean or not present:
+                self.sessions[connection.client_id] = SmartIntercomSession()
+            connection.session = self.sessions[connection.client_id]
+            self.log("CONNECT  %s keepalive=%d clean=%d session_present=%d"
+                     % (connection.client_id, keepalive, clean, present))
+            self.send(connection, smartintercom_packet(0x20, bytes([1 if present else 0, 0])))
+        elif kind == SMARTINTERCOM_PUBLISH:
+            qos = (header >> 1) & 0x03
+            dup = bool(header & 0x08)
+            retain = bool(header & 0x01)
+            topic, offset = smartintercom_string(body, 0)
+            packet_id = None
+            if qos:
+                (packet_id,) = struct.unpack_from("!H", body, offset)
+                offset += 2
+            payload = bytes(body[offset:])
+            topic = topic.decode(errors="replace")
+            self.received += 1
+            self.duplicates += 1 if dup else 0
+            self.log("PUBLISH  %s qos=%d retain=%d dup=%d id=%s %s"
+                     % (topic, qos, retain, dup, packet_id, payload.decode(errors="replace")))
+            if qos and self.args.drop_every:
+                self.acks_due += 1
+                if self.acks_due % self.args.drop_every == 0:
+                    self.drops += 1
+                    self.log("DROP     %s before PUBACK %d" % (connection.client_id, packet_id))
+                    self.close(connection, abnormal=False)
+                    return
+            self.publish(topic, payload, qos, retain)
+            if qos:
+                self.send(connection, smartintercom_packet(0x40, struct.pack("!H", packet_id)))
+        elif kind == SMARTINTERCOM_PUBACK:
+            pass
+        elif kind == SMARTINTERCOM_SUBSCRIBE:
+            (packet_id,) = struct.unpack_from("!H", body, 0)
+            offset = 2
+            granted = bytearray()
+            topics = []
+            while offset < len(body):
+                pattern, offset = smartintercom_string(body, offset)
+                qos = min(body[offset], 1)
+                offset += 1
+                connection.session.subscriptions[pattern.decode()] = qos
+                topics.append(pattern.decode())
+                granted.append(qos)
+            self.log("SUBSCRIBE %s %s" % (connection.client_id, " ".join(topics)))
+            self.send(connection, smartintercom_packet(0x90, struct.pack("!H", packet_id) + bytes(granted)))
+            for topic, (payload, qos) in self.retained.items():
+                if any(smartintercom_matches(pattern, topic) for pattern in topics):
+                    self.send_publish(connection, topic, payload, qos, True)
+        elif kind == SMARTINTERCOM_PINGREQ:
+            self.send(connection, bytes([0xD0, 0]))
+        elif kind == SMARTINTERCOM_DISCONNECT:
+            connection.will = None
+            self.log("DISCONNECT %s" % connection.client_id)
+            self.close(connection, abnormal=False)
+
+    def receive(self, connection):
+        try:
+            data = connection.sock.recv(4096)
+        except OSError:
+            data = b""
+        if not data:
+            self.close(connection, abnormal=True)
+            return
+        connection.buffer += data
+        while len(connection.buffer) >= 2:
+            length = 0
+            shift = 0
+            offset = 1
+            while offset < len(connection.buffer):
+                digit = connection.buffer[offset]
+                offset += 1
+                length |= (digit & 0x7F) << shift
+                shift += 7
+                if not digit & 0x80:
+                    break
+            else:
+                return
+            if len(connection.buffer) < offset + length:
+                return
+            header = connection.buffer[0]
+            body = bytes(connection.buffer[offset:offset + length])
+            del connection.buffer[:offset + length]
+            self.handle(connection, header, body)
+            if connection.sock.fileno() not in self.connections:
+                return
+
+    def run(self):
+        self.started = time.monotonic()
+        pending = sorted(self.args.publish_at or [], key=lambda item: float(item[0]))
+        self.log("LISTEN   %s:%d" % (self.args.host, self.args.port))
+        while True:
+            elapsed = time.monotonic() - self.started
+            if self.args.duration_s and elapsed >= self.args.duration_s:
+                break
+            while pending and float(pending[0][0]) <= elapsed:
+                _, topic, payload = pending.pop(0)
+                self.log("INJECT   %s %s" % (topic, payload))
+                self.publish(topic, payload.encode(), 1, False)
+            sockets = [self.listener] + [c.sock for c in self.connections.values()]
+            readable, _, _ = select.select(sockets, [], [], 0.1)
+            for sock in readable:
+                if sock is self.listener:
+                    client, address = self.listener.accept()
+                    client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                    self.connections[client.fileno()] = SmartIntercomConnection(client, address)
+                elif sock.fileno() in self.connections:
+                    self.receive(self.connections[sock.fileno()])
+        print("received: %d" % self.received)
+        print("duplicates: %d" % self.duplicates)
+        print("drops: %d" % self.drops)
+        for topic, (payload, _) in sorted(self.retained.items()):
+            print("retained %s: %s" % (topic, payload.decode(errors="replace")))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Минимальный MQTT-брокер для проверки SmartIntercom")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--drop-every", type=int, default=0,
+                        help="закрывать соединение вместо каждого N-го PUBACK")
+    parser.add_argument("--duration-s", type=float, default=0, help="остановиться через D секунд")
+    parser.add_argument("--publish-at", nargs=3, action="append", metavar=("S", "TOPIC", "PAYLOAD"),
+                        help="опубликовать PAYLOAD в TOPIC через S секунд")
+    args = parser.parse_args()
+    try:
+        SmartIntercomBroker(args).run()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
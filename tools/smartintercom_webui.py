@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+smartintercom_webui.py - Сборка веб-интерфейса SmartIntercom в PROGMEM
+
+Минифицирует HTML-страницу (HTML, CSS и JS внутри <style>/<script>),
+сжимает ее gzip и записывает заголовок C++ с массивом байт во флеш-памяти.
+Прошивка отдает массив как есть с Content-Encoding: gzip через send_P(),
+без сборки страницы в String.
+
+Использование:
+  python3 tools/smartintercom_webui.py web/index.html SmartIntercomWebPage.h
+  python3 tools/smartintercom_webui.py --check web/index.html SmartIntercomWebPage.h
+
+--check не перезаписывает файл, а завершается с кодом 1, если заголовок
+устарел (удобно для CI и pre-commit).
+
+Copyright (c) 2025 SmartIntercom Team
+https://smartintercom.ru
+"""
+
+import argparse
+import gzip
+import os
+import re
+import sys
+
+SMARTINTERCOM_BLOCK = re.compile(r"(<style[^>]*>)(.*?)(</style>)|(<script[^>]*>)(.*?)(</script>)",
+                                 re.DOTALL | re.IGNORECASE)
+
+
+def smartintercom_minify_css(css):
+    """CSS SmartIntercom: без комментариев и лишних пробелов."""
+    css = re.sub(r"/\*.*?\*/", "", css, flags=re.DOTALL)
+    css = re.sub(r"\s+", " ", css)
+    css = re.sub(r"\s*([{}:;,>])\s*", r"\1", css)
+    css = css.replace(";}", "}")
+    return css.strip()
+
+
+def smartintercom_minify_js(js):
+    """JS SmartIntercom: построчно, без отступов, пустых строк и строк-комментариев.
+
+    Переводы строк сохраняются, чтобы не зависеть от автоматической
+    расстановки точек с запятой.
+    """
+    lines = []
+    for line in js.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def smartintercom_minify_html(html):
+    """HTML SmartIntercom: без комментариев и пробелов между тегами."""
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.DOTALL)
+    html = re.sub(r"\s+", " ", html)
+    html = re.sub(r">\s+<", "><", html)
+    return html.strip()
+
+
+def smartintercom_minify(source):
+    """Минификация страницы SmartIntercom с отдельной обработкой style/script."""
+    result = []
+    position = 0
+    for match in SMARTINTERCOM_BLOCK.finditer(source):
+        result.append(smartintercom_minify_html(source[position:match.start()]))
+        if match.group(1):
+            result.append(match.group(1) + smartintercom_minify_css(match.group(2)) + match.group(3))
+        else:
+            result.append(match.group(4) + smartintercom_minify_js(match.group(5)) + match.group(6))
+        position = match.end()
+    result.append(smartintercom_minify_html(source[position:]))
+    return "".join(result)
+
+
+def smartintercom_header(name, output_path, source_path, source_size, minified_size, payload):
+    """Текст заголовка C++ SmartIntercom с массивом PROGMEM."""
+    guard = name + "_H"
+    lines = [
+        "/*",
+        " * %s - Сжатая веб-страница SmartIntercom" % os.path.basename(output_path),
+        " *",
+        " * Сгенерировано tools/smartintercom_webui.py из %s, не редактировать." % source_path,
+        " * Исходник: %d байт, после минификации: %d байт, gzip: %d байт."
+        % (source_size, minified_size, len(payload)),
+        " */",
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include <Arduino.h>",
+        "",
+        "#define %s_GZ_LENGTH %d" % (name, len(payload)),
+        "",
+        "static const uint8_t %s_GZ[] PROGMEM = {" % name,
+    ]
+    for offset in range(0, len(payload), 16):
+        chunk = payload[offset:offset + 16]
+        lines.append("  " + ", ".join("0x%02x" % byte for byte in chunk) + ",")
+    lines += [
+        "};",
+        "",
+        "#endif // %s" % guard,
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SmartIntercom web UI -> gzipped PROGMEM header")
+    parser.add_argument("source", help="HTML-страница SmartIntercom")
+    parser.add_argument("output", help="заголовок C++ для прошивки")
+    parser.add_argument("--name", default="SMARTINTERCOM_WEB_PAGE", help="префикс имени массива")
+    parser.add_argument("--check", action="store_true", help="только проверить, что заголовок актуален")
+    args = parser.parse_args()
+
+    with open(args.source, "r", encoding="utf-8") as handle:
+        source = handle.read()
+    minified = smartintercom_minify(source).encode("utf-8")
+    # SmartIntercom mtime=0 keeps the output byte-for-byte reproducible
+    payload = gzip.compress(minified, compresslevel=9, mtime=0)
+
+    header = smartintercom_header(args.name, args.output, args.source.replace(os.sep, "/"),
+                                  len(source.encode("utf-8")), len(minified), payload)
+
+    if args.check:
+        try:
+            with open(args.output, "r", encoding="utf-8") as handle:
+                current = handle.read()
+        except OSError:
+            current = None
+        if current != header:
+            print("SmartIntercom: %s is out of date, rerun %s" % (args.output, sys.argv[0]), file=sys.stderr)
+            return 1
+        return 0
+
+    with open(args.output, "w", encoding="utf-8", newline="\n") as handle:
+        handle.write(header)
+    print("SmartIntercom: %s -> %s (%d -> %d -> %d bytes)"
+          % (args.source, args.output, len(source.encode("utf-8")), len(minified), len(payload)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())